@@ -31,12 +31,99 @@ int oc_init(void);
  */
 void oc_shutdown(void);
 
+// ============================================================================
+// Job System
+// ============================================================================
+
+/**
+ * Job priority lanes. Higher lanes are drained first on every worker.
+ */
+typedef enum {
+    OC_JOB_LANE_HIGH = 0,    // Latency-sensitive work the emulator is waiting on
+    OC_JOB_LANE_NORMAL = 1,
+    OC_JOB_LANE_LOW = 2,     // Speculative and background work
+} oc_job_lane_t;
+
+/** Job callback */
+typedef void (*oc_job_fn)(void* user_data);
+
+/** Parallel loop callback over [begin, end) */
+typedef void (*oc_job_range_fn)(void* user_data, size_t begin, size_t end);
+
+/**
+ * Set of jobs that can be waited on together
+ */
+typedef struct oc_job_group_t oc_job_group_t;
+
+/**
+ * Queue a job on the runtime-wide job system (one worker per core, shared
+ * with JIT compilation and the other C++ subsystems).
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_jobs_submit(oc_job_fn fn, void* user_data, int lane);
+
+/**
+ * Create a job group
+ */
+oc_job_group_t* oc_job_group_create(void);
+
+/**
+ * Queue a job that the group waits for
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_job_group_submit(oc_job_group_t* group, oc_job_fn fn, void* user_data, int lane);
+
+/**
+ * Wait for every job in the group. The calling thread runs queued jobs
+ * while it waits, so this is safe to call from inside a job.
+ */
+void oc_job_group_wait(oc_job_group_t* group);
+
+/**
+ * Wait for the group's jobs, then destroy it
+ */
+void oc_job_group_destroy(oc_job_group_t* group);
+
+/**
+ * Run fn over [0, count) in chunks of grain items across the workers and
+ * wait for completion. The calling thread takes part.
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_jobs_parallel_for(oc_job_range_fn fn, void* user_data,
+                         size_t count, size_t grain, int lane);
+
+/**
+ * Get the number of job system workers
+ */
+size_t oc_jobs_get_worker_count(void);
+
+/**
+ * Get the number of queued (not yet started) jobs
+ */
+size_t oc_jobs_get_pending(void);
+
+/**
+ * Get job system statistics
+ */
+void oc_jobs_get_stats(uint64_t* submitted, uint64_t* executed,
+                       uint64_t* stolen, uint64_t* executed_by_waiters);
+
+/**
+ * Reset job system statistics
+ */
+void oc_jobs_reset_stats(void);
+
 // ============================================================================
 // PPU JIT Compiler
 // ============================================================================
 
 /**
  * PPU JIT compiler handle
+ *
+ * All oc_ppu_jit_* functions may be called concurrently from any number of
+ * threads on the same handle, except oc_ppu_jit_destroy. Cache lookups
+ * (oc_ppu_jit_get_compiled, oc_ppu_jit_execute) are lock-free on a hit;
+ * compilation and invalidation lock only a shard of the code cache.
  */
 typedef struct oc_ppu_jit_t oc_ppu_jit_t;
 
@@ -57,9 +144,21 @@ int oc_ppu_jit_compile(oc_ppu_jit_t* jit, uint32_t address, const uint8_t* code,
 
 /**
  * Get compiled code for address
+ *
+ * The returned code stays allocated until the JIT is destroyed, even if
+ * the block is invalidated, evicted or the cache is cleared in the meantime.
  */
 void* oc_ppu_jit_get_compiled(oc_ppu_jit_t* jit, uint32_t address);
 
+/**
+ * Check whether address has compiled code, without handing the code out
+ *
+ * Unlike oc_ppu_jit_get_compiled this keeps nothing alive past eviction or
+ * invalidation, so it is the check to use before oc_ppu_jit_execute.
+ * Returns: 1 if compiled, 0 otherwise
+ */
+int oc_ppu_jit_is_compiled(oc_ppu_jit_t* jit, uint32_t address);
+
 /**
  * Invalidate compiled code at address
  */
@@ -70,6 +169,174 @@ void oc_ppu_jit_invalidate(oc_ppu_jit_t* jit, uint32_t address);
  */
 void oc_ppu_jit_clear_cache(oc_ppu_jit_t* jit);
 
+/**
+ * Enable/disable self-modifying code detection (enabled by default)
+ * Compiled blocks in memory registered with oc_mem_track_add_region() are
+ * invalidated when their guest code, the callee code they inlined or the
+ * jump table they dispatch through is written. Disabling stops watching
+ * new blocks; code already watched stays watched.
+ */
+void oc_ppu_jit_smc_enable(oc_ppu_jit_t* jit, int enable);
+int oc_ppu_jit_smc_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Get self-modifying code detection statistics
+ */
+void oc_ppu_jit_smc_get_stats(oc_ppu_jit_t* jit, uint64_t* watched_chunks,
+                              uint64_t* writes_detected, uint64_t* blocks_invalidated);
+
+/**
+ * PPU optimization pass pipelines
+ */
+typedef enum {
+    OC_PPU_PASS_PIPELINE_O0 = 0,
+    OC_PPU_PASS_PIPELINE_O1 = 1,
+    OC_PPU_PASS_PIPELINE_O2 = 2,        // Default
+    OC_PPU_PASS_PIPELINE_O3 = 3,
+    OC_PPU_PASS_PIPELINE_BASELINE = 4   // SROA, early CSE, instcombine, simplifycfg
+} oc_ppu_pass_pipeline_t;
+
+/**
+ * Select the pass pipeline used by subsequent compiles
+ * Returns: 0 on success, -1 unknown pipeline
+ */
+int oc_ppu_jit_set_pass_pipeline(oc_ppu_jit_t* jit, int pipeline);
+int oc_ppu_jit_get_pass_pipeline(oc_ppu_jit_t* jit);
+
+/**
+ * PPU compile corpus file: "OCPPUCRP", uint32 version, uint32 reserved,
+ * then one oc_ppu_corpus_unit_t per compile unit followed by its payload:
+ * instruction_count instruction words, inlined_call_count x 4 words
+ * (first index, count, callee address, return address), then
+ * jump_table_targets case target addresses, then guard_count x 4 words
+ * (instruction index, kind << 8 | register, expected value low, high).
+ */
+typedef struct oc_ppu_corpus_unit_t {
+    uint32_t address;
+    uint32_t end_address;
+    uint32_t instruction_count;
+    uint32_t inlined_call_count;
+    uint32_t jump_table_targets;     // 0 if the unit ends without a jump table
+    uint32_t jump_table_address;
+    uint32_t jump_default_target;
+    uint32_t jump_guard_index;
+    uint8_t jump_index_reg;
+    uint8_t guard_count;             // Speculation guards (oc_ppu_guard_kind_t)
+    uint8_t reserved[2];
+} oc_ppu_corpus_unit_t;
+
+/**
+ * Start writing every unit this JIT compiles (after region formation) to a
+ * corpus file, replacing it. Each address/code combination is written once.
+ * Returns: 0 on success, -1 invalid arguments, -2 already writing,
+ * -3 file error
+ */
+int oc_ppu_jit_corpus_begin(oc_ppu_jit_t* jit, const char* path);
+
+/**
+ * Stop writing the compile corpus
+ */
+void oc_ppu_jit_corpus_end(oc_ppu_jit_t* jit);
+
+/**
+ * Get the number of units written to the compile corpus
+ */
+uint64_t oc_ppu_jit_corpus_get_count(oc_ppu_jit_t* jit);
+
+/**
+ * Measurements of one compile
+ */
+typedef struct oc_ppu_compile_metrics_t {
+    uint32_t guest_instructions;
+    uint32_t native;                  // 1 if host code was generated
+    uint64_t ir_instructions_before;  // Before the pass pipeline
+    uint64_t ir_instructions_after;   // After the pass pipeline
+    uint64_t host_bytes;              // Emitted machine code
+    uint64_t compile_ns;
+} oc_ppu_compile_metrics_t;
+
+/**
+ * Compile a corpus unit with the current pass pipeline and measure it.
+ * The unit is recompiled as recorded (no region formation) and the result
+ * is discarded rather than cached, so a unit can be compiled repeatedly.
+ * payload is the unit's corpus payload.
+ * Returns: 0 if host code was generated, 1 if only the interpreter
+ * placeholder was, -1 invalid arguments
+ */
+int oc_ppu_jit_compile_unit(oc_ppu_jit_t* jit, const oc_ppu_corpus_unit_t* unit,
+                            const uint32_t* payload, oc_ppu_compile_metrics_t* metrics);
+
+/**
+ * Compile a corpus unit with the current pass pipeline to a relocatable
+ * host object defining ppu_block_<address>_<symbol_version>. The object is
+ * copied to out only if it fits in capacity.
+ * Returns: object size in bytes, 0 if no host code could be generated,
+ * -1 invalid arguments
+ */
+int64_t oc_ppu_jit_compile_object(oc_ppu_jit_t* jit, const oc_ppu_corpus_unit_t* unit,
+                                  const uint32_t* payload, uint32_t symbol_version,
+                                  void* out, size_t capacity);
+
+/**
+ * Enable/disable compiling in the compile server (disabled by default)
+ * While oc_compile_server_is_running(), blocks are compiled there and the
+ * returned objects linked into this JIT; without a server, or if a remote
+ * compile fails, blocks are compiled in-process as before.
+ */
+void oc_ppu_jit_remote_compile_enable(oc_ppu_jit_t* jit, int enable);
+int oc_ppu_jit_remote_compile_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Guest instruction classes for code quality statistics
+ */
+typedef enum {
+    OC_PPU_OP_CLASS_INTEGER = 0,      // ALU, compare, rotate/shift
+    OC_PPU_OP_CLASS_LOAD_STORE = 1,   // Integer, FP and vector memory accesses
+    OC_PPU_OP_CLASS_BRANCH = 2,       // Branches and CR logic
+    OC_PPU_OP_CLASS_FLOAT = 3,
+    OC_PPU_OP_CLASS_VECTOR = 4,
+    OC_PPU_OP_CLASS_SYSTEM = 5,       // sc, traps, SPR moves, cache and sync
+    OC_PPU_OP_CLASS_COUNT = 6,
+    OC_PPU_OP_CLASS_ALL = -1
+} oc_ppu_op_class_t;
+
+/**
+ * Quality of emitted code. Host bytes and instructions are measured from
+ * the object ORC links; helper calls and context loads/stores are counted
+ * in the optimized IR.
+ */
+typedef struct oc_ppu_codegen_stats_t {
+    uint64_t blocks;                 // Natively compiled units
+    uint64_t guest_instructions;
+    uint64_t host_instructions;
+    uint64_t host_bytes;
+    uint64_t helper_calls;           // Calls out of generated code
+    uint64_t context_loads;          // Loads from the PPU context
+    uint64_t context_stores;         // Stores to the PPU context
+} oc_ppu_codegen_stats_t;
+
+/**
+ * Get code quality statistics of the natively compiled block at address
+ * Returns: 0 on success, -1 if no natively compiled block is cached there
+ */
+int oc_ppu_jit_get_block_codegen(oc_ppu_jit_t* jit, uint32_t address,
+                                 oc_ppu_codegen_stats_t* stats);
+
+/**
+ * Get code quality statistics accumulated over all native compiles, for one
+ * oc_ppu_op_class_t or OC_PPU_OP_CLASS_ALL. Per-class host figures split each
+ * unit's cost across its guest instructions, so they are apportioned rather
+ * than exact; blocks counts units containing the class.
+ * Returns: 0 on success, -1 invalid arguments
+ */
+int oc_ppu_jit_get_codegen_stats(oc_ppu_jit_t* jit, int op_class,
+                                 oc_ppu_codegen_stats_t* stats);
+
+/**
+ * Reset accumulated code quality statistics
+ */
+void oc_ppu_jit_reset_codegen_stats(oc_ppu_jit_t* jit);
+
 /**
  * Add breakpoint at address
  */
@@ -226,6 +493,121 @@ void oc_ppu_jit_btb_reset_stats(oc_ppu_jit_t* jit);
  */
 void oc_ppu_jit_btb_clear(oc_ppu_jit_t* jit);
 
+// PPU JIT Jump Table APIs
+
+/**
+ * Register guest memory that never changes at runtime (read-only ELF segments)
+ * Jump tables are only recovered from, and leaf calls only inlined from,
+ * registered memory. The data is copied.
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_ppu_jit_add_readonly_region(oc_ppu_jit_t* jit, uint32_t guest_address,
+                                   const uint8_t* data, size_t size);
+
+/**
+ * Forget all registered read-only memory
+ * Blocks already compiled keep their recovered tables.
+ */
+void oc_ppu_jit_clear_readonly_regions(oc_ppu_jit_t* jit);
+
+/**
+ * Get the switch targets recovered for a compiled block
+ * Copies up to max_targets case targets (indexed by case value) and stores
+ * the bounds check target in default_target.
+ * Returns: number of cases, or 0 if the block has no jump table
+ */
+size_t oc_ppu_jit_get_jump_table(oc_ppu_jit_t* jit, uint32_t block_address,
+                                 uint32_t* targets, size_t max_targets,
+                                 uint32_t* default_target);
+
+/**
+ * Get jump table recognition statistics
+ */
+void oc_ppu_jit_jump_table_get_stats(oc_ppu_jit_t* jit, uint64_t* candidates,
+                                     uint64_t* tables_recognized, uint64_t* cases_total);
+
+/**
+ * Reset jump table recognition statistics
+ */
+void oc_ppu_jit_jump_table_reset_stats(oc_ppu_jit_t* jit);
+
+// PPU JIT Leaf Inlining APIs
+
+/**
+ * Enable/disable inlining of small leaf functions at bl sites
+ * Enabled by default. Callees must lie in registered read-only memory.
+ * Invalidating callee code also invalidates every block that inlined it.
+ */
+void oc_ppu_jit_inline_enable(oc_ppu_jit_t* jit, int enable);
+
+/**
+ * Check if leaf inlining is enabled
+ */
+int oc_ppu_jit_inline_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Set the maximum callee size in instructions, not counting blr (default 16)
+ */
+void oc_ppu_jit_inline_set_max_size(oc_ppu_jit_t* jit, size_t max_instructions);
+
+/**
+ * Get leaf inlining statistics
+ */
+void oc_ppu_jit_inline_get_stats(oc_ppu_jit_t* jit, uint64_t* calls_inlined,
+                                 uint64_t* instructions_inlined, uint64_t* calls_rejected);
+
+/**
+ * Reset leaf inlining statistics
+ */
+void oc_ppu_jit_inline_reset_stats(oc_ppu_jit_t* jit);
+
+// PPU JIT Warm Start APIs
+
+/**
+ * Serialize the execution profile (block address, execution count, tier
+ * reached, trace shape) collected this run, hottest first, for reuse on the
+ * next boot of the same title. Keeps the hottest max_entries (0 = all).
+ * The buffer is written only if buffer_size is large enough; call with a
+ * NULL buffer to size it.
+ * Returns: size of the serialized profile in bytes
+ */
+size_t oc_ppu_jit_warm_start_export(oc_ppu_jit_t* jit, uint8_t* buffer, size_t buffer_size,
+                                    size_t max_entries);
+
+/**
+ * Load a profile saved by oc_ppu_jit_warm_start_export as compile seeds
+ * Replaces any seeds not yet submitted.
+ * Returns: number of entries loaded, -1 on invalid arguments,
+ *          -2 on bad magic/version, -3 if the data is truncated
+ */
+int oc_ppu_jit_warm_start_import(oc_ppu_jit_t* jit, const uint8_t* data, size_t size);
+
+/**
+ * Submit up to max_count seeds, hottest first, reading their code from guest
+ * memory. Blocks go to the compile thread pool when it is running (and are
+ * compiled synchronously otherwise), tiered entries are promoted straight to
+ * the tier they reached last run, and trace shapes are re-registered.
+ * Returns: number of seeds submitted
+ */
+size_t oc_ppu_jit_warm_start_submit(oc_ppu_jit_t* jit, const uint8_t* memory_base,
+                                    uint64_t memory_size, size_t max_count);
+
+/**
+ * Get number of seeds not yet submitted
+ */
+size_t oc_ppu_jit_warm_start_pending(oc_ppu_jit_t* jit);
+
+/**
+ * Get warm start statistics
+ */
+void oc_ppu_jit_warm_start_get_stats(oc_ppu_jit_t* jit, uint64_t* entries_exported,
+                                     uint64_t* entries_imported, uint64_t* seeds_submitted);
+
+/**
+ * Drop all loaded seeds and reset statistics
+ */
+void oc_ppu_jit_warm_start_clear(oc_ppu_jit_t* jit);
+
 // PPU JIT Constant Propagation Cache APIs
 
 /**
@@ -409,6 +791,249 @@ void oc_ppu_jit_reg_reset_stats(oc_ppu_jit_t* jit);
  */
 void oc_ppu_jit_reg_clear(oc_ppu_jit_t* jit);
 
+// PPU JIT Stack Slot Promotion APIs
+
+/**
+ * Enable/disable promotion of r1-relative stack slots to SSA values
+ * Enabled by default. Affects blocks compiled afterwards.
+ */
+void oc_ppu_jit_stack_promotion_enable(oc_ppu_jit_t* jit, int enable);
+
+/**
+ * Check if stack slot promotion is enabled
+ */
+int oc_ppu_jit_stack_promotion_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Run the stack frame analysis on an instruction sequence
+ * Slots qualify when r1 only changes by constants (stwu/stdu r1,-N(r1),
+ * addi r1,r1,N), no stack address escapes, and the slot lies in a frame
+ * allocated by the sequence itself.
+ * Returns: 1 if any slot can be promoted, 0 otherwise
+ */
+int oc_ppu_jit_stack_analyze(oc_ppu_jit_t* jit, const uint32_t* instructions,
+                             size_t count, uint32_t* promoted_slots,
+                             uint32_t* promoted_accesses);
+
+/**
+ * Get stack slot promotion statistics
+ */
+void oc_ppu_jit_stack_get_stats(oc_ppu_jit_t* jit, uint64_t* regions_analyzed,
+                                uint64_t* regions_promoted, uint64_t* slots_promoted,
+                                uint64_t* accesses_promoted);
+
+/**
+ * Reset stack slot promotion statistics
+ */
+void oc_ppu_jit_stack_reset_stats(oc_ppu_jit_t* jit);
+
+// PPU JIT VMX Byte Order Folding APIs
+
+/**
+ * Enable or disable lazy VR byte reversal (enabled by default)
+ * When disabled, VRs always stay in guest byte order
+ */
+void oc_ppu_jit_vmx_swap_fold_enable(oc_ppu_jit_t* jit, int enable);
+
+/**
+ * Check if VR byte reversal folding is enabled
+ */
+int oc_ppu_jit_vmx_swap_fold_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Plan VR byte reversals for an instruction sequence without compiling it
+ * Returns the number of VMX instructions; swaps_emitted receives the number
+ * of reversals the emitter would insert, swaps_folded the eager load/store
+ * reversals that were avoided
+ */
+int oc_ppu_jit_vmx_analyze(oc_ppu_jit_t* jit, const uint32_t* instructions,
+                           size_t count, uint32_t* swaps_emitted,
+                           uint32_t* swaps_folded);
+
+/**
+ * Get VMX byte order folding statistics
+ */
+void oc_ppu_jit_vmx_get_stats(oc_ppu_jit_t* jit, uint64_t* regions_analyzed,
+                              uint64_t* vector_instructions, uint64_t* swaps_emitted,
+                              uint64_t* swaps_folded);
+
+/**
+ * Reset VMX byte order folding statistics
+ */
+void oc_ppu_jit_vmx_reset_stats(oc_ppu_jit_t* jit);
+
+// PPU JIT Idiom Recognition APIs
+
+/**
+ * Multi-instruction sequences emitted as a single host operation
+ */
+typedef enum {
+    OC_PPU_IDIOM_CONSTANT = 0,        // li/lis + ori/oris/addi/addis/sldi
+    OC_PPU_IDIOM_ROTATE_MASK = 1,     // rlwinm chains -> one rotate and mask
+    OC_PPU_IDIOM_EXTEND = 2,          // extsb/extsh/extsw/clrldi chains
+    OC_PPU_IDIOM_BYTE_SWAP = 3,       // rotlwi + rlwimi byte reversal -> bswap
+    OC_PPU_IDIOM_COMPARE_BRANCH = 4,  // cmp* + bc ending the region
+    OC_PPU_IDIOM_COUNT = 5
+} oc_ppu_idiom_t;
+
+/**
+ * Enable or disable idiom recognition (enabled by default)
+ * When disabled, every instruction is emitted on its own
+ */
+void oc_ppu_jit_idioms_enable(oc_ppu_jit_t* jit, int enable);
+
+/**
+ * Check if idiom recognition is enabled
+ */
+int oc_ppu_jit_idioms_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Recognize idioms in an instruction sequence without compiling it
+ * Returns the number of instructions covered by idioms; counts (may be NULL)
+ * receives OC_PPU_IDIOM_COUNT per-kind idiom counts
+ */
+int oc_ppu_jit_idioms_analyze(oc_ppu_jit_t* jit, const uint32_t* instructions,
+                              size_t count, uint32_t* counts);
+
+/**
+ * Get idiom recognition statistics
+ * idioms (may be NULL) receives OC_PPU_IDIOM_COUNT per-kind totals
+ */
+void oc_ppu_jit_idioms_get_stats(oc_ppu_jit_t* jit, uint64_t* regions,
+                                 uint64_t* idioms, uint64_t* instructions_fused);
+
+/**
+ * Reset idiom recognition statistics
+ */
+void oc_ppu_jit_idioms_reset_stats(oc_ppu_jit_t* jit);
+
+// PPU JIT Speculation and Deoptimization APIs
+
+/**
+ * Speculations a region can be compiled with, each checked by a guard that
+ * exits with OC_PPU_EXIT_DEOPT when it does not hold
+ */
+typedef enum {
+    OC_PPU_GUARD_REGISTER_VALUE = 0,  // A GPR holds its profiled constant at region entry
+    OC_PPU_GUARD_BRANCH_TARGET = 1,   // The closing bcctr goes to its BTB target
+    OC_PPU_GUARD_KIND_COUNT = 2
+} oc_ppu_guard_kind_t;
+
+/** oc_ppu_guard_info_t::materialized flags for special registers */
+#define OC_PPU_DEOPT_CR           0x01u
+#define OC_PPU_DEOPT_LR           0x02u
+#define OC_PPU_DEOPT_CTR          0x04u
+#define OC_PPU_DEOPT_XER          0x08u
+#define OC_PPU_DEOPT_VSCR         0x10u
+#define OC_PPU_DEOPT_STACK_SLOTS  0x20u  // Promoted stack slots written back to memory
+
+/**
+ * One guard of a compiled region and the guest state its side exit writes
+ * to the context: every register the region changed before the guard.
+ * The state masks are zero until the region was compiled in-process.
+ */
+typedef struct oc_ppu_guard_info_t {
+    int32_t kind;              // oc_ppu_guard_kind_t
+    uint32_t reg;              // GPR for OC_PPU_GUARD_REGISTER_VALUE
+    uint32_t guest_pc;         // Resume address after a failure
+    uint32_t instruction_index;
+    uint64_t expected;         // Speculated value or branch target
+    uint32_t gprs;             // Bitmasks of registers stored on exit
+    uint32_t fprs;
+    uint32_t vrs;
+    uint32_t materialized;     // OC_PPU_DEOPT_* flags
+} oc_ppu_guard_info_t;
+
+/**
+ * Enable or disable speculation (enabled by default). Affects regions
+ * compiled afterwards.
+ */
+void oc_ppu_jit_speculation_enable(oc_ppu_jit_t* jit, int enable);
+
+/**
+ * Check if speculation is enabled
+ */
+int oc_ppu_jit_speculation_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Set how many times a guard may fail before its region is invalidated and
+ * compiled again without that speculation (default 8, minimum 1)
+ */
+void oc_ppu_jit_deopt_set_threshold(oc_ppu_jit_t* jit, uint32_t failures);
+
+/**
+ * Get the guard failure threshold
+ */
+uint32_t oc_ppu_jit_deopt_get_threshold(oc_ppu_jit_t* jit);
+
+/**
+ * Get the guards of a compiled region; fills up to capacity entries
+ * Returns: the number of guards, -1 if the region is not compiled
+ */
+int oc_ppu_jit_get_guards(oc_ppu_jit_t* jit, uint32_t address,
+                          oc_ppu_guard_info_t* guards, size_t capacity);
+
+/**
+ * Get speculation statistics
+ * guards: guards placed in compiled regions; deopts: side exits taken;
+ * speculations_dropped: speculations removed after repeated failures
+ */
+void oc_ppu_jit_deopt_get_stats(oc_ppu_jit_t* jit, uint64_t* guards, uint64_t* deopts,
+                                uint64_t* speculations_dropped);
+
+/**
+ * Reset speculation statistics (failure counts and dropped speculations
+ * are kept)
+ */
+void oc_ppu_jit_deopt_reset_stats(oc_ppu_jit_t* jit);
+
+// PPU JIT On-Stack Replacement APIs
+
+/**
+ * Enable or disable on-stack replacement (enabled by default). Regions
+ * ending in a back-edge compiled while it is enabled check at the back-edge
+ * whether their tier-2 loop is ready and continue in it. oc_ppu_jit_execute
+ * upgrades such a region once enough of its runs ended on the back-edge.
+ * With the budget disabled, a tier-2 loop still returns at its header every
+ * 65536 iterations.
+ */
+void oc_ppu_jit_osr_enable(oc_ppu_jit_t* jit, int enable);
+
+/**
+ * Check if on-stack replacement is enabled
+ */
+int oc_ppu_jit_osr_is_enabled(oc_ppu_jit_t* jit);
+
+/**
+ * Get the loop header a compiled region's closing back-edge returns to
+ * Returns: the header's guest address, 0 if the region is not compiled or
+ *          has no upgrade check
+ */
+uint32_t oc_ppu_jit_osr_get_loop_header(oc_ppu_jit_t* jit, uint32_t address);
+
+/**
+ * Compile the tier-2 loop of the region at address, entered at its loop
+ * header with the guest state in the context, and make it ready for the
+ * region's back-edge. Promoting an entry to tier 2 with
+ * oc_ppu_jit_tiered_promote does this for the region at the same address.
+ * Returns: 1 if the loop is ready, 0 if the region has no loop header,
+ *          -1 if the region is not compiled, -2 if compilation failed
+ */
+int oc_ppu_jit_osr_upgrade(oc_ppu_jit_t* jit, uint32_t address);
+
+/**
+ * Get on-stack replacement statistics
+ * loop_regions: regions compiled with a back-edge check; upgrades: tier-2
+ * loops made ready; upgrade_failures: tier-2 loops that failed to compile
+ */
+void oc_ppu_jit_osr_get_stats(oc_ppu_jit_t* jit, uint64_t* loop_regions, uint64_t* upgrades,
+                              uint64_t* upgrade_failures);
+
+/**
+ * Reset on-stack replacement statistics
+ */
+void oc_ppu_jit_osr_reset_stats(oc_ppu_jit_t* jit);
+
 // PPU JIT Lazy Compilation APIs
 
 /**
@@ -569,6 +1194,8 @@ int oc_ppu_jit_tiered_get_tier(oc_ppu_jit_t* jit, uint32_t address);
 /**
  * Promote code to specified tier
  * target_tier: 1=Baseline, 2=Optimizing
+ * Promoting to tier 2 also upgrades a compiled region ending in a loop at
+ * the same address (see oc_ppu_jit_osr_upgrade)
  * Returns: 1 if successful, 0 if failed
  */
 int oc_ppu_jit_tiered_promote(oc_ppu_jit_t* jit, uint32_t address, int target_tier);
@@ -848,7 +1475,8 @@ typedef struct oc_ppu_context_t {
     uint32_t instructions_executed;
     
     // Execution result/status
-    // 0 = normal, 1 = branch, 2 = syscall, 3 = breakpoint, 4 = error
+    // 0 = normal, 1 = branch, 2 = syscall, 3 = breakpoint, 4 = error, 5 = preempted,
+    // 6 = deoptimized
     int32_t exit_reason;
     
     // Memory base pointer (set before execution)
@@ -856,6 +1484,21 @@ typedef struct oc_ppu_context_t {
     
     // Memory size (for bounds checking in debug builds)
     uint64_t memory_size;
+    
+    // Remaining guest instructions in the current time slice. Compiled code
+    // charges each region's instruction count on entry and exits with
+    // OC_PPU_EXIT_PREEMPTED once it is used up. Only enforced when
+    // budget_enabled is non-zero.
+    int64_t instruction_budget;
+    uint32_t budget_enabled;
+    
+    // Set asynchronously (e.g. by the scheduler) to request an exit with
+    // OC_PPU_EXIT_PREEMPTED at the next region entry or loop back-edge
+    volatile uint32_t interrupt_pending;
+    
+    // Index of the failed guard in its region when exit_reason is
+    // OC_PPU_EXIT_DEOPT
+    uint32_t deopt_guard;
 } oc_ppu_context_t;
 
 /**
@@ -866,7 +1509,10 @@ typedef enum {
     OC_PPU_EXIT_BRANCH = 1,      // Block ended with branch
     OC_PPU_EXIT_SYSCALL = 2,     // System call encountered
     OC_PPU_EXIT_BREAKPOINT = 3,  // Breakpoint hit
-    OC_PPU_EXIT_ERROR = 4        // Execution error
+    OC_PPU_EXIT_ERROR = 4,       // Execution error
+    OC_PPU_EXIT_PREEMPTED = 5,   // Budget exhausted or interrupt pending; next_pc is the resume point
+    OC_PPU_EXIT_DEOPT = 6        // A speculation guard failed; guest state is materialized up to
+                                 // next_pc, where the interpreter resumes
 } oc_ppu_exit_reason_t;
 
 /**
@@ -1052,7 +1698,7 @@ typedef struct oc_spu_context_t {
     uint32_t instructions_executed;
     
     // Execution result/status
-    // 0 = normal, 1 = branch, 2 = stop, 3 = breakpoint, 4 = error
+    // 0 = normal, 1 = branch, 2 = stop, 3 = breakpoint, 4 = error, 5 = preempted
     int32_t exit_reason;
     
     // Local Store base pointer (256KB SPU local memory)
@@ -1072,8 +1718,68 @@ typedef struct oc_spu_context_t {
     
     // Padding for alignment
     uint8_t _padding[3];
+    
+    // Remaining guest instructions in the current time slice, as
+    // oc_ppu_context_t::instruction_budget. Charged per block by
+    // oc_spu_jit_execute, which also checks interrupt_pending; compiled
+    // SPU code has no preemption check of its own.
+    int64_t instruction_budget;
+    uint32_t budget_enabled;
+    
+    // Set asynchronously to request an exit with OC_SPU_EXIT_PREEMPTED
+    volatile uint32_t interrupt_pending;
+    
+    // Channel state used by the inline rdch/wrch fast paths. Compiled code
+    // reads and writes these directly and only calls the channel callbacks
+    // when a channel would block, i.e. its channel_count entry is zero.
+    uint32_t event_mask;        // SPU_WrEventMask / SPU_RdEventMask
+    uint32_t event_stat;        // Pending events, maintained by the runtime
+    uint32_t srr0;              // SPU_WrSRR0 / SPU_RdSRR0
+    uint32_t signal_notify[2];  // SPU_RdSigNotify1/2, valid while their count is non-zero
+    uint32_t mfc_lsa;           // MFC_LSA
+    uint32_t mfc_eah;           // MFC_EAH
+    uint32_t mfc_eal;           // MFC_EAL
+    uint32_t mfc_size;          // MFC_Size
+    uint32_t mfc_tag_id;        // MFC_TagID
+    uint32_t mfc_tag_status;    // MFC_RdTagStat, valid while its count is non-zero
+    uint32_t mfc_atomic_stat;   // MFC_RdAtomicStat, valid while its count is non-zero
+    uint32_t out_mbox;          // SPU_WrOutMbox, drained by the runtime when its count is zero
 } oc_spu_context_t;
 
+/**
+ * SPU channel numbers as encoded in rdch/wrch/rchcnt
+ */
+typedef enum {
+    OC_SPU_CH_RD_EVENT_STAT = 0,
+    OC_SPU_CH_WR_EVENT_MASK = 1,
+    OC_SPU_CH_WR_EVENT_ACK = 2,
+    OC_SPU_CH_RD_SIG_NOTIFY1 = 3,
+    OC_SPU_CH_RD_SIG_NOTIFY2 = 4,
+    OC_SPU_CH_WR_DEC = 7,
+    OC_SPU_CH_RD_DEC = 8,
+    OC_SPU_CH_WR_MS_SYNC_REQ = 9,
+    OC_SPU_CH_RD_EVENT_MASK = 11,
+    OC_SPU_CH_RD_TAG_MASK = 12,
+    OC_SPU_CH_RD_MACH_STAT = 13,
+    OC_SPU_CH_WR_SRR0 = 14,
+    OC_SPU_CH_RD_SRR0 = 15,
+    OC_SPU_CH_MFC_LSA = 16,
+    OC_SPU_CH_MFC_EAH = 17,
+    OC_SPU_CH_MFC_EAL = 18,
+    OC_SPU_CH_MFC_SIZE = 19,
+    OC_SPU_CH_MFC_TAG_ID = 20,
+    OC_SPU_CH_MFC_CMD = 21,
+    OC_SPU_CH_WR_TAG_MASK = 22,
+    OC_SPU_CH_WR_TAG_UPDATE = 23,
+    OC_SPU_CH_RD_TAG_STAT = 24,
+    OC_SPU_CH_RD_LIST_STALL_STAT = 25,
+    OC_SPU_CH_WR_LIST_STALL_ACK = 26,
+    OC_SPU_CH_RD_ATOMIC_STAT = 27,
+    OC_SPU_CH_WR_OUT_MBOX = 28,
+    OC_SPU_CH_RD_IN_MBOX = 29,
+    OC_SPU_CH_WR_OUT_INTR_MBOX = 30
+} oc_spu_channel_t;
+
 /**
  * SPU exit reason codes
  */
@@ -1082,7 +1788,8 @@ typedef enum {
     OC_SPU_EXIT_BRANCH = 1,      // Block ended with branch
     OC_SPU_EXIT_STOP = 2,        // Stop instruction encountered
     OC_SPU_EXIT_BREAKPOINT = 3,  // Breakpoint hit
-    OC_SPU_EXIT_ERROR = 4        // Execution error
+    OC_SPU_EXIT_ERROR = 4,       // Execution error
+    OC_SPU_EXIT_PREEMPTED = 5    // Budget exhausted or interrupt pending; next_pc is the resume point
 } oc_spu_exit_reason_t;
 
 /**
@@ -1105,6 +1812,20 @@ void oc_spu_jit_destroy(oc_spu_jit_t* jit);
  */
 int oc_spu_jit_compile(oc_spu_jit_t* jit, uint32_t address, const uint8_t* code, size_t size);
 
+/**
+ * Print the LLVM IR of an SPU block without compiling or caching it
+ *
+ * The block at address is built from code into a scratch module, with the
+ * channel callbacks currently set, and the verified, unoptimized module is
+ * written to buffer (NUL-terminated, truncated to buffer_size). Compiled SPU
+ * blocks are not linked to native code yet, so this is how the code
+ * generator is inspected.
+ * Returns: length of the full IR text, -1 on invalid arguments, -2 without
+ * LLVM, -3 if the IR fails verification
+ */
+int oc_spu_jit_emit_ir(oc_spu_jit_t* jit, uint32_t address, const uint8_t* code, size_t size,
+                       char* buffer, size_t buffer_size);
+
 /**
  * Get compiled code for address
  */
@@ -1160,6 +1881,15 @@ void oc_spu_jit_set_channel_callbacks(oc_spu_jit_t* jit,
                                        void* read_callback,
                                        void* write_callback);
 
+/**
+ * Set the rchcnt callback, uint32_t (*)(oc_spu_context_t*, uint8_t channel),
+ * for channels whose count the runtime owns (those
+ * oc_spu_jit_channel_fast_path reports 0 for in both directions). Without
+ * one, rchcnt of such a channel reads channel_count from the context.
+ * Takes effect for blocks compiled afterwards.
+ */
+void oc_spu_jit_set_channel_count_callback(oc_spu_jit_t* jit, void* count_callback);
+
 /**
  * Get number of registered channel operations
  */
@@ -1411,6 +2141,14 @@ void oc_spu_jit_reset_channel_stats(oc_spu_jit_t* jit);
  */
 void oc_spu_jit_set_channel_blocking_callback(oc_spu_jit_t* jit, void* callback);
 
+/**
+ * Get how compiled code accesses a channel
+ * Returns 0 if every access calls the channel callback, 1 if it is a plain
+ * load/store on the context, 2 if it is inlined and only calls the callback
+ * when the channel would block
+ */
+int oc_spu_jit_channel_fast_path(uint8_t channel, int is_write);
+
 // SPU JIT Enhanced MFC DMA APIs
 
 /**
@@ -1614,6 +2352,13 @@ int oc_rsx_shader_compile_fragment(oc_rsx_shader_t* shader, const uint32_t* code
  */
 void oc_rsx_shader_free_spirv(uint32_t* spirv);
 
+/**
+ * Enable/disable translating programs in the compile server (disabled by
+ * default). Falls back to in-process translation without a server.
+ */
+void oc_rsx_shader_remote_compile_enable(oc_rsx_shader_t* shader, int enable);
+int oc_rsx_shader_remote_compile_is_enabled(oc_rsx_shader_t* shader);
+
 // RSX Shader Linking APIs
 
 /**
@@ -1673,6 +2418,108 @@ size_t oc_rsx_shader_get_vertex_cache_count(oc_rsx_shader_t* shader);
  */
 size_t oc_rsx_shader_get_fragment_cache_count(oc_rsx_shader_t* shader);
 
+// RSX Shader Corpus APIs
+
+/**
+ * Pipeline record in a shader corpus (pipelines.bin)
+ */
+typedef struct oc_rsx_corpus_pipeline_t {
+    uint64_t vs_hash;
+    uint64_t fs_hash;
+    uint32_t vertex_mask;
+    uint8_t cull_mode;
+    uint8_t blend_enable;
+    uint8_t reserved[2];
+} oc_rsx_corpus_pipeline_t;
+
+/**
+ * Start dumping every unique VP/FP microcode blob (vp_<hash>.bin,
+ * fp_<hash>.bin) and pipeline state (pipelines.bin) to an existing
+ * directory. Appends to a corpus already in the directory.
+ * Returns: 0 on success, -1 invalid arguments, -2 already dumping or
+ * directory not writable
+ */
+int oc_rsx_shader_corpus_begin(oc_rsx_shader_t* shader, const char* dir);
+
+/**
+ * Stop dumping the shader corpus
+ */
+void oc_rsx_shader_corpus_end(oc_rsx_shader_t* shader);
+
+/**
+ * Get the number of shaders and pipelines written to the corpus
+ */
+void oc_rsx_shader_corpus_get_stats(oc_rsx_shader_t* shader, uint64_t* vertex_programs,
+                                     uint64_t* fragment_programs, uint64_t* pipelines);
+
+// RSX Constant File APIs
+
+/**
+ * RSX constant files
+ */
+typedef enum {
+    OC_RSX_CONST_VERTEX = 0,    // 468 transform constants
+    OC_RSX_CONST_FRAGMENT = 1,  // 512 fragment constant slots
+} oc_rsx_const_file_t;
+
+/**
+ * Constant upload range (in vec4 constants)
+ */
+typedef struct {
+    uint32_t first;
+    uint32_t count;
+} oc_rsx_const_range_t;
+
+/**
+ * Get the number of vec4 constants in a constant file
+ */
+uint32_t oc_rsx_constants_get_count(oc_rsx_shader_t* shader, int file);
+
+/**
+ * Mirror guest constant writes (count vec4 constants from data)
+ * Returns: 0 on success, -1 on invalid arguments, -2 if out of range
+ */
+int oc_rsx_constants_write(oc_rsx_shader_t* shader, int file, uint32_t first,
+                           const float* data, uint32_t count);
+
+/**
+ * Read back mirrored guest constants
+ * Returns: 0 on success, -1 on invalid arguments, -2 if out of range
+ */
+int oc_rsx_constants_read(oc_rsx_shader_t* shader, int file, uint32_t first,
+                          float* data, uint32_t count);
+
+/**
+ * At draw time, compute the constant ranges that changed since the last flush.
+ * Nearby ranges are merged, and overflow past max_ranges folds into the last
+ * range. out_hash receives a content hash of the whole constant file.
+ * Returns: 0 if nothing changed, 1 if ranges were emitted, 2 if ranges were
+ *          emitted and the file now matches a previously flushed one (a
+ *          backend that keeps buffers per hash may rebind instead of
+ *          uploading), -1 on invalid arguments
+ */
+int oc_rsx_constants_flush(oc_rsx_shader_t* shader, int file,
+                           oc_rsx_const_range_t* ranges, size_t max_ranges,
+                           size_t* out_count, uint64_t* out_hash);
+
+/**
+ * Make the next flush upload the whole constant file
+ */
+void oc_rsx_constants_invalidate(oc_rsx_shader_t* shader, int file);
+
+/**
+ * Get constant file statistics
+ */
+void oc_rsx_constants_get_stats(oc_rsx_shader_t* shader, int file,
+                                uint64_t* writes, uint64_t* flushes,
+                                uint64_t* clean_flushes, uint64_t* reused_flushes,
+                                uint64_t* ranges_emitted, uint64_t* constants_uploaded);
+
+/**
+ * Reset constant file statistics
+ */
+void oc_rsx_constants_reset_stats(oc_rsx_shader_t* shader, int file);
+
 // ============================================================================
 // Atomics (mutex-guarded on non-x86_64 platforms)
 // ============================================================================
@@ -1749,17 +2596,623 @@ void oc_dma_get_stats(uint64_t* gets, uint64_t* puts,
                       uint64_t* fences, uint64_t* barriers);
 
 /**
- * Reset DMA statistics and clear all pending transfers.
+ * Reset DMA statistics, prefetch stream state and clear all pending transfers.
  */
 void oc_dma_reset_stats(void);
 
+/**
+ * Enable or disable predictive prefetching of constant-stride GET streams
+ * (enabled by default). Streams are tracked per tag of the SPU set with
+ * oc_dma_heatmap_set_current_spu, or per tag of the calling thread if none.
+ */
+void oc_dma_prefetch_enable(int enable);
+
+/**
+ * Check if predictive GET prefetching is enabled
+ */
+int oc_dma_prefetch_is_enabled(void);
+
+/**
+ * Report a GET performed outside the C++ DMA paths, once its data has moved,
+ * and prefetch the stream's predicted next chunk. main_memory is the base the
+ * 32-bit EA is an offset into.
+ * spu_id: issuing SPU, or -1 for the calling thread's current SPU
+ */
+void oc_dma_prefetch_observe(int spu_id, uint16_t tag, uint64_t ea, uint32_t size,
+                             const void* main_memory);
+
+/**
+ * Get prefetch statistics.
+ * hits/misses count GETs that did or did not match the predicted next chunk.
+ */
+void oc_dma_prefetch_get_stats(uint64_t* predictions, uint64_t* hits,
+                               uint64_t* misses, uint64_t* bytes_prefetched);
+
+// ============================================================================
+// DMA Bandwidth Heatmap
+// ============================================================================
+
+/** Per-SPU slots in a heatmap snapshot */
+#define OC_DMA_HEATMAP_SPUS 8
+
+/** Size histogram classes: class N counts transfers of [2^N, 2^(N+1)) bytes */
+#define OC_DMA_HEATMAP_SIZE_CLASSES 15
+
+/** EA bucket granularity (64KB) */
+#define OC_DMA_HEATMAP_BUCKET_SHIFT 16
+
+/**
+ * Aggregated DMA traffic for one SPU, tag or EA bucket.
+ * stall_ns is the time the issuer waited for its transfers: the copy time of
+ * synchronous oc_dma_* transfers, and queue-to-completion time for commands
+ * queued on an SPU JIT's MFC.
+ */
+typedef struct {
+    uint64_t bytes_in;    // GET bytes (EA -> LS)
+    uint64_t bytes_out;   // PUT bytes (LS -> EA)
+    uint64_t gets;
+    uint64_t puts;
+    uint64_t stall_ns;
+} oc_dma_traffic_t;
+
+/**
+ * Traffic for one 64KB EA bucket (EA range [bucket << 16, (bucket + 1) << 16))
+ */
+typedef struct {
+    uint32_t bucket;
+    uint32_t reserved;
+    oc_dma_traffic_t traffic;
+} oc_dma_bucket_t;
+
+/**
+ * Heatmap snapshot totals
+ */
+typedef struct {
+    oc_dma_traffic_t spus[OC_DMA_HEATMAP_SPUS];
+    oc_dma_traffic_t tags[32];
+    uint64_t size_histogram[OC_DMA_HEATMAP_SIZE_CLASSES];
+    uint64_t unattributed_ops;   // Transfers issued with no current SPU
+} oc_dma_heatmap_t;
+
+/**
+ * Enable or disable heatmap instrumentation (disabled by default).
+ * When enabled, transfers from oc_dma_transfer, oc_dma_list_transfer and
+ * completed SPU JIT MFC commands are recorded.
+ */
+void oc_dma_heatmap_enable(int enable);
+
+/**
+ * Check if heatmap instrumentation is enabled
+ */
+int oc_dma_heatmap_is_enabled(void);
+
+/**
+ * Set the SPU that the calling thread issues DMA for (-1 for none).
+ * SPU threads call this once before running guest code. Used to attribute
+ * heatmap traffic and to keep the prefetcher's streams per SPU.
+ */
+void oc_dma_heatmap_set_current_spu(int spu_id);
+
+/**
+ * Record a transfer performed outside the C++ DMA paths.
+ * spu_id: issuing SPU, or -1 for the calling thread's current SPU
+ */
+void oc_dma_heatmap_record(int spu_id, uint16_t tag, uint64_t ea, uint32_t size,
+                           int is_put, uint64_t stall_ns);
+
+/**
+ * Take a heatmap snapshot.
+ * out: per-SPU, per-tag and size histogram totals (may be NULL)
+ * buckets: receives up to max_buckets EA buckets, hottest (most bytes) first
+ * Returns: total number of EA buckets with traffic
+ */
+size_t oc_dma_heatmap_snapshot(oc_dma_heatmap_t* out,
+                               oc_dma_bucket_t* buckets, size_t max_buckets);
+
+/**
+ * Clear all heatmap counters
+ */
+void oc_dma_heatmap_reset(void);
+
+// ============================================================================
+// SPU Local Store Backing
+// ============================================================================
+
+/**
+ * Create a fixed 256KB local store window for one SPU.
+ * base: receives the window address, which stays valid until the window is
+ * destroyed and is what oc_spu_context_t::local_storage should point at.
+ * While no image is attached the window is not accessible.
+ * Returns: window id, or negative on error
+ */
+int oc_spu_ls_window_create(void** base);
+
+/**
+ * Detach the current image and release a window.
+ * Returns: 0 on success, negative on error
+ */
+int oc_spu_ls_window_destroy(int window);
+
+/**
+ * Create a local store image in its own memfd region.
+ * data/size: initial contents (may be NULL), the rest is zero
+ * Returns: image id, or negative on error
+ */
+int oc_spu_ls_image_create(const uint8_t* data, size_t size);
+
+/**
+ * Create an image holding source's current contents.
+ * A clone of a sealed image (see oc_spu_ls_image_seal) maps the template
+ * privately, so pages are shared until either side writes them; a clone of
+ * any other image is a 256KB copy. Either way the clone is a snapshot: later
+ * changes to source never show through.
+ * Returns: image id, or negative on error
+ */
+int oc_spu_ls_image_clone(int source);
+
+/**
+ * Make an image a read-only template for zero-copy clones, e.g. a SPURS task
+ * binary. With memfd support the contents are sealed with F_SEAL_WRITE; a
+ * sealed image attached to a window is mapped read-only. Sealing is
+ * permanent.
+ * Returns: 0 on success, -2 if the image is attached, -3 if sealing failed,
+ * other negative on error
+ */
+int oc_spu_ls_image_seal(int image);
+
+/**
+ * Destroy an image. An attached image is detached first; its window is left
+ * reserved and empty.
+ * Returns: 0 on success, -3 if the window could not be emptied, other
+ * negative on error
+ */
+int oc_spu_ls_image_destroy(int image);
+
+/**
+ * Switch a window to an image. The previously attached image keeps its
+ * contents. With memfd support this remaps the window and copies nothing.
+ * Returns: 0 on success, -2 if the image is attached to another window,
+ * other negative on error
+ */
+int oc_spu_ls_attach(int window, int image);
+
+/**
+ * Detach the current image from a window.
+ */
+int oc_spu_ls_detach(int window);
+
+/**
+ * Get the image attached to a window, or -1
+ */
+int oc_spu_ls_get_attached(int window);
+
+/**
+ * Check whether local store switching is done by remapping (1) or by
+ * copying (0, platforms without memfd)
+ */
+int oc_spu_ls_is_zero_copy(void);
+
+/**
+ * Get local store switching statistics.
+ */
+void oc_spu_ls_get_stats(uint64_t* switches, uint64_t* remapped_switches,
+                         uint64_t* bytes_copied, uint64_t* cow_clones);
+
+/**
+ * Reset local store switching statistics.
+ */
+void oc_spu_ls_reset_stats(void);
+
+// ============================================================================
+// Guest Memory Write Tracking
+// ============================================================================
+
+/** Region flag: detect writes by write-protecting armed pages */
+#define OC_MEM_TRACK_PROTECT 0x1
+
+/**
+ * Subscription callback.
+ * sub: subscription id; addr: guest address of the written 4KB page
+ */
+typedef void (*oc_mem_track_callback)(void* user_data, int sub, uint32_t addr);
+
+/**
+ * Track writes to a guest memory range (4KB aligned) at 4KB granularity.
+ * host_base: host mapping of guest_base; required with OC_MEM_TRACK_PROTECT,
+ * in which case armed pages are write-protected and writes are caught by a
+ * fault handler. Without it only oc_mem_track_mark_written() reports writes.
+ * Pages start clean and unarmed; with OC_MEM_TRACK_PROTECT a page's writes
+ * are only seen once a subscription or collect has armed it.
+ * Returns: region id, -1 invalid arguments, -2 overlaps a region,
+ * -3 protection not supported, -4 no free region
+ */
+int oc_mem_track_add_region(uint32_t guest_base, uint64_t size, void* host_base, int flags);
+
+/**
+ * Stop tracking a region and restore write access to it.
+ */
+int oc_mem_track_remove_region(int region);
+
+/**
+ * Report a write to guest memory. The emulator reports every write made
+ * through its memory manager (interpreter stores, HLE, loaders); stores
+ * from JIT code are only seen in OC_MEM_TRACK_PROTECT regions.
+ * Cheap for pages already written since they were last armed.
+ */
+void oc_mem_track_mark_written(uint32_t addr, uint32_t size);
+
+/**
+ * Get the write generation of the page containing addr (0 if untracked).
+ */
+uint32_t oc_mem_track_get_page_generation(uint32_t addr);
+
+/**
+ * Collect and clear the dirty bits of a range, one bit per 4KB page starting
+ * at the page containing addr. The collected pages are armed again.
+ * Returns: number of dirty pages
+ */
+size_t oc_mem_track_collect_dirty(uint32_t addr, uint32_t size,
+                                  uint64_t* bitmap, size_t bitmap_words);
+
+/**
+ * Subscribe to writes to a range and arm its pages. The subscription's
+ * generation is bumped on the first write to each armed page; callback
+ * (may be NULL) is then invoked, deferred to oc_mem_track_dispatch() when
+ * the write was caught by a fault.
+ * Returns: subscription id, or negative on error
+ */
+int oc_mem_track_subscribe(uint32_t addr, uint32_t size,
+                           oc_mem_track_callback callback, void* user_data);
+
+/**
+ * Remove a subscription. Waits for callbacks already running on other
+ * threads, so the callback is not running and will not run once this
+ * returns. May be called from the subscription's own callback.
+ */
+void oc_mem_track_unsubscribe(int sub);
+
+/**
+ * Get a subscription's generation. A cache entry that recorded this value
+ * is valid while it is unchanged.
+ */
+uint64_t oc_mem_track_get_generation(int sub);
+
+/**
+ * Re-arm a subscription's pages after revalidating, so the next write is
+ * reported again.
+ * Returns: the generation to record
+ */
+uint64_t oc_mem_track_rearm(int sub);
+
+/**
+ * Run callbacks deferred from write faults.
+ * Returns: number of callbacks invoked
+ */
+size_t oc_mem_track_dispatch(void);
+
+/**
+ * Check whether OC_MEM_TRACK_PROTECT is supported on this host.
+ */
+int oc_mem_track_is_protect_supported(void);
+
+/**
+ * Get write tracking statistics.
+ */
+void oc_mem_track_get_stats(uint64_t* marks, uint64_t* faults,
+                            uint64_t* notifications, uint64_t* rearms);
+
+/**
+ * Reset write tracking statistics.
+ */
+void oc_mem_track_reset_stats(void);
+
+// ============================================================================
+// Cache Memory Budget
+// ============================================================================
+
+/**
+ * Lookup count callback: total lookups the cache has served so far.
+ * Called from any thread; must only read counters.
+ */
+typedef uint64_t (*oc_mem_budget_lookups_fn)(void* user_data);
+
+/**
+ * Register a cache with the runtime-wide memory budget. The budget limit is
+ * split into per-cache targets; a cache evicts down to
+ * oc_mem_budget_get_target() before it inserts. lookups (may be NULL) lets
+ * the budget weigh refetches against the cache's traffic.
+ * There is no practical limit on the number of clients.
+ * Returns: client id, -1 invalid arguments, -2 no free client slot
+ */
+int oc_mem_budget_register(const char* name, oc_mem_budget_lookups_fn lookups, void* user_data);
+
+/**
+ * Unregister a cache; its remaining bytes are released
+ */
+void oc_mem_budget_unregister(int client);
+
+/**
+ * Charge an entry the cache inserted. If key was evicted by this cache
+ * recently, the insert counts as a refetch: a miss more memory would have
+ * avoided.
+ */
+void oc_mem_budget_insert(int client, uint64_t key, uint64_t bytes);
+
+/**
+ * Release an entry evicted to stay within the target; key is remembered to
+ * detect refetches
+ */
+void oc_mem_budget_evict(int client, uint64_t key, uint64_t bytes);
+
+/**
+ * Release bytes dropped for any other reason (invalidation, clear)
+ */
+void oc_mem_budget_release(int client, uint64_t bytes);
+
+/**
+ * Get the number of bytes a cache may hold
+ */
+uint64_t oc_mem_budget_get_target(int client);
+
+/**
+ * Memory available to this process: the tightest cgroup memory.max /
+ * memory.high (v2) or memory.limit_in_bytes (v1) on its path, else
+ * physical memory
+ */
+uint64_t oc_mem_budget_detect_host_limit(void);
+
+/**
+ * Set the total bytes all registered caches may hold. 0 selects a quarter
+ * of oc_mem_budget_detect_host_limit().
+ */
+void oc_mem_budget_set_limit(uint64_t bytes);
+
+/**
+ * Get the total budget in bytes
+ */
+uint64_t oc_mem_budget_get_limit(void);
+
+/**
+ * Get the bytes currently held by all registered caches
+ */
+uint64_t oc_mem_budget_get_usage(void);
+
+/**
+ * Recompute per-cache targets now. This also happens on its own when caches
+ * insert, at most every few milliseconds.
+ */
+void oc_mem_budget_rebalance(void);
+
+/**
+ * Per-cache budget statistics
+ */
+typedef struct oc_mem_budget_client_stats_t {
+    char name[32];
+    uint64_t bytes;
+    uint64_t target;
+    uint64_t lookups;
+    uint64_t evictions;
+    uint64_t evicted_bytes;
+    uint64_t refetches;
+    double marginal_benefit;   // Smoothed refetches per lookup
+} oc_mem_budget_client_stats_t;
+
+/**
+ * Get statistics of up to max_clients registered caches
+ * Returns: number of entries written, or with stats NULL the number of
+ * registered caches
+ */
+size_t oc_mem_budget_get_clients(oc_mem_budget_client_stats_t* stats, size_t max_clients);
+
+// ============================================================================
+// Out-of-Process Compile Server
+// ============================================================================
+
+/**
+ * Compilation can run in a helper process (oc_compile_server) so LLVM's
+ * transient allocations stay out of the emulator heap and an optimizer
+ * crash only loses the helper. The emulator and the helper share a memfd
+ * of fixed message slots; requests and results are copied through them
+ * and waits use futexes. Linux only.
+ */
+
+/** Largest request or response that fits a message slot */
+#define OC_COMPILE_SERVER_MAX_MESSAGE (1u << 20)
+
+/**
+ * Request kinds
+ */
+typedef enum {
+    OC_COMPILE_KIND_PPU = 0,           // uint32 symbol version + oc_ppu_corpus_unit_t + payload -> host object
+    OC_COMPILE_KIND_RSX_VERTEX = 1,    // Vertex program words -> SPIR-V words
+    OC_COMPILE_KIND_RSX_FRAGMENT = 2   // Fragment program words -> SPIR-V words
+} oc_compile_kind_t;
+
+/** OC_COMPILE_KIND_PPU flags: pass pipeline in the low byte, plus: */
+#define OC_COMPILE_PPU_PIPELINE_MASK    0xFFu
+#define OC_COMPILE_PPU_STACK_PROMOTION  0x100u
+#define OC_COMPILE_PPU_VMX_SWAP_FOLD    0x200u
+#define OC_COMPILE_PPU_IDIOMS           0x400u
+
+/**
+ * Spawn the compile server executable at server_path with threads compile
+ * threads (0 = one per host core, at most 8)
+ * Returns: 0 on success, -1 invalid arguments, -2 already running,
+ * -3 unsupported on this host, -4 shared memory error, -5 the server
+ * failed to start
+ */
+int oc_compile_server_start(const char* server_path, uint32_t threads);
+
+/**
+ * Stop the compile server; waits for compiles in flight
+ */
+void oc_compile_server_stop(void);
+
+/**
+ * Returns 1 while a compile server is running and has not been lost
+ */
+int oc_compile_server_is_running(void);
+
+/**
+ * Compile one request in the server and wait for the result. May be called
+ * from any number of threads. If the server dies or a compile exceeds the
+ * timeout the server is marked lost and later submits fail until it is
+ * started again; callers then compile in-process.
+ * Returns: 0 on success with the result in response, 1 the server could
+ * not compile the request, -1 invalid arguments, -2 no server running,
+ * -3 request or response too large, -4 server lost
+ */
+int oc_compile_server_submit(int kind, uint32_t flags, const void* request, size_t request_size,
+                             void* response, size_t capacity, size_t* response_size);
+
+/**
+ * Server side: serve requests on the shared memory passed as shm_fd until
+ * the client stops the server or exits. Called by the oc_compile_server
+ * executable.
+ * Returns: 0 on a clean shutdown, -1 invalid shared memory, -3 unsupported
+ */
+int oc_compile_server_serve(int shm_fd, uint32_t threads);
+
+/**
+ * Compile server statistics (client side)
+ */
+typedef struct oc_compile_server_stats_t {
+    uint64_t requests;
+    uint64_t completed;
+    uint64_t failed;             // Server could not compile
+    uint64_t lost;               // Server died or timed out
+    uint64_t request_bytes;
+    uint64_t response_bytes;
+    uint64_t compile_ns;         // Time spent compiling in the server
+    uint64_t round_trip_ns;      // Submit to result, including queueing
+    uint32_t server_pid;         // 0 if not running
+    uint32_t server_threads;
+} oc_compile_server_stats_t;
+
+void oc_compile_server_get_stats(oc_compile_server_stats_t* stats);
+void oc_compile_server_reset_stats(void);
+
+// ============================================================================
+// SPU Job Capture and Replay
+// ============================================================================
+
+/**
+ * Start capturing the job running on context's local store to a file.
+ * Records the local store and registers now, then every DMA transfer
+ * issued on that local store until oc_spu_capture_end().
+ * One capture can be active at a time.
+ * Returns: 0 on success, -1 invalid arguments, -2 capture already active,
+ * -3 file error
+ */
+int oc_spu_capture_begin(const char* path, const oc_spu_context_t* context);
+
+/**
+ * Check whether a capture is active.
+ */
+int oc_spu_capture_is_active(void);
+
+/**
+ * Record a completed DMA transfer. Called by the DMA engine; other transfer
+ * paths call it after moving the data. Ignored unless local_storage is the
+ * captured job's local store.
+ */
+void oc_spu_capture_record_dma(const void* local_storage, uint32_t local_addr,
+                               uint64_t ea, uint32_t size, uint16_t tag, int is_put);
+
+/**
+ * Finish the capture with the job's final state and close the file.
+ * Returns: number of DMA transfers recorded, or negative on error
+ */
+int64_t oc_spu_capture_end(const oc_spu_context_t* context);
+
+/**
+ * Stop the capture without writing an end state.
+ */
+void oc_spu_capture_abort(void);
+
+/** Replay verification result bits (0 = replay matched the capture) */
+#define OC_SPU_REPLAY_REGS_DIFFER    0x01  // Final registers differ
+#define OC_SPU_REPLAY_LS_DIFFERS     0x02  // Final local store differs
+#define OC_SPU_REPLAY_PUT_DIFFERS    0x04  // A PUT wrote different data
+#define OC_SPU_REPLAY_DMA_DIVERGED   0x08  // A transfer did not match the capture
+#define OC_SPU_REPLAY_DMA_INCOMPLETE 0x10  // Captured transfers were not all issued
+#define OC_SPU_REPLAY_NO_END_STATE   0x20  // Capture has no end state to compare
+
+/**
+ * Opaque handle to a loaded capture
+ */
+typedef struct oc_spu_replay_t oc_spu_replay_t;
+
+typedef struct oc_spu_replay_info_t {
+    uint32_t spu_id;
+    uint32_t entry_pc;
+    uint32_t gets;
+    uint32_t puts;
+    uint64_t get_bytes;
+    uint64_t put_bytes;
+    uint32_t has_end_state;
+    uint32_t reserved;
+} oc_spu_replay_info_t;
+
+/**
+ * Load a capture file.
+ * Returns: replay handle, or NULL if the file is missing or malformed
+ */
+oc_spu_replay_t* oc_spu_replay_open(const char* path);
+
+/**
+ * Release a replay.
+ */
+void oc_spu_replay_close(oc_spu_replay_t* replay);
+
+/**
+ * Get a capture's summary.
+ */
+void oc_spu_replay_get_info(const oc_spu_replay_t* replay, oc_spu_replay_info_t* info);
+
+/**
+ * Restore the captured starting state into context and its local store,
+ * and rewind the transfer stream.
+ */
+int oc_spu_replay_reset(oc_spu_replay_t* replay, oc_spu_context_t* context);
+
+/**
+ * Service a DMA command issued by the replayed job from the capture.
+ * GETs receive the captured data; PUTs are compared with it and main
+ * memory is never touched. Transfers must follow the captured order.
+ * Returns: 0 on success, 1 if a PUT's data differs, -1 if the transfer
+ * diverges from the capture, -2 unsupported command
+ */
+int oc_spu_replay_dma(oc_spu_replay_t* replay, void* local_storage, uint32_t local_addr,
+                      uint64_t ea, uint32_t size, uint16_t tag, uint8_t cmd);
+
+/**
+ * Service a DMA list command issued by the replayed job (list layout as for
+ * oc_dma_list_transfer). Returns as oc_spu_replay_dma().
+ */
+int oc_spu_replay_dma_list(oc_spu_replay_t* replay, void* local_storage, uint32_t list_addr,
+                           uint32_t list_size, uint16_t tag, uint8_t cmd);
+
+/**
+ * Compare a finished replay with the captured end state.
+ * Returns: OC_SPU_REPLAY_* bits, 0 if identical, negative on error
+ */
+int oc_spu_replay_verify(oc_spu_replay_t* replay, const oc_spu_context_t* context);
+
 // ============================================================================
 // SIMD Helpers (with runtime CPU feature detection)
 // ============================================================================
 
+/** SIMD levels, ordered so a higher level implies the lower ones */
+typedef enum {
+    OC_SIMD_SCALAR = 0,
+    OC_SIMD_SSE42 = 1,
+    OC_SIMD_AVX2 = 2,
+} oc_simd_level_t;
+
 /**
  * Get detected SIMD level.
- * Returns: 0=Scalar, 1=SSE4.2, 2=AVX2
+ * Returns: an oc_simd_level_t
  */
 int oc_simd_get_level(void);
 
@@ -1806,6 +3259,235 @@ void oc_simd_vec_fsub(oc_v128_t* result, const oc_v128_t* a, const oc_v128_t* b)
 /** Vector float mul: result = a * b (4 x float32) */
 void oc_simd_vec_fmul(oc_v128_t* result, const oc_v128_t* a, const oc_v128_t* b);
 
+// ============================================================================
+// Video Post-Processing (cellVpost)
+// ============================================================================
+
+/** Deinterlacing algorithms (values match cellVpost's HLE enum) */
+#define OC_VPOST_DEINTERLACE_BOB              0  // Repeat lines of the kept field
+#define OC_VPOST_DEINTERLACE_WEAVE            1  // Keep both fields (progressive input)
+#define OC_VPOST_DEINTERLACE_MOTION_ADAPTIVE  2  // Interpolate lines that moved since the last frame
+
+/** Scaling algorithms */
+#define OC_VPOST_SCALE_NEAREST   0
+#define OC_VPOST_SCALE_BILINEAR  1
+#define OC_VPOST_SCALE_BICUBIC   2
+
+/** YUV colour matrices */
+#define OC_VPOST_MATRIX_BT601  0
+#define OC_VPOST_MATRIX_BT709  1
+
+/**
+ * Video post-processor: deinterlaces, converts full-range YUV420 planar to
+ * RGBA8888 and scales in one fused pass, split into bands across the job
+ * system. Not thread-safe; process one frame at a time per processor.
+ */
+typedef struct oc_vpost_t oc_vpost_t;
+
+/**
+ * One frame. Pitches are in bytes; 0 selects a tightly packed plane.
+ * The U and V planes are (in_width + 1) / 2 by (in_height + 1) / 2.
+ */
+typedef struct oc_vpost_frame_t {
+    const uint8_t* y;
+    const uint8_t* u;
+    const uint8_t* v;
+    uint32_t y_pitch;
+    uint32_t uv_pitch;
+    uint32_t in_width;
+    uint32_t in_height;
+    uint8_t* out;           // RGBA8888
+    uint32_t out_pitch;
+    uint32_t out_width;
+    uint32_t out_height;
+} oc_vpost_frame_t;
+
+/**
+ * Video post-processor statistics
+ */
+typedef struct oc_vpost_stats_t {
+    uint64_t frames;
+    uint64_t output_pixels;
+    uint64_t source_rows;     // Rows converted, including rows shared by adjacent bands
+    uint64_t motion_lines;    // Lines interpolated by motion-adaptive deinterlacing
+    uint64_t process_ns;
+    uint32_t bands;           // Bands used for the last frame
+    int32_t simd_level;       // Kernels used for the last frame (as oc_simd_get_level)
+} oc_vpost_stats_t;
+
+/**
+ * Create a video post-processor (weave, bilinear, BT.709, opaque alpha).
+ */
+oc_vpost_t* oc_vpost_create(void);
+
+/**
+ * Destroy a video post-processor.
+ */
+void oc_vpost_destroy(oc_vpost_t* vp);
+
+/**
+ * Set the deinterlacing algorithm (OC_VPOST_DEINTERLACE_*).
+ * top_field_first: the even lines are the field that is kept
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_vpost_set_deinterlace(oc_vpost_t* vp, int algorithm, int top_field_first);
+
+/**
+ * Set the scaling algorithm (OC_VPOST_SCALE_*).
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_vpost_set_scaling(oc_vpost_t* vp, int algorithm);
+
+/**
+ * Set the input colour matrix (OC_VPOST_MATRIX_*) and the output alpha.
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_vpost_set_color(oc_vpost_t* vp, int matrix, uint8_t alpha);
+
+/**
+ * Enable/disable the AVX2 kernels (enabled by default when supported).
+ * Both paths produce identical output.
+ */
+void oc_vpost_enable_simd(oc_vpost_t* vp, int enable);
+
+/**
+ * Process one frame.
+ * Returns: 0 on success, -1 on invalid arguments
+ */
+int oc_vpost_process(oc_vpost_t* vp, const oc_vpost_frame_t* frame);
+
+/**
+ * Get video post-processor statistics.
+ */
+void oc_vpost_get_stats(oc_vpost_t* vp, oc_vpost_stats_t* stats);
+
+/**
+ * Reset video post-processor statistics.
+ */
+void oc_vpost_reset_stats(oc_vpost_t* vp);
+
+// ============================================================================
+// Disc and Package Image I/O
+// ============================================================================
+
+/** Read backends */
+#define OC_DISC_IO_BACKEND_AUTO     0  // io_uring when the host supports it, else threads
+#define OC_DISC_IO_BACKEND_URING    1  // Linux io_uring
+#define OC_DISC_IO_BACKEND_THREADS  2  // Pool of I/O threads issuing positional reads
+
+/** Disc sector size, and the cache block size (a multiple of it) */
+#define OC_DISC_IO_SECTOR_SIZE  2048
+#define OC_DISC_IO_BLOCK_SIZE   0x10000
+
+/**
+ * An ISO or PKG image opened for reading through the shared block cache.
+ * Reads, batches and prefetches may be issued from any thread.
+ */
+typedef struct oc_disc_file_t oc_disc_file_t;
+
+/**
+ * One read of a batch. result is set to the bytes read (short at the end
+ * of the image) or a negative error.
+ */
+typedef struct oc_disc_io_vec_t {
+    uint64_t offset;
+    void* buffer;
+    uint32_t size;
+    int64_t result;
+} oc_disc_io_vec_t;
+
+/**
+ * Disc I/O statistics (all files)
+ */
+typedef struct oc_disc_io_stats_t {
+    uint64_t reads;
+    uint64_t bytes_read;
+    uint64_t cache_hits;         // Blocks found loaded or in flight
+    uint64_t cache_misses;       // Blocks a read had to load
+    uint64_t readahead_blocks;   // Blocks loaded by read-ahead and prefetch
+    uint64_t readahead_hits;     // Of those, blocks a read later used
+    uint64_t submissions;        // Batches handed to the backend
+    uint64_t decrypted_bytes;
+    uint64_t errors;
+    uint64_t wait_ns;            // Time reads spent waiting for blocks
+    uint64_t cached_bytes;
+    int32_t backend;             // OC_DISC_IO_BACKEND_*, AUTO until the first open
+} oc_disc_io_stats_t;
+
+/**
+ * Select the read backend (OC_DISC_IO_BACKEND_*). Only possible while no
+ * image is open; AUTO keeps the current backend.
+ * Returns: 0 on success, -1 on invalid arguments, -2 if images are open,
+ *          -3 if io_uring is not supported by the host
+ */
+int oc_disc_io_set_backend(int backend);
+
+/**
+ * Get the read backend in use (AUTO before the first open).
+ */
+int oc_disc_io_get_backend(void);
+
+/**
+ * Set the block cache size in bytes (0 restores the 64MB default). The
+ * cache memory budget may hold it lower.
+ */
+void oc_disc_io_set_cache_size(uint64_t bytes);
+
+/**
+ * Open an image.
+ * Returns: NULL if the file cannot be opened
+ */
+oc_disc_file_t* oc_disc_file_open(const char* path);
+
+/**
+ * Close an image and drop its cached blocks.
+ */
+void oc_disc_file_close(oc_disc_file_t* file);
+
+/**
+ * Get the size of an image in bytes.
+ */
+uint64_t oc_disc_file_get_size(oc_disc_file_t* file);
+
+/**
+ * Decrypt [offset, offset + size) of the image with AES-128-CTR, counting
+ * 16-byte blocks from iv at offset (the PKG data area). Drops the cached
+ * blocks of the image; size 0 turns decryption off.
+ * Returns: 0 on success, -1 on invalid arguments, -2 while reads are in flight
+ */
+int oc_disc_file_set_decrypt(oc_disc_file_t* file, uint64_t offset, uint64_t size,
+                             const uint8_t* key, const uint8_t* iv);
+
+/**
+ * Read from an image, waiting for the blocks it needs.
+ * Returns: bytes read (short at the end of the image), -1 on invalid
+ *          arguments, -2 on an I/O error
+ */
+int64_t oc_disc_file_read(oc_disc_file_t* file, uint64_t offset, void* buffer, uint64_t size);
+
+/**
+ * Read several ranges, submitting the blocks of all of them together.
+ * Returns: 0 if every read succeeded, -1 on invalid arguments, -2 if any
+ *          read failed (see each result)
+ */
+int oc_disc_file_read_batch(oc_disc_file_t* file, oc_disc_io_vec_t* vecs, size_t count);
+
+/**
+ * Start loading a range into the cache without waiting for it.
+ * Returns: blocks queued, or -1 on invalid arguments
+ */
+int oc_disc_file_prefetch(oc_disc_file_t* file, uint64_t offset, uint64_t size);
+
+/**
+ * Get disc I/O statistics.
+ */
+void oc_disc_io_get_stats(oc_disc_io_stats_t* stats);
+
+/**
+ * Reset disc I/O statistics.
+ */
+void oc_disc_io_reset_stats(void);
+
 // ============================================================================
 // PPU JIT Block Linking APIs
 // ============================================================================
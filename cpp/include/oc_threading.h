@@ -11,6 +11,11 @@
 
 #include <functional>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
 
 // Platform-specific threading for cross-compilation compatibility
 // When using MinGW with win32 threading model, std::mutex may not work properly
@@ -29,6 +34,7 @@ public:
     oc_mutex() { InitializeCriticalSection(&cs); }
     ~oc_mutex() { DeleteCriticalSection(&cs); }
     void lock() { EnterCriticalSection(&cs); }
+    bool try_lock() { return TryEnterCriticalSection(&cs) != 0; }
     void unlock() { LeaveCriticalSection(&cs); }
     CRITICAL_SECTION* native_handle() { return &cs; }
     oc_mutex(const oc_mutex&) = delete;
@@ -137,6 +143,14 @@ public:
     oc_thread& operator=(const oc_thread&) = delete;
 };
 
+inline unsigned oc_hardware_concurrency() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<unsigned>(info.dwNumberOfProcessors);
+}
+
+inline void oc_thread_yield() { SwitchToThread(); }
+
 #else
 // On non-Windows platforms, use standard library
 #include <mutex>
@@ -150,6 +164,310 @@ template<typename T>
 using oc_unique_lock = std::unique_lock<T>;
 using oc_condition_variable = std::condition_variable;
 using oc_thread = std::thread;
+
+inline unsigned oc_hardware_concurrency() { return std::thread::hardware_concurrency(); }
+
+inline void oc_thread_yield() { std::this_thread::yield(); }
 #endif
 
+// ============================================================================
+// Runtime-wide Job System
+// ============================================================================
+//
+// One worker per core, shared by every subsystem (JIT compilation, shader
+// compilation, DMA, conversion work, and Rust via oc_jobs_*). Each worker
+// owns a deque per priority lane: the owner pushes and pops at the back for
+// locality, and idle workers steal from the front of other workers' deques.
+// Higher lanes are always drained first, across all workers, before lower
+// ones. Threads waiting on a job group run queued jobs instead of blocking,
+// so fork/join is safe from inside a job.
+
+/**
+ * Job priority lanes (lower value runs first)
+ */
+enum class oc_job_lane : int {
+    High = 0,     // Latency-sensitive work the emulator is waiting on
+    Normal = 1,
+    Low = 2,      // Speculative and background work
+};
+
+static constexpr int OC_JOB_LANES = 3;
+
+class oc_job_system;
+
+/**
+ * Set of jobs that can be waited on together (fork/join)
+ */
+class oc_job_group {
+    friend class oc_job_system;
+    std::atomic<size_t> outstanding{0};
+    oc_mutex mutex;
+    oc_condition_variable done;
+    
+    // Decremented under the lock so a waiter that observes zero (and then
+    // takes the lock once) knows the group is no longer referenced
+    void finish_one() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            done.notify_all();
+        }
+    }
+    
+public:
+    oc_job_group() = default;
+    oc_job_group(const oc_job_group&) = delete;
+    oc_job_group& operator=(const oc_job_group&) = delete;
+    
+    bool is_done() const { return outstanding.load(std::memory_order_acquire) == 0; }
+};
+
+/**
+ * Job system statistics
+ */
+struct oc_job_stats {
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t stolen = 0;           // Jobs run by a worker other than the one queued on
+    uint64_t executed_by_waiters = 0;  // Jobs run by threads waiting on a group
+};
+
+class oc_job_system {
+    struct job {
+        std::function<void()> fn;
+        oc_job_group* group = nullptr;
+    };
+    
+    struct alignas(64) worker_queue {
+        oc_mutex mutex;
+        std::deque<job> lanes[OC_JOB_LANES];
+    };
+    
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<oc_thread> workers;
+    oc_mutex sleep_mutex;
+    oc_condition_variable wake;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> next_queue{0};
+    std::atomic<bool> stopping{false};
+    
+    std::atomic<uint64_t> stat_submitted{0};
+    std::atomic<uint64_t> stat_executed{0};
+    std::atomic<uint64_t> stat_stolen{0};
+    std::atomic<uint64_t> stat_by_waiters{0};
+    
+    static int& current_worker() {
+        static thread_local int index = -1;
+        return index;
+    }
+    
+    static oc_job_system*& current_system() {
+        static thread_local oc_job_system* system = nullptr;
+        return system;
+    }
+    
+    bool pop_lane(size_t q, int lane, bool steal, job& out) {
+        auto& wq = *queues[q];
+        oc_lock_guard<oc_mutex> lock(wq.mutex);
+        auto& dq = wq.lanes[lane];
+        if (dq.empty()) return false;
+        if (steal) {
+            out = std::move(dq.front());
+            dq.pop_front();
+        } else {
+            out = std::move(dq.back());
+            dq.pop_back();
+        }
+        return true;
+    }
+    
+    // Find the highest-priority job, preferring the caller's own queue
+    bool find_job(job& out, bool& stolen) {
+        if (queued.load(std::memory_order_acquire) == 0) return false;
+        size_t n = queues.size();
+        int self = current_system() == this ? current_worker() : -1;
+        size_t start = self >= 0 ? static_cast<size_t>(self)
+                                 : next_queue.load(std::memory_order_relaxed) % n;
+        for (int lane = 0; lane < OC_JOB_LANES; lane++) {
+            for (size_t i = 0; i < n; i++) {
+                size_t q = (start + i) % n;
+                bool steal = static_cast<int>(q) != self;
+                if (pop_lane(q, lane, steal, out)) {
+                    queued.fetch_sub(1, std::memory_order_acq_rel);
+                    stolen = steal && self >= 0;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    void run(job& j) {
+        j.fn();
+        stat_executed.fetch_add(1, std::memory_order_relaxed);
+        if (j.group) j.group->finish_one();
+    }
+    
+    void worker_loop(int index) {
+        current_worker() = index;
+        current_system() = this;
+        while (true) {
+            job j;
+            bool stolen = false;
+            if (find_job(j, stolen)) {
+                if (stolen) stat_stolen.fetch_add(1, std::memory_order_relaxed);
+                run(j);
+                continue;
+            }
+            oc_unique_lock<oc_mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] {
+                return stopping.load() || queued.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping.load() && queued.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+    
+    void push(std::function<void()> fn, oc_job_lane lane, oc_job_group* group) {
+        if (group) group->outstanding.fetch_add(1, std::memory_order_relaxed);
+        
+        // Workers keep their own forks local; other threads spread round-robin
+        int self = current_system() == this ? current_worker() : -1;
+        size_t q = self >= 0 ? static_cast<size_t>(self)
+                             : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            oc_lock_guard<oc_mutex> lock(queues[q]->mutex);
+            queues[q]->lanes[static_cast<int>(lane)].push_back(job{std::move(fn), group});
+        }
+        queued.fetch_add(1, std::memory_order_acq_rel);
+        stat_submitted.fetch_add(1, std::memory_order_relaxed);
+        {
+            oc_lock_guard<oc_mutex> lock(sleep_mutex);
+        }
+        wake.notify_one();
+    }
+    
+public:
+    explicit oc_job_system(size_t num_workers = 0) {
+        if (num_workers == 0) num_workers = oc_hardware_concurrency();
+        if (num_workers == 0) num_workers = 1;
+        for (size_t i = 0; i < num_workers; i++) {
+            queues.push_back(std::make_unique<worker_queue>());
+        }
+        for (size_t i = 0; i < num_workers; i++) {
+            workers.emplace_back([this, i] { worker_loop(static_cast<int>(i)); });
+        }
+    }
+    
+    ~oc_job_system() {
+        {
+            oc_lock_guard<oc_mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) {
+            if (w.joinable()) w.join();
+        }
+    }
+    
+    oc_job_system(const oc_job_system&) = delete;
+    oc_job_system& operator=(const oc_job_system&) = delete;
+    
+    /**
+     * Queue a fire-and-forget job
+     */
+    void submit(std::function<void()> fn, oc_job_lane lane = oc_job_lane::Normal) {
+        push(std::move(fn), lane, nullptr);
+    }
+    
+    /**
+     * Queue a job that `group` waits for
+     */
+    void submit(oc_job_group& group, std::function<void()> fn,
+                oc_job_lane lane = oc_job_lane::Normal) {
+        push(std::move(fn), lane, &group);
+    }
+    
+    /**
+     * Run one queued job on the calling thread, if any
+     */
+    bool run_one() {
+        job j;
+        bool stolen = false;
+        if (!find_job(j, stolen)) return false;
+        if (stolen) stat_stolen.fetch_add(1, std::memory_order_relaxed);
+        run(j);
+        return true;
+    }
+    
+    /**
+     * Wait for every job in `group`, running queued jobs meanwhile
+     */
+    void wait(oc_job_group& group) {
+        while (!group.is_done()) {
+            if (run_one()) {
+                stat_by_waiters.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            // Nothing runnable: the remaining jobs are executing elsewhere
+            oc_unique_lock<oc_mutex> lock(group.mutex);
+            group.done.wait(lock, [&group] { return group.is_done(); });
+        }
+        oc_lock_guard<oc_mutex> lock(group.mutex);
+    }
+    
+    /**
+     * Run fn(begin, end) over [0, count) in chunks of `grain` and wait.
+     * The calling thread runs the first chunk itself.
+     */
+    template<typename F>
+    void parallel_for(size_t count, size_t grain, F&& fn,
+                      oc_job_lane lane = oc_job_lane::Normal) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        if (count <= grain) {
+            fn(static_cast<size_t>(0), count);
+            return;
+        }
+        oc_job_group group;
+        for (size_t begin = grain; begin < count; begin += grain) {
+            size_t end = begin + grain < count ? begin + grain : count;
+            submit(group, [&fn, begin, end] { fn(begin, end); }, lane);
+        }
+        fn(static_cast<size_t>(0), grain);
+        wait(group);
+    }
+    
+    size_t worker_count() const { return workers.size(); }
+    
+    size_t pending() const { return queued.load(std::memory_order_acquire); }
+    
+    /**
+     * Check if the calling thread is one of this system's workers
+     */
+    bool on_worker() const { return current_system() == this && current_worker() >= 0; }
+    
+    oc_job_stats get_stats() const {
+        oc_job_stats stats;
+        stats.submitted = stat_submitted.load();
+        stats.executed = stat_executed.load();
+        stats.stolen = stat_stolen.load();
+        stats.executed_by_waiters = stat_by_waiters.load();
+        return stats;
+    }
+    
+    void reset_stats() {
+        stat_submitted = 0;
+        stat_executed = 0;
+        stat_stolen = 0;
+        stat_by_waiters = 0;
+    }
+};
+
+/**
+ * The runtime-wide job system (started on first use)
+ */
+inline oc_job_system& oc_jobs() {
+    static oc_job_system system;
+    return system;
+}
+
 #endif // OC_THREADING_H
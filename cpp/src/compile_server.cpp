@@ -0,0 +1,621 @@
+/**
+ * Out-of-process compile server
+ *
+ * LLVM compilation makes large short-lived allocations that fragment the
+ * emulator heap, and a crash in the optimizer takes the whole session
+ * down. With a compile server running, PPU blocks and RSX programs are
+ * compiled in a helper process instead: the emulator copies a request into
+ * a slot of a shared memfd, the server compiles it on its own heap and
+ * threads, and copies back a relocatable object (or SPIR-V) that the
+ * emulator links into its own executable memory.
+ *
+ * Slot states move FREE -> CLAIMED (client filling) -> REQUEST -> RUNNING
+ * (server compiling) -> DONE -> FREE. A client that gives up on a running
+ * request marks it ABANDONED and the server frees it when done. All waits
+ * are futexes on words in the shared mapping. The server bumps a heartbeat;
+ * a client that sees it stall, or a compile that exceeds the timeout, marks
+ * the server lost and callers compile in-process from then on.
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define OC_COMPILE_SERVER_SUPPORTED 1
+extern char** environ;
+#endif
+
+static constexpr uint64_t SHM_MAGIC = 0x3130565253434F43ULL;  // "COCSRV01"
+static constexpr uint32_t SHM_VERSION = 1;
+
+static constexpr uint32_t MAX_SERVER_THREADS = 8;
+static constexpr uint32_t SLOTS_PER_THREAD = 2;
+
+// Descriptor the shared memory is passed on to the server
+static constexpr int SERVER_SHM_FD = 3;
+
+static constexpr auto HEARTBEAT_INTERVAL = std::chrono::milliseconds(10);
+static constexpr auto HEARTBEAT_TIMEOUT = std::chrono::seconds(2);
+static constexpr auto COMPILE_TIMEOUT = std::chrono::seconds(30);
+static constexpr auto START_TIMEOUT = std::chrono::seconds(5);
+static constexpr auto WAIT_SLICE = std::chrono::milliseconds(50);
+
+enum SlotState : uint32_t {
+    SLOT_FREE = 0,
+    SLOT_CLAIMED = 1,    // Client is filling the request
+    SLOT_REQUEST = 2,    // Waiting for a server thread
+    SLOT_RUNNING = 3,    // Server is compiling
+    SLOT_DONE = 4,       // Result ready for the client
+    SLOT_ABANDONED = 5   // Client gave up; server frees it when done
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "futex words must be plain lock-free 32-bit atomics");
+
+// Start of the shared mapping, followed by slot_count slots
+struct alignas(64) ShmHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t threads;
+    uint32_t client_pid;
+    std::atomic<uint32_t> ready;       // Set once the server is serving
+    std::atomic<uint32_t> shutdown;    // Set to stop the server
+    std::atomic<uint32_t> pending;     // Bumped per request; server threads wait on it
+    std::atomic<uint32_t> freed;       // Bumped per freed slot; clients wait on it
+    std::atomic<uint32_t> heartbeat;   // Bumped by the server while alive
+};
+
+struct alignas(64) ShmSlot {
+    std::atomic<uint32_t> state;
+    uint32_t kind;
+    uint32_t flags;
+    int32_t status;                    // 0 compiled, 1 failed
+    uint32_t request_size;
+    uint32_t response_size;
+    uint64_t compile_ns;
+    uint8_t data[OC_COMPILE_SERVER_MAX_MESSAGE];   // Request, then response
+};
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+static size_t shm_size(uint32_t slot_count) {
+    return sizeof(ShmHeader) + size_t(slot_count) * sizeof(ShmSlot);
+}
+
+// Shared (not process-private) futex operations: the words live in a
+// mapping both processes see
+static void futex_wait(std::atomic<uint32_t>& word, uint32_t expected,
+                       std::chrono::microseconds timeout) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+    ts.tv_nsec = static_cast<long>((timeout.count() % 1000000) * 1000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+#endif
+
+// ============================================================================
+// Client
+// ============================================================================
+
+struct CompileClient {
+    oc_mutex mutex;                      // Start and stop
+    std::atomic<bool> running{false};
+    std::atomic<int> users{0};           // Submits using the mapping
+    ShmHeader* header = nullptr;
+    ShmSlot* slots = nullptr;
+    size_t map_size = 0;
+    int fd = -1;
+    int pid = 0;
+    uint32_t threads = 0;
+
+    // Last heartbeat value seen, and when it changed
+    std::atomic<uint32_t> last_heartbeat{0};
+    std::atomic<int64_t> last_beat_ns{0};
+
+    // Statistics
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> lost{0};
+    std::atomic<uint64_t> request_bytes{0};
+    std::atomic<uint64_t> response_bytes{0};
+    std::atomic<uint64_t> compile_ns{0};
+    std::atomic<uint64_t> round_trip_ns{0};
+
+    bool server_alive() {
+        uint32_t beat = header->heartbeat.load(std::memory_order_relaxed);
+        int64_t now = now_ns();
+        if (beat != last_heartbeat.load(std::memory_order_relaxed)) {
+            last_heartbeat.store(beat, std::memory_order_relaxed);
+            last_beat_ns.store(now, std::memory_order_relaxed);
+            return true;
+        }
+        return now - last_beat_ns.load(std::memory_order_relaxed) <
+               std::chrono::duration_cast<std::chrono::nanoseconds>(HEARTBEAT_TIMEOUT).count();
+    }
+
+    void mark_lost() {
+        if (!running.exchange(false)) return;
+        lost.fetch_add(1, std::memory_order_relaxed);
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+        // A wedged server would keep burning a core; it is reaped on stop
+        kill(pid, SIGKILL);
+#endif
+    }
+
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+    void slot_freed() {
+        header->freed.fetch_add(1, std::memory_order_release);
+        futex_wake(header->freed, INT_MAX);
+    }
+
+    ShmSlot* claim_slot(int64_t deadline) {
+        while (running.load()) {
+            uint32_t freed = header->freed.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < header->slot_count; i++) {
+                uint32_t expected = SLOT_FREE;
+                if (slots[i].state.compare_exchange_strong(expected, SLOT_CLAIMED,
+                                                           std::memory_order_acquire)) {
+                    return &slots[i];
+                }
+            }
+            if (!server_alive() || now_ns() > deadline) {
+                mark_lost();
+                return nullptr;
+            }
+            futex_wait(header->freed, freed, WAIT_SLICE);
+        }
+        return nullptr;
+    }
+
+    // Give a slot back without its result
+    void abandon(ShmSlot* slot) {
+        for (;;) {
+            uint32_t state = slot->state.load(std::memory_order_acquire);
+            if (state == SLOT_REQUEST || state == SLOT_DONE) {
+                if (slot->state.compare_exchange_strong(state, SLOT_FREE)) {
+                    slot_freed();
+                    return;
+                }
+            } else if (state == SLOT_RUNNING) {
+                if (slot->state.compare_exchange_strong(state, SLOT_ABANDONED)) return;
+            } else {
+                return;
+            }
+        }
+    }
+#endif
+
+    // Caller holds mutex
+    void teardown_locked() {
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+        running.store(false);
+        while (users.load() != 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (header) {
+            header->shutdown.store(1, std::memory_order_release);
+            futex_wake(header->shutdown, INT_MAX);
+            futex_wake(header->pending, INT_MAX);
+        }
+        if (pid > 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (waitpid(pid, nullptr, WNOHANG) == 0) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    kill(pid, SIGKILL);
+                    waitpid(pid, nullptr, 0);
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        if (header) munmap(header, map_size);
+        if (fd >= 0) close(fd);
+#endif
+        header = nullptr;
+        slots = nullptr;
+        map_size = 0;
+        fd = -1;
+        pid = 0;
+        threads = 0;
+    }
+};
+
+static CompileClient g_compile_client;
+
+// ============================================================================
+// Server
+// ============================================================================
+
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+/**
+ * One server thread's compilers, created on first use
+ */
+struct ServerWorker {
+    oc_ppu_jit_t* ppu = nullptr;
+    oc_rsx_shader_t* rsx = nullptr;
+    std::vector<uint8_t> request;
+    std::vector<uint32_t> words;
+
+    ~ServerWorker() {
+        if (ppu) oc_ppu_jit_destroy(ppu);
+        if (rsx) oc_rsx_shader_destroy(rsx);
+    }
+
+    bool compile_ppu(uint32_t flags, uint8_t* out, uint32_t* out_size) {
+        uint32_t symbol_version;
+        oc_ppu_corpus_unit_t unit;
+        size_t header = sizeof(symbol_version) + sizeof(unit);
+        if (request.size() < header) return false;
+        std::memcpy(&symbol_version, request.data(), sizeof(symbol_version));
+        std::memcpy(&unit, request.data() + sizeof(symbol_version), sizeof(unit));
+        size_t payload_bytes = request.size() - header;
+        size_t expected = size_t(unit.instruction_count) + size_t(unit.inlined_call_count) * 4 +
+                          unit.jump_table_targets + size_t(unit.guard_count) * 4;
+        if (unit.instruction_count == 0 || payload_bytes != expected * sizeof(uint32_t)) return false;
+        words.resize(expected);
+        std::memcpy(words.data(), request.data() + header, payload_bytes);
+
+        if (!ppu) ppu = oc_ppu_jit_create();
+        if (!ppu || oc_ppu_jit_set_pass_pipeline(ppu, flags & OC_COMPILE_PPU_PIPELINE_MASK) != 0) {
+            return false;
+        }
+        oc_ppu_jit_stack_promotion_enable(ppu, (flags & OC_COMPILE_PPU_STACK_PROMOTION) != 0);
+        oc_ppu_jit_vmx_swap_fold_enable(ppu, (flags & OC_COMPILE_PPU_VMX_SWAP_FOLD) != 0);
+        oc_ppu_jit_idioms_enable(ppu, (flags & OC_COMPILE_PPU_IDIOMS) != 0);
+
+        int64_t size = oc_ppu_jit_compile_object(ppu, &unit, words.data(), symbol_version, out,
+                                                 OC_COMPILE_SERVER_MAX_MESSAGE);
+        if (size <= 0 || size > OC_COMPILE_SERVER_MAX_MESSAGE) return false;
+        *out_size = static_cast<uint32_t>(size);
+        return true;
+    }
+
+    bool compile_rsx(bool vertex, uint8_t* out, uint32_t* out_size) {
+        if (request.empty() || request.size() % sizeof(uint32_t)) return false;
+        words.resize(request.size() / sizeof(uint32_t));
+        std::memcpy(words.data(), request.data(), request.size());
+
+        if (!rsx) rsx = oc_rsx_shader_create();
+        if (!rsx) return false;
+        uint32_t* spirv = nullptr;
+        size_t count = 0;
+        int r = vertex ? oc_rsx_shader_compile_vertex(rsx, words.data(), words.size(), &spirv, &count)
+                       : oc_rsx_shader_compile_fragment(rsx, words.data(), words.size(), &spirv, &count);
+        bool ok = r == 0 && spirv && count * sizeof(uint32_t) <= OC_COMPILE_SERVER_MAX_MESSAGE;
+        if (ok) {
+            std::memcpy(out, spirv, count * sizeof(uint32_t));
+            *out_size = static_cast<uint32_t>(count * sizeof(uint32_t));
+        }
+        oc_rsx_shader_free_spirv(spirv);
+        return ok;
+    }
+
+    void serve(ShmHeader* header, ShmSlot* slot) {
+        uint32_t size = std::min<uint32_t>(slot->request_size, OC_COMPILE_SERVER_MAX_MESSAGE);
+        request.assign(slot->data, slot->data + size);
+
+        int64_t start = now_ns();
+        uint32_t response_size = 0;
+        bool ok = false;
+        switch (slot->kind) {
+            case OC_COMPILE_KIND_PPU:
+                ok = compile_ppu(slot->flags, slot->data, &response_size);
+                break;
+            case OC_COMPILE_KIND_RSX_VERTEX:
+            case OC_COMPILE_KIND_RSX_FRAGMENT:
+                ok = compile_rsx(slot->kind == OC_COMPILE_KIND_RSX_VERTEX, slot->data, &response_size);
+                break;
+            default:
+                break;
+        }
+        slot->status = ok ? 0 : 1;
+        slot->response_size = ok ? response_size : 0;
+        slot->compile_ns = static_cast<uint64_t>(now_ns() - start);
+
+        uint32_t expected = SLOT_RUNNING;
+        if (slot->state.compare_exchange_strong(expected, SLOT_DONE, std::memory_order_release)) {
+            futex_wake(slot->state, INT_MAX);
+        } else {
+            // Abandoned by the client
+            slot->state.store(SLOT_FREE, std::memory_order_release);
+            header->freed.fetch_add(1, std::memory_order_release);
+            futex_wake(header->freed, INT_MAX);
+        }
+    }
+};
+
+static void server_thread(ShmHeader* header, ShmSlot* slots) {
+    ServerWorker worker;
+    while (!header->shutdown.load(std::memory_order_acquire)) {
+        uint32_t pending = header->pending.load(std::memory_order_acquire);
+        bool served = false;
+        for (uint32_t i = 0; i < header->slot_count; i++) {
+            uint32_t expected = SLOT_REQUEST;
+            if (slots[i].state.compare_exchange_strong(expected, SLOT_RUNNING,
+                                                       std::memory_order_acquire)) {
+                worker.serve(header, &slots[i]);
+                served = true;
+            }
+        }
+        if (!served) {
+            futex_wait(header->pending, pending, std::chrono::milliseconds(100));
+        }
+    }
+}
+#endif
+
+// ============================================================================
+// C API
+// ============================================================================
+
+extern "C" {
+
+int oc_compile_server_start(const char* server_path, uint32_t threads) {
+    if (!server_path) return -1;
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+    auto& c = g_compile_client;
+    oc_lock_guard<oc_mutex> lock(c.mutex);
+    if (c.running.load()) return -2;
+    if (c.header) c.teardown_locked();  // Lost earlier
+
+    if (threads == 0) threads = std::max(1u, std::min(std::thread::hardware_concurrency(), MAX_SERVER_THREADS));
+    threads = std::min(threads, MAX_SERVER_THREADS);
+    uint32_t slot_count = threads * SLOTS_PER_THREAD;
+    size_t size = shm_size(slot_count);
+
+    // Kept clear of SERVER_SHM_FD so the dup2 below always clears CLOEXEC
+    int memfd = memfd_create("oc_compile_server", MFD_CLOEXEC);
+    if (memfd < 0) return -4;
+    c.fd = fcntl(memfd, F_DUPFD_CLOEXEC, SERVER_SHM_FD + 1);
+    close(memfd);
+    if (c.fd < 0) return -4;
+    if (ftruncate(c.fd, static_cast<off_t>(size)) != 0) {
+        c.teardown_locked();
+        return -4;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, c.fd, 0);
+    if (p == MAP_FAILED) {
+        c.teardown_locked();
+        return -4;
+    }
+    // A fresh memfd reads as zeros, which is every atomic's initial state
+    c.header = static_cast<ShmHeader*>(p);
+    c.slots = reinterpret_cast<ShmSlot*>(c.header + 1);
+    c.map_size = size;
+    c.header->magic = SHM_MAGIC;
+    c.header->version = SHM_VERSION;
+    c.header->slot_count = slot_count;
+    c.header->threads = threads;
+    c.header->client_pid = static_cast<uint32_t>(getpid());
+
+    std::string fd_arg = std::to_string(SERVER_SHM_FD);
+    std::string threads_arg = std::to_string(threads);
+    char* argv[] = {const_cast<char*>(server_path), const_cast<char*>("--fd"), fd_arg.data(),
+                    const_cast<char*>("--threads"), threads_arg.data(), nullptr};
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, c.fd, SERVER_SHM_FD);
+    pid_t pid = 0;
+    int spawn_error = posix_spawn(&pid, server_path, &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawn_error != 0) {
+        c.teardown_locked();
+        return -5;
+    }
+    c.pid = pid;
+
+    auto deadline = std::chrono::steady_clock::now() + START_TIMEOUT;
+    while (!c.header->ready.load(std::memory_order_acquire)) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            c.pid = 0;  // Already reaped
+            c.teardown_locked();
+            return -5;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            c.teardown_locked();
+            return -5;
+        }
+        futex_wait(c.header->ready, 0, std::chrono::milliseconds(10));
+    }
+
+    c.threads = threads;
+    c.last_heartbeat.store(c.header->heartbeat.load(), std::memory_order_relaxed);
+    c.last_beat_ns.store(now_ns(), std::memory_order_relaxed);
+    c.running.store(true);
+    return 0;
+#else
+    (void)threads;
+    return -3;
+#endif
+}
+
+void oc_compile_server_stop(void) {
+    auto& c = g_compile_client;
+    oc_lock_guard<oc_mutex> lock(c.mutex);
+    if (c.header) c.teardown_locked();
+}
+
+int oc_compile_server_is_running(void) {
+    return g_compile_client.running.load(std::memory_order_acquire) ? 1 : 0;
+}
+
+int oc_compile_server_submit(int kind, uint32_t flags, const void* request, size_t request_size,
+                             void* response, size_t capacity, size_t* response_size) {
+    if (response_size) *response_size = 0;
+    if (!request || request_size == 0 || (!response && capacity) || !response_size) return -1;
+    if (kind < OC_COMPILE_KIND_PPU || kind > OC_COMPILE_KIND_RSX_FRAGMENT) return -1;
+    if (request_size > OC_COMPILE_SERVER_MAX_MESSAGE) return -3;
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+    auto& c = g_compile_client;
+    c.users.fetch_add(1);
+    if (!c.running.load()) {
+        c.users.fetch_sub(1);
+        return -2;
+    }
+
+    int64_t start = now_ns();
+    int64_t deadline = start + std::chrono::duration_cast<std::chrono::nanoseconds>(COMPILE_TIMEOUT).count();
+    ShmSlot* slot = c.claim_slot(deadline);
+    if (!slot) {
+        c.users.fetch_sub(1);
+        return -4;
+    }
+    slot->kind = static_cast<uint32_t>(kind);
+    slot->flags = flags;
+    slot->status = 1;
+    slot->request_size = static_cast<uint32_t>(request_size);
+    slot->response_size = 0;
+    std::memcpy(slot->data, request, request_size);
+    slot->state.store(SLOT_REQUEST, std::memory_order_release);
+    c.header->pending.fetch_add(1, std::memory_order_release);
+    futex_wake(c.header->pending, 1);
+    c.requests.fetch_add(1, std::memory_order_relaxed);
+    c.request_bytes.fetch_add(request_size, std::memory_order_relaxed);
+
+    for (;;) {
+        uint32_t state = slot->state.load(std::memory_order_acquire);
+        if (state == SLOT_DONE) break;
+        if (!c.running.load() || !c.server_alive() || now_ns() > deadline) {
+            c.abandon(slot);
+            c.mark_lost();
+            c.users.fetch_sub(1);
+            return -4;
+        }
+        futex_wait(slot->state, state, WAIT_SLICE);
+    }
+
+    int result = 0;
+    if (slot->status != 0) {
+        c.failed.fetch_add(1, std::memory_order_relaxed);
+        result = 1;
+    } else if (slot->response_size > capacity) {
+        result = -3;
+    } else {
+        std::memcpy(response, slot->data, slot->response_size);
+        *response_size = slot->response_size;
+        c.completed.fetch_add(1, std::memory_order_relaxed);
+        c.response_bytes.fetch_add(slot->response_size, std::memory_order_relaxed);
+    }
+    c.compile_ns.fetch_add(slot->compile_ns, std::memory_order_relaxed);
+    slot->state.store(SLOT_FREE, std::memory_order_release);
+    c.slot_freed();
+    c.round_trip_ns.fetch_add(static_cast<uint64_t>(now_ns() - start), std::memory_order_relaxed);
+    c.users.fetch_sub(1);
+    return result;
+#else
+    (void)flags;
+    (void)response;
+    return -2;
+#endif
+}
+
+int oc_compile_server_serve(int shm_fd, uint32_t threads) {
+#ifdef OC_COMPILE_SERVER_SUPPORTED
+    struct stat st;
+    if (shm_fd < 0 || fstat(shm_fd, &st) != 0 || size_t(st.st_size) < sizeof(ShmHeader)) return -1;
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (p == MAP_FAILED) return -1;
+    auto* header = static_cast<ShmHeader*>(p);
+    if (header->magic != SHM_MAGIC || header->version != SHM_VERSION ||
+        header->slot_count == 0 || size < shm_size(header->slot_count)) {
+        munmap(p, size);
+        return -1;
+    }
+    if (getppid() != static_cast<pid_t>(header->client_pid)) {
+        munmap(p, size);  // The client is already gone
+        return 0;
+    }
+    auto* slots = reinterpret_cast<ShmSlot*>(header + 1);
+
+    if (threads == 0) threads = header->threads;
+    threads = std::max(1u, std::min(threads, MAX_SERVER_THREADS));
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < threads; i++) {
+        workers.emplace_back(server_thread, header, slots);
+    }
+    header->ready.store(1, std::memory_order_release);
+    futex_wake(header->ready, INT_MAX);
+
+    // Exit with the emulator, even if it dies without stopping us. The
+    // parent is polled rather than PR_SET_PDEATHSIG used, which would fire
+    // when the emulator thread that spawned us exits, not the emulator.
+    while (!header->shutdown.load(std::memory_order_acquire)) {
+        header->heartbeat.fetch_add(1, std::memory_order_relaxed);
+        if (getppid() != static_cast<pid_t>(header->client_pid)) {
+            header->shutdown.store(1, std::memory_order_release);
+            break;
+        }
+        futex_wait(header->shutdown, 0, HEARTBEAT_INTERVAL);
+    }
+    futex_wake(header->pending, INT_MAX);
+    for (auto& worker : workers) worker.join();
+    munmap(p, size);
+    return 0;
+#else
+    (void)shm_fd;
+    (void)threads;
+    return -3;
+#endif
+}
+
+void oc_compile_server_get_stats(oc_compile_server_stats_t* stats) {
+    if (!stats) return;
+    auto& c = g_compile_client;
+    std::memset(stats, 0, sizeof(*stats));
+    stats->requests = c.requests.load(std::memory_order_relaxed);
+    stats->completed = c.completed.load(std::memory_order_relaxed);
+    stats->failed = c.failed.load(std::memory_order_relaxed);
+    stats->lost = c.lost.load(std::memory_order_relaxed);
+    stats->request_bytes = c.request_bytes.load(std::memory_order_relaxed);
+    stats->response_bytes = c.response_bytes.load(std::memory_order_relaxed);
+    stats->compile_ns = c.compile_ns.load(std::memory_order_relaxed);
+    stats->round_trip_ns = c.round_trip_ns.load(std::memory_order_relaxed);
+    oc_lock_guard<oc_mutex> lock(c.mutex);
+    if (c.running.load()) {
+        stats->server_pid = static_cast<uint32_t>(c.pid);
+        stats->server_threads = c.threads;
+    }
+}
+
+void oc_compile_server_reset_stats(void) {
+    auto& c = g_compile_client;
+    c.requests.store(0, std::memory_order_relaxed);
+    c.completed.store(0, std::memory_order_relaxed);
+    c.failed.store(0, std::memory_order_relaxed);
+    c.lost.store(0, std::memory_order_relaxed);
+    c.request_bytes.store(0, std::memory_order_relaxed);
+    c.response_bytes.store(0, std::memory_order_relaxed);
+    c.compile_ns.store(0, std::memory_order_relaxed);
+    c.round_trip_ns.store(0, std::memory_order_relaxed);
+}
+
+} // extern "C"
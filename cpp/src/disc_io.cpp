@@ -0,0 +1,1151 @@
+/**
+ * Disc and package image I/O
+ *
+ * Reads from ISO and PKG images go through a shared cache of 64KB blocks
+ * (32 disc sectors, aligned to the sector size). Missing blocks are read
+ * by an asynchronous backend:
+ *
+ *   - io_uring (Linux), driven through the raw syscalls: every block a read
+ *     or its read-ahead needs is queued and submitted with one
+ *     io_uring_enter(), and a reaper thread completes them
+ *   - otherwise a small pool of I/O threads issuing positional reads
+ *
+ * Each open file tracks whether it is being read sequentially; while it
+ * is, reads also queue a read-ahead window that doubles up to 2MB, so the
+ * next reads find their blocks loaded or in flight. Files can carry an
+ * AES-128-CTR range (PKG content); blocks are decrypted in place by the
+ * completing thread before they become visible, so the cache only holds
+ * plaintext.
+ *
+ * Cached blocks are charged to the cache memory budget and the least
+ * recently used are evicted down to its target.
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+
+#if defined(_WIN32)
+// windows.h comes with oc_threading.h
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define OC_DISC_IO_URING_SUPPORTED 1
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef __GNUC__
+#include <cpuid.h>
+#endif
+#define OC_X86_64 1
+#else
+#define OC_X86_64 0
+#endif
+
+static constexpr uint32_t DISC_BLOCK_SIZE = OC_DISC_IO_BLOCK_SIZE;
+static constexpr uint32_t DISC_BLOCK_SHIFT = 16;
+static_assert((1u << DISC_BLOCK_SHIFT) == DISC_BLOCK_SIZE, "block shift");
+
+// Read-ahead window, in blocks
+static constexpr uint32_t READAHEAD_MIN_BLOCKS = 2;
+static constexpr uint32_t READAHEAD_MAX_BLOCKS = 32;
+
+// Large reads are split so they cannot pin more than this many blocks
+static constexpr uint32_t READ_CHUNK_BLOCKS = 64;
+
+static constexpr uint64_t DEFAULT_CACHE_BYTES = 64ull << 20;
+static constexpr uint32_t URING_ENTRIES = 128;
+static constexpr uint32_t IO_THREADS = 4;
+
+// ============================================================================
+// AES-128-CTR
+// ============================================================================
+
+static const uint8_t AES_SBOX[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static inline uint8_t aes_xtime(uint8_t x) {
+    return static_cast<uint8_t>((x << 1) ^ ((x >> 7) * 0x1b));
+}
+
+/**
+ * AES-128 encryption (all CTR mode needs), AES-NI when available
+ */
+struct Aes128 {
+    uint8_t round_keys[11][16];
+    bool aesni = false;
+
+    void set_key(const uint8_t key[16]) {
+        static const uint8_t rcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+        std::memcpy(round_keys[0], key, 16);
+        for (int r = 1; r <= 10; r++) {
+            const uint8_t* prev = round_keys[r - 1];
+            uint8_t* rk = round_keys[r];
+            uint8_t t[4] = {AES_SBOX[prev[13]], AES_SBOX[prev[14]], AES_SBOX[prev[15]], AES_SBOX[prev[12]]};
+            t[0] ^= rcon[r - 1];
+            for (int i = 0; i < 4; i++) rk[i] = prev[i] ^ t[i];
+            for (int i = 4; i < 16; i++) rk[i] = prev[i] ^ rk[i - 4];
+        }
+        aesni = detect_aesni();
+    }
+
+    static bool detect_aesni() {
+#if OC_X86_64 && defined(__GNUC__)
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return (ecx >> 25) & 1;
+#endif
+        return false;
+    }
+
+    void encrypt_scalar(const uint8_t in[16], uint8_t out[16]) const {
+        uint8_t s[16];
+        for (int i = 0; i < 16; i++) s[i] = in[i] ^ round_keys[0][i];
+        for (int r = 1; r <= 10; r++) {
+            uint8_t t[16];
+            // SubBytes + ShiftRows (column-major state)
+            for (int c = 0; c < 4; c++) {
+                for (int row = 0; row < 4; row++) {
+                    t[c * 4 + row] = AES_SBOX[s[((c + row) & 3) * 4 + row]];
+                }
+            }
+            if (r != 10) {
+                // MixColumns
+                for (int c = 0; c < 4; c++) {
+                    uint8_t* col = &t[c * 4];
+                    uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+                    uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                    col[0] = a0 ^ all ^ aes_xtime(a0 ^ a1);
+                    col[1] = a1 ^ all ^ aes_xtime(a1 ^ a2);
+                    col[2] = a2 ^ all ^ aes_xtime(a2 ^ a3);
+                    col[3] = a3 ^ all ^ aes_xtime(a3 ^ a0);
+                }
+            }
+            for (int i = 0; i < 16; i++) s[i] = t[i] ^ round_keys[r][i];
+        }
+        std::memcpy(out, s, 16);
+    }
+
+    void ctr_blocks(uint8_t counter[16], uint8_t* keystream, size_t blocks) const;
+};
+
+// 128-bit big-endian counter increment
+static inline void ctr_increment(uint8_t counter[16], uint64_t amount) {
+    for (int i = 15; i >= 0 && amount; i--) {
+        uint64_t sum = counter[i] + (amount & 0xFF);
+        counter[i] = static_cast<uint8_t>(sum);
+        amount = (amount >> 8) + (sum >> 8);
+    }
+}
+
+#if OC_X86_64
+__attribute__((target("aes,sse4.1")))
+static void aes_ctr_aesni(const uint8_t round_keys[11][16], uint8_t counter[16],
+                          uint8_t* keystream, size_t blocks) {
+    __m128i rk[11];
+    for (int i = 0; i < 11; i++) rk[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(round_keys[i]));
+    size_t b = 0;
+    for (; b + 4 <= blocks; b += 4) {
+        __m128i x[4];
+        for (int j = 0; j < 4; j++) {
+            x[j] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counter)), rk[0]);
+            ctr_increment(counter, 1);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < 4; j++) x[j] = _mm_aesenc_si128(x[j], rk[r]);
+        }
+        for (int j = 0; j < 4; j++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(keystream + (b + j) * 16), _mm_aesenclast_si128(x[j], rk[10]));
+        }
+    }
+    for (; b < blocks; b++) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counter)), rk[0]);
+        for (int r = 1; r < 10; r++) x = _mm_aesenc_si128(x, rk[r]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(keystream + b * 16), _mm_aesenclast_si128(x, rk[10]));
+        ctr_increment(counter, 1);
+    }
+}
+#endif
+
+void Aes128::ctr_blocks(uint8_t counter[16], uint8_t* keystream, size_t blocks) const {
+#if OC_X86_64
+    if (aesni) {
+        aes_ctr_aesni(round_keys, counter, keystream, blocks);
+        return;
+    }
+#endif
+    for (size_t b = 0; b < blocks; b++) {
+        encrypt_scalar(counter, keystream + b * 16);
+        ctr_increment(counter, 1);
+    }
+}
+
+// ============================================================================
+// Host files
+// ============================================================================
+
+/**
+ * An open image, shared by its oc_disc_file_t and the requests in flight
+ */
+struct HostFile {
+#if defined(_WIN32)
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    uint32_t id = 0;
+    uint64_t size = 0;
+
+    // Decrypted range, set before any block of the file is loaded
+    bool decrypt = false;
+    uint64_t decrypt_begin = 0;
+    uint64_t decrypt_end = 0;
+    Aes128 aes;
+    uint8_t iv[16] = {};
+
+    ~HostFile() {
+#if defined(_WIN32)
+        if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+#else
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool open(const char* path) {
+#if defined(_WIN32)
+        handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER li;
+        if (!GetFileSizeEx(handle, &li)) return false;
+        size = static_cast<uint64_t>(li.QuadPart);
+#else
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return false;
+        size = static_cast<uint64_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    /**
+     * Positional read; returns bytes read (0 at end of file) or -errno
+     */
+    int64_t pread_at(void* buf, uint32_t len, uint64_t offset) const {
+#if defined(_WIN32)
+        OVERLAPPED ov = {};
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD got = 0;
+        if (!ReadFile(handle, buf, len, &got, &ov)) {
+            return GetLastError() == ERROR_HANDLE_EOF ? 0 : -EIO;
+        }
+        return got;
+#else
+        ssize_t n = ::pread(fd, buf, len, static_cast<off_t>(offset));
+        return n < 0 ? -errno : n;
+#endif
+    }
+
+    /**
+     * Decrypt the part of [offset, offset + len) inside the CTR range
+     */
+    void decrypt_range(uint8_t* data, uint64_t offset, uint32_t len) const {
+        uint64_t begin = std::max(offset, decrypt_begin);
+        uint64_t end = std::min(offset + len, decrypt_end);
+        if (begin >= end) return;
+
+        uint64_t rel = begin - decrypt_begin;
+        uint8_t counter[16];
+        std::memcpy(counter, iv, 16);
+        ctr_increment(counter, rel / 16);
+
+        uint8_t keystream[64 * 16];
+        uint64_t pos = begin;
+        uint32_t skip = static_cast<uint32_t>(rel % 16);
+        while (pos < end) {
+            uint64_t want = end - pos + skip;
+            size_t blocks = static_cast<size_t>(std::min<uint64_t>((want + 15) / 16, 64));
+            aes.ctr_blocks(counter, keystream, blocks);
+            size_t avail = std::min<uint64_t>(blocks * 16 - skip, end - pos);
+            uint8_t* dst = data + (pos - offset);
+            for (size_t i = 0; i < avail; i++) dst[i] ^= keystream[skip + i];
+            pos += avail;
+            skip = 0;
+        }
+    }
+};
+
+// ============================================================================
+// Block cache
+// ============================================================================
+
+enum class BlockState { Loading, Ready, Failed };
+
+struct DiscBlock {
+    uint64_t key = 0;
+    uint64_t offset = 0;
+    uint32_t length = 0;          // Bytes requested (short for the last block)
+    uint32_t valid = 0;           // Bytes read
+    int error = 0;
+    BlockState state = BlockState::Loading;
+    bool readahead = false;       // Loaded ahead of any read that needed it
+    std::list<uint64_t>::iterator lru_entry;  // Position in the recency list once Ready
+    std::unique_ptr<uint8_t[]> data;
+};
+
+/**
+ * One block read in flight
+ */
+struct IoRequest {
+    std::shared_ptr<DiscBlock> block;
+    std::shared_ptr<HostFile> file;
+};
+
+class DiscIoEngine;
+
+/**
+ * Asynchronous read backend: submit() queues a batch, and every request
+ * ends in DiscIoEngine::complete() on a backend thread.
+ */
+class DiscIoBackend {
+public:
+    virtual ~DiscIoBackend() = default;
+    virtual void submit(std::vector<IoRequest*>& batch) = 0;
+};
+
+class DiscIoEngine {
+public:
+    oc_mutex lock;
+    oc_condition_variable block_done;
+    std::unordered_map<uint64_t, std::shared_ptr<DiscBlock>> blocks;
+    std::list<uint64_t> lru;  // Keys of Ready blocks, least recently used first
+    uint64_t cached_bytes = 0;
+    uint64_t max_bytes = DEFAULT_CACHE_BYTES;
+
+    std::unique_ptr<DiscIoBackend> backend;
+    int backend_kind = OC_DISC_IO_BACKEND_AUTO;
+    uint32_t next_file_id = 1;
+    uint32_t open_files = 0;
+
+    int budget_client;
+    std::atomic<uint64_t> lookups{0};
+
+    // Statistics
+    std::atomic<uint64_t> stat_reads{0};
+    std::atomic<uint64_t> stat_bytes{0};
+    std::atomic<uint64_t> stat_hits{0};
+    std::atomic<uint64_t> stat_misses{0};
+    std::atomic<uint64_t> stat_readahead_blocks{0};
+    std::atomic<uint64_t> stat_readahead_hits{0};
+    std::atomic<uint64_t> stat_submissions{0};
+    std::atomic<uint64_t> stat_decrypted{0};
+    std::atomic<uint64_t> stat_errors{0};
+    std::atomic<uint64_t> stat_wait_ns{0};
+
+    DiscIoEngine() {
+        budget_client = oc_mem_budget_register("disc_blocks", budget_lookups, this);
+    }
+
+    ~DiscIoEngine() {
+        backend.reset();
+        oc_mem_budget_unregister(budget_client);
+    }
+
+    static uint64_t budget_lookups(void* user_data) {
+        return static_cast<DiscIoEngine*>(user_data)->lookups.load(std::memory_order_relaxed);
+    }
+
+    static DiscIoEngine& get() {
+        static DiscIoEngine engine;
+        return engine;
+    }
+
+    /**
+     * Start the backend on first use (called with lock held)
+     *
+     * A backend being replaced is moved to retired; the caller destroys it
+     * after dropping the lock, since its workers take the lock to complete.
+     */
+    int ensure_backend(int kind, std::unique_ptr<DiscIoBackend>& retired);
+
+    /**
+     * Called by the backend when a request finishes: result is bytes read
+     * or -errno
+     */
+    void complete(IoRequest* req, int64_t result) {
+        DiscBlock* block = req->block.get();
+        if (result >= 0) {
+            block->valid = static_cast<uint32_t>(result);
+            if (block->valid < block->length) {
+                // Image shorter than when it was opened
+                std::memset(block->data.get() + block->valid, 0, block->length - block->valid);
+            }
+            if (req->file->decrypt) {
+                req->file->decrypt_range(block->data.get(), block->offset, block->length);
+                stat_decrypted.fetch_add(block->length, std::memory_order_relaxed);
+            }
+        }
+        {
+            oc_lock_guard<oc_mutex> guard(lock);
+            if (result >= 0) {
+                block->state = BlockState::Ready;
+                auto it = blocks.find(block->key);
+                if (it != blocks.end() && it->second.get() == block) {
+                    block->lru_entry = lru.insert(lru.end(), block->key);
+                }
+            } else {
+                block->state = BlockState::Failed;
+                block->error = static_cast<int>(-result);
+                stat_errors.fetch_add(1, std::memory_order_relaxed);
+                // Let the next read retry
+                auto it = blocks.find(block->key);
+                if (it != blocks.end() && it->second.get() == block) {
+                    blocks.erase(it);
+                    cached_bytes -= DISC_BLOCK_SIZE;
+                    oc_mem_budget_release(budget_client, DISC_BLOCK_SIZE);
+                }
+            }
+        }
+        block_done.notify_all();
+        delete req;
+    }
+
+    /**
+     * Evict least recently used loaded blocks until one more fits (called
+     * with lock held)
+     */
+    void make_room() {
+        uint64_t limit = std::min(max_bytes, oc_mem_budget_get_target(budget_client));
+        limit = std::max<uint64_t>(limit, DISC_BLOCK_SIZE * READ_CHUNK_BLOCKS);
+        while (cached_bytes + DISC_BLOCK_SIZE > limit) {
+            if (lru.empty()) return;    // Everything is in flight
+            uint64_t victim = lru.front();
+            lru.pop_front();
+            oc_mem_budget_evict(budget_client, victim, DISC_BLOCK_SIZE);
+            cached_bytes -= DISC_BLOCK_SIZE;
+            blocks.erase(victim);
+        }
+    }
+
+    /**
+     * Find or start loading a block (called with lock held). New blocks are
+     * appended to batch.
+     */
+    std::shared_ptr<DiscBlock> acquire(const std::shared_ptr<HostFile>& file, uint64_t index,
+                                       bool readahead, std::vector<IoRequest*>& batch) {
+        uint64_t key = (static_cast<uint64_t>(file->id) << 32) | index;
+        auto it = blocks.find(key);
+        if (it != blocks.end()) {
+            DiscBlock* block = it->second.get();
+            if (!readahead) {
+                // Loading blocks join the list when they complete
+                if (block->state == BlockState::Ready) {
+                    lru.splice(lru.end(), lru, block->lru_entry);
+                }
+                stat_hits.fetch_add(1, std::memory_order_relaxed);
+                if (block->readahead) {
+                    block->readahead = false;
+                    stat_readahead_hits.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            return it->second;
+        }
+
+        make_room();
+        auto block = std::make_shared<DiscBlock>();
+        block->key = key;
+        block->offset = index << DISC_BLOCK_SHIFT;
+        block->length = static_cast<uint32_t>(std::min<uint64_t>(DISC_BLOCK_SIZE, file->size - block->offset));
+        block->readahead = readahead;
+        block->data.reset(new uint8_t[DISC_BLOCK_SIZE]);
+        blocks.emplace(key, block);
+        cached_bytes += DISC_BLOCK_SIZE;
+        oc_mem_budget_insert(budget_client, key, DISC_BLOCK_SIZE);
+        if (readahead) {
+            stat_readahead_blocks.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            stat_misses.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        batch.push_back(new IoRequest{block, file});
+        return block;
+    }
+
+    void submit(std::vector<IoRequest*>& batch) {
+        if (batch.empty()) return;
+        stat_submissions.fetch_add(1, std::memory_order_relaxed);
+        backend->submit(batch);
+        batch.clear();
+    }
+
+    /**
+     * Drop every cached block of a file
+     */
+    void drop_file(uint32_t id) {
+        oc_lock_guard<oc_mutex> guard(lock);
+        for (auto it = blocks.begin(); it != blocks.end();) {
+            if ((it->first >> 32) == id && it->second->state != BlockState::Loading) {
+                if (it->second->state == BlockState::Ready) lru.erase(it->second->lru_entry);
+                cached_bytes -= DISC_BLOCK_SIZE;
+                oc_mem_budget_release(budget_client, DISC_BLOCK_SIZE);
+                it = blocks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+// ============================================================================
+// Thread pool backend
+// ============================================================================
+
+class ThreadPoolBackend : public DiscIoBackend {
+    oc_mutex lock;
+    oc_condition_variable wake;
+    std::deque<IoRequest*> queue;
+    std::vector<oc_thread> threads;
+    bool stopping = false;
+
+    void run() {
+        for (;;) {
+            IoRequest* req;
+            {
+                oc_unique_lock<oc_mutex> guard(lock);
+                wake.wait(guard, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                req = queue.front();
+                queue.pop_front();
+            }
+            DiscBlock* block = req->block.get();
+            int64_t done = 0;
+            while (done < block->length) {
+                int64_t n = req->file->pread_at(block->data.get() + done,
+                                                static_cast<uint32_t>(block->length - done),
+                                                block->offset + done);
+                if (n == -EINTR) continue;
+                if (n <= 0) {
+                    if (n < 0) done = n;
+                    break;
+                }
+                done += n;
+            }
+            DiscIoEngine::get().complete(req, done);
+        }
+    }
+
+public:
+    ThreadPoolBackend() {
+        for (uint32_t i = 0; i < IO_THREADS; i++) {
+            threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ~ThreadPoolBackend() override {
+        {
+            oc_lock_guard<oc_mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    void submit(std::vector<IoRequest*>& batch) override {
+        {
+            oc_lock_guard<oc_mutex> guard(lock);
+            for (IoRequest* req : batch) queue.push_back(req);
+        }
+        if (batch.size() == 1) {
+            wake.notify_one();
+        } else {
+            wake.notify_all();
+        }
+    }
+};
+
+// ============================================================================
+// io_uring backend
+// ============================================================================
+
+#ifdef OC_DISC_IO_URING_SUPPORTED
+
+static int uring_setup(uint32_t entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uring_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// The kernel hands requests from the submitter to the reaper, which
+// ThreadSanitizer cannot see
+#if defined(__SANITIZE_THREAD__)
+extern "C" void __tsan_acquire(void* addr);
+extern "C" void __tsan_release(void* addr);
+#define OC_TSAN_ACQUIRE(p) __tsan_acquire(p)
+#define OC_TSAN_RELEASE(p) __tsan_release(p)
+#else
+#define OC_TSAN_ACQUIRE(p) ((void)(p))
+#define OC_TSAN_RELEASE(p) ((void)(p))
+#endif
+
+static int uring_register(int fd, uint32_t opcode, void* arg, uint32_t nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+class UringBackend : public DiscIoBackend {
+    int ring_fd = -1;
+    io_uring_params params{};
+    void* sq_ptr = nullptr;
+    void* cq_ptr = nullptr;
+    size_t sq_size = 0;
+    size_t cq_size = 0;
+    io_uring_sqe* sqes = nullptr;
+
+    uint32_t* sq_head;
+    uint32_t* sq_tail;
+    uint32_t sq_mask;
+    uint32_t* sq_array;
+    uint32_t* cq_head;
+    uint32_t* cq_tail;
+    uint32_t cq_mask;
+    io_uring_cqe* cqes;
+
+    // Submission side: requests in flight are capped at the SQ size so the
+    // completion queue (twice as large) cannot overflow
+    oc_mutex sq_lock;
+    oc_condition_variable slot_free;
+    uint32_t in_flight = 0;
+    oc_thread reaper;
+    std::atomic<bool> stopping{false};
+
+    // Queue one read for the rest of a request (called with sq_lock held)
+    void push_read(IoRequest* req, uint32_t done) {
+        uint32_t tail = *sq_tail;
+        uint32_t index = tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = req->file->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(req->block->data.get() + done);
+        sqe->len = req->block->length - done;
+        sqe->off = req->block->offset + done;
+        sqe->user_data = reinterpret_cast<uint64_t>(req);
+        sq_array[index] = index;
+        OC_TSAN_RELEASE(req);
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    void enter(uint32_t count) {
+        while (count > 0) {
+            int n = uring_enter(ring_fd, count, 0, 0);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                return;
+            }
+            count -= static_cast<uint32_t>(n);
+        }
+    }
+
+    void run() {
+        // Partial progress of requests, keyed by the request
+        std::unordered_map<IoRequest*, uint32_t> progress;
+        while (!stopping.load(std::memory_order_acquire)) {
+            uring_enter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            uint32_t head = *cq_head;
+            uint32_t tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            std::vector<std::pair<IoRequest*, uint32_t>> resubmit;
+            uint32_t finished = 0;
+            for (; head != tail; head++) {
+                io_uring_cqe* cqe = &cqes[head & cq_mask];
+                auto* req = reinterpret_cast<IoRequest*>(cqe->user_data);
+                int res = cqe->res;
+                if (!req) continue;    // Wakeup
+                OC_TSAN_ACQUIRE(req);
+                uint32_t& done = progress[req];
+                if (res == -EINTR || res == -EAGAIN) {
+                    resubmit.emplace_back(req, done);
+                    continue;
+                }
+                if (res > 0) done += static_cast<uint32_t>(res);
+                if (res > 0 && done < req->block->length) {
+                    // Short read: queue the rest
+                    resubmit.emplace_back(req, done);
+                    continue;
+                }
+                int64_t result = res < 0 ? res : static_cast<int64_t>(done);
+                progress.erase(req);
+                finished++;
+                DiscIoEngine::get().complete(req, result);
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+            if (!resubmit.empty() || finished) {
+                oc_lock_guard<oc_mutex> guard(sq_lock);
+                for (auto& r : resubmit) push_read(r.first, r.second);
+                enter(static_cast<uint32_t>(resubmit.size()));
+                in_flight -= finished;
+            }
+            if (finished) slot_free.notify_all();
+        }
+    }
+
+public:
+    bool init() {
+        ring_fd = uring_setup(URING_ENTRIES, &params);
+        if (ring_fd < 0) return false;
+
+        // IORING_OP_READ needs Linux 5.6
+        std::vector<uint8_t> probe_mem(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(probe_mem.data());
+        if (uring_register(ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+            probe->last_op < IORING_OP_READ ||
+            !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sq_size = cq_size = std::max(sq_size, cq_size);
+
+        sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) { sq_ptr = nullptr; return false; }
+        if (single) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) { cq_ptr = nullptr; return false; }
+        }
+        void* sqe_ptr = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (sqe_ptr == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(sqe_ptr);
+
+        auto* sq = static_cast<uint8_t*>(sq_ptr);
+        auto* cq = static_cast<uint8_t*>(cq_ptr);
+        sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        reaper = oc_thread([this] { run(); });
+        return true;
+    }
+
+    ~UringBackend() override {
+        if (reaper.joinable()) {
+            {
+                oc_unique_lock<oc_mutex> guard(sq_lock);
+                slot_free.wait(guard, [this] { return in_flight == 0; });
+                stopping.store(true, std::memory_order_release);
+                // A NOP with no request wakes the reaper
+                uint32_t tail = *sq_tail;
+                uint32_t index = tail & sq_mask;
+                std::memset(&sqes[index], 0, sizeof(io_uring_sqe));
+                sqes[index].opcode = IORING_OP_NOP;
+                sq_array[index] = index;
+                __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+                enter(1);
+            }
+            reaper.join();
+        }
+        if (sqes) munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+        if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+        if (sq_ptr) munmap(sq_ptr, sq_size);
+        if (ring_fd >= 0) close(ring_fd);
+    }
+
+    void submit(std::vector<IoRequest*>& batch) override {
+        oc_unique_lock<oc_mutex> guard(sq_lock);
+        size_t next = 0;
+        while (next < batch.size()) {
+            slot_free.wait(guard, [this] { return in_flight < params.sq_entries; });
+            uint32_t count = 0;
+            while (next < batch.size() && in_flight < params.sq_entries) {
+                push_read(batch[next++], 0);
+                in_flight++;
+                count++;
+            }
+            enter(count);
+        }
+    }
+};
+
+#endif // OC_DISC_IO_URING_SUPPORTED
+
+int DiscIoEngine::ensure_backend(int kind, std::unique_ptr<DiscIoBackend>& retired) {
+    if (backend && (kind == OC_DISC_IO_BACKEND_AUTO || kind == backend_kind)) return 0;
+    if (backend && open_files > 0) return -2;
+    retired = std::move(backend);
+
+#ifdef OC_DISC_IO_URING_SUPPORTED
+    if (kind != OC_DISC_IO_BACKEND_THREADS) {
+        auto uring = std::make_unique<UringBackend>();
+        if (uring->init()) {
+            backend = std::move(uring);
+            backend_kind = OC_DISC_IO_BACKEND_URING;
+            return 0;
+        }
+    }
+#endif
+    if (kind == OC_DISC_IO_BACKEND_URING) return -3;
+    backend = std::make_unique<ThreadPoolBackend>();
+    backend_kind = OC_DISC_IO_BACKEND_THREADS;
+    return 0;
+}
+
+// ============================================================================
+// Files
+// ============================================================================
+
+struct oc_disc_file_t {
+    std::shared_ptr<HostFile> host;
+
+    // Sequential read detection
+    oc_mutex readahead_lock;
+    uint64_t next_offset = 0;       // Where a sequential read would start
+    uint32_t window = 0;            // Read-ahead blocks, 0 while reads are random
+};
+
+/**
+ * Blocks [first, last] of a file's read, plus its read-ahead
+ */
+static void collect_blocks(DiscIoEngine& engine, oc_disc_file_t* file, uint64_t offset, uint64_t size,
+                           std::vector<std::shared_ptr<DiscBlock>>& needed,
+                           std::vector<IoRequest*>& batch) {
+    uint64_t first = offset >> DISC_BLOCK_SHIFT;
+    uint64_t last = (offset + size - 1) >> DISC_BLOCK_SHIFT;
+    uint64_t block_count = (file->host->size + DISC_BLOCK_SIZE - 1) >> DISC_BLOCK_SHIFT;
+
+    uint32_t window;
+    {
+        oc_lock_guard<oc_mutex> guard(file->readahead_lock);
+        // Continuing the previous read, or re-reading inside its last block
+        bool sequential = offset == file->next_offset ||
+                          (offset < file->next_offset && offset >> DISC_BLOCK_SHIFT ==
+                           (file->next_offset - 1) >> DISC_BLOCK_SHIFT);
+        if (sequential) {
+            file->window = file->window ? std::min(file->window * 2, READAHEAD_MAX_BLOCKS)
+                                        : READAHEAD_MIN_BLOCKS;
+        } else {
+            file->window = 0;
+        }
+        file->next_offset = offset + size;
+        window = file->window;
+    }
+
+    oc_lock_guard<oc_mutex> guard(engine.lock);
+    for (uint64_t b = first; b <= last; b++) {
+        engine.lookups.fetch_add(1, std::memory_order_relaxed);
+        needed.push_back(engine.acquire(file->host, b, false, batch));
+    }
+    for (uint64_t b = last + 1; b <= last + window && b < block_count; b++) {
+        engine.acquire(file->host, b, true, batch);
+    }
+}
+
+/**
+ * Wait for the blocks of one read and copy them out
+ * Returns: 0, or the error of the first failed block
+ */
+static int copy_blocks(DiscIoEngine& engine, const std::vector<std::shared_ptr<DiscBlock>>& needed,
+                       uint64_t offset, uint64_t size, uint8_t* out) {
+    auto start = std::chrono::steady_clock::now();
+    bool waited = false;
+    {
+        oc_unique_lock<oc_mutex> guard(engine.lock);
+        for (const auto& block : needed) {
+            if (block->state == BlockState::Loading) {
+                waited = true;
+                engine.block_done.wait(guard, [&block] { return block->state != BlockState::Loading; });
+            }
+            if (block->state == BlockState::Failed) return block->error ? block->error : EIO;
+        }
+    }
+    if (waited) {
+        engine.stat_wait_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+    }
+
+    // Loaded blocks never change, so they are read without the lock
+    for (const auto& block : needed) {
+        uint64_t begin = std::max(offset, block->offset);
+        uint64_t end = std::min(offset + size, block->offset + block->length);
+        std::memcpy(out + (begin - offset), block->data.get() + (begin - block->offset), end - begin);
+    }
+    return 0;
+}
+
+/**
+ * End of the chunk of a read starting at pos. Chunks end on block
+ * boundaries so the next one reads sequentially, and bound the blocks one
+ * read holds at a time.
+ */
+static uint64_t chunk_end(uint64_t pos, uint64_t end) {
+    uint64_t chunk_bytes = static_cast<uint64_t>(READ_CHUNK_BLOCKS) * DISC_BLOCK_SIZE;
+    return std::min(end, (pos & ~static_cast<uint64_t>(DISC_BLOCK_SIZE - 1)) + chunk_bytes);
+}
+
+/**
+ * Read [pos, end) of a file one chunk at a time into out
+ * Returns: 0, or -2 on an I/O error
+ */
+static int read_chunks(DiscIoEngine& engine, oc_disc_file_t* file, uint64_t pos, uint64_t end,
+                       uint8_t* out) {
+    uint64_t start = pos;
+    std::vector<std::shared_ptr<DiscBlock>> needed;
+    std::vector<IoRequest*> batch;
+    while (pos < end) {
+        uint64_t next = chunk_end(pos, end);
+        needed.clear();
+        collect_blocks(engine, file, pos, next - pos, needed, batch);
+        engine.submit(batch);
+        if (copy_blocks(engine, needed, pos, next - pos, out + (pos - start)) != 0) return -2;
+        pos = next;
+    }
+    return 0;
+}
+
+extern "C" {
+
+int oc_disc_io_set_backend(int backend) {
+    if (backend < OC_DISC_IO_BACKEND_AUTO || backend > OC_DISC_IO_BACKEND_THREADS) return -1;
+    DiscIoEngine& engine = DiscIoEngine::get();
+    std::unique_ptr<DiscIoBackend> retired;
+    oc_lock_guard<oc_mutex> guard(engine.lock);
+    return engine.ensure_backend(backend, retired);
+}
+
+int oc_disc_io_get_backend(void) {
+    DiscIoEngine& engine = DiscIoEngine::get();
+    oc_lock_guard<oc_mutex> guard(engine.lock);
+    return engine.backend ? engine.backend_kind : OC_DISC_IO_BACKEND_AUTO;
+}
+
+void oc_disc_io_set_cache_size(uint64_t bytes) {
+    DiscIoEngine& engine = DiscIoEngine::get();
+    oc_lock_guard<oc_mutex> guard(engine.lock);
+    engine.max_bytes = bytes ? bytes : DEFAULT_CACHE_BYTES;
+}
+
+oc_disc_file_t* oc_disc_file_open(const char* path) {
+    if (!path) return nullptr;
+    auto host = std::make_shared<HostFile>();
+    if (!host->open(path)) return nullptr;
+
+    DiscIoEngine& engine = DiscIoEngine::get();
+    std::unique_ptr<DiscIoBackend> retired;
+    oc_lock_guard<oc_mutex> guard(engine.lock);
+    if (engine.ensure_backend(OC_DISC_IO_BACKEND_AUTO, retired) != 0) return nullptr;
+    host->id = engine.next_file_id++;
+    engine.open_files++;
+
+    auto* file = new oc_disc_file_t();
+    file->host = std::move(host);
+    return file;
+}
+
+void oc_disc_file_close(oc_disc_file_t* file) {
+    if (!file) return;
+    DiscIoEngine& engine = DiscIoEngine::get();
+    engine.drop_file(file->host->id);
+    {
+        oc_lock_guard<oc_mutex> guard(engine.lock);
+        engine.open_files--;
+    }
+    // Reads still in flight keep the host file open until they complete
+    delete file;
+}
+
+uint64_t oc_disc_file_get_size(oc_disc_file_t* file) {
+    return file ? file->host->size : 0;
+}
+
+int oc_disc_file_set_decrypt(oc_disc_file_t* file, uint64_t offset, uint64_t size,
+                             const uint8_t* key, const uint8_t* iv) {
+    if (!file || !key || !iv) return -1;
+    DiscIoEngine& engine = DiscIoEngine::get();
+    {
+        oc_lock_guard<oc_mutex> guard(engine.lock);
+        for (const auto& entry : engine.blocks) {
+            if ((entry.first >> 32) == file->host->id && entry.second->state == BlockState::Loading) {
+                return -2;
+            }
+        }
+    }
+    engine.drop_file(file->host->id);
+
+    // Requests in flight share the host file, so a new one takes the range
+    auto host = std::make_shared<HostFile>();
+#if defined(_WIN32)
+    DuplicateHandle(GetCurrentProcess(), file->host->handle, GetCurrentProcess(), &host->handle,
+                    0, FALSE, DUPLICATE_SAME_ACCESS);
+#else
+    host->fd = fcntl(file->host->fd, F_DUPFD_CLOEXEC, 0);
+#endif
+    host->size = file->host->size;
+    host->decrypt = size > 0;
+    host->decrypt_begin = offset;
+    host->decrypt_end = offset + size;
+    host->aes.set_key(key);
+    std::memcpy(host->iv, iv, 16);
+    {
+        oc_lock_guard<oc_mutex> guard(engine.lock);
+        host->id = engine.next_file_id++;
+    }
+    file->host = std::move(host);
+    return 0;
+}
+
+int64_t oc_disc_file_read(oc_disc_file_t* file, uint64_t offset, void* buffer, uint64_t size) {
+    if (!file || (!buffer && size)) return -1;
+    uint64_t file_size = file->host->size;
+    if (offset >= file_size || size == 0) return 0;
+    size = std::min(size, file_size - offset);
+
+    DiscIoEngine& engine = DiscIoEngine::get();
+    engine.stat_reads.fetch_add(1, std::memory_order_relaxed);
+
+    if (read_chunks(engine, file, offset, offset + size, static_cast<uint8_t*>(buffer)) != 0) return -2;
+    engine.stat_bytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<int64_t>(size);
+}
+
+int oc_disc_file_read_batch(oc_disc_file_t* file, oc_disc_io_vec_t* vecs, size_t count) {
+    if (!file || (!vecs && count)) return -1;
+    DiscIoEngine& engine = DiscIoEngine::get();
+    uint64_t file_size = file->host->size;
+
+    // Queue the first chunk of every vector, then submit them together
+    std::vector<std::vector<std::shared_ptr<DiscBlock>>> needed(count);
+    std::vector<IoRequest*> batch;
+    for (size_t i = 0; i < count; i++) {
+        oc_disc_io_vec_t& v = vecs[i];
+        if (!v.buffer && v.size) {
+            v.result = -1;
+            continue;
+        }
+        uint64_t size = v.offset < file_size ? std::min<uint64_t>(v.size, file_size - v.offset) : 0;
+        v.result = static_cast<int64_t>(size);
+        if (size) collect_blocks(engine, file, v.offset, chunk_end(v.offset, v.offset + size) - v.offset,
+                                 needed[i], batch);
+    }
+    engine.submit(batch);
+
+    int failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        oc_disc_io_vec_t& v = vecs[i];
+        if (v.result <= 0) {
+            if (v.result < 0) failed = 1;
+            continue;
+        }
+        engine.stat_reads.fetch_add(1, std::memory_order_relaxed);
+        auto* out = static_cast<uint8_t*>(v.buffer);
+        uint64_t end = v.offset + static_cast<uint64_t>(v.result);
+        uint64_t first_end = chunk_end(v.offset, end);
+        if (copy_blocks(engine, needed[i], v.offset, first_end - v.offset, out) != 0 ||
+            read_chunks(engine, file, first_end, end, out + (first_end - v.offset)) != 0) {
+            v.result = -2;
+            failed = 1;
+            continue;
+        }
+        engine.stat_bytes.fetch_add(static_cast<uint64_t>(v.result), std::memory_order_relaxed);
+    }
+    return failed ? -2 : 0;
+}
+
+int oc_disc_file_prefetch(oc_disc_file_t* file, uint64_t offset, uint64_t size) {
+    if (!file) return -1;
+    uint64_t file_size = file->host->size;
+    if (offset >= file_size || size == 0) return 0;
+    size = std::min(size, file_size - offset);
+
+    DiscIoEngine& engine = DiscIoEngine::get();
+    std::vector<IoRequest*> batch;
+    {
+        oc_lock_guard<oc_mutex> guard(engine.lock);
+        uint64_t last = (offset + size - 1) >> DISC_BLOCK_SHIFT;
+        for (uint64_t b = offset >> DISC_BLOCK_SHIFT; b <= last; b++) {
+            engine.acquire(file->host, b, true, batch);
+        }
+    }
+    int queued = static_cast<int>(batch.size());
+    engine.submit(batch);
+    return queued;
+}
+
+void oc_disc_io_get_stats(oc_disc_io_stats_t* stats) {
+    if (!stats) return;
+    DiscIoEngine& engine = DiscIoEngine::get();
+    stats->reads = engine.stat_reads.load();
+    stats->bytes_read = engine.stat_bytes.load();
+    stats->cache_hits = engine.stat_hits.load();
+    stats->cache_misses = engine.stat_misses.load();
+    stats->readahead_blocks = engine.stat_readahead_blocks.load();
+    stats->readahead_hits = engine.stat_readahead_hits.load();
+    stats->submissions = engine.stat_submissions.load();
+    stats->decrypted_bytes = engine.stat_decrypted.load();
+    stats->errors = engine.stat_errors.load();
+    stats->wait_ns = engine.stat_wait_ns.load();
+    oc_lock_guard<oc_mutex> guard(engine.lock);
+    stats->cached_bytes = engine.cached_bytes;
+    stats->backend = engine.backend ? engine.backend_kind : OC_DISC_IO_BACKEND_AUTO;
+}
+
+void oc_disc_io_reset_stats(void) {
+    DiscIoEngine& engine = DiscIoEngine::get();
+    engine.stat_reads = 0;
+    engine.stat_bytes = 0;
+    engine.stat_hits = 0;
+    engine.stat_misses = 0;
+    engine.stat_readahead_blocks = 0;
+    engine.stat_readahead_hits = 0;
+    engine.stat_submissions = 0;
+    engine.stat_decrypted = 0;
+    engine.stat_errors = 0;
+    engine.stat_wait_ns = 0;
+}
+
+} // extern "C"
@@ -11,6 +11,9 @@
 #include <algorithm>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
 
 // DMA transfer directions
 static constexpr uint8_t DMA_CMD_GET      = 0x40;  // EA → LS (read from main memory)
@@ -52,6 +55,237 @@ struct DmaTagState {
     std::atomic<uint64_t> sequence{0};       // Sequence number for ordering
 };
 
+// Stride prediction for double-buffered GET streams
+static constexpr uint32_t DMA_PREFETCH_MIN_CONFIDENCE = 1;  // Repeats of a stride before predicting
+static constexpr uint32_t DMA_PREFETCH_T0_LIMIT = 4096;     // Larger chunks bypass the near caches
+static constexpr uint32_t DMA_CACHE_LINE = 64;
+
+// Per-tag GET stream state
+struct DmaStreamState {
+    uint32_t last_ea = 0;
+    uint32_t last_size = 0;
+    int64_t stride = 0;
+    uint32_t confidence = 0;      // Consecutive GETs that repeated the stride
+    uint32_t predicted_ea = 0;
+    bool has_prediction = false;
+};
+
+// GET streams of one SPU, or of a thread issuing DMA for no SPU. Only the
+// SPU's own thread takes the lock, so it is uncontended.
+struct alignas(64) DmaStreamSet {
+    std::mutex mutex;
+    DmaStreamState tags[32];
+    uint64_t generation = 0;      // Prefetcher generation the streams belong to
+};
+
+// SPU that the calling thread issues DMA for, -1 for none
+static thread_local int t_dma_current_spu = -1;
+
+// Detects constant-stride GET sequences per (SPU, tag) and prefetches the
+// next chunk
+//
+// SPU jobs double-buffer: while chunk N is processed, chunk N+1 is fetched at
+// a fixed stride. Once a tag repeats its stride, the predicted next chunk is
+// prefetched right after the current GET, so its memory latency overlaps the
+// SPU's work on the current chunk instead of stalling the next GET. Each SPU
+// numbers its tags independently, so streams are kept per SPU; GETs issued
+// for no SPU are tracked per thread.
+struct DmaPrefetcher {
+    std::atomic<bool> enabled{true};
+    DmaStreamSet spus[OC_DMA_HEATMAP_SPUS];
+    std::atomic<uint64_t> generation{0};  // Bumped by reset, which clears streams lazily
+    
+    // Statistics
+    std::atomic<uint64_t> predictions{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> bytes_prefetched{0};
+    
+    static void prefetch_range(const uint8_t* src, uint32_t size) {
+        if (size <= DMA_PREFETCH_T0_LIMIT) {
+            for (uint32_t off = 0; off < size; off += DMA_CACHE_LINE) {
+                __builtin_prefetch(src + off, 0, 3);  // prefetcht0
+            }
+        } else {
+            for (uint32_t off = 0; off < size; off += DMA_CACHE_LINE) {
+                __builtin_prefetch(src + off, 0, 0);  // prefetchnta
+            }
+        }
+    }
+    
+    DmaStreamSet& streams_for(int spu_id) {
+        static thread_local DmaStreamSet unattributed;
+        return (spu_id >= 0 && spu_id < OC_DMA_HEATMAP_SPUS) ? spus[spu_id] : unattributed;
+    }
+    
+    // Record a completed GET and prefetch the predicted next one
+    void observe(int spu_id, uint16_t tag, uint32_t ea, uint32_t size,
+                 const uint8_t* main_memory) {
+        if (!enabled.load(std::memory_order_relaxed)) return;
+        
+        uint32_t next_ea = 0;
+        {
+            auto& set = streams_for(spu_id);
+            std::lock_guard<std::mutex> lock(set.mutex);
+            uint64_t current = generation.load(std::memory_order_relaxed);
+            if (set.generation != current) {
+                for (auto& stream : set.tags) stream = DmaStreamState();
+                set.generation = current;
+            }
+            auto& s = set.tags[tag];
+            if (s.has_prediction) {
+                if (ea == s.predicted_ea && size == s.last_size) {
+                    hits.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    misses.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            
+            int64_t stride = static_cast<int64_t>(ea) - static_cast<int64_t>(s.last_ea);
+            if (size == s.last_size && stride != 0 && stride == s.stride) {
+                s.confidence++;
+            } else {
+                s.stride = stride;
+                s.confidence = 0;
+            }
+            s.last_ea = ea;
+            s.last_size = size;
+            
+            int64_t predicted = static_cast<int64_t>(ea) + s.stride;
+            s.has_prediction = s.confidence >= DMA_PREFETCH_MIN_CONFIDENCE &&
+                               predicted >= 0 && predicted <= UINT32_MAX - size;
+            if (!s.has_prediction) return;
+            s.predicted_ea = static_cast<uint32_t>(predicted);
+            next_ea = s.predicted_ea;
+        }
+        
+        prefetch_range(main_memory + next_ea, size);
+        predictions.fetch_add(1, std::memory_order_relaxed);
+        bytes_prefetched.fetch_add(size, std::memory_order_relaxed);
+    }
+    
+    void reset() {
+        generation.fetch_add(1);
+        predictions.store(0);
+        hits.store(0);
+        misses.store(0);
+        bytes_prefetched.store(0);
+    }
+};
+
+// Heatmap counters are sharded by issuing thread so SPU threads do not
+// contend on a shared lock; snapshots merge the shards.
+static constexpr size_t DMA_HEATMAP_SHARDS = 16;
+
+// One shard of heatmap counters
+struct alignas(64) DmaHeatmapShard {
+    std::mutex mutex;
+    oc_dma_traffic_t spus[OC_DMA_HEATMAP_SPUS] = {};
+    oc_dma_traffic_t tags[32] = {};
+    uint64_t size_histogram[OC_DMA_HEATMAP_SIZE_CLASSES] = {};
+    uint64_t unattributed_ops = 0;
+    std::unordered_map<uint32_t, oc_dma_traffic_t> buckets;
+};
+
+// Per-SPU, per-tag and per-64KB-EA-bucket DMA traffic accounting
+struct DmaHeatmap {
+    std::atomic<bool> enabled{false};
+    DmaHeatmapShard shards[DMA_HEATMAP_SHARDS];
+    std::atomic<uint32_t> next_shard{0};
+    
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
+    static void add(oc_dma_traffic_t& t, uint32_t size, bool is_put, uint64_t stall_ns) {
+        if (is_put) { t.bytes_out += size; t.puts++; }
+        else { t.bytes_in += size; t.gets++; }
+        t.stall_ns += stall_ns;
+    }
+    
+    static void merge(oc_dma_traffic_t& dst, const oc_dma_traffic_t& src) {
+        dst.bytes_in += src.bytes_in;
+        dst.bytes_out += src.bytes_out;
+        dst.gets += src.gets;
+        dst.puts += src.puts;
+        dst.stall_ns += src.stall_ns;
+    }
+    
+    static size_t size_class(uint32_t size) {
+        if (size == 0) return 0;
+        size_t cls = 31 - __builtin_clz(size);
+        return std::min<size_t>(cls, OC_DMA_HEATMAP_SIZE_CLASSES - 1);
+    }
+    
+    DmaHeatmapShard& local_shard() {
+        static thread_local uint32_t index =
+            next_shard.fetch_add(1, std::memory_order_relaxed) % DMA_HEATMAP_SHARDS;
+        return shards[index];
+    }
+    
+    void record(int spu_id, uint16_t tag, uint64_t ea, uint32_t size,
+                bool is_put, uint64_t stall_ns) {
+        if (spu_id < 0) spu_id = t_dma_current_spu;
+        uint32_t bucket = static_cast<uint32_t>(ea) >> OC_DMA_HEATMAP_BUCKET_SHIFT;
+        
+        auto& shard = local_shard();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (spu_id >= 0 && spu_id < OC_DMA_HEATMAP_SPUS) {
+            add(shard.spus[spu_id], size, is_put, stall_ns);
+        } else {
+            shard.unattributed_ops++;
+        }
+        if (tag < 32) add(shard.tags[tag], size, is_put, stall_ns);
+        add(shard.buckets[bucket], size, is_put, stall_ns);
+        shard.size_histogram[size_class(size)]++;
+    }
+    
+    size_t snapshot(oc_dma_heatmap_t* out, oc_dma_bucket_t* buckets, size_t max_buckets) {
+        oc_dma_heatmap_t totals = {};
+        std::unordered_map<uint32_t, oc_dma_traffic_t> merged;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (int i = 0; i < OC_DMA_HEATMAP_SPUS; i++) merge(totals.spus[i], shard.spus[i]);
+            for (int i = 0; i < 32; i++) merge(totals.tags[i], shard.tags[i]);
+            for (int i = 0; i < OC_DMA_HEATMAP_SIZE_CLASSES; i++) {
+                totals.size_histogram[i] += shard.size_histogram[i];
+            }
+            totals.unattributed_ops += shard.unattributed_ops;
+            for (const auto& [bucket, traffic] : shard.buckets) merge(merged[bucket], traffic);
+        }
+        if (out) *out = totals;
+        
+        if (buckets && max_buckets > 0) {
+            std::vector<oc_dma_bucket_t> sorted;
+            sorted.reserve(merged.size());
+            for (const auto& [bucket, traffic] : merged) {
+                sorted.push_back({bucket, 0, traffic});
+            }
+            size_t n = std::min(max_buckets, sorted.size());
+            std::partial_sort(sorted.begin(), sorted.begin() + n, sorted.end(),
+                [](const oc_dma_bucket_t& a, const oc_dma_bucket_t& b) {
+                    uint64_t ab = a.traffic.bytes_in + a.traffic.bytes_out;
+                    uint64_t bb = b.traffic.bytes_in + b.traffic.bytes_out;
+                    return ab != bb ? ab > bb : a.bucket < b.bucket;
+                });
+            std::copy(sorted.begin(), sorted.begin() + n, buckets);
+        }
+        return merged.size();
+    }
+    
+    void reset() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            std::memset(shard.spus, 0, sizeof(shard.spus));
+            std::memset(shard.tags, 0, sizeof(shard.tags));
+            std::memset(shard.size_histogram, 0, sizeof(shard.size_histogram));
+            shard.unattributed_ops = 0;
+            shard.buckets.clear();
+        }
+    }
+};
+
 // DMA engine state
 struct DmaEngine {
     DmaTransfer transfers[MAX_DMA_PENDING];
@@ -68,6 +302,9 @@ struct DmaEngine {
     std::atomic<uint64_t> total_fences{0};
     std::atomic<uint64_t> total_barriers{0};
     
+    DmaPrefetcher prefetcher;
+    DmaHeatmap heatmap;
+    
     DmaEngine() {
         for (auto& t : transfers) {
             t.active = false;
@@ -112,19 +349,29 @@ int oc_dma_transfer(void* local_storage, uint32_t local_addr,
     uint8_t* mm = static_cast<uint8_t*>(main_memory) + static_cast<uint32_t>(ea);
     
     bool is_get = (cmd == DMA_CMD_GET || cmd == DMA_CMD_GETL || cmd == DMA_CMD_GETLB);
+    bool instrument = engine.heatmap.enabled.load(std::memory_order_relaxed);
+    uint64_t start_ns = instrument ? DmaHeatmap::now_ns() : 0;
     
     if (is_get) {
         // EA → LS (read from main memory into local store)
         std::memcpy(ls, mm, size);
         engine.total_gets.fetch_add(1);
         engine.total_bytes_in.fetch_add(size);
+        engine.prefetcher.observe(t_dma_current_spu, tag, static_cast<uint32_t>(ea), size,
+                                  static_cast<const uint8_t*>(main_memory));
     } else {
         // LS → EA (write from local store to main memory)
         std::memcpy(mm, ls, size);
+        oc_mem_track_mark_written(static_cast<uint32_t>(ea), size);
         engine.total_puts.fetch_add(1);
         engine.total_bytes_out.fetch_add(size);
     }
     
+    if (instrument) {
+        engine.heatmap.record(-1, tag, ea, size, !is_get, DmaHeatmap::now_ns() - start_ns);
+    }
+    oc_spu_capture_record_dma(local_storage, local_addr, ea, size, tag, is_get ? 0 : 1);
+    
     // Track in pending for tag completion
     {
         std::lock_guard<std::mutex> lock(engine.transfer_mutex);
@@ -154,6 +401,7 @@ int oc_dma_list_transfer(void* local_storage, uint32_t list_addr,
     bool has_barrier = (cmd == DMA_CMD_GETLB || cmd == DMA_CMD_PUTLB);
     
     auto& engine = g_dma_engine;
+    bool instrument = engine.heatmap.enabled.load(std::memory_order_relaxed);
     
     // If barrier variant, wait for prior transfers on this tag
     if (has_barrier) {
@@ -191,16 +439,27 @@ int oc_dma_list_transfer(void* local_storage, uint32_t list_addr,
         if (transfer_size > 0 && transfer_size <= MAX_DMA_SIZE &&
             data_offset + transfer_size <= 0x40000) {
             uint8_t* mm = static_cast<uint8_t*>(main_memory) + static_cast<uint32_t>(ea);
+            uint64_t start_ns = instrument ? DmaHeatmap::now_ns() : 0;
             
             if (is_get) {
                 // EA → LS: read from main memory into local store data area
                 std::memcpy(ls + data_offset, mm, transfer_size);
                 engine.total_bytes_in.fetch_add(transfer_size);
+                // Gathers walk a table at a fixed stride as often as jobs do
+                engine.prefetcher.observe(t_dma_current_spu, tag, static_cast<uint32_t>(ea),
+                                          transfer_size, static_cast<const uint8_t*>(main_memory));
             } else {
                 // LS → EA: write from local store data area to main memory
                 std::memcpy(mm, ls + data_offset, transfer_size);
+                oc_mem_track_mark_written(static_cast<uint32_t>(ea), transfer_size);
                 engine.total_bytes_out.fetch_add(transfer_size);
             }
+            if (instrument) {
+                engine.heatmap.record(-1, tag, ea, transfer_size, !is_get,
+                                      DmaHeatmap::now_ns() - start_ns);
+            }
+            oc_spu_capture_record_dma(local_storage, data_offset, ea, transfer_size, tag,
+                                      is_get ? 0 : 1);
             data_offset += transfer_size;
         }
         
@@ -326,6 +585,7 @@ void oc_dma_reset_stats(void) {
     engine.total_bytes_out.store(0);
     engine.total_fences.store(0);
     engine.total_barriers.store(0);
+    engine.prefetcher.reset();
     
     // Clear pending transfers
     std::lock_guard<std::mutex> lock(engine.transfer_mutex);
@@ -340,4 +600,65 @@ void oc_dma_reset_stats(void) {
     }
 }
 
+// ============================================================================
+// Predictive GET Prefetching
+// ============================================================================
+
+void oc_dma_prefetch_enable(int enable) {
+    g_dma_engine.prefetcher.enabled.store(enable != 0);
+}
+
+int oc_dma_prefetch_is_enabled(void) {
+    return g_dma_engine.prefetcher.enabled.load() ? 1 : 0;
+}
+
+void oc_dma_prefetch_observe(int spu_id, uint16_t tag, uint64_t ea, uint32_t size,
+                             const void* main_memory) {
+    if (!main_memory || size == 0 || size > MAX_DMA_SIZE || tag > 31) return;
+    if (spu_id < 0) spu_id = t_dma_current_spu;
+    g_dma_engine.prefetcher.observe(spu_id, tag, static_cast<uint32_t>(ea), size,
+                                    static_cast<const uint8_t*>(main_memory));
+}
+
+void oc_dma_prefetch_get_stats(uint64_t* predictions, uint64_t* hits,
+                               uint64_t* misses, uint64_t* bytes_prefetched) {
+    auto& pf = g_dma_engine.prefetcher;
+    if (predictions) *predictions = pf.predictions.load();
+    if (hits) *hits = pf.hits.load();
+    if (misses) *misses = pf.misses.load();
+    if (bytes_prefetched) *bytes_prefetched = pf.bytes_prefetched.load();
+}
+
+// ============================================================================
+// DMA Bandwidth Heatmap
+// ============================================================================
+
+void oc_dma_heatmap_enable(int enable) {
+    g_dma_engine.heatmap.enabled.store(enable != 0);
+}
+
+int oc_dma_heatmap_is_enabled(void) {
+    return g_dma_engine.heatmap.enabled.load() ? 1 : 0;
+}
+
+void oc_dma_heatmap_set_current_spu(int spu_id) {
+    t_dma_current_spu = spu_id;
+}
+
+void oc_dma_heatmap_record(int spu_id, uint16_t tag, uint64_t ea, uint32_t size,
+                           int is_put, uint64_t stall_ns) {
+    auto& heatmap = g_dma_engine.heatmap;
+    if (!heatmap.enabled.load(std::memory_order_relaxed)) return;
+    heatmap.record(spu_id, tag, ea, size, is_put != 0, stall_ns);
+}
+
+size_t oc_dma_heatmap_snapshot(oc_dma_heatmap_t* out,
+                               oc_dma_bucket_t* buckets, size_t max_buckets) {
+    return g_dma_engine.heatmap.snapshot(out, buckets, max_buckets);
+}
+
+void oc_dma_heatmap_reset(void) {
+    g_dma_engine.heatmap.reset();
+}
+
 } // extern "C"
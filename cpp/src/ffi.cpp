@@ -3,8 +3,17 @@
  */
 
 #include "oc_ffi.h"
+#include "oc_threading.h"
 #include <cstdlib>
 
+struct oc_job_group_t {
+    oc_job_group group;
+};
+
+static bool valid_job_lane(int lane) {
+    return lane >= 0 && lane < OC_JOB_LANES;
+}
+
 extern "C" {
 
 int oc_init(void) {
@@ -16,4 +25,66 @@ void oc_shutdown(void) {
     // Shutdown C++ runtime
 }
 
+// ============================================================================
+// Job System
+// ============================================================================
+
+int oc_jobs_submit(oc_job_fn fn, void* user_data, int lane) {
+    if (!fn || !valid_job_lane(lane)) return -1;
+    oc_jobs().submit([fn, user_data] { fn(user_data); }, static_cast<oc_job_lane>(lane));
+    return 0;
+}
+
+oc_job_group_t* oc_job_group_create(void) {
+    return new oc_job_group_t();
+}
+
+int oc_job_group_submit(oc_job_group_t* group, oc_job_fn fn, void* user_data, int lane) {
+    if (!group || !fn || !valid_job_lane(lane)) return -1;
+    oc_jobs().submit(group->group, [fn, user_data] { fn(user_data); },
+                     static_cast<oc_job_lane>(lane));
+    return 0;
+}
+
+void oc_job_group_wait(oc_job_group_t* group) {
+    if (!group) return;
+    oc_jobs().wait(group->group);
+}
+
+void oc_job_group_destroy(oc_job_group_t* group) {
+    if (!group) return;
+    oc_jobs().wait(group->group);
+    delete group;
+}
+
+int oc_jobs_parallel_for(oc_job_range_fn fn, void* user_data,
+                         size_t count, size_t grain, int lane) {
+    if (!fn || !valid_job_lane(lane)) return -1;
+    oc_jobs().parallel_for(count, grain,
+        [fn, user_data](size_t begin, size_t end) { fn(user_data, begin, end); },
+        static_cast<oc_job_lane>(lane));
+    return 0;
+}
+
+size_t oc_jobs_get_worker_count(void) {
+    return oc_jobs().worker_count();
+}
+
+size_t oc_jobs_get_pending(void) {
+    return oc_jobs().pending();
+}
+
+void oc_jobs_get_stats(uint64_t* submitted, uint64_t* executed,
+                       uint64_t* stolen, uint64_t* executed_by_waiters) {
+    auto stats = oc_jobs().get_stats();
+    if (submitted) *submitted = stats.submitted;
+    if (executed) *executed = stats.executed;
+    if (stolen) *stolen = stats.stolen;
+    if (executed_by_waiters) *executed_by_waiters = stats.executed_by_waiters;
+}
+
+void oc_jobs_reset_stats(void) {
+    oc_jobs().reset_stats();
+}
+
 } // extern "C"
@@ -0,0 +1,86 @@
+/**
+ * In-code preemption checks for JIT-compiled regions
+ *
+ * Guest contexts carry the same scheduler fields (interrupt_pending,
+ * budget_enabled, instruction_budget, exit_reason, next_pc) at their own
+ * offsets; a PreemptionLayout describes where they live. The PPU JIT emits
+ * these checks; the SPU JIT preempts only at dispatch.
+ */
+
+#ifndef OC_JIT_PREEMPTION_H
+#define OC_JIT_PREEMPTION_H
+
+#ifdef HAVE_LLVM
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/MDBuilder.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Context offsets of the scheduler fields, and the exit code reported on
+ * preemption. next_pc_bits is the width of the next_pc field.
+ */
+struct PreemptionLayout {
+    size_t interrupt_pending;
+    size_t budget_enabled;
+    size_t instruction_budget;
+    size_t exit_reason;
+    size_t next_pc;
+    unsigned next_pc_bits;
+    uint32_t preempted_exit;
+};
+
+/**
+ * Emit a preemption check at a region entry or loop header
+ *
+ * Exits with layout.preempted_exit and next_pc = resume_pc when
+ * interrupt_pending is set or the enabled instruction budget is used up;
+ * otherwise charges instr_count against the budget. The budget is charged
+ * even when it is disabled, so dispatchers can derive the instructions
+ * executed from how far it moved. The builder is left in the continuation
+ * block; the preemption exit block is returned.
+ */
+inline llvm::BasicBlock* emit_preemption_check(llvm::IRBuilder<>& builder, llvm::Value* context,
+                                               const PreemptionLayout& layout,
+                                               uint32_t instr_count, uint64_t resume_pc) {
+    auto& ctx = builder.getContext();
+    llvm::Function* func = builder.GetInsertBlock()->getParent();
+    auto i8_ty = builder.getInt8Ty();
+    auto i32_ty = builder.getInt32Ty();
+    auto i64_ty = builder.getInt64Ty();
+
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(i8_ty, context, offset);
+    };
+
+    llvm::Value* interrupt = builder.CreateLoad(i32_ty,
+        field(layout.interrupt_pending), true, "interrupt_pending");
+    llvm::Value* enabled = builder.CreateLoad(i32_ty, field(layout.budget_enabled), "budget_enabled");
+    llvm::Value* budget_ptr = field(layout.instruction_budget);
+    llvm::Value* budget = builder.CreateLoad(i64_ty, budget_ptr, "budget");
+
+    llvm::Value* exhausted = builder.CreateAnd(
+        builder.CreateICmpNE(enabled, builder.getInt32(0)),
+        builder.CreateICmpSLE(budget, builder.getInt64(0)));
+    llvm::Value* preempt = builder.CreateOr(
+        builder.CreateICmpNE(interrupt, builder.getInt32(0)), exhausted, "preempt");
+
+    llvm::BasicBlock* preempt_bb = llvm::BasicBlock::Create(ctx, "preempt", func);
+    llvm::BasicBlock* cont_bb = llvm::BasicBlock::Create(ctx, "run", func);
+    llvm::MDBuilder md(ctx);
+    builder.CreateCondBr(preempt, preempt_bb, cont_bb, md.createBranchWeights(1, 1000));
+
+    builder.SetInsertPoint(preempt_bb);
+    builder.CreateStore(builder.getInt32(layout.preempted_exit), field(layout.exit_reason));
+    builder.CreateStore(builder.getIntN(layout.next_pc_bits, resume_pc), field(layout.next_pc));
+    builder.CreateRetVoid();
+
+    // Charged unconditionally: when the budget is disabled the value is
+    // ignored, and skipping the store would cost another branch
+    builder.SetInsertPoint(cont_bb);
+    builder.CreateStore(builder.CreateSub(budget, builder.getInt64(instr_count)), budget_ptr);
+    return preempt_bb;
+}
+#endif // HAVE_LLVM
+
+#endif // OC_JIT_PREEMPTION_H
@@ -0,0 +1,441 @@
+/**
+ * Cache memory budget
+ *
+ * One byte budget shared by every JIT and shader cache (PPU and SPU code,
+ * SPIR-V, linked programs, pipelines), so a process has a predictable
+ * memory ceiling no matter which caches its title stresses. Many emulator
+ * instances share a host, so the default budget is derived from the
+ * process's cgroup memory limit rather than from physical memory.
+ *
+ * Caches charge the bytes they really hold and report entries they evict.
+ * Periodically the budget is split into per-cache targets, which each cache
+ * enforces with its own eviction policy on its next insert. Shares follow
+ * current usage, scaled up by each cache's marginal benefit: the fraction of
+ * its recent lookups that refetched an entry it had evicted, i.e. the hits
+ * it would gain from more memory. A cache whose evictions are never missed
+ * drifts toward a small floor while one that keeps refetching grows.
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+/**
+ * Clients live in chunks that are allocated as registrations need them and
+ * never freed, so a client lookup needs no lock. Per-thread caches (one SPU
+ * code cache per SPU thread) make the count open-ended.
+ */
+static constexpr size_t CLIENT_CHUNK_SIZE = 64;
+static constexpr size_t MAX_CLIENT_CHUNKS = 1024;
+
+/** Evicted keys remembered per cache for refetch detection */
+static constexpr size_t GHOST_CAPACITY = 4096;
+
+/** Every cache is guaranteed 1/(MIN_SHARE_DIVISOR * clients) of the budget */
+static constexpr uint64_t MIN_SHARE_DIVISOR = 4;
+
+/** How strongly refetches pull budget toward a cache */
+static constexpr double BENEFIT_GAIN = 8.0;
+
+/** Minimum time between automatic rebalances */
+static constexpr auto REBALANCE_INTERVAL = std::chrono::milliseconds(10);
+
+/** Budget used when the host limit cannot be determined */
+static constexpr uint64_t FALLBACK_HOST_LIMIT = 4ULL << 30;
+
+// A registered cache
+struct BudgetClient {
+    std::atomic<bool> live{false};
+    char name[32] = {};
+    oc_mem_budget_lookups_fn lookups = nullptr;
+    void* user_data = nullptr;
+
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> target{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> evicted_bytes{0};
+    std::atomic<uint64_t> refetches{0};
+
+    // Recently evicted keys, oldest first
+    oc_mutex ghost_mutex;
+    std::unordered_set<uint64_t> ghosts;
+    std::deque<uint64_t> ghost_order;
+
+    // Rebalance state, under MemoryBudget::mutex
+    uint64_t last_lookups = 0;
+    uint64_t last_refetches = 0;
+    double benefit = 0.0;
+
+    uint64_t lookup_count() const {
+        return lookups ? lookups(user_data) : 0;
+    }
+};
+
+// Budget state
+struct MemoryBudget {
+    std::atomic<BudgetClient*> chunks[MAX_CLIENT_CHUNKS] = {};
+    std::atomic<size_t> chunk_count{0};
+    oc_mutex mutex;                       // Registration and rebalancing
+    std::atomic<uint64_t> limit{0};       // 0 until first use
+    std::atomic<uint64_t> usage{0};
+    std::atomic<int64_t> last_rebalance_ns{0};
+
+    size_t capacity() const {
+        return chunk_count.load(std::memory_order_acquire) * CLIENT_CHUNK_SIZE;
+    }
+
+    // Slot of a client index below capacity()
+    BudgetClient& slot(size_t index) {
+        return chunks[index / CLIENT_CHUNK_SIZE].load(std::memory_order_acquire)[index % CLIENT_CHUNK_SIZE];
+    }
+
+    BudgetClient* get(int client) {
+        if (client < 0 || static_cast<size_t>(client) >= capacity()) return nullptr;
+        BudgetClient* c = &slot(static_cast<size_t>(client));
+        return c->live.load(std::memory_order_acquire) ? c : nullptr;
+    }
+
+    // Caller holds mutex; -1 if every chunk is in use
+    int allocate_locked() {
+        size_t count = capacity();
+        for (size_t i = 0; i < count; i++) {
+            if (!slot(i).live.load(std::memory_order_relaxed)) return static_cast<int>(i);
+        }
+        size_t chunk = chunk_count.load(std::memory_order_relaxed);
+        if (chunk == MAX_CLIENT_CHUNKS) return -1;
+        chunks[chunk].store(new BudgetClient[CLIENT_CHUNK_SIZE], std::memory_order_release);
+        chunk_count.store(chunk + 1, std::memory_order_release);
+        return static_cast<int>(count);
+    }
+
+    uint64_t get_limit() {
+        uint64_t value = limit.load(std::memory_order_relaxed);
+        if (value == 0) {
+            value = std::max<uint64_t>(oc_mem_budget_detect_host_limit() / 4, 1);
+            limit.store(value, std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    void release(BudgetClient* c, uint64_t bytes) {
+        // Never underflow on a double release; clamp at zero
+        uint64_t held = c->bytes.load(std::memory_order_relaxed);
+        uint64_t freed;
+        do {
+            freed = std::min(held, bytes);
+        } while (!c->bytes.compare_exchange_weak(held, held - freed, std::memory_order_relaxed));
+        usage.fetch_sub(freed, std::memory_order_relaxed);
+    }
+
+    /**
+     * Rebalance if over budget or the interval has passed, unless another
+     * thread is already doing it
+     */
+    void maybe_rebalance() {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t last = last_rebalance_ns.load(std::memory_order_relaxed);
+        bool over = usage.load(std::memory_order_relaxed) > get_limit();
+        if (!over && now - last < std::chrono::nanoseconds(REBALANCE_INTERVAL).count()) return;
+        if (!mutex.try_lock()) return;
+        rebalance_locked();
+        last_rebalance_ns.store(now, std::memory_order_relaxed);
+        mutex.unlock();
+    }
+
+    // Caller holds mutex
+    void rebalance_locked() {
+        uint64_t total = get_limit();
+        size_t slots = capacity();
+        size_t count = 0;
+        for (size_t i = 0; i < slots; i++) {
+            if (slot(i).live.load(std::memory_order_acquire)) count++;
+        }
+        if (count == 0) return;
+
+        uint64_t floor = total / (MIN_SHARE_DIVISOR * count);
+        std::vector<double> weights(slots, 0.0);
+        double weight_sum = 0.0;
+        for (size_t i = 0; i < slots; i++) {
+            BudgetClient& c = slot(i);
+            if (!c.live.load(std::memory_order_acquire)) continue;
+
+            uint64_t lookups = c.lookup_count();
+            uint64_t refetches = c.refetches.load(std::memory_order_relaxed);
+            uint64_t window_lookups = lookups - std::min(lookups, c.last_lookups);
+            uint64_t window_refetches = refetches - std::min(refetches, c.last_refetches);
+            c.last_lookups = lookups;
+            c.last_refetches = refetches;
+
+            // Without lookup counts, refetches are measured against inserts
+            double rate = 0.0;
+            if (window_refetches) {
+                rate = window_lookups ? std::min(1.0, double(window_refetches) / double(window_lookups))
+                                      : 1.0;
+            }
+            c.benefit = 0.5 * c.benefit + 0.5 * rate;
+
+            double held = double(std::max(c.bytes.load(std::memory_order_relaxed), floor));
+            weights[i] = held * (1.0 + BENEFIT_GAIN * c.benefit);
+            weight_sum += weights[i];
+        }
+
+        uint64_t spare = total - floor * count;
+        for (size_t i = 0; i < slots; i++) {
+            BudgetClient& c = slot(i);
+            if (!c.live.load(std::memory_order_acquire)) continue;
+            double share = weight_sum > 0.0 ? weights[i] / weight_sum : 1.0 / double(count);
+            c.target.store(floor + static_cast<uint64_t>(double(spare) * share),
+                           std::memory_order_relaxed);
+        }
+    }
+};
+
+static MemoryBudget g_mem_budget;
+
+// ============================================================================
+// Host Limit Detection
+// ============================================================================
+
+#if defined(__linux__)
+/**
+ * Read a cgroup limit file; 0 if missing or unlimited
+ */
+static uint64_t read_cgroup_limit(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (!f) return 0;
+    char buf[64] = {};
+    bool ok = std::fgets(buf, sizeof(buf), f) != nullptr;
+    std::fclose(f);
+    if (!ok || std::strncmp(buf, "max", 3) == 0) return 0;
+    unsigned long long value = std::strtoull(buf, nullptr, 10);
+    // cgroup v1 reports "unlimited" as a huge page-rounded value
+    return value >= (1ULL << 60) ? 0 : value;
+}
+
+/**
+ * Tightest limit among the files on a cgroup path and its ancestors
+ */
+static uint64_t walk_cgroup_limits(const std::string& root, std::string path,
+                                   const char* const* files, size_t file_count) {
+    uint64_t limit = 0;
+    while (true) {
+        for (size_t i = 0; i < file_count; i++) {
+            uint64_t value = read_cgroup_limit(root + path + "/" + files[i]);
+            if (value && (!limit || value < limit)) limit = value;
+        }
+        if (path.empty() || path == "/") break;
+        size_t slash = path.find_last_of('/');
+        path = slash == std::string::npos ? "" : path.substr(0, slash);
+    }
+    return limit;
+}
+
+static uint64_t detect_cgroup_limit() {
+    FILE* f = std::fopen("/proc/self/cgroup", "r");
+    if (!f) return 0;
+
+    uint64_t limit = 0;
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        // hierarchy-id:controllers:path
+        std::string entry(line);
+        if (!entry.empty() && entry.back() == '\n') entry.pop_back();
+        size_t first = entry.find(':');
+        size_t second = first == std::string::npos ? first : entry.find(':', first + 1);
+        if (second == std::string::npos) continue;
+        std::string controllers = entry.substr(first + 1, second - first - 1);
+        std::string path = entry.substr(second + 1);
+        if (path == "/") path.clear();
+
+        uint64_t value = 0;
+        if (controllers.empty()) {
+            static const char* const v2_files[] = {"memory.max", "memory.high"};
+            value = walk_cgroup_limits("/sys/fs/cgroup", path, v2_files, 2);
+        } else if (("," + controllers + ",").find(",memory,") != std::string::npos) {
+            static const char* const v1_files[] = {"memory.limit_in_bytes"};
+            value = walk_cgroup_limits("/sys/fs/cgroup/memory", path, v1_files, 1);
+        }
+        if (value && (!limit || value < limit)) limit = value;
+    }
+    std::fclose(f);
+    return limit;
+}
+#endif
+
+static uint64_t detect_physical_memory() {
+#if defined(__unix__) || defined(__APPLE__)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && page_size > 0) {
+        return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+    }
+#endif
+    return 0;
+}
+
+// ============================================================================
+// C API
+// ============================================================================
+
+extern "C" {
+
+int oc_mem_budget_register(const char* name, oc_mem_budget_lookups_fn lookups, void* user_data) {
+    if (!name) return -1;
+    auto& b = g_mem_budget;
+    oc_lock_guard<oc_mutex> lock(b.mutex);
+    int index = b.allocate_locked();
+    if (index < 0) return -2;
+
+    BudgetClient& c = b.slot(static_cast<size_t>(index));
+    std::snprintf(c.name, sizeof(c.name), "%s", name);
+    c.lookups = lookups;
+    c.user_data = user_data;
+    c.bytes.store(0, std::memory_order_relaxed);
+    c.evictions.store(0, std::memory_order_relaxed);
+    c.evicted_bytes.store(0, std::memory_order_relaxed);
+    c.refetches.store(0, std::memory_order_relaxed);
+    {
+        oc_lock_guard<oc_mutex> ghost_lock(c.ghost_mutex);
+        c.ghosts.clear();
+        c.ghost_order.clear();
+    }
+    c.last_lookups = c.lookup_count();
+    c.last_refetches = 0;
+    c.benefit = 0.0;
+    c.target.store(b.get_limit(), std::memory_order_relaxed);
+    c.live.store(true, std::memory_order_release);
+    b.rebalance_locked();
+    return index;
+}
+
+void oc_mem_budget_unregister(int client) {
+    auto& b = g_mem_budget;
+    oc_lock_guard<oc_mutex> lock(b.mutex);
+    BudgetClient* c = b.get(client);
+    if (!c) return;
+    c->live.store(false, std::memory_order_release);
+    b.release(c, c->bytes.load(std::memory_order_relaxed));
+    b.rebalance_locked();
+}
+
+void oc_mem_budget_insert(int client, uint64_t key, uint64_t bytes) {
+    auto& b = g_mem_budget;
+    BudgetClient* c = b.get(client);
+    if (!c) return;
+    c->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    b.usage.fetch_add(bytes, std::memory_order_relaxed);
+    {
+        oc_lock_guard<oc_mutex> lock(c->ghost_mutex);
+        if (c->ghosts.erase(key)) {
+            c->refetches.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    b.maybe_rebalance();
+}
+
+void oc_mem_budget_evict(int client, uint64_t key, uint64_t bytes) {
+    auto& b = g_mem_budget;
+    BudgetClient* c = b.get(client);
+    if (!c) return;
+    b.release(c, bytes);
+    c->evictions.fetch_add(1, std::memory_order_relaxed);
+    c->evicted_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    oc_lock_guard<oc_mutex> lock(c->ghost_mutex);
+    if (c->ghosts.insert(key).second) {
+        c->ghost_order.push_back(key);
+    }
+    // The order may still list keys already refetched; dropping those early
+    // only shortens how long they are remembered
+    while (c->ghost_order.size() > GHOST_CAPACITY) {
+        c->ghosts.erase(c->ghost_order.front());
+        c->ghost_order.pop_front();
+    }
+}
+
+void oc_mem_budget_release(int client, uint64_t bytes) {
+    auto& b = g_mem_budget;
+    BudgetClient* c = b.get(client);
+    if (!c) return;
+    b.release(c, bytes);
+}
+
+uint64_t oc_mem_budget_get_target(int client) {
+    auto& b = g_mem_budget;
+    BudgetClient* c = b.get(client);
+    return c ? c->target.load(std::memory_order_relaxed) : b.get_limit();
+}
+
+uint64_t oc_mem_budget_detect_host_limit(void) {
+    uint64_t limit = 0;
+#if defined(__linux__)
+    limit = detect_cgroup_limit();
+#endif
+    uint64_t physical = detect_physical_memory();
+    if (physical && (!limit || physical < limit)) limit = physical;
+    return limit ? limit : FALLBACK_HOST_LIMIT;
+}
+
+void oc_mem_budget_set_limit(uint64_t bytes) {
+    auto& b = g_mem_budget;
+    oc_lock_guard<oc_mutex> lock(b.mutex);
+    b.limit.store(bytes, std::memory_order_relaxed);
+    b.rebalance_locked();
+}
+
+uint64_t oc_mem_budget_get_limit(void) {
+    return g_mem_budget.get_limit();
+}
+
+uint64_t oc_mem_budget_get_usage(void) {
+    return g_mem_budget.usage.load(std::memory_order_relaxed);
+}
+
+void oc_mem_budget_rebalance(void) {
+    auto& b = g_mem_budget;
+    oc_lock_guard<oc_mutex> lock(b.mutex);
+    b.rebalance_locked();
+}
+
+size_t oc_mem_budget_get_clients(oc_mem_budget_client_stats_t* stats, size_t max_clients) {
+    auto& b = g_mem_budget;
+    oc_lock_guard<oc_mutex> lock(b.mutex);
+    size_t written = 0;
+    size_t slots = b.capacity();
+    for (size_t i = 0; i < slots; i++) {
+        BudgetClient& c = b.slot(i);
+        if (stats && written == max_clients) break;
+        if (!c.live.load(std::memory_order_acquire)) continue;
+        if (!stats) {
+            written++;
+            continue;
+        }
+        oc_mem_budget_client_stats_t& s = stats[written++];
+        std::memset(&s, 0, sizeof(s));
+        std::memcpy(s.name, c.name, sizeof(s.name));
+        s.bytes = c.bytes.load(std::memory_order_relaxed);
+        s.target = c.target.load(std::memory_order_relaxed);
+        s.lookups = c.lookup_count();
+        s.evictions = c.evictions.load(std::memory_order_relaxed);
+        s.evicted_bytes = c.evicted_bytes.load(std::memory_order_relaxed);
+        s.refetches = c.refetches.load(std::memory_order_relaxed);
+        s.marginal_benefit = c.benefit;
+    }
+    return written;
+}
+
+} // extern "C"
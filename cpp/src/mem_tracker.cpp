@@ -0,0 +1,519 @@
+/**
+ * Guest memory write tracking
+ *
+ * One service that tells every cache (PPU/SPU code, shader microcode,
+ * textures, vertex data) when guest memory changes, so caches validate with
+ * a generation compare instead of rehashing data.
+ *
+ * Guest main and RSX memory are registered as regions tracked at 4KB page
+ * granularity. Each page has a dirty bit, a generation counter and an
+ * "armed" bit. A write to an armed page disarms it and bumps the generation
+ * of every subscription covering the page; later writes to the same page
+ * cost nothing until a subscriber re-arms it. Writes are observed either
+ * through explicit marks (memory manager writes, DMA PUTs) or, for regions
+ * registered with OC_MEM_TRACK_PROTECT, by write-protecting armed pages and
+ * catching the first write fault.
+ *
+ * Everything the fault handler touches is a fixed-size array of atomics,
+ * so it never takes a lock. Subscription callbacks raised from a fault are
+ * deferred to oc_mem_track_dispatch() (or the next explicit mark). Lock-free
+ * users of a region's page arrays are counted, and removing a region waits
+ * for them before freeing the arrays. Likewise each subscription counts its
+ * running callbacks, and unsubscribing waits for them.
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <signal.h>
+#include <unistd.h>
+#define OC_MEM_TRACK_HAVE_MPROTECT 1
+#endif
+
+// Tracking granularity (guest page size)
+static constexpr uint32_t TRACK_PAGE_SHIFT = 12;
+static constexpr uint32_t TRACK_PAGE_SIZE = 1u << TRACK_PAGE_SHIFT;
+
+static constexpr size_t MAX_TRACK_REGIONS = 16;
+static constexpr size_t MAX_TRACK_SUBSCRIPTIONS = 4096;
+
+// Per-page state bits
+static constexpr uint8_t PAGE_DIRTY = 0x1;   // Written since the last collect
+static constexpr uint8_t PAGE_ARMED = 0x2;   // Next write must be reported
+
+struct TrackSubscription;
+
+// Subscription whose callback this thread is running
+static thread_local const TrackSubscription* t_dispatching = nullptr;
+
+// A tracked guest memory range
+struct TrackedRegion {
+    std::atomic<bool> live{false};
+    std::atomic<bool> retiring{false};        // Being removed: faults only unprotect
+    uint32_t guest_base = 0;
+    uint64_t size = 0;
+    uint8_t* host_base = nullptr;
+    bool protect = false;
+    std::unique_ptr<std::atomic<uint8_t>[]> state;
+    std::unique_ptr<std::atomic<uint32_t>[]> generation;
+
+    uint64_t page_count() const { return size >> TRACK_PAGE_SHIFT; }
+
+    bool contains(uint32_t addr) const {
+        return addr >= guest_base && static_cast<uint64_t>(addr) - guest_base < size;
+    }
+};
+
+// A range subscription
+struct TrackSubscription {
+    std::atomic<bool> live{false};
+    uint32_t start = 0;
+    uint64_t end = 0;                         // Exclusive
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> callback_pending{false};
+    std::atomic<uint32_t> pending_addr{0};    // Page that triggered the pending callback
+    std::atomic<uint32_t> in_flight{0};       // Dispatches past the live check
+    oc_mem_track_callback callback = nullptr;
+    void* user_data = nullptr;
+};
+
+// Write tracking state
+struct MemoryWriteTracker {
+    TrackedRegion regions[MAX_TRACK_REGIONS];
+    TrackSubscription subscriptions[MAX_TRACK_SUBSCRIPTIONS];
+    std::atomic<size_t> region_count{0};
+    std::atomic<size_t> subscription_limit{0};  // One past the highest slot ever used
+    std::atomic<size_t> pending_callbacks{0};
+    std::atomic<uint32_t> readers{0};           // Lock-free users of region page arrays
+    oc_mutex mutex;                             // Serializes registration changes
+    bool protect_supported = false;
+
+    // Statistics
+    std::atomic<uint64_t> marks{0};
+    std::atomic<uint64_t> faults{0};
+    std::atomic<uint64_t> notifications{0};
+    std::atomic<uint64_t> rearms{0};
+
+#ifdef OC_MEM_TRACK_HAVE_MPROTECT
+    struct sigaction previous_segv = {};
+    struct sigaction previous_bus = {};
+    bool handler_installed = false;
+#endif
+
+    MemoryWriteTracker() {
+#ifdef OC_MEM_TRACK_HAVE_MPROTECT
+        // Protection works on host pages, which must match the tracking page
+        protect_supported = sysconf(_SC_PAGESIZE) == static_cast<long>(TRACK_PAGE_SIZE);
+#endif
+    }
+
+    /**
+     * Pins region page arrays for lock-free use; removal waits for it
+     */
+    struct ReadScope {
+        MemoryWriteTracker& tracker;
+        explicit ReadScope(MemoryWriteTracker& t) : tracker(t) { tracker.readers.fetch_add(1); }
+        ~ReadScope() { tracker.readers.fetch_sub(1); }
+    };
+
+    TrackedRegion* region_for(uint32_t addr) {
+        for (auto& r : regions) {
+            if (r.live.load(std::memory_order_acquire) && r.contains(addr)) return &r;
+        }
+        return nullptr;
+    }
+
+    TrackSubscription* subscription_at(int id) {
+        if (id < 0 || static_cast<size_t>(id) >= MAX_TRACK_SUBSCRIPTIONS) return nullptr;
+        auto& sub = subscriptions[id];
+        return sub.live.load(std::memory_order_acquire) ? &sub : nullptr;
+    }
+
+    static void set_protection(TrackedRegion& r, uint64_t page, uint64_t count, bool writable) {
+#ifdef OC_MEM_TRACK_HAVE_MPROTECT
+        mprotect(r.host_base + (page << TRACK_PAGE_SHIFT), count << TRACK_PAGE_SHIFT,
+                 writable ? (PROT_READ | PROT_WRITE) : PROT_READ);
+#else
+        (void)r; (void)page; (void)count; (void)writable;
+#endif
+    }
+
+    /**
+     * Bump every subscription covering the page at guest address `addr`.
+     * Lock-free; callbacks are only flagged here.
+     */
+    void notify_page(uint32_t addr) {
+        uint64_t page_start = addr & ~(TRACK_PAGE_SIZE - 1);
+        uint64_t page_end = page_start + TRACK_PAGE_SIZE;
+        size_t limit = subscription_limit.load(std::memory_order_acquire);
+        for (size_t i = 0; i < limit; i++) {
+            auto& sub = subscriptions[i];
+            if (!sub.live.load(std::memory_order_acquire)) continue;
+            if (sub.start >= page_end || sub.end <= page_start) continue;
+            sub.generation.fetch_add(1, std::memory_order_acq_rel);
+            notifications.fetch_add(1, std::memory_order_relaxed);
+            if (sub.callback) {
+                sub.pending_addr.store(static_cast<uint32_t>(page_start), std::memory_order_relaxed);
+                if (!sub.callback_pending.exchange(true, std::memory_order_acq_rel)) {
+                    pending_callbacks.fetch_add(1, std::memory_order_acq_rel);
+                }
+            }
+        }
+    }
+
+    /**
+     * Record a write to one page. Returns true if the page was armed.
+     */
+    bool observe_page(TrackedRegion& r, uint64_t page) {
+        uint8_t state = r.state[page].load(std::memory_order_acquire);
+        if (state == PAGE_DIRTY) return false;  // Already seen, nobody waiting
+
+        state = r.state[page].fetch_or(PAGE_DIRTY, std::memory_order_acq_rel);
+        if (!(state & PAGE_DIRTY) || (state & PAGE_ARMED)) {
+            r.generation[page].fetch_add(1, std::memory_order_acq_rel);
+        }
+        if (!(state & PAGE_ARMED)) return false;
+
+        state = r.state[page].fetch_and(static_cast<uint8_t>(~PAGE_ARMED), std::memory_order_acq_rel);
+        if (!(state & PAGE_ARMED)) return false;  // Another writer reported it
+
+        if (r.protect) set_protection(r, page, 1, true);
+        notify_page(static_cast<uint32_t>(r.guest_base + (page << TRACK_PAGE_SHIFT)));
+        return true;
+    }
+
+    void mark_written(uint32_t addr, uint32_t size) {
+        if (size == 0) return;
+        uint64_t end = static_cast<uint64_t>(addr) + size;
+        uint64_t a = addr;
+        while (a < end) {
+            TrackedRegion* r = region_for(static_cast<uint32_t>(a));
+            if (!r) {
+                a = (a & ~static_cast<uint64_t>(TRACK_PAGE_SIZE - 1)) + TRACK_PAGE_SIZE;
+                continue;
+            }
+            uint64_t region_end = static_cast<uint64_t>(r->guest_base) + r->size;
+            uint64_t stop = end < region_end ? end : region_end;
+            uint64_t first = (a - r->guest_base) >> TRACK_PAGE_SHIFT;
+            uint64_t last = (stop - 1 - r->guest_base) >> TRACK_PAGE_SHIFT;
+            for (uint64_t p = first; p <= last; p++) observe_page(*r, p);
+            a = stop;
+        }
+        marks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Arm [start, end) so the next write to each page is reported.
+     * The range must lie inside region r.
+     */
+    void arm_range(TrackedRegion& r, uint64_t start, uint64_t end) {
+        uint64_t first = (start - r.guest_base) >> TRACK_PAGE_SHIFT;
+        uint64_t last = (end - 1 - r.guest_base) >> TRACK_PAGE_SHIFT;
+        uint64_t run = first;
+        for (uint64_t p = first; p <= last; p++) {
+            uint8_t prev = r.state[p].fetch_or(PAGE_ARMED, std::memory_order_acq_rel);
+            bool newly = !(prev & PAGE_ARMED);
+            // Batch protection changes over runs of newly armed pages
+            if (!newly || p == last) {
+                uint64_t run_end = newly ? p + 1 : p;
+                if (r.protect && run_end > run) set_protection(r, run, run_end - run, false);
+                run = p + 1;
+            }
+        }
+    }
+
+    size_t dispatch() {
+        if (pending_callbacks.load(std::memory_order_acquire) == 0) return 0;
+        size_t count = 0;
+        size_t limit = subscription_limit.load(std::memory_order_acquire);
+        for (size_t i = 0; i < limit; i++) {
+            auto& sub = subscriptions[i];
+            if (!sub.callback_pending.load(std::memory_order_acquire)) continue;
+            if (!sub.callback_pending.exchange(false, std::memory_order_acq_rel)) continue;
+            pending_callbacks.fetch_sub(1, std::memory_order_acq_rel);
+            // Counted before the live check (both seq_cst): unsubscribe
+            // either stops this call or waits for it
+            sub.in_flight.fetch_add(1);
+            if (sub.live.load() && sub.callback) {
+                const TrackSubscription* outer = t_dispatching;
+                t_dispatching = &sub;
+                sub.callback(sub.user_data, static_cast<int>(i),
+                             sub.pending_addr.load(std::memory_order_relaxed));
+                t_dispatching = outer;
+                count++;
+            }
+            sub.in_flight.fetch_sub(1);
+        }
+        return count;
+    }
+
+#ifdef OC_MEM_TRACK_HAVE_MPROTECT
+    /**
+     * Handle a write fault on a protected page. Returns false if the fault
+     * is not ours.
+     */
+    bool handle_fault(void* fault_addr) {
+        uint8_t* p = static_cast<uint8_t*>(fault_addr);
+        ReadScope scope(*this);
+        for (auto& r : regions) {
+            bool live = r.live.load();
+            if ((!live && !r.retiring.load()) || !r.protect) continue;
+            if (p < r.host_base || p >= r.host_base + r.size) continue;
+
+            uint64_t page = static_cast<uint64_t>(p - r.host_base) >> TRACK_PAGE_SHIFT;
+            faults.fetch_add(1, std::memory_order_relaxed);
+            if (live) observe_page(r, page);
+            // Unprotect even if the page was disarmed concurrently
+            set_protection(r, page, 1, true);
+            return true;
+        }
+        return false;
+    }
+
+    void install_handler();
+#endif
+};
+
+static MemoryWriteTracker g_mem_tracker;
+
+#ifdef OC_MEM_TRACK_HAVE_MPROTECT
+static void chain_signal(const struct sigaction& previous, int sig, siginfo_t* info, void* ctx) {
+    if (previous.sa_flags & SA_SIGINFO) {
+        if (previous.sa_sigaction) {
+            previous.sa_sigaction(sig, info, ctx);
+            return;
+        }
+    } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+        previous.sa_handler(sig);
+        return;
+    }
+    // Default action: restore it and let the faulting access re-trap
+    signal(sig, SIG_DFL);
+}
+
+static void mem_track_fault_handler(int sig, siginfo_t* info, void* ctx) {
+    if (g_mem_tracker.handle_fault(info->si_addr)) return;
+    chain_signal(sig == SIGBUS ? g_mem_tracker.previous_bus : g_mem_tracker.previous_segv,
+                 sig, info, ctx);
+}
+
+void MemoryWriteTracker::install_handler() {
+    if (handler_installed) return;
+    struct sigaction sa = {};
+    sa.sa_sigaction = mem_track_fault_handler;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &previous_segv);
+    // macOS reports protection faults as SIGBUS
+    sigaction(SIGBUS, &sa, &previous_bus);
+    handler_installed = true;
+}
+#endif
+
+extern "C" {
+
+// ============================================================================
+// Guest Memory Write Tracking
+// ============================================================================
+
+int oc_mem_track_add_region(uint32_t guest_base, uint64_t size, void* host_base, int flags) {
+    auto& t = g_mem_tracker;
+    if (size == 0 || (guest_base & (TRACK_PAGE_SIZE - 1)) || (size & (TRACK_PAGE_SIZE - 1))) return -1;
+    if (static_cast<uint64_t>(guest_base) + size > 0x100000000ULL) return -1;
+    bool protect = (flags & OC_MEM_TRACK_PROTECT) != 0;
+    if (protect) {
+        if (!t.protect_supported) return -3;
+        if (!host_base || (reinterpret_cast<uintptr_t>(host_base) & (TRACK_PAGE_SIZE - 1))) return -1;
+    }
+
+    oc_lock_guard<oc_mutex> lock(t.mutex);
+    uint64_t end = static_cast<uint64_t>(guest_base) + size;
+    for (auto& r : t.regions) {
+        if (!r.live.load() ) continue;
+        uint64_t r_end = static_cast<uint64_t>(r.guest_base) + r.size;
+        if (guest_base < r_end && r.guest_base < end) return -2;  // Overlap
+    }
+    for (size_t i = 0; i < MAX_TRACK_REGIONS; i++) {
+        auto& r = t.regions[i];
+        if (r.live.load()) continue;
+        uint64_t pages = size >> TRACK_PAGE_SHIFT;
+        r.guest_base = guest_base;
+        r.size = size;
+        r.host_base = static_cast<uint8_t*>(host_base);
+        r.protect = protect;
+        r.state.reset(new std::atomic<uint8_t>[pages]);
+        r.generation.reset(new std::atomic<uint32_t>[pages]);
+        for (uint64_t p = 0; p < pages; p++) {
+            r.state[p].store(0, std::memory_order_relaxed);
+            r.generation[p].store(0, std::memory_order_relaxed);
+        }
+#ifdef OC_MEM_TRACK_HAVE_MPROTECT
+        if (protect) t.install_handler();
+#endif
+        r.live.store(true, std::memory_order_release);
+        t.region_count.fetch_add(1);
+        return static_cast<int>(i);
+    }
+    return -4;
+}
+
+int oc_mem_track_remove_region(int region) {
+    auto& t = g_mem_tracker;
+    if (region < 0 || static_cast<size_t>(region) >= MAX_TRACK_REGIONS) return -1;
+    oc_lock_guard<oc_mutex> lock(t.mutex);
+    auto& r = t.regions[region];
+    if (!r.live.load()) return -1;
+    r.retiring.store(true);
+    r.live.store(false);
+    t.region_count.fetch_sub(1);
+    // Marks, collects and faults that saw the region live may still be
+    // using its arrays or arming its pages
+    while (t.readers.load() != 0) std::this_thread::yield();
+    if (r.protect) MemoryWriteTracker::set_protection(r, 0, r.page_count(), true);
+    r.state.reset();
+    r.generation.reset();
+    r.retiring.store(false);
+    return 0;
+}
+
+void oc_mem_track_mark_written(uint32_t addr, uint32_t size) {
+    auto& t = g_mem_tracker;
+    if (t.region_count.load(std::memory_order_relaxed) == 0) return;
+    {
+        MemoryWriteTracker::ReadScope scope(t);
+        t.mark_written(addr, size);
+    }
+    t.dispatch();
+}
+
+uint32_t oc_mem_track_get_page_generation(uint32_t addr) {
+    MemoryWriteTracker::ReadScope scope(g_mem_tracker);
+    TrackedRegion* r = g_mem_tracker.region_for(addr);
+    if (!r) return 0;
+    return r->generation[(addr - r->guest_base) >> TRACK_PAGE_SHIFT].load(std::memory_order_acquire);
+}
+
+size_t oc_mem_track_collect_dirty(uint32_t addr, uint32_t size,
+                                  uint64_t* bitmap, size_t bitmap_words) {
+    auto& t = g_mem_tracker;
+    if (size == 0) return 0;
+    MemoryWriteTracker::ReadScope scope(t);
+    TrackedRegion* r = t.region_for(addr);
+    if (!r) return 0;
+    uint64_t end = static_cast<uint64_t>(addr) + size;
+    uint64_t region_end = static_cast<uint64_t>(r->guest_base) + r->size;
+    if (end > region_end) end = region_end;
+
+    uint64_t first = (addr - r->guest_base) >> TRACK_PAGE_SHIFT;
+    uint64_t last = (end - 1 - r->guest_base) >> TRACK_PAGE_SHIFT;
+    if (bitmap) std::memset(bitmap, 0, bitmap_words * sizeof(uint64_t));
+
+    size_t dirty = 0;
+    for (uint64_t p = first; p <= last; p++) {
+        uint8_t prev = r->state[p].fetch_and(static_cast<uint8_t>(~PAGE_DIRTY), std::memory_order_acq_rel);
+        if (!(prev & PAGE_DIRTY)) continue;
+        uint64_t bit = p - first;
+        if (bitmap && bit / 64 < bitmap_words) bitmap[bit / 64] |= 1ULL << (bit % 64);
+        dirty++;
+    }
+    // Observe the next write to every collected page
+    t.arm_range(*r, r->guest_base + (first << TRACK_PAGE_SHIFT),
+                r->guest_base + ((last + 1) << TRACK_PAGE_SHIFT));
+    return dirty;
+}
+
+int oc_mem_track_subscribe(uint32_t addr, uint32_t size,
+                           oc_mem_track_callback callback, void* user_data) {
+    auto& t = g_mem_tracker;
+    if (size == 0) return -1;
+    uint64_t end = static_cast<uint64_t>(addr) + size;
+
+    oc_lock_guard<oc_mutex> lock(t.mutex);
+    TrackedRegion* r = t.region_for(addr);
+    if (!r || end > static_cast<uint64_t>(r->guest_base) + r->size) return -2;
+
+    for (size_t i = 0; i < MAX_TRACK_SUBSCRIPTIONS; i++) {
+        auto& sub = t.subscriptions[i];
+        if (sub.live.load()) continue;
+        sub.start = addr;
+        sub.end = end;
+        sub.callback = callback;
+        sub.user_data = user_data;
+        sub.callback_pending.store(false);
+        sub.live.store(true, std::memory_order_release);
+        if (i + 1 > t.subscription_limit.load()) t.subscription_limit.store(i + 1, std::memory_order_release);
+        t.arm_range(*r, addr, end);
+        return static_cast<int>(i);
+    }
+    return -4;
+}
+
+void oc_mem_track_unsubscribe(int subscription) {
+    auto& t = g_mem_tracker;
+    TrackSubscription* sub;
+    {
+        oc_lock_guard<oc_mutex> lock(t.mutex);
+        sub = t.subscription_at(subscription);
+        if (!sub) return;
+        sub->live.store(false);
+        if (sub->callback_pending.exchange(false)) t.pending_callbacks.fetch_sub(1);
+    }
+    // Wait for callbacks that passed the live check, outside the lock so
+    // they may (un)subscribe. A callback unsubscribing itself skips its own.
+    uint32_t own = t_dispatching == sub ? 1 : 0;
+    while (sub->in_flight.load() > own) std::this_thread::yield();
+}
+
+uint64_t oc_mem_track_get_generation(int subscription) {
+    TrackSubscription* sub = g_mem_tracker.subscription_at(subscription);
+    return sub ? sub->generation.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t oc_mem_track_rearm(int subscription) {
+    auto& t = g_mem_tracker;
+    TrackSubscription* sub = t.subscription_at(subscription);
+    if (!sub) return 0;
+    {
+        MemoryWriteTracker::ReadScope scope(t);
+        TrackedRegion* r = t.region_for(sub->start);
+        if (r) t.arm_range(*r, sub->start, sub->end);
+    }
+    t.rearms.fetch_add(1, std::memory_order_relaxed);
+    // Read after arming: a write racing with the re-arm bumps past this value
+    return sub->generation.load(std::memory_order_acquire);
+}
+
+size_t oc_mem_track_dispatch(void) {
+    return g_mem_tracker.dispatch();
+}
+
+int oc_mem_track_is_protect_supported(void) {
+    return g_mem_tracker.protect_supported ? 1 : 0;
+}
+
+void oc_mem_track_get_stats(uint64_t* marks, uint64_t* faults,
+                            uint64_t* notifications, uint64_t* rearms) {
+    auto& t = g_mem_tracker;
+    if (marks) *marks = t.marks.load();
+    if (faults) *faults = t.faults.load();
+    if (notifications) *notifications = t.notifications.load();
+    if (rearms) *rearms = t.rearms.load();
+}
+
+void oc_mem_track_reset_stats(void) {
+    auto& t = g_mem_tracker;
+    t.marks.store(0);
+    t.faults.store(0);
+    t.notifications.store(0);
+    t.rearms.store(0);
+}
+
+} // extern "C"
@@ -14,8 +14,13 @@
 
 #include "oc_ffi.h"
 #include "oc_threading.h"
+#include "jit_preemption.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -25,6 +30,8 @@
 #include <atomic>
 #include <functional>
 #include <list>
+#include <map>
+#include <array>
 
 #ifdef HAVE_LLVM
 #include <llvm/IR/LLVMContext.h>
@@ -34,15 +41,26 @@
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Analysis/ValueTracking.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ObjectTransformLayer.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/TargetParser/Host.h>
 #include <llvm/Support/Error.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/MC/MCContext.h>
+#include <llvm/MC/MCDisassembler/MCDisassembler.h>
+#include <llvm/MC/MCInst.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Object/SymbolSize.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/InstCombine/InstCombine.h>
 #include <llvm/Passes/PassBuilder.h>
@@ -50,6 +68,80 @@
 #include <llvm/Analysis/CGSCCPassManager.h>
 #endif
 
+/**
+ * Switch dispatch recovered from a cmplwi/bgt + lwzx/add/mtctr/bctr sequence
+ */
+struct JumpTable {
+    uint32_t table_address = 0;     // Guest address of the table (read-only data)
+    uint32_t default_target = 0;    // Target of the bounds check branch
+    uint8_t index_reg = 0;          // GPR holding the case index
+    size_t guard_index = 0;         // Index of the bounds check branch in the block
+    std::vector<uint32_t> targets;  // Case targets, indexed by case value
+    
+    bool valid() const { return !targets.empty(); }
+};
+
+/**
+ * A leaf call inlined into a region: instructions[first_index, first_index +
+ * count) are the callee body, after which the caller resumes
+ */
+struct InlinedCall {
+    size_t first_index = 0;
+    size_t count = 0;
+    uint32_t callee_address = 0;
+    uint32_t return_address = 0;
+};
+
+/**
+ * What a speculation guard checks
+ */
+enum class GuardKind : uint8_t {
+    RegisterValue = OC_PPU_GUARD_REGISTER_VALUE,  // GPR equals a profiled constant
+    BranchTarget = OC_PPU_GUARD_BRANCH_TARGET,    // CTR equals the predicted bcctr target
+};
+
+/**
+ * Guest state a side exit writes back to the context: whatever the region
+ * changed before the guard. Registers it has not written still hold the
+ * values the dispatcher passed in.
+ */
+struct DeoptState {
+    uint32_t gprs = 0;          // Bitmasks of registers written before the guard
+    uint32_t fprs = 0;
+    uint32_t vrs = 0;
+    uint32_t materialized = 0;  // OC_PPU_DEOPT_* flags
+};
+
+/**
+ * A speculation and the guard that checks it before instructions[index].
+ * When the guard fails, execution resumes in the interpreter at guest_pc.
+ */
+struct GuardSite {
+    GuardKind kind = GuardKind::RegisterValue;
+    uint8_t reg = 0;            // RegisterValue: the GPR
+    uint32_t index = 0;
+    uint32_t guest_pc = 0;
+    uint64_t expected = 0;      // Speculated value or branch target
+    DeoptState state;           // Filled in when the guard is emitted
+};
+
+/**
+ * Entry slots a block's native code polls through their raw address. They
+ * are allocated apart from the block so they can outlive it: the code stays
+ * in the JIT's dylib after the block is reclaimed (see
+ * CodeCache::retained_links).
+ */
+struct BlockLinks {
+    // Tier-2 loop entered from the back-edge at loop_header; null until the
+    // region has been upgraded. Tier-1 code polls it.
+    std::atomic<void*> osr_entry{nullptr};
+    
+    // Code of the block a BranchTarget guard predicts, entered directly
+    // once the guard holds; null until the dispatcher has linked the two.
+    // Links are made and broken under CodeCache::chain_mutex.
+    std::atomic<void*> chain_entry{nullptr};
+};
+
 /**
  * Basic block structure for compiled code
  */
@@ -59,6 +151,8 @@ struct BasicBlock {
     std::vector<uint32_t> instructions;
     void* compiled_code;
     size_t code_size;
+    bool owns_code;                      // compiled_code was malloc'd by us and must be freed
+    bool checks_budget;                  // compiled_code performs the preemption check itself
     
     // Block merging support: CFG edges
     std::vector<uint32_t> successors;    // Addresses of successor blocks
@@ -66,15 +160,84 @@ struct BasicBlock {
     bool is_fallthrough;                 // True if block falls through to next
     bool can_merge;                      // True if block can be merged with successor
     
+    JumpTable jump_table;                // Recovered switch dispatch ending the block
+    std::vector<InlinedCall> inlined_calls;  // Leaf calls inlined into the block, in order
+    std::vector<GuardSite> guards;       // Speculation guards, in instruction order
+    uint32_t loop_header = 0;            // Target of a closing back-edge (0 if none)
+    std::atomic<uint32_t> back_edges{0}; // Runs that ended on the back-edge, until upgraded
+    std::atomic<uint64_t> runs{0};       // Dispatches of the block, kept for warm start profiles
+    uint32_t symbol_version = 0;         // Tells this compile's symbols from earlier ones at the address
+
+    std::unique_ptr<BlockLinks> links;   // Upgrade and chain slots
+    BasicBlock* chained_to = nullptr;
+    bool unpublished = false;
+
+    // Measured quality of native code; all zero for interpreter placeholders
+    uint32_t host_instructions = 0;
+    uint32_t helper_calls = 0;
+    uint32_t context_loads = 0;
+    uint32_t context_stores = 0;
+    
+    // LRU tick of the last lookup; written racily by readers, which is fine
+    // because eviction only needs an approximate age
+    std::atomic<uint64_t> last_use;
+    
+    // Set once compiled_code has been handed out through the C API; such
+    // code must outlive the block (see CodeCache::exported_code)
+    std::atomic<bool> code_exported;
+    
 #ifdef HAVE_LLVM
     std::unique_ptr<llvm::Function> llvm_func;
 #endif
     
     BasicBlock(uint32_t start) 
         : start_address(start), end_address(start), compiled_code(nullptr), code_size(0),
-          is_fallthrough(false), can_merge(false) {}
+          owns_code(false), checks_budget(false), is_fallthrough(false), can_merge(false),
+          links(new BlockLinks), last_use(0), code_exported(false) {}
+    
+    ~BasicBlock() {
+        if (owns_code && compiled_code) {
+            free(compiled_code);
+        }
+    }
+    
+    BasicBlock(const BasicBlock&) = delete;
+    BasicBlock& operator=(const BasicBlock&) = delete;
+    
+    // Host memory held by the block, as charged to the cache budget
+    size_t footprint() const {
+        return code_size + sizeof(BasicBlock) + instructions.capacity() * sizeof(uint32_t);
+    }
+    
+    // Guest address of instructions[index]; differs from start_address + 4 * index
+    // once calls have been inlined
+    uint32_t address_of(size_t index) const {
+        uint32_t address = start_address + static_cast<uint32_t>(index * 4);
+        for (const auto& call : inlined_calls) {
+            if (index < call.first_index) break;
+            size_t end = call.first_index + call.count;
+            if (index < end) {
+                return call.callee_address + static_cast<uint32_t>((index - call.first_index) * 4);
+            }
+            address = call.return_address + static_cast<uint32_t>((index - end) * 4);
+        }
+        return address;
+    }
+};
+
+/**
+ * Per-block profile record persisted across runs for warm start
+ */
+struct WarmStartEntry {
+    uint32_t address = 0;
+    uint64_t execution_count = 0;
+    uint8_t tier = 0;                 // Highest CompilationTier reached
+    uint32_t back_edge_target = 0;    // Trace loop back-edge (0 if linear or no trace)
+    std::vector<uint32_t> trace;      // Trace block addresses starting here, if any
 };
 
+using WarmStartMap = std::unordered_map<uint32_t, WarmStartEntry>;
+
 /**
  * Cache statistics for profiling
  */
@@ -93,104 +256,520 @@ struct CacheStatistics {
 };
 
 /**
- * Code cache for compiled blocks with LRU eviction
+ * Code cache for compiled blocks with approximate LRU eviction
+ * 
+ * Safe for concurrent find/insert/invalidate from any number of PPU and
+ * compile threads:
+ * - Lookups hit a direct-mapped table of atomic block pointers and take no
+ *   lock; only a table miss falls back to the owning shard's map
+ * - Mutation (insert, evict, invalidate) locks a single shard, chosen from
+ *   the same address bits as the lookup slot, so a slot is only ever
+ *   written under its shard's lock
+ * - Blocks removed from the cache are retired rather than freed. Retirement
+ *   stamps them with the current epoch, and a retired block is reclaimed
+ *   once every ReadGuard still open entered at a later epoch, so a guard
+ *   held across a long-running block only pins blocks retired after it
+ *   was opened
+ * - A hit writes nothing shared: LRU stamps come from a clock that only
+ *   insertion advances, and hit/miss counts are striped per thread
+ * 
+ * Any BasicBlock* returned by find_block() must only be used while the
+ * caller holds a ReadGuard.
+ * 
+ * Sizes are block footprints, charged to the runtime-wide cache memory
+ * budget; the cache holds at most the smaller of max_size and its budget
+ * target.
  */
 struct CodeCache {
-    std::unordered_map<uint32_t, std::unique_ptr<BasicBlock>> blocks;
-    std::list<uint32_t> lru_order;  // LRU tracking: front = most recent, back = least recent
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_positions;
-    oc_mutex mutex;
-    size_t total_size;
-    size_t max_size;
-    CacheStatistics stats;
+    static constexpr size_t NUM_SHARDS = 16;
+    static constexpr size_t LOOKUP_TABLE_BITS = 16;
+    static constexpr size_t LOOKUP_TABLE_SIZE = size_t(1) << LOOKUP_TABLE_BITS;
+    static constexpr size_t NUM_READER_SLOTS = 256;
+    static constexpr size_t NUM_COUNTER_STRIPES = 32;
+    static constexpr uint64_t NO_RETIRED = UINT64_MAX;
+    
+    struct Shard {
+        oc_mutex mutex;
+        std::unordered_map<uint32_t, std::unique_ptr<BasicBlock>> blocks;
+    };
     
-    CodeCache() : total_size(0), max_size(64 * 1024 * 1024) {} // 64MB default
+    // Epoch a reader entered at, or 0 while the slot is free
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};
+    };
     
-    void set_max_size(size_t size) { max_size = size; }
-    size_t get_max_size() const { return max_size; }
+    struct alignas(64) CounterStripe {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
     
-    BasicBlock* find_block(uint32_t address) {
-        auto it = blocks.find(address);
-        if (it != blocks.end()) {
-            // Move to front of LRU list (most recently used)
-            auto lru_it = lru_positions.find(address);
-            if (lru_it != lru_positions.end()) {
-                lru_order.erase(lru_it->second);
-                lru_order.push_front(address);
-                lru_positions[address] = lru_order.begin();
+    struct RetiredBlock {
+        uint64_t epoch;
+        std::unique_ptr<BasicBlock> block;
+    };
+    
+    std::array<Shard, NUM_SHARDS> shards;
+    std::unique_ptr<std::atomic<BasicBlock*>[]> lookup_table;
+    
+    // Blocks unpublished from the cache but possibly still in use by a
+    // reader, in retirement order
+    oc_mutex retire_mutex;
+    std::vector<RetiredBlock> retired;
+    std::atomic<uint64_t> oldest_retired;
+    std::atomic<uint64_t> global_epoch;
+    std::unique_ptr<ReaderSlot[]> reader_slots;
+    
+    // Placeholder code handed out by oc_ppu_jit_get_compiled. Callers hold
+    // no guard, so it stays allocated until the cache is destroyed.
+    std::vector<void*> exported_code;
+    
+    // Slots of reclaimed native blocks. Their code stays linked, exported or
+    // mid-run without a guard, and addresses the slots directly, so the
+    // slots are kept for as long as the code (until destruction).
+    std::vector<std::unique_ptr<BlockLinks>> retained_links;
+    
+    // Direct links between blocks, by target, so unpublishing a block can
+    // unlink everything that jumps into it
+    oc_mutex chain_mutex;
+    std::unordered_map<const BasicBlock*, std::vector<BasicBlock*>> chains_into;
+    
+    std::atomic<size_t> total_size;
+    std::atomic<size_t> max_size;
+    std::atomic<uint64_t> lru_clock;
+    std::atomic<size_t> evict_cursor;
+    
+    std::unique_ptr<CounterStripe[]> counters;
+    std::atomic<uint64_t> eviction_count;
+    std::atomic<uint64_t> invalidation_count;
+    
+    int budget_client;
+    
+    CodeCache()
+        : lookup_table(new std::atomic<BasicBlock*>[LOOKUP_TABLE_SIZE]),
+          oldest_retired(NO_RETIRED), global_epoch(1),
+          reader_slots(new ReaderSlot[NUM_READER_SLOTS]), total_size(0),
+          max_size(64 * 1024 * 1024), // 64MB default
+          lru_clock(0), evict_cursor(0), counters(new CounterStripe[NUM_COUNTER_STRIPES]),
+          eviction_count(0), invalidation_count(0) {
+        for (size_t i = 0; i < LOOKUP_TABLE_SIZE; i++) {
+            lookup_table[i].store(nullptr, std::memory_order_relaxed);
+        }
+        budget_client = oc_mem_budget_register("ppu_code", budget_lookups, this);
+    }
+    
+    ~CodeCache() {
+        oc_mem_budget_unregister(budget_client);
+        for (void* code : exported_code) free(code);
+    }
+    
+    static uint64_t budget_lookups(void* user_data) {
+        auto* cache = static_cast<CodeCache*>(user_data);
+        return cache->hit_total() + cache->miss_total();
+    }
+    
+    // Per-thread starting point for reader slot and counter stripe selection;
+    // the address of a thread-local is unique among live threads
+    static size_t thread_hint() {
+        static thread_local char tag;
+        static thread_local size_t hint = reinterpret_cast<uintptr_t>(&tag) >> 6;
+        return hint;
+    }
+    
+    CounterStripe& counter_stripe() {
+        return counters[thread_hint() % NUM_COUNTER_STRIPES];
+    }
+    
+    /**
+     * RAII marker for a window in which BasicBlock pointers obtained from the
+     * cache may be dereferenced. Claims a reader slot, normally the one this
+     * thread used last, so entering and leaving touch no shared cache line.
+     */
+    struct ReadGuard {
+        CodeCache& cache;
+        ReaderSlot* slot;
+        uint64_t epoch;
+        explicit ReadGuard(CodeCache& c) : cache(c), slot(nullptr), epoch(0) {
+            slot = cache.enter_epoch(epoch);
+        }
+        ~ReadGuard() {
+            slot->epoch.store(0, std::memory_order_release);
+            // Only a reader at or before the oldest retirement can be what
+            // keeps it alive
+            if (epoch <= cache.oldest_retired.load(std::memory_order_relaxed)) {
+                cache.try_reclaim(false);
             }
-            stats.hit_count++;
-            return it->second.get();
         }
-        stats.miss_count++;
-        return nullptr;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+    
+    static size_t slot_index(uint32_t address) {
+        return (address >> 2) & (LOOKUP_TABLE_SIZE - 1);
     }
     
-    void insert_block(uint32_t address, std::unique_ptr<BasicBlock> block) {
-        // Evict LRU blocks if we're over the limit
-        while (total_size + block->code_size > max_size && !lru_order.empty()) {
-            evict_lru();
+    // Low slot bits pick the shard, so every slot belongs to exactly one shard
+    Shard& shard_for(uint32_t address) {
+        return shards[slot_index(address) & (NUM_SHARDS - 1)];
+    }
+    
+    void set_max_size(size_t size) { max_size.store(size, std::memory_order_relaxed); }
+    size_t get_max_size() const { return max_size.load(std::memory_order_relaxed); }
+    size_t get_size_limit() const {
+        return std::min<size_t>(get_max_size(), oc_mem_budget_get_target(budget_client));
+    }
+    size_t get_total_size() const { return total_size.load(std::memory_order_relaxed); }
+    
+    BasicBlock* find_block(uint32_t address) {
+        // Lock-free fast path
+        BasicBlock* block = lookup_table[slot_index(address)].load(std::memory_order_seq_cst);
+        if (block && block->start_address == address) {
+            touch(block);
+            return block;
         }
         
-        total_size += block->code_size;
-        blocks[address] = std::move(block);
-        
-        // Add to front of LRU list
-        lru_order.push_front(address);
-        lru_positions[address] = lru_order.begin();
+        // Slot holds a colliding block (or nothing): consult the shard
+        Shard& shard = shard_for(address);
+        oc_lock_guard<oc_mutex> lock(shard.mutex);
+        auto it = shard.blocks.find(address);
+        if (it == shard.blocks.end()) {
+            counter_stripe().misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        block = it->second.get();
+        lookup_table[slot_index(address)].store(block, std::memory_order_release);
+        touch(block);
+        return block;
     }
     
-    void evict_lru() {
-        if (lru_order.empty()) return;
+    bool contains(uint32_t address) {
+        ReadGuard guard(*this);
+        return find_block(address) != nullptr;
+    }
+    
+    /**
+     * Hand out a block's code to a caller outside any ReadGuard. Placeholder
+     * code the cache would free on reclaim is kept until destruction instead;
+     * native code lives in the JIT's dylib and is never freed early.
+     * Caller holds a ReadGuard.
+     */
+    void* export_code(BasicBlock* block) {
+        block->code_exported.store(true, std::memory_order_relaxed);
+        return block->compiled_code;
+    }
+    
+    /**
+     * Link source's branch guard to target's code, so a source run whose
+     * guard holds continues in target without returning to the dispatcher.
+     * Fails if either block has left the cache. Caller holds a ReadGuard.
+     */
+    bool chain(BasicBlock* source, BasicBlock* target) {
+        oc_lock_guard<oc_mutex> lock(chain_mutex);
+        if (source->unpublished || target->unpublished || source->chained_to) return false;
+        source->chained_to = target;
+        chains_into[target].push_back(source);
+        source->links->chain_entry.store(target->compiled_code, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * Insert a compiled block. If another thread already cached a block at the
+     * same address, the existing block wins and the new one is discarded.
+     * Returns true if the block was inserted.
+     */
+    bool insert_block(uint32_t address, std::unique_ptr<BasicBlock> block) {
+        size_t size = block->footprint();
+        
+        // Make room first; eviction locks other shards one at a time, so it
+        // must not run while we hold our own shard lock
+        size_t attempts = NUM_SHARDS;
+        size_t limit = get_size_limit();
+        while (total_size.load(std::memory_order_relaxed) + size > limit && attempts-- > 0) {
+            evict_lru();
+        }
         
-        uint32_t oldest = lru_order.back();
-        lru_order.pop_back();
-        lru_positions.erase(oldest);
+        block->last_use.store(lru_clock.fetch_add(1, std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
         
-        auto it = blocks.find(oldest);
-        if (it != blocks.end()) {
-            total_size -= it->second->code_size;
-            blocks.erase(it);
-            stats.eviction_count++;
+        {
+            Shard& shard = shard_for(address);
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            auto& slot = shard.blocks[address];
+            if (slot) {
+                return false;
+            }
+            slot = std::move(block);
+            total_size.fetch_add(size, std::memory_order_relaxed);
+            lookup_table[slot_index(address)].store(slot.get(), std::memory_order_release);
         }
+        oc_mem_budget_insert(budget_client, address, size);
+        return true;
     }
     
-    void invalidate(uint32_t address) {
-        auto it = blocks.find(address);
-        if (it != blocks.end()) {
-            total_size -= it->second->code_size;
-            blocks.erase(it);
+    /**
+     * Evict the least recently used block of the next shard in round-robin
+     * order. Exact global LRU would need a shared list touched on every hit.
+     */
+    void evict_lru() {
+        for (size_t n = 0; n < NUM_SHARDS; n++) {
+            size_t idx = evict_cursor.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+            Shard& shard = shards[idx];
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            if (shard.blocks.empty()) continue;
             
-            auto lru_it = lru_positions.find(address);
-            if (lru_it != lru_positions.end()) {
-                lru_order.erase(lru_it->second);
-                lru_positions.erase(lru_it);
+            auto victim = shard.blocks.begin();
+            uint64_t oldest = victim->second->last_use.load(std::memory_order_relaxed);
+            for (auto it = std::next(shard.blocks.begin()); it != shard.blocks.end(); ++it) {
+                uint64_t age = it->second->last_use.load(std::memory_order_relaxed);
+                if (age < oldest) {
+                    oldest = age;
+                    victim = it;
+                }
             }
-            stats.invalidation_count++;
+            oc_mem_budget_evict(budget_client, victim->first, victim->second->footprint());
+            unpublish_locked(shard, victim, true);
+            eviction_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    
+    void invalidate(uint32_t address) {
+        {
+            Shard& shard = shard_for(address);
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            auto it = shard.blocks.find(address);
+            if (it == shard.blocks.end()) return;
+            unpublish_locked(shard, it);
+            invalidation_count.fetch_add(1, std::memory_order_relaxed);
         }
+        try_reclaim();
     }
     
     void invalidate_range(uint32_t start, uint32_t end) {
-        std::vector<uint32_t> to_remove;
-        for (const auto& pair : blocks) {
-            if (pair.first >= start && pair.first < end) {
-                to_remove.push_back(pair.first);
+        for (auto& shard : shards) {
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            for (auto it = shard.blocks.begin(); it != shard.blocks.end();) {
+                if (it->first >= start && it->first < end) {
+                    auto next = std::next(it);
+                    unpublish_locked(shard, it);
+                    invalidation_count.fetch_add(1, std::memory_order_relaxed);
+                    it = next;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        try_reclaim();
+    }
+    
+    /**
+     * Start addresses of cached blocks whose code overlaps [start, end).
+     */
+    std::vector<uint32_t> blocks_overlapping(uint32_t start, uint32_t end) {
+        std::vector<uint32_t> result;
+        for (auto& shard : shards) {
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            for (const auto& [address, block] : shard.blocks) {
+                if (block->start_address < end && block->end_address > start) {
+                    result.push_back(address);
+                }
             }
         }
-        for (uint32_t addr : to_remove) {
-            invalidate(addr);
+        return result;
+    }
+    
+    /**
+     * Add every cached block to a warm start profile: its dispatch count,
+     * and tier 2 once its loop has been upgraded
+     */
+    void export_warm_start(WarmStartMap& out) {
+        for (auto& shard : shards) {
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            for (const auto& [address, block] : shard.blocks) {
+                if (!block->compiled_code) continue;
+                uint8_t tier = block->links->osr_entry.load(std::memory_order_relaxed) ? 2 : 1;
+                auto& entry = out[address];
+                entry.address = address;
+                entry.execution_count = std::max(entry.execution_count,
+                                                 block->runs.load(std::memory_order_relaxed));
+                entry.tier = std::max(entry.tier, tier);
+            }
         }
     }
     
     void clear() {
-        blocks.clear();
-        lru_order.clear();
-        lru_positions.clear();
-        total_size = 0;
+        for (auto& shard : shards) {
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            while (!shard.blocks.empty()) {
+                unpublish_locked(shard, shard.blocks.begin());
+            }
+        }
+        try_reclaim();
+    }
+    
+    /**
+     * Free retired blocks that no reader can still observe.
+     * A block is unpublished before the epoch it is stamped with is taken,
+     * and a reader publishes its epoch before loading any block pointer, so
+     * a reader that entered after that epoch can never have seen the block.
+     * Readers that leave pass wait = false and skip the pass if another
+     * thread is already reclaiming.
+     */
+    void try_reclaim(bool wait = true) {
+        if (oldest_retired.load(std::memory_order_relaxed) == NO_RETIRED) return;
+        
+        if (wait) {
+            retire_mutex.lock();
+        } else if (!retire_mutex.try_lock()) {
+            return;
+        }
+        std::vector<RetiredBlock> dead = take_reclaimable_locked();
+        retire_mutex.unlock();
+        // Blocks (and their code) are destroyed here, outside the lock
+    }
+    
+    size_t block_count() {
+        size_t count = 0;
+        for (auto& shard : shards) {
+            oc_lock_guard<oc_mutex> lock(shard.mutex);
+            count += shard.blocks.size();
+        }
+        return count;
+    }
+    
+    uint64_t hit_total() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < NUM_COUNTER_STRIPES; i++) {
+            total += counters[i].hits.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    uint64_t miss_total() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < NUM_COUNTER_STRIPES; i++) {
+            total += counters[i].misses.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    CacheStatistics get_statistics() const {
+        CacheStatistics s;
+        s.hit_count = hit_total();
+        s.miss_count = miss_total();
+        s.eviction_count = eviction_count.load(std::memory_order_relaxed);
+        s.invalidation_count = invalidation_count.load(std::memory_order_relaxed);
+        return s;
+    }
+    
+    void reset_statistics() {
+        for (size_t i = 0; i < NUM_COUNTER_STRIPES; i++) {
+            counters[i].hits.store(0, std::memory_order_relaxed);
+            counters[i].misses.store(0, std::memory_order_relaxed);
+        }
+        eviction_count.store(0, std::memory_order_relaxed);
+        invalidation_count.store(0, std::memory_order_relaxed);
+    }
+    
+private:
+    using BlockMap = std::unordered_map<uint32_t, std::unique_ptr<BasicBlock>>;
+    
+    // Stamp a hit with the current LRU tick. The clock only advances on
+    // insertion, so a block that is hit repeatedly is written once per tick
+    // and hits never write a shared counter.
+    void touch(BasicBlock* block) {
+        uint64_t now = lru_clock.load(std::memory_order_relaxed);
+        if (block->last_use.load(std::memory_order_relaxed) != now) {
+            block->last_use.store(now, std::memory_order_relaxed);
+        }
+        counter_stripe().hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Publish this thread's epoch in a free reader slot. The slot is claimed
+    // with the epoch itself, so a slot is either free (0) or owned.
+    ReaderSlot* enter_epoch(uint64_t& epoch) {
+        size_t start = thread_hint();
+        for (size_t n = 0;; n++) {
+            ReaderSlot& slot = reader_slots[(start + n) % NUM_READER_SLOTS];
+            epoch = global_epoch.load(std::memory_order_seq_cst);
+            uint64_t expected = 0;
+            if (slot.epoch.load(std::memory_order_relaxed) == 0 &&
+                slot.epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst)) {
+                return &slot;
+            }
+        }
+    }
+    
+    // Caller holds retire_mutex. Detaches every retired block older than the
+    // oldest open ReadGuard.
+    // Break every link into and out of a block leaving the cache. Done
+    // before it is stamped, like the lookup slot, so a reader entering later
+    // cannot follow a link to it.
+    void unchain(BasicBlock* block) {
+        oc_lock_guard<oc_mutex> lock(chain_mutex);
+        block->unpublished = true;
+        if (BasicBlock* target = block->chained_to) {
+            auto& sources = chains_into[target];
+            sources.erase(std::remove(sources.begin(), sources.end(), block), sources.end());
+            if (sources.empty()) chains_into.erase(target);
+            block->chained_to = nullptr;
+            block->links->chain_entry.store(nullptr, std::memory_order_seq_cst);
+        }
+        auto into = chains_into.find(block);
+        if (into == chains_into.end()) return;
+        for (BasicBlock* source : into->second) {
+            source->chained_to = nullptr;
+            source->links->chain_entry.store(nullptr, std::memory_order_seq_cst);
+        }
+        chains_into.erase(into);
     }
     
-    const CacheStatistics& get_statistics() const { return stats; }
-    void reset_statistics() { stats = CacheStatistics(); }
+    std::vector<RetiredBlock> take_reclaimable_locked() {
+        uint64_t min_active = NO_RETIRED;
+        for (size_t i = 0; i < NUM_READER_SLOTS; i++) {
+            uint64_t epoch = reader_slots[i].epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0) min_active = std::min(min_active, epoch);
+        }
+        
+        size_t n = 0;
+        while (n < retired.size() && retired[n].epoch < min_active) {
+            BasicBlock* block = retired[n].block.get();
+            if (block->compiled_code && !block->owns_code) {
+                retained_links.push_back(std::move(block->links));
+            }
+            if (block->owns_code && block->code_exported.load(std::memory_order_relaxed)) {
+                exported_code.push_back(block->compiled_code);
+                block->owns_code = false;
+            }
+            n++;
+        }
+        std::vector<RetiredBlock> dead(std::make_move_iterator(retired.begin()),
+                                       std::make_move_iterator(retired.begin() + n));
+        retired.erase(retired.begin(), retired.begin() + n);
+        oldest_retired.store(retired.empty() ? NO_RETIRED : retired.front().epoch,
+                             std::memory_order_relaxed);
+        return dead;
+    }
+    
+    // Caller holds shard.mutex. Evictions have already been reported to the
+    // budget; anything else is a plain release.
+    void unpublish_locked(Shard& shard, BlockMap::iterator it, bool evicted = false) {
+        BasicBlock* block = it->second.get();
+        unchain(block);
+        BasicBlock* expected = block;
+        lookup_table[slot_index(it->first)].compare_exchange_strong(
+            expected, nullptr, std::memory_order_seq_cst);
+        total_size.fetch_sub(block->footprint(), std::memory_order_relaxed);
+        if (!evicted) oc_mem_budget_release(budget_client, block->footprint());
+        
+        std::unique_ptr<BasicBlock> owned = std::move(it->second);
+        shard.blocks.erase(it);
+        
+        // Stamping under retire_mutex keeps the list in epoch order
+        oc_lock_guard<oc_mutex> lock(retire_mutex);
+        uint64_t epoch = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (retired.empty()) oldest_retired.store(epoch, std::memory_order_relaxed);
+        retired.push_back({epoch, std::move(owned)});
+    }
 };
 
 /**
@@ -381,14 +960,92 @@ struct BlockLinkStats {
 };
 
 struct BlockLinker {
+    /**
+     * A block built from [start, end) outside its own code: an inlined
+     * callee or the jump table it dispatches through
+     */
+    struct SourceDependency {
+        uint32_t start;
+        uint32_t end;
+        uint32_t block;
+    };
+    
     std::unordered_map<uint32_t, std::vector<BlockLink>> outgoing_links;
     std::unordered_map<uint32_t, std::vector<uint32_t>> incoming_links;
+    
+    // Source ranges ordered by start, and the range starts each cached
+    // block depends on; the widest range bounds how far back a lookup has
+    // to start
+    std::multimap<uint32_t, SourceDependency> source_dependencies;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> sources_by_block;
+    uint32_t widest_source = 0;
+    
     BlockLinkStats stats;
+    mutable oc_mutex mutex;
+    
+    /**
+     * Record the guest ranges outside its own code a cached block was built
+     * from, replacing what an earlier compile of the block recorded
+     */
+    void set_source_dependencies(uint32_t block,
+                                 const std::vector<std::pair<uint32_t, uint32_t>>& ranges) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        remove_source_dependencies_locked(block);
+        if (ranges.empty()) return;
+        auto& starts = sources_by_block[block];
+        for (const auto& [start, end] : ranges) {
+            source_dependencies.emplace(start, SourceDependency{start, end, block});
+            starts.push_back(start);
+            widest_source = std::max(widest_source, end - start);
+        }
+    }
+    
+    /**
+     * Forget the source ranges of a block leaving the cache
+     */
+    void remove_source_dependencies(uint32_t block) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        remove_source_dependencies_locked(block);
+    }
+    
+    /**
+     * Blocks built from guest data in [start, end) outside their own code,
+     * which must be invalidated when it changes
+     */
+    std::vector<uint32_t> source_dependents(uint32_t start, uint32_t end) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        std::vector<uint32_t> blocks;
+        uint32_t from = start > widest_source ? start - widest_source : 0;
+        for (auto it = source_dependencies.lower_bound(from);
+             it != source_dependencies.end() && it->first < end; ++it) {
+            if (it->second.end > start) blocks.push_back(it->second.block);
+        }
+        return blocks;
+    }
+    
+    size_t source_dependency_count() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return source_dependencies.size();
+    }
+    
+    // Caller holds mutex
+    void remove_source_dependencies_locked(uint32_t block) {
+        auto it = sources_by_block.find(block);
+        if (it == sources_by_block.end()) return;
+        for (uint32_t start : it->second) {
+            auto range = source_dependencies.equal_range(start);
+            for (auto dep = range.first; dep != range.second;) {
+                dep = dep->second.block == block ? source_dependencies.erase(dep) : std::next(dep);
+            }
+        }
+        sources_by_block.erase(it);
+    }
     
     /**
      * Register a potential link between two blocks
      */
     void add_link(uint32_t source, uint32_t target, bool conditional = false) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         outgoing_links[source].emplace_back(source, target, conditional);
         incoming_links[target].push_back(source);
         stats.total_links++;
@@ -398,6 +1055,7 @@ struct BlockLinker {
      * Activate a link: patch the source block to jump directly to target code
      */
     bool link_blocks(uint32_t source, uint32_t target, void* target_code) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = outgoing_links.find(source);
         if (it == outgoing_links.end()) return false;
         
@@ -416,6 +1074,7 @@ struct BlockLinker {
      * Unlink all outgoing links from a block (e.g., when it's invalidated)
      */
     void unlink_source(uint32_t source) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = outgoing_links.find(source);
         if (it == outgoing_links.end()) return;
         
@@ -433,6 +1092,7 @@ struct BlockLinker {
      * Unlink all incoming links to a target (e.g., when target is recompiled)
      */
     void unlink_target(uint32_t target) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = incoming_links.find(target);
         if (it == incoming_links.end()) return;
         
@@ -455,6 +1115,7 @@ struct BlockLinker {
      * Get linked target code for a block's outgoing branch
      */
     void* get_linked_target(uint32_t source, uint32_t target) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = outgoing_links.find(source);
         if (it == outgoing_links.end()) return nullptr;
         
@@ -469,20 +1130,37 @@ struct BlockLinker {
     /**
      * Record a link hit (direct jump taken without dispatch)
      */
-    void record_hit() { stats.link_hits++; }
-    void record_miss() { stats.link_misses++; }
+    void record_hit() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.link_hits++;
+    }
+    void record_miss() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.link_misses++;
+    }
     
-    const BlockLinkStats& get_stats() const { return stats; }
+    BlockLinkStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
     
-    void reset_stats() { stats = BlockLinkStats(); }
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = BlockLinkStats();
+    }
     
     void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
         outgoing_links.clear();
         incoming_links.clear();
+        source_dependencies.clear();
+        sources_by_block.clear();
+        widest_source = 0;
         stats = BlockLinkStats();
     }
     
     size_t get_link_count() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         size_t count = 0;
         for (const auto& pair : outgoing_links) {
             count += pair.second.size();
@@ -491,6 +1169,7 @@ struct BlockLinker {
     }
     
     size_t get_active_count() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         return static_cast<size_t>(stats.active_links);
     }
 };
@@ -538,16 +1217,26 @@ struct TraceCompiler {
     uint64_t hot_threshold;
     size_t max_trace_length;
     TraceCompilerStats stats;
+    mutable oc_mutex mutex;
     
     TraceCompiler() : hot_threshold(100), max_trace_length(32) {}
     
     /**
      * Set the execution count threshold for trace compilation
      */
-    void set_hot_threshold(uint64_t threshold) { hot_threshold = threshold; }
-    uint64_t get_hot_threshold() const { return hot_threshold; }
+    void set_hot_threshold(uint64_t threshold) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        hot_threshold = threshold;
+    }
+    uint64_t get_hot_threshold() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return hot_threshold;
+    }
     
-    void set_max_trace_length(size_t length) { max_trace_length = length; }
+    void set_max_trace_length(size_t length) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        max_trace_length = length;
+    }
     
     /**
      * Detect a potential trace starting at the given header
@@ -558,6 +1247,7 @@ struct TraceCompiler {
      */
     void detect_trace(uint32_t header, const std::vector<uint32_t>& path,
                       uint32_t back_edge = 0) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto& trace = traces[header];
         trace.header_address = header;
         trace.block_addresses = path;
@@ -572,6 +1262,7 @@ struct TraceCompiler {
      * Record trace execution and check if it should be compiled
      */
     bool record_execution(uint32_t header) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = traces.find(header);
         if (it == traces.end()) return false;
         
@@ -585,6 +1276,7 @@ struct TraceCompiler {
      * Mark a trace as compiled
      */
     void mark_compiled(uint32_t header, void* code) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = traces.find(header);
         if (it == traces.end()) return;
         
@@ -597,31 +1289,57 @@ struct TraceCompiler {
      * Get compiled trace code for an address
      */
     void* get_compiled_trace(uint32_t header) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = traces.find(header);
         if (it == traces.end() || !it->second.is_compiled) return nullptr;
         return it->second.compiled_trace;
     }
     
+    /**
+     * Add trace shapes to a warm start profile
+     */
+    void export_warm_start(WarmStartMap& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        for (const auto& pair : traces) {
+            auto& entry = out[pair.first];
+            entry.address = pair.first;
+            entry.execution_count = std::max(entry.execution_count, pair.second.execution_count);
+            entry.trace = pair.second.block_addresses;
+            entry.back_edge_target = pair.second.back_edge_target;
+        }
+    }
+    
     /**
      * Check if an address is a trace header
      */
     bool is_trace_header(uint32_t address) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         return traces.find(address) != traces.end();
     }
     
     /**
-     * Get trace info
+     * Get a copy of the trace info; returns false if no trace starts at header
      */
-    const TraceEntry* get_trace(uint32_t header) const {
+    bool get_trace(uint32_t header, TraceEntry& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = traces.find(header);
-        return (it != traces.end()) ? &it->second : nullptr;
+        if (it == traces.end()) return false;
+        out = it->second;
+        return true;
     }
     
-    const TraceCompilerStats& get_stats() const { return stats; }
+    TraceCompilerStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
     
-    void reset_stats() { stats = TraceCompilerStats(); }
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = TraceCompilerStats();
+    }
     
     void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
         traces.clear();
         stats = TraceCompilerStats();
     }
@@ -674,6 +1392,11 @@ struct BreakpointStats {
 struct BreakpointManager {
     std::unordered_map<uint32_t, BreakpointEntry> breakpoints;
     BreakpointStats stats;
+    mutable oc_mutex mutex;
+    
+    // Number of active breakpoints, readable without the lock so the execute
+    // path can skip the map lookup entirely when no breakpoints are set
+    std::atomic<size_t> active_count{0};
     
     // Breakpoint trap instruction for PowerPC
     // This is "tw 31, 0, 0" which is an unconditional trap instruction
@@ -683,21 +1406,26 @@ struct BreakpointManager {
     static constexpr uint32_t BREAKPOINT_TRAP = 0x7FE00008;
     
     void add_breakpoint(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         if (breakpoints.find(address) == breakpoints.end()) {
             breakpoints[address] = BreakpointEntry(address);
             stats.total_breakpoints_set++;
         } else {
             breakpoints[address].is_active = true;
         }
+        update_active_count();
     }
     
     void add_breakpoint_with_instruction(uint32_t address, uint32_t original_instr) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         BreakpointEntry entry(address, original_instr);
         breakpoints[address] = entry;
         stats.total_breakpoints_set++;
+        update_active_count();
     }
     
     void remove_breakpoint(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = breakpoints.find(address);
         if (it != breakpoints.end()) {
             // If patched, need to restore original instruction
@@ -706,15 +1434,19 @@ struct BreakpointManager {
             }
             breakpoints.erase(it);
         }
+        update_active_count();
     }
     
     bool has_breakpoint(uint32_t address) const {
+        if (active_count.load(std::memory_order_acquire) == 0) return false;
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = breakpoints.find(address);
         return it != breakpoints.end() && it->second.is_active;
     }
     
     // Record a breakpoint hit
     void record_hit(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = breakpoints.find(address);
         if (it != breakpoints.end()) {
             it->second.hit_count++;
@@ -724,6 +1456,7 @@ struct BreakpointManager {
     
     // Get hit count for a breakpoint
     uint64_t get_hit_count(uint32_t address) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = breakpoints.find(address);
         return it != breakpoints.end() ? it->second.hit_count : 0;
     }
@@ -737,6 +1470,7 @@ struct BreakpointManager {
     // The tracking mode is sufficient for interpreter-assisted breakpoints.
     // Returns true if patch site was registered, false if breakpoint not found.
     bool apply_patch(uint32_t address, void* compiled_code_site) {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = breakpoints.find(address);
         if (it == breakpoints.end() || !it->second.is_active) {
             return false;
@@ -752,6 +1486,7 @@ struct BreakpointManager {
     // Unregister a patch site for a breakpoint
     // Note: This clears the patch tracking. Like apply_patch, actual code
     // restoration would require memory protection changes and cache flushing.
+    // Caller holds mutex.
     void restore_patch(BreakpointEntry& entry) {
         if (entry.has_patch && entry.compiled_patch_site) {
             entry.has_patch = false;
@@ -762,12 +1497,14 @@ struct BreakpointManager {
     
     // Get original instruction at breakpoint
     uint32_t get_original_instruction(uint32_t address) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = breakpoints.find(address);
         return it != breakpoints.end() ? it->second.original_instruction : 0;
     }
     
     // Get all breakpoint addresses
     std::vector<uint32_t> get_all_addresses() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         std::vector<uint32_t> addresses;
         addresses.reserve(breakpoints.size());
         for (const auto& pair : breakpoints) {
@@ -780,22 +1517,23 @@ struct BreakpointManager {
     
     // Get breakpoint count
     size_t get_count() const {
-        size_t count = 0;
-        for (const auto& pair : breakpoints) {
-            if (pair.second.is_active) {
-                count++;
-            }
-        }
-        return count;
+        return active_count.load(std::memory_order_acquire);
     }
     
     // Get statistics
-    const BreakpointStats& get_stats() const { return stats; }
+    BreakpointStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
     
     // Reset statistics
-    void reset_stats() { stats.reset(); }
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.reset();
+    }
     
     void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
         // Restore all patches before clearing
         for (auto& pair : breakpoints) {
             if (pair.second.has_patch) {
@@ -803,6 +1541,19 @@ struct BreakpointManager {
             }
         }
         breakpoints.clear();
+        update_active_count();
+    }
+    
+private:
+    // Caller holds mutex
+    void update_active_count() {
+        size_t count = 0;
+        for (const auto& pair : breakpoints) {
+            if (pair.second.is_active) {
+                count++;
+            }
+        }
+        active_count.store(count, std::memory_order_release);
     }
 };
 
@@ -864,32 +1615,41 @@ struct JitProfiler {
     std::unordered_map<uint32_t, BlockProfile> profiles;
     JitProfilingStats stats;
     uint64_t hot_threshold;         // Execution count to be considered "hot"
-    bool enabled;                   // Whether profiling is enabled
-    bool dump_ir_enabled;           // Whether to dump LLVM IR
+    std::atomic<bool> enabled;      // Whether profiling is enabled (checked without the lock)
+    std::atomic<bool> dump_ir_enabled; // Whether to dump LLVM IR
+    mutable oc_mutex mutex;
     
     JitProfiler() : hot_threshold(1000), enabled(false), dump_ir_enabled(false) {}
     
     // Enable/disable profiling
-    void set_enabled(bool enable) { enabled = enable; }
-    bool is_enabled() const { return enabled; }
+    void set_enabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
     
     // Enable/disable IR dumping
-    void set_dump_ir_enabled(bool enable) { dump_ir_enabled = enable; }
-    bool is_dump_ir_enabled() const { return dump_ir_enabled; }
+    void set_dump_ir_enabled(bool enable) { dump_ir_enabled.store(enable, std::memory_order_relaxed); }
+    bool is_dump_ir_enabled() const { return dump_ir_enabled.load(std::memory_order_relaxed); }
     
     // Set hot threshold
-    void set_hot_threshold(uint64_t threshold) { hot_threshold = threshold; }
-    uint64_t get_hot_threshold() const { return hot_threshold; }
+    void set_hot_threshold(uint64_t threshold) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        hot_threshold = threshold;
+    }
+    uint64_t get_hot_threshold() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return hot_threshold;
+    }
     
     // Register a block for profiling
     void register_block(uint32_t address, uint32_t instruction_count) {
-        if (!enabled) return;
+        if (!is_enabled()) return;
+        oc_lock_guard<oc_mutex> lock(mutex);
         profiles[address] = BlockProfile(address, instruction_count);
     }
     
     // Record compilation of a block
     void record_compilation(uint32_t address, uint64_t compile_time_ns) {
-        if (!enabled) return;
+        if (!is_enabled()) return;
+        oc_lock_guard<oc_mutex> lock(mutex);
         
         auto it = profiles.find(address);
         if (it != profiles.end()) {
@@ -905,7 +1665,8 @@ struct JitProfiler {
     
     // Record execution of a block
     void record_execution(uint32_t address, uint64_t execution_time_ns = 0) {
-        if (!enabled) return;
+        if (!is_enabled()) return;
+        oc_lock_guard<oc_mutex> lock(mutex);
         
         auto it = profiles.find(address);
         if (it != profiles.end()) {
@@ -931,18 +1692,21 @@ struct JitProfiler {
     
     // Get execution count for a block
     uint64_t get_execution_count(uint32_t address) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = profiles.find(address);
         return it != profiles.end() ? it->second.execution_count : 0;
     }
     
     // Check if block is hot
     bool is_hot(uint32_t address) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = profiles.find(address);
         return it != profiles.end() && it->second.is_hot;
     }
     
     // Get hot block addresses sorted by execution count (descending)
     std::vector<uint32_t> get_hot_blocks(size_t max_count = 100) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         std::vector<std::pair<uint32_t, uint64_t>> hot_blocks;
         for (const auto& pair : profiles) {
             if (pair.second.is_hot) {
@@ -963,23 +1727,42 @@ struct JitProfiler {
         return result;
     }
     
-    // Get profile for a specific block
-    const BlockProfile* get_profile(uint32_t address) const {
+    // Add execution counts to a warm start profile
+    void export_warm_start(WarmStartMap& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        for (const auto& pair : profiles) {
+            if (pair.second.execution_count == 0) continue;
+            auto& entry = out[pair.first];
+            entry.address = pair.first;
+            entry.execution_count = std::max(entry.execution_count, pair.second.execution_count);
+        }
+    }
+    
+    // Copy the profile for a specific block; returns false if not profiled
+    bool get_profile(uint32_t address, BlockProfile& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = profiles.find(address);
-        return it != profiles.end() ? &it->second : nullptr;
+        if (it == profiles.end()) return false;
+        out = it->second;
+        return true;
     }
     
     // Get statistics
-    const JitProfilingStats& get_stats() const { return stats; }
+    JitProfilingStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
     
     // Reset all profiling data
     void reset() {
+        oc_lock_guard<oc_mutex> lock(mutex);
         profiles.clear();
         stats.reset();
     }
     
     // Get average compilation time
     uint64_t get_avg_compilation_time_ns() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         return stats.total_blocks_compiled > 0 
                ? stats.total_compilation_time_ns / stats.total_blocks_compiled 
                : 0;
@@ -987,6 +1770,7 @@ struct JitProfiler {
     
     // Get average execution time
     uint64_t get_avg_execution_time_ns() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         return stats.total_executions > 0 
                ? stats.total_execution_time_ns / stats.total_executions 
                : 0;
@@ -1492,6 +2276,14 @@ struct BranchTargetCache {
         return 0;
     }
     
+    // Target of a branch that has only ever gone to one place, or 0; not
+    // counted as a lookup
+    uint32_t monomorphic_target(uint32_t branch_address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto it = monomorphic.find(branch_address);
+        return it != monomorphic.end() && it->second.is_valid ? it->second.target_address : 0;
+    }
+    
     // Update BTB with actual target taken
     void update(uint32_t branch_address, uint32_t actual_target) {
         oc_lock_guard<oc_mutex> lock(mutex);
@@ -1856,6 +2648,20 @@ struct ConstantPropagationCache {
         return false;
     }
     
+    // Registers known to hold a constant on entry to a block, without
+    // counting lookups
+    std::vector<std::pair<uint8_t, uint64_t>> entry_constants(uint32_t block_addr) {
+        std::vector<std::pair<uint8_t, uint64_t>> result;
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto it = register_values.find(block_addr);
+        if (it == register_values.end()) return result;
+        for (uint8_t reg = 0; reg < 32; reg++) {
+            const auto& entry = it->second[reg];
+            if (entry.is_known && entry.is_constant) result.emplace_back(reg, entry.value);
+        }
+        return result;
+    }
+    
     // Invalidate a register value at a specific block
     void invalidate_register(uint32_t block_addr, uint8_t reg_num) {
         if (reg_num >= 32) return;
@@ -2031,6 +2837,7 @@ struct RegisterLiveness {
  */
 struct RegisterAllocator {
     std::unordered_map<uint32_t, RegisterLiveness> block_liveness;
+    mutable oc_mutex mutex;
     
     // Analyze register usage in a basic block
     void analyze_block(uint32_t address, const std::vector<uint32_t>& instructions) {
@@ -2060,11 +2867,13 @@ struct RegisterAllocator {
             }
         }
         
+        oc_lock_guard<oc_mutex> lock(mutex);
         block_liveness[address] = liveness;
     }
     
     // Get allocation hints for a register
     RegAllocHint get_hint(uint32_t address, uint8_t reg) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = block_liveness.find(address);
         if (it == block_liveness.end()) {
             return RegAllocHint::None;
@@ -2080,13 +2889,17 @@ struct RegisterAllocator {
         return RegAllocHint::Caller;
     }
     
-    // Get liveness info for a block
-    const RegisterLiveness* get_liveness(uint32_t address) const {
+    // Copy liveness info for a block; returns false if not analyzed
+    bool get_liveness(uint32_t address, RegisterLiveness& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
         auto it = block_liveness.find(address);
-        return (it != block_liveness.end()) ? &it->second : nullptr;
+        if (it == block_liveness.end()) return false;
+        out = it->second;
+        return true;
     }
     
     void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
         block_liveness.clear();
     }
 };
@@ -2624,164 +3437,1658 @@ struct EnhancedRegisterAllocator {
     }
 };
 
+// ============================================================================
+// Guest Stack Slot Promotion
+// ============================================================================
+
 /**
- * Lazy compilation state
+ * A guest stack slot addressed as d(r1) inside a compiled region
+ *
+ * Offsets are relative to the value r1 held on region entry, so the same
+ * slot keeps its identity across stwu/addi frame adjustments.
  */
-enum class LazyState : uint8_t {
-    NotCompiled = 0,
-    Pending = 1,
-    Compiling = 2,
-    Compiled = 3,
-    Failed = 4
+struct StackSlot {
+    int32_t offset = 0;              // Offset from entry r1
+    uint8_t size = 0;                // 4 or 8 bytes
+    bool read_before_write = false;  // Guest value must be loaded on entry
+    bool written = false;            // Must be written back at calls and exits
+    uint32_t access_count = 0;
 };
 
 /**
- * Lazy compilation entry
+ * Result of the r1 analysis for one region
  */
-struct LazyCompilationEntry {
-    uint32_t address;
-    const uint8_t* code;
-    size_t size;
-    LazyState state;
-    std::atomic<uint32_t> execution_count;
-    uint32_t threshold;  // Compile after this many executions
-    
-    LazyCompilationEntry()
-        : address(0), code(nullptr), size(0), state(LazyState::NotCompiled),
-          execution_count(0), threshold(10) {}
-    
-    LazyCompilationEntry(uint32_t addr, const uint8_t* c, size_t s, uint32_t thresh = 10)
-        : address(addr), code(c), size(s), state(LazyState::NotCompiled),
-          execution_count(0), threshold(thresh) {}
-    
-    // Move constructor
-    LazyCompilationEntry(LazyCompilationEntry&& other) noexcept
-        : address(other.address), code(other.code), size(other.size),
-          state(other.state), execution_count(other.execution_count.load()),
-          threshold(other.threshold) {}
-    
-    // Move assignment
-    LazyCompilationEntry& operator=(LazyCompilationEntry&& other) noexcept {
-        if (this != &other) {
-            address = other.address;
-            code = other.code;
-            size = other.size;
-            state = other.state;
-            execution_count.store(other.execution_count.load());
-            threshold = other.threshold;
-        }
-        return *this;
-    }
-    
-    // Delete copy operations
-    LazyCompilationEntry(const LazyCompilationEntry&) = delete;
-    LazyCompilationEntry& operator=(const LazyCompilationEntry&) = delete;
+struct StackFrameInfo {
+    bool r1_known = true;          // r1 only changed by constant adjustments
+    bool address_escapes = false;  // r1 or a stack address flows elsewhere
+    int64_t final_r1_delta = 0;    // r1 at exit minus r1 at entry
+    int64_t min_r1_delta = 0;      // Deepest frame allocated by the region
+    std::vector<StackSlot> slots;
+    std::unordered_map<size_t, size_t> promoted;  // instruction index -> slot
     
-    bool should_compile() {
-        return execution_count.fetch_add(1) + 1 >= threshold;
+    bool can_promote() const {
+        return r1_known && !address_escapes && !promoted.empty();
     }
 };
 
+#ifdef HAVE_LLVM
+/**
+ * Check whether an instruction ends the region or transfers control out of it
+ * (branches and system calls), i.e. a point where stack slots must be in memory
+ */
+static bool is_stack_sync_point(uint32_t instr) {
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    return opcode == 16 || opcode == 17 || opcode == 18 || opcode == 19;
+}
+#endif
+
 /**
- * Lazy compilation manager
+ * Analyze r1 usage in a region and find stack slots that can live in SSA
+ *
+ * A slot is promoted when every access to it is an aligned D/DS-form
+ * lwz/stw/ld/std/lfd/stfd off r1 of one size, no other r1-based access
+ * overlaps it, and it lies in a frame the region allocated itself (below
+ * entry r1). Frames allocated by earlier blocks may already have their
+ * address taken, so they are left alone. Any write to r1 other than
+ * stwu/stdu r1,-N(r1) or addi r1,r1,imm, and any other read of r1, disables
+ * promotion for the whole region.
  */
-struct LazyCompilationManager {
-    std::unordered_map<uint32_t, std::unique_ptr<LazyCompilationEntry>> entries;
-    oc_mutex mutex;
+static StackFrameInfo analyze_stack_frame(const std::vector<uint32_t>& instructions) {
+    StackFrameInfo info;
     
-    void register_lazy(uint32_t address, const uint8_t* code, size_t size, uint32_t threshold = 10) {
-        oc_lock_guard<oc_mutex> lock(mutex);
-        entries[address] = std::make_unique<LazyCompilationEntry>(address, code, size, threshold);
+    struct Access { size_t index; int64_t offset; uint8_t size; bool is_store; };
+    struct Range { int64_t begin; int64_t end; };
+    std::vector<Access> accesses;
+    std::vector<Range> pinned;  // Ranges touched by non-promotable accesses
+    
+    int64_t delta = 0;
+    for (size_t i = 0; i < instructions.size() && info.r1_known; i++) {
+        uint32_t instr = instructions[i];
+        uint8_t opcode = (instr >> 26) & 0x3F;
+        uint8_t rt = (instr >> 21) & 0x1F;
+        uint8_t ra = (instr >> 16) & 0x1F;
+        uint8_t rb = (instr >> 11) & 0x1F;
+        int16_t simm = static_cast<int16_t>(instr & 0xFFFF);
+        int16_t ds = static_cast<int16_t>(instr & 0xFFFC);
+        uint8_t ds_xo = instr & 3;
+        
+        switch (opcode) {
+            case 14: // addi
+                if (rt == 1) {
+                    if (ra == 1) delta += simm;
+                    else info.r1_known = false;
+                } else if (ra == 1) {
+                    info.address_escapes = true;  // Stack address taken
+                }
+                break;
+            
+            case 32: case 36: case 50: case 54: { // lwz, stw, lfd, stfd
+                bool is_store = opcode == 36 || opcode == 54;
+                bool is_gpr = opcode == 32 || opcode == 36;
+                if (is_gpr && rt == 1) {
+                    if (is_store) info.address_escapes = true;
+                    else info.r1_known = false;
+                }
+                if (ra == 1) {
+                    accesses.push_back({i, delta + simm,
+                        static_cast<uint8_t>(opcode >= 50 ? 8 : 4), is_store});
+                }
+                break;
+            }
+            
+            case 58: case 62: { // ld/ldu/lwa, std/stdu
+                bool is_store = opcode == 62;
+                if (rt == 1) {
+                    if (is_store) info.address_escapes = true;
+                    else info.r1_known = false;
+                }
+                if (ra != 1) break;
+                if (ds_xo == 0) {
+                    accesses.push_back({i, delta + ds, 8, is_store});
+                } else if (is_store && ds_xo == 1 && rt == 1) {
+                    // stdu r1, -N(r1): frame allocation, back chain stays in memory
+                    pinned.push_back({delta + ds, delta + ds + 8});
+                    delta += ds;
+                } else {
+                    pinned.push_back({delta + ds, delta + ds + (ds_xo == 2 ? 4 : 8)});
+                    if (ds_xo == 1) info.r1_known = false;  // ldu/stdu moves r1
+                }
+                break;
+            }
+            
+            case 37: // stwu
+                if (ra == 1 && rt == 1) {
+                    // stwu r1, -N(r1): frame allocation, back chain stays in memory
+                    pinned.push_back({delta + simm, delta + simm + 4});
+                    delta += simm;
+                } else if (ra == 1) {
+                    info.r1_known = false;
+                } else if (rt == 1) {
+                    info.address_escapes = true;
+                }
+                break;
+            
+            case 10: case 11: // cmpli, cmpi: the rt field holds crfD/L
+                if (ra == 1) info.address_escapes = true;
+                break;
+            
+            case 4: case 59: case 63: // VMX and FP arithmetic: no GPR operands
+            case 16: case 17: case 18: case 19: // Branches, sc, CR ops
+                break;
+            
+            default:
+                if (opcode >= 33 && opcode <= 55) {
+                    // Remaining D-form loads/stores: not promoted, but pin
+                    // whatever they touch so promoted slots never alias them
+                    static const uint8_t sizes[] = {
+                        4, 1, 1, 4, 4, 1, 1, 2, 2, 2, 2, 2, 2, 4, 4, 4, 4, 8, 8, 4, 4, 8, 8
+                    }; // opcodes 33..55
+                    bool is_fp = opcode >= 48;
+                    bool is_multiple = opcode == 46 || opcode == 47;  // lmw, stmw
+                    bool is_store = is_fp ? (opcode >= 52) : ((opcode >= 36 && opcode <= 39) ||
+                                    opcode == 44 || opcode == 45 || opcode == 47);
+                    bool updates = (opcode & 1) && opcode != 47;
+                    if (ra == 1) {
+                        int64_t size = is_multiple ? (32 - rt) * 4 : sizes[opcode - 33];
+                        pinned.push_back({delta + simm, delta + simm + size});
+                        if (updates) info.r1_known = false;
+                    }
+                    bool touches_r1 = is_multiple ? rt <= 1 : rt == 1;
+                    if (!is_fp && touches_r1) {
+                        if (is_store) info.address_escapes = true;
+                        else info.r1_known = false;
+                    }
+                } else if (rt == 1 || ra == 1 || rb == 1) {
+                    // Unknown use or definition of r1
+                    info.r1_known = false;
+                }
+                break;
+        }
+        if (delta < info.min_r1_delta) info.min_r1_delta = delta;
     }
+    info.final_r1_delta = delta;
+    if (!info.r1_known || info.address_escapes) return info;
     
-    LazyCompilationEntry* get_entry(uint32_t address) {
-        oc_lock_guard<oc_mutex> lock(mutex);
-        auto it = entries.find(address);
-        return (it != entries.end()) ? it->second.get() : nullptr;
+    // Group accesses into slots; a slot must have a single, aligned size and
+    // sit inside the frame this region allocated
+    std::unordered_map<int64_t, size_t> slot_at;
+    std::vector<bool> slot_ok;
+    for (const auto& acc : accesses) {
+        auto it = slot_at.find(acc.offset);
+        if (it == slot_at.end()) {
+            StackSlot slot;
+            slot.offset = static_cast<int32_t>(acc.offset);
+            slot.size = acc.size;
+            slot.read_before_write = !acc.is_store;
+            it = slot_at.emplace(acc.offset, info.slots.size()).first;
+            info.slots.push_back(slot);
+            slot_ok.push_back(acc.offset >= info.min_r1_delta &&
+                              acc.offset + acc.size <= 0 &&
+                              (acc.offset % acc.size) == 0);
+        }
+        StackSlot& slot = info.slots[it->second];
+        if (slot.size != acc.size) slot_ok[it->second] = false;
+        slot.written |= acc.is_store;
+        slot.access_count++;
     }
     
-    void mark_compiling(uint32_t address) {
-        oc_lock_guard<oc_mutex> lock(mutex);
-        auto it = entries.find(address);
-        if (it != entries.end()) {
-            it->second->state = LazyState::Compiling;
+    // Reject slots that overlap each other or a pinned range
+    for (size_t s = 0; s < info.slots.size(); s++) {
+        int64_t begin = info.slots[s].offset;
+        int64_t end = begin + info.slots[s].size;
+        for (const auto& r : pinned) {
+            if (begin < r.end && r.begin < end) slot_ok[s] = false;
+        }
+        for (size_t o = 0; o < info.slots.size(); o++) {
+            if (o == s) continue;
+            int64_t obegin = info.slots[o].offset;
+            if (begin < obegin + info.slots[o].size && obegin < end) slot_ok[s] = false;
         }
     }
     
-    void mark_compiled(uint32_t address) {
+    // Compact the surviving slots and map their accesses
+    std::vector<size_t> remap(info.slots.size(), SIZE_MAX);
+    std::vector<StackSlot> kept;
+    for (size_t s = 0; s < info.slots.size(); s++) {
+        if (!slot_ok[s]) continue;
+        remap[s] = kept.size();
+        kept.push_back(info.slots[s]);
+    }
+    info.slots = std::move(kept);
+    for (const auto& acc : accesses) {
+        size_t s = remap[slot_at[acc.offset]];
+        if (s != SIZE_MAX) info.promoted[acc.index] = s;
+    }
+    return info;
+}
+
+/**
+ * Stack promotion statistics
+ */
+struct StackPromotionStats {
+    uint64_t regions_analyzed = 0;
+    uint64_t regions_promoted = 0;
+    uint64_t slots_promoted = 0;
+    uint64_t accesses_promoted = 0;
+    uint64_t r1_unknown = 0;        // Regions rejected for untracked r1 writes
+    uint64_t address_escaped = 0;   // Regions rejected for escaping stack addresses
+};
+
+/**
+ * Stack slot promotion pass state
+ */
+struct StackSlotPromoter {
+    std::atomic<bool> enabled{true};
+    StackPromotionStats stats;
+    mutable oc_mutex mutex;
+    
+    StackFrameInfo analyze(const std::vector<uint32_t>& instructions) {
+        StackFrameInfo info = analyze_stack_frame(instructions);
+        
         oc_lock_guard<oc_mutex> lock(mutex);
-        auto it = entries.find(address);
-        if (it != entries.end()) {
-            it->second->state = LazyState::Compiled;
+        stats.regions_analyzed++;
+        if (!info.r1_known) {
+            stats.r1_unknown++;
+        } else if (info.address_escapes) {
+            stats.address_escaped++;
+        } else if (info.can_promote()) {
+            stats.regions_promoted++;
+            stats.slots_promoted += info.slots.size();
+            stats.accesses_promoted += info.promoted.size();
         }
+        return info;
     }
     
-    void mark_failed(uint32_t address) {
+    StackPromotionStats get_stats() const {
         oc_lock_guard<oc_mutex> lock(mutex);
-        auto it = entries.find(address);
-        if (it != entries.end()) {
-            it->second->state = LazyState::Failed;
-        }
+        return stats;
     }
     
-    void clear() {
+    void reset_stats() {
         oc_lock_guard<oc_mutex> lock(mutex);
-        entries.clear();
+        stats = StackPromotionStats();
     }
 };
 
+// ============================================================================
+// VMX Byte Order Folding
+// ============================================================================
+
 /**
- * Lazy compilation statistics
+ * Representation of a VR value inside a compiled region
+ *
+ * GuestOrder holds the 16 bytes exactly as they sit in guest memory, which is
+ * what lvx/stvx and the lane-indexed ops operate on. Reversed is the full
+ * 16-byte reversal: lane order is flipped but every element is in host byte
+ * order, so elementwise arithmetic and compares are correct on it.
  */
-struct LazyCompilationStats {
-    uint64_t total_registered;       // Total functions registered for lazy compilation
-    uint64_t total_compiled;         // Total functions compiled
-    uint64_t total_failed;           // Total compilation failures
-    uint64_t total_executions;       // Total execution count across all entries
-    uint64_t hot_path_promotions;    // Times a function was promoted to hot status
-    uint64_t stub_calls;             // Times interpreter stub was called
-    
-    LazyCompilationStats()
-        : total_registered(0), total_compiled(0), total_failed(0),
-          total_executions(0), hot_path_promotions(0), stub_calls(0) {}
+enum class VrLayout : uint8_t {
+    GuestOrder = 0,
+    Reversed = 1,
 };
 
 /**
- * Hot path entry for prioritization
+ * How a VMX instruction depends on lane order
  */
-struct HotPathEntry {
-    uint32_t address;
-    uint32_t execution_count;
-    bool is_compiled;
-    
-    HotPathEntry() : address(0), execution_count(0), is_compiled(false) {}
-    HotPathEntry(uint32_t addr, uint32_t count, bool compiled)
-        : address(addr), execution_count(count), is_compiled(compiled) {}
-    
-    // Higher execution count = higher priority
-    bool operator<(const HotPathEntry& other) const {
-        return execution_count < other.execution_count;
-    }
+enum class VmxLaneClass : uint8_t {
+    None = 0,          // Does not touch VRs
+    Bitwise,           // Byte-agnostic: runs in either layout if operands agree
+    Elementwise,       // Needs host-order elements, lane order irrelevant
+    SplatImmediate,    // All lanes equal: produced directly in Reversed layout
+    LaneOrdered,       // Lane or byte index observable: needs GuestOrder
 };
 
 /**
- * Interpreter stub callback type
- * Called when uncompiled code is executed
- * Returns: 0 = continue with interpreter, 1 = code is now compiled
+ * VR operands of one instruction
  */
-using InterpreterStubCallback = int (*)(uint32_t address, void* user_data);
+struct VmxLaneUse {
+    VmxLaneClass kind = VmxLaneClass::None;
+    uint32_t reads = 0;   // Bitmask of VRs read
+    uint32_t writes = 0;  // Bitmask of VRs written
+};
 
 /**
- * Enhanced lazy compilation manager with hot path detection and stub support
+ * Classify the VR operands of an instruction
+ *
+ * Decodes the same sub-opcode fields as emit_ppu_instruction so that the plan
+ * matches what is emitted. An opcode 4 word that hits both the VA-form and
+ * the VX-form switch of the emitter with different requirements is treated
+ * as lane-ordered.
  */
-struct EnhancedLazyCompilationManager {
-    std::unordered_map<uint32_t, std::unique_ptr<LazyCompilationEntry>> entries;
-    std::priority_queue<HotPathEntry> hot_queue;  // Priority queue for hot paths
-    mutable oc_mutex mutex;  // mutable to allow locking in const methods
+static VmxLaneUse classify_vmx_lanes(uint32_t instr) {
+    VmxLaneUse use;
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    uint32_t vt = 1u << ((instr >> 21) & 0x1F);
+    uint32_t va = 1u << ((instr >> 16) & 0x1F);
+    uint32_t vb = 1u << ((instr >> 11) & 0x1F);
+    uint32_t vc = 1u << ((instr >> 6) & 0x1F);
+    
+    if (opcode == 31) {
+        switch ((instr >> 1) & 0x3FF) {
+            case 103:  // lvx
+                use = {VmxLaneClass::LaneOrdered, 0, vt};
+                break;
+            case 231:  // stvx
+            case 135: case 167: case 199:  // stvebx/stvehx/stvewx
+                use = {VmxLaneClass::LaneOrdered, vt, 0};
+                break;
+            case 7: case 39: case 71:  // lvebx/lvehx/lvewx merge into vt
+                use = {VmxLaneClass::LaneOrdered, vt, vt};
+                break;
+            default:
+                break;
+        }
+        return use;
+    }
+    if (opcode != 4) return use;
     
-    uint32_t default_threshold;          // Default compilation threshold
-    uint32_t hot_threshold;              // Threshold to consider a path "hot"
-    InterpreterStubCallback stub_callback;
+    VmxLaneUse va_use;
+    switch (instr & 0x3F) {
+        case 46: case 47:  // vmaddfp/vnmsubfp
+            va_use = {VmxLaneClass::Elementwise, va | vb | vc, vt};
+            break;
+        case 42:  // vsel
+            va_use = {VmxLaneClass::Bitwise, va | vb | vc, vt};
+            break;
+        case 43:  // vperm
+            va_use = {VmxLaneClass::LaneOrdered, va | vb | vc, vt};
+            break;
+        default:
+            break;
+    }
+    
+    VmxLaneUse vx_use;
+    switch (instr & 0x7FF) {
+        case 10: case 74:              // vaddfp/vsubfp
+        case 134: case 902:            // vcmpequw/vcmpgtsw
+        case 128: case 1152:           // vadduwm/vsubuwm
+        case 896: case 640:            // vaddsws/vadduws
+        case 386: case 898: case 1410: // vmaxsw/vminsw/vavgsw
+            vx_use = {VmxLaneClass::Elementwise, va | vb, vt};
+            break;
+        case 1028: case 1156: case 1220: case 1284:  // vand/vor/vxor/vnor
+            vx_use = {VmxLaneClass::Bitwise, va | vb, vt};
+            break;
+        case 840: case 904:            // vmulesh/vmulesw pick even lanes
+        case 140: case 396:            // vmrghw/vmrglw
+        case 14: case 78:              // vpkuhum/vpkuwum
+            vx_use = {VmxLaneClass::LaneOrdered, va | vb, vt};
+            break;
+        case 652: case 588: case 524:  // vspltw/vsplth/vspltb
+        case 590: case 718:            // vupkhsh/vupklsh
+            vx_use = {VmxLaneClass::LaneOrdered, vb, vt};
+            break;
+        case 908:                      // vspltisw
+            vx_use = {VmxLaneClass::SplatImmediate, 0, vt};
+            break;
+        default:
+            break;
+    }
+    
+    if (va_use.kind == VmxLaneClass::None) return vx_use;
+    if (vx_use.kind == VmxLaneClass::None) return va_use;
+    use.kind = va_use.kind == vx_use.kind ? va_use.kind : VmxLaneClass::LaneOrdered;
+    use.reads = va_use.reads | vx_use.reads;
+    use.writes = va_use.writes | vx_use.writes;
+    return use;
+}
+
+/**
+ * Where the emitter has to reverse VR values in one region
+ */
+struct VmxSwapPlan {
+    std::unordered_map<size_t, uint32_t> swaps_before;  // instruction index -> VRs to reverse
+    uint32_t vector_instructions = 0;
+    uint32_t memory_accesses = 0;   // Vector loads/stores, each a swap if done eagerly
+    uint32_t swaps = 0;             // Reversals actually emitted
+    uint32_t reversed_at_end = 0;   // VRs left in Reversed layout
+    
+    uint32_t swaps_folded() const {
+        return memory_accesses > swaps ? memory_accesses - swaps : 0;
+    }
+};
+
+/**
+ * Track the layout of every VR through a region and place reversals lazily
+ *
+ * Loads leave values in guest order. A value is reversed only when an
+ * elementwise op needs host-order elements or a lane-ordered op needs guest
+ * order, and the new layout sticks until the next such op. Bitwise ops follow
+ * whichever layout most of their operands are already in. VRs enter in guest
+ * order; reversed_at_end tells the exit which of them to store from the
+ * reversed layout, so no swap is placed for the exit itself.
+ */
+static VmxSwapPlan plan_vmx_byte_order(const std::vector<uint32_t>& instructions) {
+    VmxSwapPlan plan;
+    uint32_t reversed = 0;  // Bitmask of VRs currently in Reversed layout
+    
+    for (size_t i = 0; i < instructions.size(); i++) {
+        VmxLaneUse use = classify_vmx_lanes(instructions[i]);
+        if (use.kind == VmxLaneClass::None) continue;
+        plan.vector_instructions++;
+        if ((instructions[i] >> 26) == 31) plan.memory_accesses++;
+        
+        VrLayout want = VrLayout::GuestOrder;
+        switch (use.kind) {
+            case VmxLaneClass::Elementwise:
+            case VmxLaneClass::SplatImmediate:
+                want = VrLayout::Reversed;
+                break;
+            case VmxLaneClass::Bitwise: {
+                int in_reversed = __builtin_popcount(use.reads & reversed);
+                int in_guest = __builtin_popcount(use.reads & ~reversed);
+                want = in_reversed > in_guest ? VrLayout::Reversed : VrLayout::GuestOrder;
+                break;
+            }
+            default:
+                break;
+        }
+        
+        uint32_t mismatched = want == VrLayout::Reversed ? use.reads & ~reversed
+                                                          : use.reads & reversed;
+        if (mismatched) {
+            plan.swaps_before[i] = mismatched;
+            plan.swaps += __builtin_popcount(mismatched);
+            reversed ^= mismatched;
+        }
+        if (want == VrLayout::Reversed) {
+            reversed |= use.writes;
+        } else {
+            reversed &= ~use.writes;
+        }
+    }
+    plan.reversed_at_end = reversed;
+    return plan;
+}
+
+/**
+ * VMX byte order folding statistics
+ */
+struct VmxByteOrderStats {
+    uint64_t regions_analyzed = 0;
+    uint64_t vector_instructions = 0;
+    uint64_t swaps_emitted = 0;
+    uint64_t swaps_folded = 0;     // Eager load/store swaps that were not needed
+};
+
+/**
+ * VMX byte order folding pass state
+ *
+ * When disabled every VR stays in guest order, as the emitter did before.
+ */
+struct VmxByteOrderPlanner {
+    std::atomic<bool> enabled{true};
+    VmxByteOrderStats stats;
+    mutable oc_mutex mutex;
+    
+    VmxSwapPlan plan(const std::vector<uint32_t>& instructions) {
+        VmxSwapPlan result = plan_vmx_byte_order(instructions);
+        if (result.vector_instructions == 0) return result;
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.regions_analyzed++;
+        stats.vector_instructions += result.vector_instructions;
+        stats.swaps_emitted += result.swaps;
+        stats.swaps_folded += result.swaps_folded();
+        return result;
+    }
+    
+    VmxByteOrderStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = VmxByteOrderStats();
+    }
+};
+
+// ============================================================================
+// PPC Idiom Recognition
+// ============================================================================
+
+/**
+ * Multi-instruction guest sequences emitted as one host operation
+ */
+enum class PpcIdiomKind : uint8_t {
+    Constant = OC_PPU_IDIOM_CONSTANT,            // li/lis + ori/oris/addi/addis/sldi chain
+    RotateMask = OC_PPU_IDIOM_ROTATE_MASK,       // rlwinm feeding rlwinm
+    Extend = OC_PPU_IDIOM_EXTEND,                // extsb/extsh/extsw/clrldi chain
+    ByteSwap = OC_PPU_IDIOM_BYTE_SWAP,           // rotlwi + rlwimi byte reversal
+    CompareBranch = OC_PPU_IDIOM_COMPARE_BRANCH, // cmp* + bc on the same CR field
+};
+
+/**
+ * One recognized idiom, starting at the instruction index it is keyed by
+ */
+struct PpcIdiom {
+    PpcIdiomKind kind = PpcIdiomKind::Constant;
+    uint8_t length = 0;        // Guest instructions covered
+    uint8_t rd = 0;            // GPR written (not CompareBranch)
+    uint8_t rs = 0;            // GPR read (CompareBranch: rA)
+    uint8_t rb = 0;            // CompareBranch register form: rB
+    uint8_t shift = 0;         // RotateMask: total rotate amount
+    uint8_t width = 0;         // Extend: bits kept; ByteSwap: 16 or 32
+    bool sign = false;         // Extend: sign- rather than zero-extend
+    uint64_t value = 0;        // Constant: value; RotateMask: mask; CompareBranch: immediate
+    // CompareBranch
+    uint8_t crf = 0;           // CR field written by the compare
+    uint8_t cr_bit = 0;        // Bit tested by the branch: 0 LT, 1 GT, 2 EQ
+    bool is_signed = false;
+    bool doubleword = false;   // L = 1
+    bool immediate = false;    // cmpi/cmpli rather than cmp/cmpl
+    bool branch_if_true = false;
+    int32_t displacement = 0;  // Branch target relative to the bc
+};
+
+/**
+ * Idioms recognized in one region
+ */
+struct IdiomPlan {
+    std::unordered_map<size_t, PpcIdiom> at;  // first instruction index -> idiom
+    uint32_t counts[OC_PPU_IDIOM_COUNT] = {};
+    uint32_t instructions_fused = 0;          // Guest instructions covered by idioms
+};
+
+/**
+ * Mask of rlwinm/rlwimi bits mb..me (IBM numbering, wrapping when mb > me)
+ */
+static uint32_t rotate_mask32(uint8_t mb, uint8_t me) {
+    return mb <= me ? ((0xFFFFFFFFu >> mb) & (0xFFFFFFFFu << (31 - me)))
+                    : ((0xFFFFFFFFu >> mb) | (0xFFFFFFFFu << (31 - me)));
+}
+
+static uint32_t rotl32(uint32_t value, uint8_t shift) {
+    shift &= 31;
+    return shift ? (value << shift) | (value >> (32 - shift)) : value;
+}
+
+/**
+ * Decode an integer extension: extsb/extsh/extsw or rldicl rA,rS,0,mb
+ * (clrldi). Record forms are rejected since the idiom does not set CR0.
+ */
+static bool decode_extension(uint32_t instr, uint8_t& rd, uint8_t& rs,
+                             uint8_t& width, bool& sign) {
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    if (instr & 1) return false;
+    rs = (instr >> 21) & 0x1F;
+    rd = (instr >> 16) & 0x1F;
+    if (opcode == 31) {
+        if ((instr >> 11) & 0x1F) return false;
+        switch ((instr >> 1) & 0x3FF) {
+            case 954: width = 8; break;   // extsb
+            case 922: width = 16; break;  // extsh
+            case 986: width = 32; break;  // extsw
+            default: return false;
+        }
+        sign = true;
+        return true;
+    }
+    if (opcode == 30 && ((instr >> 2) & 7) == 0) {  // rldicl
+        uint8_t sh = ((instr >> 11) & 0x1F) | (((instr >> 1) & 1) << 5);
+        uint8_t mb = ((instr >> 6) & 0x1F) | (((instr >> 5) & 1) << 5);
+        if (sh != 0 || mb == 0) return false;
+        width = 64 - mb;
+        sign = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * li/lis rD followed by ori/oris/addi/addis/sldi that read and write rD:
+ * the whole chain is one constant
+ */
+static size_t match_constant(const std::vector<uint32_t>& instrs, size_t i, PpcIdiom& idiom) {
+    uint32_t first = instrs[i];
+    uint8_t opcode = (first >> 26) & 0x3F;
+    if ((opcode != 14 && opcode != 15) || ((first >> 16) & 0x1F) != 0) return 0;
+    uint8_t rd = (first >> 21) & 0x1F;
+    int64_t simm = static_cast<int16_t>(first & 0xFFFF);
+    uint64_t value = opcode == 14 ? static_cast<uint64_t>(simm) : static_cast<uint64_t>(simm) << 16;
+    
+    size_t n = 1;
+    for (; i + n < instrs.size(); n++) {
+        uint32_t instr = instrs[i + n];
+        uint8_t op = (instr >> 26) & 0x3F;
+        uint8_t rt = (instr >> 21) & 0x1F;
+        uint8_t ra = (instr >> 16) & 0x1F;
+        uint16_t uimm = instr & 0xFFFF;
+        if (rt != rd || ra != rd) break;
+        if (op == 14 || op == 15) {
+            if (rd == 0) break;  // rA = 0 is the literal zero
+            int64_t imm = static_cast<int16_t>(uimm);
+            value += op == 14 ? static_cast<uint64_t>(imm) : static_cast<uint64_t>(imm) << 16;
+        } else if (op == 24 || op == 25) {
+            value |= op == 24 ? uint64_t(uimm) : uint64_t(uimm) << 16;
+        } else if (op == 30 && ((instr >> 2) & 7) == 1 && !(instr & 1)) {  // rldicr
+            uint8_t sh = ((instr >> 11) & 0x1F) | (((instr >> 1) & 1) << 5);
+            uint8_t me = ((instr >> 6) & 0x1F) | (((instr >> 5) & 1) << 5);
+            if (sh == 0 || me != 63 - sh) break;  // Only sldi
+            value <<= sh;
+        } else {
+            break;
+        }
+    }
+    if (n < 2) return 0;
+    idiom.kind = PpcIdiomKind::Constant;
+    idiom.rd = rd;
+    idiom.value = value;
+    return n;
+}
+
+/**
+ * rlwinm rD,rS,s1,m1 followed by rlwinm rD,rD,s2,m2...: rotations add up
+ * and masks combine, so the chain is one rotate and one AND. The last mask
+ * must not wrap, so the 64-bit result is the zero-extended word.
+ */
+static size_t match_rotate_mask(const std::vector<uint32_t>& instrs, size_t i, PpcIdiom& idiom) {
+    auto decode = [&](uint32_t instr, uint8_t& rd, uint8_t& rs, uint8_t& sh,
+                      uint8_t& mb, uint8_t& me) {
+        if (((instr >> 26) & 0x3F) != 21 || (instr & 1)) return false;
+        rs = (instr >> 21) & 0x1F;
+        rd = (instr >> 16) & 0x1F;
+        sh = (instr >> 11) & 0x1F;
+        mb = (instr >> 6) & 0x1F;
+        me = (instr >> 1) & 0x1F;
+        return true;
+    };
+    uint8_t rd, rs, sh, mb, me;
+    if (!decode(instrs[i], rd, rs, sh, mb, me)) return 0;
+    uint8_t total_shift = sh;
+    uint32_t mask = rotate_mask32(mb, me);
+    bool wraps = mb > me;
+    
+    size_t n = 1;
+    for (; i + n < instrs.size(); n++) {
+        uint8_t d, s;
+        if (!decode(instrs[i + n], d, s, sh, mb, me) || d != rd || s != rd || mb > me) break;
+        total_shift = (total_shift + sh) & 31;
+        mask = rotl32(mask, sh) & rotate_mask32(mb, me);
+        wraps = false;
+    }
+    if (n < 2 || wraps) return 0;
+    idiom.kind = PpcIdiomKind::RotateMask;
+    idiom.rd = rd;
+    idiom.rs = rs;
+    idiom.shift = total_shift;
+    idiom.value = mask;
+    return n;
+}
+
+/**
+ * Chains of sign and zero extensions of the same value: the narrowest
+ * extension wins, except that a zero-extension after a narrower
+ * sign-extension needs both and ends the chain
+ */
+static size_t match_extend(const std::vector<uint32_t>& instrs, size_t i, PpcIdiom& idiom) {
+    uint8_t rd, rs, width;
+    bool sign;
+    if (!decode_extension(instrs[i], rd, rs, width, sign)) return 0;
+    
+    size_t n = 1;
+    for (; i + n < instrs.size(); n++) {
+        uint8_t d, s, w;
+        bool sg;
+        if (!decode_extension(instrs[i + n], d, s, w, sg) || d != rd || s != rd) break;
+        if (width >= w) {
+            width = w;
+            sign = sg;
+        } else if (sign && !sg) {
+            break;
+        }
+    }
+    if (n < 2) return 0;
+    idiom.kind = PpcIdiomKind::Extend;
+    idiom.rd = rd;
+    idiom.rs = rs;
+    idiom.width = width;
+    idiom.sign = sign;
+    return n;
+}
+
+/**
+ * Word and halfword byte reversal built from rotates:
+ *   rotlwi rT,rS,8; rlwimi rT,rS,24,0,7; rlwimi rT,rS,24,16,23
+ *   rlwinm rT,rS,24,24,31; rlwimi rT,rS,8,16,23
+ * (inserts in either order, rT != rS)
+ */
+static size_t match_byte_swap(const std::vector<uint32_t>& instrs, size_t i, PpcIdiom& idiom) {
+    struct Rotate { uint8_t opcode, rd, rs, sh, mb, me; };
+    auto decode = [&](size_t k, Rotate& r) {
+        uint32_t instr = instrs[k];
+        r.opcode = (instr >> 26) & 0x3F;
+        r.rs = (instr >> 21) & 0x1F;
+        r.rd = (instr >> 16) & 0x1F;
+        r.sh = (instr >> 11) & 0x1F;
+        r.mb = (instr >> 6) & 0x1F;
+        r.me = (instr >> 1) & 0x1F;
+        return (r.opcode == 20 || r.opcode == 21) && !(instr & 1);
+    };
+    auto is = [](const Rotate& r, uint8_t opcode, uint8_t sh, uint8_t mb, uint8_t me) {
+        return r.opcode == opcode && r.sh == sh && r.mb == mb && r.me == me;
+    };
+    
+    Rotate a, b, c;
+    if (i + 1 >= instrs.size() || !decode(i, a) || !decode(i + 1, b)) return 0;
+    if (a.opcode != 21 || a.rd == a.rs || b.rd != a.rd || b.rs != a.rs) return 0;
+    
+    if (is(a, 21, 8, 0, 31) && i + 2 < instrs.size() && decode(i + 2, c) &&
+        c.rd == a.rd && c.rs == a.rs &&
+        ((is(b, 20, 24, 0, 7) && is(c, 20, 24, 16, 23)) ||
+         (is(b, 20, 24, 16, 23) && is(c, 20, 24, 0, 7)))) {
+        idiom.width = 32;
+    } else if ((is(a, 21, 24, 24, 31) && is(b, 20, 8, 16, 23)) ||
+               (is(a, 21, 8, 16, 23) && is(b, 20, 24, 24, 31))) {
+        idiom.width = 16;
+    } else {
+        return 0;
+    }
+    idiom.kind = PpcIdiomKind::ByteSwap;
+    idiom.rd = a.rd;
+    idiom.rs = a.rs;
+    return idiom.width == 32 ? 3 : 2;
+}
+
+/**
+ * cmp/cmpl/cmpi/cmpli into crF immediately followed by a bc on crF that
+ * ends the region: the branch decision is taken from the compare directly
+ * instead of being re-read from CR. Only plain conditional branches (no CTR,
+ * no link, relative) on LT/GT/EQ qualify.
+ */
+static size_t match_compare_branch(const std::vector<uint32_t>& instrs, size_t i, PpcIdiom& idiom) {
+    if (i + 2 != instrs.size()) return 0;
+    uint32_t cmp = instrs[i];
+    uint32_t bc = instrs[i + 1];
+    uint8_t opcode = (cmp >> 26) & 0x3F;
+    
+    if (opcode == 11 || opcode == 10) {
+        idiom.immediate = true;
+        idiom.is_signed = opcode == 11;
+        idiom.value = idiom.is_signed ? static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(cmp & 0xFFFF)))
+                                      : uint64_t(cmp & 0xFFFF);
+    } else if (opcode == 31 && !(cmp & 1) &&
+               (((cmp >> 1) & 0x3FF) == 0 || ((cmp >> 1) & 0x3FF) == 32)) {
+        idiom.immediate = false;
+        idiom.is_signed = ((cmp >> 1) & 0x3FF) == 0;
+        idiom.rb = (cmp >> 11) & 0x1F;
+    } else {
+        return 0;
+    }
+    if ((cmp >> 22) & 1) return 0;  // Reserved bit of the BF field
+    
+    uint8_t bo = (bc >> 21) & 0x1F;
+    uint8_t bi = (bc >> 16) & 0x1F;
+    if (((bc >> 26) & 0x3F) != 16 || (bc & 3) != 0) return 0;  // AA = LK = 0
+    if ((bo & 0x14) != 0x04) return 0;  // Conditional, CTR untouched
+    if ((bi >> 2) != ((cmp >> 23) & 7) || (bi & 3) == 3) return 0;
+    
+    idiom.kind = PpcIdiomKind::CompareBranch;
+    idiom.crf = (cmp >> 23) & 7;
+    idiom.doubleword = (cmp >> 21) & 1;
+    idiom.rs = (cmp >> 16) & 0x1F;
+    idiom.cr_bit = bi & 3;
+    idiom.branch_if_true = (bo & 0x08) != 0;
+    idiom.displacement = static_cast<int16_t>(bc & 0xFFFC);
+    return 2;
+}
+
+/**
+ * Find non-overlapping idioms in a region, scanning forward and taking the
+ * first pattern that matches at each instruction
+ */
+static IdiomPlan recognize_ppc_idioms(const std::vector<uint32_t>& instructions) {
+    IdiomPlan plan;
+    static size_t (*const matchers[])(const std::vector<uint32_t>&, size_t, PpcIdiom&) = {
+        match_byte_swap, match_constant, match_rotate_mask, match_extend, match_compare_branch,
+    };
+    
+    for (size_t i = 0; i < instructions.size();) {
+        size_t length = 0;
+        PpcIdiom idiom;
+        for (auto match : matchers) {
+            idiom = PpcIdiom();
+            length = match(instructions, i, idiom);
+            if (length) break;
+        }
+        if (!length) {
+            i++;
+            continue;
+        }
+        idiom.length = static_cast<uint8_t>(length);
+        plan.counts[static_cast<size_t>(idiom.kind)]++;
+        plan.instructions_fused += static_cast<uint32_t>(length);
+        plan.at.emplace(i, idiom);
+        i += length;
+    }
+    return plan;
+}
+
+/**
+ * PPC idiom recognition statistics
+ */
+struct IdiomStats {
+    uint64_t regions = 0;                      // Regions with at least one idiom
+    uint64_t idioms[OC_PPU_IDIOM_COUNT] = {};
+    uint64_t instructions_fused = 0;
+};
+
+/**
+ * PPC idiom recognition pass state
+ *
+ * When disabled every instruction is emitted on its own.
+ */
+struct IdiomRecognizer {
+    std::atomic<bool> enabled{true};
+    IdiomStats stats;
+    mutable oc_mutex mutex;
+    
+    IdiomPlan plan(const std::vector<uint32_t>& instructions) {
+        IdiomPlan result = recognize_ppc_idioms(instructions);
+        if (result.at.empty()) return result;
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.regions++;
+        for (size_t k = 0; k < OC_PPU_IDIOM_COUNT; k++) stats.idioms[k] += result.counts[k];
+        stats.instructions_fused += result.instructions_fused;
+        return result;
+    }
+    
+    IdiomStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = IdiomStats();
+    }
+};
+
+// ============================================================================
+// Jump Table Recognition
+// ============================================================================
+
+/**
+ * Maximum number of cases accepted for a recovered jump table
+ */
+static constexpr size_t MAX_JUMP_TABLE_CASES = 1024;
+
+/**
+ * Maximum instructions between the bounds check branch and the bctr
+ */
+static constexpr size_t MAX_JUMP_TABLE_SEQUENCE = 8;
+
+/**
+ * Guest memory known not to change at runtime (read-only ELF segments)
+ */
+struct ReadOnlyMemoryMap {
+    struct Region {
+        uint32_t base;
+        std::vector<uint8_t> data;
+    };
+    
+    std::vector<Region> regions;
+    mutable oc_mutex mutex;
+    
+    void add(uint32_t base, const uint8_t* data, size_t size) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        regions.push_back({base, std::vector<uint8_t>(data, data + size)});
+    }
+    
+    // Read a big-endian word; fails unless all four bytes are in one region
+    bool read_u32(uint32_t address, uint32_t& value) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        for (const auto& region : regions) {
+            uint64_t offset = static_cast<uint64_t>(address) - region.base;
+            if (address < region.base || offset + 4 > region.data.size()) continue;
+            const uint8_t* p = region.data.data() + offset;
+            value = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+                    (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+            return true;
+        }
+        return false;
+    }
+    
+    size_t count() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return regions.size();
+    }
+    
+    void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        regions.clear();
+    }
+};
+
+/**
+ * Recognize a switch dispatch at the end of an instruction sequence
+ *
+ * Expected shape (register numbers and the base materialization vary):
+ *   cmplwi  crN, rI, MAX
+ *   bgt     crN, default        (or bge with MAX = case count)
+ *   lis     rB, table@ha
+ *   addi    rB, rB, table@l
+ *   slwi    rS, rI, 2
+ *   lwzx    rE, rB, rS
+ *   add     rT, rE, rB          (optional: relative tables)
+ *   mtctr   rT
+ *   bctr
+ * Only these instructions may appear after the bounds check, and the table
+ * must lie entirely in registered read-only memory.
+ */
+static bool recognize_jump_table(const std::vector<uint32_t>& instrs, uint32_t start_address,
+                                 const ReadOnlyMemoryMap& rodata, JumpTable& out) {
+    size_t n = instrs.size();
+    if (n < 4) return false;
+    
+    // Must end in an unconditional, non-linking bctr
+    uint32_t last = instrs[n - 1];
+    if (((last >> 26) & 0x3F) != 19 || ((last >> 1) & 0x3FF) != 528 ||
+        (last & 1) || (((last >> 21) & 0x14) != 0x14)) {
+        return false;
+    }
+    
+    // Find the bounds check: cmplwi followed by a conditional branch on its GT/LT bit
+    size_t g = n - 1;
+    while (g > 0 && ((instrs[g - 1] >> 26) & 0x3F) != 16) g--;
+    if (g < 2) return false;
+    g--;
+    uint32_t bc = instrs[g];
+    uint32_t cmp = instrs[g - 1];
+    if (((cmp >> 26) & 0x3F) != 10 || ((cmp >> 21) & 1)) return false;  // cmplwi, L=0
+    uint8_t crf = (cmp >> 23) & 7;
+    uint8_t index_reg = (cmp >> 16) & 0x1F;
+    uint32_t limit = cmp & 0xFFFF;
+    uint8_t bo = (bc >> 21) & 0x1F;
+    uint8_t bi = (bc >> 16) & 0x1F;
+    if (bc & 3) return false;  // No AA/LK
+    size_t count;
+    if (bo == 12 && bi == crf * 4 + 1) {
+        count = static_cast<size_t>(limit) + 1;  // bgt: cases 0..limit
+    } else if (bo == 4 && bi == crf * 4) {
+        count = limit;                           // bge: cases 0..limit-1
+    } else {
+        return false;
+    }
+    if (count == 0 || count > MAX_JUMP_TABLE_CASES) return false;
+    uint32_t default_target = start_address + static_cast<uint32_t>(g * 4) +
+                              static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(bc & 0xFFFC)));
+    
+    // Symbolically execute the dispatch sequence
+    enum class Kind : uint8_t { Unknown, Const, ScaledIndex, Entry, Target };
+    Kind kind[32];
+    uint32_t value[32];
+    for (int r = 0; r < 32; r++) kind[r] = Kind::Unknown;
+    uint32_t table = 0;
+    uint32_t rel_base = 0;
+    bool relative = false;
+    bool have_table = false;
+    uint8_t ctr_reg = 32;
+    
+    for (size_t i = g + 1; i < n - 1; i++) {
+        uint32_t instr = instrs[i];
+        uint8_t opcode = (instr >> 26) & 0x3F;
+        uint8_t rt = (instr >> 21) & 0x1F;
+        uint8_t ra = (instr >> 16) & 0x1F;
+        uint8_t rb = (instr >> 11) & 0x1F;
+        uint16_t uimm = instr & 0xFFFF;
+        int16_t simm = static_cast<int16_t>(uimm);
+        uint8_t dest;
+        
+        switch (opcode) {
+            case 14: case 15: { // addi, addis
+                uint32_t imm = opcode == 15 ? static_cast<uint32_t>(uimm) << 16
+                                            : static_cast<uint32_t>(static_cast<int32_t>(simm));
+                dest = rt;
+                if (ra == 0) {
+                    value[dest] = imm;
+                } else if (kind[ra] == Kind::Const) {
+                    value[dest] = value[ra] + imm;
+                } else {
+                    return false;
+                }
+                kind[dest] = Kind::Const;
+                break;
+            }
+            case 24: { // ori
+                dest = ra;
+                if (kind[rt] != Kind::Const) return false;
+                value[dest] = value[rt] | uimm;
+                kind[dest] = Kind::Const;
+                break;
+            }
+            case 21: { // rlwinm: only slwi rS, rI, 2
+                dest = ra;
+                uint8_t sh = rb;
+                uint8_t mb = (instr >> 6) & 0x1F;
+                uint8_t me = (instr >> 1) & 0x1F;
+                if (rt != index_reg || sh != 2 || mb != 0 || me != 29 || (instr & 1)) return false;
+                kind[dest] = Kind::ScaledIndex;
+                break;
+            }
+            case 31: {
+                uint16_t xo = (instr >> 1) & 0x3FF;
+                if (xo == 23) { // lwzx
+                    dest = rt;
+                    uint8_t base_reg;
+                    if (ra == 0 || have_table) return false;
+                    if (kind[ra] == Kind::Const && kind[rb] == Kind::ScaledIndex) {
+                        base_reg = ra;
+                    } else if (kind[rb] == Kind::Const && kind[ra] == Kind::ScaledIndex) {
+                        base_reg = rb;
+                    } else {
+                        return false;
+                    }
+                    table = value[base_reg];
+                    have_table = true;
+                    kind[dest] = Kind::Entry;
+                } else if (xo == 266 && !(instr & 1) && !((instr >> 10) & 1)) { // add
+                    dest = rt;
+                    if (kind[ra] == Kind::Entry && kind[rb] == Kind::Const) {
+                        rel_base = value[rb];
+                    } else if (kind[rb] == Kind::Entry && kind[ra] == Kind::Const) {
+                        rel_base = value[ra];
+                    } else {
+                        return false;
+                    }
+                    relative = true;
+                    kind[dest] = Kind::Target;
+                } else if (xo == 467 && ra == 9 && rb == 0) { // mtctr
+                    if (kind[rt] != Kind::Target && kind[rt] != Kind::Entry) return false;
+                    if (kind[rt] == Kind::Entry && relative) return false;
+                    ctr_reg = rt;
+                    dest = 32;
+                } else {
+                    return false;
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+        if (dest == index_reg) return false;  // Index clobbered before dispatch
+    }
+    if (!have_table || ctr_reg == 32) return false;
+    
+    // Read the table at compile time
+    std::vector<uint32_t> targets(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t entry;
+        if (!rodata.read_u32(table + static_cast<uint32_t>(i * 4), entry)) return false;
+        uint32_t target = relative ? rel_base + entry : entry;
+        if (target & 3) return false;
+        targets[i] = target;
+    }
+    
+    out.table_address = table;
+    out.default_target = default_target;
+    out.index_reg = index_reg;
+    out.guard_index = g;
+    out.targets = std::move(targets);
+    return true;
+}
+
+/**
+ * Jump table recognition statistics
+ */
+struct JumpTableStats {
+    uint64_t candidates = 0;        // Blocks ending in a bounds check branch
+    uint64_t tables_recognized = 0;
+    uint64_t cases_total = 0;
+};
+
+/**
+ * Jump table recognizer: extends blocks ending at a switch bounds check
+ * through the following bctr
+ */
+struct JumpTableRecognizer {
+    JumpTableStats stats;
+    mutable oc_mutex mutex;
+    
+    // Called after identify_basic_block. The block ends at the bounds check
+    // bc; if the dispatch sequence follows, it is pulled into the block and
+    // the recovered table is attached to it.
+    bool extend(BasicBlock* block, const uint8_t* code, size_t size,
+                const ReadOnlyMemoryMap& rodata) {
+        size_t n = block->instructions.size();
+        if (n < 2 || ((block->instructions[n - 1] >> 26) & 0x3F) != 16 ||
+            ((block->instructions[n - 2] >> 26) & 0x3F) != 10) {
+            return false;
+        }
+        if (rodata.count() == 0) return false;
+        
+        // The block may hold inlined code, so addresses are taken from its end
+        std::vector<uint32_t> candidate = block->instructions;
+        size_t offset = block->end_address - block->start_address;
+        uint32_t base_address = block->end_address - static_cast<uint32_t>(n * 4);
+        bool found_bctr = false;
+        for (size_t k = 0; k < MAX_JUMP_TABLE_SEQUENCE && offset + 4 <= size; k++, offset += 4) {
+            uint32_t instr;
+            memcpy(&instr, code + offset, 4);
+            instr = __builtin_bswap32(instr);
+            candidate.push_back(instr);
+            uint8_t opcode = (instr >> 26) & 0x3F;
+            if (opcode == 19 && ((instr >> 1) & 0x3FF) == 528) {
+                found_bctr = true;
+                break;
+            }
+            if (opcode == 16 || opcode == 17 || opcode == 18 || opcode == 19) break;
+        }
+        
+        {
+            oc_lock_guard<oc_mutex> lock(mutex);
+            stats.candidates++;
+        }
+        if (!found_bctr) return false;
+        
+        JumpTable table;
+        if (!recognize_jump_table(candidate, base_address, rodata, table)) return false;
+        
+        {
+            oc_lock_guard<oc_mutex> lock(mutex);
+            stats.tables_recognized++;
+            stats.cases_total += table.targets.size();
+        }
+        block->end_address += static_cast<uint32_t>((candidate.size() - n) * 4);
+        block->instructions = std::move(candidate);
+        block->jump_table = std::move(table);
+        return true;
+    }
+    
+    JumpTableStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = JumpTableStats();
+    }
+};
+
+// ============================================================================
+// Leaf Function Inlining
+// ============================================================================
+
+/**
+ * Default maximum callee size (instructions, excluding blr) for inlining
+ */
+static constexpr size_t DEFAULT_MAX_INLINE_INSTRUCTIONS = 16;
+
+/**
+ * Maximum number of calls inlined into one region
+ */
+static constexpr size_t MAX_INLINED_CALLS_PER_REGION = 4;
+
+/**
+ * Leaf inlining statistics
+ */
+struct LeafInlineStats {
+    uint64_t calls_inlined = 0;
+    uint64_t instructions_inlined = 0;
+    uint64_t calls_rejected = 0;     // bl seen but callee not inlinable
+};
+
+/**
+ * Check whether a callee instruction may be inlined into a leaf body:
+ * no control flow, no traps and no writes to LR (blr must return to the
+ * instruction after the bl)
+ */
+static bool is_inlinable_leaf_instruction(uint32_t instr) {
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    switch (opcode) {
+        case 2: case 3:                       // tdi, twi
+        case 16: case 17: case 18: case 19:   // Branches, sc, rfid/isync/CR ops
+            return false;
+        case 31: {
+            uint16_t xo = (instr >> 1) & 0x3FF;
+            uint8_t spr_lo = (instr >> 16) & 0x1F;
+            uint8_t spr_hi = (instr >> 11) & 0x1F;
+            if (xo == 4 || xo == 68) return false;  // tw, td
+            if (xo == 467 && spr_lo == 8 && spr_hi == 0) return false;  // mtlr
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+/**
+ * Leaf inliner: replaces a region-ending bl with the body of its callee when
+ * the callee is a small leaf in read-only memory
+ */
+struct LeafInliner {
+    std::atomic<bool> enabled{true};
+    std::atomic<size_t> max_instructions{DEFAULT_MAX_INLINE_INSTRUCTIONS};
+    LeafInlineStats stats;
+    mutable oc_mutex mutex;
+    
+    // The bl itself stays in the block (it sets LR); the callee body follows
+    // it and the matching blr is dropped. On success the region can continue
+    // at the return address.
+    bool try_inline(BasicBlock* block, const ReadOnlyMemoryMap& rodata) {
+        if (!enabled.load(std::memory_order_relaxed) || block->instructions.empty()) {
+            return false;
+        }
+        uint32_t bl = block->instructions.back();
+        if (((bl >> 26) & 0x3F) != 18 || (bl & 3) != 1) return false;  // bl, not bla
+        
+        uint32_t call_address = block->end_address - 4;
+        int32_t li = ((int32_t)(bl & 0x03FFFFFC) << 6) >> 6;
+        uint32_t callee = call_address + static_cast<uint32_t>(li);
+        
+        std::vector<uint32_t> body;
+        size_t limit = max_instructions.load(std::memory_order_relaxed);
+        bool found_blr = false;
+        for (size_t i = 0; i <= limit; i++) {
+            uint32_t instr;
+            if (!rodata.read_u32(callee + static_cast<uint32_t>(i * 4), instr)) break;
+            if (instr == 0x4E800020) {  // blr
+                found_blr = true;
+                break;
+            }
+            if (!is_inlinable_leaf_instruction(instr)) break;
+            body.push_back(instr);
+        }
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (!found_blr) {
+            stats.calls_rejected++;
+            return false;
+        }
+        InlinedCall call;
+        call.first_index = block->instructions.size();
+        call.count = body.size();
+        call.callee_address = callee;
+        call.return_address = call_address + 4;
+        block->inlined_calls.push_back(call);
+        block->instructions.insert(block->instructions.end(), body.begin(), body.end());
+        stats.calls_inlined++;
+        stats.instructions_inlined += body.size();
+        return true;
+    }
+    
+    LeafInlineStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = LeafInlineStats();
+    }
+};
+
+// ============================================================================
+// Speculation and Deoptimization
+// ============================================================================
+
+/**
+ * Default number of failures of one guard before its speculation is dropped
+ */
+static constexpr uint32_t DEFAULT_DEOPT_THRESHOLD = 8;
+
+/**
+ * Most register constants speculated on at one region entry; each costs a
+ * context load and a compare
+ */
+static constexpr size_t MAX_REGISTER_GUARDS = 4;
+
+/**
+ * Speculation statistics
+ */
+struct SpeculationStats {
+    uint64_t guards = 0;                // Guards placed in regions
+    uint64_t deopts = 0;                // Side exits taken
+    uint64_t speculations_dropped = 0;  // Sites given up on after repeated failures
+};
+
+/**
+ * Chooses what a region speculates on and tracks how often each guard fails
+ *
+ * Speculation is decided at region formation from the profiles gathered so
+ * far: register values the constant propagation cache saw constant on block
+ * entry, and monomorphic BTB targets of a closing bctr. A site whose guard
+ * fails `threshold` times is dropped: the region is invalidated and the next
+ * compile leaves that speculation out.
+ */
+struct SpeculationManager {
+    std::atomic<bool> enabled{true};
+    std::atomic<uint32_t> threshold{DEFAULT_DEOPT_THRESHOLD};
+    std::unordered_map<uint64_t, uint32_t> failures;  // site -> guard failures
+    std::unordered_set<uint64_t> dropped;             // Sites compiled without speculation
+    SpeculationStats stats;
+    mutable oc_mutex mutex;
+    
+    // Register guards all sit at the region entry and are told apart by
+    // register; branch guards by their word-aligned PC. The kind goes in
+    // the low bits.
+    static uint64_t site_key(uint32_t region, const GuardSite& site) {
+        uint32_t where = site.kind == GuardKind::RegisterValue ? uint32_t(site.reg) << 2
+                                                               : site.guest_pc;
+        return (uint64_t(region) << 32) | where | static_cast<uint32_t>(site.kind);
+    }
+    
+    void speculate(BasicBlock* block, ConstantPropagationCache& constants,
+                   BranchTargetCache& btb) {
+        block->guards.clear();
+        if (!enabled.load(std::memory_order_relaxed) || block->instructions.empty()) return;
+        
+        std::vector<GuardSite> sites;
+        for (const auto& [reg, value] : constants.entry_constants(block->start_address)) {
+            if (sites.size() == MAX_REGISTER_GUARDS) break;
+            GuardSite site;
+            site.kind = GuardKind::RegisterValue;
+            site.reg = reg;
+            site.guest_pc = block->start_address;
+            site.expected = value;
+            sites.push_back(site);
+        }
+        
+        // bctr/bctrl fed by an mtctr in the region; switch dispatch is
+        // already resolved by the jump table
+        size_t last = block->instructions.size() - 1;
+        uint32_t bcctr = block->instructions[last];
+        bool sets_ctr = std::any_of(block->instructions.begin(), block->instructions.begin() + last,
+            [](uint32_t instr) {
+                return (instr & 0xFC1FFFFE) == 0x7C0903A6;  // mtctr rS
+            });
+        if ((bcctr & 0xFFFFFFFE) == 0x4E800420 && sets_ctr && !block->jump_table.valid()) {
+            uint32_t pc = block->address_of(last);
+            uint32_t target = btb.monomorphic_target(pc);
+            if (target) {
+                GuardSite site;
+                site.kind = GuardKind::BranchTarget;
+                site.index = static_cast<uint32_t>(last);
+                site.guest_pc = pc;
+                site.expected = target;
+                sites.push_back(site);
+            }
+        }
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        for (const auto& site : sites) {
+            if (dropped.count(site_key(block->start_address, site))) continue;
+            block->guards.push_back(site);
+        }
+        stats.guards += block->guards.size();
+    }
+    
+    // Returns true when the site has now failed often enough to be dropped
+    bool record_failure(uint32_t region, const GuardSite& site) {
+        uint64_t key = site_key(region, site);
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.deopts++;
+        if (++failures[key] < std::max(1u, threshold.load(std::memory_order_relaxed))) {
+            return false;
+        }
+        failures.erase(key);
+        if (dropped.insert(key).second) stats.speculations_dropped++;
+        return true;
+    }
+    
+    SpeculationStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = SpeculationStats();
+    }
+};
+
+// ============================================================================
+// On-Stack Replacement
+// ============================================================================
+
+/**
+ * Index of the region instruction at guest PC target, outside any inlined
+ * call; SIZE_MAX if there is none
+ */
+static size_t loop_header_index(const BasicBlock* block, uint32_t target) {
+    for (size_t i = 0; i < block->instructions.size(); i++) {
+        bool inlined = std::any_of(block->inlined_calls.begin(), block->inlined_calls.end(),
+            [i](const InlinedCall& call) {
+                return i >= call.first_index && i < call.first_index + call.count;
+            });
+        if (!inlined && block->address_of(i) == target) return i;
+    }
+    return SIZE_MAX;
+}
+
+/**
+ * Guest PC of the loop header a region's closing branch returns to: a
+ * relative bc without link whose target is an instruction of the region.
+ * Returns 0 if the region does not end in a loop.
+ */
+static uint32_t find_loop_header(const BasicBlock* block) {
+    if (block->instructions.empty()) return 0;
+    size_t last = block->instructions.size() - 1;
+    uint32_t bc = block->instructions[last];
+    if (((bc >> 26) & 0x3F) != 16 || (bc & 3) != 0) return 0;
+
+    uint32_t target = block->address_of(last) + static_cast<int16_t>(bc & 0xFFFC);
+    return loop_header_index(block, target) != SIZE_MAX ? target : 0;
+}
+
+/**
+ * On-stack replacement statistics
+ */
+struct OsrStats {
+    uint64_t loop_regions = 0;      // Regions compiled with a back-edge upgrade check
+    uint64_t upgrades = 0;          // Tier-2 loops published to their region
+    uint64_t upgrade_failures = 0;  // Tier-2 loops that failed to compile
+};
+
+/**
+ * Moves hot loops from tier-1 to tier-2 code without leaving them
+ *
+ * A region ending in a back-edge is compiled at tier 1 with a check of its
+ * upgrade slot after the branch. Once the region is promoted, its tier-2
+ * loop is compiled with an entry at the loop header that takes the guest
+ * state from the context, and published to the slot; the next taken
+ * back-edge stores the state tier 1 changed and tail-calls into it. The
+ * tier-2 loop then iterates without returning to the dispatcher until the
+ * loop exits or it is preempted. With the budget disabled only an interrupt
+ * would preempt it, so it also returns at the loop header every
+ * UNBUDGETED_ITERATIONS iterations.
+ *
+ * The dispatcher promotes a region itself once UPGRADE_BACK_EDGES of its
+ * runs have ended on the back-edge.
+ */
+struct OsrManager {
+    static constexpr uint32_t UPGRADE_BACK_EDGES = 1000;
+    static constexpr uint32_t UNBUDGETED_ITERATIONS = 1u << 16;
+    
+    std::atomic<bool> enabled{true};
+    OsrStats stats;
+    mutable oc_mutex mutex;
+
+    void plan(BasicBlock* block) {
+        block->loop_header = enabled.load(std::memory_order_relaxed) ? find_loop_header(block) : 0;
+        if (!block->loop_header) return;
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.loop_regions++;
+    }
+
+    void record_upgrade(bool compiled) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (compiled) stats.upgrades++;
+        else stats.upgrade_failures++;
+    }
+
+    OsrStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = OsrStats();
+    }
+};
+
+/**
+ * Lazy compilation state
+ */
+enum class LazyState : uint8_t {
+    NotCompiled = 0,
+    Pending = 1,
+    Compiling = 2,
+    Compiled = 3,
+    Failed = 4
+};
+
+/**
+ * Lazy compilation entry
+ */
+struct LazyCompilationEntry {
+    uint32_t address;
+    const uint8_t* code;
+    size_t size;
+    LazyState state;
+    std::atomic<uint32_t> execution_count;
+    uint32_t threshold;  // Compile after this many executions
+    
+    LazyCompilationEntry()
+        : address(0), code(nullptr), size(0), state(LazyState::NotCompiled),
+          execution_count(0), threshold(10) {}
+    
+    LazyCompilationEntry(uint32_t addr, const uint8_t* c, size_t s, uint32_t thresh = 10)
+        : address(addr), code(c), size(s), state(LazyState::NotCompiled),
+          execution_count(0), threshold(thresh) {}
+    
+    // Move constructor
+    LazyCompilationEntry(LazyCompilationEntry&& other) noexcept
+        : address(other.address), code(other.code), size(other.size),
+          state(other.state), execution_count(other.execution_count.load()),
+          threshold(other.threshold) {}
+    
+    // Move assignment
+    LazyCompilationEntry& operator=(LazyCompilationEntry&& other) noexcept {
+        if (this != &other) {
+            address = other.address;
+            code = other.code;
+            size = other.size;
+            state = other.state;
+            execution_count.store(other.execution_count.load());
+            threshold = other.threshold;
+        }
+        return *this;
+    }
+    
+    // Delete copy operations
+    LazyCompilationEntry(const LazyCompilationEntry&) = delete;
+    LazyCompilationEntry& operator=(const LazyCompilationEntry&) = delete;
+    
+    bool should_compile() {
+        return execution_count.fetch_add(1) + 1 >= threshold;
+    }
+};
+
+/**
+ * Lazy compilation manager
+ */
+struct LazyCompilationManager {
+    std::unordered_map<uint32_t, std::unique_ptr<LazyCompilationEntry>> entries;
+    oc_mutex mutex;
+    
+    void register_lazy(uint32_t address, const uint8_t* code, size_t size, uint32_t threshold = 10) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        entries[address] = std::make_unique<LazyCompilationEntry>(address, code, size, threshold);
+    }
+    
+    LazyCompilationEntry* get_entry(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto it = entries.find(address);
+        return (it != entries.end()) ? it->second.get() : nullptr;
+    }
+    
+    void mark_compiling(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto it = entries.find(address);
+        if (it != entries.end()) {
+            it->second->state = LazyState::Compiling;
+        }
+    }
+    
+    void mark_compiled(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto it = entries.find(address);
+        if (it != entries.end()) {
+            it->second->state = LazyState::Compiled;
+        }
+    }
+    
+    void mark_failed(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto it = entries.find(address);
+        if (it != entries.end()) {
+            it->second->state = LazyState::Failed;
+        }
+    }
+    
+    void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        entries.clear();
+    }
+};
+
+/**
+ * Lazy compilation statistics
+ */
+struct LazyCompilationStats {
+    uint64_t total_registered;       // Total functions registered for lazy compilation
+    uint64_t total_compiled;         // Total functions compiled
+    uint64_t total_failed;           // Total compilation failures
+    uint64_t total_executions;       // Total execution count across all entries
+    uint64_t hot_path_promotions;    // Times a function was promoted to hot status
+    uint64_t stub_calls;             // Times interpreter stub was called
+    
+    LazyCompilationStats()
+        : total_registered(0), total_compiled(0), total_failed(0),
+          total_executions(0), hot_path_promotions(0), stub_calls(0) {}
+};
+
+/**
+ * Hot path entry for prioritization
+ */
+struct HotPathEntry {
+    uint32_t address;
+    uint32_t execution_count;
+    bool is_compiled;
+    
+    HotPathEntry() : address(0), execution_count(0), is_compiled(false) {}
+    HotPathEntry(uint32_t addr, uint32_t count, bool compiled)
+        : address(addr), execution_count(count), is_compiled(compiled) {}
+    
+    // Higher execution count = higher priority
+    bool operator<(const HotPathEntry& other) const {
+        return execution_count < other.execution_count;
+    }
+};
+
+/**
+ * Interpreter stub callback type
+ * Called when uncompiled code is executed
+ * Returns: 0 = continue with interpreter, 1 = code is now compiled
+ */
+using InterpreterStubCallback = int (*)(uint32_t address, void* user_data);
+
+/**
+ * Enhanced lazy compilation manager with hot path detection and stub support
+ */
+struct EnhancedLazyCompilationManager {
+    std::unordered_map<uint32_t, std::unique_ptr<LazyCompilationEntry>> entries;
+    std::priority_queue<HotPathEntry> hot_queue;  // Priority queue for hot paths
+    mutable oc_mutex mutex;  // mutable to allow locking in const methods
+    
+    uint32_t default_threshold;          // Default compilation threshold
+    uint32_t hot_threshold;              // Threshold to consider a path "hot"
+    InterpreterStubCallback stub_callback;
     void* stub_user_data;
     LazyCompilationStats stats;
     
@@ -2972,6 +5279,18 @@ struct EnhancedLazyCompilationManager {
         return result;
     }
     
+    // Add execution counts to a warm start profile
+    void export_warm_start(WarmStartMap& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        for (const auto& pair : entries) {
+            uint64_t count = pair.second->execution_count.load();
+            if (count == 0) continue;
+            auto& entry = out[pair.first];
+            entry.address = pair.first;
+            entry.execution_count = std::max(entry.execution_count, count);
+        }
+    }
+    
     // Get pending compilation count
     size_t get_pending_count() const {
         oc_lock_guard<oc_mutex> lock(mutex);
@@ -3385,6 +5704,20 @@ struct TieredCompilationManager {
         return (it != entries.end()) ? it->second->execution_count.load() : 0;
     }
     
+    // Add tiers reached and execution counts to a warm start profile
+    void export_warm_start(WarmStartMap& out) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        for (const auto& pair : entries) {
+            uint8_t tier = static_cast<uint8_t>(pair.second->get_tier());
+            uint64_t count = pair.second->execution_count.load();
+            if (tier == 0 && count == 0) continue;
+            auto& entry = out[pair.first];
+            entry.address = pair.first;
+            entry.execution_count = std::max(entry.execution_count, count);
+            entry.tier = std::max(entry.tier, tier);
+        }
+    }
+    
     // Get count of entries at each tier
     void get_tier_counts(size_t* tier0, size_t* tier1, size_t* tier2) const {
         oc_lock_guard<oc_mutex> lock(mutex);
@@ -3422,6 +5755,189 @@ struct TieredCompilationManager {
     }
 };
 
+// ============================================================================
+// Profile-Guided Warm Start
+// ============================================================================
+
+/**
+ * Serialized warm start profile layout (little-endian):
+ *   header: magic "OCWS", version, entry count (u32 each)
+ *   entry:  address u32, trace length u32, execution count u64,
+ *           tier u8, reserved u8[3], back-edge target u32,
+ *           trace block addresses u32[trace length]
+ * Entries are stored hottest first.
+ */
+static constexpr uint32_t WARM_START_MAGIC = 0x5357434F;  // "OCWS"
+static constexpr uint32_t WARM_START_VERSION = 1;
+static constexpr size_t WARM_START_HEADER_SIZE = 12;
+static constexpr size_t WARM_START_ENTRY_SIZE = 24;
+static constexpr size_t MAX_WARM_START_TRACE = 256;
+
+/**
+ * Bytes of guest code handed to the compiler per seed (64 instructions,
+ * the same window the interpreter uses for block reads)
+ */
+static constexpr size_t WARM_START_CODE_WINDOW = 256;
+
+/**
+ * Warm start statistics
+ */
+struct WarmStartStats {
+    uint64_t entries_exported = 0;
+    uint64_t entries_imported = 0;
+    uint64_t seeds_submitted = 0;
+};
+
+/**
+ * Warm start profile: serializes what the profilers learned during a run and
+ * hands it back, hottest first, to the compile scheduler on the next boot
+ */
+struct WarmStartProfile {
+    std::vector<WarmStartEntry> seeds;  // Sorted by execution count, descending
+    size_t next_seed = 0;
+    WarmStartStats stats;
+    std::unordered_set<uint32_t> optimizing;    // Tier-2 seeds whose compile is not cached yet
+    std::atomic<size_t> optimizing_pending{0};  // Size of optimizing, read without the lock
+    mutable oc_mutex mutex;
+    
+    static void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+    
+    static void put_u64(std::vector<uint8_t>& out, uint64_t value) {
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+    
+    static uint32_t get_u32(const uint8_t* p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+    
+    static uint64_t get_u64(const uint8_t* p) {
+        return uint64_t(get_u32(p)) | (uint64_t(get_u32(p + 4)) << 32);
+    }
+    
+    static void sort_hottest_first(std::vector<WarmStartEntry>& entries) {
+        std::sort(entries.begin(), entries.end(),
+                  [](const WarmStartEntry& a, const WarmStartEntry& b) {
+                      if (a.execution_count != b.execution_count) {
+                          return a.execution_count > b.execution_count;
+                      }
+                      return a.tier > b.tier;
+                  });
+    }
+    
+    // Serialize collected entries, keeping the hottest max_entries (0 = all)
+    std::vector<uint8_t> serialize(const WarmStartMap& collected, size_t max_entries) {
+        std::vector<WarmStartEntry> entries;
+        entries.reserve(collected.size());
+        for (const auto& pair : collected) entries.push_back(pair.second);
+        sort_hottest_first(entries);
+        if (max_entries != 0 && entries.size() > max_entries) entries.resize(max_entries);
+        
+        std::vector<uint8_t> out;
+        put_u32(out, WARM_START_MAGIC);
+        put_u32(out, WARM_START_VERSION);
+        put_u32(out, static_cast<uint32_t>(entries.size()));
+        for (const auto& entry : entries) {
+            size_t trace_len = std::min(entry.trace.size(), MAX_WARM_START_TRACE);
+            put_u32(out, entry.address);
+            put_u32(out, static_cast<uint32_t>(trace_len));
+            put_u64(out, entry.execution_count);
+            out.push_back(entry.tier);
+            out.insert(out.end(), 3, 0);
+            put_u32(out, entry.back_edge_target);
+            for (size_t i = 0; i < trace_len; i++) put_u32(out, entry.trace[i]);
+        }
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.entries_exported += entries.size();
+        return out;
+    }
+    
+    // Replace the seed list with a serialized profile
+    // Returns: entries loaded, -2 on bad magic/version, -3 if truncated
+    int deserialize(const uint8_t* data, size_t size) {
+        if (size < WARM_START_HEADER_SIZE) return -3;
+        if (get_u32(data) != WARM_START_MAGIC || get_u32(data + 4) != WARM_START_VERSION) {
+            return -2;
+        }
+        uint32_t count = get_u32(data + 8);
+        
+        std::vector<WarmStartEntry> entries;
+        size_t offset = WARM_START_HEADER_SIZE;
+        for (uint32_t i = 0; i < count; i++) {
+            if (size - offset < WARM_START_ENTRY_SIZE) return -3;
+            const uint8_t* p = data + offset;
+            WarmStartEntry entry;
+            entry.address = get_u32(p);
+            uint32_t trace_len = get_u32(p + 4);
+            entry.execution_count = get_u64(p + 8);
+            entry.tier = std::min<uint8_t>(p[16], static_cast<uint8_t>(CompilationTier::Optimizing));
+            entry.back_edge_target = get_u32(p + 20);
+            offset += WARM_START_ENTRY_SIZE;
+            
+            if (trace_len > MAX_WARM_START_TRACE || (size - offset) / 4 < trace_len) return -3;
+            for (uint32_t t = 0; t < trace_len; t++) {
+                entry.trace.push_back(get_u32(data + offset + t * 4));
+            }
+            offset += static_cast<size_t>(trace_len) * 4;
+            entries.push_back(std::move(entry));
+        }
+        sort_hottest_first(entries);
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        seeds = std::move(entries);
+        next_seed = 0;
+        stats.entries_imported += seeds.size();
+        return static_cast<int>(seeds.size());
+    }
+    
+    // Pop the hottest seed not yet handed out
+    bool next(WarmStartEntry& out) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (next_seed >= seeds.size()) return false;
+        out = seeds[next_seed++];
+        stats.seeds_submitted++;
+        return true;
+    }
+    
+    size_t pending() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return seeds.size() - next_seed;
+    }
+    
+    // Note a seed to be upgraded to tier 2 once its compile is cached
+    void expect_optimizing(uint32_t address) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (optimizing.insert(address).second) {
+            optimizing_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    // Returns true once for an address passed to expect_optimizing
+    bool take_optimizing(uint32_t address) {
+        if (optimizing_pending.load(std::memory_order_relaxed) == 0) return false;
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (!optimizing.erase(address)) return false;
+        optimizing_pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    WarmStartStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void clear() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        seeds.clear();
+        next_seed = 0;
+        optimizing.clear();
+        optimizing_pending.store(0, std::memory_order_relaxed);
+        stats = WarmStartStats();
+    }
+};
+
 /**
  * Compilation task for multi-threaded compilation
  */
@@ -3494,117 +6010,110 @@ struct EnhancedCompilationTask {
 
 /**
  * Enhanced multi-threaded compilation thread pool with statistics
+ *
+ * Runs on the runtime-wide job system rather than owning threads: tasks are
+ * kept in this pool's priority queue, and up to `max_concurrency` drain jobs
+ * on oc_jobs() pop and compile them one task per job.
  */
 struct EnhancedCompilationThreadPool {
-    std::vector<oc_thread> workers;
     std::priority_queue<EnhancedCompilationTask> task_queue;
     mutable oc_mutex queue_mutex;
-    oc_condition_variable condition;
     oc_condition_variable all_done_condition;  // For waiting until all tasks complete
     std::atomic<bool> stop_flag;
     std::atomic<bool> drain_flag;              // If true, finish remaining tasks before shutdown
     std::atomic<size_t> pending_tasks;
     std::atomic<size_t> completed_tasks;
-    std::atomic<size_t> active_workers;        // Workers currently processing tasks
+    std::atomic<size_t> active_workers;        // Tasks currently being compiled
+    size_t max_concurrency;                    // Drain jobs allowed in flight
+    size_t drainers;                           // Drain jobs in flight (guarded by queue_mutex)
+    bool started;
     std::function<bool(const EnhancedCompilationTask&)> compile_func;  // Returns true on success
     ThreadPoolStats stats;
     
     EnhancedCompilationThreadPool() 
         : stop_flag(false), drain_flag(false), pending_tasks(0), 
-          completed_tasks(0), active_workers(0) {}
+          completed_tasks(0), active_workers(0), max_concurrency(0), drainers(0),
+          started(false) {}
     
     ~EnhancedCompilationThreadPool() {
         shutdown(false);
     }
     
-    // Start thread pool with specified number of workers
+    // Start the pool with up to num_threads concurrent compilations
     void start(size_t num_threads, std::function<bool(const EnhancedCompilationTask&)> func) {
+        oc_lock_guard<oc_mutex> lock(queue_mutex);
         compile_func = std::move(func);
         stop_flag = false;
         drain_flag = false;
-        
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers.emplace_back([this, i] {
-                worker_thread(i);
-            });
-        }
+        max_concurrency = num_threads;
+        started = true;
     }
     
-    // Worker thread function
-    void worker_thread(size_t /* worker_id */) {
-        while (true) {
-            EnhancedCompilationTask task;
-            {
-                oc_unique_lock<oc_mutex> lock(queue_mutex);
-                condition.wait(lock, [this] {
-                    return stop_flag.load() || !task_queue.empty();
-                });
-                
-                // Check if we should exit
-                if (stop_flag.load()) {
-                    // If draining, only exit when queue is empty
-                    if (drain_flag.load()) {
-                        if (task_queue.empty()) {
-                            return;
-                        }
-                    } else {
-                        // Immediate shutdown, exit even if tasks remain
-                        return;
-                    }
-                }
-                
-                if (task_queue.empty()) {
-                    continue;
-                }
-                
-                task = task_queue.top();
-                task_queue.pop();
+    // Compile one queued task, then requeue this drain job if work remains
+    void drain_one() {
+        EnhancedCompilationTask task;
+        {
+            oc_lock_guard<oc_mutex> lock(queue_mutex);
+            if (task_queue.empty() || (stop_flag.load() && !drain_flag.load())) {
+                drainers--;
+                all_done_condition.notify_all();
+                return;
             }
-            
+            task = task_queue.top();
+            task_queue.pop();
             active_workers.fetch_add(1);
-            
-            // Track wait time
-            uint64_t wait_time = task.get_wait_time_ms();
-            
-            // Execute task
-            auto exec_start = std::chrono::steady_clock::now();
-            bool success = true;
-            if (compile_func) {
-                success = compile_func(task);
+        }
+        
+        // Track wait time
+        uint64_t wait_time = task.get_wait_time_ms();
+        
+        // Execute task
+        auto exec_start = std::chrono::steady_clock::now();
+        bool success = true;
+        if (compile_func) {
+            success = compile_func(task);
+        }
+        auto exec_end = std::chrono::steady_clock::now();
+        
+        uint64_t exec_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            exec_end - exec_start).count();
+        
+        // Update counters and stats
+        bool again;
+        {
+            oc_lock_guard<oc_mutex> lock(queue_mutex);
+            stats.total_wait_time_ms += wait_time;
+            stats.total_exec_time_ms += exec_time;
+            if (success) {
+                stats.total_tasks_completed++;
+            } else {
+                stats.total_tasks_failed++;
             }
-            auto exec_end = std::chrono::steady_clock::now();
             
-            uint64_t exec_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                exec_end - exec_start).count();
+            // Update counters while holding lock
+            pending_tasks.fetch_sub(1);
+            completed_tasks.fetch_add(1);
+            active_workers.fetch_sub(1);
             
-            // Update counters and stats
-            {
-                oc_lock_guard<oc_mutex> lock(queue_mutex);
-                stats.total_wait_time_ms += wait_time;
-                stats.total_exec_time_ms += exec_time;
-                if (success) {
-                    stats.total_tasks_completed++;
-                } else {
-                    stats.total_tasks_failed++;
-                }
-                
-                // Update counters while holding lock
-                pending_tasks.fetch_sub(1);
-                completed_tasks.fetch_add(1);
-                active_workers.fetch_sub(1);
-                
-                // Check and notify if all tasks done (inside lock to avoid race)
-                if (pending_tasks.load() == 0 && active_workers.load() == 0) {
-                    all_done_condition.notify_all();
-                }
-            }
+            again = !task_queue.empty() && !(stop_flag.load() && !drain_flag.load());
+            if (!again) drainers--;
+            
+            // Notify waiters (inside lock to avoid race)
+            all_done_condition.notify_all();
+        }
+        
+        // One task per job keeps higher job lanes responsive between compiles
+        if (again) {
+            oc_jobs().submit([this] { drain_one(); }, oc_job_lane::Normal);
         }
     }
     
     // Submit a compilation task
     void submit(uint32_t address, const uint8_t* code, size_t size, int priority = 0) {
+        bool spawn = false;
         {
             oc_lock_guard<oc_mutex> lock(queue_mutex);
+            if (!started || stop_flag.load()) return;
             task_queue.emplace(address, code, size, priority);
             pending_tasks.fetch_add(1);
             stats.total_tasks_submitted++;
@@ -3614,8 +6123,15 @@ struct EnhancedCompilationThreadPool {
             if (current_size > stats.peak_queue_size) {
                 stats.peak_queue_size = current_size;
             }
+            
+            if (drainers < max_concurrency) {
+                drainers++;
+                spawn = true;
+            }
+        }
+        if (spawn) {
+            oc_jobs().submit([this] { drain_one(); }, oc_job_lane::Normal);
         }
-        condition.notify_one();
     }
     
     // Wait for all pending tasks to complete
@@ -3640,19 +6156,23 @@ struct EnhancedCompilationThreadPool {
         }
     }
     
-    // Shutdown the thread pool
+    // Shutdown the pool
     // If drain is true, finish all remaining tasks before stopping
     void shutdown(bool drain = true) {
-        drain_flag = drain;
-        stop_flag = true;
-        condition.notify_all();
-        
-        for (auto& worker : workers) {
-            if (worker.joinable()) {
-                worker.join();
-            }
+        {
+            oc_lock_guard<oc_mutex> lock(queue_mutex);
+            if (!started) return;
+            drain_flag = drain;
+            stop_flag = true;
+        }
+        if (!drain) {
+            cancel_all();
         }
-        workers.clear();
+        
+        // Drain jobs reference this pool; wait for them to finish
+        oc_unique_lock<oc_mutex> lock(queue_mutex);
+        all_done_condition.wait(lock, [this] { return drainers == 0; });
+        started = false;
     }
     
     // Cancel all pending tasks (only queue tasks, not active ones)
@@ -3666,13 +6186,15 @@ struct EnhancedCompilationThreadPool {
         // Only decrement by cancelled count, not set to 0
         // Active workers still have pending work
         pending_tasks.fetch_sub(cancelled);
+        all_done_condition.notify_all();
         
         return cancelled;
     }
     
-    // Get thread count
+    // Get the concurrency limit
     size_t get_thread_count() const {
-        return workers.size();
+        oc_lock_guard<oc_mutex> lock(queue_mutex);
+        return started ? max_concurrency : 0;
     }
     
     // Get active worker count
@@ -3692,7 +6214,8 @@ struct EnhancedCompilationThreadPool {
     
     // Check if running
     bool is_running() const { 
-        return !workers.empty() && !stop_flag.load(); 
+        oc_lock_guard<oc_mutex> lock(queue_mutex);
+        return started && !stop_flag.load(); 
     }
     
     // Get statistics
@@ -3710,77 +6233,101 @@ struct EnhancedCompilationThreadPool {
 
 /**
  * Multi-threaded compilation thread pool
+ *
+ * Like EnhancedCompilationThreadPool, schedules its priority queue onto the
+ * runtime-wide job system with at most `max_concurrency` tasks in flight.
  */
 struct CompilationThreadPool {
-    std::vector<oc_thread> workers;
     std::priority_queue<CompilationTask> task_queue;
-    oc_mutex queue_mutex;
-    oc_condition_variable condition;
+    mutable oc_mutex queue_mutex;
+    oc_condition_variable idle_condition;
     std::atomic<bool> stop_flag;
     std::atomic<size_t> pending_tasks;
     std::atomic<size_t> completed_tasks;
+    size_t max_concurrency;
+    size_t drainers;   // Guarded by queue_mutex
+    bool started;
     std::function<void(const CompilationTask&)> compile_func;
     
-    CompilationThreadPool() : stop_flag(false), pending_tasks(0), completed_tasks(0) {}
+    CompilationThreadPool()
+        : stop_flag(false), pending_tasks(0), completed_tasks(0),
+          max_concurrency(0), drainers(0), started(false) {}
     
     ~CompilationThreadPool() {
         shutdown();
     }
     
     void start(size_t num_threads, std::function<void(const CompilationTask&)> func) {
+        oc_lock_guard<oc_mutex> lock(queue_mutex);
         compile_func = std::move(func);
         stop_flag = false;
+        max_concurrency = num_threads;
+        started = true;
+    }
+    
+    void drain_one() {
+        CompilationTask task;
+        {
+            oc_lock_guard<oc_mutex> lock(queue_mutex);
+            if (task_queue.empty()) {
+                drainers--;
+                idle_condition.notify_all();
+                return;
+            }
+            task = task_queue.top();
+            task_queue.pop();
+        }
         
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers.emplace_back([this] {
-                while (true) {
-                    CompilationTask task;
-                    {
-                        oc_unique_lock<oc_mutex> lock(queue_mutex);
-                        condition.wait(lock, [this] {
-                            return stop_flag.load() || !task_queue.empty();
-                        });
-                        
-                        if (stop_flag && task_queue.empty()) {
-                            return;
-                        }
-                        
-                        task = task_queue.top();
-                        task_queue.pop();
-                    }
-                    
-                    compile_func(task);
-                    pending_tasks--;
-                    completed_tasks++;
-                }
-            });
+        compile_func(task);
+        pending_tasks--;
+        completed_tasks++;
+        
+        bool again;
+        {
+            oc_lock_guard<oc_mutex> lock(queue_mutex);
+            again = !task_queue.empty();
+            if (!again) {
+                drainers--;
+                idle_condition.notify_all();
+            }
+        }
+        if (again) {
+            oc_jobs().submit([this] { drain_one(); }, oc_job_lane::Normal);
         }
     }
     
     void submit(const CompilationTask& task) {
+        bool spawn = false;
         {
             oc_lock_guard<oc_mutex> lock(queue_mutex);
+            if (!started || stop_flag.load()) return;
             task_queue.push(task);
             pending_tasks++;
+            if (drainers < max_concurrency) {
+                drainers++;
+                spawn = true;
+            }
+        }
+        if (spawn) {
+            oc_jobs().submit([this] { drain_one(); }, oc_job_lane::Normal);
         }
-        condition.notify_one();
     }
     
+    // Stop accepting tasks and finish the queued ones
     void shutdown() {
+        oc_unique_lock<oc_mutex> lock(queue_mutex);
+        if (!started) return;
         stop_flag = true;
-        condition.notify_all();
-        
-        for (auto& worker : workers) {
-            if (worker.joinable()) {
-                worker.join();
-            }
-        }
-        workers.clear();
+        idle_condition.wait(lock, [this] { return drainers == 0; });
+        started = false;
     }
     
     size_t get_pending_count() const { return pending_tasks; }
     size_t get_completed_count() const { return completed_tasks; }
-    bool is_running() const { return !workers.empty() && !stop_flag; }
+    bool is_running() const {
+        oc_lock_guard<oc_mutex> lock(queue_mutex);
+        return started && !stop_flag;
+    }
 };
 
 // ============================================================================
@@ -4113,6 +6660,16 @@ public:
     std::string last_error;
     bool initialized;
     
+    /**
+     * Machine code of one function, measured from its object before linking
+     */
+    struct EmittedCode {
+        uint64_t bytes = 0;
+        uint64_t instructions = 0;
+    };
+    std::unique_ptr<llvm::MCContext> mc_context;
+    std::unique_ptr<llvm::MCDisassembler> disassembler;
+    
     // CPU feature flags detected at runtime
     bool has_avx2;
     bool has_avx512;
@@ -4156,9 +6713,116 @@ public:
         jit = std::move(*jit_expected);
         initialized = true;
         
+        setup_code_measurement();
+        
         return JitResult();
     }
     
+    /**
+     * Measure every object ORC links, so blocks report the code they really
+     * occupy rather than an estimate. Without a disassembler for the host
+     * only byte sizes are recorded.
+     */
+    void setup_code_measurement() {
+        llvm::InitializeNativeTargetDisassembler();
+        const llvm::MCSubtargetInfo* sti = target_machine->getMCSubtargetInfo();
+        mc_context = std::make_unique<llvm::MCContext>(
+            target_machine->getTargetTriple(), target_machine->getMCAsmInfo(),
+            target_machine->getMCRegisterInfo(), sti);
+        disassembler.reset(target_machine->getTarget().createMCDisassembler(*sti, *mc_context));
+        
+        jit->getObjTransformLayer().setTransform(
+            [this](std::unique_ptr<llvm::MemoryBuffer> object)
+                -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+                measure_object(*object);
+                return object;
+            });
+    }
+    
+    uint64_t count_instructions(llvm::ArrayRef<uint8_t> code) const {
+        if (!disassembler) return 0;
+        uint64_t count = 0;
+        uint64_t offset = 0;
+        while (offset < code.size()) {
+            llvm::MCInst inst;
+            uint64_t size = 0;
+            auto status = disassembler->getInstruction(inst, size, code.slice(offset),
+                                                       offset, llvm::nulls());
+            if (status == llvm::MCDisassembler::Success && size > 0) {
+                count++;
+            } else {
+                size = 1;  // Padding or data; resync on the next byte
+            }
+            offset += size;
+        }
+        return count;
+    }
+    
+    /**
+     * Functions of the last object this thread linked, until taken
+     *
+     * Compilation runs in the thread that looks a symbol up, so the take
+     * after a lookup finds its function here. Whatever is not taken (OSR
+     * entries, failed lookups) is dropped when the thread links its next
+     * object instead of accumulating.
+     */
+    static std::unordered_map<std::string, EmittedCode>& linked_code() {
+        thread_local std::unordered_map<std::string, EmittedCode> code;
+        return code;
+    }
+    
+    void measure_object(const llvm::MemoryBuffer& object) {
+        auto& linked = linked_code();
+        linked.clear();
+        auto file = llvm::object::ObjectFile::createObjectFile(object.getMemBufferRef());
+        if (!file) {
+            llvm::consumeError(file.takeError());
+            return;
+        }
+        
+        for (const auto& [symbol, size] : llvm::object::computeSymbolSizes(**file)) {
+            auto type = symbol.getType();
+            auto name = symbol.getName();
+            auto section = symbol.getSection();
+            auto address = symbol.getAddress();
+            if (!type || !name || !section || !address ||
+                *type != llvm::object::SymbolRef::ST_Function ||
+                *section == (*file)->section_end()) {
+                if (!type) llvm::consumeError(type.takeError());
+                if (!name) llvm::consumeError(name.takeError());
+                if (!section) llvm::consumeError(section.takeError());
+                if (!address) llvm::consumeError(address.takeError());
+                continue;
+            }
+            auto contents = (*section)->getContents();
+            if (!contents) {
+                llvm::consumeError(contents.takeError());
+                continue;
+            }
+            uint64_t offset = *address - (*section)->getAddress();
+            if (offset + size > contents->size()) continue;
+            
+            EmittedCode code;
+            code.bytes = size;
+            code.instructions = count_instructions(llvm::ArrayRef<uint8_t>(
+                reinterpret_cast<const uint8_t*>(contents->data()) + offset, size));
+            linked[name->str()] = code;
+        }
+    }
+    
+    /**
+     * Take the measurement of a function this thread just linked
+     */
+    bool take_emitted_code(const std::string& name, EmittedCode& code) {
+        auto& linked = linked_code();
+        auto it = linked.find(name);
+        if (it == linked.end()) it = linked.find("_" + name);  // Mach-O prefix
+        if (it == linked.end()) return false;
+        code = it->second;
+        linked.erase(it);
+        return true;
+    }
+    
     /**
      * Detect host CPU features for optimal code generation
      */
@@ -4240,6 +6904,25 @@ public:
         return JitResult();
     }
     
+    /**
+     * Link a relocatable object compiled elsewhere (the compile server)
+     */
+    JitResult add_object(std::unique_ptr<llvm::MemoryBuffer> object) {
+        if (!initialized || !jit) {
+            return JitResult(JitErrorKind::InitializationFailed, "JIT not initialized");
+        }
+        
+        if (auto err = jit->addObjectFile(std::move(object))) {
+            std::string err_msg;
+            llvm::raw_string_ostream err_stream(err_msg);
+            err_stream << err;
+            last_error = err_stream.str();
+            return JitResult(JitErrorKind::ModuleCreationFailed, last_error);
+        }
+        
+        return JitResult();
+    }
+    
     /**
      * Lookup a compiled function by name with error handling
      */
@@ -4276,6 +6959,278 @@ public:
 };
 #endif
 
+// ============================================================================
+// Self-Modifying Code Detection
+// ============================================================================
+
+/**
+ * Watches guest pages holding compiled code through the guest memory write
+ * tracker. Code is subscribed in 64KB chunks to keep the number of tracker
+ * subscriptions small; the tracker still reports the written 4KB page, so
+ * only blocks on that page are dropped.
+ */
+struct CodeWriteWatcher {
+    static constexpr uint32_t CHUNK_SHIFT = 16;
+    
+    struct Watch {
+        int subscription;
+        uint64_t generation;   // Subscription generation when last armed
+    };
+    
+    std::unordered_map<uint32_t, Watch> watches;  // Chunk index -> subscription
+    oc_mutex mutex;
+    std::atomic<bool> enabled{true};
+    
+    std::atomic<uint64_t> writes_detected{0};
+    std::atomic<uint64_t> blocks_invalidated{0};
+};
+
+// ============================================================================
+// Code Quality Statistics
+// ============================================================================
+
+/**
+ * Classify a guest instruction for code quality statistics
+ */
+static int classify_op_class(uint32_t instr) {
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    switch (opcode) {
+        case 2: case 3: case 17:  // tdi, twi, sc
+            return OC_PPU_OP_CLASS_SYSTEM;
+        case 4:
+            return OC_PPU_OP_CLASS_VECTOR;
+        case 16: case 18: case 19:
+            return OC_PPU_OP_CLASS_BRANCH;
+        case 58: case 62:
+            return OC_PPU_OP_CLASS_LOAD_STORE;
+        case 59: case 63:
+            return OC_PPU_OP_CLASS_FLOAT;
+        case 31:
+            break;
+        default:
+            return opcode >= 32 && opcode <= 55 ? OC_PPU_OP_CLASS_LOAD_STORE
+                                                : OC_PPU_OP_CLASS_INTEGER;
+    }
+    
+    switch ((instr >> 1) & 0x3FF) {
+        // Indexed, update, reserved and byte-reversed loads/stores, integer and FP
+        case 20: case 21: case 23: case 53: case 55: case 84: case 87: case 119:
+        case 149: case 150: case 151: case 181: case 183: case 214: case 215: case 247:
+        case 279: case 311: case 341: case 343: case 373: case 375: case 407: case 439:
+        case 533: case 534: case 535: case 567: case 597: case 599: case 631: case 661:
+        case 662: case 663: case 695: case 725: case 727: case 759: case 790: case 918:
+        case 983:
+        // Vector loads/stores
+        case 6: case 7: case 38: case 39: case 71: case 103: case 135: case 167:
+        case 199: case 231: case 359: case 487:
+            return OC_PPU_OP_CLASS_LOAD_STORE;
+        // tw, td, mfcr, mtcrf, mfspr, mftb, mtspr, cache management, sync, eieio
+        case 4: case 68: case 19: case 144: case 339: case 371: case 467:
+        case 54: case 86: case 246: case 278: case 982: case 1014: case 598: case 854:
+            return OC_PPU_OP_CLASS_SYSTEM;
+        default:
+            return OC_PPU_OP_CLASS_INTEGER;
+    }
+}
+
+/**
+ * Code quality of native compiles, in total and per guest instruction class.
+ * A unit's host cost is shared across its classes by guest instruction
+ * count, so per-class host figures are kept fractional.
+ */
+struct CodegenStats {
+    struct ClassTotals {
+        uint64_t blocks = 0;
+        uint64_t guest_instructions = 0;
+        double host_instructions = 0;
+        double host_bytes = 0;
+        double helper_calls = 0;
+        double context_loads = 0;
+        double context_stores = 0;
+    };
+    
+    ClassTotals total;
+    ClassTotals classes[OC_PPU_OP_CLASS_COUNT];
+    oc_mutex mutex;
+    
+    void record(const BasicBlock* block) {
+        uint64_t counts[OC_PPU_OP_CLASS_COUNT] = {};
+        for (uint32_t instr : block->instructions) {
+            counts[classify_op_class(instr)]++;
+        }
+        double guest = static_cast<double>(block->instructions.size());
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        auto add = [&](ClassTotals& t, uint64_t count, double share) {
+            t.blocks++;
+            t.guest_instructions += count;
+            t.host_instructions += share * block->host_instructions;
+            t.host_bytes += share * static_cast<double>(block->code_size);
+            t.helper_calls += share * block->helper_calls;
+            t.context_loads += share * block->context_loads;
+            t.context_stores += share * block->context_stores;
+        };
+        add(total, block->instructions.size(), 1.0);
+        for (int c = 0; c < OC_PPU_OP_CLASS_COUNT; c++) {
+            if (counts[c]) add(classes[c], counts[c], static_cast<double>(counts[c]) / guest);
+        }
+    }
+    
+    void reset() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        total = ClassTotals();
+        for (auto& c : classes) c = ClassTotals();
+    }
+};
+
+// ============================================================================
+// Compile Corpus
+// ============================================================================
+
+/**
+ * Flatten a block as region formation left it into a corpus unit and its
+ * payload (layout documented with oc_ppu_corpus_unit_t)
+ */
+static void serialize_unit(const BasicBlock* block, oc_ppu_corpus_unit_t& unit,
+                           std::vector<uint32_t>& payload) {
+    std::memset(&unit, 0, sizeof(unit));
+    unit.address = block->start_address;
+    unit.end_address = block->end_address;
+    unit.instruction_count = static_cast<uint32_t>(block->instructions.size());
+    unit.inlined_call_count = static_cast<uint32_t>(block->inlined_calls.size());
+    if (block->jump_table.valid()) {
+        unit.jump_table_targets = static_cast<uint32_t>(block->jump_table.targets.size());
+        unit.jump_table_address = block->jump_table.table_address;
+        unit.jump_default_target = block->jump_table.default_target;
+        unit.jump_guard_index = static_cast<uint32_t>(block->jump_table.guard_index);
+        unit.jump_index_reg = block->jump_table.index_reg;
+    }
+    unit.guard_count = static_cast<uint8_t>(block->guards.size());
+    
+    payload.assign(block->instructions.begin(), block->instructions.end());
+    for (const auto& call : block->inlined_calls) {
+        payload.push_back(static_cast<uint32_t>(call.first_index));
+        payload.push_back(static_cast<uint32_t>(call.count));
+        payload.push_back(call.callee_address);
+        payload.push_back(call.return_address);
+    }
+    payload.insert(payload.end(), block->jump_table.targets.begin(), block->jump_table.targets.end());
+    for (const auto& site : block->guards) {
+        payload.push_back(site.index);
+        payload.push_back(static_cast<uint32_t>(site.kind) << 8 | site.reg);
+        payload.push_back(static_cast<uint32_t>(site.expected));
+        payload.push_back(static_cast<uint32_t>(site.expected >> 32));
+    }
+}
+
+/**
+ * Rebuild a block from a corpus unit and its payload
+ */
+static void deserialize_unit(const oc_ppu_corpus_unit_t* unit, const uint32_t* payload,
+                             BasicBlock& block) {
+    block.end_address = unit->end_address;
+    block.instructions.assign(payload, payload + unit->instruction_count);
+    const uint32_t* calls = payload + unit->instruction_count;
+    for (uint32_t i = 0; i < unit->inlined_call_count; i++) {
+        InlinedCall call;
+        call.first_index = calls[i * 4];
+        call.count = calls[i * 4 + 1];
+        call.callee_address = calls[i * 4 + 2];
+        call.return_address = calls[i * 4 + 3];
+        block.inlined_calls.push_back(call);
+    }
+    const uint32_t* targets = calls + unit->inlined_call_count * 4;
+    if (unit->jump_table_targets) {
+        block.jump_table.table_address = unit->jump_table_address;
+        block.jump_table.default_target = unit->jump_default_target;
+        block.jump_table.guard_index = unit->jump_guard_index;
+        block.jump_table.index_reg = unit->jump_index_reg;
+        block.jump_table.targets.assign(targets, targets + unit->jump_table_targets);
+    }
+    const uint32_t* guards = targets + unit->jump_table_targets;
+    for (uint32_t i = 0; i < unit->guard_count; i++) {
+        const uint32_t* words = guards + i * 4;
+        if (words[0] >= block.instructions.size()) continue;
+        GuardSite site;
+        site.index = words[0];
+        site.kind = static_cast<GuardKind>(words[1] >> 8);
+        site.reg = static_cast<uint8_t>(words[1] & 0x1F);
+        site.guest_pc = block.address_of(site.index);
+        site.expected = words[2] | uint64_t(words[3]) << 32;
+        block.guards.push_back(site);
+    }
+}
+
+/**
+ * Writes every unit the JIT compiles, after region formation, to a corpus
+ * file so pass pipelines can be tuned offline against real game code (see
+ * ppu_compile_bench). Units are keyed by address and instruction hash, so a
+ * block recompiled after invalidation is only written again if its code
+ * changed. File layout is documented with oc_ppu_corpus_unit_t.
+ */
+struct CompileCorpusWriter {
+    static constexpr char MAGIC[8] = {'O', 'C', 'P', 'P', 'U', 'C', 'R', 'P'};
+    static constexpr uint32_t VERSION = 1;
+    
+    FILE* file = nullptr;
+    std::atomic<bool> active{false};
+    std::unordered_set<uint64_t> seen;
+    uint64_t units_written = 0;
+    oc_mutex mutex;
+    
+    ~CompileCorpusWriter() {
+        end();
+    }
+    
+    int begin(const char* path) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (file) return -2;
+        file = std::fopen(path, "wb");
+        if (!file) return -3;
+        uint32_t header[2] = {VERSION, 0};
+        if (std::fwrite(MAGIC, sizeof(MAGIC), 1, file) != 1 ||
+            std::fwrite(header, sizeof(header), 1, file) != 1) {
+            std::fclose(file);
+            file = nullptr;
+            return -3;
+        }
+        seen.clear();
+        units_written = 0;
+        active.store(true, std::memory_order_release);
+        return 0;
+    }
+    
+    void end() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        active.store(false, std::memory_order_release);
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+    
+    void record(const BasicBlock* block) {
+        if (!active.load(std::memory_order_acquire) || block->instructions.empty()) return;
+        
+        uint64_t key = 0xcbf29ce484222325ULL ^ (static_cast<uint64_t>(block->start_address) << 32);
+        for (uint32_t word : block->instructions) {
+            key = (key ^ word) * 0x100000001b3ULL;
+        }
+        
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (!file || !seen.insert(key).second) return;
+        
+        oc_ppu_corpus_unit_t unit;
+        std::vector<uint32_t> payload;
+        serialize_unit(block, unit, payload);
+        
+        if (std::fwrite(&unit, sizeof(unit), 1, file) == 1 &&
+            std::fwrite(payload.data(), sizeof(uint32_t), payload.size(), file) == payload.size()) {
+            units_written++;
+        }
+    }
+};
+
 /**
  * PPU JIT compiler structure
  */
@@ -4297,12 +7252,31 @@ struct oc_ppu_jit_t {
     JitProfiler profiler;              // JIT profiling support
     BlockLinker block_linker;           // Block linking for direct jumps
     TraceCompiler trace_compiler;       // Trace compilation for hot loops
-    bool enabled;
-    bool lazy_compilation_enabled;
-    bool multithreaded_enabled;
+    StackSlotPromoter stack_promoter;   // r1-relative slot promotion
+    ReadOnlyMemoryMap rodata;           // Registered non-writable guest memory
+    JumpTableRecognizer jump_tables;    // Switch dispatch recovery
+    LeafInliner leaf_inliner;           // bl inlining of small leaf functions
+    WarmStartProfile warm_start;        // Profile persisted across runs
+    VmxByteOrderPlanner vmx_planner;    // Lazy VR byte reversal
+    IdiomRecognizer idioms;             // Multi-instruction idiom fusion
+    SpeculationManager speculation;     // Guards and deoptimization
+    OsrManager osr;                     // Tier-1 to tier-2 loop upgrades
+    CodeWriteWatcher smc_watcher;       // Invalidation on guest code writes
+    CompileCorpusWriter corpus;         // Compiled units dumped for offline tuning
+    CodegenStats codegen_stats;         // Emitted code quality
+    std::atomic<bool> enabled;
+    std::atomic<bool> lazy_compilation_enabled;
+    std::atomic<bool> multithreaded_enabled;
     size_t num_compile_threads;
+    std::atomic<int> pass_pipeline;     // oc_ppu_pass_pipeline_t
+    std::atomic<bool> remote_compile;   // Compile in the compile server when it runs
+    std::atomic<uint32_t> symbol_serial{0};  // Last symbol version handed to a compile
     
 #ifdef HAVE_LLVM
+    // The LLVM context/module below are shared by every compiling thread;
+    // IR generation and module hand-off to ORC are serialized on this lock.
+    // Cache lookups and execution never take it.
+    oc_mutex codegen_mutex;
     std::unique_ptr<llvm::LLVMContext> context;
     std::unique_ptr<llvm::Module> module;
     std::unique_ptr<llvm::orc::LLJIT> jit;
@@ -4311,7 +7285,8 @@ struct oc_ppu_jit_t {
 #endif
     
     oc_ppu_jit_t() : enabled(true), lazy_compilation_enabled(false), 
-                     multithreaded_enabled(false), num_compile_threads(0) {
+                     multithreaded_enabled(false), num_compile_threads(0),
+                     pass_pipeline(OC_PPU_PASS_PIPELINE_O2), remote_compile(false) {
 #ifdef HAVE_LLVM
         context = std::make_unique<llvm::LLVMContext>();
         module = std::make_unique<llvm::Module>("ppu_jit", *context);
@@ -4336,6 +7311,143 @@ struct oc_ppu_jit_t {
     }
 };
 
+/**
+ * Tracker callback: guest code on the page at `page` was written
+ */
+static void on_code_page_written(void* user_data, int /*subscription*/, uint32_t page) {
+    auto* jit = static_cast<oc_ppu_jit_t*>(user_data);
+    jit->smc_watcher.writes_detected.fetch_add(1, std::memory_order_relaxed);
+    std::vector<uint32_t> stale = jit->cache.blocks_overlapping(page, page + 0x1000);
+    // Blocks holding inlined code or a jump table from the page go too
+    for (uint32_t block : jit->block_linker.source_dependents(page, page + 0x1000)) {
+        stale.push_back(block);
+    }
+    for (uint32_t address : stale) {
+        oc_ppu_jit_invalidate(jit, address);
+        jit->smc_watcher.blocks_invalidated.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Subscription generations of the chunks a block was built from, taken
+ * once they are armed and before the block is compiled
+ */
+using CodeSnapshot = std::vector<std::pair<int, uint64_t>>;
+
+/**
+ * Arm write tracking for a range of guest code. Chunks already armed cost a
+ * generation compare. With a snapshot, the armed generation of every chunk
+ * is appended to it.
+ */
+static void watch_code_range(oc_ppu_jit_t* jit, uint32_t start, uint32_t end,
+                             CodeSnapshot* snapshot = nullptr) {
+    auto& watcher = jit->smc_watcher;
+    if (!watcher.enabled.load(std::memory_order_relaxed) || end <= start) return;
+    
+    oc_lock_guard<oc_mutex> lock(watcher.mutex);
+    for (uint32_t chunk = start >> CodeWriteWatcher::CHUNK_SHIFT;
+         chunk <= (end - 1) >> CodeWriteWatcher::CHUNK_SHIFT; chunk++) {
+        auto it = watcher.watches.find(chunk);
+        if (it == watcher.watches.end()) {
+            int sub = oc_mem_track_subscribe(chunk << CodeWriteWatcher::CHUNK_SHIFT,
+                                             1u << CodeWriteWatcher::CHUNK_SHIFT,
+                                             on_code_page_written, jit);
+            if (sub < 0) continue;  // Not tracked guest memory
+            it = watcher.watches.emplace(chunk, CodeWriteWatcher::Watch{sub, oc_mem_track_get_generation(sub)}).first;
+        } else if (oc_mem_track_get_generation(it->second.subscription) != it->second.generation) {
+            // A page of this chunk was written since it was armed
+            it->second.generation = oc_mem_track_rearm(it->second.subscription);
+        }
+        if (snapshot) snapshot->emplace_back(it->second.subscription, it->second.generation);
+    }
+}
+
+/**
+ * Guest ranges a block was built from: its own code first, then the callee
+ * code it inlined and the jump table it dispatches through
+ */
+static std::vector<std::pair<uint32_t, uint32_t>> block_source_ranges(const BasicBlock* block) {
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    ranges.emplace_back(block->start_address, block->end_address);
+    for (const auto& call : block->inlined_calls) {
+        ranges.emplace_back(call.callee_address,
+                            call.callee_address + static_cast<uint32_t>(call.count * 4) + 4);
+    }
+    if (block->jump_table.valid()) {
+        uint32_t table = block->jump_table.table_address;
+        ranges.emplace_back(table, table + static_cast<uint32_t>(block->jump_table.targets.size() * 4));
+    }
+    return ranges;
+}
+
+/**
+ * Arm the source ranges of an identified block before it is compiled. A
+ * write landing while it compiles misses the block, which is not cached
+ * yet; cache_compiled_block compares against the snapshot to catch it.
+ */
+static CodeSnapshot snapshot_block_source(oc_ppu_jit_t* jit, const BasicBlock* block) {
+    CodeSnapshot snapshot;
+    for (const auto& [start, end] : block_source_ranges(block)) {
+        watch_code_range(jit, start, end, &snapshot);
+    }
+    return snapshot;
+}
+
+/**
+ * Bring a cached loop region to the edge of its tier-2 upgrade, so the
+ * dispatcher compiles it on the next run that takes the back-edge
+ */
+static void arm_loop_upgrade(oc_ppu_jit_t* jit, uint32_t address) {
+    constexpr uint32_t armed = OsrManager::UPGRADE_BACK_EDGES - 1;
+    CodeCache::ReadGuard guard(jit->cache);
+    BasicBlock* block = jit->cache.find_block(address);
+    if (!block || !block->loop_header) return;
+    uint32_t seen = block->back_edges.load(std::memory_order_relaxed);
+    while (seen < armed &&
+           !block->back_edges.compare_exchange_weak(seen, armed, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Insert a compiled block into the cache and watch what it was built from
+ * for writes. A block whose source was written since the snapshot is
+ * dropped again.
+ */
+static void cache_compiled_block(oc_ppu_jit_t* jit, uint32_t address,
+                                 std::unique_ptr<BasicBlock> block,
+                                 const CodeSnapshot& snapshot) {
+    std::vector<std::pair<uint32_t, uint32_t>> ranges = block_source_ranges(block.get());
+    jit->corpus.record(block.get());
+    // Recorded first so an invalidation of a callee cannot slip in between;
+    // a block losing the insert race has the same sources as the winner
+    jit->block_linker.set_source_dependencies(
+        address, std::vector<std::pair<uint32_t, uint32_t>>(ranges.begin() + 1, ranges.end()));
+    if (!jit->cache.insert_block(address, std::move(block))) return;
+    
+    // Compared before re-arming, which moves the generations on
+    bool written = std::any_of(snapshot.begin(), snapshot.end(), [](const auto& watch) {
+        return oc_mem_track_get_generation(watch.first) != watch.second;
+    });
+    for (const auto& [start, end] : ranges) {
+        watch_code_range(jit, start, end);
+    }
+    if (written) {
+        oc_ppu_jit_invalidate(jit, address);
+        jit->smc_watcher.blocks_invalidated.fetch_add(1, std::memory_order_relaxed);
+    } else if (jit->warm_start.take_optimizing(address)) {
+        arm_loop_upgrade(jit, address);
+    }
+}
+
+static void unwatch_all_code(oc_ppu_jit_t* jit) {
+    auto& watcher = jit->smc_watcher;
+    oc_lock_guard<oc_mutex> lock(watcher.mutex);
+    for (const auto& [chunk, watch] : watcher.watches) {
+        oc_mem_track_unsubscribe(watch.subscription);
+    }
+    watcher.watches.clear();
+}
+
 /**
  * Identify basic block boundaries
  * A basic block ends at:
@@ -4386,10 +7498,87 @@ static void identify_basic_block(const uint8_t* code, size_t size, BasicBlock* b
     }
 }
 
+/**
+ * Identify the region to compile at a block start: the basic block, with
+ * small leaf calls inlined and extended through a switch dispatch when its
+ * jump table can be recovered
+ */
+static void identify_region(oc_ppu_jit_t* jit, const uint8_t* code, size_t size,
+                            BasicBlock* block) {
+    identify_basic_block(code, size, block);
+    
+    // Inline leaf calls and keep going in the caller after each one
+    while (block->inlined_calls.size() < MAX_INLINED_CALLS_PER_REGION &&
+           jit->leaf_inliner.try_inline(block, jit->rodata)) {
+        size_t offset = block->end_address - block->start_address;
+        if (offset >= size) break;
+        BasicBlock tail(block->end_address);
+        identify_basic_block(code + offset, size - offset, &tail);
+        block->instructions.insert(block->instructions.end(),
+                                   tail.instructions.begin(), tail.instructions.end());
+        block->end_address = tail.end_address;
+    }
+    
+    jit->jump_tables.extend(block, code, size, jit->rodata);
+    jit->speculation.speculate(block, jit->const_prop_cache, jit->branch_target_cache);
+    jit->osr.plan(block);
+}
+
 #ifdef HAVE_LLVM
 // Forward declarations for functions defined later in this file
-static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* block);
-static void apply_optimization_passes(llvm::Module* module);
+static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* block,
+                                            const StackFrameInfo* frame = nullptr,
+                                            const VmxSwapPlan* vmx = nullptr,
+                                            const IdiomPlan* idioms = nullptr);
+static void apply_optimization_passes(llvm::Module* module,
+                                      int pipeline = OC_PPU_PASS_PIPELINE_O2);
+
+/**
+ * Create the LLVM function for a block, with the stack slot, VMX byte order
+ * and idiom plans the JIT has enabled
+ */
+static llvm::Function* create_block_function(oc_ppu_jit_t* jit, llvm::Module* module,
+                                             BasicBlock* block) {
+    StackFrameInfo frame;
+    if (jit->stack_promoter.enabled.load(std::memory_order_relaxed)) {
+        frame = jit->stack_promoter.analyze(block->instructions);
+    }
+    VmxSwapPlan vmx;
+    if (jit->vmx_planner.enabled.load(std::memory_order_relaxed)) {
+        vmx = jit->vmx_planner.plan(block->instructions);
+    }
+    IdiomPlan idioms;
+    if (jit->idioms.enabled.load(std::memory_order_relaxed)) {
+        idioms = jit->idioms.plan(block->instructions);
+    }
+    return create_llvm_function(module, block, &frame, &vmx, &idioms);
+}
+
+/**
+ * Count helper calls and PPU context traffic left in optimized block IR
+ */
+static void count_context_traffic(llvm::Function* func, BasicBlock* block) {
+    llvm::Value* context = func->getArg(0);
+    block->helper_calls = 0;
+    block->context_loads = 0;
+    block->context_stores = 0;
+    for (auto& bb : *func) {
+        for (auto& inst : bb) {
+            if (auto* call = llvm::dyn_cast<llvm::CallInst>(&inst)) {
+                llvm::Function* callee = call->getCalledFunction();
+                if (!callee || !callee->isIntrinsic()) block->helper_calls++;
+            } else if (auto* load = llvm::dyn_cast<llvm::LoadInst>(&inst)) {
+                if (llvm::getUnderlyingObject(load->getPointerOperand()) == context) {
+                    block->context_loads++;
+                }
+            } else if (auto* store = llvm::dyn_cast<llvm::StoreInst>(&inst)) {
+                if (llvm::getUnderlyingObject(store->getPointerOperand()) == context) {
+                    block->context_stores++;
+                }
+            }
+        }
+    }
+}
 #endif
 
 /**
@@ -4418,39 +7607,140 @@ static void allocate_placeholder_code(BasicBlock* block) {
     block->code_size = block->instructions.size() * 16; // Estimate
     block->compiled_code = malloc(block->code_size);
     if (block->compiled_code) {
+        block->owns_code = true;
         memset(block->compiled_code, X86_RET_INSTRUCTION, block->code_size);
     }
 }
 
+#ifdef HAVE_LLVM
+/**
+ * Name of a block's function in the JIT's dylib. Every compile of an address
+ * gets its own version, since code of the earlier ones stays linked.
+ */
+static std::string block_symbol(const char* prefix, const BasicBlock* block) {
+    return prefix + std::to_string(block->start_address) + "_" + std::to_string(block->symbol_version);
+}
+
+/**
+ * Compile a block in the compile server and link the returned object here.
+ * The server receives the unit as region formation left it and this JIT's
+ * codegen settings, so it emits the code an in-process compile would; no
+ * codegen lock is held while it works.
+ * Returns false if the block must be compiled in-process instead.
+ */
+static bool compile_remote(BasicBlock* block, oc_ppu_jit_t* jit) {
+    if (!jit->orc_manager.is_initialized() || !oc_compile_server_is_running()) return false;
+    // The back-edge upgrade check and the branch guard's link address the
+    // block's slots in this process
+    if (block->loop_header) return false;
+    for (const auto& site : block->guards) {
+        if (site.kind == GuardKind::BranchTarget) return false;
+    }
+    
+    oc_ppu_corpus_unit_t unit;
+    std::vector<uint32_t> payload;
+    serialize_unit(block, unit, payload);
+    block->symbol_version = jit->symbol_serial.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::vector<uint8_t> request(sizeof(uint32_t) + sizeof(unit) + payload.size() * sizeof(uint32_t));
+    std::memcpy(request.data(), &block->symbol_version, sizeof(uint32_t));
+    std::memcpy(request.data() + sizeof(uint32_t), &unit, sizeof(unit));
+    std::memcpy(request.data() + sizeof(uint32_t) + sizeof(unit), payload.data(),
+                payload.size() * sizeof(uint32_t));
+    
+    uint32_t flags = static_cast<uint32_t>(jit->pass_pipeline.load(std::memory_order_relaxed));
+    if (jit->stack_promoter.enabled.load(std::memory_order_relaxed)) flags |= OC_COMPILE_PPU_STACK_PROMOTION;
+    if (jit->vmx_planner.enabled.load(std::memory_order_relaxed)) flags |= OC_COMPILE_PPU_VMX_SWAP_FOLD;
+    if (jit->idioms.enabled.load(std::memory_order_relaxed)) flags |= OC_COMPILE_PPU_IDIOMS;
+    
+    thread_local std::vector<uint8_t> object(OC_COMPILE_SERVER_MAX_MESSAGE);
+    size_t object_size = 0;
+    if (oc_compile_server_submit(OC_COMPILE_KIND_PPU, flags, request.data(), request.size(),
+                                 object.data(), object.size(), &object_size) != 0) {
+        return false;
+    }
+    
+    auto buffer = llvm::MemoryBuffer::getMemBufferCopy(
+        llvm::StringRef(reinterpret_cast<const char*>(object.data()), object_size),
+        "ppu_remote_object");
+    if (!jit->orc_manager.add_object(std::move(buffer)).success()) return false;
+    
+    std::string func_name = block_symbol("ppu_block_", block);
+    auto sym_result = jit->orc_manager.lookup_function(func_name);
+    if (!sym_result.success() || !sym_result.compiled_code) return false;
+    
+    block->compiled_code = sym_result.compiled_code;
+    block->code_size = block->instructions.size() * 16;
+    block->checks_budget = true;
+    OrcJitManager::EmittedCode emitted;
+    if (jit->orc_manager.take_emitted_code(func_name, emitted)) {
+        block->code_size = emitted.bytes;
+        block->host_instructions = static_cast<uint32_t>(emitted.instructions);
+    }
+    jit->codegen_stats.record(block);
+    return true;
+}
+
+/**
+ * Hand the JIT's current module to ORC and look up name in it. The JIT
+ * starts a new module either way; the caller holds the codegen lock.
+ * Returns nullptr if the module could not be added or the symbol found.
+ */
+static void* link_current_module(oc_ppu_jit_t* jit, const std::string& name) {
+    void* code = nullptr;
+    auto result = jit->orc_manager.add_module(std::move(jit->module));
+    if (result.success()) {
+        auto sym_result = jit->orc_manager.lookup(name);
+        if (sym_result.success() && sym_result.address != 0) {
+            code = reinterpret_cast<void*>(sym_result.address);
+        }
+    }
+    // Create a new module for next compilation
+    jit->module = std::make_unique<llvm::Module>("ppu_jit", *jit->context);
+    return code;
+}
+#endif
+
 static void generate_llvm_ir(BasicBlock* block, oc_ppu_jit_t* jit = nullptr) {
 #ifdef HAVE_LLVM
-    if (jit && jit->module) {
+    if (!jit) {
+        allocate_placeholder_code(block);
+        return;
+    }
+    if (jit->remote_compile.load(std::memory_order_relaxed) && compile_remote(block, jit)) {
+        return;
+    }
+    oc_lock_guard<oc_mutex> codegen_lock(jit->codegen_mutex);
+    if (jit->module) {
+        block->symbol_version = jit->symbol_serial.fetch_add(1, std::memory_order_relaxed) + 1;
         // Create LLVM function for this block
-        llvm::Function* func = create_llvm_function(jit->module.get(), block);
+        llvm::Function* func = create_block_function(jit, jit->module.get(), block);
         
         if (func) {
             // Apply optimization passes to the module
-            apply_optimization_passes(jit->module.get());
+            apply_optimization_passes(jit->module.get(),
+                                      jit->pass_pipeline.load(std::memory_order_relaxed));
+            count_context_traffic(func, block);
             
             // If we have a working ORC JIT, compile and get the function pointer
             if (jit->orc_manager.is_initialized()) {
-                auto result = jit->orc_manager.add_module(std::move(jit->module));
-                if (result.success()) {
-                    std::string func_name = "ppu_block_" + std::to_string(block->start_address);
-                    auto sym_result = jit->orc_manager.lookup(func_name);
-                    if (sym_result.success() && sym_result.address != 0) {
-                        block->compiled_code = reinterpret_cast<void*>(sym_result.address);
-                        block->code_size = block->instructions.size() * 16;
-                    } else {
-                        // Symbol lookup failed — fallback to interpreter
-                        allocate_placeholder_code(block);
+                std::string func_name = block_symbol("ppu_block_", block);
+                void* code = link_current_module(jit, func_name);
+                if (code) {
+                    block->compiled_code = code;
+                    block->code_size = block->instructions.size() * 16;
+                    block->checks_budget = true;
+                    
+                    // Lookup materialized the module, so its object was measured
+                    OrcJitManager::EmittedCode emitted;
+                    if (jit->orc_manager.take_emitted_code(func_name, emitted)) {
+                        block->code_size = emitted.bytes;
+                        block->host_instructions = static_cast<uint32_t>(emitted.instructions);
                     }
+                    jit->codegen_stats.record(block);
                 } else {
-                    // Module add failed — fallback to interpreter
+                    // Module add or symbol lookup failed — fallback to interpreter
                     allocate_placeholder_code(block);
                 }
-                // Create a new module for next compilation
-                jit->module = std::make_unique<llvm::Module>("ppu_jit", *jit->context);
             } else if (jit->jit) {
                 // Fallback to LLJIT
                 auto ts_module = llvm::orc::ThreadSafeModule(
@@ -4650,6 +7940,43 @@ static void set_ca_add_extended(llvm::IRBuilder<>& builder, llvm::Value* a, llvm
     builder.CreateStore(new_xer, xer_ptr);
 }
 
+static const PreemptionLayout PPU_PREEMPTION_LAYOUT = {
+    offsetof(oc_ppu_context_t, interrupt_pending),
+    offsetof(oc_ppu_context_t, budget_enabled),
+    offsetof(oc_ppu_context_t, instruction_budget),
+    offsetof(oc_ppu_context_t, exit_reason),
+    offsetof(oc_ppu_context_t, next_pc),
+    64,
+    OC_PPU_EXIT_PREEMPTED,
+};
+
+/**
+ * Emit a preemption check at a region entry or loop header
+ * 
+ * If context->interrupt_pending is set, or the instruction budget is enabled
+ * and used up, the function exits with OC_PPU_EXIT_PREEMPTED and
+ * next_pc = resume_pc so the dispatcher can resume exactly here later.
+ * Otherwise instr_count is charged against the budget. The builder is left
+ * in the continuation block. Cost on the fast path: two loads, a compare
+ * and a store. Callers that hold guest state in registers get the exit
+ * block in preempt_out to store it there.
+ */
+static void emit_preemption_check(llvm::IRBuilder<>& builder, llvm::Value* context,
+                                  uint32_t instr_count, uint64_t resume_pc,
+                                  llvm::BasicBlock** preempt_out = nullptr) {
+    llvm::BasicBlock* preempt_bb = emit_preemption_check(builder, context, PPU_PREEMPTION_LAYOUT,
+                                                         instr_count, resume_pc);
+    if (preempt_out) *preempt_out = preempt_bb;
+}
+
+/**
+ * SPR number of an mfspr/mtspr: the instruction holds the two 5-bit halves
+ * swapped, low half in bits 16-20
+ */
+static uint16_t decode_spr(uint32_t instr) {
+    return ((instr >> 16) & 0x1F) | (((instr >> 11) & 0x1F) << 5);
+}
+
 /**
  * Emit LLVM IR for PPU instructions
  * 
@@ -5796,7 +9123,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                 }
                 // SPR access
                 case 339: { // mfspr rt, spr - Move From Special Purpose Register
-                    uint16_t spr = ((instr >> 11) & 0x1F) | (((instr >> 16) & 0x1F) << 5);
+                    uint16_t spr = decode_spr(instr);
                     llvm::Value* spr_val = llvm::ConstantInt::get(i64_ty, 0);
                     if (spr == 8) { // LR
                         spr_val = builder.CreateLoad(i64_ty, lr_ptr);
@@ -5826,7 +9153,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     break;
                 }
                 case 467: { // mtspr spr, rs - Move To Special Purpose Register
-                    uint16_t spr = ((instr >> 11) & 0x1F) | (((instr >> 16) & 0x1F) << 5);
+                    uint16_t spr = decode_spr(instr);
                     llvm::Value* rs_val = builder.CreateLoad(i64_ty, gprs[rt]);
                     if (spr == 8) { // LR
                         builder.CreateStore(rs_val, lr_ptr);
@@ -7415,7 +10742,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
             uint8_t vrc = (instr >> 6) & 0x1F;  // Vector source register C (for VA-form)
             
             // Extract sub-opcode fields
-            uint16_t vxo_vx = (instr >> 1) & 0x3FF;  // 10-bit sub-opcode for VX-form
+            uint16_t vxo_vx = instr & 0x7FF;  // 11-bit sub-opcode for VX-form
             uint8_t vxo_va = (instr >> 0) & 0x3F;  // 6-bit sub-opcode for VA-form
             
             // VA-Form instructions (6-bit sub-opcode in bits 0-5)
@@ -7440,7 +10767,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result, vrs[vrt]);
                     break;
                 }
-                case 43: { // vsel vrt, vra, vrb, vrc - Vector Select
+                case 42: { // vsel vrt, vra, vrb, vrc - Vector Select
                     // For each bit: result = (vrc & vrb) | (~vrc & vra)
                     llvm::Value* a = builder.CreateLoad(v4i32_ty, vrs[vra]);
                     llvm::Value* b = builder.CreateLoad(v4i32_ty, vrs[vrb]);
@@ -7452,7 +10779,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result, vrs[vrt]);
                     break;
                 }
-                case 44: { // vperm vrt, vra, vrb, vrc - Vector Permute
+                case 43: { // vperm vrt, vra, vrb, vrc - Vector Permute
                     // vperm selects bytes from the concatenation of vra and vrb based on vrc
                     // Each byte of vrc selects a byte from the 32-byte {vra, vrb} concatenation
                     auto v16i8_ty = llvm::VectorType::get(i8_ty, 16, false);
@@ -7487,7 +10814,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     break;
             }
             
-            // VX-Form instructions (10-bit sub-opcode)
+            // VX-Form instructions (11-bit sub-opcode)
             switch (vxo_vx) {
                 case 10: { // vaddfp vrt, vra, vrb - Vector Add FP
                     llvm::Value* a = builder.CreateLoad(v4f32_ty, vrs[vra]);
@@ -7583,7 +10910,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result, vrs[vrt]);
                     break;
                 }
-                case 258: { // vmaxsw vrt, vra, vrb - Vector Maximum Signed Word
+                case 386: { // vmaxsw vrt, vra, vrb - Vector Maximum Signed Word
                     llvm::Value* a = builder.CreateLoad(v4i32_ty, vrs[vra]);
                     llvm::Value* b = builder.CreateLoad(v4i32_ty, vrs[vrb]);
                     llvm::Function* smax_fn = llvm::Intrinsic::getDeclaration(
@@ -7593,7 +10920,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result, vrs[vrt]);
                     break;
                 }
-                case 386: { // vminsw vrt, vra, vrb - Vector Minimum Signed Word
+                case 898: { // vminsw vrt, vra, vrb - Vector Minimum Signed Word
                     llvm::Value* a = builder.CreateLoad(v4i32_ty, vrs[vra]);
                     llvm::Value* b = builder.CreateLoad(v4i32_ty, vrs[vrb]);
                     llvm::Function* smin_fn = llvm::Intrinsic::getDeclaration(
@@ -7621,7 +10948,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result, vrs[vrt]);
                     break;
                 }
-                case 776: { // vmulesh vrt, vra, vrb - Vector Multiply Even Signed Halfword
+                case 840: { // vmulesh vrt, vra, vrb - Vector Multiply Even Signed Halfword
                     auto v8i16_ty = llvm::VectorType::get(i16_ty, 8, false);
                     llvm::Value* a = builder.CreateBitCast(
                         builder.CreateLoad(v4i32_ty, vrs[vra]), v8i16_ty);
@@ -7762,7 +11089,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result_i32, vrs[vrt]);
                     break;
                 }
-                case 846: { // vupkhsh vrt, vrb - Vector Unpack High Signed Halfword
+                case 590: { // vupkhsh vrt, vrb - Vector Unpack High Signed Halfword
                     auto v8i16_ty = llvm::VectorType::get(i16_ty, 8, false);
                     llvm::Value* b = builder.CreateBitCast(
                         builder.CreateLoad(v4i32_ty, vrs[vrb]), v8i16_ty);
@@ -7776,7 +11103,7 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
                     builder.CreateStore(result, vrs[vrt]);
                     break;
                 }
-                case 974: { // vupklsh vrt, vrb - Vector Unpack Low Signed Halfword
+                case 718: { // vupklsh vrt, vrb - Vector Unpack Low Signed Halfword
                     auto v8i16_ty = llvm::VectorType::get(i16_ty, 8, false);
                     llvm::Value* b = builder.CreateBitCast(
                         builder.CreateLoad(v4i32_ty, vrs[vrb]), v8i16_ty);
@@ -7799,17 +11126,469 @@ static void emit_ppu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
             (void)vscr_ptr;
             break;
         }
-        
+        
+        default:
+            // Unhandled instruction - emit nop
+            break;
+    }
+}
+
+/**
+ * Emit a promoted stack access against the slot's alloca instead of guest memory
+ */
+static void emit_promoted_stack_access(llvm::IRBuilder<>& builder, uint32_t instr,
+                                       llvm::Value* slot, llvm::Value** gprs,
+                                       llvm::Value** fprs) {
+    auto& ctx = builder.getContext();
+    auto i32_ty = llvm::Type::getInt32Ty(ctx);
+    auto i64_ty = llvm::Type::getInt64Ty(ctx);
+    auto f64_ty = llvm::Type::getDoubleTy(ctx);
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    uint8_t rt = (instr >> 21) & 0x1F;
+    
+    switch (opcode) {
+        case 32: { // lwz
+            llvm::Value* loaded = builder.CreateLoad(i32_ty, slot);
+            builder.CreateStore(builder.CreateZExt(loaded, i64_ty), gprs[rt]);
+            break;
+        }
+        case 36: { // stw
+            llvm::Value* rs_val = builder.CreateLoad(i64_ty, gprs[rt]);
+            builder.CreateStore(builder.CreateTrunc(rs_val, i32_ty), slot);
+            break;
+        }
+        case 58: // ld
+            builder.CreateStore(builder.CreateLoad(i64_ty, slot), gprs[rt]);
+            break;
+        case 62: // std
+            builder.CreateStore(builder.CreateLoad(i64_ty, gprs[rt]), slot);
+            break;
+        case 50: { // lfd
+            llvm::Value* bits = builder.CreateLoad(i64_ty, slot);
+            builder.CreateStore(builder.CreateBitCast(bits, f64_ty), fprs[rt]);
+            break;
+        }
+        case 54: { // stfd
+            llvm::Value* frs_val = builder.CreateLoad(f64_ty, fprs[rt]);
+            builder.CreateStore(builder.CreateBitCast(frs_val, i64_ty), slot);
+            break;
+        }
         default:
-            // Unhandled instruction - emit nop
             break;
     }
 }
 
+/**
+ * Emit the bounds check of a recovered jump table
+ *
+ * An out-of-range case index stores the default target in next_pc and
+ * skips the dispatch sequence, as the guest's bounds check branch does. The
+ * builder is left at the start of the in-range path; the returned block
+ * joins both paths and is where emit_jump_table_switch continues.
+ */
+static llvm::BasicBlock* emit_jump_table_bounds_check(llvm::IRBuilder<>& builder, llvm::Value* context,
+                                                      llvm::Value** gprs, const JumpTable& table) {
+    auto& ctx = builder.getContext();
+    llvm::Function* func = builder.GetInsertBlock()->getParent();
+    
+    llvm::Value* index = builder.CreateTrunc(
+        builder.CreateLoad(builder.getInt64Ty(), gprs[table.index_reg]), builder.getInt32Ty(), "case_index");
+    llvm::Value* in_range = builder.CreateICmpULT(
+        index, builder.getInt32(static_cast<uint32_t>(table.targets.size())));
+    
+    llvm::BasicBlock* dispatch_bb = llvm::BasicBlock::Create(ctx, "switch_dispatch", func);
+    llvm::BasicBlock* default_bb = llvm::BasicBlock::Create(ctx, "switch_default", func);
+    llvm::BasicBlock* exit_bb = llvm::BasicBlock::Create(ctx, "switch_exit", func);
+    builder.CreateCondBr(in_range, dispatch_bb, default_bb);
+    
+    builder.SetInsertPoint(default_bb);
+    builder.CreateStore(builder.getInt64(table.default_target), builder.CreateConstInBoundsGEP1_64(
+        builder.getInt8Ty(), context, offsetof(oc_ppu_context_t, next_pc)));
+    builder.CreateBr(exit_bb);
+    
+    builder.SetInsertPoint(dispatch_bb);
+    return exit_bb;
+}
+
+/**
+ * Emit the bctr of a recovered jump table as a native switch on the case
+ * index
+ *
+ * Runs after the dispatch sequence on the in-range path only: every case
+ * stores its constant target in next_pc, so dispatch never goes through the
+ * BTB. Continues in exit_bb from emit_jump_table_bounds_check.
+ */
+static void emit_jump_table_switch(llvm::IRBuilder<>& builder, llvm::Value* context,
+                                   llvm::Value** gprs, const JumpTable& table,
+                                   llvm::BasicBlock* exit_bb) {
+    auto& ctx = builder.getContext();
+    llvm::Function* func = builder.GetInsertBlock()->getParent();
+    auto i32_ty = builder.getInt32Ty();
+    auto i64_ty = builder.getInt64Ty();
+    
+    llvm::Value* next_pc_ptr = builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(),
+        context, offsetof(oc_ppu_context_t, next_pc));
+    llvm::Value* index = builder.CreateTrunc(
+        builder.CreateLoad(i64_ty, gprs[table.index_reg]), i32_ty, "case_index");
+    
+    std::unordered_map<uint32_t, llvm::BasicBlock*> edges;
+    llvm::IRBuilder<> edge_builder(ctx);
+    auto edge_to = [&](uint32_t target) {
+        auto it = edges.find(target);
+        if (it != edges.end()) return it->second;
+        llvm::BasicBlock* bb = llvm::BasicBlock::Create(ctx,
+            "case_" + std::to_string(target), func, exit_bb);
+        edge_builder.SetInsertPoint(bb);
+        edge_builder.CreateStore(edge_builder.getInt64(target), next_pc_ptr);
+        edge_builder.CreateBr(exit_bb);
+        edges.emplace(target, bb);
+        return bb;
+    };
+    
+    // The bounds check already sent every other index to the default
+    llvm::BasicBlock* unreachable_bb = llvm::BasicBlock::Create(ctx, "switch_unreachable", func, exit_bb);
+    edge_builder.SetInsertPoint(unreachable_bb);
+    edge_builder.CreateUnreachable();
+    llvm::SwitchInst* sw = builder.CreateSwitch(index, unreachable_bb,
+                                                static_cast<unsigned>(table.targets.size()));
+    for (size_t i = 0; i < table.targets.size(); i++) {
+        sw->addCase(builder.getInt32(static_cast<uint32_t>(i)), edge_to(table.targets[i]));
+    }
+    builder.SetInsertPoint(exit_bb);
+}
+
+/**
+ * Emit a recognized idiom in place of the guest instructions it covers
+ *
+ * Values are built from rotate, bswap and truncate/extend intrinsics in the
+ * canonical form instruction selection matches to rorx, bzhi, movbe and
+ * movsx/movzx when the host has them. A compare-branch updates CR as the
+ * compare would and stores the taken or fall-through target in next_pc.
+ */
+static void emit_ppc_idiom(llvm::IRBuilder<>& builder, const PpcIdiom& idiom,
+                           llvm::Value** gprs, llvm::Value* cr_ptr, llvm::Value* xer_ptr,
+                           llvm::Value* context, uint64_t branch_pc) {
+    auto i32_ty = builder.getInt32Ty();
+    auto i64_ty = builder.getInt64Ty();
+    llvm::Module* module = builder.GetInsertBlock()->getModule();
+    
+    switch (idiom.kind) {
+        case PpcIdiomKind::Constant:
+            builder.CreateStore(builder.getInt64(idiom.value), gprs[idiom.rd]);
+            break;
+        case PpcIdiomKind::RotateMask: {
+            llvm::Value* word = builder.CreateTrunc(builder.CreateLoad(i64_ty, gprs[idiom.rs]), i32_ty);
+            if (idiom.shift) {
+                llvm::Function* fshl = llvm::Intrinsic::getDeclaration(module, llvm::Intrinsic::fshl, {i32_ty});
+                word = builder.CreateCall(fshl, {word, word, builder.getInt32(idiom.shift)});
+            }
+            if (static_cast<uint32_t>(idiom.value) != 0xFFFFFFFFu) {
+                word = builder.CreateAnd(word, builder.getInt32(static_cast<uint32_t>(idiom.value)));
+            }
+            builder.CreateStore(builder.CreateZExt(word, i64_ty), gprs[idiom.rd]);
+            break;
+        }
+        case PpcIdiomKind::Extend: {
+            llvm::Value* value = builder.CreateLoad(i64_ty, gprs[idiom.rs]);
+            if (idiom.sign) {
+                value = builder.CreateSExt(builder.CreateTrunc(value, builder.getIntNTy(idiom.width)), i64_ty);
+            } else if (idiom.width < 64) {
+                value = builder.CreateAnd(value, builder.getInt64(~0ULL >> (64 - idiom.width)));
+            }
+            builder.CreateStore(value, gprs[idiom.rd]);
+            break;
+        }
+        case PpcIdiomKind::ByteSwap: {
+            auto ty = builder.getIntNTy(idiom.width);
+            llvm::Value* value = builder.CreateTrunc(builder.CreateLoad(i64_ty, gprs[idiom.rs]), ty);
+            llvm::Function* bswap = llvm::Intrinsic::getDeclaration(module, llvm::Intrinsic::bswap, {ty});
+            builder.CreateStore(builder.CreateZExt(builder.CreateCall(bswap, {value}), i64_ty),
+                                gprs[idiom.rd]);
+            break;
+        }
+        case PpcIdiomKind::CompareBranch: {
+            auto cmp_ty = idiom.doubleword ? i64_ty : i32_ty;
+            llvm::Value* a = builder.CreateLoad(i64_ty, gprs[idiom.rs]);
+            llvm::Value* b = idiom.immediate ? static_cast<llvm::Value*>(builder.getInt64(idiom.value))
+                                             : builder.CreateLoad(i64_ty, gprs[idiom.rb]);
+            if (!idiom.doubleword) {
+                a = builder.CreateTrunc(a, cmp_ty);
+                b = builder.CreateTrunc(b, cmp_ty);
+            }
+            llvm::Value* lt = idiom.is_signed ? builder.CreateICmpSLT(a, b) : builder.CreateICmpULT(a, b);
+            llvm::Value* gt = idiom.is_signed ? builder.CreateICmpSGT(a, b) : builder.CreateICmpUGT(a, b);
+            llvm::Value* eq = builder.CreateICmpEQ(a, b);
+            
+            llvm::Value* cr_field = builder.CreateSelect(lt, builder.getInt32(8),
+                builder.CreateSelect(gt, builder.getInt32(4), builder.getInt32(2)));
+            cr_field = builder.CreateOr(cr_field, get_so_bit_for_cr(builder, xer_ptr));
+            unsigned shift = 28 - idiom.crf * 4;
+            llvm::Value* cr = builder.CreateAnd(builder.CreateLoad(i32_ty, cr_ptr),
+                                                builder.getInt32(~(0xFu << shift)));
+            builder.CreateStore(builder.CreateOr(cr, builder.CreateShl(cr_field, shift)), cr_ptr);
+            
+            llvm::Value* taken = idiom.cr_bit == 0 ? lt : idiom.cr_bit == 1 ? gt : eq;
+            if (!idiom.branch_if_true) taken = builder.CreateNot(taken);
+            uint64_t target = static_cast<uint32_t>(branch_pc + static_cast<int64_t>(idiom.displacement));
+            llvm::Value* next_pc_ptr = builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(),
+                context, offsetof(oc_ppu_context_t, next_pc));
+            builder.CreateStore(builder.CreateSelect(taken, builder.getInt64(target),
+                                                     builder.getInt64(branch_pc + 4)),
+                                next_pc_ptr);
+            break;
+        }
+    }
+}
+
+/**
+ * Guest state a region has changed so far: every store to a register alloca
+ * other than its load from the context at entry. reg_of maps the allocas to (0 GPR,
+ * 1 FPR, 2 VR, 3 special register, index or OC_PPU_DEOPT_* flag).
+ */
+static DeoptState collect_written_state(llvm::Function* func,
+    const std::unordered_map<const llvm::Value*, std::pair<int, uint32_t>>& reg_of,
+    const std::unordered_set<const llvm::Instruction*>& untracked_stores) {
+    DeoptState state;
+    for (auto& bb : *func) {
+        for (auto& inst : bb) {
+            auto* store = llvm::dyn_cast<llvm::StoreInst>(&inst);
+            if (!store || untracked_stores.count(store)) continue;
+            auto it = reg_of.find(store->getPointerOperand()->stripPointerCasts());
+            if (it == reg_of.end()) continue;
+            switch (it->second.first) {
+                case 0: state.gprs |= 1u << it->second.second; break;
+                case 1: state.fprs |= 1u << it->second.second; break;
+                case 2: state.vrs |= 1u << it->second.second; break;
+                default: state.materialized |= it->second.second; break;
+            }
+        }
+    }
+    return state;
+}
+
+/**
+ * Store the registers in state to the context. VRs are stored as host-order
+ * words in element order, whichever layout the region held them in.
+ */
+static void store_guest_state(llvm::IRBuilder<>& builder, llvm::Value* context,
+                              const DeoptState& state, uint32_t vrs_reversed,
+                              llvm::Value** gprs, llvm::Value** fprs, llvm::Value** vrs,
+                              llvm::Value* cr_ptr, llvm::Value* lr_ptr, llvm::Value* ctr_ptr,
+                              llvm::Value* xer_ptr, llvm::Value* vscr_ptr) {
+    auto i8_ty = builder.getInt8Ty();
+    auto i32_ty = builder.getInt32Ty();
+    auto i64_ty = builder.getInt64Ty();
+    auto v16i8_ty = llvm::VectorType::get(i8_ty, 16, false);
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(i8_ty, context, offset);
+    };
+    // Byte-swap each word, from guest order or from a fully reversed vector
+    static const int guest_words[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    static const int reversed_words[16] = {12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3};
+    
+    for (int reg = 0; reg < 32; reg++) {
+        if (state.gprs & (1u << reg)) {
+            builder.CreateStore(builder.CreateLoad(i64_ty, gprs[reg]),
+                                field(offsetof(oc_ppu_context_t, gpr) + reg * sizeof(uint64_t)));
+        }
+        if (state.fprs & (1u << reg)) {
+            builder.CreateStore(builder.CreateLoad(builder.getDoubleTy(), fprs[reg]),
+                                field(offsetof(oc_ppu_context_t, fpr) + reg * sizeof(double)));
+        }
+        if (state.vrs & (1u << reg)) {
+            llvm::Value* bytes = builder.CreateLoad(v16i8_ty, vrs[reg]);
+            bytes = builder.CreateShuffleVector(bytes, bytes,
+                (vrs_reversed & (1u << reg)) ? reversed_words : guest_words);
+            builder.CreateAlignedStore(bytes,
+                field(offsetof(oc_ppu_context_t, vr) + reg * 4 * sizeof(uint32_t)), llvm::MaybeAlign(4));
+        }
+    }
+    if (state.materialized & OC_PPU_DEOPT_CR) {
+        builder.CreateStore(builder.CreateLoad(i32_ty, cr_ptr), field(offsetof(oc_ppu_context_t, cr)));
+    }
+    if (state.materialized & OC_PPU_DEOPT_LR) {
+        builder.CreateStore(builder.CreateLoad(i64_ty, lr_ptr), field(offsetof(oc_ppu_context_t, lr)));
+    }
+    if (state.materialized & OC_PPU_DEOPT_CTR) {
+        builder.CreateStore(builder.CreateLoad(i64_ty, ctr_ptr), field(offsetof(oc_ppu_context_t, ctr)));
+    }
+    if (state.materialized & OC_PPU_DEOPT_XER) {
+        builder.CreateStore(builder.CreateLoad(i64_ty, xer_ptr), field(offsetof(oc_ppu_context_t, xer)));
+    }
+    if (state.materialized & OC_PPU_DEOPT_VSCR) {
+        builder.CreateStore(builder.CreateLoad(i32_ty, vscr_ptr), field(offsetof(oc_ppu_context_t, vscr)));
+    }
+}
+
+/**
+ * Side exit of a failed guard: store the state the region changed to the
+ * context and leave with OC_PPU_EXIT_DEOPT so the dispatcher resumes at
+ * resume_pc
+ */
+static void emit_deopt_exit(llvm::IRBuilder<>& builder, llvm::Value* context,
+                            const DeoptState& state, uint32_t vrs_reversed,
+                            llvm::Value** gprs, llvm::Value** fprs, llvm::Value** vrs,
+                            llvm::Value* cr_ptr, llvm::Value* lr_ptr, llvm::Value* ctr_ptr,
+                            llvm::Value* xer_ptr, llvm::Value* vscr_ptr,
+                            uint32_t guard_id, uint32_t resume_pc) {
+    store_guest_state(builder, context, state, vrs_reversed, gprs, fprs, vrs,
+                      cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr);
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), context, offset);
+    };
+    builder.CreateStore(builder.getInt32(OC_PPU_EXIT_DEOPT), field(offsetof(oc_ppu_context_t, exit_reason)));
+    builder.CreateStore(builder.getInt64(resume_pc), field(offsetof(oc_ppu_context_t, next_pc)));
+    builder.CreateStore(builder.getInt32(guard_id), field(offsetof(oc_ppu_context_t, deopt_guard)));
+    builder.CreateRetVoid();
+}
+
+/**
+ * Reverse the 16 bytes of each VR in the mask, switching it between guest
+ * order and host-order elements (a single pshufb on x86)
+ */
+static void emit_vr_reverse(llvm::IRBuilder<>& builder, llvm::Value** vrs, uint32_t mask) {
+    auto v16i8_ty = llvm::VectorType::get(builder.getInt8Ty(), 16, false);
+    static const int reverse_mask[16] = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+    for (int reg = 0; reg < 32; reg++) {
+        if (!(mask & (1u << reg))) continue;
+        llvm::Value* bytes = builder.CreateLoad(v16i8_ty, vrs[reg]);
+        builder.CreateStore(builder.CreateShuffleVector(bytes, bytes, reverse_mask), vrs[reg]);
+    }
+}
+
+/**
+ * Whether the bc instr is taken, evaluated after the bc itself has
+ * decremented CTR: the CTR condition unless BO ignores it, and the CR bit
+ * unless BO ignores it
+ */
+static llvm::Value* emit_branch_taken(llvm::IRBuilder<>& builder, uint32_t instr,
+                                      llvm::Value* cr_ptr, llvm::Value* ctr_ptr) {
+    uint8_t bo = (instr >> 21) & 0x1F;
+    uint8_t bi = (instr >> 16) & 0x1F;
+    llvm::Value* taken = builder.getTrue();
+    if (!(bo & 0x04)) {
+        llvm::Value* ctr_zero = builder.CreateICmpEQ(
+            builder.CreateLoad(builder.getInt64Ty(), ctr_ptr), builder.getInt64(0));
+        taken = (bo & 0x02) ? ctr_zero : builder.CreateNot(ctr_zero);
+    }
+    if (!(bo & 0x10)) {
+        llvm::Value* bit = builder.CreateAnd(
+            builder.CreateLShr(builder.CreateLoad(builder.getInt32Ty(), cr_ptr), 31 - bi),
+            builder.getInt32(1));
+        taken = builder.CreateAnd(taken, builder.CreateICmpEQ(bit, builder.getInt32((bo & 0x08) ? 1 : 0)));
+    }
+    return taken;
+}
+
+/**
+ * Where a region goes after its closing instruction
+ *
+ * A branch stores its taken or fall-through target in next_pc; the
+ * condition is evaluated after the branch has decremented CTR, and a bclr
+ * goes to lr_before, LR as it was before a bclrl overwrote it. An sc exits
+ * with OC_PPU_EXIT_SYSCALL at the sc itself so the interpreter performs
+ * it. Any other instruction leaves the region end the dispatcher put in
+ * next_pc.
+ */
+static void emit_region_successor(llvm::IRBuilder<>& builder, llvm::Value* context, uint32_t instr,
+                                  uint32_t pc, llvm::Value* lr_before,
+                                  llvm::Value* cr_ptr, llvm::Value* ctr_ptr) {
+    auto i64_ty = builder.getInt64Ty();
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), context, offset);
+    };
+    uint8_t opcode = (instr >> 26) & 0x3F;
+    uint16_t xo = (instr >> 1) & 0x3FF;
+    bool absolute = (instr >> 1) & 1;
+    
+    llvm::Value* target;
+    llvm::Value* taken;
+    if (opcode == 18) {  // b
+        int32_t li = ((int32_t)(instr & 0x03FFFFFC) << 6) >> 6;
+        target = builder.getInt64(static_cast<uint32_t>(absolute ? li : pc + li));
+        taken = builder.getTrue();
+    } else if (opcode == 16) {  // bc
+        int32_t bd = static_cast<int16_t>(instr & 0xFFFC);
+        target = builder.getInt64(static_cast<uint32_t>(absolute ? bd : pc + bd));
+        taken = emit_branch_taken(builder, instr, cr_ptr, ctr_ptr);
+    } else if (opcode == 19 && (xo == 16 || xo == 528)) {  // bclr, bcctr
+        llvm::Value* base = xo == 16 ? lr_before : builder.CreateLoad(i64_ty, ctr_ptr);
+        target = builder.CreateAnd(base, builder.getInt64(~3ULL));
+        taken = emit_branch_taken(builder, instr, cr_ptr, ctr_ptr);
+    } else if (opcode == 17) {  // sc
+        builder.CreateStore(builder.getInt32(OC_PPU_EXIT_SYSCALL), field(offsetof(oc_ppu_context_t, exit_reason)));
+        builder.CreateStore(builder.getInt64(pc), field(offsetof(oc_ppu_context_t, next_pc)));
+        return;
+    } else {
+        // Falls through: a region entered by a chained jump has no
+        // dispatcher-supplied next_pc to leave in place
+        builder.CreateStore(builder.getInt64(pc + 4), field(offsetof(oc_ppu_context_t, next_pc)));
+        return;
+    }
+    builder.CreateStore(builder.CreateSelect(taken, target, builder.getInt64(pc + 4)),
+                        field(offsetof(oc_ppu_context_t, next_pc)));
+}
+
+/**
+ * Continue in the code published in *slot, when it is set and cond holds,
+ * by a tail call passing the context and memory base on; otherwise fall
+ * through. The slot is one of the block's BlockLinks, which the cache keeps
+ * for as long as the code.
+ */
+static void emit_slot_tail_call(llvm::IRBuilder<>& builder, std::atomic<void*>* slot,
+                                llvm::Value* cond, const char* name) {
+    auto& ctx = builder.getContext();
+    llvm::Function* func = builder.GetInsertBlock()->getParent();
+    llvm::FunctionType* func_ty = func->getFunctionType();
+    auto ptr_ty = llvm::PointerType::get(builder.getInt8Ty(), 0);
+    
+    llvm::Value* slot_ptr = builder.CreateIntToPtr(
+        builder.getInt64(reinterpret_cast<uintptr_t>(slot)), llvm::PointerType::get(ptr_ty, 0));
+    llvm::LoadInst* entry = builder.CreateAlignedLoad(ptr_ty, slot_ptr, llvm::MaybeAlign(alignof(void*)),
+                                                      name);
+    entry->setAtomic(llvm::AtomicOrdering::Acquire);
+    llvm::Value* enter = builder.CreateICmpNE(entry, llvm::ConstantPointerNull::get(ptr_ty));
+    if (cond) enter = builder.CreateAnd(cond, enter);
+    
+    llvm::BasicBlock* call_bb = llvm::BasicBlock::Create(ctx, name, func);
+    llvm::BasicBlock* done_bb = llvm::BasicBlock::Create(ctx, "done", func);
+    builder.CreateCondBr(enter, call_bb, done_bb);
+    
+    builder.SetInsertPoint(call_bb);
+    llvm::CallInst* call = builder.CreateCall(func_ty,
+        builder.CreateBitCast(entry, llvm::PointerType::get(func_ty, 0)), {func->getArg(0), func->getArg(1)});
+    call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+    builder.CreateRetVoid();
+    
+    builder.SetInsertPoint(done_bb);
+}
+
 /**
  * Create LLVM function for basic block with optimization passes
+ *
+ * Registers are loaded from the context on entry, and the ones the region
+ * changes are stored back at its exit.
+ *
+ * When frame analysis proved r1 stable, promoted stack slots live in allocas
+ * that mem2reg turns into SSA values. They are loaded from guest memory on
+ * entry only if read before written, and dirty slots are written back before
+ * branches, system calls and the region exit.
+ *
+ * VR values are reversed only at the points chosen by the VMX swap plan,
+ * and idioms from the idiom plan replace the instructions they cover.
+ *
+ * Each speculation guard of the block branches to its own side exit, which
+ * writes the guest state changed up to the guard back to the context.
+ *
+ * The closing branch sets next_pc from its own condition. A closing
+ * back-edge, once the region's tier-2 loop is ready, continues there when
+ * taken; a guarded bctr continues in its predicted target once the
+ * dispatcher has linked it.
  */
-static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* block) {
+static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* block,
+                                            const StackFrameInfo* frame,
+                                            const VmxSwapPlan* vmx,
+                                            const IdiomPlan* idioms) {
     auto& ctx = module->getContext();
     
     // Function type: void(void* ppu_state, void* memory)
@@ -7818,7 +11597,7 @@ static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* bl
     llvm::FunctionType* func_ty = llvm::FunctionType::get(void_ty, {ptr_ty, ptr_ty}, false);
     
     // Create function
-    std::string func_name = "ppu_block_" + std::to_string(block->start_address);
+    std::string func_name = block_symbol("ppu_block_", block);
     llvm::Function* func = llvm::Function::Create(func_ty,
         llvm::Function::ExternalLinkage, func_name, module);
     
@@ -7833,18 +11612,30 @@ static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* bl
     auto f32_ty = llvm::Type::getFloatTy(ctx);
     auto v4f32_ty = llvm::VectorType::get(f32_ty, 4, false);  // 128-bit vector as 4 x float
     
+    auto v16i8_ty = llvm::VectorType::get(llvm::Type::getInt8Ty(ctx), 16, false);
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(llvm::Type::getInt8Ty(ctx), func->getArg(0), offset);
+    };
+    // Context VRs hold host-order words; the allocas hold guest byte order
+    static const int guest_words[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    
     llvm::Value* gprs[32];
     llvm::Value* fprs[32];
     llvm::Value* vrs[32];  // Vector registers for VMX
     
+    // Registers start out as the guest state in the context; loads of
+    // registers the region never reads are deleted by the optimizer
     for (int i = 0; i < 32; i++) {
         gprs[i] = builder.CreateAlloca(i64_ty, nullptr, "gpr" + std::to_string(i));
         fprs[i] = builder.CreateAlloca(f64_ty, nullptr, "fpr" + std::to_string(i));
         vrs[i] = builder.CreateAlloca(v4f32_ty, nullptr, "vr" + std::to_string(i));
-        // Initialize to zero
-        builder.CreateStore(llvm::ConstantInt::get(i64_ty, 0), gprs[i]);
-        builder.CreateStore(llvm::ConstantFP::get(f64_ty, 0.0), fprs[i]);
-        builder.CreateStore(llvm::ConstantAggregateZero::get(v4f32_ty), vrs[i]);
+        builder.CreateStore(builder.CreateLoad(i64_ty,
+            field(offsetof(oc_ppu_context_t, gpr) + i * sizeof(uint64_t))), gprs[i]);
+        builder.CreateStore(builder.CreateLoad(f64_ty,
+            field(offsetof(oc_ppu_context_t, fpr) + i * sizeof(double))), fprs[i]);
+        llvm::Value* bytes = builder.CreateAlignedLoad(v16i8_ty,
+            field(offsetof(oc_ppu_context_t, vr) + i * 4 * sizeof(uint32_t)), llvm::MaybeAlign(4));
+        builder.CreateStore(builder.CreateShuffleVector(bytes, bytes, guest_words), vrs[i]);
     }
     
     // Allocate special registers
@@ -7853,24 +11644,209 @@ static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* bl
     llvm::Value* ctr_ptr = builder.CreateAlloca(i64_ty, nullptr, "ctr");
     llvm::Value* xer_ptr = builder.CreateAlloca(i64_ty, nullptr, "xer");
     llvm::Value* vscr_ptr = builder.CreateAlloca(i32_ty, nullptr, "vscr");  // Vector Status and Control Register
-    
-    // Initialize special registers to zero
-    builder.CreateStore(llvm::ConstantInt::get(i32_ty, 0), cr_ptr);
-    builder.CreateStore(llvm::ConstantInt::get(i64_ty, 0), lr_ptr);
-    builder.CreateStore(llvm::ConstantInt::get(i64_ty, 0), ctr_ptr);
-    builder.CreateStore(llvm::ConstantInt::get(i64_ty, 0), xer_ptr);
-    builder.CreateStore(llvm::ConstantInt::get(i32_ty, 0), vscr_ptr);
+    builder.CreateStore(builder.CreateLoad(i32_ty, field(offsetof(oc_ppu_context_t, cr))), cr_ptr);
+    builder.CreateStore(builder.CreateLoad(i64_ty, field(offsetof(oc_ppu_context_t, lr))), lr_ptr);
+    builder.CreateStore(builder.CreateLoad(i64_ty, field(offsetof(oc_ppu_context_t, ctr))), ctr_ptr);
+    builder.CreateStore(builder.CreateLoad(i64_ty, field(offsetof(oc_ppu_context_t, xer))), xer_ptr);
+    builder.CreateStore(builder.CreateLoad(i32_ty, field(offsetof(oc_ppu_context_t, vscr))), vscr_ptr);
     
     // Get memory base pointer from function argument
     llvm::Value* memory_base = func->getArg(1);
     
+    // Stores to the register allocas from here on change guest state, which
+    // side exits and the region exit have to write back
+    std::unordered_map<const llvm::Value*, std::pair<int, uint32_t>> reg_of;
+    std::unordered_set<const llvm::Instruction*> untracked_stores;
+    for (uint32_t i = 0; i < 32; i++) {
+        reg_of[gprs[i]] = {0, i};
+        reg_of[fprs[i]] = {1, i};
+        reg_of[vrs[i]] = {2, i};
+    }
+    reg_of[cr_ptr] = {3, OC_PPU_DEOPT_CR};
+    reg_of[lr_ptr] = {3, OC_PPU_DEOPT_LR};
+    reg_of[ctr_ptr] = {3, OC_PPU_DEOPT_CTR};
+    reg_of[xer_ptr] = {3, OC_PPU_DEOPT_XER};
+    reg_of[vscr_ptr] = {3, OC_PPU_DEOPT_VSCR};
+    for (auto& inst : *entry_bb) {
+        if (llvm::isa<llvm::StoreInst>(inst)) untracked_stores.insert(&inst);
+    }
+    
+    // Region entry: give the scheduler a chance to stop us before doing work
+    emit_preemption_check(builder, func->getArg(0),
+                          static_cast<uint32_t>(block->instructions.size()),
+                          block->start_address);
+    
+    // Promoted stack slots are addressed relative to r1 at region entry
+    bool promote_stack = frame && frame->can_promote();
+    std::vector<llvm::Value*> slot_allocas;
+    llvm::Value* r1_entry = nullptr;
+    auto slot_guest_ptr = [&](const StackSlot& slot) {
+        llvm::Value* addr = builder.CreateAdd(r1_entry,
+            llvm::ConstantInt::get(i64_ty, (int64_t)slot.offset));
+        llvm::Value* ptr = builder.CreateGEP(llvm::Type::getInt8Ty(ctx), memory_base, addr);
+        auto slot_ty = llvm::IntegerType::get(ctx, slot.size * 8);
+        return builder.CreateBitCast(ptr, llvm::PointerType::get(slot_ty, 0));
+    };
+    if (promote_stack) {
+        r1_entry = builder.CreateLoad(i64_ty, gprs[1], "r1_entry");
+        for (const auto& slot : frame->slots) {
+            auto slot_ty = llvm::IntegerType::get(ctx, slot.size * 8);
+            llvm::Value* slot_alloca = builder.CreateAlloca(slot_ty, nullptr,
+                "stack_slot" + std::to_string(slot_allocas.size()));
+            if (slot.read_before_write) {
+                builder.CreateStore(builder.CreateLoad(slot_ty, slot_guest_ptr(slot)),
+                                    slot_alloca);
+            }
+            slot_allocas.push_back(slot_alloca);
+        }
+    }
+    bool stack_dirty = false;
+    auto store_stack_slots = [&]() {
+        for (size_t s = 0; s < frame->slots.size(); s++) {
+            const StackSlot& slot = frame->slots[s];
+            if (!slot.written) continue;
+            auto slot_ty = llvm::IntegerType::get(ctx, slot.size * 8);
+            builder.CreateStore(builder.CreateLoad(slot_ty, slot_allocas[s]),
+                                slot_guest_ptr(slot));
+        }
+    };
+    auto write_back_stack = [&]() {
+        if (!stack_dirty) return;
+        store_stack_slots();
+        stack_dirty = false;
+    };
+    
+    // A guard branches to a side exit when its speculation does not hold and
+    // otherwise lets the region use the speculated value
+    std::unordered_map<size_t, uint64_t> known_targets;  // bcctr index -> target
+    auto emit_guard = [&](uint32_t id) {
+        GuardSite& site = block->guards[id];
+        llvm::Value* context = func->getArg(0);
+        llvm::Value* holds;
+        if (site.kind == GuardKind::RegisterValue) {
+            llvm::Value* actual = builder.CreateLoad(i64_ty, gprs[site.reg]);
+            holds = builder.CreateICmpEQ(actual, builder.getInt64(site.expected));
+        } else {
+            llvm::Value* ctr = builder.CreateAnd(builder.CreateLoad(i64_ty, ctr_ptr), builder.getInt64(~3ULL));
+            holds = builder.CreateICmpEQ(ctr, builder.getInt64(site.expected));
+            known_targets[site.index] = site.expected;
+        }
+        
+        site.state = collect_written_state(func, reg_of, untracked_stores);
+        if (stack_dirty) site.state.materialized |= OC_PPU_DEOPT_STACK_SLOTS;
+        uint32_t vrs_reversed = 0;
+        if (vmx && vmx->vector_instructions && site.state.vrs) {
+            std::vector<uint32_t> prefix(block->instructions.begin(),
+                                         block->instructions.begin() + site.index);
+            vrs_reversed = plan_vmx_byte_order(prefix).reversed_at_end;
+        }
+        
+        llvm::BasicBlock* deopt_bb = llvm::BasicBlock::Create(ctx, "deopt" + std::to_string(id), func);
+        llvm::BasicBlock* cont_bb = llvm::BasicBlock::Create(ctx, "guarded" + std::to_string(id), func);
+        llvm::MDBuilder md(ctx);
+        builder.CreateCondBr(holds, cont_bb, deopt_bb, md.createBranchWeights(1000, 1));
+        builder.SetInsertPoint(deopt_bb);
+        if (stack_dirty) store_stack_slots();
+        emit_deopt_exit(builder, context, site.state, vrs_reversed, gprs, fprs, vrs,
+                        cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr, id, site.guest_pc);
+        
+        builder.SetInsertPoint(cont_bb);
+        if (site.kind == GuardKind::RegisterValue) {
+            // Known equal to the context value, not a change the region made
+            untracked_stores.insert(builder.CreateStore(builder.getInt64(site.expected),
+                                                        gprs[site.reg]));
+        }
+    };
+    
     // Emit IR for each instruction
     uint64_t current_pc = block->start_address;
-    for (uint32_t instr : block->instructions) {
+    uint32_t next_guard = 0;
+    llvm::BasicBlock* switch_exit = nullptr;
+    for (size_t i = 0; i < block->instructions.size(); i++) {
+        uint32_t instr = block->instructions[i];
+        current_pc = block->address_of(i);
+        while (next_guard < block->guards.size() && block->guards[next_guard].index <= i) {
+            emit_guard(next_guard++);
+        }
+        if (promote_stack) {
+            auto promoted = frame->promoted.find(i);
+            if (promoted != frame->promoted.end()) {
+                emit_promoted_stack_access(builder, instr, slot_allocas[promoted->second],
+                                           gprs, fprs);
+                uint8_t opcode = (instr >> 26) & 0x3F;
+                stack_dirty |= opcode == 36 || opcode == 54 || opcode == 62;
+                current_pc += 4;
+                continue;
+            }
+            if (is_stack_sync_point(instr)) write_back_stack();
+        }
+        if (block->jump_table.valid()) {
+            // The bounds check branches around the dispatch sequence, and the
+            // bctr becomes a switch on the case index
+            if (i == block->jump_table.guard_index) {
+                switch_exit = emit_jump_table_bounds_check(builder, func->getArg(0), gprs,
+                                                           block->jump_table);
+                current_pc += 4;
+                continue;
+            }
+            if (i + 1 == block->instructions.size()) {
+                emit_jump_table_switch(builder, func->getArg(0), gprs, block->jump_table, switch_exit);
+                current_pc += 4;
+                continue;
+            }
+        }
+        if (vmx) {
+            auto swaps = vmx->swaps_before.find(i);
+            if (swaps != vmx->swaps_before.end()) emit_vr_reverse(builder, vrs, swaps->second);
+        }
+        if (idioms) {
+            auto idiom = idioms->at.find(i);
+            if (idiom != idioms->at.end()) {
+                size_t last = i + idiom->second.length - 1;
+                if (promote_stack && is_stack_sync_point(block->instructions[last])) {
+                    write_back_stack();
+                }
+                emit_ppc_idiom(builder, idiom->second, gprs, cr_ptr, xer_ptr, func->getArg(0),
+                               block->address_of(last));
+                i = last;
+                continue;
+            }
+        }
+        bool closing = i + 1 == block->instructions.size();
+        llvm::Value* lr_before = closing ? builder.CreateLoad(i64_ty, lr_ptr, "lr_before") : nullptr;
         emit_ppu_instruction(builder, instr, gprs, fprs, vrs, memory_base,
                             cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr, current_pc);
+        auto target = known_targets.find(i);
+        if (target != known_targets.end()) {
+            builder.CreateStore(builder.getInt64(target->second), builder.CreateConstInBoundsGEP1_64(
+                builder.getInt8Ty(), func->getArg(0), offsetof(oc_ppu_context_t, next_pc)));
+        } else if (closing) {
+            emit_region_successor(builder, func->getArg(0), instr, static_cast<uint32_t>(current_pc),
+                                  lr_before, cr_ptr, ctr_ptr);
+        }
         current_pc += 4; // PowerPC instructions are 4 bytes
     }
+    if (promote_stack) write_back_stack();
+    
+    // Region exit: store what the region changed
+    DeoptState exit_state = collect_written_state(func, reg_of, untracked_stores);
+    uint32_t exit_reversed = (vmx && vmx->vector_instructions) ? vmx->reversed_at_end : 0;
+    store_guest_state(builder, func->getArg(0), exit_state, exit_reversed, gprs, fprs, vrs,
+                      cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr);
+    
+    if (block->loop_header) {
+        // Upgrade check on the back-edge: once the tier-2 loop is published,
+        // continue there with the state just stored
+        llvm::Value* next_pc = builder.CreateLoad(i64_ty, builder.CreateConstInBoundsGEP1_64(
+            builder.getInt8Ty(), func->getArg(0), offsetof(oc_ppu_context_t, next_pc)));
+        emit_slot_tail_call(builder, &block->links->osr_entry,
+                            builder.CreateICmpEQ(next_pc, builder.getInt64(block->loop_header)), "osr");
+    } else if (!known_targets.empty()) {
+        // The branch guard held, so the region ends in a jump to the
+        // predicted target; follow it directly once the dispatcher has
+        // linked that block
+        emit_slot_tail_call(builder, &block->links->chain_entry, nullptr, "chain");
+    }
     
     // Return
     builder.CreateRetVoid();
@@ -7892,10 +11868,137 @@ static llvm::Function* create_llvm_function(llvm::Module* module, BasicBlock* bl
     return func;
 }
 
+/**
+ * Create the tier-2 loop of a region ending in a back-edge, entered from
+ * tier-1 code at the loop header
+ *
+ * The loop takes the guest state from the context, so it carries on from
+ * wherever tier 1 was, and stores all of it back when the loop exits or is
+ * preempted. Every iteration repeats the preemption check and charges the
+ * loop body to the budget. The region's stack slot, VMX, idiom and guard
+ * plans are left out; the loop is instead built for the optimizing
+ * pipeline.
+ */
+static llvm::Function* create_osr_function(llvm::Module* module, const BasicBlock* block) {
+    size_t header = loop_header_index(block, block->loop_header);
+    if (header == SIZE_MAX) return nullptr;
+    size_t last = block->instructions.size() - 1;
+    
+    auto& ctx = module->getContext();
+    auto void_ty = llvm::Type::getVoidTy(ctx);
+    auto ptr_ty = llvm::PointerType::get(llvm::Type::getInt8Ty(ctx), 0);
+    llvm::FunctionType* func_ty = llvm::FunctionType::get(void_ty, {ptr_ty, ptr_ty}, false);
+    std::string func_name = block_symbol("ppu_osr_", block);
+    llvm::Function* func = llvm::Function::Create(func_ty,
+        llvm::Function::ExternalLinkage, func_name, module);
+    
+    llvm::BasicBlock* entry_bb = llvm::BasicBlock::Create(ctx, "entry", func);
+    llvm::IRBuilder<> builder(entry_bb);
+    llvm::Value* context = func->getArg(0);
+    llvm::Value* memory_base = func->getArg(1);
+    auto i8_ty = builder.getInt8Ty();
+    auto i32_ty = builder.getInt32Ty();
+    auto i64_ty = builder.getInt64Ty();
+    auto f64_ty = builder.getDoubleTy();
+    auto v4f32_ty = llvm::VectorType::get(builder.getFloatTy(), 4, false);
+    auto v16i8_ty = llvm::VectorType::get(i8_ty, 16, false);
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(i8_ty, context, offset);
+    };
+    // Context VRs hold host-order words; the allocas hold guest byte order
+    static const int guest_words[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    
+    llvm::Value* gprs[32];
+    llvm::Value* fprs[32];
+    llvm::Value* vrs[32];
+    for (int i = 0; i < 32; i++) {
+        gprs[i] = builder.CreateAlloca(i64_ty, nullptr, "gpr" + std::to_string(i));
+        fprs[i] = builder.CreateAlloca(f64_ty, nullptr, "fpr" + std::to_string(i));
+        vrs[i] = builder.CreateAlloca(v4f32_ty, nullptr, "vr" + std::to_string(i));
+        builder.CreateStore(builder.CreateLoad(i64_ty,
+            field(offsetof(oc_ppu_context_t, gpr) + i * sizeof(uint64_t))), gprs[i]);
+        builder.CreateStore(builder.CreateLoad(f64_ty,
+            field(offsetof(oc_ppu_context_t, fpr) + i * sizeof(double))), fprs[i]);
+        llvm::Value* bytes = builder.CreateAlignedLoad(v16i8_ty,
+            field(offsetof(oc_ppu_context_t, vr) + i * 4 * sizeof(uint32_t)), llvm::MaybeAlign(4));
+        builder.CreateStore(builder.CreateShuffleVector(bytes, bytes, guest_words), vrs[i]);
+    }
+    llvm::Value* cr_ptr = builder.CreateAlloca(i32_ty, nullptr, "cr");
+    llvm::Value* lr_ptr = builder.CreateAlloca(i64_ty, nullptr, "lr");
+    llvm::Value* ctr_ptr = builder.CreateAlloca(i64_ty, nullptr, "ctr");
+    llvm::Value* xer_ptr = builder.CreateAlloca(i64_ty, nullptr, "xer");
+    llvm::Value* vscr_ptr = builder.CreateAlloca(i32_ty, nullptr, "vscr");
+    builder.CreateStore(builder.CreateLoad(i32_ty, field(offsetof(oc_ppu_context_t, cr))), cr_ptr);
+    builder.CreateStore(builder.CreateLoad(i64_ty, field(offsetof(oc_ppu_context_t, lr))), lr_ptr);
+    builder.CreateStore(builder.CreateLoad(i64_ty, field(offsetof(oc_ppu_context_t, ctr))), ctr_ptr);
+    builder.CreateStore(builder.CreateLoad(i64_ty, field(offsetof(oc_ppu_context_t, xer))), xer_ptr);
+    builder.CreateStore(builder.CreateLoad(i32_ty, field(offsetof(oc_ppu_context_t, vscr))), vscr_ptr);
+    
+    DeoptState all;
+    all.gprs = all.fprs = all.vrs = ~0u;
+    all.materialized = OC_PPU_DEOPT_CR | OC_PPU_DEOPT_LR | OC_PPU_DEOPT_CTR |
+                       OC_PPU_DEOPT_XER | OC_PPU_DEOPT_VSCR;
+    
+    llvm::Value* iterations = builder.CreateAlloca(i32_ty, nullptr, "iterations");
+    builder.CreateStore(builder.getInt32(0), iterations);
+    
+    llvm::BasicBlock* header_bb = llvm::BasicBlock::Create(ctx, "loop_header", func);
+    builder.CreateBr(header_bb);
+    builder.SetInsertPoint(header_bb);
+    llvm::BasicBlock* preempt_bb = nullptr;
+    emit_preemption_check(builder, context, static_cast<uint32_t>(last - header + 1),
+                          block->loop_header, &preempt_bb);
+    {
+        llvm::IRBuilder<> exit_builder(preempt_bb->getTerminator());
+        store_guest_state(exit_builder, context, all, 0, gprs, fprs, vrs,
+                          cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr);
+    }
+    
+    for (size_t i = header; i <= last; i++) {
+        emit_ppu_instruction(builder, block->instructions[i], gprs, fprs, vrs, memory_base,
+                             cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr, block->address_of(i));
+    }
+    llvm::Value* taken = emit_branch_taken(builder, block->instructions[last], cr_ptr, ctr_ptr);
+    llvm::BasicBlock* back_edge_bb = llvm::BasicBlock::Create(ctx, "back_edge", func);
+    llvm::BasicBlock* exit_bb = llvm::BasicBlock::Create(ctx, "loop_exit", func);
+    builder.CreateCondBr(taken, back_edge_bb, exit_bb);
+    
+    builder.SetInsertPoint(back_edge_bb);
+    llvm::Value* count = builder.CreateAdd(builder.CreateLoad(i32_ty, iterations), builder.getInt32(1));
+    builder.CreateStore(count, iterations);
+    llvm::Value* unbudgeted = builder.CreateICmpEQ(
+        builder.CreateLoad(i32_ty, field(offsetof(oc_ppu_context_t, budget_enabled))), builder.getInt32(0));
+    llvm::Value* yield = builder.CreateAnd(unbudgeted,
+        builder.CreateICmpUGE(count, builder.getInt32(OsrManager::UNBUDGETED_ITERATIONS)));
+    llvm::BasicBlock* yield_bb = llvm::BasicBlock::Create(ctx, "yield", func);
+    builder.CreateCondBr(yield, yield_bb, header_bb);
+    
+    builder.SetInsertPoint(yield_bb);
+    store_guest_state(builder, context, all, 0, gprs, fprs, vrs,
+                      cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr);
+    builder.CreateStore(builder.getInt64(block->loop_header), field(offsetof(oc_ppu_context_t, next_pc)));
+    builder.CreateRetVoid();
+    
+    builder.SetInsertPoint(exit_bb);
+    store_guest_state(builder, context, all, 0, gprs, fprs, vrs,
+                      cr_ptr, lr_ptr, ctr_ptr, xer_ptr, vscr_ptr);
+    builder.CreateStore(builder.getInt64(block->address_of(last) + 4),
+                        field(offsetof(oc_ppu_context_t, next_pc)));
+    builder.CreateRetVoid();
+    
+    std::string error_str;
+    llvm::raw_string_ostream error_stream(error_str);
+    if (llvm::verifyFunction(*func, &error_stream)) {
+        func->eraseFromParent();
+        return nullptr;
+    }
+    return func;
+}
+
 /**
  * Apply optimization passes to the module
  */
-static void apply_optimization_passes(llvm::Module* module) {
+static void apply_optimization_passes(llvm::Module* module, int pipeline) {
     // Create pass managers
     llvm::LoopAnalysisManager LAM;
     llvm::FunctionAnalysisManager FAM;
@@ -7912,8 +12015,30 @@ static void apply_optimization_passes(llvm::Module* module) {
     PB.registerLoopAnalyses(LAM);
     PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
     
-    // Build optimization pipeline (O2 level)
-    llvm::ModulePassManager MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+    // Build the selected optimization pipeline
+    llvm::ModulePassManager MPM;
+    switch (pipeline) {
+        case OC_PPU_PASS_PIPELINE_O0:
+            MPM = PB.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+            break;
+        case OC_PPU_PASS_PIPELINE_O1:
+            MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O1);
+            break;
+        case OC_PPU_PASS_PIPELINE_O3:
+            MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+            break;
+        case OC_PPU_PASS_PIPELINE_BASELINE:
+            // Cheap cleanup only: the IR is straight-line per block, so
+            // promoting allocas and folding redundancies gets most of the win
+            if (auto err = PB.parsePassPipeline(MPM, "function(sroa,early-cse,instcombine,simplifycfg)")) {
+                llvm::consumeError(std::move(err));
+                MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O1);
+            }
+            break;
+        default:
+            MPM = PB.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+            break;
+    }
     
     // Run optimization passes
     MPM.run(*module, MAM);
@@ -7945,15 +12070,9 @@ oc_ppu_jit_t* oc_ppu_jit_create(void) {
 }
 
 void oc_ppu_jit_destroy(oc_ppu_jit_t* jit) {
-    if (jit) {
-        // Clean up compiled code
-        for (auto& pair : jit->cache.blocks) {
-            if (pair.second->compiled_code) {
-                free(pair.second->compiled_code);
-            }
-        }
-        delete jit;
-    }
+    if (jit) unwatch_all_code(jit);
+    // Blocks free their own compiled code
+    delete jit;
 }
 
 int oc_ppu_jit_compile(oc_ppu_jit_t* jit, uint32_t address, 
@@ -7967,7 +12086,7 @@ int oc_ppu_jit_compile(oc_ppu_jit_t* jit, uint32_t address,
     }
     
     // Check if already compiled
-    if (jit->cache.find_block(address)) {
+    if (jit->cache.contains(address)) {
         return 0; // Already compiled
     }
     
@@ -7975,11 +12094,12 @@ int oc_ppu_jit_compile(oc_ppu_jit_t* jit, uint32_t address,
     auto block = std::make_unique<BasicBlock>(address);
     
     // Step 1: Identify basic block boundaries
-    identify_basic_block(code, size, block.get());
+    identify_region(jit, code, size, block.get());
     
     if (block->instructions.empty()) {
         return -3; // No instructions found — fallback to interpreter
     }
+    CodeSnapshot snapshot = snapshot_block_source(jit, block.get());
     
     // Step 2: Generate LLVM IR (with fallback to interpreter placeholder)
     generate_llvm_ir(block.get(), jit);
@@ -7987,46 +12107,279 @@ int oc_ppu_jit_compile(oc_ppu_jit_t* jit, uint32_t address,
     // Step 3: Emit machine code
     emit_machine_code(block.get());
     
-    // Step 4: Verify compilation succeeded
-    if (!block->compiled_code) {
-        return -4; // Compilation failed — caller should use interpreter
+    // Step 4: Verify compilation succeeded
+    if (!block->compiled_code) {
+        return -4; // Compilation failed — caller should use interpreter
+    }
+    
+    // Step 5: Cache the compiled block. If another thread compiled the same
+    // address in the meantime its block is kept and ours is dropped.
+    cache_compiled_block(jit, address, std::move(block), snapshot);
+    
+    return 0;
+}
+
+void* oc_ppu_jit_get_compiled(oc_ppu_jit_t* jit, uint32_t address) {
+    if (!jit) return nullptr;
+    
+    CodeCache::ReadGuard guard(jit->cache);
+    BasicBlock* block = jit->cache.find_block(address);
+    return block ? jit->cache.export_code(block) : nullptr;
+}
+
+int oc_ppu_jit_is_compiled(oc_ppu_jit_t* jit, uint32_t address) {
+    if (!jit) return 0;
+    
+    CodeCache::ReadGuard guard(jit->cache);
+    BasicBlock* block = jit->cache.find_block(address);
+    return (block && block->compiled_code) ? 1 : 0;
+}
+
+void oc_ppu_jit_invalidate(oc_ppu_jit_t* jit, uint32_t address) {
+    if (!jit) return;
+    
+    jit->block_linker.unlink_target(address);
+    jit->block_linker.remove_source_dependencies(address);
+    jit->cache.invalidate(address);
+    
+    // Callers holding an inlined copy of this code, or dispatching through a
+    // table here, go with it
+    for (uint32_t caller : jit->block_linker.source_dependents(address, address + 4)) {
+        oc_ppu_jit_invalidate(jit, caller);
+    }
+}
+
+void oc_ppu_jit_clear_cache(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    
+    jit->cache.clear();
+}
+
+void oc_ppu_jit_smc_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->smc_watcher.enabled.store(enable != 0, std::memory_order_relaxed);
+}
+
+int oc_ppu_jit_smc_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->smc_watcher.enabled.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+void oc_ppu_jit_smc_get_stats(oc_ppu_jit_t* jit, uint64_t* watched_chunks,
+                              uint64_t* writes_detected, uint64_t* blocks_invalidated) {
+    if (watched_chunks) *watched_chunks = 0;
+    if (writes_detected) *writes_detected = 0;
+    if (blocks_invalidated) *blocks_invalidated = 0;
+    if (!jit) return;
+    
+    auto& watcher = jit->smc_watcher;
+    {
+        oc_lock_guard<oc_mutex> lock(watcher.mutex);
+        if (watched_chunks) *watched_chunks = watcher.watches.size();
+    }
+    if (writes_detected) *writes_detected = watcher.writes_detected.load();
+    if (blocks_invalidated) *blocks_invalidated = watcher.blocks_invalidated.load();
+}
+
+int oc_ppu_jit_set_pass_pipeline(oc_ppu_jit_t* jit, int pipeline) {
+    if (!jit) return -1;
+    if (pipeline < OC_PPU_PASS_PIPELINE_O0 || pipeline > OC_PPU_PASS_PIPELINE_BASELINE) {
+        return -1;
+    }
+    jit->pass_pipeline.store(pipeline, std::memory_order_relaxed);
+    return 0;
+}
+
+int oc_ppu_jit_get_pass_pipeline(oc_ppu_jit_t* jit) {
+    if (!jit) return OC_PPU_PASS_PIPELINE_O2;
+    return jit->pass_pipeline.load(std::memory_order_relaxed);
+}
+
+int oc_ppu_jit_corpus_begin(oc_ppu_jit_t* jit, const char* path) {
+    if (!jit || !path) return -1;
+    return jit->corpus.begin(path);
+}
+
+void oc_ppu_jit_corpus_end(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->corpus.end();
+}
+
+uint64_t oc_ppu_jit_corpus_get_count(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    oc_lock_guard<oc_mutex> lock(jit->corpus.mutex);
+    return jit->corpus.units_written;
+}
+
+#ifdef HAVE_LLVM
+/**
+ * Sum of the text section sizes of an emitted object
+ */
+static uint64_t object_text_bytes(const llvm::MemoryBuffer& object) {
+    auto file = llvm::object::ObjectFile::createObjectFile(object.getMemBufferRef());
+    if (!file) {
+        llvm::consumeError(file.takeError());
+        return 0;
+    }
+    uint64_t bytes = 0;
+    for (const auto& section : (*file)->sections()) {
+        if (section.isText()) bytes += section.getSize();
+    }
+    return bytes;
+}
+
+/**
+ * Compile a rebuilt unit to a relocatable object with the current pass
+ * pipeline. A private module keeps repeated compiles of one unit from
+ * colliding with each other or with the JIT's own symbols.
+ */
+static std::unique_ptr<llvm::MemoryBuffer> compile_unit_object(oc_ppu_jit_t* jit, BasicBlock* block,
+                                                               uint64_t* ir_before, uint64_t* ir_after) {
+    oc_lock_guard<oc_mutex> codegen_lock(jit->codegen_mutex);
+    if (!jit->context || !jit->orc_manager.target_machine) return nullptr;
+    
+    llvm::TargetMachine& tm = *jit->orc_manager.target_machine;
+    llvm::Module module("ppu_compile_unit", *jit->context);
+    module.setDataLayout(tm.createDataLayout());
+    module.setTargetTriple(tm.getTargetTriple().str());
+    
+    llvm::Function* func = create_block_function(jit, &module, block);
+    if (!func) return nullptr;
+    std::string name = func->getName().str();
+    if (ir_before) *ir_before = func->getInstructionCount();
+    apply_optimization_passes(&module, jit->pass_pipeline.load(std::memory_order_relaxed));
+    if (llvm::Function* optimized = module.getFunction(name)) {
+        if (ir_after) *ir_after = optimized->getInstructionCount();
+    }
+    
+    llvm::orc::SimpleCompiler compiler(tm);
+    auto object = compiler(module);
+    if (!object) {
+        llvm::consumeError(object.takeError());
+        return nullptr;
+    }
+    return std::move(*object);
+}
+#endif
+
+int oc_ppu_jit_compile_unit(oc_ppu_jit_t* jit, const oc_ppu_corpus_unit_t* unit,
+                            const uint32_t* payload, oc_ppu_compile_metrics_t* metrics) {
+    if (metrics) std::memset(metrics, 0, sizeof(*metrics));
+    if (!jit || !unit || !payload || unit->instruction_count == 0) return -1;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    // Rebuild the unit as region formation left it
+    BasicBlock block(unit->address);
+    deserialize_unit(unit, payload, block);
+    
+    uint64_t ir_before = 0;
+    uint64_t ir_after = 0;
+    uint64_t host_bytes = 0;
+    bool native = false;
+    
+#ifdef HAVE_LLVM
+    if (auto object = compile_unit_object(jit, &block, &ir_before, &ir_after)) {
+        host_bytes = object_text_bytes(*object);
+        native = true;
+    }
+#endif
+    
+    if (!native) {
+        allocate_placeholder_code(&block);
+        host_bytes = block.code_size;
     }
     
-    // Step 5: Cache the compiled block
-    jit->cache.insert_block(address, std::move(block));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (metrics) {
+        metrics->guest_instructions = unit->instruction_count;
+        metrics->native = native ? 1 : 0;
+        metrics->ir_instructions_before = ir_before;
+        metrics->ir_instructions_after = ir_after;
+        metrics->host_bytes = host_bytes;
+        metrics->compile_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    return native ? 0 : 1;
+}
+
+int64_t oc_ppu_jit_compile_object(oc_ppu_jit_t* jit, const oc_ppu_corpus_unit_t* unit,
+                                  const uint32_t* payload, uint32_t symbol_version,
+                                  void* out, size_t capacity) {
+    if (!jit || !unit || !payload || unit->instruction_count == 0) return -1;
     
+#ifdef HAVE_LLVM
+    BasicBlock block(unit->address);
+    deserialize_unit(unit, payload, block);
+    block.symbol_version = symbol_version;
+    auto object = compile_unit_object(jit, &block, nullptr, nullptr);
+    if (!object) return 0;
+    size_t size = object->getBufferSize();
+    if (out && size <= capacity) {
+        std::memcpy(out, object->getBufferStart(), size);
+    }
+    return static_cast<int64_t>(size);
+#else
+    (void)symbol_version;
+    (void)out;
+    (void)capacity;
     return 0;
+#endif
 }
 
-void* oc_ppu_jit_get_compiled(oc_ppu_jit_t* jit, uint32_t address) {
-    if (!jit) return nullptr;
+void oc_ppu_jit_remote_compile_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->remote_compile.store(enable != 0, std::memory_order_relaxed);
+}
+
+int oc_ppu_jit_remote_compile_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->remote_compile.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+int oc_ppu_jit_get_block_codegen(oc_ppu_jit_t* jit, uint32_t address,
+                                 oc_ppu_codegen_stats_t* stats) {
+    if (stats) std::memset(stats, 0, sizeof(*stats));
+    if (!jit || !stats) return -1;
     
+    CodeCache::ReadGuard guard(jit->cache);
     BasicBlock* block = jit->cache.find_block(address);
-    return block ? block->compiled_code : nullptr;
+    if (!block || !block->compiled_code || block->owns_code) return -1;
+    stats->blocks = 1;
+    stats->guest_instructions = block->instructions.size();
+    stats->host_instructions = block->host_instructions;
+    stats->host_bytes = block->code_size;
+    stats->helper_calls = block->helper_calls;
+    stats->context_loads = block->context_loads;
+    stats->context_stores = block->context_stores;
+    return 0;
 }
 
-void oc_ppu_jit_invalidate(oc_ppu_jit_t* jit, uint32_t address) {
-    if (!jit) return;
-    
-    auto it = jit->cache.blocks.find(address);
-    if (it != jit->cache.blocks.end()) {
-        if (it->second->compiled_code) {
-            free(it->second->compiled_code);
-        }
-        jit->cache.total_size -= it->second->code_size;
-        jit->cache.blocks.erase(it);
+int oc_ppu_jit_get_codegen_stats(oc_ppu_jit_t* jit, int op_class,
+                                 oc_ppu_codegen_stats_t* stats) {
+    if (stats) std::memset(stats, 0, sizeof(*stats));
+    if (!jit || !stats) return -1;
+    if (op_class != OC_PPU_OP_CLASS_ALL && (op_class < 0 || op_class >= OC_PPU_OP_CLASS_COUNT)) {
+        return -1;
     }
+    
+    auto& codegen = jit->codegen_stats;
+    oc_lock_guard<oc_mutex> lock(codegen.mutex);
+    const auto& t = op_class == OC_PPU_OP_CLASS_ALL ? codegen.total : codegen.classes[op_class];
+    auto round = [](double v) { return static_cast<uint64_t>(v + 0.5); };
+    stats->blocks = t.blocks;
+    stats->guest_instructions = t.guest_instructions;
+    stats->host_instructions = round(t.host_instructions);
+    stats->host_bytes = round(t.host_bytes);
+    stats->helper_calls = round(t.helper_calls);
+    stats->context_loads = round(t.context_loads);
+    stats->context_stores = round(t.context_stores);
+    return 0;
 }
 
-void oc_ppu_jit_clear_cache(oc_ppu_jit_t* jit) {
+void oc_ppu_jit_reset_codegen_stats(oc_ppu_jit_t* jit) {
     if (!jit) return;
-    
-    for (auto& pair : jit->cache.blocks) {
-        if (pair.second->compiled_code) {
-            free(pair.second->compiled_code);
-        }
-    }
-    jit->cache.clear();
+    jit->codegen_stats.reset();
 }
 
 void oc_ppu_jit_add_breakpoint(oc_ppu_jit_t* jit, uint32_t address) {
@@ -8424,6 +12777,505 @@ void oc_ppu_jit_reg_clear(oc_ppu_jit_t* jit) {
     jit->enhanced_reg_allocator.clear();
 }
 
+// ============================================================================
+// Jump Table APIs
+// ============================================================================
+
+int oc_ppu_jit_add_readonly_region(oc_ppu_jit_t* jit, uint32_t guest_address,
+                                   const uint8_t* data, size_t size) {
+    if (!jit || !data || size == 0) return -1;
+    if (static_cast<uint64_t>(guest_address) + size > 0x100000000ULL) return -1;
+    jit->rodata.add(guest_address, data, size);
+    return 0;
+}
+
+void oc_ppu_jit_clear_readonly_regions(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->rodata.clear();
+}
+
+size_t oc_ppu_jit_get_jump_table(oc_ppu_jit_t* jit, uint32_t block_address,
+                                 uint32_t* targets, size_t max_targets,
+                                 uint32_t* default_target) {
+    if (default_target) *default_target = 0;
+    if (!jit) return 0;
+    
+    CodeCache::ReadGuard guard(jit->cache);
+    BasicBlock* block = jit->cache.find_block(block_address);
+    if (!block || !block->jump_table.valid()) return 0;
+    
+    const JumpTable& table = block->jump_table;
+    if (targets) {
+        size_t n = std::min(max_targets, table.targets.size());
+        std::copy(table.targets.begin(), table.targets.begin() + n, targets);
+    }
+    if (default_target) *default_target = table.default_target;
+    return table.targets.size();
+}
+
+void oc_ppu_jit_jump_table_get_stats(oc_ppu_jit_t* jit, uint64_t* candidates,
+                                     uint64_t* tables_recognized, uint64_t* cases_total) {
+    if (!jit) {
+        if (candidates) *candidates = 0;
+        if (tables_recognized) *tables_recognized = 0;
+        if (cases_total) *cases_total = 0;
+        return;
+    }
+    auto stats = jit->jump_tables.get_stats();
+    if (candidates) *candidates = stats.candidates;
+    if (tables_recognized) *tables_recognized = stats.tables_recognized;
+    if (cases_total) *cases_total = stats.cases_total;
+}
+
+void oc_ppu_jit_jump_table_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->jump_tables.reset_stats();
+}
+
+// ============================================================================
+// Leaf Inlining APIs
+// ============================================================================
+
+void oc_ppu_jit_inline_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->leaf_inliner.enabled = (enable != 0);
+}
+
+int oc_ppu_jit_inline_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->leaf_inliner.enabled ? 1 : 0;
+}
+
+void oc_ppu_jit_inline_set_max_size(oc_ppu_jit_t* jit, size_t max_instructions) {
+    if (!jit) return;
+    jit->leaf_inliner.max_instructions = max_instructions;
+}
+
+void oc_ppu_jit_inline_get_stats(oc_ppu_jit_t* jit, uint64_t* calls_inlined,
+                                 uint64_t* instructions_inlined, uint64_t* calls_rejected) {
+    if (!jit) {
+        if (calls_inlined) *calls_inlined = 0;
+        if (instructions_inlined) *instructions_inlined = 0;
+        if (calls_rejected) *calls_rejected = 0;
+        return;
+    }
+    auto stats = jit->leaf_inliner.get_stats();
+    if (calls_inlined) *calls_inlined = stats.calls_inlined;
+    if (instructions_inlined) *instructions_inlined = stats.instructions_inlined;
+    if (calls_rejected) *calls_rejected = stats.calls_rejected;
+}
+
+void oc_ppu_jit_inline_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->leaf_inliner.reset_stats();
+}
+
+// ============================================================================
+// Warm Start APIs
+// ============================================================================
+
+size_t oc_ppu_jit_warm_start_export(oc_ppu_jit_t* jit, uint8_t* buffer, size_t buffer_size,
+                                    size_t max_entries) {
+    if (!jit) return 0;
+    
+    // The cache counts dispatches itself, so a profile is collected even with
+    // the profiler off; the managers add what they tracked beyond that
+    WarmStartMap collected;
+    jit->cache.export_warm_start(collected);
+    jit->profiler.export_warm_start(collected);
+    jit->enhanced_lazy_manager.export_warm_start(collected);
+    jit->tiered_manager.export_warm_start(collected);
+    jit->trace_compiler.export_warm_start(collected);
+    
+    std::vector<uint8_t> data = jit->warm_start.serialize(collected, max_entries);
+    if (buffer && buffer_size >= data.size()) {
+        memcpy(buffer, data.data(), data.size());
+    }
+    return data.size();
+}
+
+int oc_ppu_jit_warm_start_import(oc_ppu_jit_t* jit, const uint8_t* data, size_t size) {
+    if (!jit || !data) return -1;
+    return jit->warm_start.deserialize(data, size);
+}
+
+size_t oc_ppu_jit_warm_start_submit(oc_ppu_jit_t* jit, const uint8_t* memory_base,
+                                    uint64_t memory_size, size_t max_count) {
+    if (!jit || !memory_base) return 0;
+    
+    size_t submitted = 0;
+    WarmStartEntry seed;
+    while (submitted < max_count && jit->warm_start.next(seed)) {
+        if (seed.address >= memory_size) continue;
+        const uint8_t* code = memory_base + seed.address;
+        size_t size = static_cast<size_t>(std::min<uint64_t>(WARM_START_CODE_WINDOW,
+                                                             memory_size - seed.address));
+        
+        // A loop that reached tier 2 last run is upgraded as soon as it runs
+        // again, rather than after another UPGRADE_BACK_EDGES back-edges
+        bool optimizing = seed.tier >= static_cast<uint8_t>(CompilationTier::Optimizing);
+        
+        // Hottest seeds are submitted first and also carry the highest priority
+        if (jit->cache.contains(seed.address)) {
+            if (optimizing) arm_loop_upgrade(jit, seed.address);
+        } else {
+            // Noted before the compile is queued, which may cache it at once
+            if (optimizing) jit->warm_start.expect_optimizing(seed.address);
+            if (jit->multithreaded_enabled) {
+                int priority = static_cast<int>(std::min<uint64_t>(seed.execution_count, INT32_MAX));
+                jit->enhanced_thread_pool.submit(seed.address, code, size, priority);
+            } else {
+                oc_ppu_jit_compile(jit, seed.address, code, size);
+            }
+        }
+        
+        // Keep the tier manager's view in step, so the tier survives into
+        // the next export even if the block has not run by then
+        if (seed.tier > 0) {
+            if (!jit->tiered_manager.get_entry(seed.address)) {
+                jit->tiered_manager.register_code(seed.address, code, size);
+            }
+            for (uint8_t tier = 1; tier <= seed.tier; tier++) {
+                jit->tiered_manager.promote(seed.address, static_cast<CompilationTier>(tier));
+            }
+        }
+        
+        if (!seed.trace.empty()) {
+            jit->trace_compiler.detect_trace(seed.address, seed.trace, seed.back_edge_target);
+        }
+        submitted++;
+    }
+    return submitted;
+}
+
+size_t oc_ppu_jit_warm_start_pending(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->warm_start.pending();
+}
+
+void oc_ppu_jit_warm_start_get_stats(oc_ppu_jit_t* jit, uint64_t* entries_exported,
+                                     uint64_t* entries_imported, uint64_t* seeds_submitted) {
+    if (!jit) {
+        if (entries_exported) *entries_exported = 0;
+        if (entries_imported) *entries_imported = 0;
+        if (seeds_submitted) *seeds_submitted = 0;
+        return;
+    }
+    auto stats = jit->warm_start.get_stats();
+    if (entries_exported) *entries_exported = stats.entries_exported;
+    if (entries_imported) *entries_imported = stats.entries_imported;
+    if (seeds_submitted) *seeds_submitted = stats.seeds_submitted;
+}
+
+void oc_ppu_jit_warm_start_clear(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->warm_start.clear();
+}
+
+// ============================================================================
+// Stack Slot Promotion APIs
+// ============================================================================
+
+void oc_ppu_jit_stack_promotion_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->stack_promoter.enabled = (enable != 0);
+}
+
+int oc_ppu_jit_stack_promotion_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->stack_promoter.enabled ? 1 : 0;
+}
+
+int oc_ppu_jit_stack_analyze(oc_ppu_jit_t* jit, const uint32_t* instructions,
+                             size_t count, uint32_t* promoted_slots,
+                             uint32_t* promoted_accesses) {
+    if (promoted_slots) *promoted_slots = 0;
+    if (promoted_accesses) *promoted_accesses = 0;
+    if (!jit || !instructions || count == 0) return 0;
+    
+    std::vector<uint32_t> instrs(instructions, instructions + count);
+    StackFrameInfo info = jit->stack_promoter.analyze(instrs);
+    if (!info.can_promote()) return 0;
+    
+    if (promoted_slots) *promoted_slots = static_cast<uint32_t>(info.slots.size());
+    if (promoted_accesses) *promoted_accesses = static_cast<uint32_t>(info.promoted.size());
+    return 1;
+}
+
+void oc_ppu_jit_stack_get_stats(oc_ppu_jit_t* jit, uint64_t* regions_analyzed,
+                                uint64_t* regions_promoted, uint64_t* slots_promoted,
+                                uint64_t* accesses_promoted) {
+    if (!jit) {
+        if (regions_analyzed) *regions_analyzed = 0;
+        if (regions_promoted) *regions_promoted = 0;
+        if (slots_promoted) *slots_promoted = 0;
+        if (accesses_promoted) *accesses_promoted = 0;
+        return;
+    }
+    auto stats = jit->stack_promoter.get_stats();
+    if (regions_analyzed) *regions_analyzed = stats.regions_analyzed;
+    if (regions_promoted) *regions_promoted = stats.regions_promoted;
+    if (slots_promoted) *slots_promoted = stats.slots_promoted;
+    if (accesses_promoted) *accesses_promoted = stats.accesses_promoted;
+}
+
+void oc_ppu_jit_stack_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->stack_promoter.reset_stats();
+}
+
+// ============================================================================
+// VMX Byte Order Folding APIs
+// ============================================================================
+
+void oc_ppu_jit_vmx_swap_fold_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->vmx_planner.enabled = (enable != 0);
+}
+
+int oc_ppu_jit_vmx_swap_fold_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->vmx_planner.enabled ? 1 : 0;
+}
+
+int oc_ppu_jit_vmx_analyze(oc_ppu_jit_t* jit, const uint32_t* instructions,
+                           size_t count, uint32_t* swaps_emitted,
+                           uint32_t* swaps_folded) {
+    if (swaps_emitted) *swaps_emitted = 0;
+    if (swaps_folded) *swaps_folded = 0;
+    if (!jit || !instructions || count == 0) return 0;
+    
+    std::vector<uint32_t> instrs(instructions, instructions + count);
+    VmxSwapPlan plan = jit->vmx_planner.plan(instrs);
+    if (swaps_emitted) *swaps_emitted = plan.swaps;
+    if (swaps_folded) *swaps_folded = plan.swaps_folded();
+    return static_cast<int>(plan.vector_instructions);
+}
+
+void oc_ppu_jit_vmx_get_stats(oc_ppu_jit_t* jit, uint64_t* regions_analyzed,
+                              uint64_t* vector_instructions, uint64_t* swaps_emitted,
+                              uint64_t* swaps_folded) {
+    if (!jit) {
+        if (regions_analyzed) *regions_analyzed = 0;
+        if (vector_instructions) *vector_instructions = 0;
+        if (swaps_emitted) *swaps_emitted = 0;
+        if (swaps_folded) *swaps_folded = 0;
+        return;
+    }
+    auto stats = jit->vmx_planner.get_stats();
+    if (regions_analyzed) *regions_analyzed = stats.regions_analyzed;
+    if (vector_instructions) *vector_instructions = stats.vector_instructions;
+    if (swaps_emitted) *swaps_emitted = stats.swaps_emitted;
+    if (swaps_folded) *swaps_folded = stats.swaps_folded;
+}
+
+void oc_ppu_jit_vmx_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->vmx_planner.reset_stats();
+}
+
+// ============================================================================
+// PPC Idiom Recognition APIs
+// ============================================================================
+
+void oc_ppu_jit_idioms_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->idioms.enabled = (enable != 0);
+}
+
+int oc_ppu_jit_idioms_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->idioms.enabled ? 1 : 0;
+}
+
+int oc_ppu_jit_idioms_analyze(oc_ppu_jit_t* jit, const uint32_t* instructions,
+                              size_t count, uint32_t* counts) {
+    if (counts) std::fill(counts, counts + OC_PPU_IDIOM_COUNT, 0u);
+    if (!jit || !instructions || count == 0) return 0;
+    
+    std::vector<uint32_t> instrs(instructions, instructions + count);
+    IdiomPlan plan = jit->idioms.plan(instrs);
+    if (counts) std::copy(plan.counts, plan.counts + OC_PPU_IDIOM_COUNT, counts);
+    return static_cast<int>(plan.instructions_fused);
+}
+
+void oc_ppu_jit_idioms_get_stats(oc_ppu_jit_t* jit, uint64_t* regions,
+                                 uint64_t* idioms, uint64_t* instructions_fused) {
+    IdiomStats stats;
+    if (jit) stats = jit->idioms.get_stats();
+    if (regions) *regions = stats.regions;
+    if (idioms) std::copy(stats.idioms, stats.idioms + OC_PPU_IDIOM_COUNT, idioms);
+    if (instructions_fused) *instructions_fused = stats.instructions_fused;
+}
+
+void oc_ppu_jit_idioms_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->idioms.reset_stats();
+}
+
+// ============================================================================
+// Speculation and Deoptimization APIs
+// ============================================================================
+
+void oc_ppu_jit_speculation_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->speculation.enabled = (enable != 0);
+}
+
+int oc_ppu_jit_speculation_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->speculation.enabled ? 1 : 0;
+}
+
+void oc_ppu_jit_deopt_set_threshold(oc_ppu_jit_t* jit, uint32_t failures) {
+    if (!jit) return;
+    jit->speculation.threshold = std::max(1u, failures);
+}
+
+uint32_t oc_ppu_jit_deopt_get_threshold(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->speculation.threshold;
+}
+
+int oc_ppu_jit_get_guards(oc_ppu_jit_t* jit, uint32_t address,
+                          oc_ppu_guard_info_t* guards, size_t capacity) {
+    if (!jit) return -1;
+    
+    CodeCache::ReadGuard guard(jit->cache);
+    BasicBlock* block = jit->cache.find_block(address);
+    if (!block || !block->compiled_code) return -1;
+    for (size_t i = 0; guards && i < block->guards.size() && i < capacity; i++) {
+        const GuardSite& site = block->guards[i];
+        oc_ppu_guard_info_t& info = guards[i];
+        info.kind = static_cast<int32_t>(site.kind);
+        info.reg = site.reg;
+        info.guest_pc = site.guest_pc;
+        info.instruction_index = site.index;
+        info.expected = site.expected;
+        info.gprs = site.state.gprs;
+        info.fprs = site.state.fprs;
+        info.vrs = site.state.vrs;
+        info.materialized = site.state.materialized;
+    }
+    return static_cast<int>(block->guards.size());
+}
+
+void oc_ppu_jit_deopt_get_stats(oc_ppu_jit_t* jit, uint64_t* guards, uint64_t* deopts,
+                                uint64_t* speculations_dropped) {
+    SpeculationStats stats;
+    if (jit) stats = jit->speculation.get_stats();
+    if (guards) *guards = stats.guards;
+    if (deopts) *deopts = stats.deopts;
+    if (speculations_dropped) *speculations_dropped = stats.speculations_dropped;
+}
+
+void oc_ppu_jit_deopt_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->speculation.reset_stats();
+}
+
+// ============================================================================
+// On-Stack Replacement APIs
+// ============================================================================
+
+/**
+ * Compile the tier-2 loop of the region at address and publish it to the
+ * region's upgrade slot. Returns as oc_ppu_jit_osr_upgrade.
+ */
+static int upgrade_loop(oc_ppu_jit_t* jit, uint32_t address) {
+    // The loop is built from a copy, so no reader epoch is held across the
+    // optimizing compile and retired blocks can be reclaimed meanwhile
+    BasicBlock loop(address);
+    {
+        CodeCache::ReadGuard guard(jit->cache);
+        BasicBlock* block = jit->cache.find_block(address);
+        if (!block || !block->compiled_code) return -1;
+        if (!block->loop_header) return 0;
+        if (block->links->osr_entry.load(std::memory_order_acquire)) return 1;
+        loop.end_address = block->end_address;
+        loop.instructions = block->instructions;
+        loop.inlined_calls = block->inlined_calls;
+        loop.loop_header = block->loop_header;
+        loop.symbol_version = block->symbol_version;
+    }
+    
+#ifdef HAVE_LLVM
+    // The upgrade slot of the compile the loop was built from, or null if
+    // that compile has left the cache; a region compiled since gets its own
+    // upgrade. Caller holds a ReadGuard.
+    auto slot = [&]() -> std::atomic<void*>* {
+        BasicBlock* block = jit->cache.find_block(address);
+        if (!block || block->symbol_version != loop.symbol_version) return nullptr;
+        return &block->links->osr_entry;
+    };
+    
+    if (jit->orc_manager.is_initialized()) {
+        void* entry = nullptr;
+        oc_lock_guard<oc_mutex> codegen_lock(jit->codegen_mutex);
+        {
+            // Another thread may have upgraded the region while we waited
+            CodeCache::ReadGuard guard(jit->cache);
+            std::atomic<void*>* osr_entry = slot();
+            if (!osr_entry) return -1;
+            if (osr_entry->load(std::memory_order_acquire)) return 1;
+        }
+        if (jit->module && create_osr_function(jit->module.get(), &loop)) {
+            apply_optimization_passes(jit->module.get(), OC_PPU_PASS_PIPELINE_O3);
+            entry = link_current_module(jit, block_symbol("ppu_osr_", &loop));
+        }
+        jit->osr.record_upgrade(entry != nullptr);
+        if (!entry) return -2;
+        
+        // Still under the codegen lock, so no other upgrade of this compile
+        // can have been published meanwhile
+        CodeCache::ReadGuard guard(jit->cache);
+        std::atomic<void*>* osr_entry = slot();
+        if (!osr_entry) return -1;
+        osr_entry->store(entry, std::memory_order_release);
+        return 1;
+    }
+#endif
+    jit->osr.record_upgrade(false);
+    return -2;
+}
+
+void oc_ppu_jit_osr_enable(oc_ppu_jit_t* jit, int enable) {
+    if (!jit) return;
+    jit->osr.enabled.store(enable != 0, std::memory_order_relaxed);
+}
+
+int oc_ppu_jit_osr_is_enabled(oc_ppu_jit_t* jit) {
+    if (!jit) return 0;
+    return jit->osr.enabled.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+uint32_t oc_ppu_jit_osr_get_loop_header(oc_ppu_jit_t* jit, uint32_t address) {
+    if (!jit) return 0;
+    
+    CodeCache::ReadGuard guard(jit->cache);
+    BasicBlock* block = jit->cache.find_block(address);
+    return (block && block->compiled_code) ? block->loop_header : 0;
+}
+
+int oc_ppu_jit_osr_upgrade(oc_ppu_jit_t* jit, uint32_t address) {
+    if (!jit) return -1;
+    return upgrade_loop(jit, address);
+}
+
+void oc_ppu_jit_osr_get_stats(oc_ppu_jit_t* jit, uint64_t* loop_regions, uint64_t* upgrades,
+                              uint64_t* upgrade_failures) {
+    OsrStats stats;
+    if (jit) stats = jit->osr.get_stats();
+    if (loop_regions) *loop_regions = stats.loop_regions;
+    if (upgrades) *upgrades = stats.upgrades;
+    if (upgrade_failures) *upgrade_failures = stats.upgrade_failures;
+}
+
+void oc_ppu_jit_osr_reset_stats(oc_ppu_jit_t* jit) {
+    if (!jit) return;
+    jit->osr.reset_stats();
+}
+
 // ============================================================================
 // Lazy Compilation APIs
 // ============================================================================
@@ -8625,7 +13477,13 @@ int oc_ppu_jit_tiered_promote(oc_ppu_jit_t* jit, uint32_t address, int target_ti
     if (!jit) return 0;
     if (target_tier < 0 || target_tier > 2) return 0;
     
-    return jit->tiered_manager.promote(address, static_cast<CompilationTier>(target_tier)) ? 1 : 0;
+    if (!jit->tiered_manager.promote(address, static_cast<CompilationTier>(target_tier))) return 0;
+    // A loop already running at tier 1 moves over on its next back-edge
+    if (target_tier == static_cast<int>(CompilationTier::Optimizing) &&
+        jit->osr.enabled.load(std::memory_order_relaxed)) {
+        upgrade_loop(jit, address);
+    }
+    return 1;
 }
 
 void* oc_ppu_jit_tiered_get_code(oc_ppu_jit_t* jit, uint32_t address) {
@@ -8693,15 +13551,13 @@ void oc_ppu_jit_start_compile_threads(oc_ppu_jit_t* jit, size_t num_threads) {
     jit->thread_pool.start(num_threads, [jit](const CompilationTask& task) {
         // Compile the task
         auto block = std::make_unique<BasicBlock>(task.address);
-        identify_basic_block(task.code.data(), task.code.size(), block.get());
+        identify_region(jit, task.code.data(), task.code.size(), block.get());
+        CodeSnapshot snapshot = snapshot_block_source(jit, block.get());
         generate_llvm_ir(block.get(), jit);
         emit_machine_code(block.get());
         
         // Insert into cache (thread-safe)
-        {
-            oc_lock_guard<oc_mutex> lock(jit->cache.mutex);
-            jit->cache.insert_block(task.address, std::move(block));
-        }
+        cache_compiled_block(jit, task.address, std::move(block), snapshot);
         
         // Update lazy state
         jit->lazy_manager.mark_compiled(task.address);
@@ -8711,15 +13567,13 @@ void oc_ppu_jit_start_compile_threads(oc_ppu_jit_t* jit, size_t num_threads) {
     jit->enhanced_thread_pool.start(num_threads, [jit](const EnhancedCompilationTask& task) -> bool {
         // Compile the task
         auto block = std::make_unique<BasicBlock>(task.address);
-        identify_basic_block(task.code.data(), task.code.size(), block.get());
+        identify_region(jit, task.code.data(), task.code.size(), block.get());
+        CodeSnapshot snapshot = snapshot_block_source(jit, block.get());
         generate_llvm_ir(block.get(), jit);
         emit_machine_code(block.get());
         
         // Insert into cache (thread-safe)
-        {
-            oc_lock_guard<oc_mutex> lock(jit->cache.mutex);
-            jit->cache.insert_block(task.address, std::move(block));
-        }
+        cache_compiled_block(jit, task.address, std::move(block), snapshot);
         
         // Update lazy state
         jit->lazy_manager.mark_compiled(task.address);
@@ -8889,21 +13743,19 @@ size_t oc_ppu_jit_bg_process_idle(oc_ppu_jit_t* jit, size_t max_count) {
             auto block = std::make_unique<BasicBlock>(addr);
             if (!block) return false;
             
-            identify_basic_block(code, size, block.get());
+            identify_region(jit, code, size, block.get());
             
             // Check if block has any instructions (basic validation)
             if (block->instructions.empty()) {
                 return false;  // Empty block, compilation failed
             }
+            CodeSnapshot snapshot = snapshot_block_source(jit, block.get());
             
             generate_llvm_ir(block.get(), jit);
             emit_machine_code(block.get());
             
-            // Insert into cache
-            {
-                oc_lock_guard<oc_mutex> lock(jit->cache.mutex);
-                jit->cache.insert_block(addr, std::move(block));
-            }
+            // Insert into cache (thread-safe)
+            cache_compiled_block(jit, addr, std::move(block), snapshot);
             return true;
         },
         max_count
@@ -8970,16 +13822,41 @@ void oc_ppu_jit_bg_clear(oc_ppu_jit_t* jit) {
  */
 typedef void (*JitFunctionPtr)(oc_ppu_context_t* context, void* memory_base);
 
-int oc_ppu_jit_execute(oc_ppu_jit_t* jit, oc_ppu_context_t* context, uint32_t address) {
-    if (!jit || !context) return -1;
+/**
+ * After a run of a native block whose branch guard held, link the block to
+ * its target so later runs continue there directly. Only guard-free native
+ * blocks are linked to: they check the budget themselves and cannot deopt,
+ * which keeps the dispatcher's accounting for the source valid. Caller
+ * holds a ReadGuard.
+ */
+static void link_branch_target(oc_ppu_jit_t* jit, BasicBlock* block, uint64_t next_pc) {
+    if (!block->checks_budget || block->guards.empty()) return;
+    const GuardSite& site = block->guards.back();
+    if (site.kind != GuardKind::BranchTarget || site.expected != next_pc) return;
+    if (block->links->chain_entry.load(std::memory_order_relaxed)) return;
     
+    uint32_t address = static_cast<uint32_t>(next_pc);
+    BasicBlock* target = jit->cache.find_block(address);
+    if (!target || !target->compiled_code || !target->checks_budget || !target->guards.empty()) return;
+    if (jit->breakpoints.has_breakpoint(address)) return;
+    jit->cache.chain(block, target);
+}
+
+/**
+ * Run the region at address once. Sets upgrade when this run made the
+ * region hot enough for its tier-2 loop.
+ */
+static int run_region(oc_ppu_jit_t* jit, oc_ppu_context_t* context, uint32_t address,
+                      bool& upgrade) {
     // Check for breakpoint at this address
     if (jit->breakpoints.has_breakpoint(address)) {
         context->exit_reason = OC_PPU_EXIT_BREAKPOINT;
         return 0;
     }
     
-    // Get compiled code
+    // Get compiled code. The guard keeps the block alive even if another
+    // thread invalidates or evicts it while we are executing it.
+    CodeCache::ReadGuard guard(jit->cache);
     BasicBlock* block = jit->cache.find_block(address);
     if (!block || !block->compiled_code) {
         // Not compiled - return error so interpreter can handle
@@ -8987,11 +13864,31 @@ int oc_ppu_jit_execute(oc_ppu_jit_t* jit, oc_ppu_context_t* context, uint32_t ad
         return -2;
     }
     
+    // Preemption point at dispatch. Natively compiled blocks repeat this
+    // check themselves (it matters once blocks are chained without going
+    // through here); for the rest the budget is charged here instead.
+    if (context->interrupt_pending ||
+        (context->budget_enabled && context->instruction_budget <= 0)) {
+        context->instructions_executed = 0;
+        context->exit_reason = OC_PPU_EXIT_PREEMPTED;
+        context->next_pc = address;
+        return 0;
+    }
+    // Native code charges the budget as it runs (once at entry, and again
+    // per loop iteration once a loop has been upgraded), and charges nothing
+    // when it is preempted at entry, so the budget delta is exactly what
+    // executed whether or not the budget is enabled
+    int64_t budget_before = context->instruction_budget;
+    if (!block->checks_budget) {
+        context->instruction_budget -= static_cast<int64_t>(block->instructions.size());
+    }
+    
     // Set up context for execution
     context->memory_base = context->memory_base; // Passed from caller
     context->instructions_executed = 0;
     context->exit_reason = OC_PPU_EXIT_NORMAL;
-    context->next_pc = address + (block->instructions.size() * 4);
+    context->next_pc = block->end_address;
+    block->runs.fetch_add(1, std::memory_order_relaxed);
     
     // Cast compiled code to function pointer and call
     JitFunctionPtr func = reinterpret_cast<JitFunctionPtr>(block->compiled_code);
@@ -9003,17 +13900,49 @@ int oc_ppu_jit_execute(oc_ppu_jit_t* jit, oc_ppu_context_t* context, uint32_t ad
     func(context, context->memory_base);
     
     // Update execution count
-    context->instructions_executed = static_cast<uint32_t>(block->instructions.size());
+    context->instructions_executed = static_cast<uint32_t>(std::min<int64_t>(
+        budget_before - context->instruction_budget, INT32_MAX));
     
     // Update PC based on exit reason
     if (context->exit_reason == OC_PPU_EXIT_NORMAL) {
         context->pc = context->next_pc;
+        link_branch_target(jit, block, context->next_pc);
+        if (block->loop_header && context->next_pc == block->loop_header &&
+            jit->osr.enabled.load(std::memory_order_relaxed) &&
+            !block->links->osr_entry.load(std::memory_order_relaxed)) {
+            upgrade = block->back_edges.fetch_add(1, std::memory_order_relaxed) + 1 ==
+                      OsrManager::UPGRADE_BACK_EDGES;
+        }
+    } else if (context->exit_reason == OC_PPU_EXIT_SYSCALL && context->instructions_executed > 0) {
+        // The sc itself is left to the interpreter
+        context->instructions_executed--;
+        context->instruction_budget++;
+    } else if (context->exit_reason == OC_PPU_EXIT_DEOPT &&
+               context->deopt_guard < block->guards.size()) {
+        // Only the instructions before the guard ran; the interpreter takes
+        // over at next_pc, so the rest of the region's budget charge is
+        // given back
+        const GuardSite& site = block->guards[context->deopt_guard];
+        context->instructions_executed = site.index;
+        context->instruction_budget += static_cast<int64_t>(block->instructions.size() - site.index);
+        if (jit->speculation.record_failure(block->start_address, site)) {
+            oc_ppu_jit_invalidate(jit, address);
+        }
     }
     // For branches/syscalls, compiled code should have set next_pc
     
     return static_cast<int>(context->instructions_executed);
 }
 
+int oc_ppu_jit_execute(oc_ppu_jit_t* jit, oc_ppu_context_t* context, uint32_t address) {
+    if (!jit || !context) return -1;
+    bool upgrade = false;
+    int executed = run_region(jit, context, address, upgrade);
+    // Compiled once the run's ReadGuard is released
+    if (upgrade) upgrade_loop(jit, address);
+    return executed;
+}
+
 int oc_ppu_jit_execute_block(oc_ppu_jit_t* jit, oc_ppu_context_t* context, uint32_t address) {
     // Same as execute for now - single block execution
     return oc_ppu_jit_execute(jit, context, address);
@@ -9064,7 +13993,7 @@ void oc_ppu_jit_get_breakpoint_stats(oc_ppu_jit_t* jit, uint64_t* total_set,
         return;
     }
     
-    auto& stats = jit->breakpoints.get_stats();
+    auto stats = jit->breakpoints.get_stats();
     if (total_set) *total_set = stats.total_breakpoints_set;
     if (total_hit) *total_hit = stats.total_breakpoints_hit;
     if (patches_applied) *patches_applied = stats.total_patches_applied;
@@ -9155,7 +14084,7 @@ void oc_ppu_jit_profiling_get_stats(oc_ppu_jit_t* jit, uint64_t* blocks_compiled
         return;
     }
     
-    auto& stats = jit->profiler.get_stats();
+    auto stats = jit->profiler.get_stats();
     if (blocks_compiled) *blocks_compiled = stats.total_blocks_compiled;
     if (total_compile_time_ns) *total_compile_time_ns = stats.total_compilation_time_ns;
     if (total_executions) *total_executions = stats.total_executions;
@@ -9200,6 +14129,7 @@ void oc_ppu_jit_link_add(oc_ppu_jit_t* jit, uint32_t source, uint32_t target, in
 int oc_ppu_jit_link_blocks(oc_ppu_jit_t* jit, uint32_t source, uint32_t target) {
     if (!jit) return 0;
     // Find target compiled code in cache
+    CodeCache::ReadGuard guard(jit->cache);
     BasicBlock* target_block = jit->cache.find_block(target);
     if (!target_block || !target_block->compiled_code) return 0;
     return jit->block_linker.link_blocks(source, target, target_block->compiled_code) ? 1 : 0;
@@ -9241,7 +14171,7 @@ void oc_ppu_jit_link_get_stats(oc_ppu_jit_t* jit, uint64_t* total_links,
         if (unlinks) *unlinks = 0;
         return;
     }
-    auto& stats = jit->block_linker.get_stats();
+    auto stats = jit->block_linker.get_stats();
     if (total_links) *total_links = stats.total_links;
     if (active_links) *active_links = stats.active_links;
     if (hits) *hits = stats.link_hits;
@@ -9329,7 +14259,7 @@ void oc_ppu_jit_trace_get_stats(oc_ppu_jit_t* jit, uint64_t* detected,
         if (aborts) *aborts = 0;
         return;
     }
-    auto& stats = jit->trace_compiler.get_stats();
+    auto stats = jit->trace_compiler.get_stats();
     if (detected) *detected = stats.traces_detected;
     if (compiled) *compiled = stats.traces_compiled;
     if (loops) *loops = stats.loop_traces;
@@ -9380,13 +14310,18 @@ int oc_ppu_jit_verify_codegen(oc_ppu_jit_t* jit) {
     }
     
     // Verify block was cached and has code
-    BasicBlock* block = jit->cache.find_block(TEST_ADDRESS);
-    if (!block || !block->compiled_code || block->code_size == 0) {
-        return 0; // No code produced
+    bool valid;
+    {
+        CodeCache::ReadGuard guard(jit->cache);
+        BasicBlock* block = jit->cache.find_block(TEST_ADDRESS);
+        if (!block || !block->compiled_code || block->code_size == 0) {
+            return 0; // No code produced
+        }
+        
+        // Verify the block has exactly one instruction
+        valid = block->instructions.size() == 1;
     }
-    
-    // Verify the block has exactly one instruction
-    if (block->instructions.size() != 1) {
+    if (!valid) {
         oc_ppu_jit_invalidate(jit, TEST_ADDRESS);
         return 0;
     }
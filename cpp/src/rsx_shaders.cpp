@@ -12,14 +12,27 @@
 
 #include "oc_ffi.h"
 #include "oc_threading.h"
+#include <atomic>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <list>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <array>
 #include <new>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define OC_RSX_X86_64 1
+#else
+#define OC_RSX_X86_64 0
+#endif
 
 // ============================================================================
 // RSX Shader Instruction Definitions
@@ -390,27 +403,92 @@ struct LinkedShaderProgram {
 
 /**
  * Shader linker
+ * 
+ * Linked programs are charged to the cache memory budget and the least
+ * recently used ones are evicted when the budget target shrinks.
  */
 struct ShaderLinker {
-    std::unordered_map<uint64_t, LinkedShaderProgram> linked_programs;
+    struct Entry {
+        LinkedShaderProgram program;
+        size_t bytes;
+        std::list<uint64_t>::iterator lru_entry;
+    };
+    
+    std::unordered_map<uint64_t, Entry> linked_programs;
     oc_mutex mutex;
+    size_t total_bytes;
+    std::list<uint64_t> lru;  // Pair hashes, least recently used first
+    std::atomic<uint64_t> lookups;
+    int budget_client;
+    
+    ShaderLinker() : total_bytes(0), lookups(0) {
+        budget_client = oc_mem_budget_register("rsx_linked", budget_lookups, this);
+    }
+    
+    ~ShaderLinker() {
+        clear();
+        oc_mem_budget_unregister(budget_client);
+    }
+    
+    static uint64_t budget_lookups(void* user_data) {
+        return static_cast<ShaderLinker*>(user_data)->lookups.load(std::memory_order_relaxed);
+    }
     
     // Compute combined hash for vertex/fragment pair
     static uint64_t compute_pair_hash(uint64_t vp_hash, uint64_t fp_hash) {
         return vp_hash ^ (fp_hash << 32) ^ (fp_hash >> 32);
     }
     
-    LinkedShaderProgram* get_linked(uint64_t vp_hash, uint64_t fp_hash) {
+    static size_t footprint(const LinkedShaderProgram& program) {
+        size_t bytes = sizeof(Entry) +
+                       (program.vertex_spirv.capacity() + program.fragment_spirv.capacity()) * sizeof(uint32_t);
+        for (const auto* bindings : {&program.vertex_outputs, &program.fragment_inputs}) {
+            bytes += bindings->capacity() * sizeof(ShaderInterfaceBinding);
+            for (const auto& binding : *bindings) bytes += binding.name.capacity();
+        }
+        return bytes;
+    }
+    
+    // Copies under the lock, since another thread may evict the entry
+    bool get_linked(uint64_t vp_hash, uint64_t fp_hash, LinkedShaderProgram* out_program) {
         oc_lock_guard<oc_mutex> lock(mutex);
+        lookups.fetch_add(1, std::memory_order_relaxed);
         uint64_t pair_hash = compute_pair_hash(vp_hash, fp_hash);
         auto it = linked_programs.find(pair_hash);
-        return (it != linked_programs.end()) ? &it->second : nullptr;
+        if (it == linked_programs.end()) return false;
+        lru.splice(lru.end(), lru, it->second.lru_entry);
+        *out_program = it->second.program;
+        return true;
     }
     
     void store_linked(uint64_t vp_hash, uint64_t fp_hash, const LinkedShaderProgram& program) {
         oc_lock_guard<oc_mutex> lock(mutex);
         uint64_t pair_hash = compute_pair_hash(vp_hash, fp_hash);
-        linked_programs[pair_hash] = program;
+        auto existing = linked_programs.find(pair_hash);
+        if (existing != linked_programs.end()) {
+            total_bytes -= existing->second.bytes;
+            oc_mem_budget_release(budget_client, existing->second.bytes);
+            lru.erase(existing->second.lru_entry);
+            linked_programs.erase(existing);
+        }
+        
+        size_t bytes = footprint(program);
+        uint64_t target = oc_mem_budget_get_target(budget_client);
+        while (!linked_programs.empty() && total_bytes + bytes > target) {
+            evict_lru();
+        }
+        
+        linked_programs[pair_hash] = Entry{program, bytes, lru.insert(lru.end(), pair_hash)};
+        total_bytes += bytes;
+        oc_mem_budget_insert(budget_client, pair_hash, bytes);
+    }
+    
+    void evict_lru() {
+        auto victim = linked_programs.find(lru.front());
+        total_bytes -= victim->second.bytes;
+        oc_mem_budget_evict(budget_client, victim->first, victim->second.bytes);
+        lru.pop_front();
+        linked_programs.erase(victim);
     }
     
     bool link(const std::vector<uint32_t>& vertex_spirv, uint64_t vp_hash,
@@ -419,8 +497,7 @@ struct ShaderLinker {
         if (!out_program) return false;
         
         // Check if already linked
-        if (auto* existing = get_linked(vp_hash, fp_hash)) {
-            *out_program = *existing;
+        if (get_linked(vp_hash, fp_hash, out_program)) {
             return true;
         }
         
@@ -450,7 +527,10 @@ struct ShaderLinker {
     
     void clear() {
         oc_lock_guard<oc_mutex> lock(mutex);
+        oc_mem_budget_release(budget_client, total_bytes);
         linked_programs.clear();
+        lru.clear();
+        total_bytes = 0;
     }
 };
 
@@ -541,14 +621,29 @@ struct CachedPipeline {
           use_count(0), last_used_frame(0) {}
 };
 
+/**
+ * Host bytes charged per cached pipeline for the driver-side object. The
+ * driver's allocation is not visible to us, so this is an estimate of a
+ * typical compiled graphics pipeline.
+ */
+static constexpr size_t RSX_PIPELINE_DRIVER_BYTES = 16 * 1024;
+
 /**
  * Pipeline cache manager
+ * 
+ * Entries are charged to the cache memory budget; the least recently used
+ * pipelines are evicted when the budget target or max_entries is reached.
  */
 struct PipelineCache {
     std::unordered_map<uint64_t, CachedPipeline> pipelines;
     oc_mutex mutex;
     size_t max_entries;
     uint64_t current_frame;
+    size_t total_bytes;
+    std::atomic<uint64_t> lookups;
+    int budget_client;
+    
+    static constexpr size_t ENTRY_BYTES = sizeof(CachedPipeline) + RSX_PIPELINE_DRIVER_BYTES;
     
     // Callback for pipeline creation
     using CreatePipelineFunc = void* (*)(const PipelineState* state);
@@ -558,11 +653,18 @@ struct PipelineCache {
     DestroyPipelineFunc destroy_callback;
     
     PipelineCache() 
-        : max_entries(1024), current_frame(0),
-          create_callback(nullptr), destroy_callback(nullptr) {}
+        : max_entries(1024), current_frame(0), total_bytes(0), lookups(0),
+          create_callback(nullptr), destroy_callback(nullptr) {
+        budget_client = oc_mem_budget_register("rsx_pipelines", budget_lookups, this);
+    }
     
     ~PipelineCache() {
         clear();
+        oc_mem_budget_unregister(budget_client);
+    }
+    
+    static uint64_t budget_lookups(void* user_data) {
+        return static_cast<PipelineCache*>(user_data)->lookups.load(std::memory_order_relaxed);
     }
     
     void set_callbacks(CreatePipelineFunc create_cb, DestroyPipelineFunc destroy_cb) {
@@ -573,6 +675,7 @@ struct PipelineCache {
     void* get_or_create(const PipelineState& state) {
         oc_lock_guard<oc_mutex> lock(mutex);
         
+        lookups.fetch_add(1, std::memory_order_relaxed);
         uint64_t hash = state.compute_hash();
         auto it = pipelines.find(hash);
         
@@ -582,8 +685,10 @@ struct PipelineCache {
             return it->second.vulkan_pipeline;
         }
         
-        // Evict if at capacity
-        if (pipelines.size() >= max_entries) {
+        // Evict if at capacity or over the budget target
+        uint64_t target = oc_mem_budget_get_target(budget_client);
+        while (!pipelines.empty() &&
+               (pipelines.size() >= max_entries || total_bytes + ENTRY_BYTES > target)) {
             evict_lru();
         }
         
@@ -595,6 +700,8 @@ struct PipelineCache {
         
         pipelines[hash] = CachedPipeline(state, pipeline);
         pipelines[hash].last_used_frame = current_frame;
+        total_bytes += ENTRY_BYTES;
+        oc_mem_budget_insert(budget_client, hash, ENTRY_BYTES);
         
         return pipeline;
     }
@@ -620,6 +727,8 @@ struct PipelineCache {
                 destroy_callback(it->second.vulkan_pipeline);
             }
             pipelines.erase(it);
+            total_bytes -= ENTRY_BYTES;
+            oc_mem_budget_evict(budget_client, evict_hash, ENTRY_BYTES);
         }
     }
     
@@ -641,7 +750,365 @@ struct PipelineCache {
                 }
             }
         }
+        oc_mem_budget_release(budget_client, total_bytes);
         pipelines.clear();
+        total_bytes = 0;
+    }
+};
+
+// ============================================================================
+// Constant File Management
+// ============================================================================
+
+/** RSX transform (vertex) constant registers */
+static constexpr uint32_t RSX_VP_CONSTANT_COUNT = 468;
+
+/** Fragment constant slots mirrored for patched fragment programs */
+static constexpr uint32_t RSX_FP_CONSTANT_COUNT = 512;
+
+/** Constants per hash block (256 bytes, a common uniform buffer alignment) */
+static constexpr uint32_t RSX_CONSTANT_BLOCK = 16;
+
+/** Clean gap (in constants) that is cheaper to re-upload than to split a range over */
+static constexpr uint32_t RSX_CONSTANT_MERGE_GAP = 4;
+
+/** Previously flushed constant-file hashes remembered for reuse */
+static constexpr size_t RSX_CONSTANT_HISTORY = 32;
+
+/**
+ * Constant file statistics
+ */
+struct RsxConstantStats {
+    uint64_t writes = 0;             // Constants written by the guest
+    uint64_t flushes = 0;            // Draw-time flushes
+    uint64_t clean_flushes = 0;      // Flushes with nothing to upload
+    uint64_t reused_flushes = 0;     // Flushes matching a previously flushed file
+    uint64_t ranges_emitted = 0;
+    uint64_t constants_uploaded = 0; // Constants covered by emitted ranges
+};
+
+/**
+ * Mirror of one RSX constant file with draw-to-draw change tracking
+ *
+ * The guest writes constants into `guest`; `shadow` holds what was last
+ * uploaded. At draw time the two are compared 16 bytes per constant with
+ * vector compares, the changed constants are coalesced into upload ranges,
+ * and the shadow is brought up to date. A content hash of the whole file is
+ * maintained per block so backends that keep one buffer per distinct
+ * constant set can rebind an identical earlier block instead of uploading.
+ */
+struct RsxConstantFile {
+    std::vector<std::array<float, 4>> guest;
+    std::vector<std::array<float, 4>> shadow;
+    std::vector<uint64_t> block_hashes;
+    std::array<uint64_t, RSX_CONSTANT_HISTORY> history{};
+    size_t history_next = 0;
+    uint32_t dirty_min;    // Conservative bounds of constants written since the last flush
+    uint32_t dirty_max;
+    bool force_full;       // Next flush uploads everything (initial state, reset)
+    RsxConstantStats stats;
+    mutable oc_mutex mutex;
+    
+    explicit RsxConstantFile(uint32_t count)
+        : guest(count), shadow(count), block_hashes((count + RSX_CONSTANT_BLOCK - 1) / RSX_CONSTANT_BLOCK),
+          dirty_min(UINT32_MAX), dirty_max(0), force_full(true) {
+        for (size_t b = 0; b < block_hashes.size(); b++) block_hashes[b] = hash_block(b);
+    }
+    
+    uint32_t size() const { return static_cast<uint32_t>(guest.size()); }
+    
+    /**
+     * Store guest constant writes (no comparison happens here)
+     */
+    int write(uint32_t first, const float* data, uint32_t count) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (first >= size() || count > size() - first) return -2;
+        std::memcpy(guest[first].data(), data, count * sizeof(guest[0]));
+        dirty_min = std::min(dirty_min, first);
+        dirty_max = std::max(dirty_max, first + count);
+        stats.writes += count;
+        return 0;
+    }
+    
+    /**
+     * Check whether guest constant i differs from the uploaded copy
+     */
+    bool differs(uint32_t i) const {
+#if OC_RSX_X86_64
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(guest[i].data()));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shadow[i].data()));
+        return _mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xFFFF;
+#else
+        return std::memcmp(guest[i].data(), shadow[i].data(), sizeof(guest[0])) != 0;
+#endif
+    }
+    
+    /**
+     * Bitmask of changed constants in [i, i + 2), compared 32 bytes at a time
+     */
+    uint32_t differs_pair(uint32_t i) const {
+#if OC_RSX_X86_64 && defined(__AVX2__)
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(guest[i].data()));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shadow[i].data()));
+        uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)));
+        return ((eq & 0xFFFF) != 0xFFFF ? 1u : 0u) | ((eq >> 16) != 0xFFFF ? 2u : 0u);
+#else
+        return (differs(i) ? 1u : 0u) | (differs(i + 1) ? 2u : 0u);
+#endif
+    }
+    
+    uint64_t hash_block(size_t block) const {
+        uint32_t begin = static_cast<uint32_t>(block * RSX_CONSTANT_BLOCK);
+        uint32_t end = std::min(begin + RSX_CONSTANT_BLOCK, size());
+        uint64_t hash = 0xCBF29CE484222325ULL ^ block;
+        for (uint32_t i = begin; i < end; i++) {
+            uint64_t lo, hi;
+            std::memcpy(&lo, shadow[i].data(), 8);
+            std::memcpy(&hi, shadow[i].data() + 2, 8);
+            hash = (hash ^ lo) * 0x100000001B3ULL;
+            hash = (hash ^ hi) * 0x100000001B3ULL;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+    
+    uint64_t file_hash() const {
+        uint64_t hash = 0x9E3779B97F4A7C15ULL;
+        for (uint64_t h : block_hashes) {
+            hash ^= h;
+            hash *= 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 32;
+        }
+        return hash;
+    }
+    
+    /**
+     * Compare guest against shadow, emit coalesced upload ranges and update
+     * the shadow.
+     *
+     * Ranges beyond max_ranges are folded into the last one, so the output
+     * always covers every changed constant.
+     * Returns: 0 if nothing changed, 1 if ranges were emitted, 2 if ranges
+     *          were emitted and the resulting file matches a previously
+     *          flushed one (identified by *out_hash)
+     */
+    int flush(oc_rsx_const_range_t* ranges, size_t max_ranges, size_t* out_count,
+              uint64_t* out_hash) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats.flushes++;
+        *out_count = 0;
+        
+        uint32_t begin = force_full ? 0 : dirty_min;
+        uint32_t end = force_full ? size() : std::min(dirty_max, size());
+        begin = std::min(begin, end);
+        
+        size_t count = 0;
+        bool open = false;
+        uint32_t run_first = 0, run_last = 0;
+        auto emit = [&](uint32_t i) {
+            if (open && i - run_last <= RSX_CONSTANT_MERGE_GAP + 1) {
+                run_last = i;
+                return;
+            }
+            if (open) {
+                if (count < max_ranges) ranges[count++] = {run_first, run_last - run_first + 1};
+                else ranges[max_ranges - 1].count = run_last - ranges[max_ranges - 1].first + 1;
+            }
+            open = true;
+            run_first = run_last = i;
+        };
+        
+        uint32_t i = begin;
+        for (; i + 1 < end; i += 2) {
+            uint32_t mask = force_full ? 3 : differs_pair(i);
+            if (mask & 1) emit(i);
+            if (mask & 2) emit(i + 1);
+        }
+        if (i < end && (force_full || differs(i))) emit(i);
+        if (open) {
+            if (count < max_ranges) ranges[count++] = {run_first, run_last - run_first + 1};
+            else ranges[max_ranges - 1].count = run_last - ranges[max_ranges - 1].first + 1;
+        }
+        
+        dirty_min = UINT32_MAX;
+        dirty_max = 0;
+        force_full = false;
+        *out_count = count;
+        
+        if (count == 0) {
+            stats.clean_flushes++;
+            if (out_hash) *out_hash = file_hash();
+            return 0;
+        }
+        
+        for (size_t r = 0; r < count; r++) {
+            uint32_t first = ranges[r].first;
+            uint32_t n = ranges[r].count;
+            std::memcpy(shadow[first].data(), guest[first].data(), n * sizeof(shadow[0]));
+            for (size_t b = first / RSX_CONSTANT_BLOCK; b <= (first + n - 1) / RSX_CONSTANT_BLOCK; b++) {
+                block_hashes[b] = hash_block(b);
+            }
+            stats.constants_uploaded += n;
+        }
+        stats.ranges_emitted += count;
+        
+        uint64_t hash = file_hash();
+        if (out_hash) *out_hash = hash;
+        
+        bool seen = std::find(history.begin(), history.end(), hash) != history.end();
+        if (seen) {
+            stats.reused_flushes++;
+            return 2;
+        }
+        history[history_next] = hash;
+        history_next = (history_next + 1) % RSX_CONSTANT_HISTORY;
+        return 1;
+    }
+    
+    /**
+     * Read back the guest view of constants
+     */
+    int read(uint32_t first, float* data, uint32_t count) const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (first >= size() || count > size() - first) return -2;
+        std::memcpy(data, guest[first].data(), count * sizeof(guest[0]));
+        return 0;
+    }
+    
+    /**
+     * Forget the uploaded state so the next flush uploads the whole file
+     * (e.g. after the backend recreates its constant buffer)
+     */
+    void invalidate() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        force_full = true;
+        history.fill(0);
+    }
+    
+    RsxConstantStats get_stats() const {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        return stats;
+    }
+    
+    void reset_stats() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        stats = RsxConstantStats();
+    }
+};
+
+// ============================================================================
+// Shader Corpus Capture
+// ============================================================================
+
+/**
+ * Dumps every unique VP/FP microcode blob and pipeline state the compiler
+ * sees into a directory, for offline replay by rsx_shader_bench.
+ *
+ * Layout: vp_<hash>.bin / fp_<hash>.bin hold the raw microcode words as
+ * passed to compile; pipelines.bin is a stream of oc_rsx_corpus_pipeline_t.
+ * Hashes are the compiler's microcode hashes, so an existing corpus
+ * directory can be appended to across sessions without duplicating shaders.
+ */
+struct ShaderCorpusWriter {
+    std::atomic<bool> enabled{false};
+    std::string dir;
+    FILE* pipelines = nullptr;
+    std::unordered_set<uint64_t> seen_vertex;
+    std::unordered_set<uint64_t> seen_fragment;
+    std::unordered_set<uint64_t> seen_pipelines;
+    uint64_t vertex_written = 0;
+    uint64_t fragment_written = 0;
+    uint64_t pipelines_written = 0;
+    oc_mutex mutex;
+
+    ~ShaderCorpusWriter() {
+        end();
+    }
+
+    static PipelineState pipeline_state_from_record(const oc_rsx_corpus_pipeline_t& record) {
+        PipelineState state;
+        state.vertex_shader_hash = record.vs_hash;
+        state.fragment_shader_hash = record.fs_hash;
+        state.vertex_attribute_mask = record.vertex_mask;
+        state.cull_mode = record.cull_mode;
+        state.blend_enable = record.blend_enable != 0;
+        return state;
+    }
+
+    bool begin(const char* path) {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (pipelines) return false;
+        std::string file = std::string(path) + "/pipelines.bin";
+        seen_vertex.clear();
+        seen_fragment.clear();
+        seen_pipelines.clear();
+
+        // Pipelines recorded by earlier sessions are not written again
+        if (FILE* existing = std::fopen(file.c_str(), "rb")) {
+            oc_rsx_corpus_pipeline_t record;
+            while (std::fread(&record, sizeof(record), 1, existing) == 1) {
+                seen_pipelines.insert(pipeline_state_from_record(record).compute_hash());
+            }
+            std::fclose(existing);
+        }
+        pipelines = std::fopen(file.c_str(), "ab");
+        if (!pipelines) return false;
+        dir = path;
+        enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void end() {
+        oc_lock_guard<oc_mutex> lock(mutex);
+        enabled.store(false, std::memory_order_release);
+        if (pipelines) {
+            std::fclose(pipelines);
+            pipelines = nullptr;
+        }
+    }
+
+    void record_shader(bool is_vertex, uint64_t hash, const uint32_t* code, size_t size) {
+        if (!enabled.load(std::memory_order_acquire)) return;
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (!pipelines) return;
+        auto& seen = is_vertex ? seen_vertex : seen_fragment;
+        if (!seen.insert(hash).second) return;
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "/%s_%016llx.bin", is_vertex ? "vp" : "fp",
+                      static_cast<unsigned long long>(hash));
+        std::string file = dir + name;
+        if (FILE* existing = std::fopen(file.c_str(), "rb")) {
+            std::fclose(existing);
+            return;
+        }
+        FILE* f = std::fopen(file.c_str(), "wb");
+        if (!f) return;
+        size_t written = std::fwrite(code, sizeof(uint32_t), size, f);
+        std::fclose(f);
+        if (written != size) {
+            std::remove(file.c_str());
+            return;
+        }
+        (is_vertex ? vertex_written : fragment_written)++;
+    }
+
+    void record_pipeline(const PipelineState& state) {
+        if (!enabled.load(std::memory_order_acquire)) return;
+        oc_lock_guard<oc_mutex> lock(mutex);
+        if (!pipelines || !seen_pipelines.insert(state.compute_hash()).second) return;
+
+        oc_rsx_corpus_pipeline_t record;
+        std::memset(&record, 0, sizeof(record));
+        record.vs_hash = state.vertex_shader_hash;
+        record.fs_hash = state.fragment_shader_hash;
+        record.vertex_mask = state.vertex_attribute_mask;
+        record.cull_mode = state.cull_mode;
+        record.blend_enable = state.blend_enable ? 1 : 0;
+        if (std::fwrite(&record, sizeof(record), 1, pipelines) == 1) {
+            std::fflush(pipelines);
+            pipelines_written++;
+        }
     }
 };
 
@@ -649,6 +1116,93 @@ struct PipelineCache {
 // RSX Shader Compiler Structure
 // ============================================================================
 
+/**
+ * Translated SPIR-V keyed by guest program hash
+ * 
+ * Callers hold the shader handle's mutex. Entries are charged to the cache
+ * memory budget and the least recently used are evicted to its target.
+ */
+struct SpirvCache {
+    struct Entry {
+        std::vector<uint32_t> spirv;
+        std::list<uint64_t>::iterator lru_entry;
+    };
+    
+    std::unordered_map<uint64_t, Entry> entries;
+    size_t total_bytes;
+    std::list<uint64_t> lru;  // Program hashes, least recently used first
+    std::atomic<uint64_t> lookups;
+    int budget_client;
+    
+    explicit SpirvCache(const char* name) : total_bytes(0), lookups(0) {
+        budget_client = oc_mem_budget_register(name, budget_lookups, this);
+    }
+    
+    ~SpirvCache() {
+        clear();
+        oc_mem_budget_unregister(budget_client);
+    }
+    
+    static uint64_t budget_lookups(void* user_data) {
+        return static_cast<SpirvCache*>(user_data)->lookups.load(std::memory_order_relaxed);
+    }
+    
+    static size_t footprint(const Entry& entry) {
+        return sizeof(Entry) + entry.spirv.capacity() * sizeof(uint32_t);
+    }
+    
+    const std::vector<uint32_t>* find(uint64_t hash) {
+        lookups.fetch_add(1, std::memory_order_relaxed);
+        auto it = entries.find(hash);
+        if (it == entries.end()) return nullptr;
+        lru.splice(lru.end(), lru, it->second.lru_entry);
+        return &it->second.spirv;
+    }
+    
+    void store(uint64_t hash, const std::vector<uint32_t>& spirv) {
+        auto existing = entries.find(hash);
+        if (existing != entries.end()) {
+            size_t bytes = footprint(existing->second);
+            total_bytes -= bytes;
+            oc_mem_budget_release(budget_client, bytes);
+            lru.erase(existing->second.lru_entry);
+            entries.erase(existing);
+        }
+        
+        Entry entry{spirv, {}};
+        size_t bytes = footprint(entry);
+        uint64_t target = oc_mem_budget_get_target(budget_client);
+        while (!entries.empty() && total_bytes + bytes > target) {
+            evict_lru();
+        }
+        
+        entry.lru_entry = lru.insert(lru.end(), hash);
+        entries.emplace(hash, std::move(entry));
+        total_bytes += bytes;
+        oc_mem_budget_insert(budget_client, hash, bytes);
+    }
+    
+    void evict_lru() {
+        auto victim = entries.find(lru.front());
+        size_t bytes = footprint(victim->second);
+        total_bytes -= bytes;
+        oc_mem_budget_evict(budget_client, victim->first, bytes);
+        lru.pop_front();
+        entries.erase(victim);
+    }
+    
+    size_t size() const {
+        return entries.size();
+    }
+    
+    void clear() {
+        oc_mem_budget_release(budget_client, total_bytes);
+        entries.clear();
+        lru.clear();
+        total_bytes = 0;
+    }
+};
+
 /**
  * RSX shader compiler handle
  */
@@ -656,10 +1210,20 @@ struct oc_rsx_shader_t {
     SpirVBuilder builder;
     ShaderLinker linker;
     PipelineCache pipeline_cache;
-    std::unordered_map<uint64_t, std::vector<uint32_t>> vertex_cache;
-    std::unordered_map<uint64_t, std::vector<uint32_t>> fragment_cache;
+    SpirvCache vertex_cache{"rsx_vertex_spirv"};
+    SpirvCache fragment_cache{"rsx_fragment_spirv"};
+    RsxConstantFile vertex_constants{RSX_VP_CONSTANT_COUNT};
+    RsxConstantFile fragment_constants{RSX_FP_CONSTANT_COUNT};
+    ShaderCorpusWriter corpus;
     oc_mutex mutex;
     bool enabled;
+    std::atomic<bool> remote_compile{false};   // Translate in the compile server
+    
+    RsxConstantFile* constant_file(int file) {
+        if (file == OC_RSX_CONST_VERTEX) return &vertex_constants;
+        if (file == OC_RSX_CONST_FRAGMENT) return &fragment_constants;
+        return nullptr;
+    }
     
     oc_rsx_shader_t() : enabled(true) {
         builder.init_types();
@@ -670,6 +1234,24 @@ struct oc_rsx_shader_t {
 // Helper Functions
 // ============================================================================
 
+/**
+ * Translate a program in the compile server, if enabled and running
+ */
+static bool compile_remote(oc_rsx_shader_t* shader, int kind, const uint32_t* code, size_t size,
+                           std::vector<uint32_t>& spirv) {
+    if (!shader->remote_compile.load(std::memory_order_relaxed) || !oc_compile_server_is_running()) {
+        return false;
+    }
+    thread_local std::vector<uint32_t> response(OC_COMPILE_SERVER_MAX_MESSAGE / sizeof(uint32_t));
+    size_t bytes = 0;
+    if (oc_compile_server_submit(kind, 0, code, size * sizeof(uint32_t), response.data(),
+                                 response.size() * sizeof(uint32_t), &bytes) != 0) {
+        return false;
+    }
+    spirv.assign(response.begin(), response.begin() + bytes / sizeof(uint32_t));
+    return true;
+}
+
 /**
  * Compute hash for shader bytecode
  */
@@ -781,38 +1363,44 @@ int oc_rsx_shader_compile_vertex(oc_rsx_shader_t* shader, const uint32_t* code,
     
     uint64_t hash = compute_shader_hash(code, size);
     
+    // Captured on hits too, so a capture started mid-session still sees
+    // programs compiled before it; the corpus skips hashes it already has
+    shader->corpus.record_shader(true, hash, code, size);
+    
     // Check cache
     {
         oc_lock_guard<oc_mutex> lock(shader->mutex);
-        auto it = shader->vertex_cache.find(hash);
-        if (it != shader->vertex_cache.end()) {
-            *out_size = it->second.size();
+        if (const auto* cached = shader->vertex_cache.find(hash)) {
+            *out_size = cached->size();
             *out_spirv = new (std::nothrow) uint32_t[*out_size];
             if (*out_spirv) {
-                memcpy(*out_spirv, it->second.data(), *out_size * sizeof(uint32_t));
+                memcpy(*out_spirv, cached->data(), *out_size * sizeof(uint32_t));
             }
             return 0;
         }
     }
     
     // Compile new shader
-    SpirVBuilder builder;
-    builder.init_types();
-    
-    // Generate SPIR-V for vertex shader
-    // In a full implementation, this would:
-    // 1. Decode all VP instructions
-    // 2. Generate SPIR-V IR for each instruction
-    // 3. Handle inputs (vertex attributes)
-    // 4. Handle outputs (varyings to fragment shader)
-    // 5. Handle uniforms (constants, matrices)
-    
-    std::vector<uint32_t> spirv = builder.build();
+    std::vector<uint32_t> spirv;
+    if (!compile_remote(shader, OC_COMPILE_KIND_RSX_VERTEX, code, size, spirv)) {
+        SpirVBuilder builder;
+        builder.init_types();
+        
+        // Generate SPIR-V for vertex shader
+        // In a full implementation, this would:
+        // 1. Decode all VP instructions
+        // 2. Generate SPIR-V IR for each instruction
+        // 3. Handle inputs (vertex attributes)
+        // 4. Handle outputs (varyings to fragment shader)
+        // 5. Handle uniforms (constants, matrices)
+        
+        spirv = builder.build();
+    }
     
     // Cache result
     {
         oc_lock_guard<oc_mutex> lock(shader->mutex);
-        shader->vertex_cache[hash] = spirv;
+        shader->vertex_cache.store(hash, spirv);
     }
     
     *out_size = spirv.size();
@@ -832,37 +1420,42 @@ int oc_rsx_shader_compile_fragment(oc_rsx_shader_t* shader, const uint32_t* code
     
     uint64_t hash = compute_shader_hash(code, size);
     
+    // Captured on hits too, as for vertex programs
+    shader->corpus.record_shader(false, hash, code, size);
+    
     // Check cache
     {
         oc_lock_guard<oc_mutex> lock(shader->mutex);
-        auto it = shader->fragment_cache.find(hash);
-        if (it != shader->fragment_cache.end()) {
-            *out_size = it->second.size();
+        if (const auto* cached = shader->fragment_cache.find(hash)) {
+            *out_size = cached->size();
             *out_spirv = new (std::nothrow) uint32_t[*out_size];
             if (*out_spirv) {
-                memcpy(*out_spirv, it->second.data(), *out_size * sizeof(uint32_t));
+                memcpy(*out_spirv, cached->data(), *out_size * sizeof(uint32_t));
             }
             return 0;
         }
     }
     
     // Compile new shader
-    SpirVBuilder builder;
-    builder.init_types();
-    
-    // Generate SPIR-V for fragment shader
-    // Similar to vertex shader, but handles:
-    // 1. Fragment inputs (varyings from vertex shader)
-    // 2. Fragment outputs (color attachments)
-    // 3. Texture sampling operations
-    // 4. Discard (KIL instruction)
-    
-    std::vector<uint32_t> spirv = builder.build();
+    std::vector<uint32_t> spirv;
+    if (!compile_remote(shader, OC_COMPILE_KIND_RSX_FRAGMENT, code, size, spirv)) {
+        SpirVBuilder builder;
+        builder.init_types();
+        
+        // Generate SPIR-V for fragment shader
+        // Similar to vertex shader, but handles:
+        // 1. Fragment inputs (varyings from vertex shader)
+        // 2. Fragment outputs (color attachments)
+        // 3. Texture sampling operations
+        // 4. Discard (KIL instruction)
+        
+        spirv = builder.build();
+    }
     
     // Cache result
     {
         oc_lock_guard<oc_mutex> lock(shader->mutex);
-        shader->fragment_cache[hash] = spirv;
+        shader->fragment_cache.store(hash, spirv);
     }
     
     *out_size = spirv.size();
@@ -880,6 +1473,16 @@ void oc_rsx_shader_free_spirv(uint32_t* spirv) {
     }
 }
 
+void oc_rsx_shader_remote_compile_enable(oc_rsx_shader_t* shader, int enable) {
+    if (!shader) return;
+    shader->remote_compile.store(enable != 0, std::memory_order_relaxed);
+}
+
+int oc_rsx_shader_remote_compile_is_enabled(oc_rsx_shader_t* shader) {
+    if (!shader) return 0;
+    return shader->remote_compile.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
 // Shader Linking APIs
 
 int oc_rsx_shader_link(oc_rsx_shader_t* shader, 
@@ -932,6 +1535,7 @@ void* oc_rsx_shader_get_pipeline(oc_rsx_shader_t* shader,
     state.cull_mode = cull_mode;
     state.blend_enable = blend_enable != 0;
     
+    shader->corpus.record_pipeline(state);
     return shader->pipeline_cache.get_or_create(state);
 }
 
@@ -967,4 +1571,98 @@ size_t oc_rsx_shader_get_fragment_cache_count(oc_rsx_shader_t* shader) {
     return shader->fragment_cache.size();
 }
 
+// Shader Corpus APIs
+
+int oc_rsx_shader_corpus_begin(oc_rsx_shader_t* shader, const char* dir) {
+    if (!shader || !dir || !*dir) return -1;
+    return shader->corpus.begin(dir) ? 0 : -2;
+}
+
+void oc_rsx_shader_corpus_end(oc_rsx_shader_t* shader) {
+    if (!shader) return;
+    shader->corpus.end();
+}
+
+void oc_rsx_shader_corpus_get_stats(oc_rsx_shader_t* shader, uint64_t* vertex_programs,
+                                     uint64_t* fragment_programs, uint64_t* pipelines) {
+    if (vertex_programs) *vertex_programs = 0;
+    if (fragment_programs) *fragment_programs = 0;
+    if (pipelines) *pipelines = 0;
+    if (!shader) return;
+    oc_lock_guard<oc_mutex> lock(shader->corpus.mutex);
+    if (vertex_programs) *vertex_programs = shader->corpus.vertex_written;
+    if (fragment_programs) *fragment_programs = shader->corpus.fragment_written;
+    if (pipelines) *pipelines = shader->corpus.pipelines_written;
+}
+
+// Constant File APIs
+
+uint32_t oc_rsx_constants_get_count(oc_rsx_shader_t* shader, int file) {
+    if (!shader) return 0;
+    RsxConstantFile* cf = shader->constant_file(file);
+    return cf ? cf->size() : 0;
+}
+
+int oc_rsx_constants_write(oc_rsx_shader_t* shader, int file, uint32_t first,
+                           const float* data, uint32_t count) {
+    if (!shader || !data) return -1;
+    RsxConstantFile* cf = shader->constant_file(file);
+    if (!cf) return -1;
+    if (count == 0) return 0;
+    return cf->write(first, data, count);
+}
+
+int oc_rsx_constants_read(oc_rsx_shader_t* shader, int file, uint32_t first,
+                          float* data, uint32_t count) {
+    if (!shader || !data) return -1;
+    RsxConstantFile* cf = shader->constant_file(file);
+    if (!cf) return -1;
+    if (count == 0) return 0;
+    return cf->read(first, data, count);
+}
+
+int oc_rsx_constants_flush(oc_rsx_shader_t* shader, int file,
+                           oc_rsx_const_range_t* ranges, size_t max_ranges,
+                           size_t* out_count, uint64_t* out_hash) {
+    if (!shader || !ranges || max_ranges == 0 || !out_count) return -1;
+    *out_count = 0;
+    RsxConstantFile* cf = shader->constant_file(file);
+    if (!cf) return -1;
+    return cf->flush(ranges, max_ranges, out_count, out_hash);
+}
+
+void oc_rsx_constants_invalidate(oc_rsx_shader_t* shader, int file) {
+    if (!shader) return;
+    RsxConstantFile* cf = shader->constant_file(file);
+    if (cf) cf->invalidate();
+}
+
+void oc_rsx_constants_get_stats(oc_rsx_shader_t* shader, int file,
+                                uint64_t* writes, uint64_t* flushes,
+                                uint64_t* clean_flushes, uint64_t* reused_flushes,
+                                uint64_t* ranges_emitted, uint64_t* constants_uploaded) {
+    if (writes) *writes = 0;
+    if (flushes) *flushes = 0;
+    if (clean_flushes) *clean_flushes = 0;
+    if (reused_flushes) *reused_flushes = 0;
+    if (ranges_emitted) *ranges_emitted = 0;
+    if (constants_uploaded) *constants_uploaded = 0;
+    if (!shader) return;
+    RsxConstantFile* cf = shader->constant_file(file);
+    if (!cf) return;
+    auto stats = cf->get_stats();
+    if (writes) *writes = stats.writes;
+    if (flushes) *flushes = stats.flushes;
+    if (clean_flushes) *clean_flushes = stats.clean_flushes;
+    if (reused_flushes) *reused_flushes = stats.reused_flushes;
+    if (ranges_emitted) *ranges_emitted = stats.ranges_emitted;
+    if (constants_uploaded) *constants_uploaded = stats.constants_uploaded;
+}
+
+void oc_rsx_constants_reset_stats(oc_rsx_shader_t* shader, int file) {
+    if (!shader) return;
+    RsxConstantFile* cf = shader->constant_file(file);
+    if (cf) cf->reset_stats();
+}
+
 } // extern "C"
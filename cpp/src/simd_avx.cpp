@@ -25,11 +25,6 @@
 // Runtime CPU Feature Detection
 // ============================================================================
 
-// Feature flags
-static constexpr int OC_SIMD_SCALAR = 0;
-static constexpr int OC_SIMD_SSE42  = 1;
-static constexpr int OC_SIMD_AVX2   = 2;
-
 static int g_simd_level = -1;  // -1 = not detected yet
 
 static int detect_simd_level() {
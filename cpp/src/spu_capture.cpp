@@ -0,0 +1,415 @@
+/**
+ * SPU job capture and replay
+ *
+ * Capture records one SPU job to a file: the local store image and registers
+ * at the start, every DMA transfer issued on the job's local store (the bytes
+ * a GET delivered and the bytes a PUT wrote, with their addresses), and the
+ * registers and a local store hash at the end.
+ *
+ * Replay restores the starting state and services the job's DMA from the
+ * file instead of main memory, so the job re-executes deterministically
+ * without the rest of the system. PUTs are compared against the captured
+ * data and the final state against the captured end state.
+ *
+ * File layout (host byte order):
+ *   CaptureHeader, CapturedState (start), local store image,
+ *   { CaptureRecord, data[size] } ..., CaptureRecord (END), CapturedState (end)
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <atomic>
+
+// SPU local store size (256KB)
+static constexpr uint32_t SPU_LS_SIZE = 0x40000;
+
+static constexpr char CAPTURE_MAGIC[8] = {'O', 'C', 'S', 'P', 'U', 'J', 'O', 'B'};
+static constexpr uint32_t CAPTURE_VERSION = 1;
+
+// Largest single transfer, and list entry limit (match dma.cpp)
+static constexpr uint32_t MAX_DMA_SIZE = 16384;
+static constexpr uint32_t MAX_LIST_ENTRIES = 2048;
+
+enum CaptureRecordKind : uint32_t {
+    CAPTURE_GET = 1,
+    CAPTURE_PUT = 2,
+    CAPTURE_END = 3,
+};
+
+struct CaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t spu_id;
+    uint32_t ls_size;
+    uint32_t reserved;
+};
+
+// Architectural state saved at the start and end of a job
+struct CapturedState {
+    uint32_t gpr[128][4];
+    uint32_t pc;
+    uint32_t decrementer;
+    uint32_t mfc_tag_mask;
+    uint32_t event_mask;
+    uint32_t srr0;
+    uint32_t reserved;
+    uint64_t ls_hash;           // End state only
+};
+
+struct CaptureRecord {
+    uint32_t kind;
+    uint32_t local_addr;
+    uint64_t ea;
+    uint32_t size;
+    uint32_t tag;
+};
+
+// FNV-1a over the local store, 8 bytes at a time
+static uint64_t hash_local_store(const uint8_t* ls) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint32_t i = 0; i < SPU_LS_SIZE; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, ls + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static void save_state(const oc_spu_context_t* ctx, CapturedState& state) {
+    std::memset(&state, 0, sizeof(state));
+    std::memcpy(state.gpr, ctx->gpr, sizeof(state.gpr));
+    state.pc = ctx->pc;
+    state.decrementer = ctx->decrementer;
+    state.mfc_tag_mask = ctx->mfc_tag_mask;
+    state.event_mask = ctx->event_mask;
+    state.srr0 = ctx->srr0;
+}
+
+// MFC command classes; list variants have bit 2 set
+static bool is_get_command(uint8_t cmd) { return (cmd & 0xF0) == 0x40; }
+static bool is_put_command(uint8_t cmd) { return (cmd & 0xF0) == 0x20; }
+static bool is_list_command(uint8_t cmd) { return (cmd & 0x04) != 0; }
+
+// ============================================================================
+// Capture
+// ============================================================================
+
+struct SpuJobCapture {
+    std::atomic<bool> active{false};
+    const uint8_t* local_storage = nullptr;  // The captured job's LS
+    FILE* file = nullptr;
+    bool failed = false;
+    uint64_t records = 0;
+    oc_mutex mutex;
+
+    void write(const void* data, size_t size) {
+        if (!failed && std::fwrite(data, 1, size, file) != size) failed = true;
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+        local_storage = nullptr;
+        active.store(false, std::memory_order_release);
+    }
+};
+
+static SpuJobCapture g_spu_capture;
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+struct ReplayRecord {
+    uint32_t kind;
+    uint32_t local_addr;
+    uint64_t ea;
+    uint32_t size;
+    uint32_t tag;
+    size_t data_offset;         // Into oc_spu_replay_t::data
+};
+
+struct oc_spu_replay_t {
+    CaptureHeader header;
+    CapturedState start;
+    CapturedState end;
+    bool has_end = false;
+    std::vector<uint8_t> ls_image;
+    std::vector<uint8_t> data;
+    std::vector<ReplayRecord> records;
+    oc_spu_replay_info_t info = {};
+
+    // Per-run state
+    size_t cursor = 0;
+    bool diverged = false;
+    uint32_t put_mismatches = 0;
+
+    /**
+     * Service one transfer from the capture.
+     * Returns 0 on success, 1 if a PUT's data differs, -1 if the transfer
+     * does not match the next captured one.
+     */
+    int service(uint8_t* ls, uint32_t local_addr, uint64_t ea, uint32_t size, bool is_put) {
+        if (diverged) return -1;
+        if (cursor >= records.size() || size == 0 || local_addr + size > SPU_LS_SIZE) {
+            diverged = true;
+            return -1;
+        }
+        // Compare the 32-bit EA only: the runtime may or may not fold EAH in
+        const ReplayRecord& rec = records[cursor];
+        if (rec.kind != (is_put ? CAPTURE_PUT : CAPTURE_GET) || rec.local_addr != local_addr ||
+            static_cast<uint32_t>(rec.ea) != static_cast<uint32_t>(ea) || rec.size != size) {
+            diverged = true;
+            return -1;
+        }
+        cursor++;
+        const uint8_t* captured = data.data() + rec.data_offset;
+        if (!is_put) {
+            std::memcpy(ls + local_addr, captured, size);
+            return 0;
+        }
+        if (std::memcmp(ls + local_addr, captured, size) != 0) {
+            put_mismatches++;
+            return 1;
+        }
+        return 0;
+    }
+};
+
+static bool read_exact(FILE* f, void* out, size_t size) {
+    return std::fread(out, 1, size, f) == size;
+}
+
+extern "C" {
+
+// ============================================================================
+// SPU Job Capture
+// ============================================================================
+
+int oc_spu_capture_begin(const char* path, const oc_spu_context_t* context) {
+    if (!path || !context || !context->local_storage) return -1;
+    auto& cap = g_spu_capture;
+    oc_lock_guard<oc_mutex> lock(cap.mutex);
+    if (cap.active.load()) return -2;
+
+    cap.file = std::fopen(path, "wb");
+    if (!cap.file) return -3;
+    cap.failed = false;
+    cap.records = 0;
+    cap.local_storage = static_cast<const uint8_t*>(context->local_storage);
+
+    CaptureHeader header = {};
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.spu_id = context->spu_id;
+    header.ls_size = SPU_LS_SIZE;
+    CapturedState start;
+    save_state(context, start);
+    cap.write(&header, sizeof(header));
+    cap.write(&start, sizeof(start));
+    cap.write(cap.local_storage, SPU_LS_SIZE);
+    if (cap.failed) {
+        cap.close();
+        return -3;
+    }
+    cap.active.store(true, std::memory_order_release);
+    return 0;
+}
+
+int oc_spu_capture_is_active(void) {
+    return g_spu_capture.active.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+void oc_spu_capture_record_dma(const void* local_storage, uint32_t local_addr,
+                               uint64_t ea, uint32_t size, uint16_t tag, int is_put) {
+    auto& cap = g_spu_capture;
+    if (!cap.active.load(std::memory_order_acquire)) return;
+    if (size == 0 || local_addr + size > SPU_LS_SIZE) return;
+
+    oc_lock_guard<oc_mutex> lock(cap.mutex);
+    if (!cap.active.load() || local_storage != cap.local_storage) return;
+    CaptureRecord rec = {is_put ? CAPTURE_PUT : CAPTURE_GET, local_addr, ea, size, tag};
+    cap.write(&rec, sizeof(rec));
+    cap.write(cap.local_storage + local_addr, size);
+    cap.records++;
+}
+
+int64_t oc_spu_capture_end(const oc_spu_context_t* context) {
+    auto& cap = g_spu_capture;
+    oc_lock_guard<oc_mutex> lock(cap.mutex);
+    if (!cap.active.load()) return -1;
+    if (!context || context->local_storage != cap.local_storage) {
+        cap.close();
+        return -1;
+    }
+
+    CaptureRecord rec = {CAPTURE_END, 0, 0, 0, 0};
+    CapturedState end;
+    save_state(context, end);
+    end.ls_hash = hash_local_store(cap.local_storage);
+    cap.write(&rec, sizeof(rec));
+    cap.write(&end, sizeof(end));
+    if (!cap.failed && std::fflush(cap.file) != 0) cap.failed = true;
+
+    bool failed = cap.failed;
+    int64_t records = static_cast<int64_t>(cap.records);
+    cap.close();
+    return failed ? -3 : records;
+}
+
+void oc_spu_capture_abort(void) {
+    auto& cap = g_spu_capture;
+    oc_lock_guard<oc_mutex> lock(cap.mutex);
+    if (cap.active.load()) cap.close();
+}
+
+// ============================================================================
+// SPU Job Replay
+// ============================================================================
+
+oc_spu_replay_t* oc_spu_replay_open(const char* path) {
+    if (!path) return nullptr;
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return nullptr;
+
+    auto* replay = new oc_spu_replay_t();
+    bool ok = read_exact(f, &replay->header, sizeof(replay->header)) &&
+              std::memcmp(replay->header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0 &&
+              replay->header.version == CAPTURE_VERSION &&
+              replay->header.ls_size == SPU_LS_SIZE &&
+              read_exact(f, &replay->start, sizeof(replay->start));
+    if (ok) {
+        replay->ls_image.resize(SPU_LS_SIZE);
+        ok = read_exact(f, replay->ls_image.data(), SPU_LS_SIZE);
+    }
+
+    auto& info = replay->info;
+    info.spu_id = replay->header.spu_id;
+    info.entry_pc = replay->start.pc;
+    CaptureRecord rec;
+    while (ok && read_exact(f, &rec, sizeof(rec))) {
+        if (rec.kind == CAPTURE_END) {
+            replay->has_end = read_exact(f, &replay->end, sizeof(replay->end));
+            break;
+        }
+        if ((rec.kind != CAPTURE_GET && rec.kind != CAPTURE_PUT) ||
+            rec.size == 0 || rec.size > MAX_DMA_SIZE || rec.local_addr + rec.size > SPU_LS_SIZE) {
+            ok = false;
+            break;
+        }
+        size_t offset = replay->data.size();
+        replay->data.resize(offset + rec.size);
+        if (!read_exact(f, replay->data.data() + offset, rec.size)) {
+            ok = false;
+            break;
+        }
+        replay->records.push_back({rec.kind, rec.local_addr, rec.ea, rec.size, rec.tag, offset});
+        if (rec.kind == CAPTURE_GET) {
+            info.gets++;
+            info.get_bytes += rec.size;
+        } else {
+            info.puts++;
+            info.put_bytes += rec.size;
+        }
+    }
+    std::fclose(f);
+
+    // A capture cut short (no end record) still replays, but cannot be verified
+    if (!ok) {
+        delete replay;
+        return nullptr;
+    }
+    info.has_end_state = replay->has_end ? 1 : 0;
+    return replay;
+}
+
+void oc_spu_replay_close(oc_spu_replay_t* replay) {
+    delete replay;
+}
+
+void oc_spu_replay_get_info(const oc_spu_replay_t* replay, oc_spu_replay_info_t* info) {
+    if (!info) return;
+    std::memset(info, 0, sizeof(*info));
+    if (replay) *info = replay->info;
+}
+
+int oc_spu_replay_reset(oc_spu_replay_t* replay, oc_spu_context_t* context) {
+    if (!replay || !context || !context->local_storage) return -1;
+    std::memcpy(context->local_storage, replay->ls_image.data(), SPU_LS_SIZE);
+    std::memcpy(context->gpr, replay->start.gpr, sizeof(context->gpr));
+    context->pc = replay->start.pc;
+    context->next_pc = replay->start.pc;
+    context->decrementer = replay->start.decrementer;
+    context->mfc_tag_mask = replay->start.mfc_tag_mask;
+    context->event_mask = replay->start.event_mask;
+    context->srr0 = replay->start.srr0;
+    context->spu_id = static_cast<uint8_t>(replay->header.spu_id);
+    context->local_storage_size = SPU_LS_SIZE;
+    context->exit_reason = OC_SPU_EXIT_NORMAL;
+    replay->cursor = 0;
+    replay->diverged = false;
+    replay->put_mismatches = 0;
+    return 0;
+}
+
+int oc_spu_replay_dma(oc_spu_replay_t* replay, void* local_storage, uint32_t local_addr,
+                      uint64_t ea, uint32_t size, uint16_t /*tag*/, uint8_t cmd) {
+    if (!replay || !local_storage) return -1;
+    if (is_list_command(cmd) || (!is_get_command(cmd) && !is_put_command(cmd))) return -2;
+    return replay->service(static_cast<uint8_t*>(local_storage), local_addr, ea, size,
+                           is_put_command(cmd));
+}
+
+int oc_spu_replay_dma_list(oc_spu_replay_t* replay, void* local_storage, uint32_t list_addr,
+                           uint32_t list_size, uint16_t /*tag*/, uint8_t cmd) {
+    if (!replay || !local_storage) return -1;
+    if (!is_list_command(cmd) || (!is_get_command(cmd) && !is_put_command(cmd))) return -2;
+    bool is_put = is_put_command(cmd);
+
+    // Walk the list the way oc_dma_list_transfer does: 8-byte big-endian
+    // elements, data packed after the list
+    uint8_t* ls = static_cast<uint8_t*>(local_storage);
+    uint32_t data_offset = list_addr + list_size;
+    int result = 0;
+    for (uint32_t i = 0; i < MAX_LIST_ENTRIES && (i + 1) * 8 <= list_size; i++) {
+        uint32_t offset = list_addr + i * 8;
+        if (offset + 8 > SPU_LS_SIZE) return -1;
+        uint32_t size_and_stall, ea_low;
+        std::memcpy(&size_and_stall, ls + offset, 4);
+        std::memcpy(&ea_low, ls + offset + 4, 4);
+        size_and_stall = __builtin_bswap32(size_and_stall);
+        uint32_t size = size_and_stall & 0x7FFF;
+
+        if (size > 0 && size <= MAX_DMA_SIZE && data_offset + size <= SPU_LS_SIZE) {
+            int r = replay->service(ls, data_offset, __builtin_bswap32(ea_low), size, is_put);
+            if (r < 0) return r;
+            if (r > 0) result = 1;
+            data_offset += size;
+        }
+        if (size_and_stall >> 31) break;
+    }
+    return result;
+}
+
+int oc_spu_replay_verify(oc_spu_replay_t* replay, const oc_spu_context_t* context) {
+    if (!replay || !context || !context->local_storage) return -1;
+    int result = 0;
+    if (replay->diverged) result |= OC_SPU_REPLAY_DMA_DIVERGED;
+    else if (replay->cursor != replay->records.size()) result |= OC_SPU_REPLAY_DMA_INCOMPLETE;
+    if (replay->put_mismatches) result |= OC_SPU_REPLAY_PUT_DIFFERS;
+    if (!replay->has_end) return result | OC_SPU_REPLAY_NO_END_STATE;
+
+    if (std::memcmp(context->gpr, replay->end.gpr, sizeof(context->gpr)) != 0) {
+        result |= OC_SPU_REPLAY_REGS_DIFFER;
+    }
+    if (hash_local_store(static_cast<const uint8_t*>(context->local_storage)) != replay->end.ls_hash) {
+        result |= OC_SPU_REPLAY_LS_DIFFERS;
+    }
+    return result;
+}
+
+} // extern "C"
@@ -13,15 +13,18 @@
 
 #include "oc_ffi.h"
 #include "oc_threading.h"
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <unordered_map>
+#include <list>
 #include <vector>
 #include <memory>
 #include <queue>
 #include <atomic>
 #include <algorithm>
 #include <array>
+#include <chrono>
 
 #ifdef HAVE_LLVM
 #include <llvm/IR/LLVMContext.h>
@@ -31,6 +34,7 @@
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/MCJIT.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
@@ -56,45 +60,111 @@ struct SpuBasicBlock {
     std::vector<uint32_t> instructions;
     void* compiled_code;
     size_t code_size;
+    bool is_placeholder;                 // compiled_code is a stand-in buffer, not executable
     
     // Block merging support: CFG edges
     std::vector<uint32_t> successors;    // Addresses of successor blocks
     std::vector<uint32_t> predecessors;  // Addresses of predecessor blocks
     bool is_fallthrough;                 // True if block falls through to next
     bool can_merge;                      // True if block can be merged with successor
+    std::list<uint32_t>::iterator lru_entry;  // Position in the cache's recency list
     
 #ifdef HAVE_LLVM
     std::unique_ptr<llvm::Function> llvm_func;
 #endif
     
+    // Host memory held by the block, as charged to the cache budget
+    size_t footprint() const {
+        return code_size + sizeof(SpuBasicBlock) + instructions.capacity() * sizeof(uint32_t);
+    }
+    
     SpuBasicBlock(uint32_t start) 
         : start_address(start), end_address(start), compiled_code(nullptr), code_size(0),
-          is_fallthrough(false), can_merge(false) {}
+          is_placeholder(false), is_fallthrough(false), can_merge(false) {}
 };
 
 /**
  * SPU Code cache
+ * 
+ * Owned by one SPU thread. Sizes are block footprints, charged to the
+ * runtime-wide cache memory budget; inserting evicts least recently used
+ * blocks down to the smaller of max_size and the budget target. A recency
+ * list makes each lookup and eviction O(1). Only the lookup counters are
+ * read from other threads.
  */
 struct SpuCodeCache {
-    std::unordered_map<uint32_t, std::unique_ptr<SpuBasicBlock>> blocks;
+    using BlockMap = std::unordered_map<uint32_t, std::unique_ptr<SpuBasicBlock>>;
+    
+    BlockMap blocks;
     size_t total_size;
     size_t max_size;
+    std::list<uint32_t> lru;  // Block addresses, least recently used first
+    std::atomic<uint64_t> lookups;
+    int budget_client;
     
-    SpuCodeCache() : total_size(0), max_size(64 * 1024 * 1024) {} // 64MB cache
+    SpuCodeCache() : total_size(0), max_size(64 * 1024 * 1024), // 64MB cache
+                     lookups(0) {
+        budget_client = oc_mem_budget_register("spu_code", budget_lookups, this);
+    }
+    
+    ~SpuCodeCache() {
+        clear();
+        oc_mem_budget_unregister(budget_client);
+    }
+    
+    static uint64_t budget_lookups(void* user_data) {
+        return static_cast<SpuCodeCache*>(user_data)->lookups.load(std::memory_order_relaxed);
+    }
     
     SpuBasicBlock* find_block(uint32_t address) {
+        lookups.fetch_add(1, std::memory_order_relaxed);
         auto it = blocks.find(address);
-        return (it != blocks.end()) ? it->second.get() : nullptr;
+        if (it == blocks.end()) return nullptr;
+        lru.splice(lru.end(), lru, it->second->lru_entry);
+        return it->second.get();
     }
     
     void insert_block(uint32_t address, std::unique_ptr<SpuBasicBlock> block) {
-        total_size += block->code_size;
+        invalidate(address);
+        
+        size_t size = block->footprint();
+        size_t limit = std::min<size_t>(max_size, oc_mem_budget_get_target(budget_client));
+        while (!blocks.empty() && total_size + size > limit) {
+            evict_lru();
+        }
+        
+        block->lru_entry = lru.insert(lru.end(), address);
+        total_size += size;
         blocks[address] = std::move(block);
+        oc_mem_budget_insert(budget_client, address, size);
+    }
+    
+    void evict_lru() {
+        auto victim = blocks.find(lru.front());
+        oc_mem_budget_evict(budget_client, victim->first, victim->second->footprint());
+        remove(victim, true);
+    }
+    
+    void invalidate(uint32_t address) {
+        auto it = blocks.find(address);
+        if (it != blocks.end()) remove(it, false);
     }
     
     void clear() {
-        blocks.clear();
-        total_size = 0;
+        while (!blocks.empty()) remove(blocks.begin(), false);
+    }
+    
+private:
+    // Evictions have already been reported to the budget
+    void remove(BlockMap::iterator it, bool evicted) {
+        size_t size = it->second->footprint();
+        if (it->second->compiled_code) {
+            free(it->second->compiled_code);
+        }
+        total_size -= size;
+        if (!evicted) oc_mem_budget_release(budget_client, size);
+        lru.erase(it->second->lru_entry);
+        blocks.erase(it);
     }
 };
 
@@ -612,6 +682,59 @@ struct ChannelManager {
     }
 };
 
+/**
+ * How compiled code reaches a channel
+ */
+enum class SpuChannelPath : uint8_t {
+    Callback = 0,     // Side effects outside the SPU: always call the runtime
+    Direct = 1,       // Plain load/store on an oc_spu_context_t field
+    CountGated = 2,   // Inline while channel_count is non-zero, callback when it would block
+};
+
+/**
+ * Classify a channel access by architectural channel number
+ *
+ * Mailbox queues, MFC command issue, tag update requests and list stall
+ * handling stay on the callbacks because the runtime must act on them
+ * immediately. Everything else is state the runtime keeps in the context.
+ */
+static SpuChannelPath spu_channel_path(uint8_t channel, bool is_write) {
+    if (is_write) {
+        switch (channel) {
+            case OC_SPU_CH_WR_EVENT_MASK:
+            case OC_SPU_CH_WR_EVENT_ACK:
+            case OC_SPU_CH_WR_DEC:
+            case OC_SPU_CH_WR_SRR0:
+            case OC_SPU_CH_MFC_LSA:
+            case OC_SPU_CH_MFC_EAH:
+            case OC_SPU_CH_MFC_EAL:
+            case OC_SPU_CH_MFC_SIZE:
+            case OC_SPU_CH_MFC_TAG_ID:
+            case OC_SPU_CH_WR_TAG_MASK:
+                return SpuChannelPath::Direct;
+            case OC_SPU_CH_WR_OUT_MBOX:
+                return SpuChannelPath::CountGated;
+            default:
+                return SpuChannelPath::Callback;
+        }
+    }
+    switch (channel) {
+        case OC_SPU_CH_RD_DEC:
+        case OC_SPU_CH_RD_EVENT_MASK:
+        case OC_SPU_CH_RD_TAG_MASK:
+        case OC_SPU_CH_RD_SRR0:
+            return SpuChannelPath::Direct;
+        case OC_SPU_CH_RD_EVENT_STAT:
+        case OC_SPU_CH_RD_SIG_NOTIFY1:
+        case OC_SPU_CH_RD_SIG_NOTIFY2:
+        case OC_SPU_CH_RD_TAG_STAT:
+        case OC_SPU_CH_RD_ATOMIC_STAT:
+            return SpuChannelPath::CountGated;
+        default:
+            return SpuChannelPath::Callback;
+    }
+}
+
 /**
  * MFC DMA command types
  */
@@ -655,12 +778,14 @@ struct MfcDmaOperation {
     MfcCommand cmd;         // DMA command
     uint8_t tid;            // Transfer class ID
     uint8_t rid;            // Replacement class ID
+    uint64_t queued_ns;     // Queue time, set only while the DMA heatmap is enabled
     
     MfcDmaOperation()
-        : local_addr(0), ea(0), size(0), tag(0), cmd(MfcCommand::GET), tid(0), rid(0) {}
+        : local_addr(0), ea(0), size(0), tag(0), cmd(MfcCommand::GET), tid(0), rid(0),
+          queued_ns(0) {}
     
     MfcDmaOperation(uint32_t la, uint64_t e, uint32_t s, uint16_t t, MfcCommand c)
-        : local_addr(la), ea(e), size(s), tag(t), cmd(c), tid(0), rid(0) {}
+        : local_addr(la), ea(e), size(s), tag(t), cmd(c), tid(0), rid(0), queued_ns(0) {}
     
     bool is_get() const {
         return (static_cast<uint8_t>(cmd) & 0x40) != 0;
@@ -748,6 +873,11 @@ struct MfcDmaManager {
                cmd == MfcCommand::PUTQLLUC;
     }
     
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
     bool is_barrier_command(MfcCommand cmd) const {
         return cmd == MfcCommand::BARRIER ||
                cmd == MfcCommand::MFCEIEIO ||
@@ -757,7 +887,9 @@ struct MfcDmaManager {
     /**
      * Queue a DMA operation with statistics tracking
      */
-    void queue_operation(const MfcDmaOperation& op) {
+    void queue_operation(MfcDmaOperation op) {
+        if (oc_dma_heatmap_is_enabled()) op.queued_ns = now_ns();
+        
         oc_lock_guard<oc_mutex> lock(mutex);
         pending_ops.push_back(op);
         tag_groups[op.tag].push_back(op);
@@ -890,8 +1022,15 @@ struct MfcDmaManager {
             // Sum up bytes for stats
             auto it = tag_groups.find(tag);
             if (it != tag_groups.end()) {
+                bool instrument = oc_dma_heatmap_is_enabled() != 0;
+                uint64_t done_ns = instrument ? now_ns() : 0;
                 for (const auto& op : it->second) {
                     complete_operation(op.cmd, op.size);
+                    if (instrument && (is_get_command(op.cmd) || is_put_command(op.cmd))) {
+                        uint64_t stall = op.queued_ns ? done_ns - op.queued_ns : 0;
+                        oc_dma_heatmap_record(-1, op.tag, op.ea, op.size,
+                                              is_put_command(op.cmd) ? 1 : 0, stall);
+                    }
                 }
             }
             
@@ -2067,6 +2206,7 @@ static void allocate_spu_placeholder_code(SpuBasicBlock* block) {
     if (block->compiled_code) {
         memset(block->compiled_code, SPU_X86_RET_INSTRUCTION, block->code_size);
     }
+    block->is_placeholder = true;
 }
 
 // Forward declarations for LLVM functions
@@ -2103,14 +2243,10 @@ static void generate_spu_llvm_ir(SpuBasicBlock* block, oc_spu_jit_t* jit = nullp
             
             // If we have a working LLJIT, compile and get the function pointer
             if (jit->jit) {
-                // In a full implementation, we would:
-                // 1. Add the module to the JIT
-                // 2. Lookup the function symbol
-                // 3. Get the function pointer
-                // 4. Store it in block->compiled_code
-                
-                // For now, use placeholder code buffer since full LLJIT
-                // integration requires additional error handling
+                // Not linked yet: the block function keeps the registers in
+                // locals that are neither loaded from nor written back to the
+                // context, so running it would lose the block's results. The
+                // IR is checked through oc_spu_jit_emit_ir instead.
                 allocate_spu_placeholder_code(block);
             } else {
                 // No JIT available, use placeholder
@@ -2132,6 +2268,182 @@ static void generate_spu_llvm_ir(SpuBasicBlock* block, oc_spu_jit_t* jit = nullp
 }
 
 #ifdef HAVE_LLVM
+/**
+ * Offset of the oc_spu_context_t field backing an inlined channel
+ */
+static size_t spu_channel_field(uint8_t channel) {
+    switch (channel) {
+        case OC_SPU_CH_RD_EVENT_STAT: return offsetof(oc_spu_context_t, event_stat);
+        case OC_SPU_CH_WR_EVENT_MASK:
+        case OC_SPU_CH_RD_EVENT_MASK: return offsetof(oc_spu_context_t, event_mask);
+        case OC_SPU_CH_RD_SIG_NOTIFY1: return offsetof(oc_spu_context_t, signal_notify);
+        case OC_SPU_CH_RD_SIG_NOTIFY2: return offsetof(oc_spu_context_t, signal_notify) + 4;
+        case OC_SPU_CH_WR_DEC:
+        case OC_SPU_CH_RD_DEC: return offsetof(oc_spu_context_t, decrementer);
+        case OC_SPU_CH_WR_SRR0:
+        case OC_SPU_CH_RD_SRR0: return offsetof(oc_spu_context_t, srr0);
+        case OC_SPU_CH_MFC_LSA: return offsetof(oc_spu_context_t, mfc_lsa);
+        case OC_SPU_CH_MFC_EAH: return offsetof(oc_spu_context_t, mfc_eah);
+        case OC_SPU_CH_MFC_EAL: return offsetof(oc_spu_context_t, mfc_eal);
+        case OC_SPU_CH_MFC_SIZE: return offsetof(oc_spu_context_t, mfc_size);
+        case OC_SPU_CH_MFC_TAG_ID: return offsetof(oc_spu_context_t, mfc_tag_id);
+        case OC_SPU_CH_WR_TAG_MASK:
+        case OC_SPU_CH_RD_TAG_MASK: return offsetof(oc_spu_context_t, mfc_tag_mask);
+        case OC_SPU_CH_RD_TAG_STAT: return offsetof(oc_spu_context_t, mfc_tag_status);
+        case OC_SPU_CH_RD_ATOMIC_STAT: return offsetof(oc_spu_context_t, mfc_atomic_stat);
+        case OC_SPU_CH_WR_OUT_MBOX: return offsetof(oc_spu_context_t, out_mbox);
+        default: return 0;
+    }
+}
+
+/**
+ * Classify an rchcnt by channel number
+ *
+ * Every channel is either read or written, so at most one direction has a
+ * fast path. Direct channels never block and always count 1; count-gated
+ * ones keep their count in the context next to the value; the runtime owns
+ * the counts of callback channels.
+ */
+static SpuChannelPath spu_channel_count_path(uint8_t channel) {
+    SpuChannelPath read = spu_channel_path(channel, false);
+    return read != SpuChannelPath::Callback ? read : spu_channel_path(channel, true);
+}
+
+/**
+ * Emit the 32-bit value of an rdch
+ *
+ * Count-gated channels test channel_count first: a non-zero count means the
+ * value is already in the context, so only an empty channel reaches the read
+ * callback (which blocks). One-shot channels are consumed by the read.
+ */
+static llvm::Value* emit_spu_channel_read(llvm::IRBuilder<>& builder, llvm::Value* spu_state,
+                                          uint8_t channel, llvm::Value* read_callback_ptr) {
+    auto& ctx = builder.getContext();
+    auto i8_ty = builder.getInt8Ty();
+    auto i32_ty = builder.getInt32Ty();
+    
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(i8_ty, spu_state, offset);
+    };
+    auto call_read = [&]() -> llvm::Value* {
+        if (!read_callback_ptr) return builder.getInt32(0);
+        auto func_ty = llvm::FunctionType::get(i32_ty, {builder.getPtrTy(), i8_ty}, false);
+        return builder.CreateCall(func_ty, read_callback_ptr,
+                                  {spu_state, builder.getInt8(channel)}, "rdch_result");
+    };
+    
+    SpuChannelPath path = spu_channel_path(channel, false);
+    if (path == SpuChannelPath::Callback) return call_read();
+    llvm::Value* value_ptr = field(spu_channel_field(channel));
+    if (path == SpuChannelPath::Direct) return builder.CreateLoad(i32_ty, value_ptr, "rdch_inline");
+    
+    llvm::Function* func = builder.GetInsertBlock()->getParent();
+    llvm::Value* count_ptr = field(offsetof(oc_spu_context_t, channel_count) +
+                                   channel * sizeof(uint32_t));
+    llvm::Value* count = builder.CreateLoad(i32_ty, count_ptr, "rdch_count");
+    llvm::BasicBlock* ready_bb = llvm::BasicBlock::Create(ctx, "rdch_ready", func);
+    llvm::BasicBlock* block_bb = llvm::BasicBlock::Create(ctx, "rdch_block", func);
+    llvm::BasicBlock* done_bb = llvm::BasicBlock::Create(ctx, "rdch_done", func);
+    builder.CreateCondBr(builder.CreateICmpNE(count, builder.getInt32(0)), ready_bb, block_bb);
+    
+    builder.SetInsertPoint(ready_bb);
+    llvm::Value* ready_value = builder.CreateLoad(i32_ty, value_ptr, "rdch_inline");
+    if (channel == OC_SPU_CH_RD_EVENT_STAT) {
+        // Events stay pending until SPU_WrEventAck
+        ready_value = builder.CreateAnd(ready_value, builder.CreateLoad(i32_ty,
+            field(offsetof(oc_spu_context_t, event_mask))));
+    } else {
+        builder.CreateStore(builder.getInt32(0), count_ptr);
+        if (channel == OC_SPU_CH_RD_SIG_NOTIFY1 || channel == OC_SPU_CH_RD_SIG_NOTIFY2) {
+            builder.CreateStore(builder.getInt32(0), value_ptr);
+        }
+    }
+    builder.CreateBr(done_bb);
+    
+    builder.SetInsertPoint(block_bb);
+    llvm::Value* blocked_value = call_read();
+    block_bb = builder.GetInsertBlock();
+    builder.CreateBr(done_bb);
+    
+    builder.SetInsertPoint(done_bb);
+    llvm::PHINode* result = builder.CreatePHI(i32_ty, 2, "rdch_value");
+    result->addIncoming(ready_value, ready_bb);
+    result->addIncoming(blocked_value, block_bb);
+    return result;
+}
+
+/**
+ * Emit a wrch of a 32-bit value
+ *
+ * Event mask and acknowledge writes also recompute the SPU_RdEventStat count
+ * so that a following read can stay inline. The single-entry outbound
+ * mailbox is written in place while it is empty.
+ */
+static void emit_spu_channel_write(llvm::IRBuilder<>& builder, llvm::Value* spu_state,
+                                   uint8_t channel, llvm::Value* value,
+                                   llvm::Value* write_callback_ptr) {
+    auto& ctx = builder.getContext();
+    auto i8_ty = builder.getInt8Ty();
+    auto i32_ty = builder.getInt32Ty();
+    
+    auto field = [&](size_t offset) {
+        return builder.CreateConstInBoundsGEP1_64(i8_ty, spu_state, offset);
+    };
+    auto call_write = [&]() {
+        if (!write_callback_ptr) return;
+        auto func_ty = llvm::FunctionType::get(builder.getVoidTy(),
+            {builder.getPtrTy(), i8_ty, i32_ty}, false);
+        builder.CreateCall(func_ty, write_callback_ptr,
+                           {spu_state, builder.getInt8(channel), value});
+    };
+    
+    SpuChannelPath path = spu_channel_path(channel, true);
+    if (path == SpuChannelPath::Callback) {
+        call_write();
+        return;
+    }
+    
+    if (path == SpuChannelPath::Direct) {
+        if (channel == OC_SPU_CH_WR_EVENT_ACK) {
+            llvm::Value* stat_ptr = field(offsetof(oc_spu_context_t, event_stat));
+            llvm::Value* stat = builder.CreateLoad(i32_ty, stat_ptr);
+            builder.CreateStore(builder.CreateAnd(stat, builder.CreateNot(value)), stat_ptr);
+        } else {
+            builder.CreateStore(value, field(spu_channel_field(channel)));
+        }
+        if (channel == OC_SPU_CH_WR_EVENT_ACK || channel == OC_SPU_CH_WR_EVENT_MASK) {
+            llvm::Value* pending = builder.CreateAnd(
+                builder.CreateLoad(i32_ty, field(offsetof(oc_spu_context_t, event_stat))),
+                builder.CreateLoad(i32_ty, field(offsetof(oc_spu_context_t, event_mask))));
+            builder.CreateStore(
+                builder.CreateZExt(builder.CreateICmpNE(pending, builder.getInt32(0)), i32_ty),
+                field(offsetof(oc_spu_context_t, channel_count) +
+                      OC_SPU_CH_RD_EVENT_STAT * sizeof(uint32_t)));
+        }
+        return;
+    }
+    
+    llvm::Function* func = builder.GetInsertBlock()->getParent();
+    llvm::Value* count_ptr = field(offsetof(oc_spu_context_t, channel_count) +
+                                   channel * sizeof(uint32_t));
+    llvm::Value* count = builder.CreateLoad(i32_ty, count_ptr, "wrch_count");
+    llvm::BasicBlock* ready_bb = llvm::BasicBlock::Create(ctx, "wrch_ready", func);
+    llvm::BasicBlock* block_bb = llvm::BasicBlock::Create(ctx, "wrch_block", func);
+    llvm::BasicBlock* done_bb = llvm::BasicBlock::Create(ctx, "wrch_done", func);
+    builder.CreateCondBr(builder.CreateICmpNE(count, builder.getInt32(0)), ready_bb, block_bb);
+    
+    builder.SetInsertPoint(ready_bb);
+    builder.CreateStore(value, field(spu_channel_field(channel)));
+    builder.CreateStore(builder.getInt32(0), count_ptr);
+    builder.CreateBr(done_bb);
+    
+    builder.SetInsertPoint(block_bb);
+    call_write();
+    builder.CreateBr(done_bb);
+    
+    builder.SetInsertPoint(done_bb);
+}
+
 /**
  * Emit LLVM IR for SPU instructions
  * 
@@ -3119,99 +3431,58 @@ static void emit_spu_instruction(llvm::IRBuilder<>& builder, uint32_t instr,
         // ---- Channel Instructions ----
         case 0b00000001101: { // rdch rt, ca - Read Channel
             uint8_t channel = ra & 0x7F;
-            
-            // Inline fast paths for common channel reads
-            if (channel == 24) {
-                // MFC_RdTagStat: Inline tag status read from SPU state
-                // SPU state memory layout (oc_spu_context_t):
-                //   regs[128] × 16 bytes = 2048 bytes (offset 0)
-                //   pc: u32 = 4 bytes (offset 2048)
-                //   status: u32 = 4 bytes (offset 2052)
-                //   tag_status inferred at offset 2056
-                constexpr uint32_t SPU_TAG_STATUS_OFFSET = 128 * 16 + 4 + 4;
-                llvm::Value* tag_offset = llvm::ConstantInt::get(i32_ty, SPU_TAG_STATUS_OFFSET);
-                llvm::Value* tag_ptr = builder.CreateGEP(i8_ty, spu_state, tag_offset);
-                llvm::Value* tag_i32_ptr = builder.CreateBitCast(tag_ptr,
-                    llvm::PointerType::get(i32_ty, 0));
-                llvm::Value* tag_status = builder.CreateLoad(i32_ty, tag_i32_ptr, "inline_tag_status");
-                llvm::Value* result_vec = create_splat_i32(0);
-                result_vec = builder.CreateInsertElement(result_vec, tag_status,
-                    llvm::ConstantInt::get(i32_ty, 0));
-                builder.CreateStore(result_vec, regs[rt]);
-                return;
-            }
-            
-            if (read_callback_ptr) {
-                auto channel_ty = llvm::Type::getInt8Ty(ctx);
-                auto func_ty = llvm::FunctionType::get(i32_ty, 
-                    {builder.getPtrTy(), channel_ty}, false);
-                
-                llvm::Value* channel_val = llvm::ConstantInt::get(channel_ty, channel);
-                llvm::Value* result = builder.CreateCall(
-                    func_ty, read_callback_ptr, {spu_state, channel_val}, "rdch_result");
-                
-                llvm::Value* result_vec = create_splat_i32(0);
-                result_vec = builder.CreateInsertElement(result_vec, result,
-                    llvm::ConstantInt::get(i32_ty, 0));
-                builder.CreateStore(result_vec, regs[rt]);
-            } else {
-                llvm::Value* zero_vec = create_splat_i32(0);
-                builder.CreateStore(zero_vec, regs[rt]);
-            }
+            llvm::Value* value = emit_spu_channel_read(builder, spu_state, channel,
+                                                       read_callback_ptr);
+            llvm::Value* result_vec = create_splat_i32(0);
+            result_vec = builder.CreateInsertElement(result_vec, value,
+                llvm::ConstantInt::get(i32_ty, 0));
+            builder.CreateStore(result_vec, regs[rt]);
             return;
         }
-        case 0b00000001100: { // wrch ca, rt - Write Channel
-            // Write to SPU channel via runtime callback
-            // Channel number is in ra field (bits 7-13)
+        case 0b00100001101: { // wrch ca, rt - Write Channel
+            // Channel number is in ra field (bits 7-13), value in rt[0]
             uint8_t channel = ra & 0x7F;
-            
-            if (write_callback_ptr) {
-                // Extract value from rt[0]
-                llvm::Value* rt_val = builder.CreateLoad(v4i32_ty, regs[rt]);
-                llvm::Value* value = builder.CreateExtractElement(rt_val,
-                    llvm::ConstantInt::get(i32_ty, 0));
-                
-                // Call write_callback(spu_state, channel, value) -> void
-                auto channel_ty = llvm::Type::getInt8Ty(ctx);
-                auto void_ty = llvm::Type::getVoidTy(ctx);
-                auto func_ty = llvm::FunctionType::get(void_ty, 
-                    {builder.getPtrTy(), channel_ty, i32_ty}, false);
-                
-                llvm::Value* channel_val = llvm::ConstantInt::get(channel_ty, channel);
-                builder.CreateCall(func_ty, write_callback_ptr, 
-                    {spu_state, channel_val, value});
-            }
-            // If no callback, instruction is a no-op
+            llvm::Value* rt_val = builder.CreateLoad(v4i32_ty, regs[rt]);
+            llvm::Value* value = builder.CreateExtractElement(rt_val,
+                llvm::ConstantInt::get(i32_ty, 0));
+            emit_spu_channel_write(builder, spu_state, channel, value, write_callback_ptr);
             return;
         }
         case 0b00000001111: { // rchcnt rt, ca - Read Channel Count
-            // Read available channel count via runtime callback
             // Channel number is in ra field (bits 7-13)
             uint8_t channel = ra & 0x7F;
+            llvm::Value* count = nullptr;
+            SpuChannelPath path = channel < 32 ? spu_channel_count_path(channel)
+                                               : SpuChannelPath::Callback;
             
-            if (count_callback_ptr) {
+            if (path == SpuChannelPath::Direct) {
+                count = llvm::ConstantInt::get(i32_ty, 1);
+            } else if (path == SpuChannelPath::CountGated ||
+                       (channel < 32 && !count_callback_ptr)) {
+                // Kept current in the context, by compiled code for the
+                // count-gated channels and by the runtime for the rest
+                llvm::Value* count_ptr = builder.CreateConstInBoundsGEP1_64(i8_ty, spu_state,
+                    offsetof(oc_spu_context_t, channel_count) + channel * sizeof(uint32_t));
+                count = builder.CreateLoad(i32_ty, count_ptr, "rchcnt_inline");
+            } else if (count_callback_ptr) {
                 // Call count_callback(spu_state, channel) -> uint32_t
                 auto channel_ty = llvm::Type::getInt8Ty(ctx);
                 auto func_ty = llvm::FunctionType::get(i32_ty, 
                     {builder.getPtrTy(), channel_ty}, false);
                 
                 llvm::Value* channel_val = llvm::ConstantInt::get(channel_ty, channel);
-                llvm::Value* count = builder.CreateCall(
+                count = builder.CreateCall(
                     func_ty, count_callback_ptr, {spu_state, channel_val}, "rchcnt_result");
-                
-                // Store count in rt[0], zero in other slots
-                llvm::Value* result_vec = create_splat_i32(0);
-                result_vec = builder.CreateInsertElement(result_vec, count,
-                    llvm::ConstantInt::get(i32_ty, 0));
-                builder.CreateStore(result_vec, regs[rt]);
             } else {
                 // Fallback: return 1 (always available)
-                llvm::Value* result = create_splat_i32(0);
-                result = builder.CreateInsertElement(result, 
-                    llvm::ConstantInt::get(i32_ty, 1),
-                    llvm::ConstantInt::get(i32_ty, 0));
-                builder.CreateStore(result, regs[rt]);
+                count = llvm::ConstantInt::get(i32_ty, 1);
             }
+            
+            // Store count in rt[0], zero in other slots
+            llvm::Value* result_vec = create_splat_i32(0);
+            result_vec = builder.CreateInsertElement(result_vec, count,
+                llvm::ConstantInt::get(i32_ty, 0));
+            builder.CreateStore(result_vec, regs[rt]);
             return;
         }
         
@@ -4228,12 +4499,7 @@ oc_spu_jit_t* oc_spu_jit_create(void) {
 
 void oc_spu_jit_destroy(oc_spu_jit_t* jit) {
     if (jit) {
-        // Clean up compiled code
-        for (auto& pair : jit->cache.blocks) {
-            if (pair.second->compiled_code) {
-                free(pair.second->compiled_code);
-            }
-        }
+        // The cache frees compiled code
         delete jit;
     }
 }
@@ -4271,6 +4537,36 @@ int oc_spu_jit_compile(oc_spu_jit_t* jit, uint32_t address,
     return 0;
 }
 
+int oc_spu_jit_emit_ir(oc_spu_jit_t* jit, uint32_t address, const uint8_t* code, size_t size,
+                       char* buffer, size_t buffer_size) {
+    if (!jit || !code || size == 0) return -1;
+#ifdef HAVE_LLVM
+    SpuBasicBlock block(address);
+    identify_spu_basic_block(code, size, &block);
+    
+    llvm::LLVMContext context;
+    llvm::Module module("spu_ir", context);
+    if (!create_spu_llvm_function(&module, &block, &jit->channel_manager)) return -3;
+    if (llvm::verifyModule(module)) return -3;
+    
+    std::string ir;
+    llvm::raw_string_ostream stream(ir);
+    module.print(stream, nullptr);
+    stream.flush();
+    if (buffer && buffer_size > 0) {
+        size_t length = std::min(ir.size(), buffer_size - 1);
+        memcpy(buffer, ir.data(), length);
+        buffer[length] = '\0';
+    }
+    return static_cast<int>(ir.size());
+#else
+    (void)address;
+    (void)buffer;
+    (void)buffer_size;
+    return -2;
+#endif
+}
+
 void* oc_spu_jit_get_compiled(oc_spu_jit_t* jit, uint32_t address) {
     if (!jit) return nullptr;
     
@@ -4281,24 +4577,12 @@ void* oc_spu_jit_get_compiled(oc_spu_jit_t* jit, uint32_t address) {
 void oc_spu_jit_invalidate(oc_spu_jit_t* jit, uint32_t address) {
     if (!jit) return;
     
-    auto it = jit->cache.blocks.find(address);
-    if (it != jit->cache.blocks.end()) {
-        if (it->second->compiled_code) {
-            free(it->second->compiled_code);
-        }
-        jit->cache.total_size -= it->second->code_size;
-        jit->cache.blocks.erase(it);
-    }
+    jit->cache.invalidate(address);
 }
 
 void oc_spu_jit_clear_cache(oc_spu_jit_t* jit) {
     if (!jit) return;
     
-    for (auto& pair : jit->cache.blocks) {
-        if (pair.second->compiled_code) {
-            free(pair.second->compiled_code);
-        }
-    }
     jit->cache.clear();
 }
 
@@ -4349,6 +4633,12 @@ void oc_spu_jit_set_channel_callbacks(oc_spu_jit_t* jit,
         reinterpret_cast<ChannelManager::ChannelWriteFunc>(write_callback));
 }
 
+void oc_spu_jit_set_channel_count_callback(oc_spu_jit_t* jit, void* count_callback) {
+    if (!jit) return;
+    jit->channel_manager.set_count_callback(
+        reinterpret_cast<ChannelManager::ChannelCountFunc>(count_callback));
+}
+
 size_t oc_spu_jit_get_channel_op_count(oc_spu_jit_t* jit) {
     if (!jit) return 0;
     return jit->channel_manager.get_operations().size();
@@ -4636,6 +4926,10 @@ void oc_spu_jit_set_channel_blocking_callback(oc_spu_jit_t* jit, void* callback)
         reinterpret_cast<ChannelManager::ChannelBlockingCheckFunc>(callback));
 }
 
+int oc_spu_jit_channel_fast_path(uint8_t channel, int is_write) {
+    return static_cast<int>(spu_channel_path(channel, is_write != 0));
+}
+
 // Enhanced MFC DMA APIs
 
 void oc_spu_jit_queue_getllar(oc_spu_jit_t* jit, uint32_t local_addr, uint64_t ea, uint16_t tag) {
@@ -4727,12 +5021,25 @@ int oc_spu_jit_execute(oc_spu_jit_t* jit, oc_spu_context_t* context, uint32_t ad
     
     // Get compiled code
     SpuBasicBlock* block = jit->cache.find_block(address);
-    if (!block || !block->compiled_code) {
-        // Not compiled - return error so interpreter can handle
+    if (!block || !block->compiled_code || block->is_placeholder) {
+        // Not compiled to native code - return error so interpreter can handle
         context->exit_reason = OC_SPU_EXIT_ERROR;
         return -2;
     }
     
+    // Preemption point at dispatch. SPU preemption is dispatcher-only:
+    // compiled blocks carry no check of their own, so each run is charged
+    // its full length here and the budget delta is what executed.
+    if (context->interrupt_pending ||
+        (context->budget_enabled && context->instruction_budget <= 0)) {
+        context->instructions_executed = 0;
+        context->exit_reason = OC_SPU_EXIT_PREEMPTED;
+        context->next_pc = address;
+        return 0;
+    }
+    int64_t budget_before = context->instruction_budget;
+    context->instruction_budget -= static_cast<int64_t>(block->instructions.size());
+    
     // Set up context for execution
     context->instructions_executed = 0;
     context->exit_reason = OC_SPU_EXIT_NORMAL;
@@ -4748,7 +5055,8 @@ int oc_spu_jit_execute(oc_spu_jit_t* jit, oc_spu_context_t* context, uint32_t ad
     func(context, context->local_storage);
     
     // Update execution count
-    context->instructions_executed = static_cast<uint32_t>(block->instructions.size());
+    context->instructions_executed = static_cast<uint32_t>(std::min<int64_t>(
+        budget_before - context->instruction_budget, INT32_MAX));
     
     // Update PC based on exit reason
     if (context->exit_reason == OC_SPU_EXIT_NORMAL) {
@@ -0,0 +1,427 @@
+/**
+ * SPU local store backing
+ *
+ * Local store images live in memfd regions and are switched into an SPU's
+ * fixed LS window by remapping instead of copying 256KB. Images cloned from
+ * a sealed template (e.g. a SPURS task binary) map the template privately,
+ * so pages are only copied by the kernel when the task writes them. Sealing
+ * (F_SEAL_WRITE) keeps the template from changing under its clones; clones
+ * of unsealed images copy.
+ *
+ * Platforms without memfd fall back to heap buffers and memcpy.
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <atomic>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OC_SPU_LS_HAVE_MEMFD 1
+#endif
+
+// SPU local store size (256KB)
+static constexpr size_t SPU_LS_SIZE = 0x40000;
+
+// A local store image: the contents of one SPU thread's or task's LS
+struct LsImage {
+    bool live = false;
+    int fd = -1;                 // memfd backing (shared images only)
+    bool cow = false;            // Private mapping of a template's memfd
+    bool sealed = false;         // Read-only template; clones share its pages
+    uint8_t* home = nullptr;     // Where the image is mapped while not attached
+    int window = -1;             // Window the image is attached to, or -1
+    std::vector<uint8_t> buffer; // Fallback storage without memfd
+};
+
+// An SPU's LS window: a fixed 256KB range the SPU context points at
+struct LsWindow {
+    bool live = false;
+    uint8_t* base = nullptr;
+    int image = -1;              // Attached image, or -1
+};
+
+// Local store backing state
+struct SpuLocalStoreManager {
+    std::vector<LsImage> images;
+    std::vector<LsWindow> windows;
+    oc_mutex mutex;
+    bool zero_copy = false;
+
+    // Statistics
+    std::atomic<uint64_t> switches{0};
+    std::atomic<uint64_t> remapped_switches{0};
+    std::atomic<uint64_t> bytes_copied{0};
+    std::atomic<uint64_t> cow_clones{0};
+
+    SpuLocalStoreManager() {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        // memfd can be unavailable under old kernels or seccomp filters
+        int fd = memfd_create("oc_spu_ls_probe", MFD_CLOEXEC);
+        if (fd >= 0) {
+            close(fd);
+            zero_copy = true;
+        }
+#endif
+    }
+
+    template<typename T>
+    static int allocate_slot(std::vector<T>& slots) {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!slots[i].live) return static_cast<int>(i);
+        }
+        slots.emplace_back();
+        return static_cast<int>(slots.size() - 1);
+    }
+
+    LsImage* image_at(int id) {
+        if (id < 0 || static_cast<size_t>(id) >= images.size()) return nullptr;
+        return images[id].live ? &images[id] : nullptr;
+    }
+
+    LsWindow* window_at(int id) {
+        if (id < 0 || static_cast<size_t>(id) >= windows.size()) return nullptr;
+        return windows[id].live ? &windows[id] : nullptr;
+    }
+
+#ifdef OC_SPU_LS_HAVE_MEMFD
+    static uint8_t* reserve(void* at = nullptr) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | (at ? MAP_FIXED : 0);
+        void* p = mmap(at, SPU_LS_SIZE, PROT_NONE, flags, -1, 0);
+        return p == MAP_FAILED ? nullptr : static_cast<uint8_t*>(p);
+    }
+
+    static uint8_t* move_pages(uint8_t* from, uint8_t* to) {
+        void* p = mremap(from, SPU_LS_SIZE, SPU_LS_SIZE, MREMAP_MAYMOVE | MREMAP_FIXED, to);
+        return p == MAP_FAILED ? nullptr : static_cast<uint8_t*>(p);
+    }
+
+    /**
+     * Give an image a zero-filled memfd of its own, mapped shared at home
+     */
+    static bool create_memfd(LsImage& image) {
+        int fd = memfd_create("oc_spu_ls", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) return false;
+        void* p = MAP_FAILED;
+        if (ftruncate(fd, SPU_LS_SIZE) == 0) {
+            p = mmap(nullptr, SPU_LS_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (p == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        image.fd = fd;
+        image.home = static_cast<uint8_t*>(p);
+        return true;
+    }
+#endif
+
+    /**
+     * Take the current image out of a window, leaving the window reserved
+     *
+     * Shared images keep their contents in the memfd, so the window is just
+     * remapped. A copy-on-write image owns private pages that only exist in
+     * the mapping; they are moved to a new home with mremap.
+     */
+    bool park(LsWindow& window) {
+        if (window.image < 0) return true;
+        LsImage& image = images[window.image];
+        if (zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+            if (image.cow) {
+                uint8_t* home = reserve();
+                if (!home) return false;
+                if (!move_pages(window.base, home)) {
+                    munmap(home, SPU_LS_SIZE);
+                    return false;
+                }
+                // The pages are safe at home, so the image is detached even
+                // if the window cannot be reserved again below
+                image.home = home;
+                image.window = -1;
+                window.image = -1;
+            }
+            if (!reserve(window.base)) return false;
+#endif
+        } else if (!image.sealed) {
+            std::memcpy(image.buffer.data(), window.base, SPU_LS_SIZE);
+            bytes_copied.fetch_add(SPU_LS_SIZE);
+        }
+        image.window = -1;
+        window.image = -1;
+        return true;
+    }
+
+    /**
+     * Put an image into an empty (reserved) window
+     */
+    bool place(LsWindow& window, int image_id) {
+        LsImage& image = images[image_id];
+        if (zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+            if (image.cow) {
+                if (!move_pages(image.home, window.base)) return false;
+                image.home = nullptr;
+            } else {
+                int prot = image.sealed ? PROT_READ : PROT_READ | PROT_WRITE;
+                void* p = mmap(window.base, SPU_LS_SIZE, prot, MAP_SHARED | MAP_FIXED, image.fd, 0);
+                if (p == MAP_FAILED) return false;
+            }
+#endif
+            remapped_switches.fetch_add(1);
+        } else {
+            std::memcpy(window.base, image.buffer.data(), SPU_LS_SIZE);
+            bytes_copied.fetch_add(SPU_LS_SIZE);
+        }
+        image.window = static_cast<int>(&window - windows.data());
+        window.image = image_id;
+        return true;
+    }
+
+    /**
+     * Empty a window whose image is being destroyed
+     *
+     * Unlike park() the contents are dropped, so nothing is moved or copied.
+     */
+    bool discard(LsWindow& window) {
+        if (window.image < 0) return true;
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        if (zero_copy && !reserve(window.base)) return false;
+#endif
+        images[window.image].window = -1;
+        window.image = -1;
+        return true;
+    }
+
+    void release(LsImage& image) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        if (image.home) munmap(image.home, SPU_LS_SIZE);
+        if (image.fd >= 0) close(image.fd);
+#endif
+        image = LsImage();
+    }
+};
+
+static SpuLocalStoreManager g_spu_ls;
+
+extern "C" {
+
+// ============================================================================
+// Local Store Windows
+// ============================================================================
+
+int oc_spu_ls_window_create(void** base) {
+    if (base) *base = nullptr;
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+
+    uint8_t* mem = nullptr;
+    if (mgr.zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        mem = SpuLocalStoreManager::reserve();
+#endif
+    } else {
+        mem = static_cast<uint8_t*>(std::calloc(1, SPU_LS_SIZE));
+    }
+    if (!mem) return -1;
+
+    int id = SpuLocalStoreManager::allocate_slot(mgr.windows);
+    mgr.windows[id].live = true;
+    mgr.windows[id].base = mem;
+    mgr.windows[id].image = -1;
+    if (base) *base = mem;
+    return id;
+}
+
+int oc_spu_ls_window_destroy(int window) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsWindow* w = mgr.window_at(window);
+    if (!w) return -1;
+    if (!mgr.park(*w)) return -2;
+
+    if (mgr.zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        munmap(w->base, SPU_LS_SIZE);
+#endif
+    } else {
+        std::free(w->base);
+    }
+    *w = LsWindow();
+    return 0;
+}
+
+// ============================================================================
+// Local Store Images
+// ============================================================================
+
+int oc_spu_ls_image_create(const uint8_t* data, size_t size) {
+    if (size > SPU_LS_SIZE) return -1;
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+
+    LsImage image;
+    uint8_t* dst = nullptr;
+    if (mgr.zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        if (!SpuLocalStoreManager::create_memfd(image)) return -2;
+        dst = image.home;
+#endif
+    } else {
+        image.buffer.assign(SPU_LS_SIZE, 0);
+        dst = image.buffer.data();
+    }
+    if (data && size) std::memcpy(dst, data, size);
+
+    int id = SpuLocalStoreManager::allocate_slot(mgr.images);
+    image.live = true;
+    mgr.images[id] = std::move(image);
+    return id;
+}
+
+int oc_spu_ls_image_clone(int source) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsImage* src = mgr.image_at(source);
+    if (!src) return -1;
+
+    LsImage image;
+    if (mgr.zero_copy && src->sealed) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        // Private mapping of the template: the kernel copies a page on first write
+        void* p = mmap(nullptr, SPU_LS_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, src->fd, 0);
+        if (p == MAP_FAILED) return -2;
+        image.home = static_cast<uint8_t*>(p);
+        image.cow = true;
+        mgr.cow_clones.fetch_add(1);
+#endif
+    } else {
+        // A writable source could change under a shared mapping, so the
+        // clone is a copy of its current contents
+        const uint8_t* from = src->window >= 0 ? mgr.windows[src->window].base :
+                              mgr.zero_copy ? src->home : src->buffer.data();
+        if (!from) return -2;
+        if (mgr.zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+            if (!SpuLocalStoreManager::create_memfd(image)) return -2;
+            std::memcpy(image.home, from, SPU_LS_SIZE);
+#endif
+        } else {
+            image.buffer.assign(from, from + SPU_LS_SIZE);
+        }
+        mgr.bytes_copied.fetch_add(SPU_LS_SIZE);
+    }
+
+    int id = SpuLocalStoreManager::allocate_slot(mgr.images);
+    image.live = true;
+    mgr.images[id] = std::move(image);
+    return id;
+}
+
+int oc_spu_ls_image_seal(int image) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsImage* img = mgr.image_at(image);
+    if (!img) return -1;
+    if (img->sealed) return 0;
+    if (img->window >= 0) return -2;
+
+    if (mgr.zero_copy) {
+#ifdef OC_SPU_LS_HAVE_MEMFD
+        if (img->cow) {
+            // Clones have only private pages; move the contents to a memfd
+            LsImage own;
+            if (!SpuLocalStoreManager::create_memfd(own)) return -3;
+            std::memcpy(own.home, img->home, SPU_LS_SIZE);
+            munmap(img->home, SPU_LS_SIZE);
+            img->home = own.home;
+            img->fd = own.fd;
+            img->cow = false;
+            mgr.bytes_copied.fetch_add(SPU_LS_SIZE);
+        }
+        // F_SEAL_WRITE needs every writable shared mapping gone
+        munmap(img->home, SPU_LS_SIZE);
+        img->home = nullptr;
+        bool sealed = fcntl(img->fd, F_ADD_SEALS,
+                            F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0;
+        void* p = mmap(nullptr, SPU_LS_SIZE, sealed ? PROT_READ : PROT_READ | PROT_WRITE,
+                       MAP_SHARED, img->fd, 0);
+        if (p != MAP_FAILED) img->home = static_cast<uint8_t*>(p);
+        img->sealed = sealed;
+        if (!sealed || !img->home) return -3;
+#endif
+    }
+    img->sealed = true;
+    return 0;
+}
+
+int oc_spu_ls_image_destroy(int image) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsImage* img = mgr.image_at(image);
+    if (!img) return -1;
+    if (img->window >= 0 && !mgr.discard(mgr.windows[img->window])) return -3;
+    mgr.release(*img);
+    return 0;
+}
+
+// ============================================================================
+// Local Store Switching
+// ============================================================================
+
+int oc_spu_ls_attach(int window, int image) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsWindow* w = mgr.window_at(window);
+    LsImage* img = mgr.image_at(image);
+    if (!w || !img) return -1;
+    if (w->image == image) return 0;
+    if (img->window >= 0) return -2;  // Attached to another SPU
+
+    if (!mgr.park(*w) || !mgr.place(*w, image)) return -3;
+    mgr.switches.fetch_add(1);
+    return 0;
+}
+
+int oc_spu_ls_detach(int window) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsWindow* w = mgr.window_at(window);
+    if (!w) return -1;
+    return mgr.park(*w) ? 0 : -3;
+}
+
+int oc_spu_ls_get_attached(int window) {
+    auto& mgr = g_spu_ls;
+    oc_lock_guard<oc_mutex> lock(mgr.mutex);
+    LsWindow* w = mgr.window_at(window);
+    return w ? w->image : -1;
+}
+
+int oc_spu_ls_is_zero_copy(void) {
+    return g_spu_ls.zero_copy ? 1 : 0;
+}
+
+void oc_spu_ls_get_stats(uint64_t* switches, uint64_t* remapped_switches,
+                         uint64_t* bytes_copied, uint64_t* cow_clones) {
+    auto& mgr = g_spu_ls;
+    if (switches) *switches = mgr.switches.load();
+    if (remapped_switches) *remapped_switches = mgr.remapped_switches.load();
+    if (bytes_copied) *bytes_copied = mgr.bytes_copied.load();
+    if (cow_clones) *cow_clones = mgr.cow_clones.load();
+}
+
+void oc_spu_ls_reset_stats(void) {
+    auto& mgr = g_spu_ls;
+    mgr.switches.store(0);
+    mgr.remapped_switches.store(0);
+    mgr.bytes_copied.store(0);
+    mgr.cow_clones.store(0);
+}
+
+} // extern "C"
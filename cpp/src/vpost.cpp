@@ -0,0 +1,722 @@
+/**
+ * Video post-processing (cellVpost)
+ *
+ * Deinterlacing, YUV420 to RGBA colour conversion and scaling fused into a
+ * single pass over the frame. The output is split into horizontal bands
+ * that run on the job system. Each band produces the source rows its
+ * vertical filter taps need, one at a time:
+ *
+ *   deinterlace (pick or average Y/U/V rows)
+ *     -> fixed-point colour conversion into one padded RGBA row
+ *     -> horizontal polyphase filter into a 16-bit row (ring of 4)
+ *   vertical polyphase filter over the ring -> output row
+ *
+ * so a source row is converted once per band and never written back to
+ * memory at full resolution. Filters use 4 taps with 64 phases (bilinear
+ * and nearest are 4-tap kernels with zero taps); coefficients are Q14 and
+ * the intermediate rows hold 8-bit values in Q6. The AVX2 and scalar paths
+ * produce identical output.
+ */
+
+#include "oc_ffi.h"
+#include "oc_threading.h"
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define OC_X86_64 1
+#else
+#define OC_X86_64 0
+#endif
+
+// Filter geometry
+static constexpr int VPOST_TAPS = 4;
+static constexpr int VPOST_PHASE_BITS = 6;
+static constexpr int VPOST_PHASES = 1 << VPOST_PHASE_BITS;
+static constexpr int VPOST_COEF_BITS = 14;
+static constexpr int VPOST_COEF_ONE = 1 << VPOST_COEF_BITS;
+
+// Horizontal pass output: (sum + round) >> 8 leaves the value in Q6
+static constexpr int VPOST_HSHIFT = 8;
+// Vertical pass: Q14 coefficients times Q6 rows
+static constexpr int VPOST_VSHIFT = VPOST_COEF_BITS + VPOST_COEF_BITS - VPOST_HSHIFT;
+
+// Replicated edge pixels on each side of the converted RGBA row, enough for
+// the leftmost and rightmost 4-tap windows
+static constexpr uint32_t VPOST_ROW_PAD = 2;
+
+// Colour conversion coefficients (Q14)
+static constexpr int VPOST_CSC_BITS = 14;
+
+// Bands are at least this many output rows; shorter bands spend too much
+// time reconverting the source rows they share with their neighbours
+static constexpr uint32_t VPOST_MIN_BAND_ROWS = 32;
+
+// Average luma difference per pixel above which a line counts as moving
+static constexpr uint32_t VPOST_MOTION_THRESHOLD = 30;
+
+struct CscCoefficients {
+    int16_t rv;    // R = Y + rv*V
+    int16_t gu;    // G = Y - gu*U - gv*V
+    int16_t gv;
+    int16_t bu;    // B = Y + bu*U
+};
+
+static CscCoefficients csc_coefficients(int matrix) {
+    auto q = [](double c) { return static_cast<int16_t>(std::lround(c * (1 << VPOST_CSC_BITS))); };
+    // Full-range YUV, as decoded by cellVdec
+    if (matrix == OC_VPOST_MATRIX_BT601) {
+        return {q(1.402), q(0.344136), q(0.714136), q(1.772)};
+    }
+    return {q(1.5748), q(0.187324), q(0.468124), q(1.8556)};
+}
+
+/**
+ * Per-output-sample filter positions along one axis
+ */
+struct ScaleAxis {
+    uint32_t src = 0;
+    uint32_t dst = 0;
+    int algorithm = -1;
+    std::vector<int32_t> first;    // First tap's source index (may be < 0)
+    std::vector<int16_t> coef;     // VPOST_TAPS per output sample
+
+    bool matches(uint32_t s, uint32_t d, int algo) const {
+        return src == s && dst == d && algorithm == algo;
+    }
+
+    void build(uint32_t s, uint32_t d, int algo);
+};
+
+static void phase_coefficients(int algorithm, int phase, int16_t out[VPOST_TAPS]) {
+    double t = static_cast<double>(phase) / VPOST_PHASES;
+    double w[VPOST_TAPS] = {0.0, 1.0, 0.0, 0.0};
+    if (algorithm == OC_VPOST_SCALE_BILINEAR) {
+        w[1] = 1.0 - t;
+        w[2] = t;
+    } else if (algorithm == OC_VPOST_SCALE_BICUBIC) {
+        // Catmull-Rom
+        double t2 = t * t, t3 = t2 * t;
+        w[0] = 0.5 * (-t + 2.0 * t2 - t3);
+        w[1] = 0.5 * (2.0 - 5.0 * t2 + 3.0 * t3);
+        w[2] = 0.5 * (t + 4.0 * t2 - 3.0 * t3);
+        w[3] = 0.5 * (-t2 + t3);
+    }
+    int sum = 0, largest = 0;
+    for (int i = 0; i < VPOST_TAPS; i++) {
+        out[i] = static_cast<int16_t>(std::lround(w[i] * VPOST_COEF_ONE));
+        sum += out[i];
+        if (out[i] > out[largest]) largest = i;
+    }
+    // Taps must sum to exactly one so flat areas stay flat
+    out[largest] = static_cast<int16_t>(out[largest] + VPOST_COEF_ONE - sum);
+}
+
+void ScaleAxis::build(uint32_t s, uint32_t d, int algo) {
+    src = s;
+    dst = d;
+    algorithm = algo;
+    first.resize(d);
+    coef.resize(static_cast<size_t>(d) * VPOST_TAPS);
+
+    int16_t table[VPOST_PHASES][VPOST_TAPS];
+    for (int p = 0; p < VPOST_PHASES; p++) {
+        phase_coefficients(algo, p, table[p]);
+    }
+
+    for (uint32_t i = 0; i < d; i++) {
+        int64_t pos;
+        int phase;
+        if (algo == OC_VPOST_SCALE_NEAREST) {
+            pos = static_cast<int64_t>(i) * s / d;
+            phase = 0;
+        } else {
+            // Pixel centres aligned: pos = (i + 0.5) * s / d - 0.5, in 16.16
+            int64_t fx = ((2 * static_cast<int64_t>(i) + 1) * s << 16) / (2 * static_cast<int64_t>(d))
+                         - (1 << 15);
+            pos = fx >> 16;
+            phase = static_cast<int>(((fx & 0xFFFF) + (1 << (15 - VPOST_PHASE_BITS))) >> (16 - VPOST_PHASE_BITS));
+            if (phase == VPOST_PHASES) {
+                pos++;
+                phase = 0;
+            }
+        }
+        first[i] = static_cast<int32_t>(pos) - 1;
+        std::memcpy(&coef[static_cast<size_t>(i) * VPOST_TAPS], table[phase], sizeof(table[phase]));
+    }
+}
+
+/**
+ * Per-band scratch rows
+ */
+struct VpostBand {
+    std::vector<uint8_t> luma;          // Averaged rows (motion-adaptive)
+    std::vector<uint8_t> cb;
+    std::vector<uint8_t> cr;
+    std::vector<uint8_t> rgba;          // Converted row with VPOST_ROW_PAD pixels each side
+    std::vector<int16_t> ring[VPOST_TAPS];
+    int64_t ring_row[VPOST_TAPS];
+    uint64_t rows_produced = 0;
+};
+
+struct oc_vpost_t {
+    int deinterlace = OC_VPOST_DEINTERLACE_WEAVE;
+    bool top_field_first = true;
+    int scaling = OC_VPOST_SCALE_BILINEAR;
+    int matrix = OC_VPOST_MATRIX_BT709;
+    uint8_t alpha = 0xFF;
+    bool simd = true;
+
+    ScaleAxis horiz;
+    ScaleAxis vert;
+    // Horizontal coefficients in the AVX2 layout: (c0,c1) x4, (c2,c3) x4
+    std::vector<int16_t> horiz_pairs;
+
+    // Motion-adaptive state
+    std::vector<uint8_t> prev_luma;
+    uint32_t prev_width = 0;
+    uint32_t prev_height = 0;
+    std::vector<uint8_t> line_moving;
+
+    std::vector<VpostBand> bands;
+
+    oc_vpost_stats_t stats{};
+};
+
+/**
+ * One frame's inputs, resolved
+ */
+struct VpostJob {
+    oc_vpost_t* vp;
+    const oc_vpost_frame_t* frame;
+    CscCoefficients csc;
+    uint32_t y_pitch;
+    uint32_t uv_pitch;
+    uint32_t out_pitch;
+    uint32_t chroma_width;
+    uint32_t rows_per_band;
+    bool avx2;
+};
+
+// ============================================================================
+// Scalar kernels
+// ============================================================================
+
+static inline uint8_t clamp_u8(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static void csc_row_scalar(const CscCoefficients& c, const uint8_t* y, const uint8_t* u,
+                           const uint8_t* v, uint8_t alpha, uint8_t* out,
+                           uint32_t begin, uint32_t end) {
+    const int round = 1 << (VPOST_CSC_BITS - 1);
+    for (uint32_t x = begin; x < end; x++) {
+        int yy = (y[x] << VPOST_CSC_BITS) + round;
+        int uu = u[x >> 1] - 128;
+        int vv = v[x >> 1] - 128;
+        out[x * 4 + 0] = clamp_u8((yy + c.rv * vv) >> VPOST_CSC_BITS);
+        out[x * 4 + 1] = clamp_u8((yy - c.gu * uu - c.gv * vv) >> VPOST_CSC_BITS);
+        out[x * 4 + 2] = clamp_u8((yy + c.bu * uu) >> VPOST_CSC_BITS);
+        out[x * 4 + 3] = alpha;
+    }
+}
+
+static void hscale_scalar(const ScaleAxis& axis, const uint8_t* row, int16_t* out,
+                          uint32_t begin, uint32_t end) {
+    const int round = 1 << (VPOST_HSHIFT - 1);
+    for (uint32_t x = begin; x < end; x++) {
+        const uint8_t* src = row + (axis.first[x] + VPOST_ROW_PAD) * 4;
+        const int16_t* c = &axis.coef[static_cast<size_t>(x) * VPOST_TAPS];
+        for (int ch = 0; ch < 4; ch++) {
+            int sum = 0;
+            for (int t = 0; t < VPOST_TAPS; t++) {
+                sum += c[t] * src[t * 4 + ch];
+            }
+            out[x * 4 + ch] = static_cast<int16_t>((sum + round) >> VPOST_HSHIFT);
+        }
+    }
+}
+
+static void vscale_scalar(const int16_t* const* rows, const int16_t* coef, int taps,
+                          uint8_t* out, uint32_t begin, uint32_t end) {
+    const int round = 1 << (VPOST_VSHIFT - 1);
+    for (uint32_t i = begin; i < end; i++) {
+        int sum = 0;
+        for (int t = 0; t < taps; t++) {
+            sum += coef[t] * rows[t][i];
+        }
+        out[i] = clamp_u8((sum + round) >> VPOST_VSHIFT);
+    }
+}
+
+static void average_row_scalar(const uint8_t* a, const uint8_t* b, uint8_t* out,
+                               uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        out[i] = static_cast<uint8_t>((a[i] + b[i] + 1) >> 1);
+    }
+}
+
+static uint64_t row_sad_scalar(const uint8_t* a, const uint8_t* b, uint32_t begin, uint32_t end) {
+    uint64_t sad = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        sad += static_cast<uint64_t>(std::abs(a[i] - b[i]));
+    }
+    return sad;
+}
+
+// ============================================================================
+// AVX2 kernels
+// ============================================================================
+
+#if OC_X86_64
+// One output channel for 16 pixels: Y + madd((U, V), k), as int16
+__attribute__((target("avx2")))
+static inline __m256i csc_channel_avx2(__m256i y_lo, __m256i y_hi, __m256i uv_lo, __m256i uv_hi, __m256i k) {
+    __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(y_lo, _mm256_madd_epi16(uv_lo, k)), VPOST_CSC_BITS);
+    __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(y_hi, _mm256_madd_epi16(uv_hi, k)), VPOST_CSC_BITS);
+    return _mm256_packs_epi32(lo, hi);
+}
+
+__attribute__((target("avx2")))
+static void csc_row_avx2(const CscCoefficients& c, const uint8_t* y, const uint8_t* u,
+                         const uint8_t* v, uint8_t alpha, uint8_t* out, uint32_t width) {
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i round = _mm256_set1_epi32(1 << (VPOST_CSC_BITS - 1));
+    // madd pairs over interleaved (U, V)
+    const __m256i k_r = _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(c.rv) << 16));
+    const __m256i k_g = _mm256_set1_epi32(static_cast<int32_t>(
+        (static_cast<uint32_t>(static_cast<uint16_t>(-c.gv)) << 16) | static_cast<uint16_t>(-c.gu)));
+    const __m256i k_b = _mm256_set1_epi32(static_cast<uint16_t>(c.bu));
+    const __m256i a16 = _mm256_set1_epi16(alpha);
+    const __m256i zero = _mm256_setzero_si256();
+    // R0..R7 G0..G7 -> R0 G0 R1 G1 ... within each 128-bit lane
+    const __m256i pair = _mm256_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15,
+                                          0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+        __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + (x >> 1)));
+        __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + (x >> 1)));
+        __m256i u16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)), bias);
+        __m256i v16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)), bias);
+
+        __m256i uv_lo = _mm256_unpacklo_epi16(u16, v16);
+        __m256i uv_hi = _mm256_unpackhi_epi16(u16, v16);
+        __m256i y_lo = _mm256_add_epi32(_mm256_slli_epi32(_mm256_unpacklo_epi16(y16, zero), VPOST_CSC_BITS), round);
+        __m256i y_hi = _mm256_add_epi32(_mm256_slli_epi32(_mm256_unpackhi_epi16(y16, zero), VPOST_CSC_BITS), round);
+
+        __m256i r16 = csc_channel_avx2(y_lo, y_hi, uv_lo, uv_hi, k_r);
+        __m256i g16 = csc_channel_avx2(y_lo, y_hi, uv_lo, uv_hi, k_g);
+        __m256i b16 = csc_channel_avx2(y_lo, y_hi, uv_lo, uv_hi, k_b);
+
+        __m256i rg = _mm256_shuffle_epi8(_mm256_packus_epi16(r16, g16), pair);
+        __m256i ba = _mm256_shuffle_epi8(_mm256_packus_epi16(b16, a16), pair);
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);    // Pixels 0-3, 8-11
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);    // Pixels 4-7, 12-15
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    csc_row_scalar(c, y, u, v, alpha, out, x, width);
+}
+
+__attribute__((target("avx2")))
+static inline __m128i hscale_pixel_avx2(const uint8_t* src, const int16_t* pairs) {
+    // p0 p1 p2 p3 (RGBA each) -> (p0c, p1c) for c = RGBA, then (p2c, p3c)
+    const __m128i interleave = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+    __m128i px = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), interleave);
+    __m256i prod = _mm256_madd_epi16(_mm256_cvtepu8_epi16(px),
+                                     _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs)));
+    return _mm_add_epi32(_mm256_castsi256_si128(prod), _mm256_extracti128_si256(prod, 1));
+}
+
+__attribute__((target("avx2")))
+static void hscale_avx2(const ScaleAxis& axis, const int16_t* pairs, const uint8_t* row,
+                        int16_t* out, uint32_t width) {
+    const __m128i round = _mm_set1_epi32(1 << (VPOST_HSHIFT - 1));
+    uint32_t x = 0;
+    for (; x + 2 <= width; x += 2) {
+        __m128i a = hscale_pixel_avx2(row + (axis.first[x] + VPOST_ROW_PAD) * 4, pairs + x * 16);
+        __m128i b = hscale_pixel_avx2(row + (axis.first[x + 1] + VPOST_ROW_PAD) * 4, pairs + (x + 1) * 16);
+        a = _mm_srai_epi32(_mm_add_epi32(a, round), VPOST_HSHIFT);
+        b = _mm_srai_epi32(_mm_add_epi32(b, round), VPOST_HSHIFT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packs_epi32(a, b));
+    }
+    hscale_scalar(axis, row, out, x, width);
+}
+
+__attribute__((target("avx2")))
+static void vscale_avx2(const int16_t* const* rows, const int16_t* coef, int taps,
+                        uint8_t* out, uint32_t count) {
+    const __m256i round = _mm256_set1_epi32(1 << (VPOST_VSHIFT - 1));
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i acc_lo = round;
+        __m256i acc_hi = round;
+        for (int t = 0; t < taps; t += 2) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[t] + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[t + 1] + i));
+            __m256i k = _mm256_set1_epi32(static_cast<int32_t>(
+                (static_cast<uint32_t>(static_cast<uint16_t>(coef[t + 1])) << 16) |
+                static_cast<uint16_t>(coef[t])));
+            acc_lo = _mm256_add_epi32(acc_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), k));
+            acc_hi = _mm256_add_epi32(acc_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), k));
+        }
+        __m256i v16 = _mm256_packs_epi32(_mm256_srai_epi32(acc_lo, VPOST_VSHIFT),
+                                          _mm256_srai_epi32(acc_hi, VPOST_VSHIFT));
+        __m256i v8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(v16, v16), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(v8));
+    }
+    vscale_scalar(rows, coef, taps, out, i, count);
+}
+
+__attribute__((target("avx2")))
+static void average_row_avx2(const uint8_t* a, const uint8_t* b, uint8_t* out, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_avg_epu8(va, vb));
+    }
+    average_row_scalar(a, b, out, i, count);
+}
+
+__attribute__((target("avx2")))
+static uint64_t row_sad_avx2(const uint8_t* a, const uint8_t* b, uint32_t count) {
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + row_sad_scalar(a, b, i, count);
+}
+#endif
+
+// ============================================================================
+// Pipeline
+// ============================================================================
+
+static void average_row(const VpostJob& job, const uint8_t* a, const uint8_t* b,
+                        uint8_t* out, uint32_t count) {
+#if OC_X86_64
+    if (job.avx2) {
+        average_row_avx2(a, b, out, count);
+        return;
+    }
+#endif
+    average_row_scalar(a, b, out, 0, count);
+}
+
+static uint64_t row_sad(const VpostJob& job, const uint8_t* a, const uint8_t* b, uint32_t count) {
+#if OC_X86_64
+    if (job.avx2) return row_sad_avx2(a, b, count);
+#endif
+    return row_sad_scalar(a, b, 0, count);
+}
+
+/**
+ * Is source row y missing from the field being kept?
+ */
+static bool is_other_field(const oc_vpost_t* vp, uint32_t y) {
+    return (y & 1) != (vp->top_field_first ? 0u : 1u);
+}
+
+/**
+ * Flag the lines motion-adaptive deinterlacing must interpolate, and keep
+ * this frame's luma for the next one. Runs before the bands start.
+ */
+static void detect_motion(const VpostJob& job) {
+    oc_vpost_t* vp = job.vp;
+    const oc_vpost_frame_t* f = job.frame;
+    uint32_t w = f->in_width, h = f->in_height;
+
+    vp->line_moving.assign(h, 0);
+    if (vp->prev_width == w && vp->prev_height == h) {
+        for (uint32_t y = 0; y < h; y++) {
+            if (!is_other_field(vp, y)) continue;
+            uint64_t sad = row_sad(job, f->y + static_cast<size_t>(y) * job.y_pitch,
+                                   vp->prev_luma.data() + static_cast<size_t>(y) * w, w);
+            if (sad / w > VPOST_MOTION_THRESHOLD) {
+                vp->line_moving[y] = 1;
+                vp->stats.motion_lines++;
+            }
+        }
+    }
+
+    vp->prev_luma.resize(static_cast<size_t>(w) * h);
+    for (uint32_t y = 0; y < h; y++) {
+        std::memcpy(vp->prev_luma.data() + static_cast<size_t>(y) * w,
+                    f->y + static_cast<size_t>(y) * job.y_pitch, w);
+    }
+    vp->prev_width = w;
+    vp->prev_height = h;
+}
+
+/**
+ * Deinterlace, convert and horizontally scale source row sy
+ */
+static void produce_row(const VpostJob& job, VpostBand& band, uint32_t sy, int16_t* out) {
+    const oc_vpost_t* vp = job.vp;
+    const oc_vpost_frame_t* f = job.frame;
+    uint32_t w = f->in_width, h = f->in_height;
+    auto luma_row = [&](uint32_t y) { return f->y + static_cast<size_t>(y) * job.y_pitch; };
+    auto cb_row = [&](uint32_t y) { return f->u + static_cast<size_t>(y >> 1) * job.uv_pitch; };
+    auto cr_row = [&](uint32_t y) { return f->v + static_cast<size_t>(y >> 1) * job.uv_pitch; };
+
+    const uint8_t* yr;
+    const uint8_t* ur;
+    const uint8_t* vr;
+    uint32_t above = sy > 0 ? sy - 1 : 0;
+    uint32_t below = sy + 1 < h ? sy + 1 : h - 1;
+
+    if (vp->deinterlace == OC_VPOST_DEINTERLACE_BOB && is_other_field(vp, sy)) {
+        // Repeat the nearest line of the kept field
+        uint32_t src = sy > 0 ? sy - 1 : std::min(sy + 1, h - 1);
+        yr = luma_row(src);
+        ur = cb_row(src);
+        vr = cr_row(src);
+    } else if (vp->deinterlace == OC_VPOST_DEINTERLACE_MOTION_ADAPTIVE && vp->line_moving[sy]) {
+        average_row(job, luma_row(above), luma_row(below), band.luma.data(), w);
+        average_row(job, cb_row(above), cb_row(below), band.cb.data(), job.chroma_width);
+        average_row(job, cr_row(above), cr_row(below), band.cr.data(), job.chroma_width);
+        yr = band.luma.data();
+        ur = band.cb.data();
+        vr = band.cr.data();
+    } else {
+        yr = luma_row(sy);
+        ur = cb_row(sy);
+        vr = cr_row(sy);
+    }
+
+    uint8_t* rgba = band.rgba.data() + VPOST_ROW_PAD * 4;
+#if OC_X86_64
+    if (job.avx2) {
+        csc_row_avx2(job.csc, yr, ur, vr, vp->alpha, rgba, w);
+    } else
+#endif
+    {
+        csc_row_scalar(job.csc, yr, ur, vr, vp->alpha, rgba, 0, w);
+    }
+    for (uint32_t i = 1; i <= VPOST_ROW_PAD; i++) {
+        std::memcpy(rgba - i * 4, rgba, 4);
+        std::memcpy(rgba + (w - 1 + i) * 4, rgba + (w - 1) * 4, 4);
+    }
+
+#if OC_X86_64
+    if (job.avx2) {
+        hscale_avx2(vp->horiz, vp->horiz_pairs.data(), band.rgba.data(), out, f->out_width);
+    } else
+#endif
+    {
+        hscale_scalar(vp->horiz, band.rgba.data(), out, 0, f->out_width);
+    }
+    band.rows_produced++;
+}
+
+/**
+ * Get horizontally scaled source row sy from the band's ring, producing it
+ * if needed. Rows are requested in increasing order, so the lowest row in
+ * the ring is the one to replace.
+ */
+static const int16_t* fetch_row(const VpostJob& job, VpostBand& band, uint32_t sy,
+                                const int16_t* const* pinned, int pinned_count) {
+    int victim = -1;
+    for (int i = 0; i < VPOST_TAPS; i++) {
+        if (band.ring_row[i] == sy) return band.ring[i].data();
+        bool in_use = false;
+        for (int p = 0; p < pinned_count; p++) {
+            if (pinned[p] == band.ring[i].data()) in_use = true;
+        }
+        if (in_use) continue;
+        if (victim < 0 || band.ring_row[i] < band.ring_row[victim]) victim = i;
+    }
+    band.ring_row[victim] = sy;
+    produce_row(job, band, sy, band.ring[victim].data());
+    return band.ring[victim].data();
+}
+
+static void run_band(const VpostJob& job, size_t index) {
+    oc_vpost_t* vp = job.vp;
+    const oc_vpost_frame_t* f = job.frame;
+    VpostBand& band = vp->bands[index];
+    for (int i = 0; i < VPOST_TAPS; i++) band.ring_row[i] = -1;
+    band.rows_produced = 0;
+
+    uint32_t row_begin = static_cast<uint32_t>(index) * job.rows_per_band;
+    uint32_t row_end = std::min(row_begin + job.rows_per_band, f->out_height);
+    uint32_t count = f->out_width * 4;
+    int32_t last = static_cast<int32_t>(f->in_height) - 1;
+
+    for (uint32_t oy = row_begin; oy < row_end; oy++) {
+        const int16_t* rows[VPOST_TAPS];
+        int16_t coef[VPOST_TAPS];
+        int taps = 0;
+        const int16_t* c = &vp->vert.coef[static_cast<size_t>(oy) * VPOST_TAPS];
+        for (int t = 0; t < VPOST_TAPS; t++) {
+            if (c[t] == 0) continue;
+            uint32_t sy = static_cast<uint32_t>(std::clamp(vp->vert.first[oy] + t, 0, last));
+            rows[taps] = fetch_row(job, band, sy, rows, taps);
+            coef[taps] = c[t];
+            taps++;
+        }
+        // The AVX2 path consumes taps in pairs
+        if (taps & 1) {
+            rows[taps] = rows[0];
+            coef[taps] = 0;
+            taps++;
+        }
+
+        uint8_t* out = f->out + static_cast<size_t>(oy) * job.out_pitch;
+#if OC_X86_64
+        if (job.avx2) {
+            vscale_avx2(rows, coef, taps, out, count);
+            continue;
+        }
+#endif
+        vscale_scalar(rows, coef, taps, out, 0, count);
+    }
+}
+
+static void prepare(oc_vpost_t* vp, const oc_vpost_frame_t* f, uint32_t chroma_width, size_t band_count) {
+    if (!vp->horiz.matches(f->in_width, f->out_width, vp->scaling)) {
+        vp->horiz.build(f->in_width, f->out_width, vp->scaling);
+        vp->horiz_pairs.resize(static_cast<size_t>(f->out_width) * 16);
+        for (uint32_t x = 0; x < f->out_width; x++) {
+            const int16_t* c = &vp->horiz.coef[static_cast<size_t>(x) * VPOST_TAPS];
+            int16_t* p = &vp->horiz_pairs[static_cast<size_t>(x) * 16];
+            for (int ch = 0; ch < 4; ch++) {
+                p[ch * 2 + 0] = c[0];
+                p[ch * 2 + 1] = c[1];
+                p[8 + ch * 2 + 0] = c[2];
+                p[8 + ch * 2 + 1] = c[3];
+            }
+        }
+    }
+    if (!vp->vert.matches(f->in_height, f->out_height, vp->scaling)) {
+        vp->vert.build(f->in_height, f->out_height, vp->scaling);
+    }
+
+    if (vp->bands.size() < band_count) vp->bands.resize(band_count);
+    for (size_t i = 0; i < band_count; i++) {
+        VpostBand& band = vp->bands[i];
+        band.luma.resize(f->in_width);
+        band.cb.resize(chroma_width);
+        band.cr.resize(chroma_width);
+        band.rgba.resize((f->in_width + 2 * VPOST_ROW_PAD) * 4);
+        for (auto& row : band.ring) row.resize(static_cast<size_t>(f->out_width) * 4);
+    }
+}
+
+extern "C" {
+
+oc_vpost_t* oc_vpost_create(void) {
+    return new oc_vpost_t();
+}
+
+void oc_vpost_destroy(oc_vpost_t* vp) {
+    delete vp;
+}
+
+int oc_vpost_set_deinterlace(oc_vpost_t* vp, int algorithm, int top_field_first) {
+    if (!vp || algorithm < OC_VPOST_DEINTERLACE_BOB || algorithm > OC_VPOST_DEINTERLACE_MOTION_ADAPTIVE) {
+        return -1;
+    }
+    vp->deinterlace = algorithm;
+    vp->top_field_first = top_field_first != 0;
+    return 0;
+}
+
+int oc_vpost_set_scaling(oc_vpost_t* vp, int algorithm) {
+    if (!vp || algorithm < OC_VPOST_SCALE_NEAREST || algorithm > OC_VPOST_SCALE_BICUBIC) return -1;
+    vp->scaling = algorithm;
+    return 0;
+}
+
+int oc_vpost_set_color(oc_vpost_t* vp, int matrix, uint8_t alpha) {
+    if (!vp || (matrix != OC_VPOST_MATRIX_BT601 && matrix != OC_VPOST_MATRIX_BT709)) return -1;
+    vp->matrix = matrix;
+    vp->alpha = alpha;
+    return 0;
+}
+
+void oc_vpost_enable_simd(oc_vpost_t* vp, int enable) {
+    if (vp) vp->simd = enable != 0;
+}
+
+int oc_vpost_process(oc_vpost_t* vp, const oc_vpost_frame_t* frame) {
+    if (!vp || !frame || !frame->y || !frame->u || !frame->v || !frame->out) return -1;
+    if (frame->in_width == 0 || frame->in_height == 0 ||
+        frame->out_width == 0 || frame->out_height == 0) {
+        return -1;
+    }
+    uint32_t chroma_width = (frame->in_width + 1) / 2;
+    uint32_t y_pitch = frame->y_pitch ? frame->y_pitch : frame->in_width;
+    uint32_t uv_pitch = frame->uv_pitch ? frame->uv_pitch : chroma_width;
+    uint32_t out_pitch = frame->out_pitch ? frame->out_pitch : frame->out_width * 4;
+    if (y_pitch < frame->in_width || uv_pitch < chroma_width || out_pitch < frame->out_width * 4) {
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    VpostJob job;
+    job.vp = vp;
+    job.frame = frame;
+    job.csc = csc_coefficients(vp->matrix);
+    job.y_pitch = y_pitch;
+    job.uv_pitch = uv_pitch;
+    job.out_pitch = out_pitch;
+    job.chroma_width = chroma_width;
+    job.avx2 = false;
+#if OC_X86_64
+    job.avx2 = vp->simd && oc_simd_get_level() >= OC_SIMD_AVX2;
+#endif
+
+    size_t band_count = std::min<size_t>(oc_jobs().worker_count() + 1,
+                                         std::max<uint32_t>(1, frame->out_height / VPOST_MIN_BAND_ROWS));
+    job.rows_per_band = (frame->out_height + static_cast<uint32_t>(band_count) - 1) /
+                        static_cast<uint32_t>(band_count);
+    band_count = (frame->out_height + job.rows_per_band - 1) / job.rows_per_band;
+
+    prepare(vp, frame, chroma_width, band_count);
+    if (vp->deinterlace == OC_VPOST_DEINTERLACE_MOTION_ADAPTIVE) {
+        detect_motion(job);
+    }
+
+    oc_jobs().parallel_for(band_count, 1, [&job](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) run_band(job, i);
+    }, oc_job_lane::High);
+
+    for (size_t i = 0; i < band_count; i++) {
+        vp->stats.source_rows += vp->bands[i].rows_produced;
+    }
+    vp->stats.frames++;
+    vp->stats.output_pixels += static_cast<uint64_t>(frame->out_width) * frame->out_height;
+    vp->stats.process_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    vp->stats.bands = static_cast<uint32_t>(band_count);
+    vp->stats.simd_level = job.avx2 ? 2 : 0;
+    return 0;
+}
+
+void oc_vpost_get_stats(oc_vpost_t* vp, oc_vpost_stats_t* stats) {
+    if (!vp || !stats) return;
+    *stats = vp->stats;
+}
+
+void oc_vpost_reset_stats(oc_vpost_t* vp) {
+    if (!vp) return;
+    vp->stats = oc_vpost_stats_t{};
+}
+
+} // extern "C"
@@ -0,0 +1,97 @@
+/**
+ * ppu_chain_lifetime_test: invalidate PPU blocks while they are chained
+ *
+ * A region whose bctr is predicted jumps straight into the target's code once
+ * the dispatcher links the two, through an entry slot whose address is baked
+ * into the region's native code. That code outlives the block: it stays in
+ * the JIT and may have been handed out by oc_ppu_jit_get_compiled. This test
+ * links a region to its target, invalidates it, lets the cache reclaim it and
+ * churns the heap, then runs the exported code directly. It must see the link
+ * broken and return to its caller instead of reading a freed slot. Exits
+ * non-zero on failure, including a build without LLVM.
+ */
+
+#include "oc_ffi.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+typedef void (*BlockCode)(oc_ppu_context_t* context, void* memory_base);
+
+static constexpr uint32_t REGION = 0x1000;   // mtctr r3; bctr
+static constexpr uint32_t TARGET = 0x2000;   // addi r4, r4, 1; blr
+static constexpr uint64_t RETURN = 0x3000;
+
+static uint8_t memory[0x10000];
+
+static bool compile(oc_ppu_jit_t* jit, uint32_t address, std::initializer_list<uint32_t> words) {
+    std::vector<uint8_t> code;
+    for (uint32_t word : words) {
+        for (int shift = 24; shift >= 0; shift -= 8) code.push_back(static_cast<uint8_t>(word >> shift));
+    }
+    return oc_ppu_jit_compile(jit, address, code.data(), code.size()) == 0;
+}
+
+static void reset(oc_ppu_context_t& context) {
+    std::memset(&context, 0, sizeof(context));
+    context.gpr[3] = TARGET;
+    context.lr = RETURN;
+    context.memory_base = memory;
+    context.memory_size = sizeof(memory);
+    context.instruction_budget = 1000;
+}
+
+// Reuse freed heap memory with a pattern that is not a valid code address
+static void churn_heap() {
+    std::vector<void*> blocks;
+    for (size_t size = 16; size <= 4096; size += 16) {
+        for (int i = 0; i < 8; i++) {
+            void* p = malloc(size);
+            std::memset(p, 0xA5, size);
+            blocks.push_back(p);
+        }
+    }
+    for (void* p : blocks) free(p);
+}
+
+static bool check(bool condition, const char* what) {
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition;
+}
+
+int main() {
+    oc_ppu_jit_t* jit = oc_ppu_jit_create();
+    oc_ppu_jit_btb_add(jit, REGION + 4, TARGET);
+    bool passed = compile(jit, TARGET, {0x38840001, 0x4E800020}) &&
+                  compile(jit, REGION, {0x7C6903A6, 0x4E800420});
+    if (!check(passed, "regions compile")) return 1;
+
+    // The first run leaves at the predicted target and links the two
+    oc_ppu_context_t context;
+    reset(context);
+    oc_ppu_jit_execute(jit, &context, REGION);
+    passed = check(context.next_pc == TARGET && context.gpr[4] == 0, "first run stops at the target");
+
+    // Linked: the next run continues into the target's code
+    reset(context);
+    oc_ppu_jit_execute(jit, &context, REGION);
+    passed &= check(context.next_pc == RETURN && context.gpr[4] == 1, "linked run enters the target");
+
+    BlockCode region = reinterpret_cast<BlockCode>(oc_ppu_jit_get_compiled(jit, REGION));
+    passed &= check(region != nullptr, "region code is exported");
+    if (!region) return 1;
+
+    // Invalidate while linked and let the cache free the block
+    oc_ppu_jit_invalidate(jit, REGION);
+    oc_ppu_jit_clear_cache(jit);
+    churn_heap();
+
+    reset(context);
+    region(&context, memory);
+    passed &= check(context.next_pc == TARGET && context.gpr[4] == 0,
+                    "exported code sees the link broken");
+
+    oc_ppu_jit_destroy(jit);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/**
+ * spu_channel_ir_test: check the IR the SPU JIT emits for channel access
+ *
+ * Compiled SPU blocks are not linked to native code yet, so the inline
+ * channel paths are checked on the emitted module instead: each rdch, wrch
+ * and rchcnt is built with oc_spu_jit_emit_ir (which verifies the module),
+ * and the test looks for the oc_spu_context_t field loads and stores and the
+ * runtime callback calls its channel path calls for. Exits non-zero on any
+ * mismatch, including a build without LLVM.
+ */
+
+#include "oc_ffi.h"
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static uint32_t read_callback(oc_spu_context_t*, uint8_t) { return 0; }
+static void write_callback(oc_spu_context_t*, uint8_t, uint32_t) {}
+static uint32_t count_callback(oc_spu_context_t*, uint8_t) { return 0; }
+
+static constexpr uint32_t OP_RDCH = 0x00D;
+static constexpr uint32_t OP_RCHCNT = 0x00F;
+static constexpr uint32_t OP_WRCH = 0x10D;
+
+static uint32_t channel_op(uint32_t op, uint8_t channel, uint8_t rt) {
+    return (op << 21) | (static_cast<uint32_t>(channel) << 7) | rt;
+}
+
+static size_t count_field(uint8_t channel) {
+    return offsetof(oc_spu_context_t, channel_count) + channel * sizeof(uint32_t);
+}
+
+/**
+ * The context accesses and calls of one emitted block
+ */
+struct BlockIr {
+    std::vector<std::pair<std::string, size_t>> loads;  // (value name, context offset)
+    std::vector<size_t> stores;                         // context offsets
+    std::vector<std::string> calls;
+
+    bool loads_field(const std::string& name, size_t offset) const {
+        for (const auto& load : loads) {
+            if (load.first == name && load.second == offset) return true;
+        }
+        return false;
+    }
+
+    bool accesses(size_t offset) const {
+        for (const auto& load : loads) {
+            if (load.second == offset) return true;
+        }
+        for (size_t store : stores) {
+            if (store == offset) return true;
+        }
+        return false;
+    }
+
+    bool stores_field(size_t offset) const {
+        for (size_t store : stores) {
+            if (store == offset) return true;
+        }
+        return false;
+    }
+
+    // A call through callback passing channel
+    bool calls_callback(const void* callback, uint8_t channel) const {
+        std::string address = std::to_string(reinterpret_cast<uintptr_t>(callback));
+        std::string argument = "i8 " + std::to_string(channel);
+        for (const auto& call : calls) {
+            if (call.find(address) != std::string::npos &&
+                call.find(argument) != std::string::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool calls_any() const { return !calls.empty(); }
+};
+
+/**
+ * Emit the block for one instruction and collect its 32-bit context
+ * accesses (through i8 GEPs off the state argument, %0)
+ */
+static bool emit_block(oc_spu_jit_t* jit, uint32_t address, uint32_t instruction, BlockIr& out) {
+    uint8_t code[4] = {
+        static_cast<uint8_t>(instruction >> 24), static_cast<uint8_t>(instruction >> 16),
+        static_cast<uint8_t>(instruction >> 8), static_cast<uint8_t>(instruction),
+    };
+    int length = oc_spu_jit_emit_ir(jit, address, code, sizeof(code), nullptr, 0);
+    if (length < 0) {
+        fprintf(stderr, "oc_spu_jit_emit_ir(0x%08x) failed: %d\n", instruction, length);
+        return false;
+    }
+    std::string ir(static_cast<size_t>(length) + 1, '\0');
+    oc_spu_jit_emit_ir(jit, address, code, sizeof(code), &ir[0], ir.size());
+    ir.resize(static_cast<size_t>(length));
+
+    static const std::regex gep(R"(^\s*(%[\w.]+) = getelementptr inbounds i8, (?:ptr|i8\*) %0, i64 (\d+))");
+    static const std::regex load(R"(^\s*(%[\w.]+) = load i32, (?:ptr|i32\*) (%[\w.]+))");
+    static const std::regex store(R"(^\s*store i32 [^,]+, (?:ptr|i32\*) (%[\w.]+))");
+
+    std::map<std::string, size_t> fields;
+    std::istringstream lines(ir);
+    std::string line;
+    std::smatch match;
+    while (std::getline(lines, line)) {
+        if (std::regex_search(line, match, gep)) {
+            fields[match[1]] = std::stoul(match[2]);
+        } else if (std::regex_search(line, match, load)) {
+            auto field = fields.find(match[2]);
+            if (field != fields.end()) out.loads.emplace_back(match[1].str().substr(1), field->second);
+        } else if (std::regex_search(line, match, store)) {
+            auto field = fields.find(match[1]);
+            if (field != fields.end()) out.stores.push_back(field->second);
+        } else if (line.find(" call ") != std::string::npos) {
+            out.calls.push_back(line);
+        }
+    }
+    return true;
+}
+
+struct Case {
+    const char* name;
+    uint32_t instruction;
+    bool with_count_callback;
+    bool (*check)(const BlockIr& ir);
+};
+
+static const Case CASES[] = {
+    // rdch
+    {"rdch SPU_RdDec is a direct load", channel_op(OP_RDCH, OC_SPU_CH_RD_DEC, 3), true,
+     [](const BlockIr& ir) {
+         return ir.loads_field("rdch_inline", offsetof(oc_spu_context_t, decrementer)) &&
+                !ir.calls_any();
+     }},
+    {"rdch MFC_RdTagStat is count gated", channel_op(OP_RDCH, OC_SPU_CH_RD_TAG_STAT, 3), true,
+     [](const BlockIr& ir) {
+         return ir.loads_field("rdch_count", count_field(OC_SPU_CH_RD_TAG_STAT)) &&
+                ir.loads_field("rdch_inline", offsetof(oc_spu_context_t, mfc_tag_status)) &&
+                ir.stores_field(count_field(OC_SPU_CH_RD_TAG_STAT)) &&
+                ir.calls_callback(reinterpret_cast<void*>(read_callback), OC_SPU_CH_RD_TAG_STAT);
+     }},
+    {"rdch SPU_RdInMbox calls the runtime", channel_op(OP_RDCH, OC_SPU_CH_RD_IN_MBOX, 3), true,
+     [](const BlockIr& ir) {
+         return ir.calls_callback(reinterpret_cast<void*>(read_callback), OC_SPU_CH_RD_IN_MBOX) &&
+                !ir.accesses(count_field(OC_SPU_CH_RD_IN_MBOX));
+     }},
+
+    // wrch
+    {"wrch MFC_LSA is a direct store", channel_op(OP_WRCH, OC_SPU_CH_MFC_LSA, 3), true,
+     [](const BlockIr& ir) {
+         return ir.stores_field(offsetof(oc_spu_context_t, mfc_lsa)) && !ir.calls_any();
+     }},
+    {"wrch SPU_WrOutMbox is count gated", channel_op(OP_WRCH, OC_SPU_CH_WR_OUT_MBOX, 3), true,
+     [](const BlockIr& ir) {
+         return ir.loads_field("wrch_count", count_field(OC_SPU_CH_WR_OUT_MBOX)) &&
+                ir.stores_field(offsetof(oc_spu_context_t, out_mbox)) &&
+                ir.stores_field(count_field(OC_SPU_CH_WR_OUT_MBOX)) &&
+                ir.calls_callback(reinterpret_cast<void*>(write_callback), OC_SPU_CH_WR_OUT_MBOX);
+     }},
+    {"wrch SPU_WrOutIntrMbox calls the runtime", channel_op(OP_WRCH, OC_SPU_CH_WR_OUT_INTR_MBOX, 3), true,
+     [](const BlockIr& ir) {
+         return ir.calls_callback(reinterpret_cast<void*>(write_callback),
+                                  OC_SPU_CH_WR_OUT_INTR_MBOX) &&
+                !ir.accesses(count_field(OC_SPU_CH_WR_OUT_INTR_MBOX));
+     }},
+
+    // rchcnt
+    {"rchcnt MFC_LSA is constant", channel_op(OP_RCHCNT, OC_SPU_CH_MFC_LSA, 3), true,
+     [](const BlockIr& ir) {
+         return !ir.accesses(count_field(OC_SPU_CH_MFC_LSA)) && !ir.calls_any();
+     }},
+    {"rchcnt MFC_RdTagStat reads the context count", channel_op(OP_RCHCNT, OC_SPU_CH_RD_TAG_STAT, 3), true,
+     [](const BlockIr& ir) {
+         return ir.loads_field("rchcnt_inline", count_field(OC_SPU_CH_RD_TAG_STAT)) &&
+                !ir.calls_any();
+     }},
+    {"rchcnt SPU_RdInMbox calls the count callback", channel_op(OP_RCHCNT, OC_SPU_CH_RD_IN_MBOX, 3), true,
+     [](const BlockIr& ir) {
+         return ir.calls_callback(reinterpret_cast<void*>(count_callback), OC_SPU_CH_RD_IN_MBOX) &&
+                !ir.accesses(count_field(OC_SPU_CH_RD_IN_MBOX));
+     }},
+    {"rchcnt SPU_RdInMbox without a count callback reads the context count",
+     channel_op(OP_RCHCNT, OC_SPU_CH_RD_IN_MBOX, 3), false,
+     [](const BlockIr& ir) {
+         return ir.loads_field("rchcnt_inline", count_field(OC_SPU_CH_RD_IN_MBOX)) &&
+                !ir.calls_any();
+     }},
+};
+
+int main() {
+    int failures = 0;
+    uint32_t address = 0x100;
+    for (const Case& test : CASES) {
+        oc_spu_jit_t* jit = oc_spu_jit_create();
+        oc_spu_jit_set_channel_callbacks(jit, reinterpret_cast<void*>(read_callback),
+                                         reinterpret_cast<void*>(write_callback));
+        if (test.with_count_callback) {
+            oc_spu_jit_set_channel_count_callback(jit, reinterpret_cast<void*>(count_callback));
+        }
+
+        BlockIr ir;
+        bool passed = emit_block(jit, address, test.instruction, ir) && test.check(ir);
+        printf("%s: %s\n", passed ? "ok" : "FAILED", test.name);
+        if (!passed) failures++;
+
+        oc_spu_jit_destroy(jit);
+        address += 0x10;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+/**
+ * oc_compile_server: out-of-process compile helper
+ *
+ * Spawned by oc_compile_server_start(). Serves PPU and RSX compile requests
+ * on the shared memory it inherits until the emulator stops it or exits.
+ *
+ *   oc_compile_server --fd N [--threads N]
+ */
+
+#include "oc_ffi.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    int fd = -1;
+    uint32_t threads = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--fd" && has_value) {
+            fd = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+        } else {
+            std::fprintf(stderr, "usage: oc_compile_server --fd N [--threads N]\n");
+            return 2;
+        }
+    }
+    if (fd < 0) {
+        std::fprintf(stderr, "usage: oc_compile_server --fd N [--threads N]\n");
+        return 2;
+    }
+
+    int r = oc_compile_server_serve(fd, threads);
+    if (r < 0) {
+        std::fprintf(stderr, "oc_compile_server: %s\n",
+                     r == -3 ? "not supported on this host" : "invalid shared memory");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+/**
+ * ppu_compile_bench: recompile a PPU block corpus under different pass pipelines
+ *
+ * Loads corpus files written by oc_ppu_jit_corpus_begin and compiles every
+ * unit under each selected pass pipeline, reporting compile time and emitted
+ * host bytes per guest instruction, and IR instruction counts before and
+ * after optimization, so the tier pipelines can be tuned against real game
+ * code.
+ *
+ *   ppu_compile_bench [--pipeline o0,o1,o2,o3,baseline] [--tier 1|2]
+ *                     [--iterations N] corpus...
+ *   ppu_compile_bench --make-synthetic corpus_file
+ *
+ * --tier 1 selects the baseline pipeline and --tier 2 the optimizing O2
+ * pipeline; without --pipeline or --tier both tiers are measured.
+ * --make-synthetic compiles generated blocks through the normal JIT path
+ * with corpus dumping enabled, for smoke testing.
+ */
+
+#include "oc_ffi.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct CorpusUnit {
+    oc_ppu_corpus_unit_t header;
+    std::vector<uint32_t> payload;
+};
+
+static const char* const PIPELINE_NAMES[] = {"o0", "o1", "o2", "o3", "baseline"};
+
+static bool load_corpus(const char* path, std::vector<CorpusUnit>& units) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+
+    char magic[8];
+    uint32_t header[2];
+    bool ok = std::fread(magic, sizeof(magic), 1, f) == 1 &&
+              std::fread(header, sizeof(header), 1, f) == 1 &&
+              std::memcmp(magic, "OCPPUCRP", 8) == 0 && header[0] == 1;
+    while (ok) {
+        CorpusUnit unit;
+        size_t got = std::fread(&unit.header, 1, sizeof(unit.header), f);
+        if (got != sizeof(unit.header)) {
+            ok = got == 0;  // A clean end of file, not a torn header
+            break;
+        }
+        const auto& h = unit.header;
+        size_t words = size_t(h.instruction_count) + size_t(h.inlined_call_count) * 4 +
+                       h.jump_table_targets + size_t(h.guard_count) * 4;
+        if (h.instruction_count == 0 || words > (1u << 20)) {
+            ok = false;
+            break;
+        }
+        unit.payload.resize(words);
+        if (std::fread(unit.payload.data(), sizeof(uint32_t), words, f) != words) {
+            ok = false;
+            break;
+        }
+        units.push_back(std::move(unit));
+    }
+    std::fclose(f);
+    return ok;
+}
+
+static int parse_pipeline(const std::string& name) {
+    for (int i = 0; i < 5; i++) {
+        if (name == PIPELINE_NAMES[i]) return i;
+    }
+    return -1;
+}
+
+static double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// ============================================================================
+// Synthetic corpus
+// ============================================================================
+
+static int make_synthetic(const char* path) {
+    oc_ppu_jit_t* jit = oc_ppu_jit_create();
+    if (!jit || oc_ppu_jit_corpus_begin(jit, path) != 0) {
+        std::fprintf(stderr, "cannot write corpus to %s\n", path);
+        oc_ppu_jit_destroy(jit);
+        return 1;
+    }
+
+    // Straight-line integer blocks ending in blr
+    static const uint32_t BODY[] = {
+        0x38630001,  // addi r3, r3, 1
+        0x7C832A14,  // add r4, r3, r5
+        0x80C10000,  // lwz r6, 0(r1)
+        0x90C10004,  // stw r6, 4(r1)
+        0x7C641B78,  // mr r4, r3
+        0x5463103A,  // rlwinm r3, r3, 2, 0, 29
+    };
+    uint32_t seed = 0x12345678;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    for (uint32_t i = 0; i < 64; i++) {
+        std::vector<uint32_t> words(2 + next() % 48);
+        for (auto& w : words) w = BODY[next() % (sizeof(BODY) / sizeof(BODY[0]))];
+        words.push_back(0x4E800020);  // blr
+        std::vector<uint8_t> code;
+        for (uint32_t w : words) {
+            code.push_back(uint8_t(w >> 24));
+            code.push_back(uint8_t(w >> 16));
+            code.push_back(uint8_t(w >> 8));
+            code.push_back(uint8_t(w));
+        }
+        oc_ppu_jit_compile(jit, 0x10000 + i * 0x400, code.data(), code.size());
+    }
+
+    uint64_t units = oc_ppu_jit_corpus_get_count(jit);
+    oc_ppu_jit_corpus_end(jit);
+    oc_ppu_jit_destroy(jit);
+    std::printf("%s: %llu units\n", path, static_cast<unsigned long long>(units));
+    return units ? 0 : 1;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage() {
+    std::fprintf(stderr,
+        "usage: ppu_compile_bench [--pipeline o0,o1,o2,o3,baseline] [--tier 1|2]\n"
+        "                         [--iterations N] corpus...\n"
+        "       ppu_compile_bench --make-synthetic corpus_file\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t iterations = 3;
+    std::vector<int> pipelines;
+    std::vector<const char*> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) {
+            iterations = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--pipeline" && has_value) {
+            std::string list = argv[++i];
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                int p = parse_pipeline(list.substr(pos, comma - pos));
+                if (p < 0) { usage(); return 2; }
+                pipelines.push_back(p);
+                pos = comma + 1;
+            }
+        } else if (arg == "--tier" && has_value) {
+            std::string tier = argv[++i];
+            if (tier == "1") pipelines.push_back(OC_PPU_PASS_PIPELINE_BASELINE);
+            else if (tier == "2") pipelines.push_back(OC_PPU_PASS_PIPELINE_O2);
+            else { usage(); return 2; }
+        } else if (arg == "--make-synthetic" && has_value) {
+            return make_synthetic(argv[++i]);
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty() || iterations == 0) {
+        usage();
+        return 2;
+    }
+    if (pipelines.empty()) {
+        pipelines = {OC_PPU_PASS_PIPELINE_BASELINE, OC_PPU_PASS_PIPELINE_O2};
+    }
+
+    std::vector<CorpusUnit> units;
+    for (const char* path : paths) {
+        if (!load_corpus(path, units)) {
+            std::fprintf(stderr, "%s: not a PPU compile corpus or truncated\n", path);
+            return 1;
+        }
+    }
+    if (units.empty()) {
+        std::fprintf(stderr, "no units found\n");
+        return 1;
+    }
+    uint64_t guest_instructions = 0;
+    for (const auto& unit : units) guest_instructions += unit.header.instruction_count;
+    std::printf("%zu units, %llu guest instructions, %llu iterations\n", units.size(),
+                static_cast<unsigned long long>(guest_instructions),
+                static_cast<unsigned long long>(iterations));
+
+    uint64_t failures = 0;
+    for (int pipeline : pipelines) {
+        // Fresh JIT per pipeline so nothing carries over between runs
+        oc_ppu_jit_t* jit = oc_ppu_jit_create();
+        oc_ppu_jit_set_pass_pipeline(jit, pipeline);
+
+        std::vector<double> unit_us;
+        double total_ns = 0;
+        uint64_t host_bytes = 0, ir_before = 0, ir_after = 0, native = 0;
+        for (uint64_t it = 0; it < iterations; it++) {
+            for (const auto& unit : units) {
+                oc_ppu_compile_metrics_t m;
+                int r = oc_ppu_jit_compile_unit(jit, &unit.header, unit.payload.data(), &m);
+                if (r < 0) {
+                    failures++;
+                    continue;
+                }
+                unit_us.push_back(double(m.compile_ns) / 1000.0);
+                total_ns += double(m.compile_ns);
+                if (it == 0) {
+                    host_bytes += m.host_bytes;
+                    ir_before += m.ir_instructions_before;
+                    ir_after += m.ir_instructions_after;
+                    native += m.native;
+                }
+            }
+        }
+        oc_ppu_jit_destroy(jit);
+
+        double guest = double(guest_instructions);
+        std::printf("  %-8s  %8.1f ns/guest insn, p99 %.1f us/unit, %6.1f host bytes/guest insn\n",
+                    PIPELINE_NAMES[pipeline], total_ns / (guest * double(iterations)),
+                    percentile(unit_us, 0.99), double(host_bytes) / guest);
+        std::printf("            IR %llu -> %llu instructions (%.2fx), %llu/%zu units native\n",
+                    static_cast<unsigned long long>(ir_before), static_cast<unsigned long long>(ir_after),
+                    ir_before ? double(ir_after) / double(ir_before) : 0.0,
+                    static_cast<unsigned long long>(native), units.size());
+    }
+    if (failures) {
+        std::printf("  FAILED: %llu compiles failed\n", static_cast<unsigned long long>(failures));
+        return 1;
+    }
+    return 0;
+}
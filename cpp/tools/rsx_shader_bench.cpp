@@ -0,0 +1,279 @@
+/**
+ * rsx_shader_bench: replay an RSX shader corpus through the shader compiler
+ *
+ * Loads a corpus written by oc_rsx_shader_corpus_begin (vp_*.bin, fp_*.bin,
+ * pipelines.bin) and, per iteration, compiles every program with a fresh
+ * compiler, links the VP/FP pair of every recorded pipeline and creates the
+ * pipeline with a stubbed creation callback. Reports shaders/s, latency
+ * percentiles and SPIR-V size so the translator can be tuned against real
+ * game shaders.
+ *
+ *   rsx_shader_bench [--iterations N] corpus_dir
+ *   rsx_shader_bench --make-synthetic corpus_dir
+ *
+ * --make-synthetic fills an existing directory with a small generated
+ * corpus through the normal dumping path, for smoke testing.
+ */
+
+#include "oc_ffi.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+using bench_clock = std::chrono::steady_clock;
+
+struct CorpusShader {
+    uint64_t hash;
+    std::vector<uint32_t> code;
+};
+
+struct Corpus {
+    std::vector<CorpusShader> vertex;
+    std::vector<CorpusShader> fragment;
+    std::vector<oc_rsx_corpus_pipeline_t> pipelines;
+};
+
+static bool read_file(const fs::path& path, std::vector<uint8_t>& out) {
+    FILE* f = std::fopen(path.string().c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    out.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    bool ok = out.empty() || std::fread(out.data(), 1, out.size(), f) == out.size();
+    std::fclose(f);
+    return ok;
+}
+
+static bool load_corpus(const fs::path& dir, Corpus& corpus) {
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        bool is_vp = name.rfind("vp_", 0) == 0;
+        bool is_fp = name.rfind("fp_", 0) == 0;
+        if ((!is_vp && !is_fp) || entry.path().extension() != ".bin") continue;
+
+        std::vector<uint8_t> bytes;
+        if (!read_file(entry.path(), bytes) || bytes.empty() || bytes.size() % 4) {
+            std::fprintf(stderr, "skipping malformed %s\n", name.c_str());
+            continue;
+        }
+        CorpusShader shader;
+        shader.hash = std::strtoull(name.c_str() + 3, nullptr, 16);
+        shader.code.resize(bytes.size() / 4);
+        std::memcpy(shader.code.data(), bytes.data(), bytes.size());
+        (is_vp ? corpus.vertex : corpus.fragment).push_back(std::move(shader));
+    }
+    if (ec) return false;
+
+    // Directory order is arbitrary; sort so runs are comparable
+    auto by_hash = [](const CorpusShader& a, const CorpusShader& b) { return a.hash < b.hash; };
+    std::sort(corpus.vertex.begin(), corpus.vertex.end(), by_hash);
+    std::sort(corpus.fragment.begin(), corpus.fragment.end(), by_hash);
+
+    std::vector<uint8_t> bytes;
+    if (read_file(dir / "pipelines.bin", bytes)) {
+        size_t count = bytes.size() / sizeof(oc_rsx_corpus_pipeline_t);
+        corpus.pipelines.resize(count);
+        std::memcpy(corpus.pipelines.data(), bytes.data(), count * sizeof(oc_rsx_corpus_pipeline_t));
+    }
+    return true;
+}
+
+// Stubbed pipeline creation: hands out distinct non-null tokens
+static uintptr_t g_next_pipeline = 0x1000;
+static void* stub_create_pipeline(const void*) { return reinterpret_cast<void*>(g_next_pipeline += 16); }
+static void stub_destroy_pipeline(void*) {}
+
+static double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+static double elapsed_us(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(bench_clock::now() - start).count();
+}
+
+// ============================================================================
+// Synthetic corpus
+// ============================================================================
+
+static int make_synthetic(const char* dir) {
+    oc_rsx_shader_t* shader = oc_rsx_shader_create();
+    if (oc_rsx_shader_corpus_begin(shader, dir) != 0) {
+        std::fprintf(stderr, "cannot write corpus to %s\n", dir);
+        oc_rsx_shader_destroy(shader);
+        return 1;
+    }
+
+    uint32_t seed = 0x12345678;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed; };
+    for (int i = 0; i < 64; i++) {
+        bool is_vertex = i % 2 == 0;
+        std::vector<uint32_t> code(4 * (4 + next() % 60));
+        for (auto& w : code) w = next();
+        uint32_t* spirv = nullptr;
+        size_t spirv_size = 0;
+        if (is_vertex) oc_rsx_shader_compile_vertex(shader, code.data(), code.size(), &spirv, &spirv_size);
+        else oc_rsx_shader_compile_fragment(shader, code.data(), code.size(), &spirv, &spirv_size);
+        oc_rsx_shader_free_spirv(spirv);
+    }
+
+    // Pipelines reference shaders by microcode hash; pick pairs from the dump
+    Corpus corpus;
+    load_corpus(dir, corpus);
+    for (size_t i = 0; i < corpus.vertex.size() && !corpus.fragment.empty(); i++) {
+        for (int variant = 0; variant < 2; variant++) {
+            oc_rsx_shader_get_pipeline(shader, corpus.vertex[i].hash,
+                                       corpus.fragment[(i * 7 + variant) % corpus.fragment.size()].hash,
+                                       0x3u << variant, static_cast<uint8_t>(variant * 2),
+                                       static_cast<uint8_t>(variant));
+        }
+    }
+
+    uint64_t vps = 0, fps = 0, pipelines = 0;
+    oc_rsx_shader_corpus_get_stats(shader, &vps, &fps, &pipelines);
+    oc_rsx_shader_corpus_end(shader);
+    oc_rsx_shader_destroy(shader);
+    std::printf("%s: %llu vertex programs, %llu fragment programs, %llu pipelines\n", dir,
+                static_cast<unsigned long long>(vps), static_cast<unsigned long long>(fps),
+                static_cast<unsigned long long>(pipelines));
+    return 0;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage() {
+    std::fprintf(stderr,
+        "usage: rsx_shader_bench [--iterations N] corpus_dir\n"
+        "       rsx_shader_bench --make-synthetic corpus_dir\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t iterations = 10;
+    const char* dir = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) iterations = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--make-synthetic" && has_value) return make_synthetic(argv[++i]);
+        else if (!arg.empty() && arg[0] == '-') { usage(); return 2; }
+        else dir = argv[i];
+    }
+    if (!dir || iterations == 0) {
+        usage();
+        return 2;
+    }
+
+    Corpus corpus;
+    if (!load_corpus(dir, corpus) || (corpus.vertex.empty() && corpus.fragment.empty())) {
+        std::fprintf(stderr, "%s: no shaders found\n", dir);
+        return 1;
+    }
+
+    std::unordered_map<uint64_t, size_t> vp_index, fp_index;
+    for (size_t i = 0; i < corpus.vertex.size(); i++) vp_index[corpus.vertex[i].hash] = i;
+    for (size_t i = 0; i < corpus.fragment.size(); i++) fp_index[corpus.fragment[i].hash] = i;
+
+    std::vector<double> compile_us, link_us, pipeline_us;
+    uint64_t spirv_words = 0, microcode_words = 0, failures = 0;
+    double compile_total = 0, link_total = 0, pipeline_total = 0;
+
+    for (uint64_t it = 0; it < iterations; it++) {
+        // Fresh compiler each iteration so every compile misses the caches
+        oc_rsx_shader_t* shader = oc_rsx_shader_create();
+        oc_rsx_shader_set_pipeline_callbacks(shader, reinterpret_cast<void*>(stub_create_pipeline),
+                                             reinterpret_cast<void*>(stub_destroy_pipeline));
+        std::vector<std::vector<uint32_t>> vp_spirv(corpus.vertex.size());
+        std::vector<std::vector<uint32_t>> fp_spirv(corpus.fragment.size());
+
+        for (int pass = 0; pass < 2; pass++) {
+            const auto& programs = pass == 0 ? corpus.vertex : corpus.fragment;
+            auto& outputs = pass == 0 ? vp_spirv : fp_spirv;
+            for (size_t i = 0; i < programs.size(); i++) {
+                uint32_t* spirv = nullptr;
+                size_t size = 0;
+                auto start = bench_clock::now();
+                int r = pass == 0
+                    ? oc_rsx_shader_compile_vertex(shader, programs[i].code.data(), programs[i].code.size(), &spirv, &size)
+                    : oc_rsx_shader_compile_fragment(shader, programs[i].code.data(), programs[i].code.size(), &spirv, &size);
+                double us = elapsed_us(start);
+                compile_us.push_back(us);
+                compile_total += us;
+                if (r != 0 || !spirv) {
+                    failures++;
+                    continue;
+                }
+                outputs[i].assign(spirv, spirv + size);
+                oc_rsx_shader_free_spirv(spirv);
+                if (it == 0) {
+                    spirv_words += size;
+                    microcode_words += programs[i].code.size();
+                }
+            }
+        }
+
+        for (const auto& p : corpus.pipelines) {
+            auto vp = vp_index.find(p.vs_hash);
+            auto fp = fp_index.find(p.fs_hash);
+            if (vp != vp_index.end() && fp != fp_index.end() &&
+                !vp_spirv[vp->second].empty() && !fp_spirv[fp->second].empty()) {
+                const auto& vs = vp_spirv[vp->second];
+                const auto& fs = fp_spirv[fp->second];
+                auto start = bench_clock::now();
+                int r = oc_rsx_shader_link(shader, vs.data(), vs.size(), fs.data(), fs.size());
+                double us = elapsed_us(start);
+                link_us.push_back(us);
+                link_total += us;
+                if (r != 0) failures++;
+            }
+
+            auto start = bench_clock::now();
+            void* pipeline = oc_rsx_shader_get_pipeline(shader, p.vs_hash, p.fs_hash, p.vertex_mask,
+                                                        p.cull_mode, p.blend_enable);
+            double us = elapsed_us(start);
+            pipeline_us.push_back(us);
+            pipeline_total += us;
+            if (!pipeline) failures++;
+        }
+        oc_rsx_shader_destroy(shader);
+    }
+
+    size_t shaders = corpus.vertex.size() + corpus.fragment.size();
+    std::printf("%s: %zu vertex programs, %zu fragment programs, %zu pipelines, %llu iterations\n",
+                dir, corpus.vertex.size(), corpus.fragment.size(), corpus.pipelines.size(),
+                static_cast<unsigned long long>(iterations));
+    std::printf("  compile:  %.0f shaders/s, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                compile_total > 0 ? double(compile_us.size()) * 1e6 / compile_total : 0.0,
+                percentile(compile_us, 0.50), percentile(compile_us, 0.99),
+                compile_us.empty() ? 0.0 : *std::max_element(compile_us.begin(), compile_us.end()));
+    std::printf("  spir-v:   %.1f words/shader avg, %.2fx microcode size\n",
+                shaders ? double(spirv_words) / double(shaders) : 0.0,
+                microcode_words ? double(spirv_words) / double(microcode_words) : 0.0);
+    if (!corpus.pipelines.empty()) {
+        std::printf("  link:     %.0f links/s, p99 %.1f us (%llu linked pairs)\n",
+                    link_total > 0 ? double(link_us.size()) * 1e6 / link_total : 0.0,
+                    percentile(link_us, 0.99),
+                    static_cast<unsigned long long>(link_us.size() / iterations));
+        std::printf("  pipeline: %.0f pipelines/s, p99 %.1f us\n",
+                    pipeline_total > 0 ? double(pipeline_us.size()) * 1e6 / pipeline_total : 0.0,
+                    percentile(pipeline_us, 0.99));
+    }
+    if (failures) {
+        std::printf("  FAILED: %llu operations failed\n", static_cast<unsigned long long>(failures));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,905 @@
+/**
+ * spu_replay_bench: replay captured SPU jobs and report throughput
+ *
+ * Loads job captures written by oc_spu_capture_begin/end, re-executes each
+ * job from its captured starting state with DMA serviced from the capture,
+ * verifies the PUTs and end state against the capture, and reports
+ * instruction and DMA throughput. Exits non-zero if any replay diverges, so
+ * a directory of captures works as a regression suite.
+ *
+ * Executors:
+ *   interp  Reference interpreter in this file
+ *   jit     SPU JIT, falling back to the interpreter per block for code the
+ *           JIT has no native code for
+ *
+ *   spu_replay_bench [--exec interp|jit] [--iterations N]
+ *                    [--max-instructions N] capture...
+ *   spu_replay_bench --make-synthetic PATH
+ *
+ * --make-synthetic runs a small built-in kernel (GET, transform, PUT) against
+ * host memory with capture enabled, producing a capture for smoke testing.
+ */
+
+#include "oc_ffi.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t SPU_LS_SIZE = 0x40000;
+static constexpr uint32_t LS_MASK_QUAD = 0x3FFF0;
+static constexpr uint32_t LS_MASK_INSN = 0x3FFFC;
+
+
+// ============================================================================
+// DMA sinks
+// ============================================================================
+
+/**
+ * Where the interpreter sends MFC commands
+ */
+struct DmaSink {
+    virtual ~DmaSink() = default;
+    // Returns false if the command cannot be serviced (ends the run)
+    virtual bool transfer(oc_spu_context_t* ctx, uint32_t lsa, uint64_t ea,
+                          uint32_t size, uint16_t tag, uint8_t cmd) = 0;
+};
+
+// Services commands from a capture
+struct ReplaySink : DmaSink {
+    oc_spu_replay_t* replay;
+    explicit ReplaySink(oc_spu_replay_t* r) : replay(r) {}
+
+    bool transfer(oc_spu_context_t* ctx, uint32_t lsa, uint64_t ea,
+                  uint32_t size, uint16_t tag, uint8_t cmd) override {
+        int r = (cmd & 0x04)
+            ? oc_spu_replay_dma_list(replay, ctx->local_storage, lsa, size, tag, cmd)
+            : oc_spu_replay_dma(replay, ctx->local_storage, lsa, ea, size, tag, cmd);
+        return r >= 0;
+    }
+};
+
+// Performs commands against host memory through the DMA engine
+struct MemorySink : DmaSink {
+    uint8_t* memory;
+    explicit MemorySink(uint8_t* m) : memory(m) {}
+
+    bool transfer(oc_spu_context_t* ctx, uint32_t lsa, uint64_t ea,
+                  uint32_t size, uint16_t tag, uint8_t cmd) override {
+        int r = (cmd & 0x04)
+            ? oc_dma_list_transfer(ctx->local_storage, lsa, memory, size, tag, cmd)
+            : oc_dma_transfer(ctx->local_storage, lsa, memory, ea, size, tag, cmd);
+        return r >= 0;
+    }
+};
+
+// ============================================================================
+// Reference interpreter
+// ============================================================================
+
+struct V {
+    uint32_t w[4];
+};
+
+static inline uint8_t get_b(const V& v, int i) { return uint8_t(v.w[i >> 2] >> (24 - 8 * (i & 3))); }
+static inline uint16_t get_h(const V& v, int i) { return uint16_t(v.w[i >> 1] >> ((i & 1) ? 0 : 16)); }
+
+static inline void set_b(V& v, int i, uint8_t x) {
+    int s = 24 - 8 * (i & 3);
+    v.w[i >> 2] = (v.w[i >> 2] & ~(0xFFu << s)) | (uint32_t(x) << s);
+}
+
+static inline void set_h(V& v, int i, uint16_t x) {
+    int s = (i & 1) ? 0 : 16;
+    v.w[i >> 1] = (v.w[i >> 1] & ~(0xFFFFu << s)) | (uint32_t(x) << s);
+}
+
+static inline float as_f(uint32_t x) { float f; std::memcpy(&f, &x, 4); return f; }
+static inline uint32_t from_f(float f) { uint32_t x; std::memcpy(&x, &f, 4); return x; }
+static inline double as_d(uint64_t x) { double d; std::memcpy(&d, &x, 8); return d; }
+static inline uint64_t from_d(double d) { uint64_t x; std::memcpy(&x, &d, 8); return x; }
+static inline uint64_t get_dw(const V& v, int i) { return (uint64_t(v.w[i * 2]) << 32) | v.w[i * 2 + 1]; }
+static inline void set_dw(V& v, int i, uint64_t x) { v.w[i * 2] = uint32_t(x >> 32); v.w[i * 2 + 1] = uint32_t(x); }
+
+static inline uint32_t rotl32(uint32_t x, uint32_t n) { n &= 31; return n ? (x << n) | (x >> (32 - n)) : x; }
+static inline uint16_t rotl16(uint16_t x, uint32_t n) { n &= 15; return n ? uint16_t((x << n) | (x >> (16 - n))) : x; }
+static inline int32_t sext(uint32_t x, int bits) { return int32_t(x << (32 - bits)) >> (32 - bits); }
+
+// Quadword byte shifts/rotates; byte 0 is the most significant
+static V qw_shl_bytes(const V& a, uint32_t n) {
+    V r = {};
+    for (int i = 0; i + uint32_t(n) < 16 && n < 16; i++) set_b(r, i, get_b(a, i + n));
+    return r;
+}
+static V qw_shr_bytes(const V& a, uint32_t n) {
+    V r = {};
+    for (int i = n; i < 16 && n < 16; i++) set_b(r, i, get_b(a, i - n));
+    return r;
+}
+static V qw_rotl_bytes(const V& a, uint32_t n) {
+    V r;
+    for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, (i + n) & 15));
+    return r;
+}
+static V qw_shl_bits(const V& a, uint32_t n) {
+    if (!n) return a;
+    V r;
+    for (int i = 0; i < 4; i++) r.w[i] = (a.w[i] << n) | (i < 3 ? a.w[i + 1] >> (32 - n) : 0);
+    return r;
+}
+static V qw_shr_bits(const V& a, uint32_t n) {
+    if (!n) return a;
+    V r;
+    for (int i = 0; i < 4; i++) r.w[i] = (a.w[i] >> n) | (i > 0 ? a.w[i - 1] << (32 - n) : 0);
+    return r;
+}
+static V qw_rotl_bits(const V& a, uint32_t n) {
+    if (!n) return a;
+    V r;
+    for (int i = 0; i < 4; i++) r.w[i] = (a.w[i] << n) | (a.w[(i + 1) & 3] >> (32 - n));
+    return r;
+}
+
+enum class StepResult { Continue, Control, Stopped, Error };
+
+/**
+ * Interpreter over oc_spu_context_t. gpr[r][0] is the preferred slot (the
+ * most significant word of the big-endian register).
+ */
+struct SpuReferenceInterpreter {
+    DmaSink* dma = nullptr;
+    uint32_t mfc_args[5] = {};       // LSA, EAH, EAL, Size, TagID
+    uint32_t tag_mask = 0;
+    const char* error = nullptr;
+
+    V reg(const oc_spu_context_t* ctx, uint32_t r) const {
+        V v;
+        std::memcpy(v.w, ctx->gpr[r], 16);
+        return v;
+    }
+    void set(oc_spu_context_t* ctx, uint32_t r, const V& v) const {
+        std::memcpy(ctx->gpr[r], v.w, 16);
+    }
+
+    V load(const oc_spu_context_t* ctx, uint32_t addr) const {
+        const uint8_t* p = static_cast<const uint8_t*>(ctx->local_storage) + (addr & LS_MASK_QUAD);
+        V v;
+        for (int i = 0; i < 4; i++) {
+            v.w[i] = (uint32_t(p[i * 4]) << 24) | (uint32_t(p[i * 4 + 1]) << 16) |
+                     (uint32_t(p[i * 4 + 2]) << 8) | p[i * 4 + 3];
+        }
+        return v;
+    }
+    void store(oc_spu_context_t* ctx, uint32_t addr, const V& v) const {
+        uint8_t* p = static_cast<uint8_t*>(ctx->local_storage) + (addr & LS_MASK_QUAD);
+        for (int i = 0; i < 16; i++) p[i] = get_b(v, i);
+    }
+
+    StepResult fail(const char* why) {
+        error = why;
+        return StepResult::Error;
+    }
+
+    StepResult read_channel(oc_spu_context_t* ctx, uint32_t ch, uint32_t rt) {
+        uint32_t value;
+        switch (ch) {
+            case OC_SPU_CH_RD_EVENT_STAT: value = 0; break;
+            case OC_SPU_CH_RD_DEC: value = ctx->decrementer; break;
+            case OC_SPU_CH_RD_EVENT_MASK: value = ctx->event_mask; break;
+            case OC_SPU_CH_RD_TAG_MASK: value = tag_mask; break;
+            case OC_SPU_CH_RD_MACH_STAT: value = 0; break;
+            case OC_SPU_CH_RD_SRR0: value = ctx->srr0; break;
+            case OC_SPU_CH_RD_TAG_STAT: value = tag_mask; break;  // Transfers complete immediately
+            case OC_SPU_CH_RD_LIST_STALL_STAT: value = 0; break;
+            default: return fail("read of a channel whose input is not captured");
+        }
+        V v = {{value, 0, 0, 0}};
+        set(ctx, rt, v);
+        return StepResult::Continue;
+    }
+
+    StepResult write_channel(oc_spu_context_t* ctx, uint32_t ch, uint32_t value) {
+        switch (ch) {
+            case OC_SPU_CH_MFC_LSA: case OC_SPU_CH_MFC_EAH: case OC_SPU_CH_MFC_EAL: case OC_SPU_CH_MFC_SIZE: case OC_SPU_CH_MFC_TAG_ID:
+                mfc_args[ch - OC_SPU_CH_MFC_LSA] = value;
+                return StepResult::Continue;
+            case OC_SPU_CH_MFC_CMD: {
+                uint8_t cmd = uint8_t(value);
+                if ((cmd & 0xF0) != 0x40 && (cmd & 0xF0) != 0x20) {
+                    return fail("unsupported MFC command");
+                }
+                uint64_t ea = (uint64_t(mfc_args[1]) << 32) | mfc_args[2];
+                if (!dma->transfer(ctx, mfc_args[0] & (SPU_LS_SIZE - 1), ea, mfc_args[3],
+                                   uint16_t(mfc_args[4] & 31), cmd)) {
+                    return fail("DMA diverged from capture");
+                }
+                return StepResult::Continue;
+            }
+            case OC_SPU_CH_WR_TAG_MASK: tag_mask = value; return StepResult::Continue;
+            case OC_SPU_CH_WR_EVENT_MASK: ctx->event_mask = value; return StepResult::Continue;
+            case OC_SPU_CH_WR_DEC: ctx->decrementer = value; return StepResult::Continue;
+            case OC_SPU_CH_WR_SRR0: ctx->srr0 = value; return StepResult::Continue;
+            case OC_SPU_CH_WR_EVENT_ACK: case OC_SPU_CH_WR_MS_SYNC_REQ: case OC_SPU_CH_WR_TAG_UPDATE:
+            case OC_SPU_CH_WR_LIST_STALL_ACK: case OC_SPU_CH_WR_OUT_MBOX: case OC_SPU_CH_WR_OUT_INTR_MBOX:
+                return StepResult::Continue;
+            default:
+                return fail("write to unsupported channel");
+        }
+    }
+
+    uint32_t channel_count(uint32_t ch) const {
+        switch (ch) {
+            case OC_SPU_CH_MFC_CMD: return 16;
+            case OC_SPU_CH_RD_IN_MBOX: case OC_SPU_CH_RD_SIG_NOTIFY1: case OC_SPU_CH_RD_SIG_NOTIFY2:
+            case OC_SPU_CH_RD_ATOMIC_STAT: case OC_SPU_CH_RD_LIST_STALL_STAT: case OC_SPU_CH_RD_EVENT_STAT:
+                return 0;
+            default: return 1;
+        }
+    }
+
+    StepResult branch(oc_spu_context_t* ctx, uint32_t target) {
+        ctx->pc = target & LS_MASK_INSN;
+        return StepResult::Control;
+    }
+
+    StepResult step(oc_spu_context_t* ctx);
+    StepResult step_rr(oc_spu_context_t* ctx, uint32_t op, uint32_t op11);
+};
+
+StepResult SpuReferenceInterpreter::step(oc_spu_context_t* ctx) {
+    const uint8_t* ls = static_cast<const uint8_t*>(ctx->local_storage);
+    uint32_t pc = ctx->pc & LS_MASK_INSN;
+    uint32_t op = (uint32_t(ls[pc]) << 24) | (uint32_t(ls[pc + 1]) << 16) |
+                  (uint32_t(ls[pc + 2]) << 8) | ls[pc + 3];
+    ctx->decrementer--;
+    ctx->pc = (pc + 4) & LS_MASK_INSN;
+
+    uint32_t rt = op & 0x7F, ra = (op >> 7) & 0x7F, rb = (op >> 14) & 0x7F;
+
+    // RRR form (4-bit opcode); the target is in the high register field
+    switch (op >> 28) {
+        case 0x8: case 0xB: case 0xC: case 0xD: case 0xE: case 0xF: {
+            uint32_t rt4 = (op >> 21) & 0x7F, rc = rt;
+            V a = reg(ctx, ra), b = reg(ctx, rb), c = reg(ctx, rc), r;
+            switch (op >> 28) {
+                case 0x8:  // selb
+                    for (int i = 0; i < 4; i++) r.w[i] = (c.w[i] & b.w[i]) | (~c.w[i] & a.w[i]);
+                    break;
+                case 0xB:  // shufb
+                    for (int i = 0; i < 16; i++) {
+                        uint8_t s = get_b(c, i), x;
+                        if ((s & 0xC0) == 0x80) x = 0x00;
+                        else if ((s & 0xE0) == 0xC0) x = 0xFF;
+                        else if ((s & 0xE0) == 0xE0) x = 0x80;
+                        else x = (s & 0x10) ? get_b(b, s & 15) : get_b(a, s & 15);
+                        set_b(r, i, x);
+                    }
+                    break;
+                case 0xC:  // mpya
+                    for (int i = 0; i < 4; i++) {
+                        r.w[i] = uint32_t(int32_t(int16_t(a.w[i])) * int32_t(int16_t(b.w[i]))) + c.w[i];
+                    }
+                    break;
+                case 0xD:  // fnms
+                    for (int i = 0; i < 4; i++) r.w[i] = from_f(as_f(c.w[i]) - as_f(a.w[i]) * as_f(b.w[i]));
+                    break;
+                case 0xE:  // fma
+                    for (int i = 0; i < 4; i++) r.w[i] = from_f(as_f(a.w[i]) * as_f(b.w[i]) + as_f(c.w[i]));
+                    break;
+                default:   // fms
+                    for (int i = 0; i < 4; i++) r.w[i] = from_f(as_f(a.w[i]) * as_f(b.w[i]) - as_f(c.w[i]));
+                    break;
+            }
+            set(ctx, rt4, r);
+            return StepResult::Continue;
+        }
+        default: break;
+    }
+
+    // RI18 form (7-bit opcode)
+    switch (op >> 25) {
+        case 0x21: {  // ila
+            uint32_t i18 = (op >> 7) & 0x3FFFF;
+            V r = {{i18, i18, i18, i18}};
+            set(ctx, rt, r);
+            return StepResult::Continue;
+        }
+        case 0x08: case 0x09:  // hbra, hbrr
+            return StepResult::Continue;
+        default: break;
+    }
+
+    // RI10 form (8-bit opcode)
+    {
+        int32_t s10 = sext((op >> 14) & 0x3FF, 10);
+        uint32_t u10 = uint32_t(s10);
+        uint16_t h10 = uint16_t(s10);
+        uint8_t b10 = uint8_t(s10);
+        V a = reg(ctx, ra), r;
+        bool handled = true;
+        switch (op >> 24) {
+            case 0x34:  // lqd
+                set(ctx, rt, load(ctx, a.w[0] + (u10 << 4)));
+                return StepResult::Continue;
+            case 0x24:  // stqd
+                store(ctx, a.w[0] + (u10 << 4), reg(ctx, rt));
+                return StepResult::Continue;
+            case 0x1C: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] + u10; break;               // ai
+            case 0x1D: for (int i = 0; i < 8; i++) set_h(r, i, uint16_t(get_h(a, i) + h10)); break;  // ahi
+            case 0x0C: for (int i = 0; i < 4; i++) r.w[i] = u10 - a.w[i]; break;               // sfi
+            case 0x0D: for (int i = 0; i < 8; i++) set_h(r, i, uint16_t(h10 - get_h(a, i))); break;  // sfhi
+            case 0x14: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] & u10; break;               // andi
+            case 0x15: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) & h10); break;      // andhi
+            case 0x16: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) & b10); break;     // andbi
+            case 0x04: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] | u10; break;               // ori
+            case 0x05: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) | h10); break;      // orhi
+            case 0x06: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) | b10); break;     // orbi
+            case 0x44: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] ^ u10; break;               // xori
+            case 0x45: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) ^ h10); break;      // xorhi
+            case 0x46: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) ^ b10); break;     // xorbi
+            case 0x7C: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] == u10 ? ~0u : 0; break;    // ceqi
+            case 0x7D: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) == h10 ? 0xFFFF : 0); break;
+            case 0x7E: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) == b10 ? 0xFF : 0); break;
+            case 0x4C: for (int i = 0; i < 4; i++) r.w[i] = int32_t(a.w[i]) > s10 ? ~0u : 0; break;  // cgti
+            case 0x4D: for (int i = 0; i < 8; i++) set_h(r, i, int16_t(get_h(a, i)) > int16_t(h10) ? 0xFFFF : 0); break;
+            case 0x4E: for (int i = 0; i < 16; i++) set_b(r, i, int8_t(get_b(a, i)) > int8_t(b10) ? 0xFF : 0); break;
+            case 0x5C: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] > u10 ? ~0u : 0; break;     // clgti
+            case 0x5D: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) > h10 ? 0xFFFF : 0); break;
+            case 0x5E: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) > b10 ? 0xFF : 0); break;
+            case 0x74:  // mpyi
+                for (int i = 0; i < 4; i++) r.w[i] = uint32_t(int32_t(int16_t(a.w[i])) * s10);
+                break;
+            case 0x75:  // mpyui
+                for (int i = 0; i < 4; i++) r.w[i] = (a.w[i] & 0xFFFF) * (u10 & 0xFFFF);
+                break;
+            case 0x7F:  // heqi
+                if (int32_t(a.w[0]) == s10) return fail("halt");
+                return StepResult::Continue;
+            case 0x4F:  // hgti
+                if (int32_t(a.w[0]) > s10) return fail("halt");
+                return StepResult::Continue;
+            case 0x5F:  // hlgti
+                if (a.w[0] > u10) return fail("halt");
+                return StepResult::Continue;
+            default: handled = false; break;
+        }
+        if (handled) {
+            set(ctx, rt, r);
+            return StepResult::Continue;
+        }
+    }
+
+    // RI16 form (9-bit opcode)
+    {
+        uint32_t i16 = (op >> 7) & 0xFFFF;
+        uint32_t s16 = uint32_t(sext(i16, 16));
+        uint32_t rel = pc + (s16 << 2);
+        uint32_t abs = s16 << 2;
+        V r;
+        switch (op >> 23) {
+            case 0x064: return branch(ctx, rel);                                    // br
+            case 0x060: return branch(ctx, abs);                                    // bra
+            case 0x066: case 0x062: {                                               // brsl, brasl
+                V link = {{(pc + 4) & LS_MASK_INSN, 0, 0, 0}};
+                set(ctx, rt, link);
+                return branch(ctx, (op >> 23) == 0x066 ? rel : abs);
+            }
+            case 0x040: if (reg(ctx, rt).w[0] == 0) return branch(ctx, rel); return StepResult::Control;   // brz
+            case 0x042: if (reg(ctx, rt).w[0] != 0) return branch(ctx, rel); return StepResult::Control;   // brnz
+            case 0x044: if ((reg(ctx, rt).w[0] & 0xFFFF) == 0) return branch(ctx, rel); return StepResult::Control;  // brhz
+            case 0x046: if ((reg(ctx, rt).w[0] & 0xFFFF) != 0) return branch(ctx, rel); return StepResult::Control;  // brhnz
+            case 0x061: set(ctx, rt, load(ctx, abs)); return StepResult::Continue;  // lqa
+            case 0x067: set(ctx, rt, load(ctx, rel)); return StepResult::Continue;  // lqr
+            case 0x041: store(ctx, abs, reg(ctx, rt)); return StepResult::Continue; // stqa
+            case 0x047: store(ctx, rel, reg(ctx, rt)); return StepResult::Continue; // stqr
+            case 0x081: for (auto& w : r.w) w = s16; set(ctx, rt, r); return StepResult::Continue;        // il
+            case 0x083: for (auto& w : r.w) w = i16 | (i16 << 16); set(ctx, rt, r); return StepResult::Continue;  // ilh
+            case 0x082: for (auto& w : r.w) w = i16 << 16; set(ctx, rt, r); return StepResult::Continue;  // ilhu
+            case 0x0C1:                                                                                   // iohl
+                r = reg(ctx, rt);
+                for (auto& w : r.w) w |= i16;
+                set(ctx, rt, r);
+                return StepResult::Continue;
+            case 0x065:                                                                                   // fsmbi
+                for (int i = 0; i < 16; i++) set_b(r, i, (i16 >> (15 - i)) & 1 ? 0xFF : 0);
+                set(ctx, rt, r);
+                return StepResult::Continue;
+            default: break;
+        }
+    }
+
+    // RI8 form (10-bit opcode): float/integer conversions
+    {
+        uint32_t i8 = (op >> 14) & 0xFF;
+        V a = reg(ctx, ra), r;
+        switch (op >> 22) {
+            case 0x1D8:  // cflts
+                for (int i = 0; i < 4; i++) {
+                    double x = std::ldexp(double(as_f(a.w[i])), 173 - int(i8));
+                    r.w[i] = x >= 2147483647.0 ? 0x7FFFFFFF : x <= -2147483648.0 ? 0x80000000u
+                           : std::isnan(x) ? 0 : uint32_t(int32_t(x));
+                }
+                set(ctx, rt, r);
+                return StepResult::Continue;
+            case 0x1D9:  // cfltu
+                for (int i = 0; i < 4; i++) {
+                    double x = std::ldexp(double(as_f(a.w[i])), 173 - int(i8));
+                    r.w[i] = x >= 4294967295.0 ? 0xFFFFFFFFu : (x <= 0.0 || std::isnan(x)) ? 0 : uint32_t(x);
+                }
+                set(ctx, rt, r);
+                return StepResult::Continue;
+            case 0x1DA:  // csflt
+                for (int i = 0; i < 4; i++) r.w[i] = from_f(float(std::ldexp(double(int32_t(a.w[i])), int(i8) - 155)));
+                set(ctx, rt, r);
+                return StepResult::Continue;
+            case 0x1DB:  // cuflt
+                for (int i = 0; i < 4; i++) r.w[i] = from_f(float(std::ldexp(double(a.w[i]), int(i8) - 155)));
+                set(ctx, rt, r);
+                return StepResult::Continue;
+            default: break;
+        }
+    }
+
+    return step_rr(ctx, op, op >> 21);
+}
+
+StepResult SpuReferenceInterpreter::step_rr(oc_spu_context_t* ctx, uint32_t op, uint32_t op11) {
+    uint32_t rt = op & 0x7F, ra = (op >> 7) & 0x7F, rb = (op >> 14) & 0x7F;
+    uint32_t i7 = rb;
+    int32_t s7 = sext(i7, 7);
+    V a = reg(ctx, ra), b = reg(ctx, rb), t = reg(ctx, rt), r = {};
+
+    switch (op11) {
+        // Control
+        case 0x000: case 0x140:  // stop, stopd
+            ctx->status = op & 0x3FFF;
+            ctx->pc -= 4;
+            return StepResult::Stopped;
+        case 0x001: case 0x002: case 0x003: case 0x201:  // lnop, sync, dsync, nop
+        case 0x1AC: case 0x10C: case 0x3BA:              // hbr, mtspr, fscrwr
+            return StepResult::Continue;
+        case 0x00C: case 0x398:                          // mfspr, fscrrd
+            set(ctx, rt, r);
+            return StepResult::Continue;
+        case 0x00D: return read_channel(ctx, ra, rt);    // rdch
+        case 0x10D: return write_channel(ctx, ra, t.w[0]);  // wrch
+        case 0x00F: {                                    // rchcnt
+            V c = {{channel_count(ra), 0, 0, 0}};
+            set(ctx, rt, c);
+            return StepResult::Continue;
+        }
+
+        // Branches
+        case 0x1A8: return branch(ctx, a.w[0]);          // bi
+        case 0x1A9: {                                    // bisl
+            V link = {{ctx->pc, 0, 0, 0}};
+            set(ctx, rt, link);
+            return branch(ctx, a.w[0]);
+        }
+        case 0x1AA: return branch(ctx, ctx->srr0);       // iret
+        case 0x128: if (t.w[0] == 0) return branch(ctx, a.w[0]); return StepResult::Control;  // biz
+        case 0x129: if (t.w[0] != 0) return branch(ctx, a.w[0]); return StepResult::Control;  // binz
+        case 0x12A: if ((t.w[0] & 0xFFFF) == 0) return branch(ctx, a.w[0]); return StepResult::Control;  // bihz
+        case 0x12B: if ((t.w[0] & 0xFFFF) != 0) return branch(ctx, a.w[0]); return StepResult::Control;  // bihnz
+        case 0x258: if (int32_t(a.w[0]) > int32_t(b.w[0])) return fail("halt"); return StepResult::Continue;  // hgt
+        case 0x2D8: if (a.w[0] > b.w[0]) return fail("halt"); return StepResult::Continue;  // hlgt
+        case 0x3D8: if (a.w[0] == b.w[0]) return fail("halt"); return StepResult::Continue;  // heq
+
+        // Memory
+        case 0x1C4: set(ctx, rt, load(ctx, a.w[0] + b.w[0])); return StepResult::Continue;   // lqx
+        case 0x144: store(ctx, a.w[0] + b.w[0], t); return StepResult::Continue;            // stqx
+
+        // Insertion controls
+        case 0x1F4: case 0x1F5: case 0x1F6: case 0x1F7:   // cbd, chd, cwd, cdd
+        case 0x1D4: case 0x1D5: case 0x1D6: case 0x1D7: { // cbx, chx, cwx, cdx
+            uint32_t addr = (op11 >= 0x1F4 ? a.w[0] + uint32_t(s7) : a.w[0] + b.w[0]) & 15;
+            r = {{0x10111213, 0x14151617, 0x18191A1B, 0x1C1D1E1F}};
+            switch (op11 & 3) {
+                case 0: set_b(r, addr, 0x03); break;
+                case 1: set_h(r, (addr >> 1) & 7, 0x0203); break;
+                case 2: r.w[(addr >> 2) & 3] = 0x00010203; break;
+                default: set_dw(r, (addr >> 3) & 1, 0x0001020304050607ULL); break;
+            }
+            break;
+        }
+
+        // Integer arithmetic
+        case 0x0C0: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] + b.w[i]; break;           // a
+        case 0x040: for (int i = 0; i < 4; i++) r.w[i] = b.w[i] - a.w[i]; break;           // sf
+        case 0x0C8: for (int i = 0; i < 8; i++) set_h(r, i, uint16_t(get_h(a, i) + get_h(b, i))); break;  // ah
+        case 0x048: for (int i = 0; i < 8; i++) set_h(r, i, uint16_t(get_h(b, i) - get_h(a, i))); break;  // sfh
+        case 0x0C2: for (int i = 0; i < 4; i++) r.w[i] = (uint64_t(a.w[i]) + b.w[i]) >> 32; break;        // cg
+        case 0x042: for (int i = 0; i < 4; i++) r.w[i] = b.w[i] >= a.w[i] ? 1 : 0; break;  // bg
+        case 0x340: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] + b.w[i] + (t.w[i] & 1); break;         // addx
+        case 0x341: for (int i = 0; i < 4; i++) r.w[i] = b.w[i] - a.w[i] - (~t.w[i] & 1); break;        // sfx
+        case 0x342: for (int i = 0; i < 4; i++) r.w[i] = (uint64_t(a.w[i]) + b.w[i] + (t.w[i] & 1)) >> 32; break;  // cgx
+        case 0x343: for (int i = 0; i < 4; i++) r.w[i] = (t.w[i] & 1) ? b.w[i] >= a.w[i] : b.w[i] > a.w[i]; break; // bgx
+        case 0x3C4: for (int i = 0; i < 4; i++) r.w[i] = uint32_t(int32_t(int16_t(a.w[i])) * int16_t(b.w[i])); break;   // mpy
+        case 0x3CC: for (int i = 0; i < 4; i++) r.w[i] = (a.w[i] & 0xFFFF) * (b.w[i] & 0xFFFF); break;                  // mpyu
+        case 0x3C5: for (int i = 0; i < 4; i++) r.w[i] = ((a.w[i] >> 16) * (b.w[i] & 0xFFFF)) << 16; break;             // mpyh
+        case 0x3C7: for (int i = 0; i < 4; i++) r.w[i] = uint32_t((int32_t(int16_t(a.w[i])) * int16_t(b.w[i])) >> 16); break;  // mpys
+        case 0x3C6: for (int i = 0; i < 4; i++) r.w[i] = uint32_t(int32_t(int16_t(a.w[i] >> 16)) * int16_t(b.w[i] >> 16)); break;  // mpyhh
+        case 0x3CE: for (int i = 0; i < 4; i++) r.w[i] = (a.w[i] >> 16) * (b.w[i] >> 16); break;                         // mpyhhu
+        case 0x346: for (int i = 0; i < 4; i++) r.w[i] = t.w[i] + uint32_t(int32_t(int16_t(a.w[i] >> 16)) * int16_t(b.w[i] >> 16)); break;  // mpyhha
+        case 0x34E: for (int i = 0; i < 4; i++) r.w[i] = t.w[i] + (a.w[i] >> 16) * (b.w[i] >> 16); break;                // mpyhhau
+        case 0x2A5: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] ? __builtin_clz(a.w[i]) : 32; break;                     // clz
+        case 0x2B4: for (int i = 0; i < 16; i++) set_b(r, i, uint8_t(__builtin_popcount(get_b(a, i)))); break;         // cntb
+        case 0x2B6: for (int i = 0; i < 8; i++) set_h(r, i, uint16_t(int16_t(int8_t(get_h(a, i))))); break;             // xsbh
+        case 0x2AE: for (int i = 0; i < 4; i++) r.w[i] = uint32_t(int32_t(int16_t(a.w[i]))); break;                     // xshw
+        case 0x2A6: for (int i = 0; i < 2; i++) set_dw(r, i, uint64_t(int64_t(int32_t(a.w[i * 2 + 1])))); break;        // xswd
+        case 0x0D3: for (int i = 0; i < 16; i++) set_b(r, i, uint8_t((get_b(a, i) + get_b(b, i) + 1) >> 1)); break;     // avgb
+        case 0x053: for (int i = 0; i < 16; i++) set_b(r, i, uint8_t(std::abs(int(get_b(a, i)) - int(get_b(b, i))))); break;  // absdb
+        case 0x253:  // sumb
+            for (int i = 0; i < 4; i++) {
+                uint32_t sb = 0, sa = 0;
+                for (int j = 0; j < 4; j++) { sb += get_b(b, i * 4 + j); sa += get_b(a, i * 4 + j); }
+                r.w[i] = (sb << 16) | sa;
+            }
+            break;
+
+        // Logical
+        case 0x0C1: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] & b.w[i]; break;     // and
+        case 0x041: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] | b.w[i]; break;     // or
+        case 0x241: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] ^ b.w[i]; break;     // xor
+        case 0x0C9: for (int i = 0; i < 4; i++) r.w[i] = ~(a.w[i] & b.w[i]); break;  // nand
+        case 0x049: for (int i = 0; i < 4; i++) r.w[i] = ~(a.w[i] | b.w[i]); break;  // nor
+        case 0x2C1: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] & ~b.w[i]; break;    // andc
+        case 0x2C9: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] | ~b.w[i]; break;    // orc
+        case 0x249: for (int i = 0; i < 4; i++) r.w[i] = ~(a.w[i] ^ b.w[i]); break;  // eqv
+        case 0x1F0: r.w[0] = a.w[0] | a.w[1] | a.w[2] | a.w[3]; break;               // orx
+
+        // Compares
+        case 0x3C0: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] == b.w[i] ? ~0u : 0; break;  // ceq
+        case 0x3C8: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) == get_h(b, i) ? 0xFFFF : 0); break;
+        case 0x3D0: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) == get_b(b, i) ? 0xFF : 0); break;
+        case 0x240: for (int i = 0; i < 4; i++) r.w[i] = int32_t(a.w[i]) > int32_t(b.w[i]) ? ~0u : 0; break;  // cgt
+        case 0x248: for (int i = 0; i < 8; i++) set_h(r, i, int16_t(get_h(a, i)) > int16_t(get_h(b, i)) ? 0xFFFF : 0); break;
+        case 0x250: for (int i = 0; i < 16; i++) set_b(r, i, int8_t(get_b(a, i)) > int8_t(get_b(b, i)) ? 0xFF : 0); break;
+        case 0x2C0: for (int i = 0; i < 4; i++) r.w[i] = a.w[i] > b.w[i] ? ~0u : 0; break;    // clgt
+        case 0x2C8: for (int i = 0; i < 8; i++) set_h(r, i, get_h(a, i) > get_h(b, i) ? 0xFFFF : 0); break;
+        case 0x2D0: for (int i = 0; i < 16; i++) set_b(r, i, get_b(a, i) > get_b(b, i) ? 0xFF : 0); break;
+
+        // Gather / form select mask
+        case 0x1B0: for (int i = 0; i < 4; i++) r.w[0] |= (a.w[i] & 1) << (3 - i); break;             // gb
+        case 0x1B1: for (int i = 0; i < 8; i++) r.w[0] |= (get_h(a, i) & 1u) << (7 - i); break;       // gbh
+        case 0x1B2: for (int i = 0; i < 16; i++) r.w[0] |= (get_b(a, i) & 1u) << (15 - i); break;     // gbb
+        case 0x1B4: for (int i = 0; i < 4; i++) r.w[i] = (a.w[0] >> (3 - i)) & 1 ? ~0u : 0; break;     // fsm
+        case 0x1B5: for (int i = 0; i < 8; i++) set_h(r, i, (a.w[0] >> (7 - i)) & 1 ? 0xFFFF : 0); break;  // fsmh
+        case 0x1B6: for (int i = 0; i < 16; i++) set_b(r, i, (a.w[0] >> (15 - i)) & 1 ? 0xFF : 0); break;  // fsmb
+
+        // Element shifts and rotates
+        case 0x05B: for (int i = 0; i < 4; i++) { uint32_t n = b.w[i] & 0x3F; r.w[i] = n > 31 ? 0 : a.w[i] << n; } break;  // shl
+        case 0x05F: for (int i = 0; i < 8; i++) { uint32_t n = get_h(b, i) & 0x1F; set_h(r, i, n > 15 ? 0 : uint16_t(get_h(a, i) << n)); } break;  // shlh
+        case 0x07B: for (int i = 0; i < 4; i++) { uint32_t n = i7 & 0x3F; r.w[i] = n > 31 ? 0 : a.w[i] << n; } break;  // shli
+        case 0x07F: for (int i = 0; i < 8; i++) { uint32_t n = i7 & 0x1F; set_h(r, i, n > 15 ? 0 : uint16_t(get_h(a, i) << n)); } break;  // shlhi
+        case 0x058: for (int i = 0; i < 4; i++) r.w[i] = rotl32(a.w[i], b.w[i]); break;              // rot
+        case 0x05C: for (int i = 0; i < 8; i++) set_h(r, i, rotl16(get_h(a, i), get_h(b, i))); break;  // roth
+        case 0x078: for (int i = 0; i < 4; i++) r.w[i] = rotl32(a.w[i], i7); break;                  // roti
+        case 0x07C: for (int i = 0; i < 8; i++) set_h(r, i, rotl16(get_h(a, i), i7)); break;         // rothi
+        case 0x059: case 0x079:  // rotm, rotmi
+            for (int i = 0; i < 4; i++) {
+                uint32_t n = (0 - (op11 == 0x059 ? b.w[i] : i7)) & 0x3F;
+                r.w[i] = n > 31 ? 0 : a.w[i] >> n;
+            }
+            break;
+        case 0x05D: case 0x07D:  // rothm, rothmi
+            for (int i = 0; i < 8; i++) {
+                uint32_t n = (0 - (op11 == 0x05D ? get_h(b, i) : i7)) & 0x1F;
+                set_h(r, i, n > 15 ? 0 : uint16_t(get_h(a, i) >> n));
+            }
+            break;
+        case 0x05A: case 0x07A:  // rotma, rotmai
+            for (int i = 0; i < 4; i++) {
+                uint32_t n = (0 - (op11 == 0x05A ? b.w[i] : i7)) & 0x3F;
+                r.w[i] = uint32_t(int32_t(a.w[i]) >> (n > 31 ? 31 : n));
+            }
+            break;
+        case 0x05E: case 0x07E:  // rotmah, rotmahi
+            for (int i = 0; i < 8; i++) {
+                uint32_t n = (0 - (op11 == 0x05E ? get_h(b, i) : i7)) & 0x1F;
+                set_h(r, i, uint16_t(int16_t(get_h(a, i)) >> (n > 15 ? 15 : n)));
+            }
+            break;
+
+        // Quadword shifts and rotates
+        case 0x1DB: r = qw_shl_bits(a, b.w[0] & 7); break;                   // shlqbi
+        case 0x1FB: r = qw_shl_bits(a, i7 & 7); break;                       // shlqbii
+        case 0x1DF: r = qw_shl_bytes(a, b.w[0] & 0x1F); break;               // shlqby
+        case 0x1FF: r = qw_shl_bytes(a, i7 & 0x1F); break;                   // shlqbyi
+        case 0x1CF: r = qw_shl_bytes(a, (b.w[0] >> 3) & 0x1F); break;        // shlqbybi
+        case 0x1D8: r = qw_rotl_bits(a, b.w[0] & 7); break;                  // rotqbi
+        case 0x1F8: r = qw_rotl_bits(a, i7 & 7); break;                      // rotqbii
+        case 0x1DC: r = qw_rotl_bytes(a, b.w[0] & 15); break;                // rotqby
+        case 0x1FC: r = qw_rotl_bytes(a, i7 & 15); break;                    // rotqbyi
+        case 0x1CC: r = qw_rotl_bytes(a, (b.w[0] >> 3) & 15); break;         // rotqbybi
+        case 0x1D9: r = qw_shr_bits(a, (0 - b.w[0]) & 7); break;             // rotqmbi
+        case 0x1F9: r = qw_shr_bits(a, (0 - i7) & 7); break;                 // rotqmbii
+        case 0x1DD: r = qw_shr_bytes(a, (0 - b.w[0]) & 0x1F); break;         // rotqmby
+        case 0x1FD: r = qw_shr_bytes(a, (0 - i7) & 0x1F); break;             // rotqmbyi
+        case 0x1CD: r = qw_shr_bytes(a, (0 - (b.w[0] >> 3)) & 0x1F); break;  // rotqmbybi
+
+        // Single precision
+        case 0x2C4: for (int i = 0; i < 4; i++) r.w[i] = from_f(as_f(a.w[i]) + as_f(b.w[i])); break;  // fa
+        case 0x2C5: for (int i = 0; i < 4; i++) r.w[i] = from_f(as_f(a.w[i]) - as_f(b.w[i])); break;  // fs
+        case 0x2C6: for (int i = 0; i < 4; i++) r.w[i] = from_f(as_f(a.w[i]) * as_f(b.w[i])); break;  // fm
+        case 0x3C2: for (int i = 0; i < 4; i++) r.w[i] = as_f(a.w[i]) == as_f(b.w[i]) ? ~0u : 0; break;  // fceq
+        case 0x2C2: for (int i = 0; i < 4; i++) r.w[i] = as_f(a.w[i]) > as_f(b.w[i]) ? ~0u : 0; break;   // fcgt
+        case 0x3CA: for (int i = 0; i < 4; i++) r.w[i] = std::fabs(as_f(a.w[i])) == std::fabs(as_f(b.w[i])) ? ~0u : 0; break;  // fcmeq
+        case 0x2CA: for (int i = 0; i < 4; i++) r.w[i] = std::fabs(as_f(a.w[i])) > std::fabs(as_f(b.w[i])) ? ~0u : 0; break;   // fcmgt
+        // Estimates are exact here and fi passes them through, so results
+        // are deterministic rather than bit-identical to hardware
+        case 0x1B8: for (int i = 0; i < 4; i++) r.w[i] = from_f(1.0f / as_f(a.w[i])); break;                     // frest
+        case 0x1B9: for (int i = 0; i < 4; i++) r.w[i] = from_f(1.0f / std::sqrt(std::fabs(as_f(a.w[i])))); break;  // frsqest
+        case 0x3D4: r = b; break;                                                                                // fi
+
+        // Double precision
+        case 0x2CC: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(as_d(get_dw(a, i)) + as_d(get_dw(b, i)))); break;  // dfa
+        case 0x2CD: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(as_d(get_dw(a, i)) - as_d(get_dw(b, i)))); break;  // dfs
+        case 0x2CE: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(as_d(get_dw(a, i)) * as_d(get_dw(b, i)))); break;  // dfm
+        case 0x35C: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(as_d(get_dw(a, i)) * as_d(get_dw(b, i)) + as_d(get_dw(t, i)))); break;     // dfma
+        case 0x35D: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(as_d(get_dw(a, i)) * as_d(get_dw(b, i)) - as_d(get_dw(t, i)))); break;     // dfms
+        case 0x35E: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(as_d(get_dw(t, i)) - as_d(get_dw(a, i)) * as_d(get_dw(b, i)))); break;     // dfnms
+        case 0x35F: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(-(as_d(get_dw(a, i)) * as_d(get_dw(b, i)) + as_d(get_dw(t, i))))); break;  // dfnma
+        case 0x3B8: for (int i = 0; i < 2; i++) set_dw(r, i, from_d(double(as_f(a.w[i * 2])))); break;                     // fesd
+        case 0x3B9: for (int i = 0; i < 2; i++) r.w[i * 2] = from_f(float(as_d(get_dw(a, i)))); break;                     // frds
+
+        default:
+            return fail("unimplemented instruction");
+    }
+    set(ctx, rt, r);
+    return StepResult::Continue;
+}
+
+// ============================================================================
+// Executors
+// ============================================================================
+
+struct RunResult {
+    uint64_t instructions = 0;
+    uint64_t jit_blocks = 0;
+    uint64_t fallback_blocks = 0;
+    bool stopped = false;
+    const char* error = nullptr;
+};
+
+static RunResult run_interpreter(SpuReferenceInterpreter& interp, oc_spu_context_t* ctx,
+                                 uint64_t max_instructions) {
+    RunResult result;
+    while (result.instructions < max_instructions) {
+        StepResult s = interp.step(ctx);
+        result.instructions++;
+        if (s == StepResult::Stopped) {
+            result.stopped = true;
+            return result;
+        }
+        if (s == StepResult::Error) {
+            result.error = interp.error;
+            return result;
+        }
+    }
+    result.error = "instruction limit reached";
+    return result;
+}
+
+static RunResult run_jit(oc_spu_jit_t* jit, SpuReferenceInterpreter& interp,
+                         oc_spu_context_t* ctx, uint64_t max_instructions) {
+    RunResult result;
+    const uint8_t* ls = static_cast<const uint8_t*>(ctx->local_storage);
+    while (result.instructions < max_instructions) {
+        uint32_t pc = ctx->pc & LS_MASK_INSN;
+        oc_spu_jit_compile(jit, pc, ls + pc, SPU_LS_SIZE - pc);
+        int n = oc_spu_jit_execute(jit, ctx, pc);
+        if (n > 0 && ctx->exit_reason != OC_SPU_EXIT_ERROR) {
+            result.jit_blocks++;
+            result.instructions += uint64_t(n);
+            if (ctx->exit_reason == OC_SPU_EXIT_STOP) {
+                result.stopped = true;
+                return result;
+            }
+            continue;
+        }
+
+        // No native code for this block: interpret to the next control transfer
+        ctx->pc = pc;
+        result.fallback_blocks++;
+        for (;;) {
+            StepResult s = interp.step(ctx);
+            result.instructions++;
+            if (s == StepResult::Stopped) {
+                result.stopped = true;
+                return result;
+            }
+            if (s == StepResult::Error) {
+                result.error = interp.error;
+                return result;
+            }
+            if (s == StepResult::Control || result.instructions >= max_instructions) break;
+        }
+    }
+    result.error = "instruction limit reached";
+    return result;
+}
+
+// ============================================================================
+// Synthetic capture
+// ============================================================================
+
+// Instruction encoders for the synthetic kernel
+static uint32_t enc_ri16(uint32_t op9, uint32_t i16, uint32_t rt) { return (op9 << 23) | ((i16 & 0xFFFF) << 7) | rt; }
+static uint32_t enc_ri10(uint32_t op8, int32_t i10, uint32_t ra, uint32_t rt) { return (op8 << 24) | ((uint32_t(i10) & 0x3FF) << 14) | (ra << 7) | rt; }
+static uint32_t enc_rr(uint32_t op11, uint32_t rb, uint32_t ra, uint32_t rt) { return (op11 << 21) | (rb << 14) | (ra << 7) | rt; }
+
+/**
+ * Kernel: GET 4KB from EA 0x10000 to LS 0x10000, add 3 to every word,
+ * PUT it to EA 0x20000, stop.
+ */
+static std::vector<uint32_t> synthetic_kernel() {
+    std::vector<uint32_t> code;
+    auto wrch = [&](uint32_t ch, uint32_t r) { code.push_back(enc_rr(0x10D, 0, ch, r)); };
+    auto il = [&](uint32_t r, uint32_t v) { code.push_back(enc_ri16(0x081, v, r)); };
+    auto ilhu_iohl = [&](uint32_t r, uint32_t v) {
+        code.push_back(enc_ri16(0x082, v >> 16, r));
+        code.push_back(enc_ri16(0x0C1, v & 0xFFFF, r));
+    };
+    auto dma = [&](uint32_t lsa, uint32_t ea, uint32_t size, uint32_t cmd) {
+        ilhu_iohl(3, lsa); wrch(OC_SPU_CH_MFC_LSA, 3);
+        il(3, 0); wrch(OC_SPU_CH_MFC_EAH, 3);
+        ilhu_iohl(3, ea); wrch(OC_SPU_CH_MFC_EAL, 3);
+        il(3, size); wrch(OC_SPU_CH_MFC_SIZE, 3);
+        il(3, 5); wrch(OC_SPU_CH_MFC_TAG_ID, 3);
+        il(3, cmd); wrch(OC_SPU_CH_MFC_CMD, 3);
+        il(3, 1 << 5); wrch(OC_SPU_CH_WR_TAG_MASK, 3);
+        il(3, 2); wrch(OC_SPU_CH_WR_TAG_UPDATE, 3);
+        code.push_back(enc_rr(0x00D, 0, OC_SPU_CH_RD_TAG_STAT, 4));  // rdch r4, MFC_RdTagStat
+    };
+
+    dma(0x10000, 0x10000, 0x1000, 0x40);
+    ilhu_iohl(5, 0x10000);                            // r5 = pointer
+    il(6, 0x1000 / 16);                               // r6 = quadword count
+    il(7, 3);                                         // r7 = increment
+    size_t loop = code.size();
+    code.push_back(enc_ri10(0x34, 0, 5, 8));          // lqd r8, 0(r5)
+    code.push_back(enc_rr(0x0C0, 7, 8, 8));           // a r8, r8, r7
+    code.push_back(enc_ri10(0x24, 0, 5, 8));          // stqd r8, 0(r5)
+    code.push_back(enc_ri10(0x1C, 16, 5, 5));         // ai r5, r5, 16
+    code.push_back(enc_ri10(0x1C, -1, 6, 6));         // ai r6, r6, -1
+    int32_t back = int32_t(loop) - int32_t(code.size());
+    code.push_back(enc_ri16(0x042, uint32_t(back), 6));  // brnz r6, loop
+    dma(0x10000, 0x20000, 0x1000, 0x20);
+    code.push_back(0x00000000);                       // stop
+    return code;
+}
+
+static int make_synthetic(const char* path) {
+    std::vector<uint8_t> ls(SPU_LS_SIZE, 0);
+    std::vector<uint8_t> memory(0x40000, 0);
+    for (uint32_t i = 0; i < 0x1000; i++) memory[0x10000 + i] = uint8_t(i * 7);
+
+    std::vector<uint32_t> code = synthetic_kernel();
+    for (size_t i = 0; i < code.size(); i++) {
+        for (int j = 0; j < 4; j++) ls[i * 4 + j] = uint8_t(code[i] >> (24 - 8 * j));
+    }
+
+    oc_spu_context_t ctx;
+    std::memset(&ctx, 0, sizeof(ctx));
+    ctx.local_storage = ls.data();
+    ctx.local_storage_size = SPU_LS_SIZE;
+
+    if (oc_spu_capture_begin(path, &ctx) != 0) {
+        std::fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+    MemorySink sink(memory.data());
+    SpuReferenceInterpreter interp;
+    interp.dma = &sink;
+    RunResult run = run_interpreter(interp, &ctx, 1000000);
+    if (!run.stopped) {
+        oc_spu_capture_abort();
+        std::fprintf(stderr, "synthetic kernel failed: %s\n", run.error);
+        return 1;
+    }
+    int64_t records = oc_spu_capture_end(&ctx);
+    std::printf("%s: %llu instructions, %lld transfers\n", path,
+                static_cast<unsigned long long>(run.instructions), static_cast<long long>(records));
+    return records == 2 ? 0 : 1;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static void usage() {
+    std::fprintf(stderr,
+        "usage: spu_replay_bench [--exec interp|jit] [--iterations N] [--max-instructions N] capture...\n"
+        "       spu_replay_bench --make-synthetic PATH\n");
+}
+
+int main(int argc, char** argv) {
+    std::string exec = "interp";
+    uint64_t iterations = 10;
+    uint64_t max_instructions = 100000000;
+    std::vector<const char*> captures;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--exec" && has_value) exec = argv[++i];
+        else if (arg == "--iterations" && has_value) iterations = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--max-instructions" && has_value) max_instructions = std::strtoull(argv[++i], nullptr, 0);
+        else if (arg == "--make-synthetic" && has_value) return make_synthetic(argv[++i]);
+        else if (!arg.empty() && arg[0] == '-') { usage(); return 2; }
+        else captures.push_back(argv[i]);
+    }
+    if (captures.empty() || iterations == 0 || (exec != "interp" && exec != "jit")) {
+        usage();
+        return 2;
+    }
+
+    std::vector<uint8_t> ls(SPU_LS_SIZE);
+    oc_spu_jit_t* jit = exec == "jit" ? oc_spu_jit_create() : nullptr;
+    int failures = 0;
+
+    for (const char* path : captures) {
+        oc_spu_replay_t* replay = oc_spu_replay_open(path);
+        if (!replay) {
+            std::printf("%s: cannot load capture\n", path);
+            failures++;
+            continue;
+        }
+        oc_spu_replay_info_t info;
+        oc_spu_replay_get_info(replay, &info);
+
+        ReplaySink sink(replay);
+        SpuReferenceInterpreter interp;
+        interp.dma = &sink;
+        oc_spu_context_t ctx;
+
+        uint64_t instructions = 0, jit_blocks = 0, fallback_blocks = 0;
+        int verify = 0;
+        const char* error = nullptr;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t it = 0; it < iterations && !error && verify == 0; it++) {
+            std::memset(&ctx, 0, sizeof(ctx));
+            ctx.local_storage = ls.data();
+            oc_spu_replay_reset(replay, &ctx);
+            interp.tag_mask = ctx.mfc_tag_mask;
+            RunResult run = jit ? run_jit(jit, interp, &ctx, max_instructions)
+                                : run_interpreter(interp, &ctx, max_instructions);
+            instructions += run.instructions;
+            jit_blocks += run.jit_blocks;
+            fallback_blocks += run.fallback_blocks;
+            error = run.error;
+            verify = oc_spu_replay_verify(replay, &ctx);
+            if (jit) oc_spu_jit_clear_cache(jit);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds <= 0) seconds = 1e-9;
+
+        double mb = double(info.get_bytes + info.put_bytes) * double(iterations) / (1024.0 * 1024.0);
+        std::printf("%s: spu%u entry 0x%05x, %u GETs / %u PUTs\n", path, info.spu_id, info.entry_pc,
+                    info.gets, info.puts);
+        std::printf("  %s x%llu: %.3f s, %.2f MIPS, %.1f jobs/s, %.1f MB/s DMA",
+                    exec.c_str(), static_cast<unsigned long long>(iterations), seconds,
+                    double(instructions) / seconds / 1e6, double(iterations) / seconds, mb / seconds);
+        if (jit) {
+            std::printf(", %llu native / %llu interpreted blocks",
+                        static_cast<unsigned long long>(jit_blocks),
+                        static_cast<unsigned long long>(fallback_blocks));
+        }
+        std::printf("\n");
+        if (error || verify != 0) {
+            std::printf("  FAILED: %s (verify 0x%x, pc 0x%05x)\n", error ? error : "end state differs",
+                        verify, ctx.pc);
+            failures++;
+        } else {
+            std::printf("  verified\n");
+        }
+        oc_spu_replay_close(replay);
+    }
+
+    if (jit) oc_spu_jit_destroy(jit);
+    return failures ? 1 : 0;
+}
@@ -155,6 +155,8 @@ pub struct PathConfig {
     pub dev_flash: PathBuf,
     pub save_data: PathBuf,
     pub shader_cache: PathBuf,
+    /// PPU JIT warm start profiles, one per title
+    pub ppu_cache: PathBuf,
     pub firmware: PathBuf,
 }
 
@@ -280,6 +282,7 @@ impl Default for PathConfig {
             dev_flash: base.join("dev_flash"),
             save_data: base.join("savedata"),
             shader_cache: base.join("cache/shaders"),
+            ppu_cache: base.join("cache/ppu"),
             firmware: base.join("firmware"),
         }
     }
@@ -227,6 +227,14 @@ impl Scheduler {
         }
     }
 
+    /// Remaining time slice of the current thread in microseconds (0 if no
+    /// thread is running)
+    pub fn remaining_time_slice(&self) -> u64 {
+        self.current
+            .and_then(|id| self.threads.get(&id))
+            .map_or(0, |thread| thread.time_slice_us)
+    }
+
     /// Check if current thread's time slice has expired
     pub fn time_slice_expired(&self) -> bool {
         if let Some(current_id) = self.current {
@@ -493,13 +501,17 @@ mod tests {
         let mut scheduler = Scheduler::new();
         
         scheduler.add_thread(ThreadId::Ppu(1), 100);
+        assert_eq!(scheduler.remaining_time_slice(), 0);
         scheduler.schedule();
+        assert_eq!(scheduler.remaining_time_slice(), 1000);
         
         scheduler.update_time_slice(500);
         assert!(!scheduler.time_slice_expired());
+        assert_eq!(scheduler.remaining_time_slice(), 500);
         
         scheduler.update_time_slice(600);
         assert!(scheduler.time_slice_expired());
+        assert_eq!(scheduler.remaining_time_slice(), 0);
     }
 
     #[test]
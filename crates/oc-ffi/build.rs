@@ -33,7 +33,14 @@ fn main() {
         .file(cpp_src.join("ppu_jit.cpp"))
         .file(cpp_src.join("spu_jit.cpp"))
         .file(cpp_src.join("atomics.cpp"))
-        .file(cpp_src.join("dma.cpp"));
+        .file(cpp_src.join("dma.cpp"))
+        .file(cpp_src.join("spu_ls.cpp"))
+        .file(cpp_src.join("mem_tracker.cpp"))
+        .file(cpp_src.join("mem_budget.cpp"))
+        .file(cpp_src.join("compile_server.cpp"))
+        .file(cpp_src.join("spu_capture.cpp"))
+        .file(cpp_src.join("vpost.cpp"))
+        .file(cpp_src.join("disc_io.cpp"));
     
     // Platform-specific settings
     let target_arch = env::var("CARGO_CFG_TARGET_ARCH")
@@ -0,0 +1,128 @@
+//! Out-of-process compile server interface
+//!
+//! Safe Rust wrappers for starting and stopping the `oc_compile_server`
+//! helper process. While it runs, PPU JITs and RSX shader compilers with
+//! remote compilation enabled compile in the helper and link the returned
+//! objects in-process, keeping LLVM's allocations out of the emulator heap.
+//! Linux only.
+
+use std::ffi::CString;
+use std::path::Path;
+
+/// Compile server statistics
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct CompileServerStats {
+    pub requests: u64,
+    pub completed: u64,
+    /// Requests the server could not compile
+    pub failed: u64,
+    /// Requests lost because the server died or timed out
+    pub lost: u64,
+    pub request_bytes: u64,
+    pub response_bytes: u64,
+    /// Time spent compiling in the server
+    pub compile_ns: u64,
+    /// Submit to result, including queueing
+    pub round_trip_ns: u64,
+    /// 0 if not running
+    pub server_pid: u32,
+    pub server_threads: u32,
+}
+
+extern "C" {
+    fn oc_compile_server_start(server_path: *const std::os::raw::c_char, threads: u32) -> i32;
+    fn oc_compile_server_stop();
+    fn oc_compile_server_is_running() -> i32;
+    fn oc_compile_server_get_stats(stats: *mut CompileServerStats);
+    fn oc_compile_server_reset_stats();
+}
+
+/// Compile server error codes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum CompileServerError {
+    /// Invalid server path
+    InvalidArguments,
+    /// A server is already running
+    AlreadyRunning,
+    /// Not supported on this host
+    Unsupported,
+    /// Shared memory could not be created
+    SharedMemory,
+    /// The server process failed to start
+    StartFailed,
+    /// Unknown error
+    Unknown(i32),
+}
+
+impl std::fmt::Display for CompileServerError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            CompileServerError::InvalidArguments => write!(f, "Invalid compile server path"),
+            CompileServerError::AlreadyRunning => write!(f, "Compile server already running"),
+            CompileServerError::Unsupported => write!(f, "Compile server not supported on this host"),
+            CompileServerError::SharedMemory => write!(f, "Compile server shared memory error"),
+            CompileServerError::StartFailed => write!(f, "Compile server failed to start"),
+            CompileServerError::Unknown(code) => write!(f, "Unknown compile server error: {}", code),
+        }
+    }
+}
+
+impl std::error::Error for CompileServerError {}
+
+/// Spawn the compile server executable with `threads` compile threads
+/// (0 = one per host core, at most 8)
+pub fn start(server_path: &Path, threads: u32) -> Result<(), CompileServerError> {
+    let path = CString::new(server_path.to_string_lossy().into_owned())
+        .map_err(|_| CompileServerError::InvalidArguments)?;
+    match unsafe { oc_compile_server_start(path.as_ptr(), threads) } {
+        0 => Ok(()),
+        -1 => Err(CompileServerError::InvalidArguments),
+        -2 => Err(CompileServerError::AlreadyRunning),
+        -3 => Err(CompileServerError::Unsupported),
+        -4 => Err(CompileServerError::SharedMemory),
+        -5 => Err(CompileServerError::StartFailed),
+        other => Err(CompileServerError::Unknown(other)),
+    }
+}
+
+/// Stop the compile server, waiting for compiles in flight
+pub fn stop() {
+    unsafe { oc_compile_server_stop() }
+}
+
+/// Check if a compile server is running and has not been lost
+pub fn is_running() -> bool {
+    unsafe { oc_compile_server_is_running() != 0 }
+}
+
+/// Get compile server statistics
+pub fn stats() -> CompileServerStats {
+    let mut stats = CompileServerStats::default();
+    unsafe { oc_compile_server_get_stats(&mut stats) };
+    stats
+}
+
+/// Reset compile server statistics
+pub fn reset_stats() {
+    unsafe { oc_compile_server_reset_stats() }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_compile_server_start_failure() {
+        let missing = std::env::temp_dir().join("oc_compile_server_missing");
+        let result = start(&missing, 1);
+        if cfg!(target_os = "linux") {
+            assert_eq!(result, Err(CompileServerError::StartFailed));
+        } else {
+            assert_eq!(result, Err(CompileServerError::Unsupported));
+        }
+        assert!(!is_running());
+        assert_eq!(stats().server_pid, 0);
+        stop();
+    }
+}
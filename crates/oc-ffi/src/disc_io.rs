@@ -0,0 +1,394 @@
+//! Disc and package image I/O
+//!
+//! Safe Rust wrappers for the native image reader: reads go through a
+//! shared cache of sector-aligned 64KB blocks, loaded by io_uring on Linux
+//! (or a pool of I/O threads elsewhere), with read-ahead for files being
+//! read sequentially and optional in-place AES-128-CTR decryption of PKG
+//! content.
+
+use std::ffi::CString;
+use std::io::{self, Read, Seek, SeekFrom};
+use std::path::Path;
+
+#[repr(C)]
+struct DiscFileHandle {
+    _private: [u8; 0],
+}
+
+#[repr(C)]
+struct RawIoVec {
+    offset: u64,
+    buffer: *mut u8,
+    size: u32,
+    result: i64,
+}
+
+/// Disc I/O statistics (all files)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct DiscIoStats {
+    pub reads: u64,
+    pub bytes_read: u64,
+    /// Blocks found loaded or in flight
+    pub cache_hits: u64,
+    /// Blocks a read had to load
+    pub cache_misses: u64,
+    /// Blocks loaded by read-ahead and prefetch
+    pub readahead_blocks: u64,
+    /// Of those, blocks a read later used
+    pub readahead_hits: u64,
+    /// Batches handed to the backend
+    pub submissions: u64,
+    pub decrypted_bytes: u64,
+    pub errors: u64,
+    /// Time reads spent waiting for blocks
+    pub wait_ns: u64,
+    pub cached_bytes: u64,
+    /// Backend in use (as [`DiscIoBackend`])
+    pub backend: i32,
+}
+
+extern "C" {
+    fn oc_disc_io_set_backend(backend: i32) -> i32;
+    fn oc_disc_io_get_backend() -> i32;
+    fn oc_disc_io_set_cache_size(bytes: u64);
+    fn oc_disc_file_open(path: *const libc::c_char) -> *mut DiscFileHandle;
+    fn oc_disc_file_close(file: *mut DiscFileHandle);
+    fn oc_disc_file_get_size(file: *mut DiscFileHandle) -> u64;
+    fn oc_disc_file_set_decrypt(
+        file: *mut DiscFileHandle, offset: u64, size: u64, key: *const u8, iv: *const u8,
+    ) -> i32;
+    fn oc_disc_file_read(file: *mut DiscFileHandle, offset: u64, buffer: *mut u8, size: u64) -> i64;
+    fn oc_disc_file_read_batch(file: *mut DiscFileHandle, vecs: *mut RawIoVec, count: usize) -> i32;
+    fn oc_disc_file_prefetch(file: *mut DiscFileHandle, offset: u64, size: u64) -> i32;
+    fn oc_disc_io_get_stats(stats: *mut DiscIoStats);
+    fn oc_disc_io_reset_stats();
+}
+
+/// Sector size of disc images
+pub const DISC_SECTOR_SIZE: u64 = 2048;
+
+/// Size of a cache block
+pub const DISC_BLOCK_SIZE: u64 = 0x10000;
+
+/// Read backend
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum DiscIoBackend {
+    /// io_uring when the host supports it, else threads
+    Auto = 0,
+    /// Linux io_uring
+    Uring = 1,
+    /// Pool of I/O threads issuing positional reads
+    Threads = 2,
+}
+
+/// Select the read backend; only possible while no image is open
+pub fn set_backend(backend: DiscIoBackend) -> io::Result<()> {
+    match unsafe { oc_disc_io_set_backend(backend as i32) } {
+        0 => Ok(()),
+        -2 => Err(io::Error::new(io::ErrorKind::Other, "disc images are open")),
+        -3 => Err(io::Error::new(io::ErrorKind::Unsupported, "io_uring is not supported")),
+        _ => Err(io::Error::new(io::ErrorKind::InvalidInput, "invalid disc I/O backend")),
+    }
+}
+
+/// Get the read backend in use (`Auto` before the first open)
+pub fn backend() -> DiscIoBackend {
+    match unsafe { oc_disc_io_get_backend() } {
+        1 => DiscIoBackend::Uring,
+        2 => DiscIoBackend::Threads,
+        _ => DiscIoBackend::Auto,
+    }
+}
+
+/// Set the block cache size in bytes (0 restores the 64MB default)
+pub fn set_cache_size(bytes: u64) {
+    unsafe { oc_disc_io_set_cache_size(bytes) };
+}
+
+/// Get disc I/O statistics
+pub fn stats() -> DiscIoStats {
+    let mut stats = DiscIoStats::default();
+    unsafe { oc_disc_io_get_stats(&mut stats) };
+    stats
+}
+
+/// Reset disc I/O statistics
+pub fn reset_stats() {
+    unsafe { oc_disc_io_reset_stats() };
+}
+
+fn io_failed() -> io::Error {
+    io::Error::new(io::ErrorKind::Other, "disc image read failed")
+}
+
+/// An ISO or PKG image opened through the block cache
+pub struct DiscFile {
+    handle: *mut DiscFileHandle,
+}
+
+// Reads, batches and prefetches are thread-safe; set_decrypt takes `&mut self`
+unsafe impl Send for DiscFile {}
+unsafe impl Sync for DiscFile {}
+
+impl DiscFile {
+    /// Open an image
+    pub fn open(path: &Path) -> io::Result<Self> {
+        let c_path = CString::new(path.to_string_lossy().as_bytes())
+            .map_err(|_| io::Error::new(io::ErrorKind::InvalidInput, "path contains a NUL byte"))?;
+        let handle = unsafe { oc_disc_file_open(c_path.as_ptr()) };
+        if handle.is_null() {
+            // Report why, as std would
+            std::fs::File::open(path)?;
+            return Err(io::Error::new(io::ErrorKind::Other, "failed to open disc image"));
+        }
+        Ok(Self { handle })
+    }
+
+    /// Size of the image in bytes
+    pub fn len(&self) -> u64 {
+        unsafe { oc_disc_file_get_size(self.handle) }
+    }
+
+    /// Whether the image is empty
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Decrypt `[offset, offset + size)` with AES-128-CTR, counting 16-byte
+    /// blocks from `iv` at `offset`. A size of 0 turns decryption off.
+    pub fn set_decrypt(&mut self, offset: u64, size: u64, key: &[u8; 16], iv: &[u8; 16]) -> io::Result<()> {
+        match unsafe { oc_disc_file_set_decrypt(self.handle, offset, size, key.as_ptr(), iv.as_ptr()) } {
+            0 => Ok(()),
+            _ => Err(io::Error::new(io::ErrorKind::Other, "disc image has reads in flight")),
+        }
+    }
+
+    /// Read at an offset; returns the bytes read (short at the end of the image)
+    pub fn read_at(&self, offset: u64, buf: &mut [u8]) -> io::Result<usize> {
+        let n = unsafe { oc_disc_file_read(self.handle, offset, buf.as_mut_ptr(), buf.len() as u64) };
+        if n < 0 { Err(io_failed()) } else { Ok(n as usize) }
+    }
+
+    /// Read exactly `buf.len()` bytes at an offset
+    pub fn read_exact_at(&self, offset: u64, buf: &mut [u8]) -> io::Result<()> {
+        if self.read_at(offset, buf)? != buf.len() {
+            return Err(io::Error::new(io::ErrorKind::UnexpectedEof, "read past the end of the disc image"));
+        }
+        Ok(())
+    }
+
+    /// Read several ranges, loading the blocks of all of them together;
+    /// returns the bytes read into each buffer
+    pub fn read_batch(&self, reads: &mut [(u64, &mut [u8])]) -> io::Result<Vec<usize>> {
+        let mut vecs = Vec::with_capacity(reads.len());
+        for (offset, buf) in reads.iter_mut() {
+            let size = u32::try_from(buf.len())
+                .map_err(|_| io::Error::new(io::ErrorKind::InvalidInput, "batched read too large"))?;
+            vecs.push(RawIoVec { offset: *offset, buffer: buf.as_mut_ptr(), size, result: 0 });
+        }
+        match unsafe { oc_disc_file_read_batch(self.handle, vecs.as_mut_ptr(), vecs.len()) } {
+            0 => Ok(vecs.iter().map(|v| v.result as usize).collect()),
+            _ => Err(io_failed()),
+        }
+    }
+
+    /// Start loading a range into the cache without waiting for it;
+    /// returns the blocks queued
+    pub fn prefetch(&self, offset: u64, size: u64) -> usize {
+        unsafe { oc_disc_file_prefetch(self.handle, offset, size) }.max(0) as usize
+    }
+
+    /// A `Read + Seek` cursor over the image
+    pub fn reader(&self) -> DiscFileReader<'_> {
+        DiscFileReader { file: self, pos: 0 }
+    }
+}
+
+impl std::fmt::Debug for DiscFile {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("DiscFile").field("len", &self.len()).finish()
+    }
+}
+
+impl Drop for DiscFile {
+    fn drop(&mut self) {
+        unsafe { oc_disc_file_close(self.handle) };
+    }
+}
+
+/// `Read + Seek` cursor over a [`DiscFile`]; cursors are independent, so
+/// each thread can use its own
+#[derive(Debug)]
+pub struct DiscFileReader<'a> {
+    file: &'a DiscFile,
+    pos: u64,
+}
+
+impl Read for DiscFileReader<'_> {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        let n = self.file.read_at(self.pos, buf)?;
+        self.pos += n as u64;
+        Ok(n)
+    }
+}
+
+impl Seek for DiscFileReader<'_> {
+    fn seek(&mut self, pos: SeekFrom) -> io::Result<u64> {
+        let target = match pos {
+            SeekFrom::Start(offset) => Some(offset),
+            SeekFrom::End(delta) => self.file.len().checked_add_signed(delta),
+            SeekFrom::Current(delta) => self.pos.checked_add_signed(delta),
+        };
+        self.pos = target
+            .ok_or_else(|| io::Error::new(io::ErrorKind::InvalidInput, "seek before the start of the disc image"))?;
+        Ok(self.pos)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn temp_image(name: &str, data: &[u8]) -> std::path::PathBuf {
+        let path = std::env::temp_dir().join(format!("oc_disc_io_{}_{}", std::process::id(), name));
+        std::fs::write(&path, data).unwrap();
+        path
+    }
+
+    fn pattern(len: usize) -> Vec<u8> {
+        (0..len).map(|i| (i * 7 + i / 4096) as u8).collect()
+    }
+
+    #[test]
+    fn test_disc_file_read_matches_std() {
+        let data = pattern(3 * DISC_BLOCK_SIZE as usize + 1234);
+        let path = temp_image("read", &data);
+        let file = DiscFile::open(&path).unwrap();
+        assert_eq!(file.len(), data.len() as u64);
+
+        // Sequential sector reads, then reads across block boundaries
+        let mut buf = vec![0u8; data.len()];
+        for chunk in (0..data.len()).step_by(DISC_SECTOR_SIZE as usize) {
+            let end = (chunk + DISC_SECTOR_SIZE as usize).min(data.len());
+            assert_eq!(file.read_at(chunk as u64, &mut buf[chunk..end]).unwrap(), end - chunk);
+        }
+        assert_eq!(buf, data);
+
+        let mut small = [0u8; 300];
+        let offset = DISC_BLOCK_SIZE - 100;
+        file.read_exact_at(offset, &mut small).unwrap();
+        assert_eq!(&small[..], &data[offset as usize..offset as usize + 300]);
+
+        // Short at the end, empty past it
+        assert_eq!(file.read_at(data.len() as u64 - 10, &mut small).unwrap(), 10);
+        assert_eq!(file.read_at(data.len() as u64 + 5, &mut small).unwrap(), 0);
+        assert!(file.read_exact_at(data.len() as u64 - 10, &mut small).is_err());
+
+        drop(file);
+        std::fs::remove_file(path).unwrap();
+    }
+
+    #[test]
+    fn test_disc_file_reader_seek() {
+        let data = pattern(100_000);
+        let path = temp_image("seek", &data);
+        let file = DiscFile::open(&path).unwrap();
+
+        let mut reader = file.reader();
+        reader.seek(SeekFrom::Start(16 * DISC_SECTOR_SIZE)).unwrap();
+        let mut sector = [0u8; 2048];
+        reader.read_exact(&mut sector).unwrap();
+        assert_eq!(&sector[..], &data[16 * 2048..17 * 2048]);
+
+        assert_eq!(reader.seek(SeekFrom::End(-4)).unwrap(), data.len() as u64 - 4);
+        let mut rest = Vec::new();
+        reader.read_to_end(&mut rest).unwrap();
+        assert_eq!(rest, &data[data.len() - 4..]);
+        assert!(reader.seek(SeekFrom::Current(-200_000)).is_err());
+
+        drop(file);
+        std::fs::remove_file(path).unwrap();
+    }
+
+    #[test]
+    fn test_disc_file_read_batch_and_prefetch() {
+        let data = pattern(5 * DISC_BLOCK_SIZE as usize);
+        let path = temp_image("batch", &data);
+        let file = DiscFile::open(&path).unwrap();
+
+        assert!(file.prefetch(4 * DISC_BLOCK_SIZE, DISC_BLOCK_SIZE) <= 1);
+        let mut a = vec![0u8; 5000];
+        let mut b = vec![0u8; 70_000];
+        let mut c = vec![0u8; 64];
+        let offsets = [10u64, 2 * DISC_BLOCK_SIZE - 3, data.len() as u64 - 16];
+        let mut reads: Vec<(u64, &mut [u8])> =
+            vec![(offsets[0], &mut a[..]), (offsets[1], &mut b[..]), (offsets[2], &mut c[..])];
+        let sizes = file.read_batch(&mut reads).unwrap();
+        assert_eq!(sizes, vec![5000, 70_000, 16]);
+        assert_eq!(&a[..], &data[10..5010]);
+        assert_eq!(&b[..], &data[offsets[1] as usize..offsets[1] as usize + 70_000]);
+        assert_eq!(&c[..16], &data[data.len() - 16..]);
+
+        drop(file);
+        std::fs::remove_file(path).unwrap();
+    }
+
+    #[test]
+    fn test_disc_file_read_batch_spans_chunks() {
+        // Longer than one 64-block read chunk, starting mid-block
+        let data = pattern(70 * DISC_BLOCK_SIZE as usize);
+        let path = temp_image("batch_chunks", &data);
+        let file = DiscFile::open(&path).unwrap();
+
+        let offset = DISC_BLOCK_SIZE / 2;
+        let mut big = vec![0u8; 66 * DISC_BLOCK_SIZE as usize];
+        let mut small = vec![0u8; 100];
+        let mut reads: Vec<(u64, &mut [u8])> = vec![(offset, &mut big[..]), (0, &mut small[..])];
+        let sizes = file.read_batch(&mut reads).unwrap();
+        assert_eq!(sizes, vec![big.len(), 100]);
+        assert_eq!(&big[..], &data[offset as usize..offset as usize + big.len()]);
+        assert_eq!(&small[..], &data[..100]);
+
+        drop(file);
+        std::fs::remove_file(path).unwrap();
+    }
+
+    #[test]
+    fn test_disc_file_decrypt_ctr() {
+        // NIST SP 800-38A F.5.1, placed after a plaintext prefix
+        let key = [
+            0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+        ];
+        let iv = [
+            0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
+        ];
+        let ciphertext = [
+            0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+            0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+        ];
+        let plaintext = [
+            0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+            0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        ];
+        let mut image = vec![0x55u8; 9];
+        image.extend_from_slice(&ciphertext);
+        let path = temp_image("ctr", &image);
+
+        let mut file = DiscFile::open(&path).unwrap();
+        file.set_decrypt(9, 32, &key, &iv).unwrap();
+        let mut out = [0u8; 41];
+        file.read_exact_at(0, &mut out).unwrap();
+        assert_eq!(&out[..9], &[0x55u8; 9]);
+        assert_eq!(&out[9..], &plaintext[..]);
+
+        // Starting mid-counter-block
+        let mut part = [0u8; 7];
+        file.read_exact_at(9 + 13, &mut part).unwrap();
+        assert_eq!(&part[..], &plaintext[13..20]);
+
+        drop(file);
+        std::fs::remove_file(path).unwrap();
+    }
+}
@@ -26,8 +26,36 @@ extern "C" {
         fences: *mut u64, barriers: *mut u64,
     );
     fn oc_dma_reset_stats();
+    fn oc_dma_prefetch_enable(enable: i32);
+    fn oc_dma_prefetch_is_enabled() -> i32;
+    fn oc_dma_prefetch_observe(spu_id: i32, tag: u16, ea: u64, size: u32, main_memory: *const u8);
+    fn oc_dma_prefetch_get_stats(
+        predictions: *mut u64, hits: *mut u64,
+        misses: *mut u64, bytes_prefetched: *mut u64,
+    );
+    fn oc_dma_heatmap_enable(enable: i32);
+    fn oc_dma_heatmap_is_enabled() -> i32;
+    fn oc_dma_heatmap_set_current_spu(spu_id: i32);
+    fn oc_dma_heatmap_record(
+        spu_id: i32, tag: u16, ea: u64, size: u32,
+        is_put: i32, stall_ns: u64,
+    );
+    fn oc_dma_heatmap_snapshot(
+        out: *mut DmaHeatmapTotals,
+        buckets: *mut DmaBucket, max_buckets: usize,
+    ) -> usize;
+    fn oc_dma_heatmap_reset();
 }
 
+/// Per-SPU slots in a heatmap snapshot
+pub const DMA_HEATMAP_SPUS: usize = 8;
+
+/// Size histogram classes: class N counts transfers of [2^N, 2^(N+1)) bytes
+pub const DMA_HEATMAP_SIZE_CLASSES: usize = 15;
+
+/// EA bucket granularity (64KB)
+pub const DMA_HEATMAP_BUCKET_SHIFT: u32 = 16;
+
 /// DMA command types matching the Cell SPU MFC command set.
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 #[repr(u8)]
@@ -196,11 +224,151 @@ pub fn get_stats() -> DmaStats {
     stats
 }
 
-/// Reset DMA statistics and clear all pending transfers.
+/// Reset DMA statistics, prefetch stream state and clear all pending transfers.
 pub fn reset_stats() {
     unsafe { oc_dma_reset_stats() };
 }
 
+/// Enable or disable predictive prefetching of constant-stride GET streams.
+pub fn prefetch_enable(enable: bool) {
+    unsafe { oc_dma_prefetch_enable(if enable { 1 } else { 0 }) };
+}
+
+/// Check if predictive GET prefetching is enabled.
+pub fn prefetch_is_enabled() -> bool {
+    unsafe { oc_dma_prefetch_is_enabled() != 0 }
+}
+
+/// Report a GET performed outside the C++ DMA paths, once its data has
+/// moved, and prefetch the stream's predicted next chunk.
+///
+/// `spu_id` of `None` attributes the GET to the calling thread's current SPU.
+///
+/// # Safety
+/// `main_memory` must be the base of a mapping that covers every 32-bit
+/// effective address, such as the guest address space reservation.
+pub unsafe fn prefetch_observe(spu_id: Option<u32>, tag: u16, ea: u64, size: u32, main_memory: *const u8) {
+    let id = spu_id.map(|id| id as i32).unwrap_or(-1);
+    oc_dma_prefetch_observe(id, tag, ea, size, main_memory);
+}
+
+/// GET prefetch statistics.
+#[derive(Debug, Clone, Default)]
+pub struct DmaPrefetchStats {
+    pub predictions: u64,
+    pub hits: u64,
+    pub misses: u64,
+    pub bytes_prefetched: u64,
+}
+
+/// Get GET prefetch statistics.
+pub fn get_prefetch_stats() -> DmaPrefetchStats {
+    let mut stats = DmaPrefetchStats::default();
+    unsafe {
+        oc_dma_prefetch_get_stats(
+            &mut stats.predictions, &mut stats.hits,
+            &mut stats.misses, &mut stats.bytes_prefetched,
+        );
+    }
+    stats
+}
+
+/// Aggregated DMA traffic for one SPU, tag or EA bucket (matches `oc_dma_traffic_t`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct DmaTraffic {
+    pub bytes_in: u64,
+    pub bytes_out: u64,
+    pub gets: u64,
+    pub puts: u64,
+    /// Time the issuer waited for its transfers, in nanoseconds
+    pub stall_ns: u64,
+}
+
+impl DmaTraffic {
+    /// Total bytes moved in either direction.
+    pub fn bytes(&self) -> u64 {
+        self.bytes_in + self.bytes_out
+    }
+}
+
+/// Traffic for one 64KB EA bucket (matches `oc_dma_bucket_t`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct DmaBucket {
+    pub bucket: u32,
+    reserved: u32,
+    pub traffic: DmaTraffic,
+}
+
+impl DmaBucket {
+    /// First EA covered by this bucket.
+    pub fn base_ea(&self) -> u64 {
+        (self.bucket as u64) << DMA_HEATMAP_BUCKET_SHIFT
+    }
+}
+
+/// Heatmap snapshot totals (matches `oc_dma_heatmap_t`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct DmaHeatmapTotals {
+    pub spus: [DmaTraffic; DMA_HEATMAP_SPUS],
+    pub tags: [DmaTraffic; 32],
+    pub size_histogram: [u64; DMA_HEATMAP_SIZE_CLASSES],
+    /// Transfers issued with no current SPU
+    pub unattributed_ops: u64,
+}
+
+/// DMA bandwidth heatmap snapshot.
+#[derive(Debug, Clone, Default)]
+pub struct DmaHeatmap {
+    pub totals: DmaHeatmapTotals,
+    /// EA buckets with traffic, hottest first
+    pub buckets: Vec<DmaBucket>,
+}
+
+/// Enable or disable heatmap instrumentation (disabled by default).
+pub fn heatmap_enable(enable: bool) {
+    unsafe { oc_dma_heatmap_enable(if enable { 1 } else { 0 }) };
+}
+
+/// Check if heatmap instrumentation is enabled.
+pub fn heatmap_is_enabled() -> bool {
+    unsafe { oc_dma_heatmap_is_enabled() != 0 }
+}
+
+/// Set the SPU that the calling thread issues DMA for (`None` for none).
+pub fn heatmap_set_current_spu(spu_id: Option<u32>) {
+    let id = spu_id.map(|id| id as i32).unwrap_or(-1);
+    unsafe { oc_dma_heatmap_set_current_spu(id) };
+}
+
+/// Record a transfer performed outside the C++ DMA paths.
+///
+/// `spu_id` of `None` attributes the transfer to the calling thread's current SPU.
+pub fn heatmap_record(spu_id: Option<u32>, tag: u16, ea: u64, size: u32, is_put: bool, stall_ns: u64) {
+    let id = spu_id.map(|id| id as i32).unwrap_or(-1);
+    unsafe { oc_dma_heatmap_record(id, tag, ea, size, if is_put { 1 } else { 0 }, stall_ns) };
+}
+
+/// Take a heatmap snapshot with up to `max_buckets` of the hottest EA buckets.
+pub fn heatmap_snapshot(max_buckets: usize) -> DmaHeatmap {
+    let mut heatmap = DmaHeatmap {
+        totals: DmaHeatmapTotals::default(),
+        buckets: vec![DmaBucket::default(); max_buckets],
+    };
+    let total = unsafe {
+        oc_dma_heatmap_snapshot(&mut heatmap.totals, heatmap.buckets.as_mut_ptr(), max_buckets)
+    };
+    heatmap.buckets.truncate(total.min(max_buckets));
+    heatmap
+}
+
+/// Clear all heatmap counters.
+pub fn heatmap_reset() {
+    unsafe { oc_dma_heatmap_reset() };
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -341,4 +509,110 @@ mod tests {
             assert_eq!(result.unwrap_err(), DmaError::LocalAddrOutOfBounds);
         }
     }
+
+    #[test]
+    fn test_dma_prefetch_stride_stream() {
+        let mut local_store = vec![0u8; 0x40000];
+        let mut main_mem = vec![0u8; 0x10000];
+
+        // Double-buffered stream: 0x400-byte chunks at a 0x1000 stride on tag 9
+        for i in 0..4u64 {
+            unsafe {
+                let result = dma_transfer(
+                    &mut local_store, ((i & 1) * 0x400) as u32,
+                    &mut main_mem, i * 0x1000, 0x400,
+                    9, DmaCommand::Get,
+                );
+                assert!(result.is_ok());
+            }
+        }
+
+        if prefetch_is_enabled() {
+            let stats = get_prefetch_stats();
+            assert!(stats.predictions >= 1);
+            assert!(stats.hits >= 1);
+        }
+    }
+
+    #[test]
+    fn test_dma_prefetch_streams_per_spu() {
+        let mut local_store = vec![0u8; 0x40000];
+        let mut main_mem = vec![0u8; 0x20000];
+
+        // Two SPUs interleave streams of different strides on the same tag;
+        // kept apart, each settles on its own stride
+        let streams = [(5u32, 0u64, 0x1000u64), (6, 0x10000, 0x800)];
+        for i in 0..6u64 {
+            for &(spu, base, stride) in &streams {
+                heatmap_set_current_spu(Some(spu));
+                unsafe {
+                    let result = dma_transfer(
+                        &mut local_store, 0, &mut main_mem, base + i * stride, 0x200,
+                        7, DmaCommand::Get,
+                    );
+                    assert!(result.is_ok());
+                }
+            }
+        }
+        heatmap_set_current_spu(None);
+
+        if prefetch_is_enabled() {
+            let stats = get_prefetch_stats();
+            assert!(stats.hits >= 2);
+        }
+    }
+
+    #[test]
+    fn test_dma_prefetch_external_and_list_gets() {
+        let mut local_store = vec![0u8; 0x40000];
+        let mut main_mem = vec![0u8; 0x20000];
+
+        // GETs copied by the caller are reported on their own
+        for i in 0..4u64 {
+            unsafe { prefetch_observe(Some(4), 3, i * 0x800, 0x100, main_mem.as_ptr()) };
+        }
+        if prefetch_is_enabled() {
+            assert!(get_prefetch_stats().hits >= 1);
+        }
+
+        // A list gathering elements at a fixed stride is a stream too
+        for i in 0..4u32 {
+            let element = (i * 8) as usize;
+            local_store[element..element + 4].copy_from_slice(&0x80u32.to_be_bytes());
+            local_store[element + 4..element + 8].copy_from_slice(&(0x10000 + i * 0x400).to_be_bytes());
+        }
+        heatmap_set_current_spu(Some(2));
+        let predictions = get_prefetch_stats().predictions;
+        let entries = unsafe {
+            dma_list_transfer(&mut local_store, 0, &mut main_mem, 32, 11, DmaCommand::GetList).unwrap()
+        };
+        heatmap_set_current_spu(None);
+        assert_eq!(entries, 4);
+        if prefetch_is_enabled() {
+            assert!(get_prefetch_stats().predictions > predictions);
+        }
+    }
+
+    #[test]
+    fn test_dma_heatmap_record() {
+        heatmap_enable(true);
+
+        // Bucket 0x7F00 is used only by this test
+        heatmap_record(Some(3), 12, 0x7F00_0000, 0x800, false, 100);
+        heatmap_record(Some(3), 12, 0x7F00_0800, 0x800, true, 50);
+
+        let heatmap = heatmap_snapshot(4096);
+        let bucket = heatmap.buckets.iter()
+            .find(|b| b.bucket == 0x7F00)
+            .expect("bucket recorded");
+        assert_eq!(bucket.base_ea(), 0x7F00_0000);
+        assert!(bucket.traffic.bytes_in >= 0x800);
+        assert!(bucket.traffic.bytes_out >= 0x800);
+        assert!(heatmap.totals.spus[3].gets >= 1);
+        assert!(heatmap.totals.size_histogram[11] >= 2);
+
+        // Off again, so the heatmap does not time every later transfer
+        heatmap_enable(false);
+        assert!(!heatmap_is_enabled());
+    }
 }
@@ -69,7 +69,8 @@ pub struct PpuContext {
     pub instructions_executed: u32,
     
     /// Execution result/status
-    /// 0 = normal, 1 = branch, 2 = syscall, 3 = breakpoint, 4 = error
+    /// 0 = normal, 1 = branch, 2 = syscall, 3 = breakpoint, 4 = error, 5 = preempted,
+    /// 6 = deoptimized
     pub exit_reason: i32,
     
     /// Memory base pointer (set before execution)
@@ -77,6 +78,21 @@ pub struct PpuContext {
     
     /// Memory size (for bounds checking in debug builds)
     pub memory_size: u64,
+    
+    /// Remaining guest instructions in the current time slice; compiled code
+    /// exits with `PpuExitReason::Preempted` once it is used up
+    pub instruction_budget: i64,
+    
+    /// Non-zero to enforce `instruction_budget`
+    pub budget_enabled: u32,
+    
+    /// Set asynchronously to request a `PpuExitReason::Preempted` exit at the
+    /// next region entry or loop back-edge
+    pub interrupt_pending: u32,
+    
+    /// Index of the failed guard in its region after a
+    /// `PpuExitReason::Deoptimized` exit
+    pub deopt_guard: u32,
 }
 
 impl Default for PpuContext {
@@ -98,6 +114,10 @@ impl Default for PpuContext {
             exit_reason: 0,
             memory_base: std::ptr::null_mut(),
             memory_size: 0,
+            instruction_budget: 0,
+            budget_enabled: 0,
+            interrupt_pending: 0,
+            deopt_guard: 0,
         }
     }
 }
@@ -116,6 +136,11 @@ pub enum PpuExitReason {
     Breakpoint = 3,
     /// Execution error
     Error = 4,
+    /// Instruction budget exhausted or interrupt pending; `next_pc` is the resume point
+    Preempted = 5,
+    /// A speculation guard failed; the guest state up to `next_pc` is in the
+    /// context and the interpreter resumes there
+    Deoptimized = 6,
 }
 
 impl From<i32> for PpuExitReason {
@@ -125,6 +150,8 @@ impl From<i32> for PpuExitReason {
             1 => PpuExitReason::Branch,
             2 => PpuExitReason::Syscall,
             3 => PpuExitReason::Breakpoint,
+            5 => PpuExitReason::Preempted,
+            6 => PpuExitReason::Deoptimized,
             _ => PpuExitReason::Error,
         }
     }
@@ -160,7 +187,7 @@ pub struct SpuContext {
     pub instructions_executed: u32,
     
     /// Execution result/status
-    /// 0 = normal, 1 = branch, 2 = stop, 3 = breakpoint, 4 = error
+    /// 0 = normal, 1 = branch, 2 = stop, 3 = breakpoint, 4 = error, 5 = preempted
     pub exit_reason: i32,
     
     /// Local Storage base pointer (256KB SPU local memory)
@@ -180,6 +207,43 @@ pub struct SpuContext {
     
     /// Padding for alignment
     _padding: [u8; 3],
+    
+    /// Remaining guest instructions in the current time slice
+    pub instruction_budget: i64,
+    
+    /// Non-zero to enforce `instruction_budget`
+    pub budget_enabled: u32,
+    
+    /// Set asynchronously to request a `SpuExitReason::Preempted` exit
+    pub interrupt_pending: u32,
+    
+    /// SPU_WrEventMask / SPU_RdEventMask
+    pub event_mask: u32,
+    
+    /// Pending events; keep `channel_count[0]` non-zero while any are unmasked
+    pub event_stat: u32,
+    
+    /// SPU_WrSRR0 / SPU_RdSRR0
+    pub srr0: u32,
+    
+    /// SPU_RdSigNotify1/2, valid while their channel count is non-zero
+    pub signal_notify: [u32; 2],
+    
+    /// MFC command parameters latched by MFC_LSA/EAH/EAL/Size/TagID writes
+    pub mfc_lsa: u32,
+    pub mfc_eah: u32,
+    pub mfc_eal: u32,
+    pub mfc_size: u32,
+    pub mfc_tag_id: u32,
+    
+    /// MFC_RdTagStat value, valid while `channel_count[24]` is non-zero
+    pub mfc_tag_status: u32,
+    
+    /// MFC_RdAtomicStat value, valid while `channel_count[27]` is non-zero
+    pub mfc_atomic_stat: u32,
+    
+    /// SPU_WrOutMbox entry; full when `channel_count[28]` is zero
+    pub out_mbox: u32,
 }
 
 impl Default for SpuContext {
@@ -199,10 +263,112 @@ impl Default for SpuContext {
             decrementer: 0,
             mfc_tag_mask: 0,
             _padding: [0; 3],
+            instruction_budget: 0,
+            budget_enabled: 0,
+            interrupt_pending: 0,
+            event_mask: 0,
+            event_stat: 0,
+            srr0: 0,
+            signal_notify: [0; 2],
+            mfc_lsa: 0,
+            mfc_eah: 0,
+            mfc_eal: 0,
+            mfc_size: 0,
+            mfc_tag_id: 0,
+            mfc_tag_status: 0,
+            mfc_atomic_stat: 0,
+            out_mbox: 0,
         }
     }
 }
 
+/// SPU channel numbers whose state the runtime keeps in `SpuContext`
+pub const SPU_CH_RD_EVENT_STAT: u8 = 0;
+pub const SPU_CH_RD_SIG_NOTIFY1: u8 = 3;
+pub const SPU_CH_RD_SIG_NOTIFY2: u8 = 4;
+pub const SPU_CH_RD_TAG_STAT: u8 = 24;
+pub const SPU_CH_RD_ATOMIC_STAT: u8 = 27;
+pub const SPU_CH_WR_OUT_MBOX: u8 = 28;
+
+/// Runtime side of the channels compiled code accesses inline. Each keeps a
+/// value and its `channel_count` entry consistent, which is all compiled
+/// code relies on; a count of zero sends it to the channel callbacks.
+impl SpuContext {
+    /// Put the channels in their reset state: nothing pending and the
+    /// outbound mailbox empty.
+    pub fn reset_channels(&mut self) {
+        self.channel_count = [0; 32];
+        self.channel_count[SPU_CH_WR_OUT_MBOX as usize] = 1;
+        self.event_stat = 0;
+        self.signal_notify = [0; 2];
+        self.mfc_tag_status = 0;
+        self.mfc_atomic_stat = 0;
+        self.out_mbox = 0;
+    }
+
+    /// Raise events; SPU_RdEventStat becomes readable once one is unmasked.
+    pub fn raise_events(&mut self, events: u32) {
+        self.event_stat |= events;
+        self.channel_count[SPU_CH_RD_EVENT_STAT as usize] =
+            (self.event_stat & self.event_mask != 0) as u32;
+    }
+
+    /// Deliver a signal notification to register 1 or 2. With `or_mode` the
+    /// value is ORed into a pending one, as the SNR OR mode does.
+    pub fn post_signal(&mut self, register: usize, value: u32, or_mode: bool) {
+        let index = register - 1;
+        let channel = (SPU_CH_RD_SIG_NOTIFY1 as usize) + index;
+        if or_mode && self.channel_count[channel] != 0 {
+            self.signal_notify[index] |= value;
+        } else {
+            self.signal_notify[index] = value;
+        }
+        self.channel_count[channel] = 1;
+    }
+
+    /// Complete a tag status update request with the completed tag groups.
+    pub fn post_tag_status(&mut self, status: u32) {
+        self.mfc_tag_status = status;
+        self.channel_count[SPU_CH_RD_TAG_STAT as usize] = 1;
+    }
+
+    /// Complete an atomic command (GETLLAR/PUTLLC/PUTLLUC) with its status.
+    pub fn post_atomic_status(&mut self, status: u32) {
+        self.mfc_atomic_stat = status;
+        self.channel_count[SPU_CH_RD_ATOMIC_STAT as usize] = 1;
+    }
+
+    /// Drain the outbound mailbox, returning the entry the SPU wrote.
+    pub fn take_out_mbox(&mut self) -> Option<u32> {
+        let count = &mut self.channel_count[SPU_CH_WR_OUT_MBOX as usize];
+        if *count != 0 {
+            return None;
+        }
+        *count = 1;
+        Some(self.out_mbox)
+    }
+}
+
+/// Channel read callback: `(context, channel) -> value`
+pub type SpuChannelReadFn = extern "C" fn(*mut SpuContext, u8) -> u32;
+
+/// Channel write callback: `(context, channel, value)`
+pub type SpuChannelWriteFn = extern "C" fn(*mut SpuContext, u8, u32);
+
+/// Channel count callback: `(context, channel) -> count`
+pub type SpuChannelCountFn = extern "C" fn(*mut SpuContext, u8) -> u32;
+
+/// How compiled code reaches a channel
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SpuChannelPath {
+    /// Every access calls the channel callback
+    Callback,
+    /// Plain load/store on a `SpuContext` field
+    Direct,
+    /// Inline while the channel count is non-zero, callback when it would block
+    CountGated,
+}
+
 /// Exit reason codes from SPU JIT execution
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 #[repr(i32)]
@@ -217,6 +383,8 @@ pub enum SpuExitReason {
     Breakpoint = 3,
     /// Execution error
     Error = 4,
+    /// Instruction budget exhausted or interrupt pending; `next_pc` is the resume point
+    Preempted = 5,
 }
 
 impl From<i32> for SpuExitReason {
@@ -226,6 +394,7 @@ impl From<i32> for SpuExitReason {
             1 => SpuExitReason::Branch,
             2 => SpuExitReason::Stop,
             3 => SpuExitReason::Breakpoint,
+            5 => SpuExitReason::Preempted,
             _ => SpuExitReason::Error,
         }
     }
@@ -237,6 +406,7 @@ extern "C" {
     fn oc_ppu_jit_destroy(jit: *mut PpuJit);
     fn oc_ppu_jit_compile(jit: *mut PpuJit, address: u32, code: *const u8, size: usize) -> i32;
     fn oc_ppu_jit_get_compiled(jit: *mut PpuJit, address: u32) -> *mut u8;
+    fn oc_ppu_jit_is_compiled(jit: *mut PpuJit, address: u32) -> i32;
     fn oc_ppu_jit_invalidate(jit: *mut PpuJit, address: u32);
     fn oc_ppu_jit_clear_cache(jit: *mut PpuJit);
     fn oc_ppu_jit_add_breakpoint(jit: *mut PpuJit, address: u32);
@@ -304,6 +474,73 @@ extern "C" {
     
     // Code verification API
     fn oc_ppu_jit_verify_codegen(jit: *mut PpuJit) -> i32;
+    
+    // Warm start APIs
+    fn oc_ppu_jit_warm_start_export(jit: *mut PpuJit, buffer: *mut u8, buffer_size: usize, max_entries: usize) -> usize;
+    fn oc_ppu_jit_warm_start_import(jit: *mut PpuJit, data: *const u8, size: usize) -> i32;
+    fn oc_ppu_jit_warm_start_submit(jit: *mut PpuJit, memory_base: *const u8, memory_size: u64, max_count: usize) -> usize;
+    fn oc_ppu_jit_warm_start_pending(jit: *mut PpuJit) -> usize;
+    
+    // Pass pipeline and compile corpus APIs
+    fn oc_ppu_jit_set_pass_pipeline(jit: *mut PpuJit, pipeline: i32) -> i32;
+    fn oc_ppu_jit_get_pass_pipeline(jit: *mut PpuJit) -> i32;
+    fn oc_ppu_jit_corpus_begin(jit: *mut PpuJit, path: *const std::os::raw::c_char) -> i32;
+    fn oc_ppu_jit_corpus_end(jit: *mut PpuJit);
+    fn oc_ppu_jit_corpus_get_count(jit: *mut PpuJit) -> u64;
+    fn oc_ppu_jit_remote_compile_enable(jit: *mut PpuJit, enable: i32);
+    fn oc_ppu_jit_remote_compile_is_enabled(jit: *mut PpuJit) -> i32;
+    
+    // Code quality APIs
+    fn oc_ppu_jit_get_block_codegen(jit: *mut PpuJit, address: u32, stats: *mut PpuCodegenStats) -> i32;
+    fn oc_ppu_jit_get_codegen_stats(jit: *mut PpuJit, op_class: i32, stats: *mut PpuCodegenStats) -> i32;
+    fn oc_ppu_jit_reset_codegen_stats(jit: *mut PpuJit);
+    
+    // Stack slot promotion APIs
+    fn oc_ppu_jit_stack_promotion_enable(jit: *mut PpuJit, enable: i32);
+    fn oc_ppu_jit_stack_promotion_is_enabled(jit: *mut PpuJit) -> i32;
+    fn oc_ppu_jit_stack_analyze(jit: *mut PpuJit, instructions: *const u32, count: usize,
+                                promoted_slots: *mut u32, promoted_accesses: *mut u32) -> i32;
+    fn oc_ppu_jit_stack_get_stats(jit: *mut PpuJit, regions_analyzed: *mut u64,
+                                  regions_promoted: *mut u64, slots_promoted: *mut u64,
+                                  accesses_promoted: *mut u64);
+    fn oc_ppu_jit_stack_reset_stats(jit: *mut PpuJit);
+    
+    // VMX byte order folding APIs
+    fn oc_ppu_jit_vmx_analyze(jit: *mut PpuJit, instructions: *const u32, count: usize,
+                              swaps_emitted: *mut u32, swaps_folded: *mut u32) -> i32;
+    
+    // Idiom recognition APIs
+    fn oc_ppu_jit_idioms_enable(jit: *mut PpuJit, enable: i32);
+    fn oc_ppu_jit_idioms_is_enabled(jit: *mut PpuJit) -> i32;
+    fn oc_ppu_jit_idioms_analyze(jit: *mut PpuJit, instructions: *const u32, count: usize,
+                                 counts: *mut u32) -> i32;
+    fn oc_ppu_jit_idioms_get_stats(jit: *mut PpuJit, regions: *mut u64, idioms: *mut u64,
+                                   instructions_fused: *mut u64);
+    fn oc_ppu_jit_idioms_reset_stats(jit: *mut PpuJit);
+    
+    // Jump table APIs
+    fn oc_ppu_jit_add_readonly_region(jit: *mut PpuJit, guest_address: u32, data: *const u8,
+                                      size: usize) -> i32;
+    fn oc_ppu_jit_get_jump_table(jit: *mut PpuJit, block_address: u32, targets: *mut u32,
+                                 max_targets: usize, default_target: *mut u32) -> usize;
+    
+    // Speculation APIs
+    fn oc_ppu_jit_btb_add(jit: *mut PpuJit, branch_address: u32, target_address: u32);
+    fn oc_ppu_jit_const_set_reg(jit: *mut PpuJit, block_addr: u32, reg_num: u8,
+                                value: u64, def_addr: u32, is_constant: i32);
+    fn oc_ppu_jit_deopt_get_stats(jit: *mut PpuJit, guards: *mut u64, deopts: *mut u64,
+                                  speculations_dropped: *mut u64);
+    fn oc_ppu_jit_get_guards(jit: *mut PpuJit, address: u32, guards: *mut PpuGuardInfo,
+                             capacity: usize) -> i32;
+
+    // On-stack replacement APIs
+    fn oc_ppu_jit_osr_enable(jit: *mut PpuJit, enable: i32);
+    fn oc_ppu_jit_osr_is_enabled(jit: *mut PpuJit) -> i32;
+    fn oc_ppu_jit_osr_get_loop_header(jit: *mut PpuJit, address: u32) -> u32;
+    fn oc_ppu_jit_osr_upgrade(jit: *mut PpuJit, address: u32) -> i32;
+    fn oc_ppu_jit_osr_get_stats(jit: *mut PpuJit, loop_regions: *mut u64, upgrades: *mut u64,
+                                upgrade_failures: *mut u64);
+    fn oc_ppu_jit_tiered_promote(jit: *mut PpuJit, address: u32, target_tier: i32) -> i32;
 }
 
 // FFI declarations for SPU JIT
@@ -324,6 +561,9 @@ extern "C" {
     fn oc_spu_jit_register_channel_op(jit: *mut SpuJit, channel: u8, is_read: i32, address: u32, reg: u8);
     #[allow(dead_code)]
     fn oc_spu_jit_set_channel_callbacks(jit: *mut SpuJit, read_callback: *mut u8, write_callback: *mut u8);
+    fn oc_spu_jit_set_channel_count_callback(jit: *mut SpuJit, count_callback: *mut u8);
+    fn oc_spu_jit_channel_fast_path(channel: u8, is_write: i32) -> i32;
+    fn oc_spu_jit_execute(jit: *mut SpuJit, context: *mut SpuContext, address: u32) -> i32;
     fn oc_spu_jit_get_channel_op_count(jit: *mut SpuJit) -> usize;
     
     // MFC DMA APIs
@@ -369,6 +609,8 @@ extern "C" {
     fn oc_rsx_shader_compile_vertex(shader: *mut RsxShader, code: *const u32, size: usize, out_spirv: *mut *mut u32, out_size: *mut usize) -> i32;
     fn oc_rsx_shader_compile_fragment(shader: *mut RsxShader, code: *const u32, size: usize, out_spirv: *mut *mut u32, out_size: *mut usize) -> i32;
     fn oc_rsx_shader_free_spirv(spirv: *mut u32);
+    fn oc_rsx_shader_remote_compile_enable(shader: *mut RsxShader, enable: i32);
+    fn oc_rsx_shader_remote_compile_is_enabled(shader: *mut RsxShader) -> i32;
     fn oc_rsx_shader_link(shader: *mut RsxShader, vs_spirv: *const u32, vs_size: usize, fs_spirv: *const u32, fs_size: usize) -> i32;
     fn oc_rsx_shader_get_linked_count(shader: *mut RsxShader) -> usize;
     #[allow(dead_code)]
@@ -379,6 +621,44 @@ extern "C" {
     fn oc_rsx_shader_clear_caches(shader: *mut RsxShader);
     fn oc_rsx_shader_get_vertex_cache_count(shader: *mut RsxShader) -> usize;
     fn oc_rsx_shader_get_fragment_cache_count(shader: *mut RsxShader) -> usize;
+    fn oc_rsx_shader_corpus_begin(shader: *mut RsxShader, dir: *const std::os::raw::c_char) -> i32;
+    fn oc_rsx_shader_corpus_end(shader: *mut RsxShader);
+    fn oc_rsx_shader_corpus_get_stats(shader: *mut RsxShader, vertex_programs: *mut u64, fragment_programs: *mut u64, pipelines: *mut u64);
+
+    // RSX constant file APIs
+    fn oc_rsx_constants_get_count(shader: *mut RsxShader, file: i32) -> u32;
+    fn oc_rsx_constants_write(shader: *mut RsxShader, file: i32, first: u32, data: *const f32, count: u32) -> i32;
+    fn oc_rsx_constants_flush(shader: *mut RsxShader, file: i32, ranges: *mut RsxConstRange, max_ranges: usize, out_count: *mut usize, out_hash: *mut u64) -> i32;
+    fn oc_rsx_constants_invalidate(shader: *mut RsxShader, file: i32);
+}
+
+/// RSX constant files
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum RsxConstFile {
+    /// 468 transform constants
+    Vertex = 0,
+    /// 512 fragment constant slots
+    Fragment = 1,
+}
+
+/// Constant upload range in vec4 constants (matches `oc_rsx_const_range_t`)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RsxConstRange {
+    pub first: u32,
+    pub count: u32,
+}
+
+/// Result of a draw-time constant flush
+#[derive(Debug, Clone, Default)]
+pub struct RsxConstFlush {
+    /// Changed ranges to upload
+    pub ranges: Vec<RsxConstRange>,
+    /// Content hash of the whole constant file
+    pub hash: u64,
+    /// The file matches a previously flushed one with the same hash
+    pub reused: bool,
 }
 
 /// Branch prediction hint types
@@ -430,7 +710,7 @@ impl PpuJitCompiler {
     }
 
     /// Compile a PPU code block starting at the given address
-    pub fn compile(&mut self, address: u32, code: &[u8]) -> Result<(), JitError> {
+    pub fn compile(&self, address: u32, code: &[u8]) -> Result<(), JitError> {
         let result = unsafe {
             oc_ppu_jit_compile(self.handle, address, code.as_ptr(), code.len())
         };
@@ -445,10 +725,9 @@ impl PpuJitCompiler {
     /// Get compiled code for a given address
     /// 
     /// # Safety
-    /// Returns a raw pointer to compiled machine code. The pointer is valid as long as:
-    /// - The JIT compiler instance is alive
-    /// - The code at this address has not been invalidated
-    /// - No cache clear operation has been performed
+    /// Returns a raw pointer to compiled machine code. The code stays allocated
+    /// while the JIT compiler instance is alive, even if the block is later
+    /// invalidated or the cache is cleared.
     /// 
     /// Calling compiled code directly requires understanding the calling convention
     /// and ensuring proper register state.
@@ -461,8 +740,15 @@ impl PpuJitCompiler {
         }
     }
 
+    /// Check if an address has compiled code. Unlike `get_compiled` this does
+    /// not hand the code out, so nothing is kept alive once the block leaves
+    /// the cache.
+    pub fn is_compiled(&self, address: u32) -> bool {
+        unsafe { oc_ppu_jit_is_compiled(self.handle, address) != 0 }
+    }
+
     /// Invalidate compiled code at a specific address
-    pub fn invalidate(&mut self, address: u32) {
+    pub fn invalidate(&self, address: u32) {
         unsafe { oc_ppu_jit_invalidate(self.handle, address) }
     }
 
@@ -491,7 +777,7 @@ impl PpuJitCompiler {
     // ========================================================================
     
     /// Add a branch prediction hint
-    pub fn add_branch_hint(&mut self, address: u32, target: u32, hint: BranchHint) {
+    pub fn add_branch_hint(&self, address: u32, target: u32, hint: BranchHint) {
         unsafe { oc_ppu_jit_add_branch_hint(self.handle, address, target, hint as i32) }
     }
     
@@ -501,7 +787,7 @@ impl PpuJitCompiler {
     }
     
     /// Update branch prediction based on actual behavior
-    pub fn update_branch(&mut self, address: u32, taken: bool) {
+    pub fn update_branch(&self, address: u32, taken: bool) {
         unsafe { oc_ppu_jit_update_branch(self.handle, address, if taken { 1 } else { 0 }) }
     }
     
@@ -575,7 +861,7 @@ impl PpuJitCompiler {
     }
     
     /// Register code for lazy compilation
-    pub fn register_lazy(&mut self, address: u32, code: &[u8], threshold: u32) {
+    pub fn register_lazy(&self, address: u32, code: &[u8], threshold: u32) {
         unsafe {
             oc_ppu_jit_register_lazy(
                 self.handle, address, code.as_ptr(), code.len(), threshold
@@ -656,7 +942,7 @@ impl PpuJitCompiler {
     /// # Returns
     /// * `Ok(count)` - Number of instructions executed
     /// * `Err(reason)` - Execution failed or interrupted
-    pub fn execute(&mut self, context: &mut PpuContext, address: u32) -> Result<u32, PpuExitReason> {
+    pub fn execute(&self, context: &mut PpuContext, address: u32) -> Result<u32, PpuExitReason> {
         let result = unsafe { oc_ppu_jit_execute(self.handle, context, address) };
         
         if result < 0 {
@@ -674,7 +960,7 @@ impl PpuJitCompiler {
     /// 
     /// Similar to `execute`, but only executes one basic block without
     /// following any branches. Useful for step-through debugging.
-    pub fn execute_block(&mut self, context: &mut PpuContext, address: u32) -> Result<u32, PpuExitReason> {
+    pub fn execute_block(&self, context: &mut PpuContext, address: u32) -> Result<u32, PpuExitReason> {
         let result = unsafe { oc_ppu_jit_execute_block(self.handle, context, address) };
         
         if result < 0 {
@@ -793,6 +1079,448 @@ impl PpuJitCompiler {
     pub fn verify_codegen(&mut self) -> bool {
         unsafe { oc_ppu_jit_verify_codegen(self.handle) == 1 }
     }
+
+    // ========== Warm Start APIs ==========
+
+    /// Serialize this run's execution profile (hottest `max_entries`, 0 = all)
+    /// for seeding the next boot of the same title
+    pub fn warm_start_export(&self, max_entries: usize) -> Vec<u8> {
+        // The buffer is only filled when large enough; the profile may grow
+        // between calls, so size and retry until it fits
+        let mut data = Vec::new();
+        loop {
+            let size = unsafe {
+                oc_ppu_jit_warm_start_export(self.handle, data.as_mut_ptr(), data.len(), max_entries)
+            };
+            if size <= data.len() {
+                data.truncate(size);
+                return data;
+            }
+            data.resize(size, 0);
+        }
+    }
+
+    /// Load a profile saved by `warm_start_export`, returns the number of entries
+    pub fn warm_start_import(&self, data: &[u8]) -> Result<usize, JitError> {
+        let result = unsafe { oc_ppu_jit_warm_start_import(self.handle, data.as_ptr(), data.len()) };
+        if result < 0 {
+            Err(JitError::InvalidInput)
+        } else {
+            Ok(result as usize)
+        }
+    }
+
+    /// Submit up to `max_count` loaded seeds, hottest first, reading their code
+    /// from guest memory at `memory_base`
+    pub fn warm_start_submit(&self, memory_base: *const u8, memory_size: u64, max_count: usize) -> usize {
+        unsafe { oc_ppu_jit_warm_start_submit(self.handle, memory_base, memory_size, max_count) }
+    }
+
+    /// Number of loaded seeds not yet submitted
+    pub fn warm_start_pending(&self) -> usize {
+        unsafe { oc_ppu_jit_warm_start_pending(self.handle) }
+    }
+
+    // ========== Pass Pipeline and Corpus APIs ==========
+
+    /// Select the LLVM pass pipeline used by subsequent compiles
+    pub fn set_pass_pipeline(&mut self, pipeline: PpuPassPipeline) {
+        unsafe { oc_ppu_jit_set_pass_pipeline(self.handle, pipeline as i32) };
+    }
+
+    /// Get the current pass pipeline
+    pub fn pass_pipeline(&self) -> PpuPassPipeline {
+        match unsafe { oc_ppu_jit_get_pass_pipeline(self.handle) } {
+            0 => PpuPassPipeline::O0,
+            1 => PpuPassPipeline::O1,
+            3 => PpuPassPipeline::O3,
+            4 => PpuPassPipeline::Baseline,
+            _ => PpuPassPipeline::O2,
+        }
+    }
+
+    /// Start writing every compiled unit to a corpus file (recompiled by the
+    /// `ppu_compile_bench` tool)
+    pub fn start_corpus(&mut self, path: &std::path::Path) -> Result<(), JitError> {
+        let path = std::ffi::CString::new(path.to_string_lossy().into_owned())
+            .map_err(|_| JitError::InvalidInput)?;
+        match unsafe { oc_ppu_jit_corpus_begin(self.handle, path.as_ptr()) } {
+            0 => Ok(()),
+            _ => Err(JitError::InvalidInput),
+        }
+    }
+
+    /// Stop writing the compile corpus
+    pub fn stop_corpus(&mut self) {
+        unsafe { oc_ppu_jit_corpus_end(self.handle) }
+    }
+
+    /// Number of units written to the compile corpus
+    pub fn corpus_count(&self) -> u64 {
+        unsafe { oc_ppu_jit_corpus_get_count(self.handle) }
+    }
+
+    /// Compile in the compile server while one is running (see
+    /// [`crate::compile_server`]); blocks fall back to in-process compiles
+    pub fn set_remote_compile(&mut self, enable: bool) {
+        unsafe { oc_ppu_jit_remote_compile_enable(self.handle, enable as i32) }
+    }
+
+    /// Check if remote compilation is enabled
+    pub fn remote_compile_enabled(&self) -> bool {
+        unsafe { oc_ppu_jit_remote_compile_is_enabled(self.handle) != 0 }
+    }
+
+    // ========== Code Quality APIs ==========
+
+    /// Code quality of the natively compiled block at `address`, if any
+    pub fn block_codegen(&self, address: u32) -> Option<PpuCodegenStats> {
+        let mut stats = PpuCodegenStats::default();
+        let result = unsafe { oc_ppu_jit_get_block_codegen(self.handle, address, &mut stats) };
+        if result == 0 { Some(stats) } else { None }
+    }
+
+    /// Code quality accumulated over native compiles, for one instruction
+    /// class or all of them (`None`)
+    pub fn codegen_stats(&self, op_class: Option<PpuOpClass>) -> PpuCodegenStats {
+        let mut stats = PpuCodegenStats::default();
+        let op_class = op_class.map_or(-1, |c| c as i32);
+        unsafe { oc_ppu_jit_get_codegen_stats(self.handle, op_class, &mut stats) };
+        stats
+    }
+
+    /// Reset accumulated code quality statistics
+    pub fn reset_codegen_stats(&mut self) {
+        unsafe { oc_ppu_jit_reset_codegen_stats(self.handle) }
+    }
+
+    // ========== Stack Slot Promotion APIs ==========
+
+    /// Enable or disable promotion of r1-relative stack slots to SSA values
+    /// for blocks compiled afterwards (enabled by default)
+    pub fn set_stack_promotion(&mut self, enable: bool) {
+        unsafe { oc_ppu_jit_stack_promotion_enable(self.handle, enable as i32) }
+    }
+
+    /// Check if stack slot promotion is enabled
+    pub fn stack_promotion_enabled(&self) -> bool {
+        unsafe { oc_ppu_jit_stack_promotion_is_enabled(self.handle) != 0 }
+    }
+
+    /// Run the stack frame analysis on a region's instruction words.
+    /// Returns the promotable slot and access counts, or `None` if nothing in
+    /// the region can be promoted.
+    pub fn stack_analyze(&self, instructions: &[u32]) -> Option<(u32, u32)> {
+        let mut slots = 0u32;
+        let mut accesses = 0u32;
+        let result = unsafe {
+            oc_ppu_jit_stack_analyze(self.handle, instructions.as_ptr(), instructions.len(),
+                                     &mut slots, &mut accesses)
+        };
+        if result != 0 { Some((slots, accesses)) } else { None }
+    }
+
+    /// Stack slot promotion statistics
+    pub fn stack_stats(&self) -> PpuStackPromotionStats {
+        let mut stats = PpuStackPromotionStats::default();
+        unsafe {
+            oc_ppu_jit_stack_get_stats(self.handle, &mut stats.regions_analyzed,
+                                       &mut stats.regions_promoted, &mut stats.slots_promoted,
+                                       &mut stats.accesses_promoted);
+        }
+        stats
+    }
+
+    /// Reset stack slot promotion statistics
+    pub fn reset_stack_stats(&mut self) {
+        unsafe { oc_ppu_jit_stack_reset_stats(self.handle) }
+    }
+
+    // ========== VMX Byte Order Folding APIs ==========
+
+    /// Plan VR byte reversals for a region's instruction words.
+    /// Returns the VMX instruction count, the reversals the emitter would
+    /// insert, and the eager load/store reversals that were avoided.
+    pub fn vmx_analyze(&self, instructions: &[u32]) -> (u32, u32, u32) {
+        let mut swaps = 0u32;
+        let mut folded = 0u32;
+        let vector = unsafe {
+            oc_ppu_jit_vmx_analyze(self.handle, instructions.as_ptr(), instructions.len(),
+                                   &mut swaps, &mut folded)
+        };
+        (vector as u32, swaps, folded)
+    }
+
+    // ========== Idiom Recognition APIs ==========
+
+    /// Enable or disable fusing PPC idioms into single operations for blocks
+    /// compiled afterwards (enabled by default)
+    pub fn set_idioms(&mut self, enable: bool) {
+        unsafe { oc_ppu_jit_idioms_enable(self.handle, enable as i32) }
+    }
+
+    /// Check if idiom recognition is enabled
+    pub fn idioms_enabled(&self) -> bool {
+        unsafe { oc_ppu_jit_idioms_is_enabled(self.handle) != 0 }
+    }
+
+    /// Recognize idioms in a region's instruction words without compiling it.
+    /// Returns the instructions covered by idioms and the per-kind idiom
+    /// counts, indexed by `PpuIdiom`.
+    pub fn idioms_analyze(&self, instructions: &[u32]) -> (u32, [u32; PPU_IDIOM_COUNT]) {
+        let mut counts = [0u32; PPU_IDIOM_COUNT];
+        let fused = unsafe {
+            oc_ppu_jit_idioms_analyze(self.handle, instructions.as_ptr(), instructions.len(),
+                                      counts.as_mut_ptr())
+        };
+        (fused as u32, counts)
+    }
+
+    /// Idiom recognition statistics
+    pub fn idiom_stats(&self) -> PpuIdiomStats {
+        let mut stats = PpuIdiomStats::default();
+        unsafe {
+            oc_ppu_jit_idioms_get_stats(self.handle, &mut stats.regions, stats.idioms.as_mut_ptr(),
+                                        &mut stats.instructions_fused);
+        }
+        stats
+    }
+
+    /// Reset idiom recognition statistics
+    pub fn reset_idiom_stats(&mut self) {
+        unsafe { oc_ppu_jit_idioms_reset_stats(self.handle) }
+    }
+
+    // ========== Jump Table APIs ==========
+
+    /// Register guest memory that never changes at runtime (read-only ELF
+    /// segments); jump tables are only recovered from registered memory
+    pub fn add_readonly_region(&self, guest_address: u32, data: &[u8]) -> Result<(), JitError> {
+        match unsafe { oc_ppu_jit_add_readonly_region(self.handle, guest_address, data.as_ptr(), data.len()) } {
+            0 => Ok(()),
+            _ => Err(JitError::InvalidInput),
+        }
+    }
+
+    /// Case targets and default target of the jump table recovered for the
+    /// compiled block at `address`, if any
+    pub fn jump_table(&self, address: u32) -> Option<(Vec<u32>, u32)> {
+        let mut default_target = 0u32;
+        let count = unsafe {
+            oc_ppu_jit_get_jump_table(self.handle, address, std::ptr::null_mut(), 0, &mut default_target)
+        };
+        if count == 0 {
+            return None;
+        }
+        let mut targets = vec![0u32; count];
+        unsafe {
+            oc_ppu_jit_get_jump_table(self.handle, address, targets.as_mut_ptr(), count, &mut default_target)
+        };
+        Some((targets, default_target))
+    }
+
+    // ========== Speculation APIs ==========
+
+    /// Record `target` as the target of the indirect branch at `branch`;
+    /// regions compiled afterwards guard on it
+    pub fn btb_add(&self, branch: u32, target: u32) {
+        unsafe { oc_ppu_jit_btb_add(self.handle, branch, target) }
+    }
+
+    /// Record that GPR `reg` holds `value` whenever the block at `block` is
+    /// entered; regions compiled afterwards guard on it
+    pub fn set_entry_constant(&self, block: u32, reg: u8, value: u64) {
+        unsafe { oc_ppu_jit_const_set_reg(self.handle, block, reg, value, block, 1) }
+    }
+
+    /// Guards of the compiled region at `address`, in instruction order
+    pub fn guards(&self, address: u32) -> Option<Vec<PpuGuardInfo>> {
+        let count = unsafe { oc_ppu_jit_get_guards(self.handle, address, std::ptr::null_mut(), 0) };
+        if count < 0 {
+            return None;
+        }
+        let mut guards = vec![PpuGuardInfo::default(); count as usize];
+        unsafe { oc_ppu_jit_get_guards(self.handle, address, guards.as_mut_ptr(), guards.len()) };
+        Some(guards)
+    }
+
+    // ========== On-Stack Replacement APIs ==========
+
+    /// Enable/disable on-stack replacement for regions compiled afterwards
+    pub fn set_osr(&mut self, enable: bool) {
+        unsafe { oc_ppu_jit_osr_enable(self.handle, enable as i32) }
+    }
+
+    /// Check if on-stack replacement is enabled
+    pub fn osr_enabled(&self) -> bool {
+        unsafe { oc_ppu_jit_osr_is_enabled(self.handle) != 0 }
+    }
+
+    /// Loop header the compiled region at `address` returns to on its
+    /// back-edge, if it has one
+    pub fn osr_loop_header(&self, address: u32) -> Option<u32> {
+        match unsafe { oc_ppu_jit_osr_get_loop_header(self.handle, address) } {
+            0 => None,
+            header => Some(header),
+        }
+    }
+
+    /// Compile the tier-2 loop of the region at `address` now rather than
+    /// once the dispatcher finds it hot. Returns false if the region has no
+    /// loop header.
+    pub fn osr_upgrade(&self, address: u32) -> Result<bool, JitError> {
+        match unsafe { oc_ppu_jit_osr_upgrade(self.handle, address) } {
+            1 => Ok(true),
+            0 => Ok(false),
+            -1 => Err(JitError::InvalidInput),
+            _ => Err(JitError::CompilationFailed),
+        }
+    }
+
+    /// On-stack replacement statistics
+    pub fn osr_stats(&self) -> PpuOsrStats {
+        let mut stats = PpuOsrStats::default();
+        unsafe {
+            oc_ppu_jit_osr_get_stats(self.handle, &mut stats.loop_regions, &mut stats.upgrades,
+                                     &mut stats.upgrade_failures);
+        }
+        stats
+    }
+
+    /// Promote the tiered entry at `address` (1 = baseline, 2 = optimizing);
+    /// tier 2 also upgrades a compiled loop region there
+    pub fn tiered_promote(&self, address: u32, tier: u8) -> bool {
+        unsafe { oc_ppu_jit_tiered_promote(self.handle, address, tier as i32) != 0 }
+    }
+
+    /// Speculation statistics
+    pub fn speculation_stats(&self) -> PpuSpeculationStats {
+        let mut stats = PpuSpeculationStats::default();
+        unsafe {
+            oc_ppu_jit_deopt_get_stats(self.handle, &mut stats.guards, &mut stats.deopts,
+                                       &mut stats.speculations_dropped);
+        }
+        stats
+    }
+}
+
+/// Guest instruction classes for code quality statistics
+#[repr(i32)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PpuOpClass {
+    Integer = 0,
+    LoadStore = 1,
+    Branch = 2,
+    Float = 3,
+    Vector = 4,
+    System = 5,
+}
+
+/// Emitted code quality; per-class host figures are apportioned by guest
+/// instruction count
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PpuCodegenStats {
+    pub blocks: u64,
+    pub guest_instructions: u64,
+    pub host_instructions: u64,
+    pub host_bytes: u64,
+    pub helper_calls: u64,
+    pub context_loads: u64,
+    pub context_stores: u64,
+}
+
+/// Stack slot promotion statistics
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PpuStackPromotionStats {
+    pub regions_analyzed: u64,
+    pub regions_promoted: u64,
+    pub slots_promoted: u64,
+    pub accesses_promoted: u64,
+}
+
+/// Number of PPC idiom kinds
+pub const PPU_IDIOM_COUNT: usize = 5;
+
+/// PPC idioms fused by the PPU JIT (mirrors `oc_ppu_idiom_t`)
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(usize)]
+pub enum PpuIdiom {
+    /// li/lis + ori/oris/addi/addis/sldi
+    Constant = 0,
+    /// rlwinm chains -> one rotate and mask
+    RotateMask = 1,
+    /// extsb/extsh/extsw/clrldi chains
+    Extend = 2,
+    /// rotlwi + rlwimi byte reversal -> bswap
+    ByteSwap = 3,
+    /// cmp* + bc ending the region
+    CompareBranch = 4,
+}
+
+/// Idiom recognition statistics
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PpuIdiomStats {
+    /// Regions with at least one idiom
+    pub regions: u64,
+    /// Idioms by kind, indexed by `PpuIdiom`
+    pub idioms: [u64; PPU_IDIOM_COUNT],
+    pub instructions_fused: u64,
+}
+
+/// A guard of a compiled region (mirrors `oc_ppu_guard_info_t`)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PpuGuardInfo {
+    /// 0 = GPR value, 1 = bcctr target
+    pub kind: i32,
+    /// GPR of a register value guard
+    pub reg: u32,
+    /// Resume address after a failure
+    pub guest_pc: u32,
+    pub instruction_index: u32,
+    /// Speculated value or branch target
+    pub expected: u64,
+    /// Registers the side exit stores
+    pub gprs: u32,
+    pub fprs: u32,
+    pub vrs: u32,
+    pub materialized: u32,
+}
+
+/// On-stack replacement statistics
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PpuOsrStats {
+    /// Regions compiled with a back-edge upgrade check
+    pub loop_regions: u64,
+    /// Tier-2 loops published to their region
+    pub upgrades: u64,
+    /// Tier-2 loops that failed to compile
+    pub upgrade_failures: u64,
+}
+
+/// Speculation statistics
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PpuSpeculationStats {
+    /// Guards placed in compiled regions
+    pub guards: u64,
+    /// Side exits taken
+    pub deopts: u64,
+    /// Speculations removed after repeated failures
+    pub speculations_dropped: u64,
+}
+
+/// LLVM pass pipeline for PPU compiles
+#[repr(i32)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PpuPassPipeline {
+    O0 = 0,
+    O1 = 1,
+    /// Default
+    O2 = 2,
+    O3 = 3,
+    /// Cheap cleanup only, for the baseline tier
+    Baseline = 4,
 }
 
 impl Drop for PpuJitCompiler {
@@ -805,6 +1533,10 @@ impl Drop for PpuJitCompiler {
 
 unsafe impl Send for PpuJitCompiler {}
 
+// The C++ JIT synchronizes internally (lock-free cache lookups, sharded
+// mutation), so a single compiler can be shared by all PPU threads.
+unsafe impl Sync for PpuJitCompiler {}
+
 /// Safe wrapper for SPU JIT compiler
 pub struct SpuJitCompiler {
     handle: *mut SpuJit,
@@ -834,6 +1566,22 @@ impl SpuJitCompiler {
         }
     }
 
+    /// Execute a compiled block
+    ///
+    /// # Returns
+    /// * `Ok(count)` - Number of instructions executed
+    /// * `Err(reason)` - Not compiled to native code, stopped or interrupted
+    pub fn execute(&self, context: &mut SpuContext, address: u32) -> Result<u32, SpuExitReason> {
+        let result = unsafe { oc_spu_jit_execute(self.handle, context, address) };
+        if result < 0 {
+            return Err(SpuExitReason::from(context.exit_reason));
+        }
+        match SpuExitReason::from(context.exit_reason) {
+            SpuExitReason::Normal | SpuExitReason::Branch => Ok(result as u32),
+            reason => Err(reason),
+        }
+    }
+
     /// Get compiled code for a given address
     /// 
     /// # Safety
@@ -905,6 +1653,39 @@ impl SpuJitCompiler {
     pub fn get_channel_op_count(&self) -> usize {
         unsafe { oc_spu_jit_get_channel_op_count(self.handle) }
     }
+
+    /// Set the callbacks compiled code calls for channel accesses that have
+    /// no inline path or would block. Takes effect for blocks compiled
+    /// afterwards.
+    pub fn set_channel_callbacks(&mut self, read: Option<SpuChannelReadFn>,
+                                 write: Option<SpuChannelWriteFn>) {
+        unsafe {
+            oc_spu_jit_set_channel_callbacks(
+                self.handle,
+                read.map_or(std::ptr::null_mut(), |f| f as *mut u8),
+                write.map_or(std::ptr::null_mut(), |f| f as *mut u8),
+            )
+        }
+    }
+
+    /// Set the rchcnt callback for channels whose count the runtime owns.
+    /// Without one, their count is read from `SpuContext::channel_count`.
+    pub fn set_channel_count_callback(&mut self, count: Option<SpuChannelCountFn>) {
+        unsafe {
+            oc_spu_jit_set_channel_count_callback(
+                self.handle, count.map_or(std::ptr::null_mut(), |f| f as *mut u8),
+            )
+        }
+    }
+
+    /// How compiled code accesses a channel
+    pub fn channel_fast_path(channel: u8, is_write: bool) -> SpuChannelPath {
+        match unsafe { oc_spu_jit_channel_fast_path(channel, is_write as i32) } {
+            1 => SpuChannelPath::Direct,
+            2 => SpuChannelPath::CountGated,
+            _ => SpuChannelPath::Callback,
+        }
+    }
     
     // ========================================================================
     // MFC DMA APIs
@@ -1191,6 +1972,16 @@ impl RsxShaderCompiler {
         Ok(spirv)
     }
     
+    /// Translate programs in the compile server while one is running
+    pub fn set_remote_compile(&mut self, enable: bool) {
+        unsafe { oc_rsx_shader_remote_compile_enable(self.handle, enable as i32) }
+    }
+    
+    /// Check if remote translation is enabled
+    pub fn remote_compile_enabled(&self) -> bool {
+        unsafe { oc_rsx_shader_remote_compile_is_enabled(self.handle) != 0 }
+    }
+    
     /// Link vertex and fragment shaders
     pub fn link(&mut self, vs_spirv: &[u32], fs_spirv: &[u32]) -> Result<(), JitError> {
         let result = unsafe {
@@ -1249,6 +2040,65 @@ impl RsxShaderCompiler {
     pub fn get_fragment_cache_count(&self) -> usize {
         unsafe { oc_rsx_shader_get_fragment_cache_count(self.handle) }
     }
+    
+    /// Start dumping every unique shader and pipeline state to an existing
+    /// corpus directory (replayed by the `rsx_shader_bench` tool)
+    pub fn start_corpus(&mut self, dir: &std::path::Path) -> Result<(), JitError> {
+        let dir = std::ffi::CString::new(dir.to_string_lossy().into_owned())
+            .map_err(|_| JitError::InvalidInput)?;
+        match unsafe { oc_rsx_shader_corpus_begin(self.handle, dir.as_ptr()) } {
+            0 => Ok(()),
+            _ => Err(JitError::InvalidInput),
+        }
+    }
+    
+    /// Stop dumping the shader corpus
+    pub fn stop_corpus(&mut self) {
+        unsafe { oc_rsx_shader_corpus_end(self.handle) }
+    }
+    
+    /// Shaders and pipelines written to the corpus: (vertex, fragment, pipelines)
+    pub fn corpus_stats(&self) -> (u64, u64, u64) {
+        let (mut vertex, mut fragment, mut pipelines) = (0u64, 0u64, 0u64);
+        unsafe { oc_rsx_shader_corpus_get_stats(self.handle, &mut vertex, &mut fragment, &mut pipelines) };
+        (vertex, fragment, pipelines)
+    }
+    
+    /// Get the number of vec4 constants in a constant file
+    pub fn constant_count(&self, file: RsxConstFile) -> u32 {
+        unsafe { oc_rsx_constants_get_count(self.handle, file as i32) }
+    }
+    
+    /// Mirror guest constant writes starting at constant `first`
+    pub fn write_constants(&mut self, file: RsxConstFile, first: u32, data: &[[f32; 4]]) -> Result<(), JitError> {
+        let result = unsafe {
+            oc_rsx_constants_write(self.handle, file as i32, first, data.as_ptr() as *const f32, data.len() as u32)
+        };
+        if result == 0 { Ok(()) } else { Err(JitError::InvalidInput) }
+    }
+    
+    /// Compute the constant ranges that changed since the last flush
+    pub fn flush_constants(&mut self, file: RsxConstFile, max_ranges: usize) -> RsxConstFlush {
+        let mut flush = RsxConstFlush {
+            ranges: vec![RsxConstRange::default(); max_ranges.max(1)],
+            ..Default::default()
+        };
+        let mut count = 0usize;
+        let result = unsafe {
+            oc_rsx_constants_flush(
+                self.handle, file as i32, flush.ranges.as_mut_ptr(), flush.ranges.len(),
+                &mut count, &mut flush.hash,
+            )
+        };
+        flush.ranges.truncate(count);
+        flush.reused = result == 2;
+        flush
+    }
+    
+    /// Make the next flush upload the whole constant file
+    pub fn invalidate_constants(&mut self, file: RsxConstFile) {
+        unsafe { oc_rsx_constants_invalidate(self.handle, file as i32) }
+    }
 }
 
 impl Drop for RsxShaderCompiler {
@@ -1431,7 +2281,7 @@ mod tests {
 
     #[test]
     fn test_ppu_jit_compile() {
-        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
         // Simple PPU instruction: nop (ori r0, r0, 0) = 0x60000000
         let code = [0x60, 0x00, 0x00, 0x00];
         let result = jit.compile(0x1000, &code);
@@ -1494,6 +2344,60 @@ mod tests {
         jit.clear_cache();
     }
 
+    #[test]
+    fn test_ppu_is_compiled() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        assert!(!jit.is_compiled(0x1000));
+        jit.compile(0x1000, &[0x60, 0x00, 0x00, 0x00]).expect("Compilation failed");
+        assert!(jit.is_compiled(0x1000));
+        assert!(!jit.is_compiled(0x1004));
+        jit.invalidate(0x1000);
+        assert!(!jit.is_compiled(0x1000));
+    }
+
+    #[test]
+    fn test_ppu_get_compiled_outlives_invalidate() {
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        jit.compile(0x1000, &[0x60, 0x00, 0x00, 0x00]).expect("Compilation failed");
+        let code = jit.get_compiled(0x1000).expect("Should have compiled code");
+        let first = unsafe { code.read_volatile() };
+
+        // Retired blocks are reclaimed right away with no reader open, but
+        // code already handed out must stay readable
+        jit.invalidate(0x1000);
+        jit.clear_cache();
+        for i in 0..64u32 {
+            jit.compile(0x2000 + i * 4, &[0x60, 0x00, 0x00, 0x00]).expect("Compilation failed");
+        }
+        assert_eq!(unsafe { code.read_volatile() }, first);
+    }
+
+    #[test]
+    fn test_ppu_jit_shared_across_threads() {
+        let jit = std::sync::Arc::new(PpuJitCompiler::new().expect("JIT creation failed"));
+        let code = [0x60, 0x00, 0x00, 0x00];
+
+        let handles: Vec<_> = (0..4u32)
+            .map(|t| {
+                let jit = jit.clone();
+                std::thread::spawn(move || {
+                    for i in 0..256u32 {
+                        let address = 0x10000 + ((i * 4 + t) % 512) * 4;
+                        jit.compile(address, &code).expect("Compilation failed");
+                        if i % 8 == 0 {
+                            jit.invalidate(address);
+                        } else {
+                            let _ = jit.get_compiled(address);
+                        }
+                    }
+                })
+            })
+            .collect();
+        for handle in handles {
+            handle.join().expect("worker panicked");
+        }
+    }
+
     #[test]
     fn test_spu_cache_operations() {
         let mut jit = SpuJitCompiler::new().expect("JIT creation failed");
@@ -1580,6 +2484,641 @@ mod tests {
         assert!(!jit.trace_is_header(0x1000));
     }
 
+    #[test]
+    fn test_ppu_warm_start_roundtrip() {
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        jit.trace_detect(0x1000, &[0x1000u32, 0x1010], 0x1000);
+        let profile = jit.warm_start_export(0);
+        assert!(profile.len() > 12);
+
+        // Seeds come back on a fresh compiler and compile from guest memory
+        let fresh = PpuJitCompiler::new().expect("JIT creation failed");
+        assert_eq!(fresh.warm_start_import(&profile), Ok(1));
+        assert_eq!(fresh.warm_start_pending(), 1);
+
+        let mut memory = vec![0u8; 0x2000];
+        memory[0x1000..0x1004].copy_from_slice(&[0x60, 0x00, 0x00, 0x00]);
+        assert_eq!(fresh.warm_start_submit(memory.as_ptr(), memory.len() as u64, 16), 1);
+        assert_eq!(fresh.warm_start_pending(), 0);
+        assert!(fresh.get_compiled(0x1000).is_some());
+        assert!(fresh.trace_is_header(0x1000));
+
+        // Garbage is rejected
+        assert!(fresh.warm_start_import(&[1, 2, 3]).is_err());
+    }
+
+    #[test]
+    fn test_ppu_warm_start_counts_dispatches() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        // addi r3, r3, 1; blr
+        let code = [0x38, 0x63, 0x00, 0x01, 0x4E, 0x80, 0x00, 0x20];
+        jit.compile(0x1000, &code).expect("compile failed");
+        if jit.block_codegen(0x1000).is_none() {
+            return;
+        }
+        let mut memory = vec![0u8; 0x2000];
+        let mut ctx = PpuContext {
+            memory_base: memory.as_mut_ptr(),
+            memory_size: 0x2000,
+            ..Default::default()
+        };
+        for _ in 0..3 {
+            jit.execute(&mut ctx, 0x1000).unwrap();
+        }
+
+        // Collected with the profiler off: one entry at 0x1000, run 3 times
+        let profile = jit.warm_start_export(0);
+        assert_eq!(u32::from_le_bytes(profile[8..12].try_into().unwrap()), 1);
+        assert_eq!(u32::from_le_bytes(profile[12..16].try_into().unwrap()), 0x1000);
+        assert_eq!(u64::from_le_bytes(profile[20..28].try_into().unwrap()), 3);
+        assert_eq!(profile[28], 1);
+    }
+
+    #[test]
+    fn test_ppu_compile_corpus() {
+        let path = std::env::temp_dir().join(format!("oc_ppu_corpus_{}.crp", std::process::id()));
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        assert_eq!(jit.pass_pipeline(), PpuPassPipeline::O2);
+        jit.set_pass_pipeline(PpuPassPipeline::Baseline);
+        assert_eq!(jit.pass_pipeline(), PpuPassPipeline::Baseline);
+
+        jit.start_corpus(&path).unwrap();
+        assert!(jit.start_corpus(&path).is_err());
+        // addi r3, r3, 1; blr
+        let code = [0x38u8, 0x63, 0x00, 0x01, 0x4E, 0x80, 0x00, 0x20];
+        jit.compile(0x1000, &code).unwrap();
+        jit.invalidate(0x1000);
+        jit.compile(0x1000, &code).unwrap();
+        jit.compile(0x2000, &code).unwrap();
+        jit.stop_corpus();
+        // Recompiling unchanged code is not written twice
+        assert_eq!(jit.corpus_count(), 2);
+
+        let data = std::fs::read(&path).unwrap();
+        assert_eq!(&data[..8], b"OCPPUCRP");
+        // Header, then two 36-byte units with two instruction words each
+        assert_eq!(data.len(), 16 + 2 * (36 + 8));
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_remote_compile_falls_back_without_server() {
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        assert!(!jit.remote_compile_enabled());
+        jit.set_remote_compile(true);
+        assert!(jit.remote_compile_enabled());
+        // addi r3, r3, 1; blr
+        let code = [0x38u8, 0x63, 0x00, 0x01, 0x4E, 0x80, 0x00, 0x20];
+        jit.compile(0x3000, &code).unwrap();
+        assert!(jit.get_compiled(0x3000).is_some());
+
+        let mut shader = RsxShaderCompiler::new().expect("shader compiler creation failed");
+        shader.set_remote_compile(true);
+        assert!(shader.remote_compile_enabled());
+        assert!(!shader.compile_vertex(&[0x0040_1c6c, 0x0040_0000]).unwrap().is_empty());
+    }
+
+    #[test]
+    fn test_ppu_codegen_stats() {
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        // addi r3, r3, 1; lwz r6, 0(r1); blr
+        let code = [0x38u8, 0x63, 0x00, 0x01, 0x80, 0xC1, 0x00, 0x00, 0x4E, 0x80, 0x00, 0x20];
+        jit.compile(0x1000, &code).unwrap();
+
+        let total = jit.codegen_stats(None);
+        match jit.block_codegen(0x1000) {
+            Some(block) => {
+                // Native code: measured and aggregated
+                assert_eq!(block.guest_instructions, 3);
+                assert!(block.host_bytes > 0);
+                assert_eq!(total.blocks, 1);
+                assert_eq!(jit.codegen_stats(Some(PpuOpClass::LoadStore)).guest_instructions, 1);
+                assert_eq!(jit.codegen_stats(Some(PpuOpClass::Float)).blocks, 0);
+            }
+            // Interpreter placeholders are not native code
+            None => assert_eq!(total, PpuCodegenStats::default()),
+        }
+        assert!(jit.block_codegen(0x2000).is_none());
+
+        jit.reset_codegen_stats();
+        assert_eq!(jit.codegen_stats(None), PpuCodegenStats::default());
+    }
+
+    #[test]
+    fn test_ppu_stack_promotion() {
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        assert!(jit.stack_promotion_enabled());
+
+        // stwu r1,-32(r1); stw r3,8(r1); lwz r4,8(r1); addi r1,r1,32; blr
+        let frame = [0x9421_FFE0, 0x9061_0008, 0x8081_0008, 0x3821_0020, 0x4E80_0020];
+        assert_eq!(jit.stack_analyze(&frame), Some((1, 2)));
+
+        // addi r3,r1,8 takes the slot's address, so nothing is promoted
+        let escaping = [0x9421_FFE0, 0x9061_0008, 0x3861_0008, 0x8081_0008, 0x3821_0020, 0x4E80_0020];
+        assert_eq!(jit.stack_analyze(&escaping), None);
+
+        assert_eq!(jit.stack_stats(), PpuStackPromotionStats {
+            regions_analyzed: 2,
+            regions_promoted: 1,
+            slots_promoted: 1,
+            accesses_promoted: 2,
+        });
+        jit.reset_stack_stats();
+        assert_eq!(jit.stack_stats(), PpuStackPromotionStats::default());
+
+        jit.set_stack_promotion(false);
+        assert!(!jit.stack_promotion_enabled());
+    }
+
+    #[test]
+    fn test_ppu_vmx_byte_order_plan() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let vx = |xo: u32, vt: u32, va: u32, vb: u32| (4 << 26) | (vt << 21) | (va << 16) | (vb << 11) | xo;
+        let va_form = |xo: u32, vt: u32, va: u32, vb: u32, vc: u32| vx(xo, vt, va, vb) | (vc << 6);
+        let lvx = |vt: u32| (31 << 26) | (vt << 21) | (4 << 11) | (103 << 1);
+        let stvx = |vs: u32| (31 << 26) | (vs << 21) | (4 << 11) | (231 << 1);
+        let splat = |vt: u32| vx(908, vt, 1, 0);
+
+        // (region, VMX instructions, swaps emitted, swaps folded)
+        let cases: &[(&str, Vec<u32>, (u32, u32, u32))] = &[
+            ("bitwise between memory ops needs no swap",
+             vec![lvx(1), lvx(2), vx(1028, 3, 1, 2), stvx(3)], (4, 0, 3)),
+            ("elementwise swaps its loads and the store",
+             vec![lvx(1), lvx(2), vx(10, 3, 1, 2), stvx(3)], (4, 3, 0)),
+            ("reversed values stay reversed across elementwise ops",
+             vec![lvx(1), lvx(2), vx(10, 3, 1, 2), vx(128, 4, 3, 1), stvx(4)], (5, 3, 0)),
+            ("vmulesh picks even lanes",
+             vec![splat(1), splat(2), vx(840, 3, 1, 2)], (3, 2, 0)),
+            ("vmaxsw and vminsw are elementwise",
+             vec![splat(1), splat(2), vx(386, 3, 1, 2), vx(898, 4, 3, 1)], (4, 0, 0)),
+            ("vupkhsh and vupklsh read lanes of vb",
+             vec![splat(1), vx(590, 2, 0, 1), vx(718, 3, 0, 1)], (3, 1, 0)),
+            ("pack and merge are lane ordered",
+             vec![splat(1), splat(2), vx(14, 3, 1, 2), vx(140, 4, 1, 2)], (4, 2, 0)),
+            ("vperm needs guest order in all three sources",
+             vec![splat(1), splat(2), splat(3), va_form(43, 4, 1, 2, 3)], (4, 3, 0)),
+            ("vsel follows its operands' layout",
+             vec![splat(1), splat(2), splat(3), va_form(42, 4, 1, 2, 3)], (4, 0, 0)),
+            ("values left reversed at the exit need no swap",
+             vec![lvx(1), vx(10, 2, 1, 1)], (2, 1, 0)),
+            // vmulesb, vupkhpx and vupklpx are not emitted
+            ("unemitted ops do not touch VRs",
+             vec![vx(776, 3, 1, 2), vx(846, 2, 0, 1), vx(974, 2, 0, 1)], (0, 0, 0)),
+        ];
+        for (name, region, expected) in cases {
+            assert_eq!(jit.vmx_analyze(region), *expected, "{}", name);
+        }
+    }
+
+    #[test]
+    fn test_ppu_idiom_recognition() {
+        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        assert!(jit.idioms_enabled());
+        let rotate = |op: u32, ra: u32, rs: u32, sh: u32, mb: u32, me: u32| {
+            (op << 26) | (rs << 21) | (ra << 16) | (sh << 11) | (mb << 6) | (me << 1)
+        };
+        let rlwinm = |ra, rs, sh, mb, me| rotate(21, ra, rs, sh, mb, me);
+        let rlwimi = |ra, rs, sh, mb, me| rotate(20, ra, rs, sh, mb, me);
+        let ext = |xo: u32, ra: u32, rs: u32| (31 << 26) | (rs << 21) | (ra << 16) | (xo << 1);
+        let (extsb, extsh, extsw) = (|ra, rs| ext(954, ra, rs), |ra, rs| ext(922, ra, rs), |ra, rs| ext(986, ra, rs));
+        let clrldi = |ra: u32, rs: u32, n: u32| (30 << 26) | (rs << 21) | (ra << 16) | ((n & 31) << 6) | ((n >> 5) << 5);
+        let one = |idiom: PpuIdiom| {
+            let mut counts = [0u32; PPU_IDIOM_COUNT];
+            counts[idiom as usize] = 1;
+            counts
+        };
+        let none = [0u32; PPU_IDIOM_COUNT];
+
+        // (region, instructions fused, idioms by kind)
+        let cases: &[(&str, Vec<u32>, (u32, [u32; PPU_IDIOM_COUNT]))] = &[
+            ("rlwinm chain",
+             vec![rlwinm(3, 4, 8, 0, 23), rlwinm(3, 3, 4, 16, 31)], (2, one(PpuIdiom::RotateMask))),
+            ("wrapping first mask is narrowed by the next",
+             vec![rlwinm(3, 4, 8, 28, 3), rlwinm(3, 3, 0, 16, 31)], (2, one(PpuIdiom::RotateMask))),
+            ("wrapping last mask ends the chain",
+             vec![rlwinm(3, 4, 8, 0, 23), rlwinm(3, 3, 0, 28, 3)], (0, none)),
+            ("wrapping mask on its own",
+             vec![rlwinm(3, 4, 8, 28, 3), 0x6000_0000], (0, none)),
+            ("rlwinm chain through another register",
+             vec![rlwinm(3, 4, 8, 0, 23), rlwinm(5, 3, 4, 16, 31)], (0, none)),
+            ("narrower extension wins",
+             vec![extsw(3, 4), extsh(3, 3), extsb(3, 3)], (3, one(PpuIdiom::Extend))),
+            ("sign extension of a zero extension",
+             vec![clrldi(3, 4, 32), extsb(3, 3)], (2, one(PpuIdiom::Extend))),
+            ("zero extension after a narrower sign extension stops",
+             vec![extsb(3, 4), clrldi(3, 3, 32)], (0, none)),
+            ("zero extension after a narrower sign extension ends a chain",
+             vec![extsh(3, 4), extsb(3, 3), clrldi(3, 3, 32)], (2, one(PpuIdiom::Extend))),
+            ("extension into another register stops",
+             vec![extsb(3, 4), extsh(5, 3)], (0, none)),
+            ("word byte swap",
+             vec![rlwinm(3, 4, 8, 0, 31), rlwimi(3, 4, 24, 0, 7), rlwimi(3, 4, 24, 16, 23)],
+             (3, one(PpuIdiom::ByteSwap))),
+            ("word byte swap, inserts reversed",
+             vec![rlwinm(3, 4, 8, 0, 31), rlwimi(3, 4, 24, 16, 23), rlwimi(3, 4, 24, 0, 7)],
+             (3, one(PpuIdiom::ByteSwap))),
+            ("halfword byte swap",
+             vec![rlwinm(3, 4, 24, 24, 31), rlwimi(3, 4, 8, 16, 23)], (2, one(PpuIdiom::ByteSwap))),
+            ("halfword byte swap, halves reversed",
+             vec![rlwinm(3, 4, 8, 16, 23), rlwimi(3, 4, 24, 24, 31)], (2, one(PpuIdiom::ByteSwap))),
+            ("byte swap in place",
+             vec![rlwinm(4, 4, 8, 0, 31), rlwimi(4, 4, 24, 0, 7), rlwimi(4, 4, 24, 16, 23)], (0, none)),
+            ("cmpwi + beq ending the region",
+             vec![0x2C03_0005, 0x4182_0010], (2, one(PpuIdiom::CompareBranch))),
+            ("cmplw cr7 + bgt cr7",
+             vec![0x7F83_2040, 0x419D_0010], (2, one(PpuIdiom::CompareBranch))),
+            ("compare + branch not ending the region",
+             vec![0x2C03_0005, 0x4182_0010, 0x6000_0000], (0, none)),
+            ("branch on another CR field",
+             vec![0x2C83_0005, 0x4182_0010], (0, none)),
+            ("branch on SO",
+             vec![0x2C03_0005, 0x4183_0010], (0, none)),
+            ("bdnz is not a plain conditional",
+             vec![0x2C03_0005, 0x4200_0010], (0, none)),
+        ];
+        for (name, region, expected) in cases {
+            assert_eq!(jit.idioms_analyze(region), *expected, "{}", name);
+        }
+
+        let stats = jit.idiom_stats();
+        assert_eq!(stats.regions, 11);
+        assert_eq!(stats.idioms, [0, 2, 3, 4, 2]);
+        assert_eq!(stats.instructions_fused, 25);
+        jit.reset_idiom_stats();
+        assert_eq!(jit.idiom_stats(), PpuIdiomStats::default());
+
+        jit.set_idioms(false);
+        assert!(!jit.idioms_enabled());
+    }
+
+    #[test]
+    fn test_ppu_compare_branch_idiom_updates_cr() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let mut memory = vec![0u8; 0x10000];
+        let memory_base = memory.as_mut_ptr();
+        let run = |address: u32, words: &[u32], r3: u64, r4: u64, so: bool| {
+            let code: Vec<u8> = words.iter().flat_map(|w| w.to_be_bytes()).collect();
+            jit.compile(address, &code).unwrap();
+            jit.block_codegen(address)?;
+            let mut gpr = [0u64; 32];
+            gpr[3] = r3;
+            gpr[4] = r4;
+            let xer = if so { 0x8000_0000 } else { 0 };
+            let mut ctx = PpuContext { gpr, xer, cr: 0xFFFF_FFFF, memory_base, memory_size: 0x10000, ..Default::default() };
+            jit.execute(&mut ctx, address).unwrap();
+            Some(ctx)
+        };
+
+        // The fused branch still leaves the compare's result in CR, with SO
+        // copied from XER, and the other fields untouched
+        // (region, r3, r4, XER[SO], CR, next PC)
+        let cases: &[(&str, u32, Vec<u32>, u64, u64, bool, u32, u64)] = &[
+            ("cmpwi equal takes beq", 0x1000, vec![0x2C03_0005, 0x4182_0010], 5, 0, false,
+             0x2FFF_FFFF, 0x1014),
+            ("cmpwi less falls through", 0x1100, vec![0x2C03_0005, 0x4182_0010], (-3i64) as u64, 0, false,
+             0x8FFF_FFFF, 0x1108),
+            ("cmpwi records SO", 0x1200, vec![0x2C03_0005, 0x4182_0010], 9, 0, true,
+             0x5FFF_FFFF, 0x1208),
+            ("cmplw cr7 greater takes bgt cr7", 0x1300, vec![0x7F83_2040, 0x419D_0010], 7, 2, false,
+             0xFFFF_FFF4, 0x1314),
+            ("cmplw is unsigned", 0x1400, vec![0x7F83_2040, 0x419D_0010], 0xFFFF_FFFF, 2, false,
+             0xFFFF_FFF4, 0x1414),
+            ("cmpw cr7 less skips bgt cr7", 0x1500, vec![0x7F83_2000, 0x419D_0010], (-1i64) as u64, 2, false,
+             0xFFFF_FFF8, 0x1508),
+        ];
+        for (name, address, region, r3, r4, so, cr, next_pc) in cases {
+            assert_eq!(jit.idioms_analyze(region).1[PpuIdiom::CompareBranch as usize], 1, "{}", name);
+            // Interpreter placeholders cannot be run natively
+            let Some(ctx) = run(*address, region, *r3, *r4, *so) else { return };
+            assert_eq!((ctx.cr, ctx.next_pc), (*cr, *next_pc), "{}", name);
+        }
+    }
+
+    #[test]
+    fn test_ppu_spr_moves() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        // mtctr r3; mflr r4; mtlr r5; mfctr r6; mfxer r7; nop
+        let code: Vec<u8> = [0x7C69_03A6u32, 0x7C88_02A6, 0x7CA8_03A6, 0x7CC9_02A6, 0x7CE1_02A6,
+                             0x6000_0000]
+            .iter().flat_map(|w| w.to_be_bytes()).collect();
+        jit.compile(0x1000, &code).unwrap();
+
+        // Interpreter placeholders cannot be run natively
+        if jit.block_codegen(0x1000).is_none() {
+            return;
+        }
+        let mut memory = vec![0u8; 0x10000];
+        let mut gpr = [0u64; 32];
+        gpr[3] = 0x1234;
+        gpr[5] = 0x9ABC;
+        let mut ctx = PpuContext {
+            gpr,
+            lr: 0x5678,
+            xer: 0x2000_0000,
+            memory_base: memory.as_mut_ptr(),
+            memory_size: 0x10000,
+            ..Default::default()
+        };
+        jit.execute(&mut ctx, 0x1000).unwrap();
+        // SPR 8 is LR, 9 is CTR and 1 is XER, with the field halves swapped
+        assert_eq!((ctx.ctr, ctx.lr), (0x1234, 0x9ABC));
+        assert_eq!((ctx.gpr[4], ctx.gpr[6], ctx.gpr[7]), (0x5678, 0x1234, 0x2000_0000));
+    }
+
+    #[test]
+    fn test_ppu_region_successor() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let mut memory = vec![0u8; 0x10000];
+        let memory_base = memory.as_mut_ptr();
+        let run = |address: u32, words: &[u32], r3: u64, lr: u64, ctr: u64| {
+            let code: Vec<u8> = words.iter().flat_map(|w| w.to_be_bytes()).collect();
+            jit.compile(address, &code).unwrap();
+            jit.block_codegen(address)?;
+            let mut gpr = [0u64; 32];
+            gpr[3] = r3;
+            let mut ctx = PpuContext { gpr, lr, ctr, memory_base, memory_size: 0x10000, ..Default::default() };
+            let result = jit.execute(&mut ctx, address);
+            Some((result, ctx))
+        };
+
+        // Interpreter placeholders cannot be run natively
+        let Some((_, ctx)) = run(0x1000, &[0x4E80_0020], 0, 0x5678, 0) else { return };
+        assert_eq!(ctx.next_pc, 0x5678);
+        // blrl goes to the old LR
+        let (_, ctx) = run(0x1100, &[0x4E80_0021], 0, 0x5678, 0).unwrap();
+        assert_eq!((ctx.next_pc, ctx.lr), (0x5678, 0x1104));
+        // cmpwi r3,5; beq +0x10
+        let (_, ctx) = run(0x1300, &[0x2C03_0005, 0x4182_0010], 5, 0, 0).unwrap();
+        assert_eq!(ctx.next_pc, 0x1314);
+        let (_, ctx) = run(0x1400, &[0x2C03_0005, 0x4182_0010], 6, 0, 0).unwrap();
+        assert_eq!(ctx.next_pc, 0x1408);
+        // bdnz sees the decremented CTR
+        let (_, ctx) = run(0x1500, &[0x4200_0010], 0, 0, 1).unwrap();
+        assert_eq!((ctx.next_pc, ctx.ctr), (0x1504, 0));
+        // bctr
+        let (_, ctx) = run(0x1800, &[0x4E80_0420], 0, 0, 0x2003).unwrap();
+        assert_eq!(ctx.next_pc, 0x2000);
+        // addi r3,r3,1; sc: the interpreter performs the sc
+        let (result, ctx) = run(0x1700, &[0x3863_0001, 0x4400_0002], 0, 0, 0).unwrap();
+        assert_eq!(result, Err(PpuExitReason::Syscall));
+        assert_eq!((ctx.next_pc, ctx.gpr[3], ctx.instructions_executed), (0x1704, 1, 1));
+    }
+
+    #[test]
+    fn test_ppu_recompile_after_invalidate() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        // addi r3,r3,1; blr
+        jit.compile(0x1000, &[0x38, 0x63, 0x00, 0x01, 0x4E, 0x80, 0x00, 0x20]).unwrap();
+        if jit.block_codegen(0x1000).is_none() {
+            return;
+        }
+        jit.invalidate(0x1000);
+        // addi r3,r3,2; blr: linked next to the first compile's code
+        jit.compile(0x1000, &[0x38, 0x63, 0x00, 0x02, 0x4E, 0x80, 0x00, 0x20]).unwrap();
+        assert!(jit.block_codegen(0x1000).is_some());
+
+        let mut memory = vec![0u8; 0x1000];
+        let mut ctx = PpuContext {
+            lr: 0x2000,
+            memory_base: memory.as_mut_ptr(),
+            memory_size: 0x1000,
+            ..Default::default()
+        };
+        jit.execute(&mut ctx, 0x1000).unwrap();
+        assert_eq!(ctx.gpr[3], 2);
+    }
+
+    #[test]
+    fn test_ppu_inline_dependents() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let words = |words: &[u32]| -> Vec<u8> { words.iter().flat_map(|w| w.to_be_bytes()).collect() };
+        // addi r3,r3,5; blr, inlined into the bl 0x8000 at 0x1000
+        jit.add_readonly_region(0x8000, &words(&[0x3863_0005, 0x4E80_0020])).unwrap();
+        let caller = words(&[0x4800_7001, 0x4E80_0020]);
+        jit.compile(0x1000, &caller).unwrap();
+        if jit.block_codegen(0x1000).is_none() {
+            return;
+        }
+
+        // Invalidating any word of the callee drops the caller
+        jit.invalidate(0x8004);
+        assert!(jit.get_compiled(0x1000).is_none());
+
+        // A recompile without the call replaces the caller's dependencies
+        jit.compile(0x1000, &caller).unwrap();
+        jit.invalidate(0x1000);
+        jit.compile(0x1000, &words(&[0x3863_0001, 0x4E80_0020])).unwrap();
+        jit.invalidate(0x8000);
+        assert!(jit.get_compiled(0x1000).is_some());
+    }
+
+    #[test]
+    fn test_ppu_branch_target_chain() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let words = |words: &[u32]| -> Vec<u8> { words.iter().flat_map(|w| w.to_be_bytes()).collect() };
+        // mtctr r5; addi r3,r3,1; bctr, predicted to reach 0x3000
+        jit.btb_add(0x2008, 0x3000);
+        jit.compile(0x2000, &words(&[0x7CA9_03A6, 0x3863_0001, 0x4E80_0420])).unwrap();
+        // addi r3,r3,100; blr
+        jit.compile(0x3000, &words(&[0x3863_0064, 0x4E80_0020])).unwrap();
+        if jit.block_codegen(0x2000).is_none() {
+            return;
+        }
+
+        let mut memory = vec![0u8; 0x10000];
+        let mut run = || {
+            let mut gpr = [0u64; 32];
+            gpr[5] = 0x3000;
+            let mut ctx = PpuContext {
+                gpr,
+                lr: 0x1234,
+                memory_base: memory.as_mut_ptr(),
+                memory_size: 0x10000,
+                ..Default::default()
+            };
+            jit.execute(&mut ctx, 0x2000).unwrap();
+            (ctx.pc, ctx.gpr[3], ctx.instructions_executed)
+        };
+        // The first run returns at the target and links the two blocks
+        assert_eq!(run(), (0x3000, 1, 3));
+        assert_eq!(run(), (0x1234, 101, 5));
+        // Invalidating the target breaks the link
+        jit.invalidate(0x3000);
+        assert_eq!(run(), (0x3000, 1, 3));
+    }
+
+    #[test]
+    fn test_ppu_osr_counted_loop() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        assert!(jit.osr_enabled());
+        // 0x1000: addi r3,r3,1; cmpw r3,r4; blt 0x1000
+        let code: Vec<u8> = [0x3863_0001u32, 0x7C03_2000, 0x4180_FFF8]
+            .iter()
+            .flat_map(|w| w.to_be_bytes())
+            .collect();
+        jit.compile(0x1000, &code).unwrap();
+        assert_eq!(jit.osr_loop_header(0x1000), Some(0x1000));
+        if jit.block_codegen(0x1000).is_none() {
+            return;
+        }
+
+        let mut memory = vec![0u8; 0x1000];
+        let mut ctx = PpuContext {
+            memory_base: memory.as_mut_ptr(),
+            memory_size: 0x1000,
+            budget_enabled: 1,
+            instruction_budget: i64::MAX,
+            ..Default::default()
+        };
+        ctx.gpr[4] = 100_000;
+        let mut dispatches = 0;
+        loop {
+            jit.execute(&mut ctx, 0x1000).unwrap();
+            dispatches += 1;
+            if ctx.pc != 0x1000 {
+                break;
+            }
+        }
+        // The dispatcher upgrades the loop once it is hot, and tier 2 runs
+        // the rest of it without coming back
+        assert_eq!((ctx.pc, ctx.gpr[3]), (0x100C, 100_000));
+        assert_eq!(jit.osr_stats().upgrades, 1);
+        assert!(dispatches <= 1001, "{} dispatches", dispatches);
+        assert_eq!(jit.osr_upgrade(0x1000), Ok(true));
+
+        // Without a budget, tier 2 still hands control back now and then
+        ctx.gpr[3] = 0;
+        ctx.gpr[4] = 1 << 20;
+        ctx.budget_enabled = 0;
+        ctx.instruction_budget = 0;
+        jit.execute(&mut ctx, 0x1000).unwrap();
+        assert_eq!((ctx.pc, ctx.gpr[3]), (0x1000, 1 + (1 << 16)));
+        while ctx.pc == 0x1000 {
+            jit.execute(&mut ctx, 0x1000).unwrap();
+        }
+        assert_eq!(ctx.gpr[3], 1 << 20);
+    }
+
+    #[test]
+    fn test_ppu_jump_table_dispatch() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let table: Vec<u8> = [0x5000u32, 0x5100, 0x5200].iter().flat_map(|t| t.to_be_bytes()).collect();
+        jit.add_readonly_region(0x10000, &table).unwrap();
+        // cmplwi r3,2; bgt 0x4044; lis r4,1; addi r4,r4,0; slwi r5,r3,2;
+        // lwzx r6,r4,r5; mtctr r6; bctr
+        let code: Vec<u8> = [0x2803_0002u32, 0x4181_0040, 0x3C80_0001, 0x3884_0000, 0x5465_103A,
+                             0x7CC4_282E, 0x7CC9_03A6, 0x4E80_0420]
+            .iter().flat_map(|w| w.to_be_bytes()).collect();
+        jit.compile(0x4000, &code).unwrap();
+        assert_eq!(jit.jump_table(0x4000), Some((vec![0x5000, 0x5100, 0x5200], 0x4044)));
+
+        // Interpreter placeholders cannot be run natively
+        if jit.block_codegen(0x4000).is_none() {
+            return;
+        }
+        let mut memory = vec![0u8; 0x20000];
+        memory[0x10000..0x1000C].copy_from_slice(&table);
+        let memory_base = memory.as_mut_ptr();
+        let run = |index: u64| {
+            let mut gpr = [0u64; 32];
+            gpr[3] = index;
+            gpr[4] = 0xAA;
+            gpr[5] = 0xBB;
+            gpr[6] = 0xCC;
+            let mut ctx = PpuContext { gpr, ctr: 0xDD, memory_base, memory_size: 0x20000, ..Default::default() };
+            jit.execute(&mut ctx, 0x4000).unwrap();
+            ctx
+        };
+
+        // In range: the dispatch sequence runs and the case target is taken;
+        // cmplwi only looks at the low word
+        for (index, target) in [(0u64, 0x5000u64), (1, 0x5100), (2, 0x5200), (0x1_0000_0001, 0x5100)] {
+            let ctx = run(index);
+            assert_eq!(ctx.next_pc, target);
+            assert_eq!((ctx.gpr[4], ctx.gpr[5] as u32), (0x10000, (index as u32) << 2));
+            assert_eq!(ctx.ctr, ctx.gpr[6]);
+        }
+
+        // Out of range: the default is taken before anything is dispatched
+        for index in [3u64, 7, 0xFFFF_FFFF] {
+            let ctx = run(index);
+            assert_eq!(ctx.next_pc, 0x4044);
+            assert_eq!((ctx.gpr[4], ctx.gpr[5], ctx.gpr[6], ctx.ctr), (0xAA, 0xBB, 0xCC, 0xDD));
+            assert_eq!(ctx.cr >> 28, 0x4);
+        }
+    }
+
+    #[test]
+    fn test_ppu_jump_table_write_invalidates() {
+        use crate::mem_track::{mark_written, TrackedRegion};
+        let _region = TrackedRegion::new(0x80_0000, 0x2_0000).unwrap();
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let table: Vec<u8> = [0x5000u32, 0x5100, 0x5200].iter().flat_map(|t| t.to_be_bytes()).collect();
+        jit.add_readonly_region(0x81_0000, &table).unwrap();
+        // cmplwi r3,2; bgt +0x40; lis r4,0x81; addi r4,r4,0; slwi r5,r3,2;
+        // lwzx r6,r4,r5; mtctr r6; bctr
+        let code: Vec<u8> = [0x2803_0002u32, 0x4181_0040, 0x3C80_0081, 0x3884_0000, 0x5465_103A,
+                             0x7CC4_282E, 0x7CC9_03A6, 0x4E80_0420]
+            .iter().flat_map(|w| w.to_be_bytes()).collect();
+        jit.compile(0x80_4000, &code).unwrap();
+        if jit.block_codegen(0x80_4000).is_none() {
+            return;
+        }
+        assert!(jit.jump_table(0x80_4000).is_some());
+
+        // A write to the table drops the block dispatching through it
+        mark_written(0x81_0004, 4);
+        assert!(jit.get_compiled(0x80_4000).is_none());
+    }
+
+    #[test]
+    fn test_ppu_deopt_materializes_registers() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        // mtctr r5; addi r3,r3,1; addi r4,r4,2; bctr
+        let code = [0x7C, 0xA9, 0x03, 0xA6, 0x38, 0x63, 0x00, 0x01,
+                    0x38, 0x84, 0x00, 0x02, 0x4E, 0x80, 0x04, 0x20];
+        jit.btb_add(0x200C, 0x3000);
+        jit.set_entry_constant(0x2000, 6, 77);
+        jit.compile(0x2000, &code).unwrap();
+        assert_eq!(jit.speculation_stats().guards, 2);
+
+        // Interpreter placeholders cannot be run natively
+        if jit.block_codegen(0x2000).is_none() {
+            return;
+        }
+        let mut memory = vec![0u8; 0x10000];
+        let memory_base = memory.as_mut_ptr();
+        let context = |r5: u64, r6: u64| PpuContext {
+            gpr: { let mut gpr = [0; 32]; gpr[3] = 10; gpr[4] = 20; gpr[5] = r5; gpr[6] = r6; gpr },
+            lr: 0x1234,
+            memory_base,
+            memory_size: 0x10000,
+            ..Default::default()
+        };
+
+        // Both speculations hold: the region runs to the guarded target
+        let mut ctx = context(0x3000, 77);
+        assert_eq!(jit.execute(&mut ctx, 0x2000), Ok(4));
+        assert_eq!((ctx.gpr[3], ctx.gpr[4], ctx.ctr, ctx.lr), (11, 22, 0x3000, 0x1234));
+        assert_eq!(ctx.next_pc, 0x3000);
+
+        // Another bctr target: the side exit materializes everything the
+        // region changed before the bctr, which the interpreter resumes at
+        let mut ctx = context(0x4000, 77);
+        assert_eq!(jit.execute(&mut ctx, 0x2000), Err(PpuExitReason::Deoptimized));
+        assert_eq!(ctx.deopt_guard, 1);
+        assert_eq!((ctx.gpr[3], ctx.gpr[4], ctx.ctr, ctx.lr), (11, 22, 0x4000, 0x1234));
+        assert_eq!(ctx.next_pc, 0x200C);
+
+        // Another r6 at entry: nothing has run yet
+        let mut ctx = context(0x3000, 5);
+        assert_eq!(jit.execute(&mut ctx, 0x2000), Err(PpuExitReason::Deoptimized));
+        assert_eq!(ctx.deopt_guard, 0);
+        assert_eq!((ctx.gpr[3], ctx.gpr[4], ctx.gpr[6]), (10, 20, 5));
+        assert_eq!(ctx.next_pc, 0x2000);
+        assert_eq!(jit.speculation_stats().deopts, 2);
+    }
+
     #[test]
     fn test_ppu_verify_codegen() {
         let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
@@ -1588,9 +3127,24 @@ mod tests {
         assert!(result, "Code verification should pass");
     }
 
+    #[test]
+    fn test_ppu_execute_preempted() {
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
+        jit.compile(0x1000, &[0x60, 0x00, 0x00, 0x00]).expect("Compilation failed");
+
+        // Pending interrupt exits before running the block
+        let mut context = PpuContext { interrupt_pending: 1, ..Default::default() };
+        assert_eq!(jit.execute(&mut context, 0x1000), Err(PpuExitReason::Preempted));
+        assert_eq!(context.next_pc, 0x1000);
+
+        // So does an exhausted budget
+        let mut context = PpuContext { budget_enabled: 1, instruction_budget: 0, ..Default::default() };
+        assert_eq!(jit.execute(&mut context, 0x1000), Err(PpuExitReason::Preempted));
+    }
+
     #[test]
     fn test_ppu_compile_fallback_on_empty() {
-        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
         // Empty code should fail gracefully
         let result = jit.compile(0x1000, &[]);
         assert!(result.is_err(), "Empty code should fail");
@@ -1786,7 +3340,7 @@ mod tests {
 
     #[test]
     fn test_ppu_compile_empty_returns_error() {
-        let mut jit = PpuJitCompiler::new().expect("JIT creation failed");
+        let jit = PpuJitCompiler::new().expect("JIT creation failed");
         let result = jit.compile(0x1000, &[]);
         assert!(result.is_err(), "Empty block should return an error");
         // May return EmptyBlock (-3) or InvalidInput (-1) depending on C++ validation order
@@ -1808,4 +3362,118 @@ mod tests {
             "Expected EmptyBlock or InvalidInput, got: {:?}", err
         );
     }
+
+    #[test]
+    fn test_spu_channel_fast_paths() {
+        use SpuChannelPath::*;
+        let cases: &[(u8, bool, SpuChannelPath)] = &[
+            (0, false, CountGated),   // SPU_RdEventStat
+            (1, true, Direct),        // SPU_WrEventMask
+            (3, false, CountGated),   // SPU_RdSigNotify1
+            (8, false, Direct),       // SPU_RdDec
+            (16, true, Direct),       // MFC_LSA
+            (21, true, Callback),     // MFC_Cmd
+            (23, true, Callback),     // MFC_WrTagUpdate
+            (24, false, CountGated),  // MFC_RdTagStat
+            (28, true, CountGated),   // SPU_WrOutMbox
+            (29, false, Callback),    // SPU_RdInMbox
+            (30, true, Callback),     // SPU_WrOutIntrMbox
+        ];
+        for &(channel, is_write, path) in cases {
+            assert_eq!(SpuJitCompiler::channel_fast_path(channel, is_write), path,
+                       "channel {} write {}", channel, is_write);
+        }
+    }
+
+    #[test]
+    fn test_spu_context_channel_state() {
+        let mut ctx = SpuContext::default();
+        ctx.reset_channels();
+        assert_eq!(ctx.take_out_mbox(), None);
+
+        // Events count only while unmasked
+        ctx.raise_events(0x2);
+        assert_eq!(ctx.channel_count[SPU_CH_RD_EVENT_STAT as usize], 0);
+        ctx.event_mask = 0x2;
+        ctx.raise_events(0);
+        assert_eq!(ctx.channel_count[SPU_CH_RD_EVENT_STAT as usize], 1);
+
+        ctx.post_signal(2, 0x10, true);
+        ctx.post_signal(2, 0x01, true);
+        assert_eq!(ctx.signal_notify[1], 0x11);
+        ctx.post_signal(2, 0x04, false);
+        assert_eq!(ctx.signal_notify[1], 0x04);
+        assert_eq!(ctx.channel_count[SPU_CH_RD_SIG_NOTIFY2 as usize], 1);
+
+        ctx.post_tag_status(0x8000_0001);
+        assert_eq!(ctx.channel_count[SPU_CH_RD_TAG_STAT as usize], 1);
+
+        // A full mailbox is drained once
+        ctx.out_mbox = 0x1234;
+        ctx.channel_count[SPU_CH_WR_OUT_MBOX as usize] = 0;
+        assert_eq!(ctx.take_out_mbox(), Some(0x1234));
+        assert_eq!(ctx.take_out_mbox(), None);
+    }
+
+    #[test]
+    fn test_rsx_constant_dirty_ranges() {
+        let mut shader = RsxShaderCompiler::new().expect("shader compiler creation failed");
+        assert_eq!(shader.constant_count(RsxConstFile::Vertex), 468);
+
+        // The first flush uploads the whole file
+        let flush = shader.flush_constants(RsxConstFile::Vertex, 8);
+        assert_eq!(flush.ranges, vec![RsxConstRange { first: 0, count: 468 }]);
+        let initial_hash = flush.hash;
+
+        shader.write_constants(RsxConstFile::Vertex, 40, &[[1.0, 0.0, 0.0, 1.0]; 2]).unwrap();
+        shader.write_constants(RsxConstFile::Vertex, 200, &[[2.0; 4]]).unwrap();
+        let flush = shader.flush_constants(RsxConstFile::Vertex, 8);
+        assert_eq!(flush.ranges, vec![
+            RsxConstRange { first: 40, count: 2 },
+            RsxConstRange { first: 200, count: 1 },
+        ]);
+
+        // Rewriting identical values uploads nothing
+        shader.write_constants(RsxConstFile::Vertex, 40, &[[1.0, 0.0, 0.0, 1.0]; 2]).unwrap();
+        assert!(shader.flush_constants(RsxConstFile::Vertex, 8).ranges.is_empty());
+
+        // Restoring the initial contents is recognized by hash
+        shader.write_constants(RsxConstFile::Vertex, 40, &[[0.0; 4]; 2]).unwrap();
+        shader.write_constants(RsxConstFile::Vertex, 200, &[[0.0; 4]]).unwrap();
+        let flush = shader.flush_constants(RsxConstFile::Vertex, 8);
+        assert!(flush.reused);
+        assert_eq!(flush.hash, initial_hash);
+
+        assert!(shader.write_constants(RsxConstFile::Vertex, 467, &[[0.0; 4]; 2]).is_err());
+    }
+
+    #[test]
+    fn test_rsx_shader_corpus_dump() {
+        let dir = std::env::temp_dir().join(format!("oc_rsx_corpus_{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let mut shader = RsxShaderCompiler::new().expect("shader compiler creation failed");
+        let vp = [0x0040_1c6c_u32, 0x0040_0000, 0x8106_c083, 0x6041_ff84];
+        let fp = [0x0200_3e00_u32, 0x1c9d_c801, 0x0001_c800, 0x3fe1_c800];
+
+        // Compiled before the capture starts, so only seen as a cache hit
+        shader.compile_fragment(&fp).unwrap();
+        shader.start_corpus(&dir).unwrap();
+
+        shader.compile_vertex(&vp).unwrap();
+        shader.compile_vertex(&vp).unwrap();
+        shader.compile_fragment(&fp).unwrap();
+        shader.get_pipeline(1, 2, 0x3, 0, false);
+        shader.get_pipeline(1, 2, 0x3, 0, false);
+        shader.stop_corpus();
+        assert_eq!(shader.corpus_stats(), (1, 1, 1));
+
+        let names: Vec<String> = std::fs::read_dir(&dir).unwrap()
+            .map(|e| e.unwrap().file_name().to_string_lossy().into_owned())
+            .collect();
+        assert_eq!(names.iter().filter(|n| n.starts_with("vp_")).count(), 1);
+        assert_eq!(names.iter().filter(|n| n.starts_with("fp_")).count(), 1);
+        assert_eq!(std::fs::metadata(dir.join("pipelines.bin")).unwrap().len(), 24);
+
+        let _ = std::fs::remove_dir_all(&dir);
+    }
 }
@@ -0,0 +1,274 @@
+//! Runtime-wide job system interface
+//!
+//! Safe Rust wrappers for the C++ job system: one worker per core with work
+//! stealing and priority lanes, shared with JIT and shader compilation so the
+//! total thread count stays at the core count.
+
+use std::any::Any;
+use std::os::raw::c_void;
+use std::panic::{self, AssertUnwindSafe};
+use std::sync::{Arc, Mutex};
+
+type JobFn = extern "C" fn(user_data: *mut c_void);
+type JobRangeFn = extern "C" fn(user_data: *mut c_void, begin: usize, end: usize);
+
+#[repr(C)]
+struct RawJobGroup {
+    _private: [u8; 0],
+}
+
+extern "C" {
+    fn oc_jobs_submit(f: JobFn, user_data: *mut c_void, lane: i32) -> i32;
+    fn oc_job_group_create() -> *mut RawJobGroup;
+    fn oc_job_group_submit(group: *mut RawJobGroup, f: JobFn, user_data: *mut c_void, lane: i32) -> i32;
+    fn oc_job_group_wait(group: *mut RawJobGroup);
+    fn oc_job_group_destroy(group: *mut RawJobGroup);
+    fn oc_jobs_parallel_for(f: JobRangeFn, user_data: *mut c_void, count: usize, grain: usize, lane: i32) -> i32;
+    fn oc_jobs_get_worker_count() -> usize;
+    fn oc_jobs_get_pending() -> usize;
+    fn oc_jobs_get_stats(
+        submitted: *mut u64, executed: *mut u64,
+        stolen: *mut u64, executed_by_waiters: *mut u64,
+    );
+    fn oc_jobs_reset_stats();
+}
+
+/// Job priority lanes. Higher lanes are drained first on every worker.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum JobLane {
+    /// Latency-sensitive work the emulator is waiting on
+    High = 0,
+    Normal = 1,
+    /// Speculative and background work
+    Low = 2,
+}
+
+type BoxedJob = Box<dyn FnOnce() + Send + 'static>;
+
+/// First panic raised by the jobs of a group or parallel_for, resumed on the
+/// thread that waits for them.
+#[derive(Default)]
+struct PanicSlot(Mutex<Option<Box<dyn Any + Send>>>);
+
+impl PanicSlot {
+    fn run<R>(&self, f: impl FnOnce() -> R) {
+        if let Err(payload) = panic::catch_unwind(AssertUnwindSafe(f)) {
+            self.0.lock().unwrap_or_else(|e| e.into_inner()).get_or_insert(payload);
+        }
+    }
+
+    fn resume(&self) {
+        let payload = self.0.lock().unwrap_or_else(|e| e.into_inner()).take();
+        if let Some(payload) = payload {
+            panic::resume_unwind(payload);
+        }
+    }
+}
+
+extern "C" fn run_boxed_job(user_data: *mut c_void) {
+    let job = unsafe { Box::from_raw(user_data as *mut BoxedJob) };
+    // A panic must not unwind into the C++ worker. The panic hook has
+    // already reported it; jobs with a waiter hand it on through a PanicSlot.
+    let _ = panic::catch_unwind(AssertUnwindSafe(job));
+}
+
+fn into_user_data<F: FnOnce() + Send + 'static>(f: F) -> *mut c_void {
+    let job: Box<BoxedJob> = Box::new(Box::new(f));
+    Box::into_raw(job) as *mut c_void
+}
+
+/// Queue a fire-and-forget job.
+pub fn submit<F: FnOnce() + Send + 'static>(lane: JobLane, f: F) {
+    unsafe { oc_jobs_submit(run_boxed_job, into_user_data(f), lane as i32) };
+}
+
+/// A set of jobs that can be waited on together.
+///
+/// Dropping the group waits for its jobs.
+pub struct JobGroup {
+    handle: *mut RawJobGroup,
+    panic: Arc<PanicSlot>,
+}
+
+impl JobGroup {
+    /// Create an empty group.
+    pub fn new() -> Self {
+        Self {
+            handle: unsafe { oc_job_group_create() },
+            panic: Arc::default(),
+        }
+    }
+
+    /// Queue a job that this group waits for.
+    pub fn spawn<F: FnOnce() + Send + 'static>(&self, lane: JobLane, f: F) {
+        let panic = Arc::clone(&self.panic);
+        let job = into_user_data(move || panic.run(f));
+        unsafe { oc_job_group_submit(self.handle, run_boxed_job, job, lane as i32) };
+    }
+
+    /// Wait for every job in the group, running queued jobs meanwhile.
+    ///
+    /// If a job panicked, the first panic is resumed here once all jobs
+    /// have finished. A panic not taken by `wait` is dropped with the group.
+    pub fn wait(&self) {
+        unsafe { oc_job_group_wait(self.handle) };
+        self.panic.resume();
+    }
+}
+
+impl Default for JobGroup {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for JobGroup {
+    fn drop(&mut self) {
+        unsafe { oc_job_group_destroy(self.handle) };
+    }
+}
+
+unsafe impl Send for JobGroup {}
+unsafe impl Sync for JobGroup {}
+
+struct RangeJob<F> {
+    f: F,
+    panic: PanicSlot,
+}
+
+extern "C" fn run_range<F: Fn(usize, usize) + Sync>(user_data: *mut c_void, begin: usize, end: usize) {
+    let job = unsafe { &*(user_data as *const RangeJob<F>) };
+    job.panic.run(|| (job.f)(begin, end));
+}
+
+/// Run `f(begin, end)` over `[0, count)` in chunks of `grain` items across
+/// the workers and wait for completion. The calling thread takes part.
+///
+/// If a chunk panicked, the first panic is resumed on the calling thread
+/// once every chunk has finished.
+pub fn parallel_for<F: Fn(usize, usize) + Sync>(count: usize, grain: usize, lane: JobLane, f: F) {
+    let job = RangeJob { f, panic: PanicSlot::default() };
+    unsafe {
+        oc_jobs_parallel_for(
+            run_range::<F>, &job as *const RangeJob<F> as *mut c_void,
+            count, grain, lane as i32,
+        )
+    };
+    job.panic.resume();
+}
+
+/// Get the number of job system workers.
+pub fn worker_count() -> usize {
+    unsafe { oc_jobs_get_worker_count() }
+}
+
+/// Get the number of queued (not yet started) jobs.
+pub fn pending() -> usize {
+    unsafe { oc_jobs_get_pending() }
+}
+
+/// Job system statistics.
+#[derive(Debug, Clone, Default)]
+pub struct JobStats {
+    pub submitted: u64,
+    pub executed: u64,
+    /// Jobs run by a worker other than the one they were queued on
+    pub stolen: u64,
+    /// Jobs run by threads waiting on a group
+    pub executed_by_waiters: u64,
+}
+
+/// Get job system statistics.
+pub fn get_stats() -> JobStats {
+    let mut stats = JobStats::default();
+    unsafe {
+        oc_jobs_get_stats(
+            &mut stats.submitted, &mut stats.executed,
+            &mut stats.stolen, &mut stats.executed_by_waiters,
+        );
+    }
+    stats
+}
+
+/// Reset job system statistics.
+pub fn reset_stats() {
+    unsafe { oc_jobs_reset_stats() };
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    #[test]
+    fn test_jobs_parallel_for() {
+        assert!(worker_count() >= 1);
+
+        let sum = AtomicU64::new(0);
+        parallel_for(1000, 64, JobLane::Normal, |begin, end| {
+            for i in begin..end {
+                sum.fetch_add(i as u64, Ordering::Relaxed);
+            }
+        });
+        assert_eq!(sum.load(Ordering::Relaxed), 999 * 1000 / 2);
+    }
+
+    #[test]
+    fn test_jobs_group_wait() {
+        let count = Arc::new(AtomicU64::new(0));
+        let group = JobGroup::new();
+        for _ in 0..32 {
+            let count = Arc::clone(&count);
+            group.spawn(JobLane::High, move || {
+                count.fetch_add(1, Ordering::Relaxed);
+            });
+        }
+        group.wait();
+        assert_eq!(count.load(Ordering::Relaxed), 32);
+    }
+
+    #[test]
+    fn test_jobs_group_wait_resumes_panic() {
+        let count = Arc::new(AtomicU64::new(0));
+        let group = JobGroup::new();
+        for i in 0..8 {
+            let count = Arc::clone(&count);
+            group.spawn(JobLane::Normal, move || {
+                if i == 3 {
+                    panic!("job 3 failed");
+                }
+                count.fetch_add(1, Ordering::Relaxed);
+            });
+        }
+        let result = std::panic::catch_unwind(AssertUnwindSafe(|| group.wait()));
+        let payload = result.expect_err("panic should reach the waiter");
+        assert_eq!(payload.downcast_ref::<&str>(), Some(&"job 3 failed"));
+        assert_eq!(count.load(Ordering::Relaxed), 7);
+
+        // Taken by the first wait
+        group.wait();
+    }
+
+    #[test]
+    fn test_jobs_parallel_for_resumes_panic() {
+        let sum = AtomicU64::new(0);
+        let result = std::panic::catch_unwind(AssertUnwindSafe(|| {
+            parallel_for(256, 16, JobLane::Normal, |begin, end| {
+                if begin == 128 {
+                    panic!("chunk failed");
+                }
+                sum.fetch_add((end - begin) as u64, Ordering::Relaxed);
+            });
+        }));
+        assert!(result.is_err());
+        assert_eq!(sum.load(Ordering::Relaxed), 240);
+
+        // The workers survive the panic
+        let again = AtomicU64::new(0);
+        parallel_for(64, 16, JobLane::Normal, |begin, end| {
+            again.fetch_add((end - begin) as u64, Ordering::Relaxed);
+        });
+        assert_eq!(again.load(Ordering::Relaxed), 64);
+    }
+}
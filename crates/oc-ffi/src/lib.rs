@@ -1,10 +1,18 @@
 //! FFI bridge to C++ components for oxidized-cell
 
 pub mod atomics;
+pub mod compile_server;
+pub mod disc_io;
 pub mod dma;
 pub mod jit;
+pub mod jobs;
+pub mod mem_budget;
+pub mod mem_track;
 pub mod simd;
+pub mod spu_capture;
+pub mod spu_ls;
 pub mod types;
+pub mod vpost;
 
 /// Initialize C++ runtime
 pub fn init() {
@@ -0,0 +1,253 @@
+//! Cache memory budget interface
+//!
+//! Safe Rust wrappers for the runtime-wide cache memory budget. The PPU and
+//! SPU code caches and the RSX shader caches charge their entries to one
+//! limit, derived from the cgroup or physical memory limit by default, which
+//! is split into per-cache targets weighted by how often each cache refetches
+//! entries it evicted.
+
+use std::ffi::CString;
+use std::os::raw::{c_char, c_void};
+
+/// Lookup count callback: total lookups the cache has served so far
+pub type MemBudgetLookupsFn = extern "C" fn(*mut c_void) -> u64;
+
+#[repr(C)]
+#[derive(Clone, Copy)]
+struct RawClientStats {
+    name: [c_char; 32],
+    bytes: u64,
+    target: u64,
+    lookups: u64,
+    evictions: u64,
+    evicted_bytes: u64,
+    refetches: u64,
+    marginal_benefit: f64,
+}
+
+extern "C" {
+    fn oc_mem_budget_register(
+        name: *const c_char, lookups: Option<MemBudgetLookupsFn>, user_data: *mut c_void,
+    ) -> i32;
+    fn oc_mem_budget_unregister(client: i32);
+    fn oc_mem_budget_insert(client: i32, key: u64, bytes: u64);
+    fn oc_mem_budget_evict(client: i32, key: u64, bytes: u64);
+    fn oc_mem_budget_release(client: i32, bytes: u64);
+    fn oc_mem_budget_get_target(client: i32) -> u64;
+    fn oc_mem_budget_detect_host_limit() -> u64;
+    fn oc_mem_budget_set_limit(bytes: u64);
+    fn oc_mem_budget_get_limit() -> u64;
+    fn oc_mem_budget_get_usage() -> u64;
+    fn oc_mem_budget_rebalance();
+    fn oc_mem_budget_get_clients(stats: *mut RawClientStats, max_clients: usize) -> usize;
+}
+
+/// Per-cache budget statistics
+#[derive(Debug, Clone, PartialEq)]
+pub struct BudgetClientStats {
+    pub name: String,
+    pub bytes: u64,
+    pub target: u64,
+    pub lookups: u64,
+    pub evictions: u64,
+    pub evicted_bytes: u64,
+    pub refetches: u64,
+    /// Smoothed refetches per lookup
+    pub marginal_benefit: f64,
+}
+
+/// A cache registered with the budget. Unregistered when dropped, which
+/// releases whatever it still holds.
+pub struct BudgetClient {
+    id: i32,
+}
+
+impl BudgetClient {
+    /// Register a cache without a lookup counter; refetches are then
+    /// weighed against inserts only.
+    pub fn register(name: &str) -> Option<Self> {
+        let name = CString::new(name).ok()?;
+        let id = unsafe { oc_mem_budget_register(name.as_ptr(), None, std::ptr::null_mut()) };
+        (id >= 0).then_some(Self { id })
+    }
+
+    /// Register a cache with a lookup counter.
+    ///
+    /// # Safety
+    /// `user_data` must stay valid for `lookups` until the client is dropped.
+    pub unsafe fn with_lookups(
+        name: &str, lookups: MemBudgetLookupsFn, user_data: *mut c_void,
+    ) -> Option<Self> {
+        let name = CString::new(name).ok()?;
+        let id = oc_mem_budget_register(name.as_ptr(), Some(lookups), user_data);
+        (id >= 0).then_some(Self { id })
+    }
+
+    /// Client id
+    pub fn id(&self) -> i32 {
+        self.id
+    }
+
+    /// Charge an inserted entry
+    pub fn insert(&self, key: u64, bytes: u64) {
+        unsafe { oc_mem_budget_insert(self.id, key, bytes) }
+    }
+
+    /// Release an entry evicted to stay within the target
+    pub fn evict(&self, key: u64, bytes: u64) {
+        unsafe { oc_mem_budget_evict(self.id, key, bytes) }
+    }
+
+    /// Release bytes dropped for any other reason
+    pub fn release(&self, bytes: u64) {
+        unsafe { oc_mem_budget_release(self.id, bytes) }
+    }
+
+    /// Bytes this cache may hold
+    pub fn target(&self) -> u64 {
+        unsafe { oc_mem_budget_get_target(self.id) }
+    }
+}
+
+impl Drop for BudgetClient {
+    fn drop(&mut self) {
+        unsafe { oc_mem_budget_unregister(self.id) }
+    }
+}
+
+/// Memory available to this process (cgroup limit or physical memory)
+pub fn detect_host_limit() -> u64 {
+    unsafe { oc_mem_budget_detect_host_limit() }
+}
+
+/// Set the total budget; 0 selects a quarter of the host limit
+pub fn set_limit(bytes: u64) {
+    unsafe { oc_mem_budget_set_limit(bytes) }
+}
+
+/// Total budget in bytes
+pub fn limit() -> u64 {
+    unsafe { oc_mem_budget_get_limit() }
+}
+
+/// Bytes currently held by all registered caches
+pub fn usage() -> u64 {
+    unsafe { oc_mem_budget_get_usage() }
+}
+
+/// Recompute per-cache targets now
+pub fn rebalance() {
+    unsafe { oc_mem_budget_rebalance() }
+}
+
+/// Statistics of all registered caches
+pub fn clients() -> Vec<BudgetClientStats> {
+    let empty = RawClientStats {
+        name: [0; 32],
+        bytes: 0,
+        target: 0,
+        lookups: 0,
+        evictions: 0,
+        evicted_bytes: 0,
+        refetches: 0,
+        marginal_benefit: 0.0,
+    };
+    // Caches may register in between; retry until the snapshot fits
+    let mut capacity = unsafe { oc_mem_budget_get_clients(std::ptr::null_mut(), 0) } + 16;
+    let mut raw;
+    loop {
+        raw = vec![empty; capacity];
+        let count = unsafe { oc_mem_budget_get_clients(raw.as_mut_ptr(), raw.len()) };
+        if count < capacity {
+            raw.truncate(count);
+            break;
+        }
+        capacity *= 2;
+    }
+    raw.iter()
+        .map(|r| {
+            let len = r.name.iter().position(|&c| c == 0).unwrap_or(r.name.len());
+            let name: Vec<u8> = r.name[..len].iter().map(|&c| c as u8).collect();
+            BudgetClientStats {
+                name: String::from_utf8_lossy(&name).into_owned(),
+                bytes: r.bytes,
+                target: r.target,
+                lookups: r.lookups,
+                evictions: r.evictions,
+                evicted_bytes: r.evicted_bytes,
+                refetches: r.refetches,
+                marginal_benefit: r.marginal_benefit,
+            }
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn stats_of(name: &str) -> BudgetClientStats {
+        rebalance();
+        clients().into_iter().find(|s| s.name == name).unwrap()
+    }
+
+    #[test]
+    fn test_mem_budget_refetch_accounting() {
+        assert!(detect_host_limit() > 0);
+        assert!(limit() > 0);
+
+        let client = BudgetClient::register("test_refetch").unwrap();
+        client.insert(1, 4096);
+        client.insert(2, 4096);
+        assert!(usage() >= 8192);
+
+        let s = stats_of("test_refetch");
+        assert_eq!(s.bytes, 8192);
+        assert_eq!(s.evictions, 0);
+
+        // Evicting and then inserting the same key again is a refetch
+        client.evict(1, 4096);
+        client.insert(3, 4096);
+        client.insert(1, 4096);
+        client.release(4096);
+
+        let s = stats_of("test_refetch");
+        assert_eq!(s.bytes, 8192);
+        assert_eq!(s.evictions, 1);
+        assert_eq!(s.evicted_bytes, 4096);
+        assert_eq!(s.refetches, 1);
+
+        drop(client);
+        assert!(clients().iter().all(|s| s.name != "test_refetch"));
+    }
+
+    #[test]
+    fn test_mem_budget_targets_within_limit() {
+        let a = BudgetClient::register("test_target_a").unwrap();
+        let b = BudgetClient::register("test_target_b").unwrap();
+        rebalance();
+
+        let total = limit();
+        assert!(a.target() > 0 && a.target() <= total);
+        assert!(b.target() > 0 && b.target() <= total);
+        let stats = clients();
+        let sum: u64 = stats.iter().map(|s| s.target).sum();
+        assert!(sum <= total + stats.len() as u64);
+    }
+
+    #[test]
+    fn test_mem_budget_many_clients() {
+        // One code cache per SPU thread can exceed a fixed client table
+        let many: Vec<_> = (0..200)
+            .map(|i| BudgetClient::register(&format!("test_many_{}", i)).unwrap())
+            .collect();
+        let ids: std::collections::HashSet<_> = many.iter().map(|c| c.id()).collect();
+        assert_eq!(ids.len(), many.len());
+
+        rebalance();
+        let total = limit();
+        assert!(many.iter().all(|c| c.target() > 0 && c.target() < total));
+        let registered = clients().iter().filter(|s| s.name.starts_with("test_many_")).count();
+        assert_eq!(registered, many.len());
+    }
+}
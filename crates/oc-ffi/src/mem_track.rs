@@ -0,0 +1,325 @@
+//! Guest memory write tracking interface
+//!
+//! Safe Rust wrappers for the C++ write tracker. Guest memory regions are
+//! tracked at 4KB page granularity; caches subscribe to the ranges they were
+//! built from and validate entries with an O(1) generation compare instead
+//! of rehashing guest data.
+
+use std::os::raw::c_void;
+
+/// Subscription callback: (user data, subscription id, written page address)
+pub type MemTrackCallback = extern "C" fn(*mut c_void, i32, u32);
+
+extern "C" {
+    fn oc_mem_track_add_region(guest_base: u32, size: u64, host_base: *mut c_void, flags: i32) -> i32;
+    fn oc_mem_track_remove_region(region: i32) -> i32;
+    fn oc_mem_track_mark_written(addr: u32, size: u32);
+    fn oc_mem_track_get_page_generation(addr: u32) -> u32;
+    fn oc_mem_track_collect_dirty(addr: u32, size: u32, bitmap: *mut u64, bitmap_words: usize) -> usize;
+    fn oc_mem_track_subscribe(
+        addr: u32, size: u32,
+        callback: Option<MemTrackCallback>, user_data: *mut c_void,
+    ) -> i32;
+    fn oc_mem_track_unsubscribe(sub: i32);
+    fn oc_mem_track_get_generation(sub: i32) -> u64;
+    fn oc_mem_track_rearm(sub: i32) -> u64;
+    fn oc_mem_track_dispatch() -> usize;
+    fn oc_mem_track_is_protect_supported() -> i32;
+    fn oc_mem_track_get_stats(
+        marks: *mut u64, faults: *mut u64,
+        notifications: *mut u64, rearms: *mut u64,
+    );
+    fn oc_mem_track_reset_stats();
+}
+
+/// Tracking page size (4KB)
+pub const MEM_TRACK_PAGE_SIZE: u32 = 0x1000;
+
+/// Write tracking error codes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MemTrackError {
+    /// Misaligned or empty range
+    InvalidArguments,
+    /// Range overlaps a tracked region, or lies outside any region
+    BadRange,
+    /// Write protection is not supported on this host
+    ProtectUnsupported,
+    /// No free region or subscription slot
+    Exhausted,
+    /// Unknown error
+    Unknown(i32),
+}
+
+impl std::fmt::Display for MemTrackError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            MemTrackError::InvalidArguments => write!(f, "Invalid tracking range"),
+            MemTrackError::BadRange => write!(f, "Range overlaps or is outside tracked memory"),
+            MemTrackError::ProtectUnsupported => write!(f, "Write protection not supported"),
+            MemTrackError::Exhausted => write!(f, "No free tracking slot"),
+            MemTrackError::Unknown(code) => write!(f, "Unknown tracking error: {}", code),
+        }
+    }
+}
+
+impl std::error::Error for MemTrackError {}
+
+fn map_track_error(code: i32) -> MemTrackError {
+    match code {
+        -1 => MemTrackError::InvalidArguments,
+        -2 => MemTrackError::BadRange,
+        -3 => MemTrackError::ProtectUnsupported,
+        -4 => MemTrackError::Exhausted,
+        other => MemTrackError::Unknown(other),
+    }
+}
+
+/// A tracked guest memory region. Tracking stops when dropped.
+pub struct TrackedRegion {
+    id: i32,
+}
+
+impl TrackedRegion {
+    /// Track writes to `[guest_base, guest_base + size)`, reported through
+    /// [`mark_written`] only.
+    pub fn new(guest_base: u32, size: u64) -> Result<Self, MemTrackError> {
+        let id = unsafe { oc_mem_track_add_region(guest_base, size, std::ptr::null_mut(), 0) };
+        if id < 0 { Err(map_track_error(id)) } else { Ok(Self { id }) }
+    }
+
+    /// Track writes by write-protecting armed pages of the host mapping.
+    ///
+    /// # Safety
+    /// `host_base` must be a page-aligned mapping of `size` bytes that stays
+    /// mapped until the region is dropped.
+    pub unsafe fn new_protected(guest_base: u32, size: u64, host_base: *mut u8) -> Result<Self, MemTrackError> {
+        let id = oc_mem_track_add_region(guest_base, size, host_base as *mut c_void, 1);
+        if id < 0 { Err(map_track_error(id)) } else { Ok(Self { id }) }
+    }
+}
+
+impl Drop for TrackedRegion {
+    fn drop(&mut self) {
+        unsafe { oc_mem_track_remove_region(self.id) };
+    }
+}
+
+/// A subscription to writes in a guest range. Unsubscribes when dropped.
+pub struct Subscription {
+    id: i32,
+}
+
+impl Subscription {
+    /// Subscribe to `[addr, addr + size)` without a callback.
+    pub fn new(addr: u32, size: u32) -> Result<Self, MemTrackError> {
+        let id = unsafe { oc_mem_track_subscribe(addr, size, None, std::ptr::null_mut()) };
+        if id < 0 { Err(map_track_error(id)) } else { Ok(Self { id }) }
+    }
+
+    /// Subscribe with a callback invoked on the first write to each armed page.
+    ///
+    /// # Safety
+    /// `user_data` must remain valid for as long as the subscription exists.
+    pub unsafe fn with_callback(
+        addr: u32, size: u32, callback: MemTrackCallback, user_data: *mut c_void,
+    ) -> Result<Self, MemTrackError> {
+        let id = oc_mem_track_subscribe(addr, size, Some(callback), user_data);
+        if id < 0 { Err(map_track_error(id)) } else { Ok(Self { id }) }
+    }
+
+    /// Subscription id (as passed to callbacks)
+    pub fn id(&self) -> i32 {
+        self.id
+    }
+
+    /// Current generation; unchanged means the range was not written.
+    pub fn generation(&self) -> u64 {
+        unsafe { oc_mem_track_get_generation(self.id) }
+    }
+
+    /// Re-arm the range after revalidating and return the generation to record.
+    pub fn rearm(&self) -> u64 {
+        unsafe { oc_mem_track_rearm(self.id) }
+    }
+}
+
+impl Drop for Subscription {
+    fn drop(&mut self) {
+        unsafe { oc_mem_track_unsubscribe(self.id) };
+    }
+}
+
+/// Report a write to guest memory.
+pub fn mark_written(addr: u32, size: u32) {
+    unsafe { oc_mem_track_mark_written(addr, size) };
+}
+
+/// Write generation of the page containing `addr`.
+pub fn page_generation(addr: u32) -> u32 {
+    unsafe { oc_mem_track_get_page_generation(addr) }
+}
+
+/// Collect and clear dirty pages of a range into `bitmap` (one bit per page
+/// from the page containing `addr`); returns the number of dirty pages.
+pub fn collect_dirty(addr: u32, size: u32, bitmap: &mut [u64]) -> usize {
+    unsafe { oc_mem_track_collect_dirty(addr, size, bitmap.as_mut_ptr(), bitmap.len()) }
+}
+
+/// Run callbacks deferred from write faults; returns how many ran.
+pub fn dispatch() -> usize {
+    unsafe { oc_mem_track_dispatch() }
+}
+
+/// Check whether write-protection tracking is supported on this host.
+pub fn is_protect_supported() -> bool {
+    unsafe { oc_mem_track_is_protect_supported() != 0 }
+}
+
+/// Write tracking statistics.
+#[derive(Debug, Clone, Default)]
+pub struct MemTrackStats {
+    pub marks: u64,
+    pub faults: u64,
+    pub notifications: u64,
+    pub rearms: u64,
+}
+
+/// Get write tracking statistics.
+pub fn get_stats() -> MemTrackStats {
+    let mut stats = MemTrackStats::default();
+    unsafe {
+        oc_mem_track_get_stats(
+            &mut stats.marks, &mut stats.faults,
+            &mut stats.notifications, &mut stats.rearms,
+        );
+    }
+    stats
+}
+
+/// Reset write tracking statistics.
+pub fn reset_stats() {
+    unsafe { oc_mem_track_reset_stats() };
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicBool, AtomicU32, Ordering};
+
+    extern "C" fn count_write(user: *mut c_void, _sub: i32, addr: u32) {
+        let last = unsafe { &*(user as *const AtomicU32) };
+        last.store(addr, Ordering::SeqCst);
+    }
+
+    #[test]
+    fn test_mem_track_explicit_marks() {
+        let _region = TrackedRegion::new(0xC000_0000, 0x10000).unwrap();
+        let last = AtomicU32::new(0);
+        let sub = unsafe {
+            Subscription::with_callback(
+                0xC000_2000, 0x1000, count_write, &last as *const AtomicU32 as *mut c_void,
+            ).unwrap()
+        };
+        let generation = sub.generation();
+
+        mark_written(0xC000_4000, 4);
+        assert_eq!(sub.generation(), generation);
+
+        mark_written(0xC000_2010, 4);
+        assert_eq!(sub.generation(), generation + 1);
+        assert_eq!(last.load(Ordering::SeqCst), 0xC000_2000);
+
+        // Disarmed until re-armed
+        mark_written(0xC000_2020, 4);
+        assert_eq!(sub.generation(), generation + 1);
+        let generation = sub.rearm();
+        mark_written(0xC000_2020, 4);
+        assert_eq!(sub.generation(), generation + 1);
+
+        let mut bitmap = [0u64; 1];
+        assert_eq!(collect_dirty(0xC000_0000, 0x10000, &mut bitmap), 2);
+        assert_eq!(bitmap[0], 0b10100);
+        assert_eq!(collect_dirty(0xC000_0000, 0x10000, &mut bitmap), 0);
+    }
+
+    struct DispatchProbe {
+        calls: AtomicU32,
+        unsubscribed: AtomicBool,
+        late_calls: AtomicU32,
+    }
+
+    extern "C" fn slow_write(user: *mut c_void, _sub: i32, _addr: u32) {
+        let probe = unsafe { &*(user as *const DispatchProbe) };
+        probe.calls.fetch_add(1, Ordering::SeqCst);
+        std::thread::sleep(std::time::Duration::from_micros(200));
+        // Still running after unsubscribe returned
+        if probe.unsubscribed.load(Ordering::SeqCst) {
+            probe.late_calls.fetch_add(1, Ordering::SeqCst);
+        }
+    }
+
+    #[test]
+    fn test_mem_track_unsubscribe_during_dispatch() {
+        const BASE: u32 = 0xC200_0000;
+        const PAGES: u32 = 256;
+        let _region = TrackedRegion::new(BASE, (PAGES * MEM_TRACK_PAGE_SIZE) as u64).unwrap();
+        let probe = DispatchProbe {
+            calls: AtomicU32::new(0),
+            unsubscribed: AtomicBool::new(false),
+            late_calls: AtomicU32::new(0),
+        };
+        let sub = unsafe {
+            Subscription::with_callback(
+                BASE, PAGES * MEM_TRACK_PAGE_SIZE, slow_write,
+                &probe as *const DispatchProbe as *mut c_void,
+            ).unwrap()
+        };
+
+        std::thread::scope(|scope| {
+            // Each thread writes its own pages, each write dispatching a callback
+            for thread in 0..4 {
+                scope.spawn(move || {
+                    for page in (thread..PAGES).step_by(4) {
+                        mark_written(BASE + page * MEM_TRACK_PAGE_SIZE, 4);
+                    }
+                });
+            }
+            while probe.calls.load(Ordering::SeqCst) < 8 {
+                std::thread::yield_now();
+            }
+            drop(sub);
+            probe.unsubscribed.store(true, Ordering::SeqCst);
+        });
+
+        assert_eq!(probe.late_calls.load(Ordering::SeqCst), 0);
+    }
+
+    #[test]
+    fn test_mem_track_write_protect() {
+        if !is_protect_supported() {
+            return;
+        }
+        let size = 0x4000usize;
+        let host = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(), size, libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_PRIVATE | libc::MAP_ANONYMOUS, -1, 0,
+            )
+        };
+        assert_ne!(host, libc::MAP_FAILED);
+        let host = host as *mut u8;
+
+        {
+            let _region = unsafe { TrackedRegion::new_protected(0xC100_0000, size as u64, host).unwrap() };
+            let sub = Subscription::new(0xC100_1000, 0x1000).unwrap();
+            let generation = sub.generation();
+
+            unsafe { host.add(0x1008).write_volatile(0x5A) };
+            assert_eq!(sub.generation(), generation + 1);
+            assert_eq!(unsafe { host.add(0x1008).read_volatile() }, 0x5A);
+            assert!(page_generation(0xC100_1000) > 0);
+        }
+
+        unsafe { libc::munmap(host as *mut c_void, size) };
+    }
+}
@@ -0,0 +1,349 @@
+//! SPU job capture and replay interface
+//!
+//! Safe Rust wrappers for capturing an SPU job (starting local store and
+//! registers, every DMA transfer, end state) to a file, and for replaying a
+//! capture offline with DMA serviced from the recorded data. The
+//! `spu_replay_bench` tool drives replays for benchmarking and regression
+//! checks.
+
+use crate::dma::DmaCommand;
+use crate::jit::SpuContext;
+use std::ffi::CString;
+use std::os::raw::{c_char, c_void};
+use std::path::Path;
+
+#[repr(C)]
+struct ReplayHandle {
+    _private: [u8; 0],
+}
+
+extern "C" {
+    fn oc_spu_capture_begin(path: *const c_char, context: *const SpuContext) -> i32;
+    fn oc_spu_capture_is_active() -> i32;
+    fn oc_spu_capture_record_dma(
+        local_storage: *const c_void, local_addr: u32,
+        ea: u64, size: u32, tag: u16, is_put: i32,
+    );
+    fn oc_spu_capture_end(context: *const SpuContext) -> i64;
+    fn oc_spu_capture_abort();
+    fn oc_spu_replay_open(path: *const c_char) -> *mut ReplayHandle;
+    fn oc_spu_replay_close(replay: *mut ReplayHandle);
+    fn oc_spu_replay_get_info(replay: *const ReplayHandle, info: *mut SpuReplayInfo);
+    fn oc_spu_replay_reset(replay: *mut ReplayHandle, context: *mut SpuContext) -> i32;
+    fn oc_spu_replay_dma(
+        replay: *mut ReplayHandle, local_storage: *mut c_void, local_addr: u32,
+        ea: u64, size: u32, tag: u16, cmd: u8,
+    ) -> i32;
+    fn oc_spu_replay_dma_list(
+        replay: *mut ReplayHandle, local_storage: *mut c_void, list_addr: u32,
+        list_size: u32, tag: u16, cmd: u8,
+    ) -> i32;
+    fn oc_spu_replay_verify(replay: *mut ReplayHandle, context: *const SpuContext) -> i32;
+}
+
+/// SPU local store size a replay restores into
+pub const SPU_REPLAY_LS_SIZE: usize = 0x40000;
+
+/// Verification result bits
+pub const REPLAY_REGS_DIFFER: i32 = 0x01;
+pub const REPLAY_LS_DIFFERS: i32 = 0x02;
+pub const REPLAY_PUT_DIFFERS: i32 = 0x04;
+pub const REPLAY_DMA_DIVERGED: i32 = 0x08;
+pub const REPLAY_DMA_INCOMPLETE: i32 = 0x10;
+pub const REPLAY_NO_END_STATE: i32 = 0x20;
+
+/// Capture and replay error codes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum CaptureError {
+    /// Null context or local store, or no capture active
+    InvalidArguments,
+    /// Another capture is already active
+    AlreadyActive,
+    /// The capture file could not be written
+    FileError,
+    /// A replayed transfer does not match the capture
+    Diverged,
+    /// Unsupported DMA command
+    UnsupportedCommand,
+    /// Unknown error
+    Unknown(i32),
+}
+
+impl std::fmt::Display for CaptureError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            CaptureError::InvalidArguments => write!(f, "Invalid capture arguments"),
+            CaptureError::AlreadyActive => write!(f, "A capture is already active"),
+            CaptureError::FileError => write!(f, "Capture file error"),
+            CaptureError::Diverged => write!(f, "Replay diverged from capture"),
+            CaptureError::UnsupportedCommand => write!(f, "Unsupported DMA command"),
+            CaptureError::Unknown(code) => write!(f, "Unknown capture error: {}", code),
+        }
+    }
+}
+
+impl std::error::Error for CaptureError {}
+
+fn path_to_cstring(path: &Path) -> Result<CString, CaptureError> {
+    CString::new(path.to_string_lossy().into_owned()).map_err(|_| CaptureError::InvalidArguments)
+}
+
+/// Start capturing the job running on `context`'s local store.
+///
+/// # Safety
+/// `context.local_storage` must point to the job's 256KB local store, and
+/// stay valid until [`capture_end`] or [`capture_abort`].
+pub unsafe fn capture_begin(path: &Path, context: &SpuContext) -> Result<(), CaptureError> {
+    let path = path_to_cstring(path)?;
+    match oc_spu_capture_begin(path.as_ptr(), context) {
+        0 => Ok(()),
+        -1 => Err(CaptureError::InvalidArguments),
+        -2 => Err(CaptureError::AlreadyActive),
+        -3 => Err(CaptureError::FileError),
+        other => Err(CaptureError::Unknown(other)),
+    }
+}
+
+/// Check whether a capture is active.
+pub fn capture_is_active() -> bool {
+    unsafe { oc_spu_capture_is_active() != 0 }
+}
+
+/// Record a transfer moved outside the C++ DMA paths, once its data has
+/// moved. Ignored unless `local_storage` is the captured job's local store.
+pub fn capture_record_dma(local_storage: &[u8], local_addr: u32, ea: u64, size: u32, tag: u16, is_put: bool) {
+    unsafe {
+        oc_spu_capture_record_dma(
+            local_storage.as_ptr() as *const c_void, local_addr, ea, size, tag,
+            if is_put { 1 } else { 0 },
+        )
+    };
+}
+
+/// Finish the active capture with the job's end state; returns the number of
+/// transfers recorded.
+pub fn capture_end(context: &SpuContext) -> Result<u64, CaptureError> {
+    match unsafe { oc_spu_capture_end(context) } {
+        n if n >= 0 => Ok(n as u64),
+        -1 => Err(CaptureError::InvalidArguments),
+        -3 => Err(CaptureError::FileError),
+        other => Err(CaptureError::Unknown(other as i32)),
+    }
+}
+
+/// Stop the active capture without writing an end state.
+pub fn capture_abort() {
+    unsafe { oc_spu_capture_abort() };
+}
+
+/// Capture summary
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct SpuReplayInfo {
+    pub spu_id: u32,
+    pub entry_pc: u32,
+    pub gets: u32,
+    pub puts: u32,
+    pub get_bytes: u64,
+    pub put_bytes: u64,
+    pub has_end_state: u32,
+    pub reserved: u32,
+}
+
+/// A loaded capture
+pub struct SpuReplay {
+    handle: *mut ReplayHandle,
+}
+
+unsafe impl Send for SpuReplay {}
+
+impl SpuReplay {
+    /// Load a capture file; `None` if it is missing or malformed.
+    pub fn open(path: &Path) -> Option<Self> {
+        let path = path_to_cstring(path).ok()?;
+        let handle = unsafe { oc_spu_replay_open(path.as_ptr()) };
+        if handle.is_null() { None } else { Some(Self { handle }) }
+    }
+
+    /// Capture summary
+    pub fn info(&self) -> SpuReplayInfo {
+        let mut info = SpuReplayInfo::default();
+        unsafe { oc_spu_replay_get_info(self.handle, &mut info) };
+        info
+    }
+
+    /// Restore the captured starting state and rewind the transfer stream.
+    ///
+    /// # Safety
+    /// `context.local_storage` must point to a writable 256KB local store.
+    pub unsafe fn reset(&mut self, context: &mut SpuContext) -> Result<(), CaptureError> {
+        match oc_spu_replay_reset(self.handle, context) {
+            0 => Ok(()),
+            other => Err(CaptureError::Unknown(other)),
+        }
+    }
+
+    /// Service a DMA command from the capture. Returns `Ok(false)` if a PUT
+    /// wrote different data than captured.
+    pub fn dma(
+        &mut self, local_storage: &mut [u8], local_addr: u32,
+        ea: u64, size: u32, tag: u16, cmd: DmaCommand,
+    ) -> Result<bool, CaptureError> {
+        if local_storage.len() < SPU_REPLAY_LS_SIZE {
+            return Err(CaptureError::InvalidArguments);
+        }
+        let result = unsafe {
+            oc_spu_replay_dma(
+                self.handle, local_storage.as_mut_ptr() as *mut c_void,
+                local_addr, ea, size, tag, cmd as u8,
+            )
+        };
+        map_replay_result(result)
+    }
+
+    /// Service a DMA list command from the capture.
+    pub fn dma_list(
+        &mut self, local_storage: &mut [u8], list_addr: u32,
+        list_size: u32, tag: u16, cmd: DmaCommand,
+    ) -> Result<bool, CaptureError> {
+        if local_storage.len() < SPU_REPLAY_LS_SIZE {
+            return Err(CaptureError::InvalidArguments);
+        }
+        let result = unsafe {
+            oc_spu_replay_dma_list(
+                self.handle, local_storage.as_mut_ptr() as *mut c_void,
+                list_addr, list_size, tag, cmd as u8,
+            )
+        };
+        map_replay_result(result)
+    }
+
+    /// Compare the finished replay with the captured end state; returns the
+    /// `REPLAY_*` bits that differ (0 if identical).
+    pub fn verify(&mut self, context: &SpuContext) -> i32 {
+        unsafe { oc_spu_replay_verify(self.handle, context) }
+    }
+}
+
+impl Drop for SpuReplay {
+    fn drop(&mut self) {
+        unsafe { oc_spu_replay_close(self.handle) };
+    }
+}
+
+fn map_replay_result(code: i32) -> Result<bool, CaptureError> {
+    match code {
+        0 => Ok(true),
+        1 => Ok(false),
+        -1 => Err(CaptureError::Diverged),
+        -2 => Err(CaptureError::UnsupportedCommand),
+        other => Err(CaptureError::Unknown(other)),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::dma::dma_transfer;
+    use std::sync::Mutex;
+
+    // One capture can be active at a time
+    static CAPTURE_LOCK: Mutex<()> = Mutex::new(());
+
+    fn fresh_context(ls: &mut [u8]) -> SpuContext {
+        let mut ctx = SpuContext::default();
+        ctx.local_storage = ls.as_mut_ptr();
+        ctx.local_storage_size = SPU_REPLAY_LS_SIZE as u32;
+        ctx
+    }
+
+    // Stand-in for the job body: transform the buffer and set a result register
+    fn run_job(ls: &mut [u8], ctx: &mut SpuContext) {
+        for b in &mut ls[0x2000..0x2100] {
+            *b = b.wrapping_add(1);
+        }
+        ctx.gpr[3][0] = 42;
+        ctx.pc = 0x180;
+    }
+
+    #[test]
+    fn test_spu_capture_replay() {
+        let _lock = CAPTURE_LOCK.lock().unwrap();
+        let path = std::env::temp_dir().join(format!("oc_spu_capture_{}.ocspu", std::process::id()));
+        let mut ls = vec![0u8; SPU_REPLAY_LS_SIZE];
+        let mut memory: Vec<u8> = (0..0x4000u32).map(|i| (i * 13) as u8).collect();
+        let mut ctx = fresh_context(&mut ls);
+        ctx.pc = 0x100;
+
+        unsafe {
+            capture_begin(&path, &ctx).unwrap();
+            assert!(capture_is_active());
+            dma_transfer(&mut ls, 0x2000, &mut memory, 0x1000, 0x100, 1, DmaCommand::Get).unwrap();
+            run_job(&mut ls, &mut ctx);
+            dma_transfer(&mut ls, 0x2000, &mut memory, 0x3000, 0x100, 1, DmaCommand::Put).unwrap();
+        }
+        assert_eq!(capture_end(&ctx).unwrap(), 2);
+        assert!(!capture_is_active());
+
+        let mut replay = SpuReplay::open(&path).unwrap();
+        let info = replay.info();
+        assert_eq!(info.entry_pc, 0x100);
+        assert_eq!((info.gets, info.puts), (1, 1));
+        assert_eq!((info.get_bytes, info.put_bytes), (0x100, 0x100));
+        assert_eq!(info.has_end_state, 1);
+
+        // Faithful replay: main memory is never touched
+        let mut ls2 = vec![0xFFu8; SPU_REPLAY_LS_SIZE];
+        let mut ctx2 = fresh_context(&mut ls2);
+        unsafe { replay.reset(&mut ctx2).unwrap() };
+        assert_eq!(ctx2.pc, 0x100);
+        assert!(replay.dma(&mut ls2, 0x2000, 0x1000, 0x100, 1, DmaCommand::Get).unwrap());
+        assert_eq!(ls2[0x2001], 13);
+        run_job(&mut ls2, &mut ctx2);
+        assert!(replay.dma(&mut ls2, 0x2000, 0x3000, 0x100, 1, DmaCommand::Put).unwrap());
+        assert_eq!(replay.verify(&ctx2), 0);
+
+        // A changed result is reported
+        unsafe { replay.reset(&mut ctx2).unwrap() };
+        replay.dma(&mut ls2, 0x2000, 0x1000, 0x100, 1, DmaCommand::Get).unwrap();
+        assert!(!replay.dma(&mut ls2, 0x2000, 0x3000, 0x100, 1, DmaCommand::Put).unwrap());
+        assert_ne!(replay.verify(&ctx2) & REPLAY_PUT_DIFFERS, 0);
+
+        // Transfers out of order diverge
+        unsafe { replay.reset(&mut ctx2).unwrap() };
+        assert_eq!(
+            replay.dma(&mut ls2, 0x2000, 0x3000, 0x100, 1, DmaCommand::Put),
+            Err(CaptureError::Diverged)
+        );
+
+        drop(replay);
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_spu_capture_external_transfers() {
+        let _lock = CAPTURE_LOCK.lock().unwrap();
+        let path = std::env::temp_dir().join(format!("oc_spu_capture_ext_{}.ocspu", std::process::id()));
+        let mut ls = vec![0u8; SPU_REPLAY_LS_SIZE];
+        let other = vec![0u8; SPU_REPLAY_LS_SIZE];
+        let ctx = fresh_context(&mut ls);
+
+        unsafe { capture_begin(&path, &ctx).unwrap() };
+        // A GET copied by the caller, then one on another SPU's local store
+        ls[0x400..0x480].fill(7);
+        capture_record_dma(&ls, 0x400, 0x8000, 0x80, 2, false);
+        capture_record_dma(&other, 0x400, 0x8000, 0x80, 2, false);
+        assert_eq!(capture_end(&ctx).unwrap(), 1);
+
+        let mut replay = SpuReplay::open(&path).unwrap();
+        assert_eq!((replay.info().gets, replay.info().get_bytes), (1, 0x80));
+        let mut ls2 = vec![0u8; SPU_REPLAY_LS_SIZE];
+        let mut ctx2 = fresh_context(&mut ls2);
+        unsafe { replay.reset(&mut ctx2).unwrap() };
+        assert!(replay.dma(&mut ls2, 0x400, 0x8000, 0x80, 2, DmaCommand::Get).unwrap());
+        assert_eq!(ls2[0x47F], 7);
+
+        drop(replay);
+        let _ = std::fs::remove_file(&path);
+    }
+}
@@ -0,0 +1,349 @@
+//! SPU local store backing interface
+//!
+//! Safe Rust wrappers for the C++ local store manager. Local store images are
+//! switched into an SPU's fixed 256KB window by remapping memfd-backed pages,
+//! so SPU thread group and SPURS task switches do not copy the local store.
+//! Platforms without memfd fall back to copying.
+
+use std::os::raw::c_void;
+
+extern "C" {
+    fn oc_spu_ls_window_create(base: *mut *mut c_void) -> i32;
+    fn oc_spu_ls_window_destroy(window: i32) -> i32;
+    fn oc_spu_ls_image_create(data: *const u8, size: usize) -> i32;
+    fn oc_spu_ls_image_clone(source: i32) -> i32;
+    fn oc_spu_ls_image_seal(image: i32) -> i32;
+    fn oc_spu_ls_image_destroy(image: i32) -> i32;
+    fn oc_spu_ls_attach(window: i32, image: i32) -> i32;
+    fn oc_spu_ls_detach(window: i32) -> i32;
+    fn oc_spu_ls_get_attached(window: i32) -> i32;
+    fn oc_spu_ls_is_zero_copy() -> i32;
+    fn oc_spu_ls_get_stats(
+        switches: *mut u64, remapped_switches: *mut u64,
+        bytes_copied: *mut u64, cow_clones: *mut u64,
+    );
+    fn oc_spu_ls_reset_stats();
+}
+
+/// SPU local store size (256KB)
+pub const SPU_LS_SIZE: usize = 0x40000;
+
+/// Local store backing error codes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SpuLsError {
+    /// Window or image creation failed
+    CreateFailed,
+    /// The image is attached to another window
+    AttachedElsewhere,
+    /// Remapping the window failed
+    RemapFailed,
+    /// Unknown error
+    Unknown(i32),
+}
+
+impl std::fmt::Display for SpuLsError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            SpuLsError::CreateFailed => write!(f, "Local store creation failed"),
+            SpuLsError::AttachedElsewhere => write!(f, "Image is attached to another window"),
+            SpuLsError::RemapFailed => write!(f, "Local store remap failed"),
+            SpuLsError::Unknown(code) => write!(f, "Unknown local store error: {}", code),
+        }
+    }
+}
+
+impl std::error::Error for SpuLsError {}
+
+fn map_ls_error(code: i32) -> SpuLsError {
+    match code {
+        -2 => SpuLsError::AttachedElsewhere,
+        -3 => SpuLsError::RemapFailed,
+        other => SpuLsError::Unknown(other),
+    }
+}
+
+/// A local store image: the saved LS contents of one SPU thread or task.
+pub struct SpuLsImage {
+    id: i32,
+}
+
+impl SpuLsImage {
+    /// Create an image initialized from `data` (zero-filled past its end).
+    pub fn new(data: &[u8]) -> Result<Self, SpuLsError> {
+        if data.len() > SPU_LS_SIZE {
+            return Err(SpuLsError::CreateFailed);
+        }
+        let id = unsafe { oc_spu_ls_image_create(data.as_ptr(), data.len()) };
+        if id < 0 { Err(SpuLsError::CreateFailed) } else { Ok(Self { id }) }
+    }
+
+    /// Create an image holding this one's current contents.
+    ///
+    /// Pages are shared copy-on-write when this image is sealed; otherwise
+    /// the clone is a copy. Later changes to this image never show through.
+    pub fn clone_cow(&self) -> Result<Self, SpuLsError> {
+        let id = unsafe { oc_spu_ls_image_clone(self.id) };
+        if id < 0 { Err(SpuLsError::CreateFailed) } else { Ok(Self { id }) }
+    }
+
+    /// Make this image a read-only template whose clones share its pages.
+    ///
+    /// Fails with `AttachedElsewhere` while the image is attached. Once
+    /// sealed, the image is mapped read-only wherever it is attached.
+    pub fn seal(&mut self) -> Result<(), SpuLsError> {
+        let result = unsafe { oc_spu_ls_image_seal(self.id) };
+        if result == 0 { Ok(()) } else { Err(map_ls_error(result)) }
+    }
+}
+
+impl Drop for SpuLsImage {
+    fn drop(&mut self) {
+        // Detaches the image from its window first, if it is attached
+        let result = unsafe { oc_spu_ls_image_destroy(self.id) };
+        debug_assert_eq!(result, 0, "failed to destroy local store image {}", self.id);
+    }
+}
+
+/// An SPU's fixed local store window.
+///
+/// The window address never changes, so it can be stored in the SPU context
+/// once; attaching an image switches what the window shows.
+pub struct SpuLsWindow {
+    id: i32,
+    base: *mut u8,
+}
+
+impl SpuLsWindow {
+    /// Reserve a new window.
+    pub fn new() -> Result<Self, SpuLsError> {
+        let mut base: *mut c_void = std::ptr::null_mut();
+        let id = unsafe { oc_spu_ls_window_create(&mut base) };
+        if id < 0 { Err(SpuLsError::CreateFailed) } else { Ok(Self { id, base: base as *mut u8 }) }
+    }
+
+    /// Window base address (valid for `SPU_LS_SIZE` bytes while an image is attached).
+    pub fn base(&self) -> *mut u8 {
+        self.base
+    }
+
+    /// Switch the window to `image`, keeping the previous image's contents.
+    ///
+    /// Dropping the attached image leaves the window empty.
+    pub fn attach(&mut self, image: &SpuLsImage) -> Result<(), SpuLsError> {
+        let result = unsafe { oc_spu_ls_attach(self.id, image.id) };
+        if result == 0 { Ok(()) } else { Err(map_ls_error(result)) }
+    }
+
+    /// Detach the current image.
+    pub fn detach(&mut self) -> Result<(), SpuLsError> {
+        let result = unsafe { oc_spu_ls_detach(self.id) };
+        if result == 0 { Ok(()) } else { Err(map_ls_error(result)) }
+    }
+
+    /// Check whether `image` is the attached image.
+    pub fn is_attached(&self, image: &SpuLsImage) -> bool {
+        unsafe { oc_spu_ls_get_attached(self.id) == image.id }
+    }
+
+    /// View the attached local store.
+    ///
+    /// # Safety
+    /// An image must be attached, and no other reference to the window may be
+    /// used while the slice is alive.
+    pub unsafe fn as_mut_slice(&mut self) -> &mut [u8] {
+        std::slice::from_raw_parts_mut(self.base, SPU_LS_SIZE)
+    }
+}
+
+// The window is an id and a fixed address; the C++ manager serializes all
+// switching, so a window can be handed to another thread.
+unsafe impl Send for SpuLsWindow {}
+
+impl Drop for SpuLsWindow {
+    fn drop(&mut self) {
+        unsafe { oc_spu_ls_window_destroy(self.id) };
+    }
+}
+
+/// Check whether switching is done by remapping rather than copying.
+pub fn is_zero_copy() -> bool {
+    unsafe { oc_spu_ls_is_zero_copy() != 0 }
+}
+
+/// Local store switching statistics.
+#[derive(Debug, Clone, Default)]
+pub struct SpuLsStats {
+    pub switches: u64,
+    pub remapped_switches: u64,
+    pub bytes_copied: u64,
+    pub cow_clones: u64,
+}
+
+/// Get local store switching statistics.
+pub fn get_stats() -> SpuLsStats {
+    let mut stats = SpuLsStats::default();
+    unsafe {
+        oc_spu_ls_get_stats(
+            &mut stats.switches, &mut stats.remapped_switches,
+            &mut stats.bytes_copied, &mut stats.cow_clones,
+        );
+    }
+    stats
+}
+
+/// Reset local store switching statistics.
+pub fn reset_stats() {
+    unsafe { oc_spu_ls_reset_stats() };
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_spu_ls_switch_preserves_images() {
+        let mut window = SpuLsWindow::new().unwrap();
+        let a = SpuLsImage::new(&[1, 2, 3]).unwrap();
+        let b = SpuLsImage::new(&[]).unwrap();
+
+        window.attach(&a).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[1], 2);
+            window.as_mut_slice()[0x100] = 0xAA;
+        }
+
+        window.attach(&b).unwrap();
+        assert!(window.is_attached(&b));
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0x100], 0);
+        }
+
+        window.attach(&a).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0x100], 0xAA);
+        }
+        window.detach().unwrap();
+    }
+
+    #[test]
+    fn test_spu_ls_cow_clone() {
+        let mut w0 = SpuLsWindow::new().unwrap();
+        let mut w1 = SpuLsWindow::new().unwrap();
+        let mut template = SpuLsImage::new(&[7; 16]).unwrap();
+        template.seal().unwrap();
+        let cow_clones = get_stats().cow_clones;
+        let task = template.clone_cow().unwrap();
+        if is_zero_copy() {
+            assert!(get_stats().cow_clones > cow_clones);
+        }
+
+        w0.attach(&task).unwrap();
+        unsafe {
+            assert_eq!(w0.as_mut_slice()[15], 7);
+            w0.as_mut_slice()[15] = 9;
+        }
+
+        // The template is unaffected by the clone's writes
+        w1.attach(&template).unwrap();
+        unsafe {
+            assert_eq!(w1.as_mut_slice()[15], 7);
+        }
+
+        // The clone keeps its private pages across a switch
+        w0.detach().unwrap();
+        w0.attach(&task).unwrap();
+        unsafe {
+            assert_eq!(w0.as_mut_slice()[15], 9);
+        }
+        assert_eq!(w1.attach(&task), Err(SpuLsError::AttachedElsewhere));
+
+        w0.detach().unwrap();
+        w1.detach().unwrap();
+    }
+
+    #[test]
+    fn test_spu_ls_clone_is_snapshot() {
+        let mut window = SpuLsWindow::new().unwrap();
+        let mut template = SpuLsImage::new(&[1; 4]).unwrap();
+
+        // An unsealed source is copied, so its later writes stay its own
+        window.attach(&template).unwrap();
+        let attached_copy = template.clone_cow().unwrap();
+        unsafe {
+            window.as_mut_slice()[0] = 2;
+        }
+        window.detach().unwrap();
+        let copy = template.clone_cow().unwrap();
+        window.attach(&template).unwrap();
+        unsafe {
+            window.as_mut_slice()[0] = 3;
+        }
+        assert_eq!(template.seal(), Err(SpuLsError::AttachedElsewhere));
+        window.detach().unwrap();
+
+        window.attach(&attached_copy).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0], 1);
+        }
+        window.attach(&copy).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0], 2);
+        }
+
+        // A sealed template still reads back, and clones of it are writable
+        template.seal().unwrap();
+        template.seal().unwrap();
+        let task = template.clone_cow().unwrap();
+        window.attach(&template).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0], 3);
+        }
+        window.attach(&task).unwrap();
+        unsafe {
+            window.as_mut_slice()[0] = 4;
+        }
+        window.attach(&template).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0], 3);
+        }
+        window.detach().unwrap();
+
+        // Sealing a clone gives it contents of its own to seal
+        let mut nested = task.clone_cow().unwrap();
+        drop(task);
+        nested.seal().unwrap();
+        window.attach(&nested).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0], 4);
+        }
+        window.detach().unwrap();
+    }
+
+    #[test]
+    fn test_spu_ls_drop_attached_image() {
+        let mut window = SpuLsWindow::new().unwrap();
+        let template = SpuLsImage::new(&[5; 8]).unwrap();
+        let shared = SpuLsImage::new(&[3; 8]).unwrap();
+
+        // Dropping an attached image empties the window instead of leaking
+        let task = template.clone_cow().unwrap();
+        window.attach(&task).unwrap();
+        drop(task);
+        assert!(!window.is_attached(&template));
+        assert!(!window.is_attached(&shared));
+
+        window.attach(&shared).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[7], 3);
+        }
+        drop(shared);
+
+        // The freed slots are reused and the window still switches
+        let next = SpuLsImage::new(&[1]).unwrap();
+        window.attach(&next).unwrap();
+        unsafe {
+            assert_eq!(window.as_mut_slice()[0], 1);
+        }
+        window.detach().unwrap();
+    }
+}
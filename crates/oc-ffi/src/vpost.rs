@@ -0,0 +1,294 @@
+//! Video post-processing interface
+//!
+//! Safe Rust wrappers for the fused cellVpost pipeline: deinterlacing,
+//! YUV420 to RGBA conversion and scaling in one banded pass over the frame,
+//! with AVX2 kernels and a scalar fallback that produce identical output.
+
+#[repr(C)]
+struct VpostHandle {
+    _private: [u8; 0],
+}
+
+#[repr(C)]
+struct RawFrame {
+    y: *const u8,
+    u: *const u8,
+    v: *const u8,
+    y_pitch: u32,
+    uv_pitch: u32,
+    in_width: u32,
+    in_height: u32,
+    out: *mut u8,
+    out_pitch: u32,
+    out_width: u32,
+    out_height: u32,
+}
+
+/// Video post-processor statistics
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct VpostStats {
+    pub frames: u64,
+    pub output_pixels: u64,
+    /// Rows converted, including rows shared by adjacent bands
+    pub source_rows: u64,
+    /// Lines interpolated by motion-adaptive deinterlacing
+    pub motion_lines: u64,
+    pub process_ns: u64,
+    /// Bands used for the last frame
+    pub bands: u32,
+    /// Kernels used for the last frame (as [`crate::simd::SimdLevel`])
+    pub simd_level: i32,
+}
+
+extern "C" {
+    fn oc_vpost_create() -> *mut VpostHandle;
+    fn oc_vpost_destroy(vp: *mut VpostHandle);
+    fn oc_vpost_set_deinterlace(vp: *mut VpostHandle, algorithm: i32, top_field_first: i32) -> i32;
+    fn oc_vpost_set_scaling(vp: *mut VpostHandle, algorithm: i32) -> i32;
+    fn oc_vpost_set_color(vp: *mut VpostHandle, matrix: i32, alpha: u8) -> i32;
+    fn oc_vpost_enable_simd(vp: *mut VpostHandle, enable: i32);
+    fn oc_vpost_process(vp: *mut VpostHandle, frame: *const RawFrame) -> i32;
+    fn oc_vpost_get_stats(vp: *mut VpostHandle, stats: *mut VpostStats);
+    fn oc_vpost_reset_stats(vp: *mut VpostHandle);
+}
+
+/// Deinterlacing algorithm
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum VpostDeinterlace {
+    /// Repeat lines of the kept field
+    Bob = 0,
+    /// Keep both fields (progressive input)
+    Weave = 1,
+    /// Interpolate lines that moved since the last frame
+    MotionAdaptive = 2,
+}
+
+/// Scaling algorithm
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum VpostScaling {
+    Nearest = 0,
+    Bilinear = 1,
+    Bicubic = 2,
+}
+
+/// YUV colour matrix
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum VpostColorMatrix {
+    Bt601 = 0,
+    Bt709 = 1,
+}
+
+/// Video post-processing error codes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum VpostError {
+    /// Zero dimensions
+    InvalidArguments,
+    /// An input plane or the output is smaller than the dimensions need
+    BufferTooSmall,
+}
+
+impl std::fmt::Display for VpostError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            VpostError::InvalidArguments => write!(f, "Invalid video post-processing arguments"),
+            VpostError::BufferTooSmall => write!(f, "Video post-processing buffer too small"),
+        }
+    }
+}
+
+impl std::error::Error for VpostError {}
+
+/// Fused deinterlace, YUV420 to RGBA conversion and scaling
+pub struct VideoPostProcessor {
+    handle: *mut VpostHandle,
+}
+
+unsafe impl Send for VideoPostProcessor {}
+// Everything that changes the processor takes `&mut self`
+unsafe impl Sync for VideoPostProcessor {}
+
+impl VideoPostProcessor {
+    /// Create a processor (weave, bilinear, BT.709, opaque alpha)
+    pub fn new() -> Option<Self> {
+        let handle = unsafe { oc_vpost_create() };
+        if handle.is_null() { None } else { Some(Self { handle }) }
+    }
+
+    /// Set the deinterlacing algorithm; `top_field_first` keeps the even lines
+    pub fn set_deinterlace(&mut self, algorithm: VpostDeinterlace, top_field_first: bool) {
+        unsafe { oc_vpost_set_deinterlace(self.handle, algorithm as i32, top_field_first as i32) };
+    }
+
+    /// Set the scaling algorithm
+    pub fn set_scaling(&mut self, algorithm: VpostScaling) {
+        unsafe { oc_vpost_set_scaling(self.handle, algorithm as i32) };
+    }
+
+    /// Set the input colour matrix and the output alpha
+    pub fn set_color(&mut self, matrix: VpostColorMatrix, alpha: u8) {
+        unsafe { oc_vpost_set_color(self.handle, matrix as i32, alpha) };
+    }
+
+    /// Enable/disable the AVX2 kernels
+    pub fn set_simd(&mut self, enable: bool) {
+        unsafe { oc_vpost_enable_simd(self.handle, enable as i32) };
+    }
+
+    /// Process one frame of tightly packed full-range YUV420 planes into
+    /// tightly packed RGBA8888.
+    #[allow(clippy::too_many_arguments)]
+    pub fn process(
+        &mut self, y: &[u8], u: &[u8], v: &[u8], in_width: u32, in_height: u32,
+        out: &mut [u8], out_width: u32, out_height: u32,
+    ) -> Result<(), VpostError> {
+        if in_width == 0 || in_height == 0 || out_width == 0 || out_height == 0 {
+            return Err(VpostError::InvalidArguments);
+        }
+        let chroma = ((in_width as usize + 1) / 2) * ((in_height as usize + 1) / 2);
+        if y.len() < in_width as usize * in_height as usize
+            || u.len() < chroma
+            || v.len() < chroma
+            || out.len() < out_width as usize * out_height as usize * 4
+        {
+            return Err(VpostError::BufferTooSmall);
+        }
+        let frame = RawFrame {
+            y: y.as_ptr(),
+            u: u.as_ptr(),
+            v: v.as_ptr(),
+            y_pitch: 0,
+            uv_pitch: 0,
+            in_width,
+            in_height,
+            out: out.as_mut_ptr(),
+            out_pitch: 0,
+            out_width,
+            out_height,
+        };
+        match unsafe { oc_vpost_process(self.handle, &frame) } {
+            0 => Ok(()),
+            _ => Err(VpostError::InvalidArguments),
+        }
+    }
+
+    /// Get statistics
+    pub fn stats(&self) -> VpostStats {
+        let mut stats = VpostStats::default();
+        unsafe { oc_vpost_get_stats(self.handle, &mut stats) };
+        stats
+    }
+
+    /// Reset statistics
+    pub fn reset_stats(&mut self) {
+        unsafe { oc_vpost_reset_stats(self.handle) };
+    }
+}
+
+impl std::fmt::Debug for VideoPostProcessor {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("VideoPostProcessor").field("stats", &self.stats()).finish()
+    }
+}
+
+impl Drop for VideoPostProcessor {
+    fn drop(&mut self) {
+        unsafe { oc_vpost_destroy(self.handle) };
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn noise(len: usize, seed: &mut u32) -> Vec<u8> {
+        (0..len)
+            .map(|_| {
+                *seed ^= *seed << 13;
+                *seed ^= *seed >> 17;
+                *seed ^= *seed << 5;
+                *seed as u8
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_vpost_simd_matches_scalar() {
+        let mut seed = 0x1234_5678;
+        let (w, h) = (45u32, 31u32);
+        let chroma = (((w + 1) / 2) * ((h + 1) / 2)) as usize;
+        let y = noise((w * h) as usize, &mut seed);
+        let u = noise(chroma, &mut seed);
+        let v = noise(chroma, &mut seed);
+
+        for scaling in [VpostScaling::Nearest, VpostScaling::Bilinear, VpostScaling::Bicubic] {
+            for (ow, oh) in [(w, h), (80, 50), (17, 9)] {
+                let mut outputs = Vec::new();
+                for simd in [true, false] {
+                    let mut vp = VideoPostProcessor::new().unwrap();
+                    vp.set_simd(simd);
+                    vp.set_scaling(scaling);
+                    vp.set_deinterlace(VpostDeinterlace::Bob, true);
+                    let mut out = vec![0u8; (ow * oh * 4) as usize];
+                    vp.process(&y, &u, &v, w, h, &mut out, ow, oh).unwrap();
+                    outputs.push(out);
+                }
+                assert_eq!(outputs[0], outputs[1], "{:?} {}x{}", scaling, ow, oh);
+            }
+        }
+    }
+
+    #[test]
+    fn test_vpost_flat_field() {
+        let (w, h) = (64u32, 36u32);
+        let y = vec![90u8; (w * h) as usize];
+        let uv = vec![128u8; (w * h / 4) as usize];
+        let mut vp = VideoPostProcessor::new().unwrap();
+        vp.set_scaling(VpostScaling::Bicubic);
+        vp.set_color(VpostColorMatrix::Bt601, 0x80);
+
+        let mut out = vec![0u8; 100 * 70 * 4];
+        vp.process(&y, &uv, &uv, w, h, &mut out, 100, 70).unwrap();
+        assert!(out.chunks(4).all(|p| p == [90, 90, 90, 0x80]));
+
+        let stats = vp.stats();
+        assert_eq!(stats.frames, 1);
+        assert_eq!(stats.output_pixels, 100 * 70);
+        assert!(stats.source_rows >= h as u64);
+    }
+
+    #[test]
+    fn test_vpost_motion_adaptive() {
+        let (w, h) = (32u32, 8u32);
+        let uv = vec![128u8; (w * h / 4) as usize];
+        let still = vec![0u8; (w * h) as usize];
+        // Odd lines bright in the second frame: they moved and get interpolated
+        let mut moved = still.clone();
+        for row in moved.chunks_mut(w as usize).skip(1).step_by(2) {
+            row.fill(200);
+        }
+
+        let mut vp = VideoPostProcessor::new().unwrap();
+        vp.set_deinterlace(VpostDeinterlace::MotionAdaptive, true);
+        let mut out = vec![0u8; (w * h * 4) as usize];
+        vp.process(&still, &uv, &uv, w, h, &mut out, w, h).unwrap();
+        vp.process(&moved, &uv, &uv, w, h, &mut out, w, h).unwrap();
+
+        assert_eq!(vp.stats().motion_lines, (h / 2) as u64);
+        // The last line has no field line below it and averages with itself
+        let interior = (w * (h - 1) * 4) as usize;
+        assert!(out[..interior].iter().step_by(4).all(|&r| r == 0));
+    }
+
+    #[test]
+    fn test_vpost_invalid_arguments() {
+        let mut vp = VideoPostProcessor::new().unwrap();
+        let plane = vec![0u8; 16];
+        let mut out = vec![0u8; 16];
+        assert_eq!(vp.process(&plane, &plane, &plane, 0, 4, &mut out, 2, 2), Err(VpostError::InvalidArguments));
+        assert_eq!(vp.process(&plane, &plane, &plane, 8, 8, &mut out, 2, 2), Err(VpostError::BufferTooSmall));
+    }
+}
@@ -3,6 +3,7 @@
 //! This module provides HLE implementations for the PS3's video post-processing library.
 //! Supports video scaling, color conversion, and deinterlacing operations.
 
+use oc_ffi::vpost::{VideoPostProcessor, VpostColorMatrix, VpostScaling};
 use std::collections::HashMap;
 use tracing::trace;
 
@@ -94,7 +95,7 @@ pub struct CellVpostCtrlParam {
 
 /// Video post-processor entry
 #[allow(dead_code)]
-#[derive(Debug, Clone)]
+#[derive(Debug)]
 struct VpostEntry {
     /// Input picture format
     in_format: CellVpostPictureFormat,
@@ -114,6 +115,8 @@ struct VpostEntry {
     deinterlacer: Option<Deinterlacer>,
     /// Compositor for picture-in-picture
     compositor: Option<Compositor>,
+    /// Fused conversion and scaling for YUV420 to RGBA
+    fused: Option<VideoPostProcessor>,
 }
 
 /// Deinterlacing algorithm
@@ -919,6 +922,21 @@ impl VpostEntry {
         let scaler = Scaler::new(ScalingAlgorithm::Bilinear);
         let deinterlacer = Deinterlacer::new(DeinterlaceAlgorithm::MotionAdaptive);
         let compositor = Compositor::new();
+        let fused = if in_format.format_type == CellVpostFormatType::Yuv420Planar as u32
+            && out_format.format_type == CellVpostFormatType::Rgba8888 as u32
+        {
+            VideoPostProcessor::new().map(|mut vp| {
+                let matrix = if in_format.color_matrix == CellVpostColorMatrix::Bt601 as u32 {
+                    VpostColorMatrix::Bt601
+                } else {
+                    VpostColorMatrix::Bt709
+                };
+                vp.set_color(matrix, 0xFF);
+                vp
+            })
+        } else {
+            None
+        };
         
         Self {
             in_format,
@@ -930,6 +948,7 @@ impl VpostEntry {
             scaler: Some(scaler),
             deinterlacer: Some(deinterlacer),
             compositor: Some(compositor),
+            fused,
         }
     }
 }
@@ -1005,7 +1024,28 @@ impl VpostManager {
         }
 
         // Perform color conversion and scaling
-        if let (Some(converter), Some(scaler)) = (&entry.converter, &entry.scaler) {
+        if let Some(fused) = &mut entry.fused {
+            // YUV420 to RGBA: convert and scale in one pass
+            let y_size = (pic_info.in_width * pic_info.in_height) as usize;
+            let uv_size = (((pic_info.in_width + 1) / 2) * ((pic_info.in_height + 1) / 2)) as usize;
+            let out_size = (pic_info.out_width * pic_info.out_height * 4) as usize;
+            
+            let in_buffer = vec![128u8; y_size + uv_size * 2]; // Dummy input
+            let mut out_buffer = vec![0u8; out_size];
+            let (y_plane, uv_planes) = in_buffer.split_at(y_size);
+            let (u_plane, v_plane) = uv_planes.split_at(uv_size);
+            
+            fused.process(
+                y_plane, u_plane, v_plane,
+                pic_info.in_width, pic_info.in_height,
+                &mut out_buffer,
+                pic_info.out_width, pic_info.out_height,
+            ).map_err(|_| CELL_VPOST_ERROR_ARG)?;
+            
+            trace!("VpostManager::exec: fused convert/scale {}x{} to {}x{}",
+                   pic_info.in_width, pic_info.in_height,
+                   pic_info.out_width, pic_info.out_height);
+        } else if let (Some(converter), Some(scaler)) = (&entry.converter, &entry.scaler) {
             // Simulate input and output buffers (in real impl, would read from memory)
             let in_size = (pic_info.in_width * pic_info.in_height * 3 / 2) as usize; // YUV420 size
             let intermediate_size = (pic_info.in_width * pic_info.in_height * 4) as usize; // RGBA size before scaling
@@ -1066,6 +1106,13 @@ impl VpostManager {
     pub fn set_scaling_algorithm(&mut self, handle: VpostHandle, algorithm: ScalingAlgorithm) -> Result<(), i32> {
         let entry = self.processors.get_mut(&handle).ok_or(CELL_VPOST_ERROR_ARG)?;
         entry.scaler = Some(Scaler::new(algorithm));
+        if let Some(fused) = &mut entry.fused {
+            fused.set_scaling(match algorithm {
+                ScalingAlgorithm::NearestNeighbor => VpostScaling::Nearest,
+                ScalingAlgorithm::Bilinear => VpostScaling::Bilinear,
+                ScalingAlgorithm::Bicubic => VpostScaling::Bicubic,
+            });
+        }
         trace!("VpostManager::set_scaling_algorithm: handle={}, algorithm={:?}", handle, algorithm);
         Ok(())
     }
@@ -1297,6 +1344,26 @@ mod tests {
         assert_eq!(manager.get_frames_processed(handle).unwrap(), 2);
     }
 
+    #[test]
+    fn test_vpost_manager_exec_fused_yuv420_to_rgba() {
+        let mut manager = VpostManager::new();
+        let in_format = create_default_format();
+        let out_format = CellVpostPictureFormat {
+            format_type: CellVpostFormatType::Rgba8888 as u32,
+            ..create_default_format()
+        };
+        let handle = manager.open(in_format, out_format, 0x100000).unwrap();
+        manager.set_scaling_algorithm(handle, ScalingAlgorithm::Bicubic).unwrap();
+        let pic_info = create_default_pic_info();
+
+        manager.exec(handle, &pic_info).unwrap();
+        assert_eq!(manager.get_frames_processed(handle).unwrap(), 1);
+
+        let stats = manager.processors[&handle].fused.as_ref().unwrap().stats();
+        assert_eq!(stats.frames, 1);
+        assert_eq!(stats.output_pixels, 1280 * 720);
+    }
+
     #[test]
     fn test_vpost_manager_exec_invalid_dimensions() {
         let mut manager = VpostManager::new();
@@ -10,18 +10,24 @@
 
 use crate::loader::{GameLoader, LoadedGame};
 use oc_core::{Config, EmulatorError, Result, Scheduler, ThreadId, ThreadState, create_rsx_bridge, create_spu_bridge, SpuBridgeReceiver, SpuBridgeMessage, SpuWorkload, SpuDmaRequest};
-use oc_core::config::GpuBackend;
-use oc_memory::MemoryManager;
+use oc_core::config::{GpuBackend, PpuDecoder};
+use oc_memory::{MemoryManager, PageFlags};
+use oc_ffi::mem_track::TrackedRegion;
+use oc_ffi::spu_ls::{SpuLsImage, SpuLsWindow};
 use oc_ppu::{PpuInterpreter, PpuThread};
-use oc_spu::{SpuInterpreter, SpuThread, SpuPriority, SpuThreadGroup};
+use oc_spu::{LocalStore, SpuInterpreter, SpuThread, SpuPriority, SpuThreadGroup};
+use oc_spu::mfc::MfcCommand;
 use oc_rsx::{RsxThread, NullBackend, VulkanBackend};
 use oc_lv2::SyscallHandler;
-use std::path::Path;
+use std::path::{Path, PathBuf};
 use std::sync::Arc;
 use std::sync::atomic::{AtomicU32, Ordering};
 use std::time::{Duration, Instant};
 use std::collections::HashMap;
-use parking_lot::RwLock;
+use parking_lot::{Mutex, RwLock};
+
+/// SPU clock, for turning modelled MFC cycles into time
+const SPU_CLOCK_MHZ: u64 = 3200;
 
 /// Emulator runner state
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -34,6 +40,19 @@ pub enum RunnerState {
     Paused,
 }
 
+/// Local store window of one SPU thread and the images switched into it
+///
+/// Owned by the thread's `LocalStore`, so the window stays mapped exactly as
+/// long as the thread can use it.
+struct SpuLocalStore {
+    /// Fixed window the thread's local store points at
+    window: SpuLsWindow,
+    /// The thread's own local store, attached while its group runs
+    thread_image: SpuLsImage,
+    /// Local stores of SPURS workloads that ran on this SPU, by workload ID
+    workload_images: HashMap<u32, SpuLsImage>,
+}
+
 /// Main emulator runner
 pub struct EmulatorRunner {
     /// Configuration
@@ -42,10 +61,14 @@ pub struct EmulatorRunner {
     state: RunnerState,
     /// Shared memory manager
     memory: Arc<MemoryManager>,
+    /// Guest memory regions registered with the write tracker
+    _write_tracking: Vec<TrackedRegion>,
     /// PPU threads
     ppu_threads: RwLock<Vec<Arc<RwLock<PpuThread>>>>,
     /// PPU interpreter
     ppu_interpreter: Arc<PpuInterpreter>,
+    /// JIT warm start profile of the loaded title, saved again on stop
+    warm_start_profile: RwLock<Option<PathBuf>>,
     /// SPU threads
     spu_threads: RwLock<Vec<Arc<RwLock<SpuThread>>>>,
     /// SPU interpreter
@@ -54,6 +77,8 @@ pub struct EmulatorRunner {
     spu_groups: RwLock<HashMap<u32, SpuThreadGroup>>,
     /// SPU bridge receiver for receiving workloads from SPURS
     spu_bridge_receiver: Option<SpuBridgeReceiver>,
+    /// SPU thread whose job is being captured, if any
+    spu_capture: Mutex<Option<u32>>,
     /// RSX thread
     rsx_thread: Arc<RwLock<RsxThread>>,
     /// LV2 syscall handler
@@ -88,6 +113,9 @@ impl EmulatorRunner {
         let memory = MemoryManager::new()
             .map_err(|e| EmulatorError::Memory(e))?;
 
+        // Guest writes invalidate JIT code and other caches built from memory
+        let write_tracking = Self::track_guest_writes(&memory);
+
         // Create PPU interpreter
         let ppu_interpreter = Arc::new(PpuInterpreter::new(memory.clone()));
 
@@ -187,12 +215,15 @@ impl EmulatorRunner {
             config,
             state: RunnerState::Stopped,
             memory,
+            _write_tracking: write_tracking,
             ppu_threads: RwLock::new(Vec::new()),
             ppu_interpreter,
+            warm_start_profile: RwLock::new(None),
             spu_threads: RwLock::new(Vec::new()),
             spu_interpreter,
             spu_groups: RwLock::new(HashMap::new()),
             spu_bridge_receiver: Some(spu_bridge_receiver),
+            spu_capture: Mutex::new(None),
             rsx_thread,
             syscall_handler,
             scheduler,
@@ -206,6 +237,23 @@ impl EmulatorRunner {
         })
     }
 
+    /// Register guest memory with the write tracker and report every write
+    /// made through the memory manager to it
+    fn track_guest_writes(memory: &MemoryManager) -> Vec<TrackedRegion> {
+        let mut tracked = Vec::new();
+        for region in memory.regions() {
+            if region.flags.contains(PageFlags::MMIO) {
+                continue;
+            }
+            match TrackedRegion::new(region.base, region.size as u64) {
+                Ok(r) => tracked.push(r),
+                Err(e) => tracing::warn!("Write tracking unavailable for {}: {}", region.name, e),
+            }
+        }
+        memory.set_write_observer(Some(oc_ffi::mem_track::mark_written));
+        tracked
+    }
+
     /// Initialize the RSX graphics backend
     pub fn init_graphics(&mut self) -> Result<()> {
         let mut rsx = self.rsx_thread.write();
@@ -268,6 +316,12 @@ impl EmulatorRunner {
     pub fn stop(&mut self) -> Result<()> {
         tracing::info!("Stopping emulator");
         self.state = RunnerState::Stopped;
+        self.save_warm_start_profile();
+        if self.spu_capture.lock().is_some() {
+            if let Err(e) = self.stop_spu_capture() {
+                tracing::warn!("Failed to finish SPU capture: {}", e);
+            }
+        }
         Ok(())
     }
 
@@ -308,7 +362,9 @@ impl EmulatorRunner {
         // Use atomic counter to ensure unique IDs even after thread removal
         let thread_id = self.next_spu_thread_id.fetch_add(1, Ordering::SeqCst);
 
-        let thread = Arc::new(RwLock::new(SpuThread::new(thread_id, self.memory.clone())));
+        let mut thread = SpuThread::new(thread_id, self.memory.clone());
+        Self::map_spu_local_store(&mut thread);
+        let thread = Arc::new(RwLock::new(thread));
         
         // Add to scheduler
         self.scheduler.write().add_thread(ThreadId::Spu(thread_id), priority);
@@ -320,6 +376,57 @@ impl EmulatorRunner {
         Ok(thread_id)
     }
 
+    /// Start capturing the job running on SPU thread `spu_id` to `path`
+    ///
+    /// Records the thread's local store and registers now, then every DMA
+    /// transfer serviced for it until [`Self::stop_spu_capture`]. One capture
+    /// can be active at a time; the file replays with `spu_replay_bench`.
+    pub fn start_spu_capture<P: AsRef<Path>>(&self, spu_id: u32, path: P) -> Result<()> {
+        let thread_arc = self.find_spu_thread(spu_id)?;
+        let mut capture = self.spu_capture.lock();
+        let thread = thread_arc.read();
+        let context = Self::spu_capture_context(&thread);
+        // Safety: the local store stays mapped while the thread exists, and
+        // threads are never removed; stop() and drop end the capture
+        unsafe { oc_ffi::spu_capture::capture_begin(path.as_ref(), &context) }
+            .map_err(|e| EmulatorError::Spu(oc_core::error::SpuError::MfcError(e.to_string())))?;
+        *capture = Some(spu_id);
+        tracing::info!("Capturing SPU {} job to {}", spu_id, path.as_ref().display());
+        Ok(())
+    }
+
+    /// Finish the active SPU capture with the thread's current state and
+    /// return the number of DMA transfers recorded
+    pub fn stop_spu_capture(&self) -> Result<u64> {
+        let mut capture = self.spu_capture.lock();
+        let spu_id = capture.take().ok_or_else(|| EmulatorError::Spu(
+            oc_core::error::SpuError::MfcError("no SPU capture active".to_string())
+        ))?;
+        let thread_arc = self.find_spu_thread(spu_id)?;
+        let context = Self::spu_capture_context(&thread_arc.read());
+        oc_ffi::spu_capture::capture_end(&context)
+            .map_err(|e| EmulatorError::Spu(oc_core::error::SpuError::MfcError(e.to_string())))
+    }
+
+    /// SPU thread with the given ID
+    fn find_spu_thread(&self, spu_id: u32) -> Result<Arc<RwLock<SpuThread>>> {
+        self.spu_threads.read().iter()
+            .find(|thread| thread.read().id == spu_id)
+            .cloned()
+            .ok_or_else(|| EmulatorError::Spu(oc_core::error::SpuError::InvalidSpuId(spu_id)))
+    }
+
+    /// A thread's registers and local store, as a capture records them
+    fn spu_capture_context(thread: &SpuThread) -> oc_ffi::jit::SpuContext {
+        let mut context = oc_ffi::jit::SpuContext::default();
+        context.gpr = thread.regs.gpr;
+        context.pc = thread.regs.pc;
+        context.local_storage = thread.local_storage.as_ptr() as *mut u8;
+        context.local_storage_size = thread.local_storage.len() as u32;
+        context.spu_id = thread.id as u8;
+        context
+    }
+
     /// Load a game from a file path
     ///
     /// This will:
@@ -338,6 +445,9 @@ impl EmulatorRunner {
         // Load the game
         let game = loader.load(path)?;
 
+        // Precompile what the last run of this title found hot
+        self.load_warm_start_profile(&game);
+
         // Create the main PPU thread
         let thread_id = self.create_ppu_thread_with_entry(&game)?;
 
@@ -350,6 +460,47 @@ impl EmulatorRunner {
         Ok(game)
     }
 
+    /// Profile file for a title, keyed by its executable path so titles that
+    /// all ship an EBOOT.BIN still get their own
+    fn warm_start_profile_path(&self, game: &LoadedGame) -> PathBuf {
+        // FNV-1a, which unlike DefaultHasher is stable across toolchains
+        let hash = game.path.bytes().fold(0xcbf29ce484222325u64, |hash, byte| {
+            (hash ^ byte as u64).wrapping_mul(0x100000001b3)
+        });
+        self.config.paths.ppu_cache.join(format!("{:016x}.jitprof", hash))
+    }
+
+    /// Load the JIT warm start profile of a freshly loaded title, if an
+    /// earlier run saved one, and remember where to save it on stop
+    fn load_warm_start_profile(&self, game: &LoadedGame) {
+        if self.config.cpu.ppu_decoder != PpuDecoder::Recompiler {
+            return;
+        }
+        let path = self.warm_start_profile_path(game);
+        if path.exists() {
+            if let Err(e) = self.ppu_interpreter.load_warm_start_profile(&path) {
+                tracing::warn!("Ignoring JIT warm start profile: {}", e);
+            }
+        }
+        *self.warm_start_profile.write() = Some(path);
+    }
+
+    /// Save the JIT warm start profile of the loaded title
+    fn save_warm_start_profile(&self) {
+        let Some(path) = self.warm_start_profile.read().clone() else {
+            return;
+        };
+        if let Some(dir) = path.parent() {
+            if let Err(e) = std::fs::create_dir_all(dir) {
+                tracing::warn!("Failed to create {}: {}", dir.display(), e);
+                return;
+            }
+        }
+        if let Err(e) = self.ppu_interpreter.save_warm_start_profile(&path) {
+            tracing::warn!("JIT warm start profile not saved: {}", e);
+        }
+    }
+
     /// Create a PPU thread with a specific entry point and initial state
     ///
     /// Uses a monotonically increasing counter to ensure unique thread IDs
@@ -683,6 +834,7 @@ impl EmulatorRunner {
                 if thread.state == oc_spu::SpuThreadState::Stopped || 
                    thread.state == oc_spu::SpuThreadState::Ready {
                     // Set up the workload on this SPU
+                    Self::switch_spu_local_store(&mut thread, Some(workload.id));
                     thread.entry_point = workload.entry_point;
                     thread.arg = workload.argument;
                     thread.set_priority(SpuPriority::new(workload.priority));
@@ -710,6 +862,68 @@ impl EmulatorRunner {
         );
     }
     
+    /// Back an SPU thread's local store with a remappable window
+    ///
+    /// Thread group and SPURS switches then attach another image to the
+    /// window instead of copying 256KB. The thread keeps its own heap local
+    /// store if no window can be set up.
+    fn map_spu_local_store(thread: &mut SpuThread) {
+        let mapped = SpuLsWindow::new().and_then(|mut window| {
+            let image = SpuLsImage::new(&thread.local_storage[..])?;
+            window.attach(&image)?;
+            Ok((window, image))
+        });
+        let (window, thread_image) = match mapped {
+            Ok(mapped) => mapped,
+            Err(e) => {
+                tracing::warn!("SPU {} keeps a private local store: {}", thread.id, e);
+                return;
+            }
+        };
+
+        let base = window.base();
+        let ls = Arc::new(Mutex::new(SpuLocalStore {
+            window,
+            thread_image,
+            workload_images: HashMap::new(),
+        }));
+        // The window lives as long as the thread's reference to it
+        thread.local_storage = unsafe { LocalStore::mapped(base, ls) };
+    }
+
+    /// Switch an SPU to the local store of a SPURS workload, or back to its own
+    ///
+    /// The local store being switched out keeps its contents in its image.
+    fn switch_spu_local_store(thread: &mut SpuThread, workload_id: Option<u32>) {
+        let Some(ls) = thread.local_storage.mapping()
+            .and_then(|mapping| mapping.downcast_ref::<Mutex<SpuLocalStore>>()) else {
+            return;
+        };
+        let mut ls = ls.lock();
+        let ls = &mut *ls;
+
+        let image = match workload_id {
+            None => &ls.thread_image,
+            Some(id) => {
+                if !ls.workload_images.contains_key(&id) {
+                    match SpuLsImage::new(&[]) {
+                        Ok(image) => {
+                            ls.workload_images.insert(id, image);
+                        }
+                        Err(e) => {
+                            tracing::warn!("No local store for workload {} on SPU {}: {}", id, thread.id, e);
+                            return;
+                        }
+                    }
+                }
+                &ls.workload_images[&id]
+            }
+        };
+        if let Err(e) = ls.window.attach(image) {
+            tracing::warn!("SPU {} local store switch failed: {}", thread.id, e);
+        }
+    }
+
     /// Handle SPU group creation
     fn handle_create_spu_group(&mut self, request: oc_core::SpuGroupRequest) {
         tracing::info!(
@@ -728,7 +942,9 @@ impl EmulatorRunner {
         // Create SPU threads for the group
         for i in 0..request.num_threads {
             let thread_id = request.group_id * 10 + i; // Simple ID scheme
-            let thread = SpuThread::new(thread_id, self.memory.clone());
+            let mut thread = SpuThread::new(thread_id, self.memory.clone());
+            thread.group_id = Some(request.group_id);
+            Self::map_spu_local_store(&mut thread);
             self.spu_threads.write().push(Arc::new(RwLock::new(thread)));
         }
         
@@ -747,6 +963,13 @@ impl EmulatorRunner {
         tracing::info!("Starting SPU group {}", group_id);
         let mut groups = self.spu_groups.write();
         if let Some(group) = groups.get_mut(&group_id) {
+            // SPURS workloads may have run on the group's SPUs meanwhile
+            for thread_arc in self.spu_threads.read().iter() {
+                let mut thread = thread_arc.write();
+                if thread.group_id == Some(group_id) {
+                    Self::switch_spu_local_store(&mut thread, None);
+                }
+            }
             group.start();
         }
     }
@@ -772,6 +995,7 @@ impl EmulatorRunner {
         thread.arg = request.argument;
         thread.set_priority(SpuPriority::new(request.priority as u8));
         thread.set_pc(request.entry_point);
+        Self::map_spu_local_store(&mut thread);
         
         self.spu_threads.write().push(Arc::new(RwLock::new(thread)));
     }
@@ -806,6 +1030,15 @@ impl EmulatorRunner {
         for thread_arc in spu_threads.iter() {
             let mut thread = thread_arc.write();
             if thread.id == request.spu_id as u32 {
+                // The copy below is synchronous, so the stall is the MFC's
+                // modelled latency for the command
+                let command = if request.is_put { MfcCommand::Put } else { MfcCommand::Get };
+                let latency = command.base_latency() + command.transfer_latency(request.size);
+                oc_ffi::dma::heatmap_record(
+                    Some(thread.id), request.tag as u16, request.ea_addr,
+                    request.size, request.is_put, latency * 1000 / SPU_CLOCK_MHZ,
+                );
+
                 // Transfer data word by word (aligned)
                 let num_words = (request.size as usize + 3) / 4;
                 if request.is_put {
@@ -825,7 +1058,18 @@ impl EmulatorRunner {
                             thread.ls_write_u32(ls_offset, word);
                         }
                     }
+                    // Safety: the base covers the whole 32-bit guest address space
+                    unsafe {
+                        oc_ffi::dma::prefetch_observe(
+                            Some(thread.id), request.tag as u16, request.ea_addr,
+                            request.size, self.memory.base_ptr(),
+                        );
+                    }
                 }
+                oc_ffi::spu_capture::capture_record_dma(
+                    &thread.local_storage[..], request.ls_addr, request.ea_addr,
+                    request.size, request.tag as u16, request.is_put,
+                );
                 break;
             }
         }
@@ -884,20 +1128,19 @@ impl EmulatorRunner {
                 None => break, // No ready threads
             };
 
-            // Execute thread based on type
-            match thread_id {
-                ThreadId::Ppu(id) => {
-                    self.execute_ppu_thread(id)?;
-                    cycles += 1;
-                }
+            // Execute thread based on type. A PPU step may run a whole JIT
+            // region, so it is charged for every instruction it retired.
+            let elapsed = match thread_id {
+                ThreadId::Ppu(id) => self.execute_ppu_thread(id)?.max(1),
                 ThreadId::Spu(id) => {
                     self.execute_spu_thread(id)?;
-                    cycles += 1;
+                    1
                 }
-            }
+            };
+            cycles += elapsed;
 
             // Update time slice (1 cycle = 1us approximation)
-            self.scheduler.write().update_time_slice(1);
+            self.scheduler.write().update_time_slice(elapsed);
 
             // Check if time slice expired
             if self.scheduler.read().time_slice_expired() {
@@ -909,8 +1152,9 @@ impl EmulatorRunner {
         Ok(())
     }
 
-    /// Execute a single PPU thread step
-    fn execute_ppu_thread(&self, thread_id: u32) -> Result<()> {
+    /// Execute a single PPU thread step, returning the guest instructions it
+    /// retired
+    fn execute_ppu_thread(&self, thread_id: u32) -> Result<u64> {
         let threads = self.ppu_threads.read();
         let thread_arc = threads.get(thread_id as usize)
             .ok_or_else(|| EmulatorError::Ppu(
@@ -920,7 +1164,7 @@ impl EmulatorRunner {
 
         // Check if thread is in running state
         if !thread.is_running() {
-            return Ok(());
+            return Ok(0);
         }
 
         // Check if we're about to execute a syscall instruction
@@ -963,12 +1207,14 @@ impl EmulatorRunner {
                     thread.advance_pc();
                 }
             }
-            return Ok(());
+            return Ok(1);
         }
 
-        // Execute one instruction normally
+        // Execute one instruction (or compiled region) within what is left of
+        // the thread's time slice
+        thread.instruction_budget = self.scheduler.read().remaining_time_slice();
         match self.ppu_interpreter.step(&mut thread) {
-            Ok(()) => Ok(()),
+            Ok(()) => Ok(thread.last_step_instructions),
             Err(oc_core::error::PpuError::ThreadExit { exit_code }) => {
                 tracing::info!("PPU thread {} exited normally with code {}", thread_id, exit_code);
                 thread.stop();
@@ -976,7 +1222,7 @@ impl EmulatorRunner {
                     ThreadId::Ppu(thread_id),
                     ThreadState::Stopped
                 );
-                Ok(()) // Thread exit is not an error
+                Ok(thread.last_step_instructions) // Thread exit is not an error
             }
             Err(oc_core::error::PpuError::Breakpoint { addr }) => {
                 tracing::debug!("PPU thread {} hit breakpoint at 0x{:08x}", thread_id, addr);
@@ -985,7 +1231,7 @@ impl EmulatorRunner {
                     ThreadId::Ppu(thread_id),
                     ThreadState::Waiting
                 );
-                Ok(()) // Breakpoint is not an error, just pauses execution
+                Ok(thread.last_step_instructions) // Breakpoint is not an error, just pauses execution
             }
             Err(e) => {
                 tracing::error!("PPU thread {} error: {}", thread_id, e);
@@ -1013,8 +1259,13 @@ impl EmulatorRunner {
             return Ok(());
         }
 
+        // DMA issued while the step runs is attributed to this SPU
+        oc_ffi::dma::heatmap_set_current_spu(Some(thread.id));
+        let result = self.spu_interpreter.step(&mut thread);
+        oc_ffi::dma::heatmap_set_current_spu(None);
+
         // Execute one instruction
-        match self.spu_interpreter.step(&mut thread) {
+        match result {
             Ok(()) => Ok(()),
             Err(e) => {
                 tracing::error!("SPU thread {} error: {}", thread_id, e);
@@ -1092,6 +1343,15 @@ impl EmulatorRunner {
     }
 }
 
+impl Drop for EmulatorRunner {
+    fn drop(&mut self) {
+        // The captured local store goes away with its thread
+        if self.spu_capture.lock().take().is_some() {
+            oc_ffi::spu_capture::capture_abort();
+        }
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -1155,6 +1415,95 @@ mod tests {
         assert_eq!(runner.spu_thread_count(), 2);
     }
 
+    #[test]
+    fn test_spu_workload_switches_local_store() {
+        let config = Config::default();
+        let runner = EmulatorRunner::new(config).unwrap();
+        runner.create_spu_thread(100).unwrap();
+
+        let thread_arc = runner.spu_threads.read()[0].clone();
+        let mut thread = thread_arc.write();
+        assert!(thread.local_storage.is_mapped());
+        thread.ls_write_u32(0x100, 0x1111);
+
+        // Each workload gets its own local store, kept across switches
+        EmulatorRunner::switch_spu_local_store(&mut thread, Some(1));
+        assert_eq!(thread.ls_read_u32(0x100), 0);
+        thread.ls_write_u32(0x100, 0x2222);
+
+        EmulatorRunner::switch_spu_local_store(&mut thread, None);
+        assert_eq!(thread.ls_read_u32(0x100), 0x1111);
+        EmulatorRunner::switch_spu_local_store(&mut thread, Some(1));
+        assert_eq!(thread.ls_read_u32(0x100), 0x2222);
+    }
+
+    #[test]
+    fn test_spu_capture_records_runner_dma() {
+        let config = Config::default();
+        let mut runner = EmulatorRunner::new(config).unwrap();
+        let spu_id = runner.create_spu_thread(100).unwrap();
+        runner.memory.write_be32(0x10000, 0xCAFE_F00D).unwrap();
+
+        let path = std::env::temp_dir()
+            .join(format!("oc_runner_capture_{}.ocspu", std::process::id()));
+        assert!(runner.stop_spu_capture().is_err());
+        runner.start_spu_capture(spu_id, &path).unwrap();
+        assert!(runner.start_spu_capture(spu_id, &path).is_err());
+
+        runner.handle_spu_dma_transfer(SpuDmaRequest {
+            spu_id: spu_id as u8, ls_addr: 0x100, ea_addr: 0x10000, size: 0x10, tag: 1, is_put: false,
+        });
+        runner.handle_spu_dma_transfer(SpuDmaRequest {
+            spu_id: spu_id as u8, ls_addr: 0x100, ea_addr: 0x20000, size: 0x10, tag: 1, is_put: true,
+        });
+        assert_eq!(runner.stop_spu_capture().unwrap(), 2);
+        assert!(!oc_ffi::spu_capture::capture_is_active());
+
+        let replay = oc_ffi::spu_capture::SpuReplay::open(&path).unwrap();
+        assert_eq!((replay.info().gets, replay.info().puts), (1, 1));
+        drop(replay);
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_runner_dma_gets_feed_prefetcher() {
+        let config = Config::default();
+        let mut runner = EmulatorRunner::new(config).unwrap();
+        let spu_id = runner.create_spu_thread(100).unwrap();
+
+        // A double-buffered stream of 0x400-byte chunks at a 0x1000 stride
+        let hits = oc_ffi::dma::get_prefetch_stats().hits;
+        for i in 0..4u64 {
+            runner.handle_spu_dma_transfer(SpuDmaRequest {
+                spu_id: spu_id as u8, ls_addr: ((i & 1) * 0x400) as u32, ea_addr: 0x40000 + i * 0x1000,
+                size: 0x400, tag: 6, is_put: false,
+            });
+        }
+        if oc_ffi::dma::prefetch_is_enabled() {
+            assert!(oc_ffi::dma::get_prefetch_stats().hits > hits);
+        }
+    }
+
+    #[test]
+    fn test_runner_dma_heatmap_stall_is_mfc_latency() {
+        let config = Config::default();
+        let mut runner = EmulatorRunner::new(config).unwrap();
+        let spu_id = runner.create_spu_thread(100).unwrap();
+
+        oc_ffi::dma::heatmap_enable(true);
+        let before = oc_ffi::dma::heatmap_snapshot(0).totals.spus[spu_id as usize].stall_ns;
+        runner.handle_spu_dma_transfer(SpuDmaRequest {
+            spu_id: spu_id as u8, ls_addr: 0, ea_addr: 0x50000, size: 0x400, tag: 2, is_put: false,
+        });
+        let after = oc_ffi::dma::heatmap_snapshot(0).totals.spus[spu_id as usize].stall_ns;
+        oc_ffi::dma::heatmap_enable(false);
+
+        // 100 cycles to issue a GET and 10 per 128-byte block, at 3.2GHz
+        let cycles = MfcCommand::Get.base_latency() + MfcCommand::Get.transfer_latency(0x400);
+        assert_eq!(cycles, 180);
+        assert!(after - before >= cycles * 1000 / SPU_CLOCK_MHZ);
+    }
+
     #[test]
     fn test_pump_hle_callbacks_no_threads() {
         // When there are no PPU threads, the pump should not panic
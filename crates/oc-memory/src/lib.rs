@@ -16,7 +16,7 @@ pub use debug::{
 };
 pub use manager::{
     ExceptionHandlerResult, MemoryException, MemoryManager, MemoryRegion,
-    RsxMemoryMapping, SharedMemoryRegion,
+    RsxMemoryMapping, SharedMemoryRegion, WriteObserver,
 };
 pub use pages::PageFlags;
 pub use reservation::Reservation;
@@ -6,8 +6,12 @@ use crate::reservation::Reservation;
 use oc_core::error::{AccessKind, MemoryError};
 use parking_lot::RwLock;
 use std::collections::HashMap;
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
 
+/// Callback told about guest writes: (address, size)
+pub type WriteObserver = fn(u32, u32);
+
 /// Memory region descriptor
 #[derive(Debug, Clone)]
 pub struct MemoryRegion {
@@ -147,6 +151,9 @@ pub struct MemoryManager {
     rsx_mappings: RwLock<Vec<RsxMemoryMapping>>,
     /// Exception handler callback (if set)
     exception_handler: RwLock<Option<Box<dyn Fn(MemoryException) -> ExceptionHandlerResult + Send + Sync>>>,
+    /// Write observer as a `WriteObserver` address (0 if unset); read on
+    /// every store, so it is kept lock-free
+    write_observer: AtomicUsize,
 }
 
 // Safety: Memory is accessed through atomic operations and proper synchronization
@@ -210,6 +217,7 @@ impl MemoryManager {
             next_shared_id: RwLock::new(1),
             rsx_mappings: RwLock::new(Vec::new()),
             exception_handler: RwLock::new(None),
+            write_observer: AtomicUsize::new(0),
         };
 
         // Initialize standard regions
@@ -373,6 +381,7 @@ impl MemoryManager {
     pub fn write<T: Copy>(&self, addr: u32, value: T) -> Result<(), MemoryError> {
         self.check_access(addr, std::mem::size_of::<T>() as u32, PageFlags::WRITE)?;
         unsafe { self.write_unchecked(addr, value) };
+        self.notify_write(addr, std::mem::size_of::<T>() as u32);
         Ok(())
     }
 
@@ -476,9 +485,28 @@ impl MemoryManager {
         unsafe {
             std::ptr::copy_nonoverlapping(data.as_ptr(), self.ptr(addr), data.len());
         }
+        self.notify_write(addr, data.len() as u32);
         Ok(())
     }
 
+    /// Report writes made through `write` and `write_bytes` (and the
+    /// big-endian helpers) to `observer`, or stop reporting with `None`.
+    /// Unchecked writes are not reported.
+    pub fn set_write_observer(&self, observer: Option<WriteObserver>) {
+        self.write_observer.store(observer.map_or(0, |f| f as usize), Ordering::Release);
+    }
+
+    #[inline(always)]
+    fn notify_write(&self, addr: u32, size: u32) {
+        let observer = self.write_observer.load(Ordering::Acquire);
+        if observer != 0 {
+            // Safety: only set_write_observer stores non-zero values, and
+            // those are WriteObserver addresses
+            let observer: WriteObserver = unsafe { std::mem::transmute(observer) };
+            observer(addr, size);
+        }
+    }
+
     /// Copy data from memory
     pub fn read_bytes(&self, addr: u32, size: u32) -> Result<Vec<u8>, MemoryError> {
         self.check_access(addr, size, PageFlags::READ)?;
@@ -827,6 +855,27 @@ mod tests {
         assert_eq!(read_data, data);
     }
 
+    #[test]
+    fn test_write_observer() {
+        use std::sync::atomic::AtomicU64;
+        static LAST_WRITE: AtomicU64 = AtomicU64::new(0);
+        fn record(addr: u32, size: u32) {
+            LAST_WRITE.store(((addr as u64) << 32) | size as u64, Ordering::SeqCst);
+        }
+
+        let mem = MemoryManager::new().unwrap();
+        let addr = mem.allocate(0x1000, 0x1000, PageFlags::RW).unwrap();
+        mem.set_write_observer(Some(record));
+        mem.write_be32(addr + 8, 1).unwrap();
+        assert_eq!(LAST_WRITE.load(Ordering::SeqCst), ((addr as u64 + 8) << 32) | 4);
+        mem.write_bytes(addr + 16, b"code").unwrap();
+        assert_eq!(LAST_WRITE.load(Ordering::SeqCst), ((addr as u64 + 16) << 32) | 4);
+
+        mem.set_write_observer(None);
+        mem.write::<u64>(addr, 0).unwrap();
+        assert_eq!(LAST_WRITE.load(Ordering::SeqCst), ((addr as u64 + 16) << 32) | 4);
+    }
+
     #[test]
     fn test_reservation() {
         let mem = MemoryManager::new().unwrap();
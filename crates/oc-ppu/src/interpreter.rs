@@ -9,6 +9,7 @@
 //! - **Hybrid**: Uses JIT for hot code paths, falls back to interpreter for cold code
 
 use std::sync::Arc;
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::collections::HashSet;
 use parking_lot::{RwLock, Mutex};
 use oc_memory::MemoryManager;
@@ -19,6 +20,17 @@ use crate::decoder::{PpuDecoder, InstructionForm};
 use crate::thread::PpuThread;
 use crate::instructions::{float, system, vector};
 
+/// Interpreted entries of a block profiled just before it turns hot
+const ENTRY_PROFILE_WINDOW: u32 = 8;
+
+/// GPR values seen on entry to a block while it was interpreted, and which
+/// of them never changed between entries
+#[derive(Debug, Clone, Copy)]
+struct EntryProfile {
+    gpr: [u64; 32],
+    constant: u32,
+}
+
 /// JIT execution mode
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
 pub enum JitMode {
@@ -48,6 +60,39 @@ pub struct JitStats {
     pub cache_misses: u64,
 }
 
+/// Lock-free JIT statistics counters shared by all PPU threads
+#[derive(Debug, Default)]
+struct JitStatsCounters {
+    blocks_compiled: AtomicU64,
+    jit_executions: AtomicU64,
+    interpreter_fallbacks: AtomicU64,
+    jit_instructions: AtomicU64,
+    cache_hits: AtomicU64,
+    cache_misses: AtomicU64,
+}
+
+impl JitStatsCounters {
+    fn snapshot(&self) -> JitStats {
+        JitStats {
+            blocks_compiled: self.blocks_compiled.load(Ordering::Relaxed),
+            jit_executions: self.jit_executions.load(Ordering::Relaxed),
+            interpreter_fallbacks: self.interpreter_fallbacks.load(Ordering::Relaxed),
+            jit_instructions: self.jit_instructions.load(Ordering::Relaxed),
+            cache_hits: self.cache_hits.load(Ordering::Relaxed),
+            cache_misses: self.cache_misses.load(Ordering::Relaxed),
+        }
+    }
+
+    fn reset(&self) {
+        self.blocks_compiled.store(0, Ordering::Relaxed);
+        self.jit_executions.store(0, Ordering::Relaxed);
+        self.interpreter_fallbacks.store(0, Ordering::Relaxed);
+        self.jit_instructions.store(0, Ordering::Relaxed);
+        self.cache_hits.store(0, Ordering::Relaxed);
+        self.cache_misses.store(0, Ordering::Relaxed);
+    }
+}
+
 /// Breakpoint type
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum BreakpointType {
@@ -91,14 +136,18 @@ pub struct PpuInterpreter {
     instruction_count: Mutex<u64>,
     /// JIT execution mode
     jit_mode: RwLock<JitMode>,
-    /// JIT compiler (optional, created on demand)
-    jit_compiler: Mutex<Option<PpuJitCompiler>>,
+    /// JIT compiler (optional, created on demand). The compiler is internally
+    /// synchronized, so PPU threads only take the read lock to use it; the
+    /// write lock is held just while creating it.
+    jit_compiler: RwLock<Option<PpuJitCompiler>>,
     /// JIT statistics
-    jit_stats: Mutex<JitStats>,
+    jit_stats: JitStatsCounters,
     /// Hot block threshold for hybrid mode (execution count before compilation)
     hot_threshold: u32,
     /// Block execution counts for hybrid mode
     block_exec_counts: RwLock<std::collections::HashMap<u32, u32>>,
+    /// Entry register profiles of blocks about to be compiled
+    entry_profiles: RwLock<std::collections::HashMap<u32, EntryProfile>>,
 }
 
 impl PpuInterpreter {
@@ -110,10 +159,11 @@ impl PpuInterpreter {
             breakpoint_details: RwLock::new(std::collections::HashMap::new()),
             instruction_count: Mutex::new(0),
             jit_mode: RwLock::new(JitMode::Interpreter),
-            jit_compiler: Mutex::new(None),
-            jit_stats: Mutex::new(JitStats::default()),
+            jit_compiler: RwLock::new(None),
+            jit_stats: JitStatsCounters::default(),
             hot_threshold: 100, // Compile after 100 executions
             block_exec_counts: RwLock::new(std::collections::HashMap::new()),
+            entry_profiles: RwLock::new(std::collections::HashMap::new()),
         }
     }
 
@@ -150,12 +200,15 @@ impl PpuInterpreter {
     /// Check if JIT is available (C++ backend compiled)
     pub fn is_jit_available(&self) -> bool {
         self.ensure_jit_compiler();
-        self.jit_compiler.lock().is_some()
+        self.jit_compiler.read().is_some()
     }
 
     /// Ensure JIT compiler is initialized
     fn ensure_jit_compiler(&self) {
-        let mut jit = self.jit_compiler.lock();
+        if self.jit_compiler.read().is_some() {
+            return;
+        }
+        let mut jit = self.jit_compiler.write();
         if jit.is_none() {
             *jit = PpuJitCompiler::new();
             if jit.is_some() {
@@ -168,12 +221,12 @@ impl PpuInterpreter {
 
     /// Get JIT statistics
     pub fn jit_stats(&self) -> JitStats {
-        self.jit_stats.lock().clone()
+        self.jit_stats.snapshot()
     }
 
     /// Reset JIT statistics
     pub fn reset_jit_stats(&self) {
-        *self.jit_stats.lock() = JitStats::default();
+        self.jit_stats.reset();
     }
 
     /// Set the hot block threshold for hybrid mode
@@ -185,21 +238,56 @@ impl PpuInterpreter {
 
     /// Compile a specific block address
     pub fn compile_block(&self, address: u32) -> Result<(), String> {
-        let mut jit = self.jit_compiler.lock();
-        let jit = jit.as_mut().ok_or("JIT compiler not available")?;
+        let jit = self.jit_compiler.read();
+        let jit = jit.as_ref().ok_or("JIT compiler not available")?;
 
         // Read the code block from memory
         let code = self.read_block_code(address)?;
+        self.publish_entry_profile(jit, address, &code);
         
         jit.compile(address, &code)
             .map_err(|e| format!("JIT compilation failed: {:?}", e))?;
 
-        self.jit_stats.lock().blocks_compiled += 1;
+        self.jit_stats.blocks_compiled.fetch_add(1, Ordering::Relaxed);
         tracing::debug!("Compiled block at 0x{:08x} ({} bytes)", address, code.len());
         
         Ok(())
     }
 
+    /// Save the JIT execution profile (hot blocks, tiers, traces) so the next
+    /// boot of this title can precompile them. Call on shutdown.
+    pub fn save_warm_start_profile(&self, path: &std::path::Path) -> Result<(), String> {
+        let jit = self.jit_compiler.read();
+        let jit = jit.as_ref().ok_or("JIT compiler not available")?;
+
+        let profile = jit.warm_start_export(0);
+        std::fs::write(path, &profile)
+            .map_err(|e| format!("Failed to write JIT profile {}: {}", path.display(), e))?;
+        tracing::info!("Saved JIT warm start profile ({} bytes) to {}", profile.len(), path.display());
+        Ok(())
+    }
+
+    /// Load a profile written by `save_warm_start_profile` and precompile its
+    /// blocks hottest first. Call after the executable is loaded into memory.
+    /// Returns the number of blocks submitted.
+    pub fn load_warm_start_profile(&self, path: &std::path::Path) -> Result<usize, String> {
+        self.ensure_jit_compiler();
+        let jit = self.jit_compiler.read();
+        let jit = jit.as_ref().ok_or("JIT compiler not available")?;
+
+        let profile = std::fs::read(path)
+            .map_err(|e| format!("Failed to read JIT profile {}: {}", path.display(), e))?;
+        let entries = jit.warm_start_import(&profile)
+            .map_err(|e| format!("Invalid JIT profile {}: {:?}", path.display(), e))?;
+        let submitted = jit.warm_start_submit(
+            self.memory.base_ptr() as *const u8,
+            self.memory.address_space_size(),
+            entries,
+        );
+        tracing::info!("JIT warm start: {} of {} profiled blocks submitted", submitted, entries);
+        Ok(submitted)
+    }
+
     /// Read a basic block of code from memory for compilation
     fn read_block_code(&self, start_address: u32) -> Result<Vec<u8>, String> {
         let mut code = Vec::with_capacity(256);
@@ -266,6 +354,10 @@ impl PpuInterpreter {
             exit_reason: 0,
             memory_base: self.memory.base_ptr(),
             memory_size: self.memory.address_space_size(),
+            instruction_budget: thread.instruction_budget.min(i64::MAX as u64) as i64,
+            budget_enabled: (thread.instruction_budget != 0) as u32,
+            interrupt_pending: 0,
+            deopt_guard: 0,
         }
     }
 
@@ -295,33 +387,32 @@ impl PpuInterpreter {
         }
 
         let pc = thread.pc() as u32;
-        let mut jit = self.jit_compiler.lock();
+        let jit = self.jit_compiler.read();
         
-        let jit = match jit.as_mut() {
+        let jit = match jit.as_ref() {
             Some(j) => j,
             None => return Ok(false),
         };
 
-        // Check for compiled code
-        if jit.get_compiled(pc).is_some() {
+        // Check for compiled code; execute enters it without exporting it
+        if jit.is_compiled(pc) {
             // JIT code is available - execute it!
-            self.jit_stats.lock().cache_hits += 1;
+            self.jit_stats.cache_hits.fetch_add(1, Ordering::Relaxed);
             
             // Create execution context from thread state
             let mut context = self.thread_to_context(thread);
             
             // Execute the JIT-compiled code
-            match jit.execute(&mut context, pc) {
+            let result = jit.execute(&mut context, pc);
+            thread.last_step_instructions += context.instructions_executed as u64;
+            match result {
                 Ok(instructions_executed) => {
                     // Copy state back to thread
                     self.context_to_thread(&context, thread);
                     
                     // Update statistics
-                    {
-                        let mut stats = self.jit_stats.lock();
-                        stats.jit_executions += 1;
-                        stats.jit_instructions += instructions_executed as u64;
-                    }
+                    self.jit_stats.jit_executions.fetch_add(1, Ordering::Relaxed);
+                    self.jit_stats.jit_instructions.fetch_add(instructions_executed as u64, Ordering::Relaxed);
                     
                     tracing::trace!(
                         "JIT executed {} instructions at 0x{:08x}, next PC: 0x{:08x}",
@@ -347,10 +438,21 @@ impl PpuInterpreter {
                             tracing::debug!("JIT hit breakpoint at 0x{:08x}", pc);
                             return Err(PpuError::Breakpoint { addr: context.pc });
                         }
+                        PpuExitReason::Preempted => {
+                            // Nothing ran past next_pc; let the interpreter make progress
+                            tracing::trace!("JIT preempted at 0x{:08x}", context.next_pc);
+                            return Ok(false);
+                        }
+                        PpuExitReason::Deoptimized => {
+                            // A speculation failed; the region's work up to next_pc is in
+                            // the context and the interpreter carries on from there
+                            tracing::trace!("JIT deoptimized at 0x{:08x}", context.next_pc);
+                            return Ok(false);
+                        }
                         PpuExitReason::Error => {
                             // JIT execution error - fall back to interpreter
                             tracing::warn!("JIT execution error at 0x{:08x}", pc);
-                            self.jit_stats.lock().interpreter_fallbacks += 1;
+                            self.jit_stats.interpreter_fallbacks.fetch_add(1, Ordering::Relaxed);
                             return Ok(false);
                         }
                         _ => {
@@ -362,16 +464,20 @@ impl PpuInterpreter {
             }
         }
 
-        self.jit_stats.lock().cache_misses += 1;
+        self.jit_stats.cache_misses.fetch_add(1, Ordering::Relaxed);
 
         // In hybrid mode, check if block is hot
         if mode == JitMode::Hybrid {
-            let should_compile = {
+            let count = {
                 let mut counts = self.block_exec_counts.write();
                 let count = counts.entry(pc).or_insert(0);
                 *count += 1;
-                *count >= self.hot_threshold
+                *count
             };
+            let should_compile = count >= self.hot_threshold;
+            if !should_compile && count + ENTRY_PROFILE_WINDOW >= self.hot_threshold {
+                self.profile_entry(pc, &thread.regs.gpr);
+            }
 
             if should_compile {
                 // Check lazy compilation state
@@ -379,6 +485,7 @@ impl PpuInterpreter {
                     LazyState::NotCompiled => {
                         // Register for lazy compilation
                         if let Ok(code) = self.read_block_code(pc) {
+                            self.publish_entry_profile(jit, pc, &code);
                             jit.register_lazy(pc, &code, self.hot_threshold);
                             tracing::debug!("Registered block 0x{:08x} for lazy compilation", pc);
                         }
@@ -399,11 +506,52 @@ impl PpuInterpreter {
         Ok(false) // Fall back to interpreter
     }
 
+    /// Narrow the entry profile of the block at `address` to the registers
+    /// that still hold the values of its first profiled entry
+    fn profile_entry(&self, address: u32, gpr: &[u64; 32]) {
+        let mut profiles = self.entry_profiles.write();
+        let profile = profiles.entry(address).or_insert(EntryProfile { gpr: *gpr, constant: u32::MAX });
+        for (reg, value) in gpr.iter().enumerate() {
+            if profile.gpr[reg] != *value {
+                profile.constant &= !(1 << reg);
+            }
+        }
+    }
+
+    /// Hand the registers that were constant on every profiled entry, and
+    /// that the block names as an operand, to the JIT as speculation
+    /// candidates for its compile
+    fn publish_entry_profile(&self, jit: &PpuJitCompiler, address: u32, code: &[u8]) {
+        let Some(profile) = self.entry_profiles.write().remove(&address) else {
+            return;
+        };
+        let mut named = 0u32;
+        for word in code.chunks_exact(4) {
+            let opcode = u32::from_be_bytes([word[0], word[1], word[2], word[3]]);
+            named |= (1 << ((opcode >> 21) & 31)) | (1 << ((opcode >> 16) & 31)) | (1 << ((opcode >> 11) & 31));
+        }
+        let candidates = profile.constant & named;
+        for reg in (0..32u8).filter(|reg| candidates & (1 << reg) != 0) {
+            jit.set_entry_constant(address, reg, profile.gpr[reg as usize]);
+        }
+    }
+
+    /// Feed the target of an executed bcctr to the JIT's branch target
+    /// buffer, so regions compiled later can speculate on it
+    fn record_indirect_branch(&self, address: u32, target: u32) {
+        if *self.jit_mode.read() == JitMode::Interpreter {
+            return;
+        }
+        if let Some(jit) = self.jit_compiler.read().as_ref() {
+            jit.btb_add(address, target);
+        }
+    }
+
     /// Add branch prediction hint from interpreter observation
     #[allow(dead_code)] // Will be used when branch recording is enabled
     fn record_branch(&self, address: u32, target: u32, taken: bool) {
-        let mut jit = self.jit_compiler.lock();
-        if let Some(jit) = jit.as_mut() {
+        let jit = self.jit_compiler.read();
+        if let Some(jit) = jit.as_ref() {
             jit.update_branch(address, taken);
             
             // Add hint if this is a new branch
@@ -498,8 +646,12 @@ impl PpuInterpreter {
         }
     }
 
-    /// Execute a single instruction
+    /// Execute a single instruction, or one compiled region when the JIT has
+    /// one for the current address. `thread.last_step_instructions` reports
+    /// how many guest instructions retired.
     pub fn step(&self, thread: &mut PpuThread) -> Result<(), PpuError> {
+        thread.last_step_instructions = 0;
+
         // Check for breakpoints before execution
         if self.should_break(thread) {
             // Update hit count
@@ -513,12 +665,13 @@ impl PpuInterpreter {
         // Try JIT execution first (if enabled and available)
         if self.try_jit_execute(thread)? {
             // JIT execution succeeded - stats already updated
-            self.jit_stats.lock().jit_executions += 1;
+            self.jit_stats.jit_executions.fetch_add(1, Ordering::Relaxed);
             return Ok(());
         }
         
         // Fall back to interpreter
-        self.jit_stats.lock().interpreter_fallbacks += 1;
+        self.jit_stats.interpreter_fallbacks.fetch_add(1, Ordering::Relaxed);
+        thread.last_step_instructions += 1;
 
         // Increment instruction count for conditional breakpoints
         let inst_count = {
@@ -2269,6 +2422,7 @@ impl PpuInterpreter {
                                 self.handle_unresolved_import(thread)?;
                             } else {
                                 // Normal branch
+                                self.record_indirect_branch(thread.pc() as u32, target as u32);
                                 if lk {
                                     thread.regs.lr = thread.pc() + 4;
                                 }
@@ -2276,6 +2430,7 @@ impl PpuInterpreter {
                             }
                         } else {
                             // Normal branch to CTR
+                            self.record_indirect_branch(thread.pc() as u32, target as u32);
                             if lk {
                                 thread.regs.lr = thread.pc() + 4;
                             }
@@ -3588,6 +3743,19 @@ mod tests {
         assert_eq!(thread.gpr(3), 0);
     }
 
+    #[test]
+    fn test_step_reports_retired_instructions() {
+        let (interpreter, mut thread) = create_test_env();
+        thread.set_pc(0x2000_0000);
+        thread.instruction_budget = 100;
+        
+        // addi r3, r0, 1; interpreted, so one instruction per step
+        interpreter.memory.write_be32(0x2000_0000, 0x3860_0001).unwrap();
+        interpreter.step(&mut thread).unwrap();
+        assert_eq!(thread.last_step_instructions, 1);
+        assert_eq!(thread.gpr(3), 1);
+    }
+
     #[test]
     fn test_divw_overflow() {
         let (interpreter, mut thread) = create_test_env();
@@ -3982,4 +4150,31 @@ mod tests {
         // CA should be 1 (negative and 1-bits shifted out)
         assert!(thread.get_xer_ca());
     }
+
+    #[test]
+    fn test_hybrid_profiles_feed_speculation() {
+        let (interpreter, mut thread) = create_test_env();
+        interpreter.set_jit_mode(JitMode::Hybrid);
+        if !interpreter.is_jit_available() {
+            return;
+        }
+        // 0x2000_0000: mtctr r5; bctr  0x2000_0100: b 0x2000_0000
+        interpreter.memory.write_be32(0x2000_0000, 0x7CA9_03A6).unwrap();
+        interpreter.memory.write_be32(0x2000_0004, 0x4E80_0420).unwrap();
+        interpreter.memory.write_be32(0x2000_0100, 0x4BFF_FF00).unwrap();
+        thread.set_pc(0x2000_0000);
+        thread.set_gpr(5, 0x2000_0100);
+        for _ in 0..3 * 100 {
+            interpreter.step(&mut thread).unwrap();
+        }
+        assert_eq!(thread.pc(), 0x2000_0000);
+
+        interpreter.compile_block(0x2000_0000).unwrap();
+        let jit = interpreter.jit_compiler.read();
+        let guards = jit.as_ref().unwrap().guards(0x2000_0000).unwrap();
+        // r5 held the same value on every profiled entry, and the bctr always
+        // went to the same place
+        assert!(guards.iter().any(|g| g.kind == 0 && g.reg == 5 && g.expected == 0x2000_0100));
+        assert!(guards.iter().any(|g| g.kind == 1 && g.guest_pc == 0x2000_0004 && g.expected == 0x2000_0100));
+    }
 }
@@ -485,6 +485,11 @@ pub struct PpuThread {
     pub joinable: bool,
     /// Whether this thread has been joined
     pub joined: bool,
+    /// Instruction budget for JIT dispatch from the next step; 0 lets a
+    /// compiled region run to its end
+    pub instruction_budget: u64,
+    /// Guest instructions retired by the last `PpuInterpreter::step`
+    pub last_step_instructions: u64,
 }
 
 impl PpuThread {
@@ -511,6 +516,8 @@ impl PpuThread {
             join_value: 0,
             joinable: true,
             joined: false,
+            instruction_budget: 0,
+            last_step_instructions: 0,
         }
     }
 
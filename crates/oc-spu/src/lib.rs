@@ -17,7 +17,7 @@ pub use decoder::SpuDecoder;
 pub use interpreter::SpuInterpreter;
 pub use mfc::Mfc;
 pub use thread::{
-    SpuThread, SpuThreadState, SpuThreadGroup, SpuPriority, SpuAffinity,
+    SpuThread, SpuThreadState, SpuThreadGroup, LocalStore, SpuPriority, SpuAffinity,
     SpuExceptionType, SpuExceptionState, SpuEventType, SpuEventQueue,
     SPU_LS_SIZE, MAX_SPU_THREADS_PER_GROUP,
 };
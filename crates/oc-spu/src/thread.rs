@@ -1,6 +1,9 @@
 //! SPU thread state
 
+use std::any::Any;
 use std::collections::VecDeque;
+use std::ops::{Deref, DerefMut};
+use std::ptr::NonNull;
 use std::sync::Arc;
 use oc_memory::MemoryManager;
 use crate::channels::SpuChannels;
@@ -419,6 +422,88 @@ impl SpuRegisters {
     }
 }
 
+/// SPU local store memory
+///
+/// Either owned by the thread or a fixed window mapped by the embedder, whose
+/// contents can then be switched (e.g. by remapping) without touching the
+/// thread. Both deref to the full 256 KB.
+pub struct LocalStore {
+    base: NonNull<[u8; SPU_LS_SIZE]>,
+    /// Keeps a mapped window alive; `None` if `base` is owned
+    mapping: Option<Arc<dyn Any + Send + Sync>>,
+}
+
+impl LocalStore {
+    /// Allocate a zero-filled local store owned by the thread
+    pub fn new() -> Self {
+        let owned: Box<[u8; SPU_LS_SIZE]> = vec![0u8; SPU_LS_SIZE]
+            .into_boxed_slice()
+            .try_into()
+            .unwrap();
+        Self {
+            base: NonNull::from(Box::leak(owned)),
+            mapping: None,
+        }
+    }
+
+    /// Use a window mapped outside the thread as the local store
+    ///
+    /// # Safety
+    /// `base` must stay valid for reads and writes of `SPU_LS_SIZE` bytes for
+    /// as long as `mapping` is alive, and must not be accessed through other
+    /// references while the thread uses it.
+    pub unsafe fn mapped(base: *mut u8, mapping: Arc<dyn Any + Send + Sync>) -> Self {
+        Self {
+            base: NonNull::new(base as *mut [u8; SPU_LS_SIZE]).expect("null local store window"),
+            mapping: Some(mapping),
+        }
+    }
+
+    /// Check whether this local store is a mapped window
+    pub fn is_mapped(&self) -> bool {
+        self.mapping.is_some()
+    }
+
+    /// The embedder's mapping state, if this local store is a mapped window
+    pub fn mapping(&self) -> Option<&(dyn Any + Send + Sync)> {
+        self.mapping.as_deref()
+    }
+}
+
+impl Default for LocalStore {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Deref for LocalStore {
+    type Target = [u8; SPU_LS_SIZE];
+
+    #[inline]
+    fn deref(&self) -> &Self::Target {
+        unsafe { self.base.as_ref() }
+    }
+}
+
+impl DerefMut for LocalStore {
+    #[inline]
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        unsafe { self.base.as_mut() }
+    }
+}
+
+impl Drop for LocalStore {
+    fn drop(&mut self) {
+        if self.mapping.is_none() {
+            drop(unsafe { Box::from_raw(self.base.as_ptr()) });
+        }
+    }
+}
+
+// The memory is uniquely owned like a Box, or kept alive by a Send + Sync mapping
+unsafe impl Send for LocalStore {}
+unsafe impl Sync for LocalStore {}
+
 /// SPU thread
 pub struct SpuThread {
     /// SPU ID (0-5 for PS3)
@@ -428,7 +513,7 @@ pub struct SpuThread {
     /// Register state
     pub regs: SpuRegisters,
     /// Local storage (256 KB)
-    pub local_storage: Box<[u8; SPU_LS_SIZE]>,
+    pub local_storage: LocalStore,
     /// Thread state
     pub state: SpuThreadState,
     /// MFC (Memory Flow Controller)
@@ -468,7 +553,7 @@ impl SpuThread {
             id,
             name: format!("SPU Thread {}", id),
             regs: SpuRegisters::default(),
-            local_storage: Box::new([0; SPU_LS_SIZE]),
+            local_storage: LocalStore::new(),
             state: SpuThreadState::Stopped,
             mfc: Mfc::new(),
             channels: SpuChannels::new(),
@@ -750,6 +835,38 @@ mod tests {
         assert_eq!(thread.ls_read_u128(0x100), value);
     }
 
+    #[test]
+    fn test_local_storage_mapped() {
+        // Stands in for an embedder's window; freed when the last user drops
+        struct Window(*mut [u8; SPU_LS_SIZE]);
+        unsafe impl Send for Window {}
+        unsafe impl Sync for Window {}
+        impl Drop for Window {
+            fn drop(&mut self) {
+                drop(unsafe { Box::from_raw(self.0) });
+            }
+        }
+
+        let memory: Box<[u8; SPU_LS_SIZE]> = vec![0u8; SPU_LS_SIZE].into_boxed_slice().try_into().unwrap();
+        let window = Arc::new(Window(Box::into_raw(memory)));
+        let base = window.0 as *mut u8;
+
+        let mem = create_test_memory();
+        let mut thread = SpuThread::new(0, mem);
+        assert!(!thread.local_storage.is_mapped());
+        thread.local_storage = unsafe { LocalStore::mapped(base, window.clone()) };
+        assert!(thread.local_storage.is_mapped());
+
+        thread.ls_write_u32(0x200, 0xCAFEBABE);
+        assert_eq!(unsafe { *base.add(0x203) }, 0xBE);
+        assert!(thread.local_storage.mapping().unwrap().downcast_ref::<Window>().is_some());
+
+        // The thread's reference keeps the window alive
+        assert_eq!(Arc::strong_count(&window), 2);
+        drop(thread);
+        assert_eq!(Arc::strong_count(&window), 1);
+    }
+
     #[test]
     fn test_pc_wrap() {
         let mem = create_test_memory();
@@ -4,8 +4,7 @@
 
 use std::io::{Read, Seek, SeekFrom};
 use std::path::PathBuf;
-use std::fs::File;
-use std::io::BufReader;
+use oc_ffi::disc_io::DiscFile;
 
 /// ISO 9660 volume descriptor type
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -122,6 +121,8 @@ pub struct IsoReader {
     pub path: PathBuf,
     /// Volume information
     pub volume: Option<IsoVolume>,
+    /// Image opened through the native block cache
+    disc: Option<DiscFile>,
 }
 
 impl IsoReader {
@@ -130,16 +131,17 @@ impl IsoReader {
         Self {
             path,
             volume: None,
+            disc: None,
         }
     }
 
     /// Open and parse the ISO file
     pub fn open(&mut self) -> Result<(), std::io::Error> {
-        let file = std::fs::File::open(&self.path)?;
-        let mut reader = std::io::BufReader::new(file);
+        let disc = DiscFile::open(&self.path)?;
         
-        let volume = IsoVolume::parse(&mut reader)?;
+        let volume = IsoVolume::parse(&mut disc.reader())?;
         self.volume = Some(volume);
+        self.disc = Some(disc);
         
         tracing::info!("Opened ISO: {:?}, Volume ID: {}", 
             self.path, 
@@ -149,6 +151,13 @@ impl IsoReader {
         Ok(())
     }
 
+    /// Get the opened image
+    fn disc(&self) -> Result<&DiscFile, std::io::Error> {
+        self.disc.as_ref().ok_or_else(|| {
+            std::io::Error::new(std::io::ErrorKind::NotFound, "ISO not opened")
+        })
+    }
+
     /// Get volume information
     pub fn volume(&self) -> Option<&IsoVolume> {
         self.volume.as_ref()
@@ -161,8 +170,7 @@ impl IsoReader {
             std::io::Error::new(std::io::ErrorKind::NotFound, "ISO not opened")
         })?;
 
-        let file = File::open(&self.path)?;
-        let mut reader = BufReader::new(file);
+        let mut reader = self.disc()?.reader();
 
         // Normalize path
         let path_parts: Vec<&str> = file_path
@@ -329,8 +337,7 @@ impl IsoReader {
             std::io::Error::new(std::io::ErrorKind::NotFound, "ISO not opened")
         })?;
 
-        let file = File::open(&self.path)?;
-        let mut reader = BufReader::new(file);
+        let mut reader = self.disc()?.reader();
 
         let path_parts: Vec<&str> = dir_path
             .trim_start_matches('/')
@@ -404,4 +411,40 @@ mod tests {
         
         assert_eq!(volume.volume_size_bytes(), 100 * 2048);
     }
+
+    #[test]
+    fn test_iso_reader_read_file() {
+        // Descriptor at sector 16, root directory at 18, file data at 19
+        let mut image = vec![0u8; 20 * 2048];
+        let pvd = &mut image[16 * 2048..17 * 2048];
+        pvd[0] = 1;
+        pvd[1..6].copy_from_slice(b"CD001");
+        pvd[40..72].fill(b' ');
+        pvd[40..44].copy_from_slice(b"TEST");
+        pvd[80..84].copy_from_slice(&20u32.to_le_bytes());
+        pvd[128..130].copy_from_slice(&2048u16.to_le_bytes());
+        pvd[158..162].copy_from_slice(&18u32.to_le_bytes());
+        pvd[166..170].copy_from_slice(&2048u32.to_le_bytes());
+
+        let name = b"PARAM.SFO;1";
+        let record = &mut image[18 * 2048..18 * 2048 + 33 + name.len()];
+        record[0] = (33 + name.len()) as u8;
+        record[2..6].copy_from_slice(&19u32.to_le_bytes());
+        record[10..14].copy_from_slice(&5u32.to_le_bytes());
+        record[32] = name.len() as u8;
+        record[33..].copy_from_slice(name);
+        image[19 * 2048..19 * 2048 + 5].copy_from_slice(b"hello");
+
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("test.iso");
+        std::fs::write(&path, &image).unwrap();
+
+        let mut reader = IsoReader::new(path);
+        assert!(reader.read_file("/PARAM.SFO").is_err());
+        reader.open().unwrap();
+        assert_eq!(reader.volume().unwrap().volume_id, "TEST");
+        assert_eq!(reader.read_file("/PARAM.SFO").unwrap(), b"hello");
+        assert_eq!(reader.list_directory("/").unwrap().len(), 1);
+        assert!(!reader.file_exists("/EBOOT.BIN"));
+    }
 }
@@ -4,6 +4,7 @@
 
 use std::io::{Read, Seek, SeekFrom, Write};
 use std::path::PathBuf;
+use oc_ffi::disc_io::DiscFile;
 
 /// PKG file type
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -101,6 +102,8 @@ pub struct PkgHeader {
     pub file_table_offset: u64,
     /// File table size
     pub file_table_size: u64,
+    /// AES-128-CTR counter for the start of the data area
+    pub data_iv: [u8; 16],
 }
 
 impl PkgHeader {
@@ -173,6 +176,9 @@ impl PkgHeader {
         let file_table_offset = data_offset;
         let file_table_size = 32 * file_count as u64; // Each entry is 32 bytes
 
+        let mut data_iv = [0u8; 16];
+        data_iv.copy_from_slice(&header_data[0x70..0x80]);
+
         Ok(Self {
             pkg_type,
             version,
@@ -184,6 +190,7 @@ impl PkgHeader {
             file_count,
             file_table_offset,
             file_table_size,
+            data_iv,
         })
     }
 
@@ -217,6 +224,8 @@ pub struct PkgReader {
     pub header: Option<PkgHeader>,
     /// File entries
     pub files: Vec<PkgFileEntry>,
+    /// Package opened through the native block cache
+    disc: Option<DiscFile>,
 }
 
 impl PkgReader {
@@ -226,13 +235,14 @@ impl PkgReader {
             path,
             header: None,
             files: Vec::new(),
+            disc: None,
         }
     }
 
     /// Open and parse the PKG file
     pub fn open(&mut self) -> Result<(), std::io::Error> {
-        let file = std::fs::File::open(&self.path)?;
-        let mut reader = std::io::BufReader::new(file);
+        let disc = DiscFile::open(&self.path)?;
+        let mut reader = disc.reader();
 
         let header = PkgHeader::parse(&mut reader)?;
 
@@ -248,10 +258,34 @@ impl PkgReader {
         self.files = self.parse_file_table(&mut reader, &header)?;
 
         self.header = Some(header);
+        self.disc = Some(disc);
 
         Ok(())
     }
 
+    /// Decrypt the data area with the package's AES key from now on. The
+    /// file table lives in the data area, so it is parsed again.
+    pub fn set_data_key(&mut self, key: &[u8; 16]) -> Result<(), std::io::Error> {
+        let header = self.header.as_ref().ok_or_else(|| {
+            std::io::Error::new(std::io::ErrorKind::InvalidInput, "PKG not opened")
+        })?;
+        let disc = self.disc.as_mut().ok_or_else(|| {
+            std::io::Error::new(std::io::ErrorKind::InvalidInput, "PKG not opened")
+        })?;
+        disc.set_decrypt(header.data_offset, header.data_size, key, &header.data_iv)?;
+
+        let disc = self.disc.as_ref().unwrap();
+        self.files = self.parse_file_table(&mut disc.reader(), header)?;
+        Ok(())
+    }
+
+    /// Get the opened package
+    fn disc(&self) -> Result<&DiscFile, std::io::Error> {
+        self.disc.as_ref().ok_or_else(|| {
+            std::io::Error::new(std::io::ErrorKind::InvalidInput, "PKG not opened")
+        })
+    }
+
     /// Parse the file table from the PKG
     fn parse_file_table<R: Read + Seek>(
         &self,
@@ -298,19 +332,22 @@ impl PkgReader {
 
             let is_directory = (flags & 0x04) != 0;
 
-            // Read file name
-            let name = if name_size > 0 && name_size < 1024 {
+            // Read file name (out of range while the table is still encrypted)
+            let mut name = None;
+            if name_size > 0 && name_size < 1024 {
                 let current_pos = reader.stream_position()?;
                 reader.seek(SeekFrom::Start(header.file_table_offset + name_offset as u64))?;
                 let mut name_bytes = vec![0u8; name_size as usize];
-                reader.read_exact(&mut name_bytes)?;
+                if reader.read_exact(&mut name_bytes).is_ok() {
+                    name = Some(
+                        String::from_utf8_lossy(&name_bytes)
+                            .trim_end_matches('\0')
+                            .to_string(),
+                    );
+                }
                 reader.seek(SeekFrom::Start(current_pos))?;
-                String::from_utf8_lossy(&name_bytes)
-                    .trim_end_matches('\0')
-                    .to_string()
-            } else {
-                format!("file_{}", entries.len())
-            };
+            }
+            let name = name.unwrap_or_else(|| format!("file_{}", entries.len()));
 
             entries.push(PkgFileEntry {
                 name_offset,
@@ -361,15 +398,11 @@ impl PkgReader {
             ));
         }
 
-        let file = std::fs::File::open(&self.path)?;
-        let mut reader = std::io::BufReader::new(file);
-
-        reader.seek(SeekFrom::Start(entry.data_offset))?;
         let mut data = vec![0u8; entry.data_size as usize];
-        reader.read_exact(&mut data)?;
+        self.disc()?.read_exact_at(entry.data_offset, &mut data)?;
 
-        // Note: Real PKG files are encrypted. This returns raw data which
-        // may need decryption. For unencrypted/decrypted PKGs, this works directly.
+        // Data of encrypted PKGs is decrypted once the key is set with
+        // set_data_key(); until then this returns the raw data.
 
         Ok(data)
     }
@@ -386,8 +419,7 @@ impl PkgReader {
         // Create output directory
         std::fs::create_dir_all(output_dir)?;
 
-        let file = std::fs::File::open(&self.path)?;
-        let mut reader = std::io::BufReader::new(file);
+        let disc = self.disc()?;
 
         let mut extracted_count = 0u32;
 
@@ -405,16 +437,14 @@ impl PkgReader {
                 }
 
                 // Read and write file data
-                reader.seek(SeekFrom::Start(entry.data_offset))?;
                 let mut data = vec![0u8; entry.data_size as usize];
-                if let Err(e) = reader.read_exact(&mut data) {
+                if let Err(e) = disc.read_exact_at(entry.data_offset, &mut data) {
                     tracing::warn!("Failed to read file {}: {}", entry.name, e);
                     continue;
                 }
 
-                // Note: Real PKG files are encrypted with AES. For encrypted PKGs,
-                // you would need to decrypt the data here using the appropriate keys.
-                // This implementation handles unencrypted/already-decrypted PKGs.
+                // Data of encrypted PKGs is decrypted by the reader once the
+                // key is set with set_data_key()
 
                 let mut output_file = std::fs::File::create(&output_path)?;
                 output_file.write_all(&data)?;
@@ -586,4 +616,51 @@ mod tests {
         
         assert!(entry.is_directory);
     }
+
+    #[test]
+    fn test_pkg_reader_encrypted_data_area() {
+        let key = [0x3cu8; 16];
+        let iv: [u8; 16] = std::array::from_fn(|i| (i * 17) as u8);
+        let data_offset = 0x100u64;
+        let content = b"decrypted through the data key";
+
+        // Header, then the data area: one file table entry, its name and its data
+        let mut pkg = vec![0u8; data_offset as usize];
+        pkg[..4].copy_from_slice(b"\x7FPKG");
+        pkg[7] = 0x01;
+        pkg[24..32].copy_from_slice(&data_offset.to_be_bytes());
+        pkg[40..44].copy_from_slice(&1u32.to_be_bytes());
+        pkg[0x70..0x80].copy_from_slice(&iv);
+        let mut entry = [0u8; 32];
+        entry[0..4].copy_from_slice(&32u32.to_be_bytes());
+        entry[4..8].copy_from_slice(&8u32.to_be_bytes());
+        entry[8..16].copy_from_slice(&(data_offset + 48).to_be_bytes());
+        entry[16..24].copy_from_slice(&(content.len() as u64).to_be_bytes());
+        pkg.extend_from_slice(&entry);
+        pkg.extend_from_slice(b"DATA.BIN\0\0\0\0\0\0\0\0");
+        pkg.extend_from_slice(content);
+        let data_size = pkg.len() as u64 - data_offset;
+        pkg[32..40].copy_from_slice(&data_size.to_be_bytes());
+
+        // CTR is symmetric: "decrypting" the plain package encrypts it
+        let dir = tempfile::tempdir().unwrap();
+        let plain_path = dir.path().join("plain.pkg");
+        std::fs::write(&plain_path, &pkg).unwrap();
+        let mut plain = DiscFile::open(&plain_path).unwrap();
+        plain.set_decrypt(data_offset, data_size, &key, &iv).unwrap();
+        let mut encrypted = vec![0u8; pkg.len()];
+        plain.read_exact_at(0, &mut encrypted).unwrap();
+        assert_ne!(&encrypted[data_offset as usize..], &pkg[data_offset as usize..]);
+
+        let path = dir.path().join("encrypted.pkg");
+        std::fs::write(&path, &encrypted).unwrap();
+        let mut reader = PkgReader::new(path);
+        reader.open().unwrap();
+        assert_eq!(reader.header().unwrap().data_iv, iv);
+        assert!(reader.read_file("DATA.BIN").is_err());
+
+        reader.set_data_key(&key).unwrap();
+        assert_eq!(reader.list_files(), vec!["DATA.BIN"]);
+        assert_eq!(reader.read_file("DATA.BIN").unwrap(), content);
+    }
 }